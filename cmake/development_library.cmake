@@ -24,6 +24,7 @@ set(
   ${CMAKE_SOURCE_DIR}/lib/core/include/bunUtil.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/chksumUtil.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/client_connection.hpp
+  ${CMAKE_SOURCE_DIR}/lib/core/include/concurrent_transfer_scheduler.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/connection_pool.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/cpUtil.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/dispatch_processor.hpp
@@ -94,6 +95,7 @@ set(
   ${CMAKE_SOURCE_DIR}/lib/core/include/irods_string_tokenize.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/irods_tcp_object.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/irods_threads.hpp
+  ${CMAKE_SOURCE_DIR}/lib/core/include/irods_tracing.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/irods_virtual_path.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/query_builder.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/query_processor.hpp
@@ -126,6 +128,7 @@ set(
   ${CMAKE_SOURCE_DIR}/lib/core/include/replUtil.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/replica.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/replica_proxy.hpp
+  ${CMAKE_SOURCE_DIR}/lib/core/include/replica_striped_get.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/resource_administration.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/rmdirUtil.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/rmUtil.h
@@ -148,6 +151,7 @@ set(
   ${CMAKE_SOURCE_DIR}/lib/core/include/rodsUser.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/rsyncUtil.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/scanUtil.h
+  ${CMAKE_SOURCE_DIR}/lib/core/include/server_config_snapshot.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/shared_memory_object.hpp
   ${CMAKE_SOURCE_DIR}/lib/core/include/sockComm.h
   ${CMAKE_SOURCE_DIR}/lib/core/include/sockCommNetworkInterface.hpp
@@ -276,9 +280,11 @@ set(
   ${CMAKE_SOURCE_DIR}/lib/api/include/pamAuthRequest.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/phyBundleColl.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/phyPathReg.h
+  ${CMAKE_SOURCE_DIR}/lib/api/include/prestage_to_cache.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/procStat.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/querySpecColl.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/readCollection.h
+  ${CMAKE_SOURCE_DIR}/lib/api/include/read_collection_batch.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/regColl.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/regDataObj.h
   ${CMAKE_SOURCE_DIR}/lib/api/include/regReplica.h
@@ -478,14 +484,26 @@ set(
 
 set(
   IRODS_SERVER_CORE_INCLUDE_HEADERS
+  ${CMAKE_SOURCE_DIR}/server/core/include/api_metrics.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/block_compression.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/cache_eviction.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/client_api_whitelist.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/collection.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/coprocess.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/dataObjOpr.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/dedup_store.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/direct_io.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/replica_access_table.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/pack_store.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/parallel_gzip.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/stage_queue.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/tar_member_index.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/fileOpr.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/initServer.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/io_engine.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/irodsReServer.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/irods_api_calling_functions.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/irods_async_log_sink.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/irods_collection_object.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/irods_data_object.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/irods_database_constants.hpp
@@ -520,6 +538,7 @@ set(
   ${CMAKE_SOURCE_DIR}/server/core/include/irods_structured_object.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/json_deserialization.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/json_serialization.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/l1desc_table.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/miscServerFunct.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/objDesc.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/objMetaOpr.hpp
@@ -538,6 +557,7 @@ set(
   ${CMAKE_SOURCE_DIR}/server/core/include/server_utilities.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/specColl.hpp
   ${CMAKE_SOURCE_DIR}/server/core/include/voting.hpp
+  ${CMAKE_SOURCE_DIR}/server/core/include/zero_copy.hpp
   )
 
 set(
@@ -612,6 +632,7 @@ install(
     PATTERN */filesystem/filesystem.tpp
     PATTERN */filesystem/filesystem_error.hpp
     PATTERN */filesystem/object_status.hpp
+    PATTERN */filesystem/parallel_recursive_collection_iterator.hpp
     PATTERN */filesystem/path.hpp
     PATTERN */filesystem/path_traits.hpp
     PATTERN */filesystem/permissions.hpp
@@ -0,0 +1,56 @@
+#ifndef IRODS_PRESTAGE_TO_CACHE_H
+#define IRODS_PRESTAGE_TO_CACHE_H
+
+/// \file
+
+struct RcComm;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// \brief Warms the cache of a compound resource with the data objects returned by a
+/// GenQuery.
+///
+/// The data objects are queued for staging and the call returns without waiting for
+/// them. The stages are queued in the agent serving \p _comm, so an open of a queued
+/// data object through the same connection stages it at once, or waits for its stage
+/// if it has started. Requests for data objects which are already queued or being
+/// staged are coalesced. Stages which have not started when the connection is closed
+/// are discarded.
+///
+/// \param[in] _comm       A pointer to a RcComm.
+/// \param[in] _json_input \parblock
+/// A JSON string describing the data objects to stage.
+///
+/// The JSON string must have the following structure:
+/// \code{.js}
+/// {
+///   "query": string,
+///   "resource": string,
+///   "priority": integer
+/// }
+/// \endcode
+/// \endparblock
+///
+/// \p query is a GenQuery string whose first two columns are COLL_NAME and DATA_NAME,
+/// e.g. "select COLL_NAME, DATA_NAME where COLL_NAME like '/tempZone/home/rods/run_42%'".
+///
+/// \p resource is the root resource of the hierarchy containing the compound resource.
+///
+/// \p priority orders the stages queued by this call relative to other prefetches.
+/// Higher values are staged first. Stages needed by opens always take precedence.
+/// This field is optional and defaults to 0.
+///
+/// \return An integer.
+/// \retval >=0      The number of data objects queued.
+/// \retval Negative On failure.
+///
+/// \since 4.3.0
+int rc_prestage_to_cache(RcComm* _comm, const char* _json_input);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // IRODS_PRESTAGE_TO_CACHE_H
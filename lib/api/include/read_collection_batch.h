@@ -0,0 +1,74 @@
+#ifndef IRODS_READ_COLLECTION_BATCH_H
+#define IRODS_READ_COLLECTION_BATCH_H
+
+/// \file
+
+struct RcComm;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// \brief Reads many entries from an open collection in a single round trip.
+///
+/// This is the batched form of ::rcReadCollection. The collection must be opened
+/// with ::rcOpenCollection first and closed with ::rcCloseCollection when done.
+///
+/// \param[in]  _comm        A pointer to a RcComm.
+/// \param[in]  _json_input  \parblock
+/// A JSON string identifying the collection handle and the batch size.
+///
+/// The JSON string must have the following structure:
+/// \code{.js}
+/// {
+///   "handle": integer,
+///   "max_entries": integer
+/// }
+/// \endcode
+/// \endparblock
+/// \param[out] _json_output \parblock
+/// A JSON string containing the entries read. The caller is responsible for
+/// freeing it.
+///
+/// To keep the response compact, each entry is encoded as an array rather than
+/// an object:
+/// \code{.js}
+/// [
+///   [
+///     object_type,  // integer (objType_t)
+///     name,         // string (absolute path for collections, data name for data objects)
+///     data_size,    // integer
+///     data_mode,    // integer
+///     data_id,      // string
+///     create_time,  // string (seconds since epoch)
+///     modify_time,  // string (seconds since epoch)
+///     checksum,     // string
+///     owner_name,   // string
+///     data_type     // string
+///   ],
+///   ...
+/// ]
+/// \endcode
+/// \endparblock
+///
+/// \p handle is the value returned by ::rcOpenCollection.
+///
+/// \p max_entries is the maximum number of entries returned. The server clamps
+/// it to the range [1, 4096]. This field is optional and defaults to 512.
+///
+/// Fewer than \p max_entries entries may be returned even when the end of the
+/// collection has not been reached.
+///
+/// \return An integer.
+/// \retval 0                 On success. At least one entry is returned.
+/// \retval CAT_NO_ROWS_FOUND If there are no more entries.
+/// \retval Non-zero          On failure.
+///
+/// \since 4.3.0
+int rc_read_collection_batch(RcComm* _comm, const char* _json_input, char** _json_output);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // IRODS_READ_COLLECTION_BATCH_H
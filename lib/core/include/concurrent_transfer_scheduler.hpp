@@ -0,0 +1,114 @@
+#ifndef IRODS_CONCURRENT_TRANSFER_SCHEDULER_HPP
+#define IRODS_CONCURRENT_TRANSFER_SCHEDULER_HPP
+
+#include "rcConnect.h"
+#include "dataObjInpOut.h"
+
+#include "connection_pool.hpp"
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace irods
+{
+    // Keeps up to N whole-file transfers in flight for the recursive put/get
+    // utilities. Each transfer is executed on its own connection taken from a
+    // connection pool.
+    //
+    // Back-pressure is applied against the oldest transfer that has not yet been
+    // recorded in the restart file. Because of this, at most N transfers can
+    // complete beyond the point recorded in the restart file, which is what
+    // allows a resumed operation to overwrite them safely.
+    //
+    // The restart file is only written by the thread which calls submit() and
+    // wait(), which is also the thread that reads the restart state while
+    // walking the tree. Completed transfers are recorded the next time either
+    // function is called.
+    class concurrent_transfer_scheduler
+    {
+    public:
+        using transfer_function = std::function<int(rcComm_t&)>;
+
+        concurrent_transfer_scheduler(int _max_in_flight,
+                                      const rodsEnv& _env,
+                                      rodsRestart_t& _restart);
+
+        concurrent_transfer_scheduler(const concurrent_transfer_scheduler&) = delete;
+        concurrent_transfer_scheduler& operator=(const concurrent_transfer_scheduler&) = delete;
+
+        ~concurrent_transfer_scheduler();
+
+        // Blocks until a transfer slot is available and then schedules _func.
+        // The path is written to the restart file once this transfer and all
+        // transfers submitted before it have completed successfully.
+        //
+        // Returns a negative error code if a previous transfer failed while a
+        // restart file is in use. The caller must stop submitting in that case.
+        int submit(const std::string& _restart_path, rodsLong_t _size, transfer_function _func);
+
+        // Blocks until all submitted transfers have completed.
+        // Returns the first error encountered, or zero.
+        int wait();
+
+        // Must be called when the restart state transitions to OPR_RESUMED.
+        // The next max_in_flight() transfers may already exist at the destination
+        // and must be forced.
+        void resumed() noexcept;
+
+        // Returns true if the next transfer must overwrite existing data.
+        bool overwrite_required() noexcept;
+
+        int max_in_flight() const noexcept;
+
+        // Prints the aggregate throughput of all completed transfers.
+        void print_summary() const;
+
+    private:
+        struct transfer_slot
+        {
+            std::string restart_path;
+            rodsLong_t size;
+            bool done;
+            int status;
+        };
+
+        void complete(std::int64_t _seq, int _status);
+
+        // Pops the completed transfers at the front of the window and writes
+        // them to the restart file. Called with mutex_ held, on the thread
+        // which owns restart_.
+        void record_completed();
+
+        const int max_in_flight_;
+        rodsRestart_t& restart_;
+        connection_pool conn_pool_;
+        thread_pool thread_pool_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<transfer_slot> window_;
+        std::int64_t base_seq_;
+        std::int64_t next_seq_;
+        int in_flight_;
+        int first_error_;
+        bool restart_pinned_;
+        int overwrites_remaining_;
+
+        std::int64_t files_done_;
+        rodsLong_t bytes_done_;
+        const std::chrono::steady_clock::time_point start_time_;
+    };
+
+    // Returns a deep copy of _input that can be handed to a scheduled transfer.
+    // The returned object releases its keyword list on destruction.
+    std::shared_ptr<dataObjInp_t> clone_data_object_input(const dataObjInp_t& _input);
+} // namespace irods
+
+#endif // IRODS_CONCURRENT_TRANSFER_SCHEDULER_HPP
@@ -6,7 +6,8 @@
 
 #include <streambuf>
 #include <type_traits>
-#include <array>
+#include <vector>
+#include <future>
 #include <string>
 #include <stdexcept>
 #include <algorithm>
@@ -20,6 +21,15 @@ namespace irods::experimental::io
     //
     //      https://en.cppreference.com/w/cpp/io/basic_streambuf
     //
+    // The size of the internal buffer can be changed at any time via pubsetbuf(nullptr, size).
+    // Small writes are coalesced in the buffer and only reach the transport once it is full.
+    //
+    // When asynchronous I/O is enabled, the next block is read while the caller consumes the
+    // current one, and a full block is sent while the caller fills the next one. The transport
+    // is then used from a second thread, so the connection behind it must not be used for
+    // anything else while the stream is open. Errors from an asynchronous write are reported
+    // by the next flush, seek or close.
+    //
     template <typename CharT,
               typename Traits = std::char_traits<CharT>>
     class basic_data_object_buf final
@@ -40,7 +50,7 @@ namespace irods::experimental::io
         using base_type = std::basic_streambuf<CharT, Traits>;
 
         // clang-format off
-        inline static constexpr auto buffer_size          = 4096;
+        inline static constexpr auto default_buffer_size  = 4096;
 
         // Errors
         inline static constexpr auto external_write_error = -1;
@@ -50,7 +60,7 @@ namespace irods::experimental::io
     public:
         basic_data_object_buf()
             : base_type{}
-            , buf_{}
+            , buf_(default_buffer_size)
             , transport_{}
         {
         }
@@ -80,6 +90,11 @@ namespace irods::experimental::io
             base_type::swap(_other);
             swap(transport_, _other.transport_);
             swap(buf_, _other.buf_);
+            swap(async_buf_, _other.async_buf_);
+            swap(pending_, _other.pending_);
+            swap(pending_op_, _other.pending_op_);
+            swap(pending_size_, _other.pending_size_);
+            swap(async_io_, _other.async_io_);
         }
 
         friend void swap(basic_data_object_buf& _lhs, basic_data_object_buf& _rhs)
@@ -91,7 +106,23 @@ namespace irods::experimental::io
         {
             return transport_ && transport_->is_open();
         }
-	
+
+        // Enables or disables read-ahead and write-behind. Disabled by default.
+        void asynchronous_io(bool _enable) noexcept
+        {
+            async_io_ = _enable;
+        }
+
+        bool asynchronous_io() const noexcept
+        {
+            return async_io_;
+        }
+
+        std::size_t buffer_size() const noexcept
+        {
+            return buf_.size();
+        }
+
         basic_data_object_buf* open(transport<char_type>& _transport,
                                     const filesystem::path& _path,
                                     std::ios_base::openmode _mode)
@@ -201,6 +232,9 @@ namespace irods::experimental::io
                 sb = nullptr;
             }
 
+            // The transport must not be in use by a read-ahead when it is closed.
+            discard_input();
+
             if (!transport_->close(_on_close_success)) {
                 sb = nullptr;
             }
@@ -245,17 +279,35 @@ namespace irods::experimental::io
             }
 
             // The "Get" area has been consumed. Fill the internal buffer with
-            // new data from the data object.
+            // new data from the data object, or take the block that was read ahead.
+
+            std::streamsize bytes_read = 0;
 
-            const auto bytes_read = transport_->receive(buf_.data(), buf_.size() * sizeof(char_type));
+            if (pending_op::read == pending_op_) {
+                bytes_read = wait_for_pending_operation();
+
+                if (bytes_read > 0) {
+                    buf_.swap(async_buf_);
+                }
+            }
+            else {
+                bytes_read = transport_->receive(buf_.data(), buf_.size() * sizeof(char_type));
+            }
+
+            auto* pbase = buf_.data();
 
             if (bytes_read <= 0) {
+                this->setg(pbase, pbase, pbase);
                 return traits_type::eof();
             }
 
-            auto* pbase = buf_.data();
             this->setg(pbase, pbase, pbase + bytes_read);
 
+            // A short read means the end of the data object has been reached.
+            if (async_io_ && bytes_read == static_cast<std::streamsize>(buf_.size())) {
+                start_read_ahead();
+            }
+
             return traits_type::to_int_type(*this->gptr());
         }
 
@@ -278,36 +330,111 @@ namespace irods::experimental::io
         {
             prepare_for_input();
 
-            const auto bytes_to_copy = this->egptr() - this->gptr(); 
+            std::streamsize total = 0;
+
+            while (total < _buffer_size) {
+                // If there are bytes in the internal buffer that haven't been consumed,
+                // then copy those bytes from the internal buffer into "_buffer".
+                if (const auto available = this->egptr() - this->gptr(); available > 0) {
+                    const auto bytes_to_copy = std::min<std::streamsize>(available, _buffer_size - total);
+                    std::memcpy(_buffer + total, this->gptr(), bytes_to_copy * sizeof(char_type));
+                    this->gbump(static_cast<int>(bytes_to_copy));
+                    total += bytes_to_copy;
+                    continue;
+                }
+
+                const auto remaining = _buffer_size - total;
 
-            // If there are bytes in the internal buffer that haven't been consumed,
-            // then copy those bytes from the internal buffer into "_buffer".
-            if (bytes_to_copy > 0) {
-                std::memcpy(_buffer, this->gptr(), bytes_to_copy * sizeof(char_type));
-                this->gbump(bytes_to_copy);
+                // Large requests bypass the internal buffer unless a block has already
+                // been read ahead.
+                if (pending_op::none == pending_op_ && remaining >= static_cast<std::streamsize>(buf_.size())) {
+                    const auto bytes_read = transport_->receive(_buffer + total, remaining * sizeof(char_type));
+
+                    if (bytes_read <= 0) {
+                        break;
+                    }
+
+                    total += bytes_read;
+                    continue;
+                }
+
+                if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+                    break;
+                }
             }
 
-            return transport_->receive(_buffer + bytes_to_copy, (_buffer_size - bytes_to_copy) * sizeof(char_type));
+            return total;
         }
 
         std::streamsize xsputn(const char_type* _buffer, std::streamsize _buffer_size) override
         {
             prepare_for_output();
 
+            // Coalesce small writes in the "Put" area.
+            if (_buffer_size <= this->epptr() - this->pptr()) {
+                std::memcpy(this->pptr(), _buffer, _buffer_size * sizeof(char_type));
+                this->pbump(static_cast<int>(_buffer_size));
+                return _buffer_size;
+            }
+
             if (flush_buffer() == external_write_error) {
                 return external_write_error;
             }
 
+            if (_buffer_size < static_cast<std::streamsize>(buf_.size())) {
+                std::memcpy(this->pptr(), _buffer, _buffer_size * sizeof(char_type));
+                this->pbump(static_cast<int>(_buffer_size));
+                return _buffer_size;
+            }
+
+            // Large writes are sent directly, after any write still in flight.
+            if (wait_for_pending_write() == external_write_error) {
+                return external_write_error;
+            }
+
             return transport_->send(_buffer, _buffer_size * sizeof(char_type));
         }
 
         int sync() override
         {
             if (this->pptr()) {
-                return flush_buffer();
+                if (flush_buffer() == external_write_error) {
+                    return external_write_error;
+                }
             }
 
-            return 0;
+            return wait_for_pending_write();
+        }
+
+        // Resizes the internal buffer. Only a null "_s" is supported because the
+        // buffer is also used for read-ahead and write-behind.
+        base_type* setbuf(char_type* _s, std::streamsize _n) override
+        {
+            if (_s || _n <= 0 || this->sync() != 0) {
+                return nullptr;
+            }
+
+            const bool reading = this->gptr();
+            const bool writing = this->pptr();
+
+            if (reading && !rewind_unread_input()) {
+                return nullptr;
+            }
+
+            buf_.assign(_n, char_type{});
+            async_buf_.clear();
+            async_buf_.shrink_to_fit();
+
+            auto* pbase = buf_.data();
+
+            if (reading) {
+                this->setg(pbase, pbase, pbase);
+            }
+            else if (writing) {
+                this->setp(pbase, pbase + buf_.size());
+            }
+
+            return this;
         }
 
         int_type pbackfail(int_type _c = traits_type::eof()) override
@@ -338,6 +465,14 @@ namespace irods::experimental::io
                 return seek_error;
             }
 
+            // The transport is ahead of the caller by the number of buffered bytes
+            // that have not been consumed yet.
+            const auto unread = discard_input();
+
+            if (std::ios_base::cur == _dir) {
+                _off -= unread;
+            }
+
             return transport_->seekpos(_off, _dir);
         }
 
@@ -347,6 +482,8 @@ namespace irods::experimental::io
                 return seek_error;
             }
 
+            discard_input();
+
             return transport_->seekpos(_pos, std::ios_base::beg);
         }
 
@@ -374,8 +511,9 @@ namespace irods::experimental::io
                 return;
             }
 
-            // Clear the contents of the "Get" area.
-            this->setg(nullptr, nullptr, nullptr);
+            // Clear the contents of the "Get" area. Writing must start where the
+            // caller stopped reading, not where the transport stopped.
+            rewind_unread_input();
 
             // Setup the "Put" area.
             auto* pbase = buf_.data();
@@ -404,6 +542,25 @@ namespace irods::experimental::io
                 return 0;
             }
 
+            if (async_io_) {
+                // Only one write may be in flight. Its buffer becomes the new "Put" area.
+                if (wait_for_pending_write() == external_write_error) {
+                    return external_write_error;
+                }
+
+                async_buf_.resize(buf_.size());
+                buf_.swap(async_buf_);
+                this->setp(buf_.data(), buf_.data() + buf_.size());
+
+                pending_size_ = bytes_to_send;
+                pending_op_ = pending_op::write;
+                pending_ = std::async(std::launch::async, [t = transport_, p = async_buf_.data(), n = bytes_to_send] {
+                    return t->send(p, n * sizeof(char_type));
+                });
+
+                return 0;
+            }
+
             const auto bytes_written = transport_->send(buf_.data(), bytes_to_send * sizeof(char_type));
 
             if (bytes_written < 0) {
@@ -415,8 +572,84 @@ namespace irods::experimental::io
             return 0;
         }
 
-        std::array<char_type, buffer_size> buf_;
+        void start_read_ahead()
+        {
+            async_buf_.resize(buf_.size());
+
+            pending_op_ = pending_op::read;
+            pending_ = std::async(std::launch::async, [t = transport_, p = async_buf_.data(), n = async_buf_.size()] {
+                return t->receive(p, n * sizeof(char_type));
+            });
+        }
+
+        // Waits for the asynchronous operation, if any, and returns its result.
+        std::streamsize wait_for_pending_operation()
+        {
+            if (pending_op::none == pending_op_) {
+                return 0;
+            }
+
+            pending_op_ = pending_op::none;
+
+            return pending_.get();
+        }
+
+        int wait_for_pending_write()
+        {
+            if (pending_op::write != pending_op_) {
+                return 0;
+            }
+
+            const auto expected = pending_size_;
+
+            return (wait_for_pending_operation() == expected) ? 0 : external_write_error;
+        }
+
+        // Clears the "Get" area and returns the number of bytes the transport has
+        // read but the caller has not consumed.
+        std::streamsize discard_input()
+        {
+            std::streamsize unread = 0;
+
+            if (this->gptr()) {
+                unread = this->egptr() - this->gptr();
+            }
+
+            if (pending_op::read == pending_op_) {
+                unread += std::max<std::streamsize>(0, wait_for_pending_operation());
+            }
+
+            this->setg(nullptr, nullptr, nullptr);
+
+            return unread;
+        }
+
+        // Clears the "Get" area and moves the transport back to the caller's position.
+        bool rewind_unread_input()
+        {
+            if (const auto unread = discard_input(); unread > 0) {
+                return transport_->seekpos(-unread, std::ios_base::cur) != seek_error;
+            }
+
+            return true;
+        }
+
+        enum class pending_op
+        {
+            none,
+            read,
+            write
+        };
+
+        std::vector<char_type> buf_;
         transport<char_type>* transport_;
+
+        // The buffer being filled by a read-ahead or drained by a write-behind.
+        std::vector<char_type> async_buf_{};
+        std::future<std::streamsize> pending_{};
+        pending_op pending_op_ = pending_op::none;
+        std::streamsize pending_size_ = 0;
+        bool async_io_ = false;
     }; // basic_data_object_buf
 
     // Provides a default openmode for basic_dstream constructors and open()
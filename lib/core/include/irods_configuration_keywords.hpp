@@ -60,10 +60,23 @@ namespace irods
     extern const std::string CFG_DEF_NUMBER_TRANSFER_THREADS;
     extern const std::string CFG_TRANS_CHUNK_SIZE_PARA_TRANS;
     extern const std::string CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS;
+    extern const std::string CFG_ZERO_COPY_FOR_PARA_TRANS;
+    extern const std::string CFG_REPLICA_ACCESS_TABLE_SIZE;
+    extern const std::string CFG_NUMBER_OF_BUNDLE_THREADS;
     extern const std::string CFG_DEF_TEMP_PASSWORD_LIFETIME;
     extern const std::string CFG_MAX_TEMP_PASSWORD_LIFETIME;
     extern const std::string CFG_MAX_NUMBER_OF_CONCURRENT_RE_PROCS;
     extern const std::string DEFAULT_LOG_ROTATION_IN_DAYS;
+    extern const std::string CFG_ASYNCHRONOUS_LOGGING;
+    extern const std::string CFG_LOG_BUFFER_SIZE;
+    extern const std::string CFG_LOG_OVERFLOW_POLICY;
+    extern const std::string CFG_LOG_FILE_PATH;
+    extern const std::string CFG_PROMETHEUS_METRICS_PORT;
+    extern const std::string CFG_TRACE_FILE_PATH;
+    extern const std::string CFG_TRACE_SAMPLING_RATIO;
+    extern const std::string CFG_REPLICA_CLOSE_COMMIT_MODE;
+    extern const std::string CFG_REPLICA_CLOSE_COMMIT_BATCH_SIZE;
+    extern const std::string CFG_REPLICA_CLOSE_SYNCHRONOUS_COMMIT;
 
     extern const std::string CFG_RE_CACHE_SALT_KW;
     extern const std::string CFG_RE_SERVER_SLEEP_TIME;
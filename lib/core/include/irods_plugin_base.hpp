@@ -17,6 +17,7 @@
 #endif
 
 #include "irods_logger.hpp"
+#include "irods_tracing.hpp"
 
 #include "irods_error.hpp"
 #include "irods_lookup_table.hpp"
@@ -61,6 +62,7 @@ namespace irods
             , operations_( )
             , start_operation_( default_plugin_start_operation )
             , stop_operation_( default_plugin_stop_operation )
+            , span_name_prefix_( )
         {
         } // ctor
 
@@ -71,6 +73,7 @@ namespace irods
             , operations_( _rhs.operations_ )
             , start_operation_(_rhs.start_operation_)
             , stop_operation_(_rhs.stop_operation_)
+            , span_name_prefix_(_rhs.span_name_prefix_)
         {
         } // cctor
 
@@ -82,6 +85,7 @@ namespace irods
             operations_        = _rhs.operations_;
             start_operation_   = _rhs.start_operation_;
             stop_operation_    = _rhs.stop_operation_;
+            span_name_prefix_  = _rhs.span_name_prefix_;
             return *this;
         } // operator=
 
@@ -158,6 +162,37 @@ namespace irods
             const std::string&            _operation_name,
             irods::first_class_object_ptr _fco,
             types_t...                    _t)
+        {
+            namespace tracing = irods::experimental::tracing;
+
+            // only the operations of plugins which set a span name prefix are traced
+            if ( span_name_prefix_.empty() || !tracing::enabled() ) {
+                return invoke_operation<types_t...>( _comm, _operation_name, _fco, std::forward<types_t>(_t)... );
+            }
+
+            tracing::span span{span_name_prefix_ + _operation_name};
+
+            if ( span.recording() ) {
+                span.set_attribute( "irods.plugin_instance", instance_name_ );
+            }
+
+            error ret = invoke_operation<types_t...>( _comm, _operation_name, _fco, std::forward<types_t>(_t)... );
+
+            if ( !ret.ok() && span.recording() ) {
+                span.set_attribute( "irods.error_code", ret.code() );
+                span.set_error( ret.result() );
+            }
+
+            return ret;
+        } // call
+
+    private:
+        template<typename... types_t>
+        error invoke_operation(
+            rsComm_t*                     _comm,
+            const std::string&            _operation_name,
+            irods::first_class_object_ptr _fco,
+            types_t...                    _t)
         {
             using namespace std;
 
@@ -291,8 +326,9 @@ namespace irods
                 msg += _operation_name;
                 return ERROR(INVALID_ANY_CAST, msg);
             }
-        } // call
+        } // invoke_operation
 
+    public:
         /// @brief get a property from the map if it exists.
         template< typename T >
         error get_property( const std::string& _key, T& _val ) {
@@ -343,6 +379,11 @@ namespace irods
         maintenance_operation_t start_operation_;
         maintenance_operation_t stop_operation_;
 
+        /// =-=-=-=-=-=-=-
+        /// @brief prefix of the names of the trace spans recorded for the
+        ///        operations of this plugin. operations are not traced if empty
+        std::string span_name_prefix_;
+
     private:
 #ifdef ENABLE_RE
         template<typename... types_t>
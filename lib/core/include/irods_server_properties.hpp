@@ -14,10 +14,15 @@
 #include "irods_configuration_parser.hpp"
 #include "irods_configuration_keywords.hpp"
 #include "irods_exception.hpp"
+#include "server_config_snapshot.hpp"
 
 #include <boost/format.hpp>
 #include <boost/any.hpp>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace irods {
 
@@ -71,46 +76,142 @@ namespace irods {
              */
             void capture_json( const std::string& );
 
+            /// Returns the typed snapshot of the configuration captured most recently.
+            ///
+            /// The snapshot is replaced atomically whenever the configuration is captured or
+            /// one of the properties it holds is changed. Reading it does not take a lock.
+            /// Replaced snapshots are kept until the process exits, so the reference remains
+            /// valid even if the configuration is reloaded by another thread.
+            ///
+            /// \since 4.3.0
+            auto snapshot() const noexcept -> const server_config_snapshot&
+            {
+                return *snapshot_.load(std::memory_order_acquire);
+            }
+
             template< typename T >
             T& get_property( const std::string& _key ) {
+                if constexpr ( is_snapshot_type_v<T> ) {
+                    if ( const auto* v = snapshot_property<std::remove_const_t<T>>( _key ); v ) {
+                        return *v;
+                    }
+                }
+
                 return config_props_.get< T >( _key );
             }
 
             template< typename T>
             T& get_property( const configuration_parser::key_path_t& _keys ) {
+                if constexpr ( is_snapshot_type_v<T> ) {
+                    if ( _keys.size() == 2 && _keys[0] == CFG_ADVANCED_SETTINGS_KW ) {
+                        if ( const auto* v = snapshot_advanced_setting<std::remove_const_t<T>>( _keys[1] ); v ) {
+                            return *v;
+                        }
+                    }
+                }
+
                 return config_props_.get<T>( _keys );
             }
 
+            template< typename T >
+            T& get_advanced_setting( const std::string& _key ) {
+                if constexpr ( is_snapshot_type_v<T> ) {
+                    if ( const auto* v = snapshot_advanced_setting<std::remove_const_t<T>>( _key ); v ) {
+                        return *v;
+                    }
+                }
+
+                return config_props_.get<T>( configuration_parser::key_path_t{CFG_ADVANCED_SETTINGS_KW, _key} );
+            }
+
             template< typename T >
             T& set_property( const std::string& _key, const T& _val ) {
-                return config_props_.set< T >( _key, _val );
+                auto& v = config_props_.set< T >( _key, _val );
+                refresh_snapshot_if_needed( _key );
+                return v;
             }
 
             template< typename T>
             T& set_property( const configuration_parser::key_path_t& _keys, const T& _val ) {
-                return config_props_.set<T>( _keys, _val );
+                auto& v = config_props_.set<T>( _keys, _val );
+                refresh_snapshot_if_needed( _keys.front() );
+                return v;
             }
 
             template<typename T>
             T remove( const std::string& _key ) {
-                return config_props_.remove<T>( _key );
+                auto v = config_props_.remove<T>( _key );
+                refresh_snapshot_if_needed( _key );
+                return v;
             }
 
             void remove( const std::string& _key );
 
         private:
+            // Only read-only lookups of these types can be served by the snapshot. Anything
+            // else is read from config_props_.
+            template <typename T>
+            static constexpr bool is_snapshot_type_v = std::is_const_v<T> &&
+                                                       (std::is_same_v<std::remove_const_t<T>, int> ||
+                                                        std::is_same_v<std::remove_const_t<T>, bool> ||
+                                                        std::is_same_v<std::remove_const_t<T>, std::string>);
+
             // Disable constructors
             server_properties( server_properties const& );
             server_properties( );
             void operator=( server_properties const& );
 
+            // Return a pointer to the value held by the snapshot, or nullptr if the key is
+            // not part of the snapshot or the value is missing or has a different type.
+            template <typename T>
+            auto snapshot_property( const std::string& _key ) const noexcept -> const T*;
+
+            template <typename T>
+            auto snapshot_advanced_setting( const std::string& _key ) const noexcept -> const T*;
+
+            void refresh_snapshot();
+            void refresh_snapshot_if_needed( const std::string& _key );
+
             /**
              * @brief properties lookup table
              */
             configuration_parser config_props_;
 
+            std::atomic<const server_config_snapshot*> snapshot_;
+
+            // Owns every snapshot ever published. See snapshot().
+            std::vector<std::unique_ptr<const server_config_snapshot>> snapshots_;
+
     }; // class server_properties
 
+    template <>
+    auto server_properties::snapshot_property<int>( const std::string& ) const noexcept -> const int*;
+
+    template <>
+    auto server_properties::snapshot_property<bool>( const std::string& ) const noexcept -> const bool*;
+
+    template <>
+    auto server_properties::snapshot_property<std::string>( const std::string& ) const noexcept -> const std::string*;
+
+    template <>
+    auto server_properties::snapshot_advanced_setting<int>( const std::string& ) const noexcept -> const int*;
+
+    template <>
+    auto server_properties::snapshot_advanced_setting<bool>( const std::string& ) const noexcept -> const bool*;
+
+    template <>
+    auto server_properties::snapshot_advanced_setting<std::string>( const std::string& ) const noexcept -> const std::string*;
+
+    /// Returns the typed snapshot of the server configuration.
+    ///
+    /// \see server_properties::snapshot()
+    ///
+    /// \since 4.3.0
+    inline auto server_config() noexcept -> const server_config_snapshot&
+    {
+        return server_properties::instance().snapshot();
+    }
+
     template< typename T >
     T& get_server_property( const std::string& _prop ) {
         return irods::server_properties::instance().get_property<T>(_prop);
@@ -140,7 +241,7 @@ namespace irods {
 
     template< typename T >
     T& get_advanced_setting( const std::string& _prop ) {
-        return irods::get_server_property<T>(configuration_parser::key_path_t{CFG_ADVANCED_SETTINGS_KW, _prop});
+        return irods::server_properties::instance().get_advanced_setting<T>(_prop);
     } // get_advanced_setting
 
 } // namespace irods
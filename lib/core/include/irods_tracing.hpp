@@ -0,0 +1,145 @@
+#ifndef IRODS_TRACING_HPP
+#define IRODS_TRACING_HPP
+
+/// \file
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/// Lightweight trace spans for attributing latency across servers.
+///
+/// A span measures one unit of work (an API call, a resource plugin operation, a
+/// database statement, ...). Spans nest on the thread that creates them and carry the
+/// trace ID of the request they belong to. The trace context is passed to other
+/// servers in the option string of the startup pack using the W3C traceparent format,
+/// so the spans recorded by every server involved in a request form a single trace.
+///
+/// Finished spans are buffered and appended to a file in the OTLP/JSON format (one
+/// ExportTraceServiceRequest per line), which the OpenTelemetry Collector can ingest.
+///
+/// Nothing is recorded until init() is called. Creating a span is then a single
+/// branch, which keeps instrumentation cheap when tracing is disabled.
+///
+/// \since 4.3.0
+namespace irods::experimental::tracing
+{
+    /// The identity of a span as propagated between processes.
+    struct trace_context
+    {
+        std::array<std::uint8_t, 16> trace_id{};
+        std::uint64_t span_id = 0;
+        bool sampled = false;
+    }; // struct trace_context
+
+    /// Converts \p _ctx to a W3C traceparent header value ("00-<trace-id>-<span-id>-<flags>").
+    auto to_traceparent(const trace_context& _ctx) -> std::string;
+
+    /// Parses a W3C traceparent header value.
+    ///
+    /// \return The trace context, or an empty optional if \p _value is not valid.
+    auto from_traceparent(std::string_view _value) noexcept -> std::optional<trace_context>;
+
+    /// The key which introduces the trace context in the option string of the startup pack.
+    inline constexpr std::string_view startup_pack_option_key = "traceparent=";
+
+    /// Returns the token to append to the option string of the startup pack.
+    auto to_startup_pack_option(const trace_context& _ctx) -> std::string;
+
+    /// Removes the trace context from the option string of a startup pack.
+    ///
+    /// \param[in,out] _option The option string. The token is removed if it is valid.
+    ///
+    /// \return The trace context, or an empty optional if \p _option does not hold one.
+    auto extract_from_startup_pack_option(std::string& _option) -> std::optional<trace_context>;
+
+    struct config
+    {
+        /// The file the spans are appended to.
+        std::string file;
+
+        /// The fraction of traces started by this process which are recorded. Traces
+        /// started by a remote caller follow the caller's decision.
+        double sampling_ratio = 1.0;
+
+        /// Reported as the service.name resource attribute.
+        std::string service_name = "irods";
+    }; // struct config
+
+    /// Enables tracing.
+    ///
+    /// Processes forked afterwards inherit the configuration. Each process buffers its
+    /// own spans and writes them when the buffer fills up, when flush() is called and
+    /// when the process exits.
+    ///
+    /// \throws std::system_error If the file cannot be opened.
+    auto init(const config& _config) -> void;
+
+    /// Returns whether init() has been called.
+    auto enabled() noexcept -> bool;
+
+    /// Writes the buffered spans.
+    auto flush() noexcept -> void;
+
+    /// Makes the spans of this process which have no local parent children of \p _ctx.
+    ///
+    /// Called by an agent with the context received from its client.
+    auto set_remote_parent(const trace_context& _ctx) noexcept -> void;
+
+    /// Returns the context to propagate to another server: the innermost span recorded
+    /// on this thread, otherwise the remote parent.
+    auto current() noexcept -> std::optional<trace_context>;
+
+    namespace detail
+    {
+        struct span_data;
+    } // namespace detail
+
+    enum class span_kind
+    {
+        internal = 1,
+        server = 2,
+        client = 3
+    }; // enum class span_kind
+
+    /// Records the time between its construction and destruction.
+    ///
+    /// Spans must be destroyed in the reverse order of their construction on the
+    /// thread that created them, which is guaranteed by declaring them as local
+    /// variables.
+    class span
+    {
+    public:
+        explicit span(std::string_view _name, span_kind _kind = span_kind::internal);
+
+        span(const span&) = delete;
+        auto operator=(const span&) -> span& = delete;
+
+        ~span();
+
+        /// Returns whether the span will be exported. Attributes which are expensive
+        /// to compute should only be set if this returns true.
+        auto recording() const noexcept -> bool;
+
+        /// Replaces the name given to the constructor.
+        auto set_name(std::string_view _name) -> void;
+
+        auto set_attribute(std::string_view _key, std::string_view _value) -> void;
+        auto set_attribute(std::string_view _key, std::int64_t _value) -> void;
+
+        /// Marks the span as failed.
+        auto set_error(std::string_view _message) -> void;
+
+    private:
+        std::unique_ptr<detail::span_data> data_;
+        span* parent_;
+
+        friend auto current() noexcept -> std::optional<trace_context>;
+    }; // class span
+} // namespace irods::experimental::tracing
+
+#endif // IRODS_TRACING_HPP
@@ -133,6 +133,11 @@ typedef struct {
     int excludeFile;
     char *excludeFileString;
 
+    int concurrentFiles;
+    int concurrentFilesValue;
+
+    int stripeReplicas;
+
     // =-=-=-=-=-=-=-
     // atomic metadata put &
     // kv pass through
@@ -0,0 +1,63 @@
+#ifndef IRODS_REPLICA_STRIPED_GET_HPP
+#define IRODS_REPLICA_STRIPED_GET_HPP
+
+#include "rcConnect.h"
+#include "getRodsEnv.h"
+
+#include <string>
+#include <vector>
+
+namespace irods
+{
+    // Data objects smaller than this are not worth striping.
+    constexpr rodsLong_t min_size_for_striped_get = 32 * 1024 * 1024;
+
+    // A replica of a data object, as seen by the striped get.
+    struct replica_location
+    {
+        int replica_number;
+        int status;
+        std::string host;
+    };
+
+    // A replica which a striped get reads from.
+    struct stripe_source
+    {
+        int replica_number;
+        std::string host;
+    };
+
+    // Returns the good replicas in _replicas, ordered by replica number. Replicas
+    // served by the same host share its bandwidth, so only the first one of each
+    // host is kept.
+    std::vector<stripe_source> select_stripe_sources(std::vector<replica_location> _replicas);
+
+    // Queries the replicas of _logical_path and returns the ones a striped get
+    // should read from.
+    //
+    // Throws if the query fails.
+    std::vector<stripe_source> select_stripe_sources(rcComm_t& _conn, const std::string& _logical_path);
+
+    // Returns the number of ranges a striped get should read at once from
+    // _number_of_sources replicas. _requested is the number of threads asked for
+    // by the user, or zero.
+    int stripe_channel_count(std::size_t _number_of_sources, int _requested) noexcept;
+
+    // Reads the data object at _logical_path into the local file _local_path.
+    //
+    // The object is cut into _channels ranges. Each range is read on its own
+    // connection to the server which hosts its replica, and neighbouring ranges
+    // are read from different replicas, so the transfer is served by all sources
+    // at once.
+    //
+    // Returns zero on success, or a negative error code. The local file may be
+    // incomplete on failure.
+    int striped_get(const rodsEnv& _env,
+                    const std::string& _logical_path,
+                    const std::string& _local_path,
+                    rodsLong_t _size,
+                    const std::vector<stripe_source>& _sources,
+                    int _channels);
+} // namespace irods
+
+#endif // IRODS_REPLICA_STRIPED_GET_HPP
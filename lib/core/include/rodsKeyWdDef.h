@@ -243,7 +243,9 @@
 #define IN_PDMO_KW                                  "in_pdmo"
 #define STAGE_OBJ_KW                                "stage_object"
 #define SYNC_OBJ_KW                                 "sync_object"
+#define STAGE_INLINE_KW                             "stage_inline"  /* stage in the calling agent rather than the stage queue */
 #define IN_REPL_KW                                  "in_repl"
+#define REPL_FAN_OUT_KW                             "repl_fan_out"  /* replication started by the fan-out of this sub-hierarchy */
 
 // =-=-=-=-=-=-=-
 // irods tcp keyword definitions
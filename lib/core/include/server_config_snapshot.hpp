@@ -0,0 +1,59 @@
+#ifndef IRODS_SERVER_CONFIG_SNAPSHOT_HPP
+#define IRODS_SERVER_CONFIG_SNAPSHOT_HPP
+
+/// \file
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace irods
+{
+    /// An immutable, typed copy of the most frequently read server configuration
+    /// properties.
+    ///
+    /// A snapshot is built each time server_properties captures the configuration.
+    /// Reading a member of the snapshot does not involve any string lookups or
+    /// boost::any casts. Properties that are missing from the configuration or that
+    /// do not have the expected type are left empty.
+    ///
+    /// \see server_properties::snapshot()
+    ///
+    /// \since 4.3.0
+    struct server_config_snapshot
+    {
+        /// Properties found under "advanced_settings".
+        struct advanced_settings_type
+        {
+            std::optional<int> default_log_rotation_in_days;
+            std::optional<int> default_number_of_transfer_threads;
+            std::optional<int> default_temporary_password_lifetime_in_seconds;
+            std::optional<int> maximum_number_of_concurrent_rule_engine_server_processes;
+            std::optional<int> maximum_size_for_single_buffer_in_megabytes;
+            std::optional<int> maximum_temporary_password_lifetime_in_seconds;
+            std::optional<int> replica_access_table_size_in_megabytes;
+            std::optional<int> rule_engine_server_execution_time_in_seconds;
+            std::optional<int> rule_engine_server_sleep_time_in_seconds;
+            std::optional<int> transfer_buffer_size_for_parallel_transfer_in_megabytes;
+            std::optional<int> transfer_chunk_size_for_parallel_transfer_in_megabytes;
+            std::optional<bool> use_zero_copy_for_parallel_transfer;
+        }; // struct advanced_settings_type
+
+        advanced_settings_type advanced_settings;
+
+        std::optional<std::string> catalog_service_role;
+        std::optional<std::string> default_hash_scheme;
+        std::optional<std::string> match_hash_policy;
+        std::optional<std::string> zone_auth_scheme;
+        std::optional<std::string> zone_name;
+        std::optional<std::string> zone_user;
+        std::optional<int> server_port_range_start;
+        std::optional<int> server_port_range_end;
+        std::optional<int> zone_port;
+
+        /// Maps each log category to its level (e.g. "api" => "info").
+        std::unordered_map<std::string, std::string> log_level;
+    }; // struct server_config_snapshot
+} // namespace irods
+
+#endif // IRODS_SERVER_CONFIG_SNAPSHOT_HPP
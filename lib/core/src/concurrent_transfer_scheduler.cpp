@@ -0,0 +1,208 @@
+#include "concurrent_transfer_scheduler.hpp"
+
+#include "rcMisc.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+namespace irods
+{
+    concurrent_transfer_scheduler::concurrent_transfer_scheduler(int _max_in_flight,
+                                                                 const rodsEnv& _env,
+                                                                 rodsRestart_t& _restart)
+        : max_in_flight_{_max_in_flight}
+        , restart_{_restart}
+        , conn_pool_{_max_in_flight,
+                     _env.rodsHost,
+                     _env.rodsPort,
+                     _env.rodsUserName,
+                     _env.rodsZone,
+                     _env.irodsConnectionPoolRefreshTime}
+        , thread_pool_{_max_in_flight}
+        , mutex_{}
+        , cv_{}
+        , window_{}
+        , base_seq_{}
+        , next_seq_{}
+        , in_flight_{}
+        , first_error_{}
+        , restart_pinned_{}
+        , overwrites_remaining_{}
+        , files_done_{}
+        , bytes_done_{}
+        , start_time_{std::chrono::steady_clock::now()}
+    {
+        if (_max_in_flight < 1) {
+            throw std::invalid_argument{"invalid number of concurrent transfers"};
+        }
+    }
+
+    concurrent_transfer_scheduler::~concurrent_transfer_scheduler()
+    {
+        wait();
+        thread_pool_.join();
+    }
+
+    int concurrent_transfer_scheduler::submit(const std::string& _restart_path,
+                                              rodsLong_t _size,
+                                              transfer_function _func)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        while (true) {
+            record_completed();
+
+            if (static_cast<int>(window_.size()) < max_in_flight_ || (first_error_ < 0 && restart_.fd > 0)) {
+                break;
+            }
+
+            cv_.wait(lock);
+        }
+
+        // Mirror the sequential behavior: once a transfer fails and a restart file
+        // is being maintained, no further transfers are started.
+        if (first_error_ < 0 && restart_.fd > 0) {
+            return first_error_;
+        }
+
+        const auto seq = next_seq_++;
+        window_.push_back({_restart_path, _size, false, 0});
+        ++in_flight_;
+        lock.unlock();
+
+        thread_pool::post(thread_pool_, [this, seq, func = std::move(_func)] {
+            int status = 0;
+
+            try {
+                auto conn = conn_pool_.get_connection();
+                status = func(conn);
+            }
+            catch (const std::exception& e) {
+                rodsLog(LOG_ERROR, "concurrent_transfer_scheduler: %s", e.what());
+                status = SYS_INTERNAL_ERR;
+            }
+
+            complete(seq, status);
+        });
+
+        return 0;
+    }
+
+    int concurrent_transfer_scheduler::wait()
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        cv_.wait(lock, [this] { return 0 == in_flight_; });
+        record_completed();
+        return first_error_;
+    }
+
+    void concurrent_transfer_scheduler::resumed() noexcept
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        overwrites_remaining_ = max_in_flight_;
+    }
+
+    bool concurrent_transfer_scheduler::overwrite_required() noexcept
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        if (overwrites_remaining_ > 0) {
+            --overwrites_remaining_;
+            return true;
+        }
+
+        return false;
+    }
+
+    int concurrent_transfer_scheduler::max_in_flight() const noexcept
+    {
+        return max_in_flight_;
+    }
+
+    void concurrent_transfer_scheduler::print_summary() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        using seconds = std::chrono::duration<float>;
+        const float time_in_sec = std::chrono::duration_cast<seconds>(std::chrono::steady_clock::now() - start_time_).count();
+        const float size_in_mb = static_cast<float>(bytes_done_) / 1048576.0;
+        const float trans_rate = time_in_sec > 0.0 ? size_in_mb / time_in_sec : 0.0;
+
+        fprintf(stdout,
+                "   %lld files | %.3f MB | %.3f sec | %d concurrent transfers | %.3f MB/s\n",
+                static_cast<long long>(files_done_),
+                size_in_mb,
+                time_in_sec,
+                max_in_flight_,
+                trans_rate);
+    }
+
+    void concurrent_transfer_scheduler::complete(std::int64_t _seq, int _status)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            auto& slot = window_[_seq - base_seq_];
+            slot.done = true;
+            slot.status = _status;
+
+            if (_status >= 0) {
+                ++files_done_;
+                bytes_done_ += slot.size;
+            }
+            else if (0 == first_error_) {
+                first_error_ = _status;
+            }
+
+            --in_flight_;
+        }
+
+        cv_.notify_all();
+    }
+
+    void concurrent_transfer_scheduler::record_completed()
+    {
+        // Advance the restart point over the contiguous run of completed
+        // transfers. A failed transfer pins the restart point so that a
+        // resumed operation starts from it. The transfers completed after it
+        // are still taken out of the window, but are not recorded.
+        while (!window_.empty() && window_.front().done) {
+            auto& front = window_.front();
+
+            if (front.status < 0) {
+                restart_pinned_ = true;
+            }
+
+            if (restart_.fd > 0 && !restart_pinned_) {
+                if (const int ec = procAndWriteRestartFile(&restart_, front.restart_path.data()); ec < 0) {
+                    rodsLogError(LOG_ERROR, ec,
+                                 "concurrent_transfer_scheduler: procAndWriteRestartFile failed for %s. status = %d",
+                                 front.restart_path.c_str(), ec);
+
+                    if (0 == first_error_) {
+                        first_error_ = ec;
+                    }
+
+                    restart_pinned_ = true;
+                }
+            }
+
+            window_.pop_front();
+            ++base_seq_;
+        }
+    }
+
+    std::shared_ptr<dataObjInp_t> clone_data_object_input(const dataObjInp_t& _input)
+    {
+        auto* copy = new dataObjInp_t{};
+        replDataObjInp(const_cast<dataObjInp_t*>(&_input), copy);
+
+        return {copy, [](dataObjInp_t* _p) {
+            clearDataObjInp(_p);
+            delete _p;
+        }};
+    }
+} // namespace irods
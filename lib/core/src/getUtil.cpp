@@ -12,6 +12,20 @@
 #include "rcPortalOpr.h"
 #include "sockComm.h"
 #include "rcGlobalExtern.h"
+#include "concurrent_transfer_scheduler.hpp"
+#include "replica_striped_get.hpp"
+
+#include <unistd.h>
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+static int
+getCollUtilImpl( rcComm_t **myConn, char *srcColl, char *targDir,
+                 rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+                 rodsRestart_t *rodsRestart, irods::concurrent_transfer_scheduler *scheduler );
 
 int
 setSessionTicket( rcComm_t *myConn, char *ticket ) {
@@ -130,9 +144,32 @@ getUtil( rcComm_t **myConn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
         else if ( targPath->objType ==  LOCAL_DIR_T ) {
             setStateForRestart( &rodsRestart, targPath, myRodsArgs );
             addKeyVal( &dataObjOprInp.condInput, TRANSLATED_PATH_KW, "" );
-            status = getCollUtil( myConn, rodsPathInp->srcPath[i].outPath,
-                                  targPath->outPath, myRodsEnv, myRodsArgs, &dataObjOprInp,
-                                  &rodsRestart );
+            if ( myRodsArgs->concurrentFiles == True && myRodsArgs->concurrentFilesValue > 1 ) {
+                std::unique_ptr<irods::concurrent_transfer_scheduler> scheduler;
+                try {
+                    scheduler = std::make_unique<irods::concurrent_transfer_scheduler>(
+                        myRodsArgs->concurrentFilesValue, *myRodsEnv, rodsRestart );
+                }
+                catch ( const std::exception& e ) {
+                    rodsLog( LOG_ERROR, "getUtil: could not start concurrent transfers: %s", e.what() );
+                    return SYS_INTERNAL_ERR;
+                }
+                status = getCollUtilImpl( myConn, rodsPathInp->srcPath[i].outPath,
+                                          targPath->outPath, myRodsEnv, myRodsArgs, &dataObjOprInp,
+                                          &rodsRestart, scheduler.get() );
+                const int transferStatus = scheduler->wait();
+                if ( status >= 0 && transferStatus < 0 ) {
+                    status = transferStatus;
+                }
+                if ( myRodsArgs->verbose == True ) {
+                    scheduler->print_summary();
+                }
+            }
+            else {
+                status = getCollUtil( myConn, rodsPathInp->srcPath[i].outPath,
+                                      targPath->outPath, myRodsEnv, myRodsArgs, &dataObjOprInp,
+                                      &rodsRestart );
+            }
         }
         else {
             /* should not be here */
@@ -196,6 +233,67 @@ getUtil( rcComm_t **myConn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
     return status;
 }
 
+/* stripedGetUtil - get a large data object by reading different ranges of it
+ * from each of its good replicas at once, when --stripe-replicas is given.
+ * Returns 1 if the object is not striped, in which case the caller gets it the
+ * usual way. A failed striped get also returns 1 after removing the partial
+ * local file. */
+static int
+stripedGetUtil( rcComm_t *conn, char *srcPath, char *targPath, rodsLong_t srcSize,
+                rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp ) {
+    constexpr int notStriped = 1;
+
+    /* options which pick a replica, need the server to verify the transfer or
+     * cannot be honored by pooled connections are left to rcDataObjGet */
+    if ( rodsArgs->stripeReplicas != True ||
+            srcSize < irods::min_size_for_striped_get ||
+            ( rodsArgs->number == True && rodsArgs->numberValue <= 1 ) ||
+            rodsArgs->replNum == True || rodsArgs->resource == True ||
+            rodsArgs->verifyChecksum == True || rodsArgs->ticket == True ||
+            rodsArgs->lfrestart == True ||
+            strcmp( targPath, STDOUT_FILE_NAME ) == 0 ) {
+        return notStriped;
+    }
+
+    if ( getValByKey( &dataObjOprInp->condInput, FORCE_FLAG_KW ) == NULL &&
+            access( targPath, F_OK ) == 0 ) {
+        /* let rcDataObjGet report the overwrite error */
+        return notStriped;
+    }
+
+    rodsEnv myEnv;
+    if ( getRodsEnv( &myEnv ) < 0 ) {
+        return notStriped;
+    }
+
+    std::vector<irods::stripe_source> sources;
+    try {
+        sources = irods::select_stripe_sources( *conn, srcPath );
+    }
+    catch ( const std::exception& e ) {
+        rodsLog( LOG_DEBUG, "stripedGetUtil: could not list replicas of %s: %s", srcPath, e.what() );
+        return notStriped;
+    }
+
+    if ( sources.size() < 2 ) {
+        return notStriped;
+    }
+
+    const int channels = irods::stripe_channel_count(
+        sources.size(), rodsArgs->number == True ? rodsArgs->numberValue : 0 );
+
+    const int status = irods::striped_get( myEnv, srcPath, targPath, srcSize, sources, channels );
+    if ( status < 0 ) {
+        rodsLogError( LOG_NOTICE, status,
+                      "stripedGetUtil: striped get of %s failed. reading from a single replica. status = %d",
+                      srcPath, status );
+        unlink( targPath );
+        return notStriped;
+    }
+
+    return 0;
+}
+
 int
 getDataObjUtil( rcComm_t *conn, char *srcPath, char *targPath,
                 rodsLong_t srcSize, uint dataMode,
@@ -239,7 +337,11 @@ getDataObjUtil( rcComm_t *conn, char *srcPath, char *targPath,
         dataObjOprInp->dataSize = srcSize;
     }
 
-    status = rcDataObjGet( conn, dataObjOprInp, targPath );
+    status = stripedGetUtil( conn, srcPath, targPath, srcSize, rodsArgs, dataObjOprInp );
+    if ( status > 0 ) {
+        /* not striped */
+        status = rcDataObjGet( conn, dataObjOprInp, targPath );
+    }
 
     if ( status >= 0 ) {
         /* old objState use numCopies in place of dataMode.
@@ -413,6 +515,17 @@ int
 getCollUtil( rcComm_t **myConn, char *srcColl, char *targDir,
              rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
              rodsRestart_t *rodsRestart ) {
+    return getCollUtilImpl( myConn, srcColl, targDir, myRodsEnv, rodsArgs,
+                            dataObjOprInp, rodsRestart, NULL );
+}
+
+/* getCollUtilImpl - when a scheduler is given, data objects are handed to it
+ * and transferred concurrently over pooled connections. Local directories are
+ * still created in order before any of their children are transferred. */
+static int
+getCollUtilImpl( rcComm_t **myConn, char *srcColl, char *targDir,
+                 rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+                 rodsRestart_t *rodsRestart, irods::concurrent_transfer_scheduler *scheduler ) {
     int status = 0;
     int savedStatus = 0;
     char srcChildPath[MAX_NAME_LEN], targChildPath[MAX_NAME_LEN];
@@ -470,6 +583,8 @@ getCollUtil( rcComm_t **myConn, char *srcColl, char *targDir,
             snprintf( srcChildPath, MAX_NAME_LEN, "%s/%s",
                       collEnt.collName, collEnt.dataName );
 
+            const bool wasResumed = ( rodsRestart->restartState & OPR_RESUMED ) != 0;
+
             int status = chkStateForResume( conn, rodsRestart, targChildPath,
                                         rodsArgs, LOCAL_FILE_T, &dataObjOprInp->condInput, 1 );
 
@@ -477,7 +592,45 @@ getCollUtil( rcComm_t **myConn, char *srcColl, char *targDir,
                 /* restart failed */
                 break;
             }
-            else if ( status == 0 ) {
+
+            if ( scheduler != NULL && !wasResumed &&
+                    ( rodsRestart->restartState & OPR_RESUMED ) != 0 ) {
+                scheduler->resumed();
+            }
+
+            if ( status == 0 ) {
+                continue;
+            }
+
+            if ( scheduler != NULL ) {
+                /* concurrent get. the restart file is written by the scheduler */
+                auto childInp = irods::clone_data_object_input( *dataObjOprInp );
+                if ( scheduler->overwrite_required() ) {
+                    addKeyVal( &childInp->condInput, FORCE_FLAG_KW, "" );
+                }
+                std::string srcObj = srcChildPath;
+                std::string targFile = targChildPath;
+                const uint dataMode = collEnt.dataMode;
+                status = scheduler->submit( targFile, mySize,
+                    [=]( rcComm_t& _conn ) mutable {
+                        if ( rodsArgs->ticket == True ) {
+                            /* pooled connections do not share the session ticket */
+                            setSessionTicket( &_conn, rodsArgs->ticketString );
+                        }
+                        const int ec = getDataObjUtil( &_conn, srcObj.data(), targFile.data(), mySize,
+                                                       dataMode, rodsArgs, childInp.get() );
+                        if ( ec < 0 ) {
+                            rodsLogError( LOG_ERROR, ec,
+                                          "getCollUtil: getDataObjUtil failed for %s. status = %d",
+                                          srcObj.c_str(), ec );
+                        }
+                        return ec;
+                    } );
+                if ( status < 0 ) {
+                    /* a previous transfer failed and was reported */
+                    savedStatus = status;
+                    break;
+                }
                 continue;
             }
 
@@ -523,8 +676,8 @@ getCollUtil( rcComm_t **myConn, char *srcColl, char *targDir,
             else {
                 childDataObjInp.specColl = NULL;
             }
-            int status = getCollUtil( myConn, collEnt.collName, targChildPath,
-                                  myRodsEnv, rodsArgs, &childDataObjInp, rodsRestart );
+            int status = getCollUtilImpl( myConn, collEnt.collName, targChildPath,
+                                      myRodsEnv, rodsArgs, &childDataObjInp, rodsRestart, scheduler );
             if ( status < 0 && status != CAT_NO_ROWS_FOUND ) {
                 rodsLogError( LOG_ERROR, status,
                               "getCollUtil: getCollUtil failed for %s. status = %d",
@@ -57,10 +57,23 @@ namespace irods
     const std::string CFG_DEF_NUMBER_TRANSFER_THREADS( "default_number_of_transfer_threads" );
     const std::string CFG_TRANS_CHUNK_SIZE_PARA_TRANS( "transfer_chunk_size_for_parallel_transfer_in_megabytes" );
     const std::string CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS( "transfer_buffer_size_for_parallel_transfer_in_megabytes" );
+    const std::string CFG_ZERO_COPY_FOR_PARA_TRANS( "use_zero_copy_for_parallel_transfer" );
+    const std::string CFG_REPLICA_ACCESS_TABLE_SIZE( "replica_access_table_size_in_megabytes" );
+    const std::string CFG_NUMBER_OF_BUNDLE_THREADS( "number_of_threads_for_struct_file_bundling" );
     const std::string CFG_DEF_TEMP_PASSWORD_LIFETIME( "default_temporary_password_lifetime_in_seconds" );
     const std::string CFG_MAX_TEMP_PASSWORD_LIFETIME( "maximum_temporary_password_lifetime_in_seconds" );
     const std::string CFG_MAX_NUMBER_OF_CONCURRENT_RE_PROCS( "maximum_number_of_concurrent_rule_engine_server_processes" );
     const std::string DEFAULT_LOG_ROTATION_IN_DAYS("default_log_rotation_in_days");
+    const std::string CFG_ASYNCHRONOUS_LOGGING( "use_asynchronous_logging" );
+    const std::string CFG_LOG_BUFFER_SIZE( "log_buffer_size_in_messages" );
+    const std::string CFG_LOG_OVERFLOW_POLICY( "log_buffer_overflow_policy" );
+    const std::string CFG_LOG_FILE_PATH( "log_file_path" );
+    const std::string CFG_PROMETHEUS_METRICS_PORT( "prometheus_metrics_port" );
+    const std::string CFG_TRACE_FILE_PATH( "trace_file_path" );
+    const std::string CFG_TRACE_SAMPLING_RATIO( "trace_sampling_ratio" );
+    const std::string CFG_REPLICA_CLOSE_COMMIT_MODE( "replica_close_commit_mode" );
+    const std::string CFG_REPLICA_CLOSE_COMMIT_BATCH_SIZE( "replica_close_commit_batch_size" );
+    const std::string CFG_REPLICA_CLOSE_SYNCHRONOUS_COMMIT( "replica_close_synchronous_commit" );
 
     const std::string CFG_RE_CACHE_SALT_KW("reCacheSalt");
     const std::string CFG_RE_SERVER_SLEEP_TIME( "rule_engine_server_sleep_time_in_seconds");
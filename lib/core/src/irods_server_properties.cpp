@@ -17,6 +17,8 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <optional>
+#include <unordered_map>
 
 #include <boost/filesystem.hpp>
 namespace fs = boost::filesystem;
@@ -27,12 +29,137 @@ namespace fs = boost::filesystem;
 
 namespace irods {
 
+    namespace {
+
+        // clang-format off
+        using snapshot_type          = server_config_snapshot;
+        using advanced_settings_type = server_config_snapshot::advanced_settings_type;
+        using map_type               = std::unordered_map<std::string, boost::any>;
+        // clang-format on
+
+        // Maps configuration keys to the snapshot members that hold their values.
+        template <typename Class, typename T>
+        using member_table = std::unordered_map<std::string, std::optional<T> Class::*>;
+
+        // The tables are function-local statics because the keywords are defined in
+        // another translation unit.
+        const auto& advanced_int_settings() {
+            static const member_table<advanced_settings_type, int> table{
+                {DEFAULT_LOG_ROTATION_IN_DAYS,           &advanced_settings_type::default_log_rotation_in_days},
+                {CFG_DEF_NUMBER_TRANSFER_THREADS,        &advanced_settings_type::default_number_of_transfer_threads},
+                {CFG_DEF_TEMP_PASSWORD_LIFETIME,         &advanced_settings_type::default_temporary_password_lifetime_in_seconds},
+                {CFG_MAX_NUMBER_OF_CONCURRENT_RE_PROCS,  &advanced_settings_type::maximum_number_of_concurrent_rule_engine_server_processes},
+                {CFG_MAX_SIZE_FOR_SINGLE_BUFFER,         &advanced_settings_type::maximum_size_for_single_buffer_in_megabytes},
+                {CFG_MAX_TEMP_PASSWORD_LIFETIME,         &advanced_settings_type::maximum_temporary_password_lifetime_in_seconds},
+                {CFG_REPLICA_ACCESS_TABLE_SIZE,          &advanced_settings_type::replica_access_table_size_in_megabytes},
+                {CFG_RE_SERVER_EXEC_TIME,                &advanced_settings_type::rule_engine_server_execution_time_in_seconds},
+                {CFG_RE_SERVER_SLEEP_TIME,               &advanced_settings_type::rule_engine_server_sleep_time_in_seconds},
+                {CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS,   &advanced_settings_type::transfer_buffer_size_for_parallel_transfer_in_megabytes},
+                {CFG_TRANS_CHUNK_SIZE_PARA_TRANS,        &advanced_settings_type::transfer_chunk_size_for_parallel_transfer_in_megabytes}
+            };
+
+            return table;
+        }
+
+        const auto& advanced_bool_settings() {
+            static const member_table<advanced_settings_type, bool> table{
+                {CFG_ZERO_COPY_FOR_PARA_TRANS, &advanced_settings_type::use_zero_copy_for_parallel_transfer}
+            };
+
+            return table;
+        }
+
+        const auto& int_properties() {
+            static const member_table<snapshot_type, int> table{
+                {CFG_SERVER_PORT_RANGE_START_KW, &snapshot_type::server_port_range_start},
+                {CFG_SERVER_PORT_RANGE_END_KW,   &snapshot_type::server_port_range_end},
+                {CFG_ZONE_PORT,                  &snapshot_type::zone_port}
+            };
+
+            return table;
+        }
+
+        const auto& string_properties() {
+            static const member_table<snapshot_type, std::string> table{
+                {CFG_CATALOG_SERVICE_ROLE,   &snapshot_type::catalog_service_role},
+                {CFG_DEFAULT_HASH_SCHEME_KW, &snapshot_type::default_hash_scheme},
+                {CFG_MATCH_HASH_POLICY_KW,   &snapshot_type::match_hash_policy},
+                {CFG_ZONE_AUTH_SCHEME,       &snapshot_type::zone_auth_scheme},
+                {CFG_ZONE_NAME,              &snapshot_type::zone_name},
+                {CFG_ZONE_USER,              &snapshot_type::zone_user}
+            };
+
+            return table;
+        }
+
+        // Copies the values found in "_map" into the members listed in "_table". Values
+        // of the wrong type are skipped, so that lookups fall back to the map and report
+        // the same errors as before.
+        template <typename Class, typename T>
+        void copy_values(const map_type& _map, const member_table<Class, T>& _table, Class& _out) {
+            for (auto&& [key, member] : _table) {
+                if (const auto iter = _map.find(key); iter != std::end(_map)) {
+                    if (const auto* v = boost::any_cast<T>(&iter->second); v) {
+                        _out.*member = *v;
+                    }
+                }
+            }
+        }
+
+        auto make_snapshot(const map_type& _root) -> std::unique_ptr<const snapshot_type> {
+            auto snapshot = std::make_unique<snapshot_type>();
+
+            copy_values(_root, int_properties(), *snapshot);
+            copy_values(_root, string_properties(), *snapshot);
+
+            if (const auto iter = _root.find(CFG_ADVANCED_SETTINGS_KW); iter != std::end(_root)) {
+                if (const auto* settings = boost::any_cast<map_type>(&iter->second); settings) {
+                    copy_values(*settings, advanced_int_settings(), snapshot->advanced_settings);
+                    copy_values(*settings, advanced_bool_settings(), snapshot->advanced_settings);
+                }
+            }
+
+            if (const auto iter = _root.find(CFG_LOG_LEVEL_KW); iter != std::end(_root)) {
+                if (const auto* log_level = boost::any_cast<map_type>(&iter->second); log_level) {
+                    for (auto&& [category, level] : *log_level) {
+                        if (const auto* v = boost::any_cast<std::string>(&level); v) {
+                            snapshot->log_level.emplace(category, *v);
+                        }
+                    }
+                }
+            }
+
+            return snapshot;
+        }
+
+        template <typename Class, typename T>
+        auto find_value(const member_table<Class, T>& _table, const Class& _object, const std::string& _key) noexcept -> const T* {
+            if (const auto iter = _table.find(_key); iter != std::end(_table)) {
+                if (const auto& v = _object.*(iter->second); v) {
+                    return &*v;
+                }
+            }
+
+            return nullptr;
+        }
+
+    } // anonymous namespace
+
     server_properties& server_properties::instance() {
         static server_properties singleton;
         return singleton;
     }
 
-    server_properties::server_properties() {
+    server_properties::server_properties()
+        : config_props_{}
+        , snapshot_{}
+        , snapshots_{}
+    {
+        // Publish an empty snapshot so that snapshot() never returns a null reference,
+        // even if capturing the configuration fails.
+        snapshots_.push_back(std::make_unique<const server_config_snapshot>());
+        snapshot_.store(snapshots_.back().get(), std::memory_order_release);
+
         capture();
     } // ctor
 
@@ -58,6 +185,10 @@ namespace irods {
     void server_properties::capture_json(
         const std::string& _fn ) {
         error ret = config_props_.load( _fn );
+
+        // The file may have been partially merged into the map.
+        refresh_snapshot();
+
         if ( !ret.ok() ) {
             THROW( ret.code(), ret.result() );
         }
@@ -66,6 +197,51 @@ namespace irods {
 
     void server_properties::remove( const std::string& _key ) {
         config_props_.remove( _key );
+        refresh_snapshot_if_needed( _key );
+    }
+
+    void server_properties::refresh_snapshot() {
+        snapshots_.push_back(make_snapshot(config_props_.map()));
+        snapshot_.store(snapshots_.back().get(), std::memory_order_release);
+    } // refresh_snapshot
+
+    void server_properties::refresh_snapshot_if_needed( const std::string& _key ) {
+        if ( _key == CFG_ADVANCED_SETTINGS_KW ||
+             _key == CFG_LOG_LEVEL_KW ||
+             int_properties().count( _key ) > 0 ||
+             string_properties().count( _key ) > 0 ) {
+            refresh_snapshot();
+        }
+    } // refresh_snapshot_if_needed
+
+    template <>
+    auto server_properties::snapshot_property<int>( const std::string& _key ) const noexcept -> const int* {
+        return find_value( int_properties(), snapshot(), _key );
+    }
+
+    template <>
+    auto server_properties::snapshot_property<bool>( const std::string& ) const noexcept -> const bool* {
+        return nullptr;
+    }
+
+    template <>
+    auto server_properties::snapshot_property<std::string>( const std::string& _key ) const noexcept -> const std::string* {
+        return find_value( string_properties(), snapshot(), _key );
+    }
+
+    template <>
+    auto server_properties::snapshot_advanced_setting<int>( const std::string& _key ) const noexcept -> const int* {
+        return find_value( advanced_int_settings(), snapshot().advanced_settings, _key );
+    }
+
+    template <>
+    auto server_properties::snapshot_advanced_setting<bool>( const std::string& _key ) const noexcept -> const bool* {
+        return find_value( advanced_bool_settings(), snapshot().advanced_settings, _key );
+    }
+
+    template <>
+    auto server_properties::snapshot_advanced_setting<std::string>( const std::string& ) const noexcept -> const std::string* {
+        return nullptr;
     }
 
     void delete_server_property( const std::string& _prop ) {
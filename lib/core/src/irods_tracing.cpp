@@ -0,0 +1,568 @@
+#include "irods_tracing.hpp"
+
+#include "irods_random.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <system_error>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace irods::experimental::tracing
+{
+    struct detail::span_data
+    {
+        trace_context context;
+        std::uint64_t parent_span_id = 0;
+        std::string name;
+        span_kind kind = span_kind::internal;
+        std::chrono::system_clock::time_point start;
+        std::chrono::system_clock::time_point end;
+        std::vector<std::pair<std::string, std::variant<std::string, std::int64_t>>> attributes;
+        std::optional<std::string> error;
+    }; // struct detail::span_data
+
+    namespace
+    {
+        // The number of spans buffered before they are written.
+        constexpr std::size_t max_pending_spans = 64;
+
+        // Statement texts and similar attributes are cut to this size.
+        constexpr std::size_t max_attribute_size = 2048;
+
+        struct tracer
+        {
+            std::mutex mutex;
+            int fd = -1;
+            std::string service_name;
+            std::string host_name;
+            std::vector<detail::span_data> pending;
+            std::string line;
+        }; // struct tracer
+
+        std::atomic<bool> g_enabled{false};
+
+        // A trace is sampled if the low 64 bits of its ID are below the threshold.
+        std::atomic<std::uint64_t> g_sampling_threshold{0};
+
+        // Never destroyed, so that spans ending during static destruction are safe.
+        tracer& g_tracer = *new tracer;
+
+        trace_context g_remote_parent;
+
+        thread_local span* t_current_span = nullptr;
+
+        auto to_hex(const std::uint8_t* _bytes, std::size_t _size) -> std::string
+        {
+            constexpr char digits[] = "0123456789abcdef";
+
+            std::string s(_size * 2, '0');
+
+            for (std::size_t i = 0; i < _size; ++i) {
+                s[i * 2] = digits[_bytes[i] >> 4];
+                s[i * 2 + 1] = digits[_bytes[i] & 0xf];
+            }
+
+            return s;
+        }
+
+        auto to_hex(std::uint64_t _value) -> std::string
+        {
+            std::uint8_t bytes[8];
+
+            for (int i = 7; i >= 0; --i, _value >>= 8) {
+                bytes[i] = _value & 0xff;
+            }
+
+            return to_hex(bytes, sizeof(bytes));
+        }
+
+        auto from_hex(std::string_view _s, std::uint8_t* _bytes) noexcept -> bool
+        {
+            const auto nibble = [](char _c) -> int {
+                if (_c >= '0' && _c <= '9') { return _c - '0'; }
+                if (_c >= 'a' && _c <= 'f') { return _c - 'a' + 10; }
+                return -1;
+            };
+
+            for (std::size_t i = 0; i < _s.size() / 2; ++i) {
+                const auto hi = nibble(_s[i * 2]);
+                const auto lo = nibble(_s[i * 2 + 1]);
+
+                if (hi < 0 || lo < 0) {
+                    return false;
+                }
+
+                _bytes[i] = static_cast<std::uint8_t>(hi << 4 | lo);
+            }
+
+            return true;
+        }
+
+        // Incremented in forked children so that they do not repeat the IDs of their parent.
+        std::atomic<unsigned> g_fork_generation{0};
+
+        // IDs only need to be unique, so a fast generator seeded from the system's
+        // secure source is used instead of drawing every ID from that source.
+        auto random_u64() -> std::uint64_t
+        {
+            thread_local std::mt19937_64 engine;
+            thread_local bool seeded = false;
+            thread_local unsigned generation = 0;
+
+            if (const auto g = g_fork_generation.load(std::memory_order_relaxed); !seeded || g != generation) {
+                engine.seed(irods::getRandom<std::uint64_t>());
+                seeded = true;
+                generation = g;
+            }
+
+            return engine();
+        }
+
+        auto new_span_id() -> std::uint64_t
+        {
+            std::uint64_t id = 0;
+
+            while (0 == id) {
+                id = random_u64();
+            }
+
+            return id;
+        }
+
+        auto append_json_string(std::string& _out, std::string_view _s) -> void
+        {
+            constexpr char digits[] = "0123456789abcdef";
+
+            _out += '"';
+
+            for (const char c : _s) {
+                switch (c) {
+                    case '"':  _out += "\\\""; break;
+                    case '\\': _out += "\\\\"; break;
+                    case '\n': _out += "\\n"; break;
+                    case '\r': _out += "\\r"; break;
+                    case '\t': _out += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            _out += "\\u00";
+                            _out += digits[c >> 4];
+                            _out += digits[c & 0xf];
+                        }
+                        else {
+                            _out += c;
+                        }
+                }
+            }
+
+            _out += '"';
+        }
+
+        auto append_string_attribute(std::string& _out, std::string_view _key, std::string_view _value) -> void
+        {
+            _out += R"_({"key":)_";
+            append_json_string(_out, _key);
+            _out += R"_(,"value":{"stringValue":)_";
+            append_json_string(_out, _value);
+            _out += "}}";
+        }
+
+        auto append_int_attribute(std::string& _out, std::string_view _key, std::int64_t _value) -> void
+        {
+            // OTLP/JSON encodes 64-bit integers as strings.
+            _out += R"_({"key":)_";
+            append_json_string(_out, _key);
+            _out += R"_(,"value":{"intValue":")_";
+            _out += std::to_string(_value);
+            _out += "\"}}";
+        }
+
+        auto append_otlp_json(std::string& _out, const detail::span_data& _span) -> void
+        {
+            const auto nanoseconds = [](auto _tp) {
+                return std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(_tp.time_since_epoch()).count());
+            };
+
+            _out += R"_({"traceId":")_";
+            _out += to_hex(_span.context.trace_id.data(), _span.context.trace_id.size());
+            _out += R"_(","spanId":")_";
+            _out += to_hex(_span.context.span_id);
+
+            if (0 != _span.parent_span_id) {
+                _out += R"_(","parentSpanId":")_";
+                _out += to_hex(_span.parent_span_id);
+            }
+
+            _out += R"_(","name":)_";
+            append_json_string(_out, _span.name);
+            _out += R"_(,"kind":)_";
+            _out += std::to_string(static_cast<int>(_span.kind));
+            _out += R"_(,"startTimeUnixNano":")_";
+            _out += nanoseconds(_span.start);
+            _out += R"_(","endTimeUnixNano":")_";
+            _out += nanoseconds(_span.end);
+            _out += R"_(","attributes":[)_";
+
+            for (std::size_t i = 0; i < _span.attributes.size(); ++i) {
+                const auto& [key, value] = _span.attributes[i];
+
+                if (i > 0) {
+                    _out += ',';
+                }
+
+                if (const auto* s = std::get_if<std::string>(&value); s) {
+                    append_string_attribute(_out, key, *s);
+                }
+                else {
+                    append_int_attribute(_out, key, std::get<std::int64_t>(value));
+                }
+            }
+
+            _out += ']';
+
+            if (_span.error) {
+                _out += R"_(,"status":{"code":2,"message":)_";
+                append_json_string(_out, *_span.error);
+                _out += '}';
+            }
+
+            _out += '}';
+        }
+
+        // Requires g_tracer.mutex to be held.
+        auto write_pending_spans() noexcept -> void
+        {
+            if (g_tracer.pending.empty()) {
+                return;
+            }
+
+            try {
+                // One ExportTraceServiceRequest in the OTLP/JSON format.
+                auto& line = g_tracer.line;
+                line.clear();
+
+                line += R"_({"resourceSpans":[{"resource":{"attributes":[)_";
+                append_string_attribute(line, "service.name", g_tracer.service_name);
+                line += ',';
+                append_string_attribute(line, "host.name", g_tracer.host_name);
+                line += ',';
+                append_int_attribute(line, "process.pid", getpid());
+                line += R"_(]},"scopeSpans":[{"scope":{"name":"irods"},"spans":[)_";
+
+                for (std::size_t i = 0; i < g_tracer.pending.size(); ++i) {
+                    if (i > 0) {
+                        line += ',';
+                    }
+
+                    append_otlp_json(line, g_tracer.pending[i]);
+                }
+
+                line += "]}]}]}\n";
+
+                // A single write per batch keeps the lines of different processes apart.
+                const char* p = line.data();
+                auto remaining = line.size();
+
+                while (remaining > 0) {
+                    const auto n = write(g_tracer.fd, p, remaining);
+
+                    if (n < 0) {
+                        if (EINTR == errno) {
+                            continue;
+                        }
+
+                        break;
+                    }
+
+                    p += n;
+                    remaining -= n;
+                }
+            }
+            catch (...) {
+                // Tracing must never interfere with the traced work.
+            }
+
+            g_tracer.pending.clear();
+        }
+
+        auto export_span(detail::span_data&& _span) -> void
+        {
+            std::lock_guard lock{g_tracer.mutex};
+
+            g_tracer.pending.push_back(std::move(_span));
+
+            if (g_tracer.pending.size() >= max_pending_spans) {
+                write_pending_spans();
+            }
+        }
+
+        auto prepare_fork() -> void
+        {
+            g_tracer.mutex.lock();
+        }
+
+        auto after_fork_in_parent() -> void
+        {
+            g_tracer.mutex.unlock();
+        }
+
+        auto after_fork_in_child() -> void
+        {
+            // The spans belong to the parent, which writes them.
+            g_tracer.pending.clear();
+            g_fork_generation.fetch_add(1);
+            g_tracer.mutex.unlock();
+        }
+    } // anonymous namespace
+
+    auto to_traceparent(const trace_context& _ctx) -> std::string
+    {
+        return "00-" + to_hex(_ctx.trace_id.data(), _ctx.trace_id.size()) + '-' + to_hex(_ctx.span_id) +
+               (_ctx.sampled ? "-01" : "-00");
+    }
+
+    auto from_traceparent(std::string_view _value) noexcept -> std::optional<trace_context>
+    {
+        // "vv-<32 hex digits>-<16 hex digits>-ff"
+        constexpr std::size_t size = 55;
+
+        if (_value.size() < size || '-' != _value[2] || '-' != _value[35] || '-' != _value[52]) {
+            return std::nullopt;
+        }
+
+        // Version 00 is the only one defined and ff is forbidden. Later versions may only
+        // append fields, so their prefix is parsed the same way.
+        std::uint8_t version;
+        std::uint8_t flags;
+        std::uint8_t span_id[8];
+        trace_context ctx;
+
+        if (!from_hex(_value.substr(0, 2), &version) || 0xff == version ||
+            (0 == version && _value.size() != size) ||
+            !from_hex(_value.substr(3, 32), ctx.trace_id.data()) ||
+            !from_hex(_value.substr(36, 16), span_id) ||
+            !from_hex(_value.substr(53, 2), &flags))
+        {
+            return std::nullopt;
+        }
+
+        for (auto b : span_id) {
+            ctx.span_id = ctx.span_id << 8 | b;
+        }
+
+        const auto zero = [](auto _b) { return 0 == _b; };
+
+        if (std::all_of(std::begin(ctx.trace_id), std::end(ctx.trace_id), zero) || 0 == ctx.span_id) {
+            return std::nullopt;
+        }
+
+        ctx.sampled = flags & 0x01;
+
+        return ctx;
+    }
+
+    auto to_startup_pack_option(const trace_context& _ctx) -> std::string
+    {
+        return std::string{startup_pack_option_key} + to_traceparent(_ctx);
+    }
+
+    auto extract_from_startup_pack_option(std::string& _option) -> std::optional<trace_context>
+    {
+        constexpr std::size_t traceparent_size = 55;
+
+        const auto pos = _option.find(startup_pack_option_key);
+
+        if (std::string::npos == pos) {
+            return std::nullopt;
+        }
+
+        const auto value = std::string_view{_option}.substr(pos + startup_pack_option_key.size(), traceparent_size);
+        const auto ctx = from_traceparent(value);
+
+        if (ctx) {
+            _option.erase(pos, startup_pack_option_key.size() + traceparent_size);
+        }
+
+        return ctx;
+    }
+
+    auto init(const config& _config) -> void
+    {
+        const int fd = open(_config.file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640);
+
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category(), "tracing: cannot open [" + _config.file + ']'};
+        }
+
+        char host_name[256]{};
+        gethostname(host_name, sizeof(host_name) - 1);
+
+        {
+            std::lock_guard lock{g_tracer.mutex};
+
+            if (g_tracer.fd >= 0) {
+                write_pending_spans();
+                close(g_tracer.fd);
+            }
+
+            g_tracer.fd = fd;
+            g_tracer.service_name = _config.service_name;
+            g_tracer.host_name = host_name;
+        }
+
+        const auto ratio = std::clamp(_config.sampling_ratio, 0.0, 1.0);
+        g_sampling_threshold.store(ratio >= 1.0
+            ? std::numeric_limits<std::uint64_t>::max()
+            : static_cast<std::uint64_t>(ratio * static_cast<double>(std::numeric_limits<std::uint64_t>::max())));
+
+        static const bool registered = [] {
+            pthread_atfork(prepare_fork, after_fork_in_parent, after_fork_in_child);
+            std::atexit([] { flush(); });
+            return true;
+        }();
+        static_cast<void>(registered);
+
+        g_enabled.store(true);
+    }
+
+    auto enabled() noexcept -> bool
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    auto flush() noexcept -> void
+    {
+        std::lock_guard lock{g_tracer.mutex};
+        write_pending_spans();
+    }
+
+    auto set_remote_parent(const trace_context& _ctx) noexcept -> void
+    {
+        g_remote_parent = _ctx;
+    }
+
+    auto current() noexcept -> std::optional<trace_context>
+    {
+        if (t_current_span) {
+            return t_current_span->data_->context;
+        }
+
+        if (0 != g_remote_parent.span_id) {
+            return g_remote_parent;
+        }
+
+        return std::nullopt;
+    }
+
+    span::span(std::string_view _name, span_kind _kind)
+        : data_{}
+        , parent_{}
+    {
+        if (!enabled()) {
+            return;
+        }
+
+        const trace_context parent = t_current_span ? t_current_span->data_->context : g_remote_parent;
+        trace_context ctx;
+
+        if (0 != parent.span_id) {
+            if (!parent.sampled) {
+                return;
+            }
+
+            ctx.trace_id = parent.trace_id;
+        }
+        else {
+            const auto threshold = g_sampling_threshold.load(std::memory_order_relaxed);
+
+            if (0 == threshold) {
+                return;
+            }
+
+            const auto high_bits = random_u64();
+            const auto low_bits = random_u64();
+
+            for (int i = 0; i < 8; ++i) {
+                ctx.trace_id[i] = (high_bits >> (56 - 8 * i)) & 0xff;
+                ctx.trace_id[8 + i] = (low_bits >> (56 - 8 * i)) & 0xff;
+            }
+
+            if (low_bits >= threshold && threshold != std::numeric_limits<std::uint64_t>::max()) {
+                return;
+            }
+        }
+
+        ctx.span_id = new_span_id();
+        ctx.sampled = true;
+
+        data_ = std::make_unique<detail::span_data>();
+        data_->context = ctx;
+        data_->parent_span_id = parent.span_id;
+        data_->name = _name;
+        data_->kind = _kind;
+        data_->start = std::chrono::system_clock::now();
+
+        parent_ = t_current_span;
+        t_current_span = this;
+    }
+
+    span::~span()
+    {
+        if (!data_) {
+            return;
+        }
+
+        data_->end = std::chrono::system_clock::now();
+        t_current_span = parent_;
+
+        try {
+            export_span(std::move(*data_));
+        }
+        catch (...) {
+        }
+    }
+
+    auto span::recording() const noexcept -> bool
+    {
+        return static_cast<bool>(data_);
+    }
+
+    auto span::set_name(std::string_view _name) -> void
+    {
+        if (data_) {
+            data_->name = _name;
+        }
+    }
+
+    auto span::set_attribute(std::string_view _key, std::string_view _value) -> void
+    {
+        if (data_) {
+            data_->attributes.emplace_back(_key, std::string{_value.substr(0, max_attribute_size)});
+        }
+    }
+
+    auto span::set_attribute(std::string_view _key, std::int64_t _value) -> void
+    {
+        if (data_) {
+            data_->attributes.emplace_back(_key, _value);
+        }
+    }
+
+    auto span::set_error(std::string_view _message) -> void
+    {
+        if (data_) {
+            data_->error = std::string{_message.substr(0, max_attribute_size)};
+        }
+    }
+} // namespace irods::experimental::tracing
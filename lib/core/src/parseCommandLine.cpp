@@ -304,6 +304,25 @@ parseCmdLineOpt( int argc, char **argv, const char *optString, int includeLong,
                     argv[i + 1] = "-Z";
                 }
             }
+
+            if ( strcmp( "--concurrent-files", argv[i] ) == 0 ) {
+                rodsArgs->concurrentFiles = True;
+                argv[i] = "-Z";
+                if ( i + 2 <= argc ) {
+                    if ( *argv[i + 1] == '-' ) {
+                        rodsLog( LOG_ERROR,
+                                 "--concurrent-files option needs a number of files" );
+                        return USER_INPUT_OPTION_ERR;
+                    }
+                    rodsArgs->concurrentFilesValue = atoi( argv[i + 1] );
+                    argv[i + 1] = "-Z";
+                }
+            }
+
+            if ( strcmp( "--stripe-replicas", argv[i] ) == 0 ) {
+                rodsArgs->stripeReplicas = True;
+                argv[i] = "-Z";
+            }
         }
     }
 
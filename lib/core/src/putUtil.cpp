@@ -18,12 +18,20 @@
 #include "irods_exception.hpp"
 #include "irods_random.hpp"
 #include "irods_log.hpp"
+#include "concurrent_transfer_scheduler.hpp"
 
 #include "sockComm.h"
 #include <boost/filesystem/operations.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem/convenience.hpp>
 
+#include <memory>
+
+static int
+putDirUtilImpl( rcComm_t **myConn, char *srcDir, char *targColl,
+                rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+                bulkOprInp_t *bulkOprInp, rodsRestart_t *rodsRestart,
+                bulkOprInfo_t *bulkOprInfo, irods::concurrent_transfer_scheduler *scheduler );
 
 /* checkStateForResume - check the state for resume operation
  * return 0 - skip
@@ -293,6 +301,31 @@ putUtil( rcComm_t **myConn, rodsEnv *myRodsEnv,
                                          myRodsEnv, myRodsArgs, &dataObjOprInp, &bulkOprInp,
                                          &rodsRestart );
             }
+            else if ( myRodsArgs->concurrentFiles == True && myRodsArgs->concurrentFilesValue > 1 ) {
+                std::unique_ptr<irods::concurrent_transfer_scheduler> scheduler;
+                try {
+                    scheduler = std::make_unique<irods::concurrent_transfer_scheduler>(
+                        myRodsArgs->concurrentFilesValue, *myRodsEnv, rodsRestart );
+                }
+                catch ( const std::exception& e ) {
+                    rodsLog( LOG_ERROR, "putUtil: could not start concurrent transfers: %s", e.what() );
+                    return SYS_INTERNAL_ERR;
+                }
+                status = putDirUtilImpl( myConn, rodsPathInp->srcPath[i].outPath,
+                                         targPath->outPath, myRodsEnv, myRodsArgs, &dataObjOprInp,
+                                         &bulkOprInp, &rodsRestart, NULL, scheduler.get() );
+                const int transferStatus = scheduler->wait();
+                if ( status >= 0 && transferStatus < 0 ) {
+                    status = transferStatus;
+                }
+                if ( myRodsArgs->verbose == True ) {
+                    scheduler->print_summary();
+                }
+                if (status == USER_INPUT_PATH_ERR || status == SYS_INVALID_INPUT_PARAM)
+                {
+                    return status;
+                }
+            }
             else {
                 status = putDirUtil( myConn, rodsPathInp->srcPath[i].outPath,
                                      targPath->outPath, myRodsEnv, myRodsArgs, &dataObjOprInp,
@@ -709,6 +742,20 @@ putDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
             rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
             bulkOprInp_t *bulkOprInp, rodsRestart_t *rodsRestart,
             bulkOprInfo_t *bulkOprInfo )
+{
+    return putDirUtilImpl( myConn, srcDir, targColl, myRodsEnv, rodsArgs, dataObjOprInp,
+                           bulkOprInp, rodsRestart, bulkOprInfo, NULL );
+}
+
+/* putDirUtilImpl - when a scheduler is given, regular files are handed to it
+ * and transferred concurrently over pooled connections. Collections are still
+ * created in order on myConn so that they exist before any of their children
+ * are transferred. */
+static int
+putDirUtilImpl( rcComm_t **myConn, char *srcDir, char *targColl,
+                rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+                bulkOprInp_t *bulkOprInp, rodsRestart_t *rodsRestart,
+                bulkOprInfo_t *bulkOprInfo, irods::concurrent_transfer_scheduler *scheduler )
 {
     namespace fs = boost::filesystem;
 
@@ -846,6 +893,8 @@ putDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
                 }
             }
 
+            const bool wasResumed = ( rodsRestart->restartState & OPR_RESUMED ) != 0;
+
             status = chkStateForResume( conn, rodsRestart, targChildPath,
                                             rodsArgs, childObjType, &dataObjOprInp->condInput, 1 );
 
@@ -854,6 +903,11 @@ putDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
                 return status;
             }
 
+            if ( scheduler != NULL && !wasResumed &&
+                    ( rodsRestart->restartState & OPR_RESUMED ) != 0 ) {
+                scheduler->resumed();
+            }
+
             if ( status == 0 ) {
                 if ( bulkFlag == BULK_OPR_SMALL_FILES &&
                         ( rodsRestart->restartState & LAST_PATH_MATCHED ) != 0 ) {
@@ -869,6 +923,42 @@ putDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
                                             dataSize,  dataObjOprInp->createMode, rodsArgs,
                                             bulkOprInp, bulkOprInfo );
                 }
+                else if ( scheduler != NULL ) {
+                    /* concurrent put. the restart file is written by the scheduler */
+                    auto childInp = irods::clone_data_object_input( *dataObjOprInp );
+                    if ( scheduler->overwrite_required() ) {
+                        addKeyVal( &childInp->condInput, FORCE_FLAG_KW, "" );
+                    }
+                    std::string srcFile = srcChildPath;
+                    std::string targFile = targChildPath;
+                    status = scheduler->submit( targFile, dataSize,
+                        [=]( rcComm_t& _conn ) mutable {
+                            int ec = 0;
+                            if ( rodsArgs->ticket == True ) {
+                                /* pooled connections do not share the session ticket */
+                                setSessionTicket( &_conn, rodsArgs->ticketString );
+                            }
+                            try {
+                                ec = putFileUtil( &_conn, srcFile.data(), targFile.data(),
+                                                  dataSize, rodsArgs, childInp.get() );
+                            } catch ( const fs::filesystem_error& e ) {
+                                rodsLog( LOG_ERROR, e.what() );
+                                ec = e.code().value();
+                            }
+                            if ( ec == CAT_NO_ROWS_FOUND ) {
+                                return 0;
+                            }
+                            if ( ec < 0 ) {
+                                rodsLogError( LOG_ERROR, ec, "putDirUtil: put %s failed. status = %d", srcFile.c_str(), ec );
+                            }
+                            return ec;
+                        } );
+                    if ( status < 0 ) {
+                        /* a previous transfer failed and was reported */
+                        return status;
+                    }
+                    continue;
+                }
                 else {
                     /* normal put */
                     try {
@@ -906,9 +996,9 @@ putDirUtil( rcComm_t **myConn, char *srcDir, char *targColl,
                         return status;
                     }
                 }
-                status = putDirUtil( myConn, srcChildPath, targChildPath,
-                                    myRodsEnv, rodsArgs, dataObjOprInp, bulkOprInp,
-                                    rodsRestart, bulkOprInfo );
+                status = putDirUtilImpl( myConn, srcChildPath, targChildPath,
+                                        myRodsEnv, rodsArgs, dataObjOprInp, bulkOprInp,
+                                        rodsRestart, bulkOprInfo, scheduler );
 
             }
 
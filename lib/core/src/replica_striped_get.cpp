@@ -0,0 +1,174 @@
+#include "replica_striped_get.hpp"
+
+#include "irods_query.hpp"
+#include "objInfo.h"
+#include "parallel_transfer_engine.hpp"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "stream_factory_utility.hpp"
+#include "stringOpr.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <unordered_set>
+
+namespace irods
+{
+    namespace
+    {
+        namespace io = irods::experimental::io;
+
+        // Each replica serves this many ranges unless the user asks otherwise.
+        constexpr int default_channels_per_source = 2;
+
+        constexpr int max_stripe_channels = 16;
+
+        constexpr std::int64_t stripe_buffer_size = 4 * 1024 * 1024;
+    } // anonymous namespace
+
+    std::vector<stripe_source> select_stripe_sources(std::vector<replica_location> _replicas)
+    {
+        std::sort(std::begin(_replicas), std::end(_replicas), [](const auto& _lhs, const auto& _rhs) {
+            return _lhs.replica_number < _rhs.replica_number;
+        });
+
+        std::vector<stripe_source> sources;
+        std::unordered_set<std::string> hosts;
+
+        for (auto&& r : _replicas) {
+            if (GOOD_REPLICA != r.status || r.host.empty() || "EMPTY_RESC_HOST" == r.host) {
+                continue;
+            }
+
+            if (hosts.insert(r.host).second) {
+                sources.push_back({r.replica_number, std::move(r.host)});
+            }
+        }
+
+        return sources;
+    }
+
+    std::vector<stripe_source> select_stripe_sources(rcComm_t& _conn, const std::string& _logical_path)
+    {
+        char coll_name[MAX_NAME_LEN]{};
+        char data_name[MAX_NAME_LEN]{};
+
+        if (const auto ec = splitPathByKey(_logical_path.c_str(), coll_name, MAX_NAME_LEN, data_name, MAX_NAME_LEN, '/');
+            ec < 0)
+        {
+            THROW(ec, fmt::format("could not split path [{}]", _logical_path));
+        }
+
+        const auto gql = fmt::format("select DATA_REPL_NUM, DATA_REPL_STATUS, RESC_LOC "
+                                     "where COLL_NAME = '{}' and DATA_NAME = '{}'",
+                                     coll_name, data_name);
+
+        std::vector<replica_location> replicas;
+
+        for (auto&& row : query<rcComm_t>{&_conn, gql}) {
+            replicas.push_back({std::stoi(row[0]), std::stoi(row[1]), row[2]});
+        }
+
+        return select_stripe_sources(std::move(replicas));
+    }
+
+    int stripe_channel_count(std::size_t _number_of_sources, int _requested) noexcept
+    {
+        const auto channels = (_requested > 0)
+            ? _requested
+            : default_channels_per_source * static_cast<int>(_number_of_sources);
+
+        return std::clamp(channels, 1, max_stripe_channels);
+    }
+
+    int striped_get(const rodsEnv& _env,
+                    const std::string& _logical_path,
+                    const std::string& _local_path,
+                    rodsLong_t _size,
+                    const std::vector<stripe_source>& _sources,
+                    int _channels)
+    {
+        if (_sources.empty() || _channels < 1 || _channels > max_stripe_channels) {
+            return SYS_INVALID_INPUT_PARAM;
+        }
+
+        try {
+            // Channel i reads the i-th range of the object. Ranges are handed to the
+            // sources in turn so that neighbouring ranges come from different servers.
+            std::vector<std::size_t> channel_source(_channels);
+            std::vector<int> channels_per_source(_sources.size());
+
+            for (int i = 0; i < _channels; ++i) {
+                channel_source[i] = i % _sources.size();
+                ++channels_per_source[channel_source[i]];
+            }
+
+            // Every stream connects directly to the server hosting its replica so that
+            // the data does not pass through a single server.
+            std::vector<std::unique_ptr<connection_pool>> pools(_sources.size());
+
+            for (std::size_t i = 0; i < _sources.size(); ++i) {
+                if (channels_per_source[i] > 0) {
+                    pools[i] = std::make_unique<connection_pool>(channels_per_source[i],
+                                                                 _sources[i].host,
+                                                                 _env.rodsPort,
+                                                                 _env.rodsUserName,
+                                                                 _env.rodsZone,
+                                                                 _env.irodsConnectionPoolRefreshTime);
+                }
+            }
+
+            // The engine creates the source stream of each channel in order, starting
+            // with the first channel.
+            int next_channel = 0;
+
+            auto source_factory = [&](std::ios_base::openmode _mode, io::managed_dstream*) -> io::managed_dstream {
+                const auto source = channel_source.at(next_channel++);
+
+                io::managed_dstream d{pools[source]->get_connection()};
+                d.transport = std::make_unique<io::client::native_transport>(d.conn);
+                d.stream.open(*d.transport, _logical_path, io::replica_number{_sources[source].replica_number}, _mode);
+                d.rdbuf(d.stream.rdbuf());
+
+                if (!d.stream) {
+                    d.setstate(std::ios_base::failbit);
+                }
+
+                return d;
+            };
+
+            // Cannot use temporary builder with Clang right now.
+            // See clang bug 41450 for details.
+            io::parallel_transfer_engine_builder<io::managed_dstream, std::fstream> builder{
+                source_factory, io::make_fstream_factory(_local_path), io::close_stream<std::fstream>, _size};
+
+            auto transfer = builder.number_of_channels(static_cast<std::int16_t>(_channels))
+                                   .transfer_buffer_size(stripe_buffer_size)
+                                   .build();
+
+            transfer.wait();
+
+            if (!transfer.success()) {
+                for (auto&& [category, msg] : transfer.errors()) {
+                    rodsLog(LOG_ERROR, "striped_get: %s [category=%d]", msg.c_str(), static_cast<int>(category));
+                }
+
+                return SYS_COPY_LEN_ERR;
+            }
+        }
+        catch (const irods::exception& e) {
+            rodsLog(LOG_ERROR, "striped_get: %s", e.client_display_what());
+            return e.code();
+        }
+        catch (const std::exception& e) {
+            rodsLog(LOG_ERROR, "striped_get: %s", e.what());
+            return SYS_INTERNAL_ERR;
+        }
+
+        return 0;
+    }
+} // namespace irods
@@ -41,6 +41,7 @@ jmp_buf Jcenv;
 #include "irods_server_properties.hpp"
 #include "sockCommNetworkInterface.hpp"
 #include "irods_random.hpp"
+#include "irods_tracing.hpp"
 
 // =-=-=-=-=-=-=-
 //
@@ -1103,6 +1104,31 @@ sendStartupPack( rcComm_t *conn, int connectCnt, int reconnFlag ) {
         startupPack.option[0] = '\0';
     }
 
+    // =-=-=-=-=-=-=-
+    // propagate the trace context of the caller so that the spans recorded by
+    // the server become part of the same trace. clients which do not record
+    // spans may provide a context through the TRACEPARENT environment variable
+    {
+        namespace tracing = irods::experimental::tracing;
+
+        auto ctx = tracing::current();
+
+        if ( !ctx ) {
+            if ( const char* traceparent = getenv( "TRACEPARENT" ); traceparent ) {
+                ctx = tracing::from_traceparent( traceparent );
+            }
+        }
+
+        if ( ctx ) {
+            const auto token = tracing::to_startup_pack_option( *ctx );
+            const size_t opt_len = strlen( startupPack.option );
+
+            if ( opt_len + token.size() < sizeof( startupPack.option ) ) {
+                rstrcpy( startupPack.option + opt_len, token.c_str(), sizeof( startupPack.option ) - opt_len );
+            }
+        }
+    }
+
     // =-=-=-=-=-=-=-
     // if the advanced negotiation is requested from the irodsEnv,
     // tack those results onto the startup pack option string
@@ -14,6 +14,7 @@ namespace irods::experimental::filesystem
     {
         class collection_iterator;
         class recursive_collection_iterator;
+        class parallel_recursive_collection_iterator;
     } // namespace NAMESPACE_IMPL
 
     class collection_entry
@@ -50,6 +51,7 @@ namespace irods::experimental::filesystem
     private:
         friend class NAMESPACE_IMPL::collection_iterator;
         friend class NAMESPACE_IMPL::recursive_collection_iterator;
+        friend class NAMESPACE_IMPL::parallel_recursive_collection_iterator;
 
         mutable class path path_;
         mutable object_status status_;
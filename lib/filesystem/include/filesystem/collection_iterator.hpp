@@ -10,9 +10,13 @@
     #include "miscUtil.h"
 #endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
 
+#include <deque>
+#include <future>
 #include <iterator>
 #include <memory>
 
+struct CollEnt;
+
 namespace irods::experimental::filesystem::NAMESPACE_IMPL
 {
     enum class collection_options
@@ -40,6 +44,17 @@ namespace irods::experimental::filesystem::NAMESPACE_IMPL
                             const path& _p,
                             collection_options _opts = collection_options::none);
 
+#ifndef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+        // Reads the entries over _read_ahead_comm, one batch ahead of the caller, so
+        // that the round trips overlap with the caller's work. _comm stays free for the
+        // caller's own requests. _read_ahead_comm must not be used for anything else
+        // until the iterator and all of its copies are destroyed.
+        collection_iterator(rxComm& _comm,
+                            rxComm& _read_ahead_comm,
+                            const path& _p,
+                            collection_options _opts = collection_options::none);
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+
         collection_iterator(const collection_iterator& _other) = default;
         auto operator=(const collection_iterator& _other) -> collection_iterator& = default;
 
@@ -69,18 +84,50 @@ namespace irods::experimental::filesystem::NAMESPACE_IMPL
         // clang-format on
 
     private:
+#ifndef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+        struct next_batch
+        {
+            std::deque<value_type> entries;
+            int error_code{};
+        };
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+
         struct context
         {
             rxComm* comm{};
             path path{};
-#ifdef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
             int handle{};
-#else
-            collHandle_t handle{};
-#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
             value_type entry{};
+#ifndef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+            // Entries received from the server but not yet visited.
+            std::deque<value_type> batch{};
+            bool end_of_collection{};
+            bool batching_supported = true;
+            // The connection the collection is open on. Differs from comm only when
+            // reading ahead.
+            rxComm* read_comm{};
+            bool read_ahead{};
+            std::future<next_batch> next{};
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
         };
 
+        static auto set_entry(value_type& _entry, const path& _parent, const CollEnt& _e) -> void;
+
+        // Opens the collection and points to its first entry.
+        auto open_collection() -> void;
+
+#ifndef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+        // Appends up to _max_entries entries to _entries.
+        // Returns CAT_NO_ROWS_FOUND once the end of the collection is reached.
+        static auto read_batch(rxComm& _comm,
+                               int _handle,
+                               int _max_entries,
+                               const path& _parent,
+                               std::deque<value_type>& _entries) -> int;
+
+        auto read_next_batch() -> void;
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+
         std::shared_ptr<context> ctx_;
     };
 
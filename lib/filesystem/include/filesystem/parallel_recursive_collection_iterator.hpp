@@ -0,0 +1,136 @@
+#ifndef IRODS_FILESYSTEM_PARALLEL_RECURSIVE_COLLECTION_ITERATOR_HPP
+#define IRODS_FILESYSTEM_PARALLEL_RECURSIVE_COLLECTION_ITERATOR_HPP
+
+/// \file
+
+#ifdef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+    #error "parallel_recursive_collection_iterator is only available to clients."
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+
+#include "filesystem/config.hpp"
+#include "filesystem/collection_entry.hpp"
+#include "filesystem/path.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace irods
+{
+    class connection_pool;
+} // namespace irods
+
+namespace irods::experimental::filesystem::NAMESPACE_IMPL
+{
+    /// Defines how a parallel_recursive_collection_iterator discovers entries.
+    ///
+    /// \since 4.3.0
+    enum class traversal_mode
+    {
+        /// Subcollections are opened concurrently, one per worker connection.
+        parallel,
+
+        /// The whole subtree is fetched through GenQuery, streamed one page at a time.
+        ///
+        /// This avoids one open/read/close cycle per collection and is the fastest mode
+        /// for administrators, for whom the catalog does not apply permission checks.
+        single_query
+    }; // enum class traversal_mode
+
+    /// \since 4.3.0
+    struct parallel_traversal_options
+    {
+        traversal_mode mode = traversal_mode::parallel;
+
+        /// The number of collections read concurrently in parallel mode. Each one holds
+        /// a connection from the pool for the lifetime of the iterator, so the pool
+        /// must have at least this many connections available.
+        int max_open_collections = 4;
+
+        /// The maximum number of entries buffered ahead of the caller. Workers pause
+        /// once the buffer is full.
+        std::size_t max_buffered_entries = 16 * 1024;
+    }; // struct parallel_traversal_options
+
+    /// An input iterator that visits every entry below a collection using several
+    /// connections at once.
+    ///
+    /// Unlike recursive_collection_iterator, entries are produced in no particular
+    /// order (roughly breadth-first) and there is no notion of depth, so recursion
+    /// cannot be controlled while iterating. Entries are yielded as soon as any worker
+    /// produces them. Errors raised by a worker are rethrown by operator++.
+    ///
+    /// \since 4.3.0
+    class parallel_recursive_collection_iterator
+    {
+    public:
+        // clang-format off
+        using value_type        = collection_entry;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const value_type*;
+        using reference         = const value_type&;
+        using iterator_category = std::input_iterator_tag;
+        // clang-format on
+
+        // Constructors and destructor
+
+        parallel_recursive_collection_iterator() = default;
+
+        /// \param[in] _pool The connections used by the workers. Must outlive the iterator.
+        /// \param[in] _p    The collection to traverse.
+        /// \param[in] _opts Controls how the traversal is carried out.
+        parallel_recursive_collection_iterator(connection_pool& _pool,
+                                               const path& _p,
+                                               const parallel_traversal_options& _opts = {});
+
+        parallel_recursive_collection_iterator(const parallel_recursive_collection_iterator& _other) = default;
+        auto operator=(const parallel_recursive_collection_iterator& _other) -> parallel_recursive_collection_iterator& = default;
+
+        parallel_recursive_collection_iterator(parallel_recursive_collection_iterator&& _other) = default;
+        auto operator=(parallel_recursive_collection_iterator&& _other) -> parallel_recursive_collection_iterator& = default;
+
+        ~parallel_recursive_collection_iterator() = default;
+
+        // Observers
+
+        auto operator*() const -> reference;
+        auto operator->() const -> pointer;
+
+        // Modifiers
+
+        auto operator++() -> parallel_recursive_collection_iterator&;
+
+        // Compare
+
+        // clang-format off
+        auto operator==(const parallel_recursive_collection_iterator& _rhs) const noexcept -> bool { return _rhs.ctx_ == ctx_; }
+        auto operator!=(const parallel_recursive_collection_iterator& _rhs) const noexcept -> bool { return !(*this == _rhs); }
+        // clang-format on
+
+    private:
+        struct context;
+
+        static auto read_collections(context& _ctx) -> void;
+        static auto read_subtree(context& _ctx) -> void;
+        static auto make_collection_entry(const std::vector<std::string>& _row) -> value_type;
+        static auto make_data_object_entry(const std::vector<std::string>& _row) -> value_type;
+
+        std::shared_ptr<context> ctx_;
+    }; // class parallel_recursive_collection_iterator
+
+    // Enables support for range-based for-loops.
+
+    inline auto begin(parallel_recursive_collection_iterator _iter) noexcept -> parallel_recursive_collection_iterator
+    {
+        return _iter;
+    }
+
+    inline auto end(const parallel_recursive_collection_iterator&) noexcept -> const parallel_recursive_collection_iterator
+    {
+        return {};
+    }
+} // namespace irods::experimental::filesystem::NAMESPACE_IMPL
+
+#endif // IRODS_FILESYSTEM_PARALLEL_RECURSIVE_COLLECTION_ITERATOR_HPP
@@ -7,49 +7,66 @@
     #include "rsOpenCollection.hpp"
     #include "rsReadCollection.hpp"
     #include "rsCloseCollection.hpp"
+#else
+    #include "openCollection.h"
+    #include "readCollection.h"
+    #include "closeCollection.h"
+    #include "read_collection_batch.h"
+
+    #include "json.hpp"
 #endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
 
 #include "irods_at_scope_exit.hpp"
+#include "rodsErrorTable.h"
 
 #include <functional>
+#include <future>
 #include <string>
 #include <cassert>
 
 namespace irods::experimental::filesystem::NAMESPACE_IMPL
 {
+    namespace
+    {
+        // The number of entries requested per round trip.
+        constexpr int batch_size = 512;
+    } // anonymous namespace
+
     collection_iterator::collection_iterator(rxComm& _comm,
                                              const path& _p,
                                              collection_options _opts)
         : ctx_{}
     {
         detail::throw_if_path_length_exceeds_limit(_p);
-    
+
         ctx_ = std::make_shared<context>();
         ctx_->comm = &_comm;
         ctx_->path = _p;
+#ifndef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+        ctx_->read_comm = &_comm;
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
 
-#ifdef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
-        assert(ctx_->handle == 0);
-
-        collInp_t input{};
-        std::strncpy(input.collName, _p.c_str(), _p.string().size());
-
-        ctx_->handle = rsOpenCollection(&_comm, &input);
+        open_collection();
+    }
 
-        if (ctx_->handle < 0) {
-            throw filesystem_error{"could not open collection for reading", detail::make_error_code(ctx_->handle)};
-        }
-#else
-        const auto no_flags = 0;
+#ifndef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+    collection_iterator::collection_iterator(rxComm& _comm,
+                                             rxComm& _read_ahead_comm,
+                                             const path& _p,
+                                             collection_options _opts)
+        : ctx_{}
+    {
+        detail::throw_if_path_length_exceeds_limit(_p);
 
-        if (const auto ec = rclOpenCollection(&_comm, const_cast<char*>(_p.c_str()), no_flags, &ctx_->handle); ec < 0) {
-            throw filesystem_error{"could not open collection for reading", detail::make_error_code(ec)};
-        }
-#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+        ctx_ = std::make_shared<context>();
+        ctx_->comm = &_comm;
+        ctx_->path = _p;
+        ctx_->read_comm = &_read_ahead_comm;
+        ctx_->read_ahead = true;
 
-        // Point to the first entry.
-        ++(*this);
+        open_collection();
     }
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
 
     collection_iterator::~collection_iterator()
     {
@@ -57,72 +74,229 @@ namespace irods::experimental::filesystem::NAMESPACE_IMPL
 #ifdef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
             rsCloseCollection(ctx_->comm, &ctx_->handle);
 #else
-            rclCloseCollection(&ctx_->handle);
+            // The collection cannot be closed while the next batch is being read.
+            if (ctx_->next.valid()) {
+                ctx_->next.wait();
+            }
+
+            rcCloseCollection(ctx_->read_comm, ctx_->handle);
 #endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
         }
     }
 
-    auto collection_iterator::operator++() -> collection_iterator&
+    auto collection_iterator::open_collection() -> void
     {
-        collEnt_t* e{};
+        assert(ctx_->handle == 0);
+
+        collInp_t input{};
+        std::strncpy(input.collName, ctx_->path.c_str(), ctx_->path.string().size());
 
 #ifdef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
-        const auto ec = rsReadCollection(ctx_->comm, &ctx_->handle, &e);
+        ctx_->handle = rsOpenCollection(ctx_->comm, &input);
 #else
-        collEnt_t ce{};
-        e = &ce;
-        const auto ec = rclReadCollection(ctx_->comm, &ctx_->handle, &ce);
+        // The collection is opened on the server so that its entries can be
+        // transferred in batches (see read_next_batch).
+        ctx_->handle = rcOpenCollection(ctx_->read_comm, &input);
 #endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
 
+        if (ctx_->handle < 0) {
+            throw filesystem_error{"could not open collection for reading", detail::make_error_code(ctx_->handle)};
+        }
+
+        // Point to the first entry.
+        ++(*this);
+    }
+
+#ifdef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+    auto collection_iterator::operator++() -> collection_iterator&
+    {
+        collEnt_t* e{};
+
+        const auto ec = rsReadCollection(ctx_->comm, &ctx_->handle, &e);
+
         if (ec < 0) {
             if (ec == CAT_NO_ROWS_FOUND) {
                 ctx_ = nullptr;
                 return *this;
             }
-            
+
             throw filesystem_error{"could not read collection entry [error code => " + std::to_string(ec) + ']',
                                    detail::make_error_code(ec)};
         }
 
-#ifdef IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
         irods::at_scope_exit at_scope_exit{[e] {
             if (e) {
                 std::free(e);
             }
         }};
-#endif
 
-        auto& entry = ctx_->entry;
+        set_entry(ctx_->entry, ctx_->path, *e);
+
+        return *this;
+    }
+#else
+    auto collection_iterator::operator++() -> collection_iterator&
+    {
+        if (ctx_->batch.empty() && !ctx_->end_of_collection) {
+            read_next_batch();
+        }
+
+        if (ctx_->batch.empty()) {
+            ctx_ = nullptr;
+            return *this;
+        }
+
+        ctx_->entry = std::move(ctx_->batch.front());
+        ctx_->batch.pop_front();
+
+        return *this;
+    }
+
+    auto collection_iterator::read_batch(rxComm& _comm,
+                                         int _handle,
+                                         int _max_entries,
+                                         const path& _parent,
+                                         std::deque<value_type>& _entries) -> int
+    {
+        using json = nlohmann::json;
+
+        const auto input = json{{"handle", _handle}, {"max_entries", _max_entries}}.dump();
+        char* output{};
+
+        if (const auto ec = rc_read_collection_batch(&_comm, input.c_str(), &output); ec < 0) {
+            return ec;
+        }
+
+        irods::at_scope_exit free_output{[output] { std::free(output); }};
+
+        try {
+            // See read_collection_batch.h for the layout of each entry.
+            const auto entries = json::parse(output);
+
+            for (auto&& e : entries) {
+                constexpr auto str = [](const json& _j) {
+                    return const_cast<char*>(_j.get_ref<const std::string&>().c_str());
+                };
+
+                // The API encodes the members the server left unset as empty strings.
+                constexpr auto optional_str = [](const json& _j) -> char* {
+                    const auto& s = _j.get_ref<const std::string&>();
+                    return s.empty() ? nullptr : const_cast<char*>(s.c_str());
+                };
+
+                collEnt_t ce{};
+                ce.objType = static_cast<objType_t>(e.at(0).get<int>());
+                ce.collName = ce.dataName = str(e.at(1));
+                ce.dataSize = e.at(2).get<rodsLong_t>();
+                ce.dataMode = e.at(3).get<uint>();
+                ce.dataId = optional_str(e.at(4));
+                ce.createTime = optional_str(e.at(5));
+                ce.modifyTime = optional_str(e.at(6));
+                ce.chksum = optional_str(e.at(7));
+                ce.ownerName = optional_str(e.at(8));
+                ce.dataType = optional_str(e.at(9));
+
+                set_entry(_entries.emplace_back(), _parent, ce);
+            }
+        }
+        catch (const json::exception& e) {
+            throw filesystem_error{std::string{"could not decode collection entries: "} + e.what(),
+                                   detail::make_error_code(SYS_LIBRARY_ERROR)};
+        }
+
+        return _entries.empty() ? CAT_NO_ROWS_FOUND : 0;
+    }
+
+    auto collection_iterator::read_next_batch() -> void
+    {
+        // Servers without the batched API are read one entry per round trip.
+        if (!ctx_->batching_supported) {
+            collEnt_t* e{};
 
-        entry.data_mode_ = e->dataMode;
-        entry.data_size_ = static_cast<std::uintmax_t>(e->dataSize);
+            if (const auto ec = rcReadCollection(ctx_->read_comm, ctx_->handle, &e); ec < 0) {
+                if (ec == CAT_NO_ROWS_FOUND) {
+                    ctx_->end_of_collection = true;
+                    return;
+                }
+
+                throw filesystem_error{"could not read collection entry [error code => " + std::to_string(ec) + ']',
+                                       detail::make_error_code(ec)};
+            }
+
+            irods::at_scope_exit free_entry{[e] { freeCollEnt(e); }};
+
+            set_entry(ctx_->batch.emplace_back(), ctx_->path, *e);
+
+            return;
+        }
+
+        int ec{};
+
+        if (ctx_->next.valid()) {
+            auto b = ctx_->next.get();
+            ctx_->batch = std::move(b.entries);
+            ec = b.error_code;
+        }
+        else {
+            ec = read_batch(*ctx_->read_comm, ctx_->handle, batch_size, ctx_->path, ctx_->batch);
+        }
+
+        if (ec < 0) {
+            if (ec == CAT_NO_ROWS_FOUND) {
+                ctx_->end_of_collection = true;
+                return;
+            }
+
+            if (ec == SYS_UNMATCHED_API_NUM) {
+                ctx_->batching_supported = false;
+                read_next_batch();
+                return;
+            }
+
+            throw filesystem_error{"could not read collection entries [error code => " + std::to_string(ec) + ']',
+                                   detail::make_error_code(ec)};
+        }
+
+        // Request the following batch while the caller visits this one. Collections
+        // which fit in one batch are not read ahead.
+        if (ctx_->read_ahead && ctx_->batch.size() == static_cast<std::size_t>(batch_size)) {
+            ctx_->next = std::async(std::launch::async, [comm = ctx_->read_comm, handle = ctx_->handle, p = ctx_->path] {
+                next_batch b;
+                b.error_code = read_batch(*comm, handle, batch_size, p, b.entries);
+                return b;
+            });
+        }
+    }
+#endif // IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
+
+    auto collection_iterator::set_entry(value_type& _entry, const path& _parent, const collEnt_t& _e) -> void
+    {
+        _entry.data_mode_ = _e.dataMode;
+        _entry.data_size_ = static_cast<std::uintmax_t>(_e.dataSize);
 
         // clang-format off
-        if (e->dataId)     { entry.data_id_ = e->dataId; }
-        if (e->createTime) { entry.ctime_ = object_time_type{std::chrono::seconds{std::stoll(e->createTime)}}; }
-        if (e->modifyTime) { entry.mtime_ = object_time_type{std::chrono::seconds{std::stoll(e->modifyTime)}}; }
-        if (e->chksum)     { entry.checksum_ = e->chksum; }
-        if (e->ownerName)  { entry.owner_ = e->ownerName; }
-        if (e->dataType)   { entry.data_type_ = e->dataType; }
+        if (_e.dataId)     { _entry.data_id_ = _e.dataId; }
+        if (_e.createTime) { _entry.ctime_ = object_time_type{std::chrono::seconds{std::stoll(_e.createTime)}}; }
+        if (_e.modifyTime) { _entry.mtime_ = object_time_type{std::chrono::seconds{std::stoll(_e.modifyTime)}}; }
+        if (_e.chksum)     { _entry.checksum_ = _e.chksum; }
+        if (_e.ownerName)  { _entry.owner_ = _e.ownerName; }
+        if (_e.dataType)   { _entry.data_type_ = _e.dataType; }
         // clang-format on
 
-        switch (e->objType) {
+        switch (_e.objType) {
             case COLL_OBJ_T:
-                entry.status_.type(object_type::collection);
-                entry.path_ = e->collName;
+                _entry.status_.type(object_type::collection);
+                _entry.path_ = _e.collName;
                 break;
 
             case DATA_OBJ_T:
-                entry.status_.type(object_type::data_object);
-                entry.path_ = ctx_->path / e->dataName;
+                _entry.status_.type(object_type::data_object);
+                _entry.path_ = _parent / _e.dataName;
                 break;
 
             default:
-                entry.status_.type(object_type::none);
+                _entry.status_.type(object_type::none);
                 break;
         }
-
-        return *this;
     }
 } // namespace irods::experimental::filesystem::NAMESPACE_IMPL
-
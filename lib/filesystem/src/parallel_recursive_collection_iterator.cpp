@@ -0,0 +1,332 @@
+#include "filesystem/parallel_recursive_collection_iterator.hpp"
+
+#include "filesystem/collection_iterator.hpp"
+#include "filesystem/filesystem_error.hpp"
+#include "filesystem/detail.hpp"
+
+#include "connection_pool.hpp"
+#include "query_builder.hpp"
+#include "thread_pool.hpp"
+#include "rodsErrorTable.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <unordered_set>
+
+namespace irods::experimental::filesystem::NAMESPACE_IMPL
+{
+    struct parallel_recursive_collection_iterator::context
+    {
+        context(connection_pool& _pool, const path& _p, const parallel_traversal_options& _opts)
+            : pool{_pool}
+            , root{_p}
+            , opts{_opts}
+            , workers{std::max(1, _opts.max_open_collections)}
+        {
+        }
+
+        context(const context&) = delete;
+        auto operator=(const context&) -> context& = delete;
+
+        ~context()
+        {
+            {
+                std::lock_guard lock{mutex};
+                stop = true;
+            }
+
+            work_available.notify_all();
+            space_available.notify_all();
+
+            workers.join();
+        }
+
+        // Returns whether every worker has finished producing entries.
+        // The mutex must be held by the caller.
+        auto producers_done() const noexcept -> bool
+        {
+            return pending.empty() && 0 == active;
+        }
+
+        // Appends an entry to the buffer, waiting for space if necessary.
+        // Returns false if the traversal has been stopped.
+        auto push(value_type&& _entry) -> bool
+        {
+            std::unique_lock lock{mutex};
+            space_available.wait(lock, [this] { return stop || entries.size() < opts.max_buffered_entries; });
+
+            if (stop) {
+                return false;
+            }
+
+            entries.push_back(std::move(_entry));
+            entry_available.notify_one();
+
+            return true;
+        }
+
+        // Records the first error seen by a worker and stops the traversal.
+        auto fail(std::exception_ptr _error) -> void
+        {
+            {
+                std::lock_guard lock{mutex};
+
+                if (!error) {
+                    error = _error;
+                }
+
+                stop = true;
+            }
+
+            work_available.notify_all();
+            space_available.notify_all();
+            entry_available.notify_all();
+        }
+
+        connection_pool& pool;
+        const path root;
+        const parallel_traversal_options opts;
+
+        std::mutex mutex;
+        std::condition_variable work_available;
+        std::condition_variable space_available;
+        std::condition_variable entry_available;
+
+        // Collections waiting to be read (parallel mode only).
+        std::deque<path> pending;
+
+        // The number of collections (or queries) currently being read.
+        int active = 0;
+
+        std::deque<value_type> entries;
+        std::exception_ptr error;
+        bool stop = false;
+
+        value_type entry;
+
+        // Must be declared last so that the workers are joined before any of the
+        // members they use are destroyed.
+        irods::thread_pool workers;
+    }; // struct context
+
+    parallel_recursive_collection_iterator::parallel_recursive_collection_iterator(connection_pool& _pool,
+                                                                                   const path& _p,
+                                                                                   const parallel_traversal_options& _opts)
+        : ctx_{std::make_shared<context>(_pool, _p, _opts)}
+    {
+        auto& ctx = *ctx_;
+
+        if (traversal_mode::single_query == _opts.mode) {
+            ctx.active = 1;
+            irods::thread_pool::post(ctx.workers, [&ctx] { read_subtree(ctx); });
+        }
+        else {
+            ctx.pending.push_back(_p);
+
+            for (int i = 0; i < std::max(1, _opts.max_open_collections); ++i) {
+                irods::thread_pool::post(ctx.workers, [&ctx] { read_collections(ctx); });
+            }
+        }
+
+        // Point to the first entry.
+        ++(*this);
+    }
+
+    auto parallel_recursive_collection_iterator::operator*() const -> reference
+    {
+        return ctx_->entry;
+    }
+
+    auto parallel_recursive_collection_iterator::operator->() const -> pointer
+    {
+        return &ctx_->entry;
+    }
+
+    auto parallel_recursive_collection_iterator::operator++() -> parallel_recursive_collection_iterator&
+    {
+        auto& ctx = *ctx_;
+
+        std::unique_lock lock{ctx.mutex};
+        ctx.entry_available.wait(lock, [&ctx] {
+            return !ctx.entries.empty() || ctx.error || ctx.producers_done();
+        });
+
+        if (ctx.error) {
+            const auto error = ctx.error;
+            lock.unlock();
+            ctx_ = nullptr;
+            std::rethrow_exception(error);
+        }
+
+        if (ctx.entries.empty()) {
+            lock.unlock();
+            ctx_ = nullptr;
+            return *this;
+        }
+
+        ctx.entry = std::move(ctx.entries.front());
+        ctx.entries.pop_front();
+        ctx.space_available.notify_one();
+
+        return *this;
+    }
+
+    auto parallel_recursive_collection_iterator::read_collections(context& _ctx) -> void
+    {
+        try {
+            // The connection is held for the lifetime of the worker. Acquiring one per
+            // collection would spin inside the pool whenever all of them are busy.
+            auto conn = _ctx.pool.get_connection();
+
+            while (true) {
+                path collection;
+
+                {
+                    std::unique_lock lock{_ctx.mutex};
+                    _ctx.work_available.wait(lock, [&_ctx] {
+                        return _ctx.stop || !_ctx.pending.empty() || 0 == _ctx.active;
+                    });
+
+                    if (_ctx.stop || _ctx.producers_done()) {
+                        break;
+                    }
+
+                    collection = std::move(_ctx.pending.front());
+                    _ctx.pending.pop_front();
+                    ++_ctx.active;
+                }
+
+                for (auto&& e : collection_iterator{conn, collection}) {
+                    if (e.is_collection()) {
+                        {
+                            std::lock_guard lock{_ctx.mutex};
+                            _ctx.pending.push_back(e.path());
+                        }
+
+                        _ctx.work_available.notify_one();
+                    }
+
+                    if (!_ctx.push(value_type{e})) {
+                        return;
+                    }
+                }
+
+                {
+                    std::lock_guard lock{_ctx.mutex};
+                    --_ctx.active;
+                }
+
+                // Wake up idle workers (and the reader) so that they notice when the
+                // traversal is complete.
+                _ctx.work_available.notify_all();
+                _ctx.entry_available.notify_all();
+            }
+        }
+        catch (...) {
+            _ctx.fail(std::current_exception());
+        }
+    }
+
+    auto parallel_recursive_collection_iterator::read_subtree(context& _ctx) -> void
+    {
+        try {
+            auto conn = _ctx.pool.get_connection();
+            auto& comm = static_cast<rcComm_t&>(conn);
+
+            // Keep the behavior consistent with parallel mode, which fails when the
+            // collection cannot be opened.
+            if (const auto s = status(comm, _ctx.root); !exists(s)) {
+                throw filesystem_error{"path does not exist", _ctx.root, detail::make_error_code(OBJ_PATH_DOES_NOT_EXIST)};
+            }
+            else if (!is_collection(s)) {
+                throw filesystem_error{"path does not point to a collection", _ctx.root,
+                                       detail::make_error_code(USER_INPUT_PATH_ERR)};
+            }
+
+            const auto& root = _ctx.root.string();
+            const auto prefix = ('/' == root.back()) ? root : root + '/';
+
+            // "_" is a wildcard for LIKE, so the results are filtered to guarantee
+            // that they are actually inside the subtree.
+            const auto in_subtree = [&root, &prefix](const std::string& _collection) {
+                return _collection == root || 0 == _collection.compare(0, prefix.size(), prefix);
+            };
+
+            irods::experimental::query_builder qb;
+
+            if (const auto zone = zone_name(_ctx.root); zone) {
+                qb.zone_hint(*zone);
+            }
+
+            const auto collections_gql = "select COLL_NAME, COLL_OWNER_NAME, COLL_CREATE_TIME, COLL_MODIFY_TIME "
+                                         "where COLL_NAME like '" + prefix + "%'";
+
+            for (auto&& row : qb.build(comm, collections_gql)) {
+                if (row[0] != root && in_subtree(row[0]) && !_ctx.push(make_collection_entry(row))) {
+                    return;
+                }
+            }
+
+            const std::string data_objects_gql = "select COLL_NAME, DATA_NAME, DATA_ID, DATA_SIZE, DATA_MODE, "
+                                                 "DATA_CREATE_TIME, DATA_MODIFY_TIME, DATA_CHECKSUM, "
+                                                 "DATA_OWNER_NAME, DATA_TYPE_NAME where COLL_NAME ";
+
+            // A row is returned for each replica. Only the first one is reported.
+            std::unordered_set<std::string> seen;
+
+            for (const auto& condition : {"= '" + root + "'", "like '" + prefix + "%'"}) {
+                for (auto&& row : qb.build(comm, data_objects_gql + condition)) {
+                    if (in_subtree(row[0]) && seen.insert(row[2]).second && !_ctx.push(make_data_object_entry(row))) {
+                        return;
+                    }
+                }
+            }
+
+            {
+                std::lock_guard lock{_ctx.mutex};
+                --_ctx.active;
+            }
+
+            _ctx.entry_available.notify_all();
+        }
+        catch (...) {
+            _ctx.fail(std::current_exception());
+        }
+    }
+
+    auto parallel_recursive_collection_iterator::make_collection_entry(const std::vector<std::string>& _row) -> value_type
+    {
+        value_type e;
+
+        e.path_ = _row[0];
+        e.status_.type(object_type::collection);
+        e.data_mode_ = 0;
+        e.data_size_ = 0;
+        e.owner_ = _row[1];
+        e.ctime_ = object_time_type{std::chrono::seconds{std::stoll(_row[2])}};
+        e.mtime_ = object_time_type{std::chrono::seconds{std::stoll(_row[3])}};
+
+        return e;
+    }
+
+    auto parallel_recursive_collection_iterator::make_data_object_entry(const std::vector<std::string>& _row) -> value_type
+    {
+        value_type e;
+
+        e.path_ = path{_row[0]} / _row[1];
+        e.status_.type(object_type::data_object);
+        e.data_id_ = _row[2];
+        e.data_size_ = _row[3].empty() ? 0 : std::stoull(_row[3]);
+        e.data_mode_ = _row[4].empty() ? 0 : std::stoul(_row[4]);
+        e.ctime_ = object_time_type{std::chrono::seconds{std::stoll(_row[5])}};
+        e.mtime_ = object_time_type{std::chrono::seconds{std::stoll(_row[6])}};
+        e.checksum_ = _row[7];
+        e.owner_ = _row[8];
+        e.data_type_ = _row[9];
+
+        return e;
+    }
+} // namespace irods::experimental::filesystem::NAMESPACE_IMPL
@@ -48,6 +48,11 @@
 #include <tuple>
 #include <chrono>
 #include <system_error>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
 
 namespace
 {
@@ -60,6 +65,19 @@ namespace
     using operation = std::function<int(rsComm_t*, bytesBuf_t*, bytesBuf_t**)>;
     // clang-format on
 
+    // The maximum number of rows inserted, deleted or looked up by a single statement.
+    // Keeps the number of bound parameters well below the limits of every database.
+    constexpr std::size_t max_rows_per_statement = 256;
+
+    // An AVU named by the input and the last operation applied to it.
+    struct avu_operation
+    {
+        fs::metadata metadata;
+        bool attach;
+        int meta_id;
+        int op_index;
+    }; // struct avu_operation
+
     //
     // Function Prototypes
     //
@@ -76,21 +94,29 @@ namespace
 
     auto get_object_id(rsComm_t& _comm, const std::string& _entity_name, const ic::entity_type _entity_type) -> int;
 
-    auto get_meta_id(nanodbc::connection& _db_conn, const fs::metadata& _metadata) -> int;
+    auto make_row_list(std::string_view _row, std::size_t _count, std::string_view _separator) -> std::string;
+
+    auto make_timestamp() -> std::string;
 
-    auto is_metadata_attached_to_object(nanodbc::connection& _db_conn, int _object_id, int _meta_id) -> bool;
+    auto to_avu_operations(const json& _operations, std::vector<avu_operation>& _avus) -> std::tuple<int, bytesBuf_t*>;
 
-    auto insert_metadata(nanodbc::connection& _db_conn, std::string_view _db_instance_name, const fs::metadata& _metadata) -> int;
+    auto fetch_meta_ids(nanodbc::connection& _db_conn, const std::vector<avu_operation*>& _avus) -> void;
 
-    auto attach_metadata_to_object(nanodbc::connection& _db_conn, int _object_id, int _meta_id) -> void;
+    auto insert_metadata(nanodbc::connection& _db_conn,
+                         std::string_view _db_instance_name,
+                         const std::vector<avu_operation*>& _avus) -> void;
 
-    auto detach_metadata_from_object(nanodbc::connection& _db_conn, int _object_id, int _meta_id) -> void;
+    auto attach_metadata_to_object(nanodbc::connection& _db_conn,
+                                   std::string_view _db_instance_name,
+                                   int _object_id,
+                                   const std::vector<int>& _meta_ids) -> void;
 
-    auto execute_metadata_operation(nanodbc::connection& _db_conn,
-                                    std::string_view _db_instance_name,
-                                    int _object_id,
-                                    const json& _operation,
-                                    int _op_index) -> std::tuple<int, bytesBuf_t*>;
+    auto detach_metadata_from_object(nanodbc::connection& _db_conn, int _object_id, const std::vector<int>& _meta_ids) -> void;
+
+    auto execute_metadata_operations(nanodbc::connection& _db_conn,
+                                     std::string_view _db_instance_name,
+                                     int _object_id,
+                                     const json& _operations) -> std::tuple<int, bytesBuf_t*>;
 
     auto rs_atomic_apply_metadata_operations(rsComm_t*, bytesBuf_t*, bytesBuf_t**) -> int;
 
@@ -187,192 +213,334 @@ namespace
         throw std::runtime_error{fmt::format("Entity does not exist [entity_name => {}]", _entity_name)};
     }
 
-    auto get_meta_id(nanodbc::connection& _db_conn, const fs::metadata& _metadata) -> int
+    auto make_row_list(std::string_view _row, std::size_t _count, std::string_view _separator) -> std::string
     {
-        nanodbc::statement stmt{_db_conn};
-
-        prepare(stmt, "select meta_id from R_META_MAIN "
-                      "where"
-                      " meta_attr_name = ? and"
-                      " meta_attr_value = ? and"
-                      " meta_attr_unit = ?");
+        std::string rows;
+        rows.reserve((_row.size() + _separator.size()) * _count);
 
-        stmt.bind(0, _metadata.attribute.c_str());
-        stmt.bind(1, _metadata.value.c_str());
-        stmt.bind(2, _metadata.units.c_str());
+        for (std::size_t i = 0; i < _count; ++i) {
+            if (i > 0) {
+                rows += _separator;
+            }
 
-        if (auto row = execute(stmt); row.next()) {
-            return row.get<int>(0);
+            rows += _row;
         }
 
-        return -1;
+        return rows;
     }
 
-    auto is_metadata_attached_to_object(nanodbc::connection& _db_conn, int _object_id, int _meta_id) -> bool
+    auto make_timestamp() -> std::string
     {
-        nanodbc::statement stmt{_db_conn};
+        using std::chrono::system_clock;
+        using std::chrono::duration_cast;
+        using std::chrono::seconds;
+
+        return fmt::format("{:011}", duration_cast<seconds>(system_clock::now().time_since_epoch()).count());
+    }
+
+    auto to_avu_operations(const json& _operations, std::vector<avu_operation>& _avus) -> std::tuple<int, bytesBuf_t*>
+    {
+        // Maps an AVU to its position in "_avus".
+        std::map<std::tuple<std::string, std::string, std::string>, std::size_t> positions;
+
+        for (json::size_type i = 0; i < _operations.size(); ++i) {
+            const auto& op = _operations[i];
 
-        prepare(stmt, "select count(*) from R_OBJT_METAMAP where object_id = ? and meta_id = ?");
+            try {
+                fs::metadata md;
+
+                md.attribute = op.at("attribute").get<std::string>();
+                md.value = op.at("value").get<std::string>();
+
+                // "units" are optional.
+                if (op.count("units")) {
+                    md.units = op.at("units").get<std::string>();
+                }
+
+                bool attach = false;
+
+                if (const auto op_code = op.at("operation").get<std::string>(); op_code == "add") {
+                    attach = true;
+                }
+                else if (op_code != "remove") {
+                    // clang-format off
+                    log::api::error({{"log_message", "Invalid metadata operation"},
+                                     {"metadata_operation", op.dump()}});
+                    // clang-format on
+
+                    return {INVALID_OPERATION, to_bytes_buffer(make_error_object(op, i, "Invalid metadata operation.").dump())};
+                }
+
+                // Adding an AVU which is already attached and removing one which is not
+                // attached do nothing, so only the last operation naming an AVU matters.
+                auto key = std::make_tuple(md.attribute, md.value, md.units);
+
+                if (const auto iter = positions.find(key); iter != std::end(positions)) {
+                    auto& avu = _avus[iter->second];
+                    avu.attach = attach;
+                    avu.op_index = i;
+                }
+                else {
+                    positions.emplace(std::move(key), _avus.size());
+                    _avus.push_back({std::move(md), attach, -1, static_cast<int>(i)});
+                }
+            }
+            catch (const json::out_of_range& e) {
+                // clang-format off
+                log::api::error({{"log_message", e.what()},
+                                 {"metadata_operation", op.dump()}});
+                // clang-format on
 
-        stmt.bind(0, &_object_id);
-        stmt.bind(1, &_meta_id);
+                return {SYS_INTERNAL_ERR, to_bytes_buffer(make_error_object(op, i, e.what()).dump())};
+            }
+            catch (const json::type_error& e) {
+                // clang-format off
+                log::api::error({{"log_message", e.what()},
+                                 {"metadata_operation", op.dump()}});
+                // clang-format on
 
-        if (auto row = execute(stmt); row.next()) {
-            return row.get<int>(0) > 0;
+                return {SYS_INTERNAL_ERR, to_bytes_buffer(make_error_object(op, i, e.what()).dump())};
+            }
         }
 
-        return false;
+        return {0, nullptr};
     }
 
-    auto insert_metadata(nanodbc::connection& _db_conn, std::string_view _db_instance_name, const fs::metadata& _metadata) -> int
+    auto fetch_meta_ids(nanodbc::connection& _db_conn, const std::vector<avu_operation*>& _avus) -> void
     {
-        nanodbc::statement stmt{_db_conn};
+        for (std::size_t first = 0; first < _avus.size(); first += max_rows_per_statement) {
+            const auto last = std::min(_avus.size(), first + max_rows_per_statement);
+
+            nanodbc::statement stmt{_db_conn};
+
+            prepare(stmt, fmt::format("select meta_id, meta_attr_name, meta_attr_value, meta_attr_unit from R_META_MAIN where {}",
+                                      make_row_list("(meta_attr_name = ? and meta_attr_value = ? and meta_attr_unit = ?)",
+                                                    last - first,
+                                                    " or ")));
+
+            std::map<std::tuple<std::string_view, std::string_view, std::string_view>, avu_operation*> chunk;
+
+            for (auto i = first; i < last; ++i) {
+                const auto& md = _avus[i]->metadata;
+                const auto param = static_cast<short>((i - first) * 3);
+
+                stmt.bind(param, md.attribute.c_str());
+                stmt.bind(param + 1, md.value.c_str());
+                stmt.bind(param + 2, md.units.c_str());
+
+                chunk.emplace(std::make_tuple(std::string_view{md.attribute}, std::string_view{md.value}, std::string_view{md.units}),
+                              _avus[i]);
+            }
+
+            for (auto row = execute(stmt); row.next();) {
+                const auto attribute = row.get<std::string>(1);
+                const auto value = row.get<std::string>(2);
+                const auto units = row.get<std::string>(3, "");
+
+                if (const auto iter = chunk.find(std::make_tuple(std::string_view{attribute}, std::string_view{value}, std::string_view{units}));
+                    iter != std::end(chunk) && iter->second->meta_id < 0)
+                {
+                    iter->second->meta_id = row.get<int>(0);
+                }
+            }
+        }
+    }
+
+    auto insert_metadata(nanodbc::connection& _db_conn,
+                         std::string_view _db_instance_name,
+                         const std::vector<avu_operation*>& _avus) -> void
+    {
+        std::string_view row;
+        std::size_t rows_per_statement = max_rows_per_statement;
 
         if (_db_instance_name == "oracle") {
-            prepare(stmt, "insert into R_META_MAIN (meta_id, meta_attr_name, meta_attr_value, meta_attr_unit, create_ts, modify_ts) "
-                          "values (select R_OBJECTID.nextval from DUAL, ?, ?, ?, ?, ?)");
+            // Oracle does not accept multiple rows in a VALUES clause and evaluates a sequence
+            // only once per INSERT ALL, so the rows are inserted one at a time.
+            row = "(R_OBJECTID.nextval, ?, ?, ?, ?, ?)";
+            rows_per_statement = 1;
         }
         else if (_db_instance_name == "mysql") {
-            prepare(stmt, "insert into R_META_MAIN (meta_id, meta_attr_name, meta_attr_value, meta_attr_unit, create_ts, modify_ts) "
-                          "values (R_OBJECTID_nextval(), ?, ?, ?, ?, ?)");
+            row = "(R_OBJECTID_nextval(), ?, ?, ?, ?, ?)";
         }
         else if (_db_instance_name == "postgres") {
-            prepare(stmt, "insert into R_META_MAIN (meta_id, meta_attr_name, meta_attr_value, meta_attr_unit, create_ts, modify_ts) "
-                          "values (nextval('R_OBJECTID'), ?, ?, ?, ?, ?)");
+            row = "(nextval('R_OBJECTID'), ?, ?, ?, ?, ?)";
         }
         else {
             throw std::runtime_error{"Invalid database plugin configuration"};
         }
 
-        using std::chrono::system_clock;
-        using std::chrono::duration_cast;
-        using std::chrono::seconds;
+        const auto timestamp = make_timestamp();
+
+        for (std::size_t first = 0; first < _avus.size(); first += rows_per_statement) {
+            const auto last = std::min(_avus.size(), first + rows_per_statement);
+
+            nanodbc::statement stmt{_db_conn};
+
+            prepare(stmt, fmt::format("insert into R_META_MAIN (meta_id, meta_attr_name, meta_attr_value, meta_attr_unit, create_ts, modify_ts) "
+                                      "values {}",
+                                      make_row_list(row, last - first, ", ")));
 
-        const auto timestamp = fmt::format("{:011}", duration_cast<seconds>(system_clock::now().time_since_epoch()).count());
+            for (auto i = first; i < last; ++i) {
+                const auto& md = _avus[i]->metadata;
+                const auto param = static_cast<short>((i - first) * 5);
 
-        stmt.bind(0, _metadata.attribute.c_str());
-        stmt.bind(1, _metadata.value.c_str());
-        stmt.bind(2, _metadata.units.c_str());
-        stmt.bind(3, timestamp.c_str());
-        stmt.bind(4, timestamp.c_str());
+                stmt.bind(param, md.attribute.c_str());
+                stmt.bind(param + 1, md.value.c_str());
+                stmt.bind(param + 2, md.units.c_str());
+                stmt.bind(param + 3, timestamp.c_str());
+                stmt.bind(param + 4, timestamp.c_str());
+            }
 
-        execute(stmt);
+            execute(stmt);
+        }
 
-        return get_meta_id(_db_conn, _metadata);
+        fetch_meta_ids(_db_conn, _avus);
     }
 
-    auto attach_metadata_to_object(nanodbc::connection& _db_conn, int _object_id, int _meta_id) -> void
+    auto attach_metadata_to_object(nanodbc::connection& _db_conn,
+                                   std::string_view _db_instance_name,
+                                   int _object_id,
+                                   const std::vector<int>& _meta_ids) -> void
     {
-        nanodbc::statement stmt{_db_conn};
+        // Metadata which is already attached to the object is skipped.
+        std::set<int> attached;
 
-        prepare(stmt, "insert into R_OBJT_METAMAP (object_id, meta_id, create_ts, modify_ts) "
-                      "values (?, ?, ?, ?)");
+        for (std::size_t first = 0; first < _meta_ids.size(); first += max_rows_per_statement) {
+            const auto last = std::min(_meta_ids.size(), first + max_rows_per_statement);
 
-        using std::chrono::system_clock;
-        using std::chrono::duration_cast;
-        using std::chrono::seconds;
+            nanodbc::statement stmt{_db_conn};
+
+            prepare(stmt, fmt::format("select meta_id from R_OBJT_METAMAP where object_id = ? and meta_id in ({})",
+                                      make_row_list("?", last - first, ", ")));
+
+            stmt.bind(0, &_object_id);
+
+            for (auto i = first; i < last; ++i) {
+                stmt.bind(static_cast<short>(i - first + 1), &_meta_ids[i]);
+            }
+
+            for (auto row = execute(stmt); row.next();) {
+                attached.insert(row.get<int>(0));
+            }
+        }
+
+        std::vector<int> meta_ids;
+        std::copy_if(std::begin(_meta_ids), std::end(_meta_ids), std::back_inserter(meta_ids), [&attached](int _id) {
+            return attached.count(_id) == 0;
+        });
+
+        const auto oracle = (_db_instance_name == "oracle");
+        const auto timestamp = make_timestamp();
 
-        const auto timestamp = fmt::format("{:011}", duration_cast<seconds>(system_clock::now().time_since_epoch()).count());
+        for (std::size_t first = 0; first < meta_ids.size(); first += max_rows_per_statement) {
+            const auto last = std::min(meta_ids.size(), first + max_rows_per_statement);
 
-        stmt.bind(0, &_object_id);
-        stmt.bind(1, &_meta_id);
-        stmt.bind(2, timestamp.c_str());
-        stmt.bind(3, timestamp.c_str());
+            nanodbc::statement stmt{_db_conn};
 
-        execute(stmt);
+            if (oracle) {
+                prepare(stmt, fmt::format("insert all {} select * from DUAL",
+                                          make_row_list("into R_OBJT_METAMAP (object_id, meta_id, create_ts, modify_ts) values (?, ?, ?, ?)",
+                                                        last - first,
+                                                        " ")));
+            }
+            else {
+                prepare(stmt, fmt::format("insert into R_OBJT_METAMAP (object_id, meta_id, create_ts, modify_ts) values {}",
+                                          make_row_list("(?, ?, ?, ?)", last - first, ", ")));
+            }
+
+            for (auto i = first; i < last; ++i) {
+                const auto param = static_cast<short>((i - first) * 4);
+
+                stmt.bind(param, &_object_id);
+                stmt.bind(param + 1, &meta_ids[i]);
+                stmt.bind(param + 2, timestamp.c_str());
+                stmt.bind(param + 3, timestamp.c_str());
+            }
+
+            execute(stmt);
+        }
     }
 
-    auto detach_metadata_from_object(nanodbc::connection& _db_conn, int _object_id, int _meta_id) -> void
+    auto detach_metadata_from_object(nanodbc::connection& _db_conn, int _object_id, const std::vector<int>& _meta_ids) -> void
     {
-        nanodbc::statement stmt{_db_conn};
+        for (std::size_t first = 0; first < _meta_ids.size(); first += max_rows_per_statement) {
+            const auto last = std::min(_meta_ids.size(), first + max_rows_per_statement);
+
+            nanodbc::statement stmt{_db_conn};
 
-        prepare(stmt, "delete from R_OBJT_METAMAP where object_id = ? and meta_id = ?");
+            prepare(stmt, fmt::format("delete from R_OBJT_METAMAP where object_id = ? and meta_id in ({})",
+                                      make_row_list("?", last - first, ", ")));
 
-        stmt.bind(0, &_object_id);
-        stmt.bind(1, &_meta_id);
+            stmt.bind(0, &_object_id);
+
+            for (auto i = first; i < last; ++i) {
+                stmt.bind(static_cast<short>(i - first + 1), &_meta_ids[i]);
+            }
 
-        execute(stmt);
+            execute(stmt);
+        }
     }
 
-    auto execute_metadata_operation(nanodbc::connection& _db_conn,
-                                    std::string_view _db_instance_name,
-                                    int _object_id,
-                                    const json& _op,
-                                    int _op_index) -> std::tuple<int, bytesBuf_t*>
+    auto execute_metadata_operations(nanodbc::connection& _db_conn,
+                                     std::string_view _db_instance_name,
+                                     int _object_id,
+                                     const json& _operations) -> std::tuple<int, bytesBuf_t*>
     {
+        std::vector<avu_operation> avus;
+
+        if (const auto [ec, bbuf] = to_avu_operations(_operations, avus); ec != 0) {
+            return {ec, bbuf};
+        }
+
+        std::vector<avu_operation*> all;
+        std::transform(std::begin(avus), std::end(avus), std::back_inserter(all), [](auto& _avu) { return &_avu; });
+
         try {
-            fs::metadata md;
+            fetch_meta_ids(_db_conn, all);
 
-            md.attribute = _op.at("attribute").get<std::string>();
-            md.value = _op.at("value").get<std::string>();
+            // AVUs which must be attached but do not exist yet are inserted first.
+            std::vector<avu_operation*> missing;
+            std::copy_if(std::begin(all), std::end(all), std::back_inserter(missing), [](auto* _avu) {
+                return _avu->attach && _avu->meta_id < 0;
+            });
 
-            // "units" are optional.
-            if (_op.count("units")) {
-                md.units = _op.at("units").get<std::string>();
+            if (!missing.empty()) {
+                insert_metadata(_db_conn, _db_instance_name, missing);
             }
 
-            if (const auto op_code = _op.at("operation").get<std::string>(); op_code == "add") {
-                if (auto meta_id = get_meta_id(_db_conn, md); meta_id > -1) {
-                    if (!is_metadata_attached_to_object(_db_conn, _object_id, meta_id)) {
-                        attach_metadata_to_object(_db_conn, _object_id, meta_id);
+            std::vector<int> to_attach;
+            std::vector<int> to_detach;
+
+            for (auto&& avu : avus) {
+                if (avu.attach) {
+                    if (avu.meta_id < 0) {
+                        const auto& md = avu.metadata;
+                        const auto msg = fmt::format("Failed to insert metadata [attribute => {}, value => {}, units => {}]",
+                                                     md.attribute, md.value, md.units);
+                        return {SYS_INTERNAL_ERR, to_bytes_buffer(make_error_object(_operations[avu.op_index], avu.op_index, msg).dump())};
                     }
+
+                    to_attach.push_back(avu.meta_id);
                 }
-                else if (meta_id = insert_metadata(_db_conn, _db_instance_name, md); meta_id > -1) {
-                    attach_metadata_to_object(_db_conn, _object_id, meta_id);
-                }
-                else {
-                    const auto msg = fmt::format("Failed to insert metadata [attribute => {}, value => {}, units => {}]",
-                                                 md.attribute, md.value, md.units);
-                    return {SYS_INTERNAL_ERR, to_bytes_buffer(make_error_object(_op, _op_index, msg).dump())};
-                }
-            }
-            else if (op_code == "remove") {
-                if (const auto meta_id = get_meta_id(_db_conn, md); meta_id > -1) {
-                    detach_metadata_from_object(_db_conn, _object_id, meta_id);
+                else if (avu.meta_id > -1) {
+                    to_detach.push_back(avu.meta_id);
                 }
             }
-            else {
-                // clang-format off
-                log::api::error({{"log_message", "Invalid metadata operation"},
-                                 {"metadata_operation", _op.dump()}});
-                // clang-format on
 
-                return {INVALID_OPERATION, to_bytes_buffer(make_error_object(_op, _op_index, "Invalid metadata operation.").dump())};
-            }
+            attach_metadata_to_object(_db_conn, _db_instance_name, _object_id, to_attach);
+            detach_metadata_from_object(_db_conn, _object_id, to_detach);
 
-            return {0, to_bytes_buffer("{}")};
+            return {0, nullptr};
         }
-        catch (const fs::filesystem_error& e) {
-            // clang-format off
-            log::api::error({{"log_message", e.what()},
-                             {"metadata_operation", _op.dump()}});
-            // clang-format on
-
-            return {e.code().value(), to_bytes_buffer(make_error_object(_op, _op_index, e.what()).dump())};
-        }
-        catch (const json::out_of_range& e) {
-            // clang-format off
-            log::api::error({{"log_message", e.what()},
-                             {"metadata_operation", _op.dump()}});
-            // clang-format on
-
-            return {SYS_INTERNAL_ERR, to_bytes_buffer(make_error_object(_op, _op_index, e.what()).dump())};
-        }
-        catch (const json::type_error& e) {
-            // clang-format off
-            log::api::error({{"log_message", e.what()},
-                             {"metadata_operation", _op.dump()}});
-            // clang-format on
-
-            return {SYS_INTERNAL_ERR, to_bytes_buffer(make_error_object(_op, _op_index, e.what()).dump())};
-        }
-        catch (const std::system_error& e) {
+        catch (const std::exception& e) {
+            // The statements are shared by all operations, so a database error is not
+            // attributed to a specific operation.
             // clang-format off
             log::api::error({{"log_message", e.what()},
-                             {"metadata_operation", _op.dump()}});
+                             {"object_id", std::to_string(_object_id)}});
             // clang-format on
 
-            return {e.code().value(), to_bytes_buffer(make_error_object(_op, _op_index, e.what()).dump())};
+            return {CAT_SQL_ERR, to_bytes_buffer(make_error_object(json{}, 0, e.what()).dump())};
         }
     }
 
@@ -462,19 +630,14 @@ namespace
         return ic::execute_transaction(db_conn, [&](auto& _trans) -> int
         {
             try {
-                const auto& operations = input.at("operations");
-
-                for (json::size_type i = 0; i < operations.size(); ++i) {
-                    const auto [ec, bbuf] = execute_metadata_operation(_trans.connection(),
-                                                                       db_instance_name,
-                                                                       object_id,
-                                                                       operations[i],
-                                                                       i);
-
-                    if (ec != 0) {
-                        *_output = bbuf;
-                        return ec;
-                    }
+                const auto [ec, bbuf] = execute_metadata_operations(_trans.connection(),
+                                                                    db_instance_name,
+                                                                    object_id,
+                                                                    input.at("operations"));
+
+                if (ec != 0) {
+                    *_output = bbuf;
+                    return ec;
                 }
 
                 _trans.commit();
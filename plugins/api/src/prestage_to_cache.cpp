@@ -0,0 +1,190 @@
+#include "api_plugin_number.h"
+#include "rodsDef.h"
+#include "rcConnect.h"
+#include "rodsPackInstruct.h"
+#include "apiHandler.hpp"
+#include "client_api_whitelist.hpp"
+
+#include <functional>
+
+#ifdef RODS_SERVER
+
+//
+// Server-side Implementation
+//
+
+#include "prestage_to_cache.h"
+
+#include "rodsErrorTable.h"
+#include "irods_exception.hpp"
+#include "irods_logger.hpp"
+#include "irods_resource_manager.hpp"
+#include "stage_queue.hpp"
+
+#define IRODS_QUERY_ENABLE_SERVER_SIDE_API
+#include "query_builder.hpp"
+
+#include "fmt/format.h"
+#include "json.hpp"
+
+#include <string>
+#include <string_view>
+
+extern irods::resource_manager resc_mgr;
+
+/*
+ The expected JSON format:
+ ~~~~~~~~~~~~~~~~~~~~~~~~~
+ {
+     // A GenQuery string whose first two columns are COLL_NAME and DATA_NAME.
+     "query": string,
+
+     // The root resource of the hierarchy containing the compound resource.
+     "resource": string,
+
+     // Optional. Defaults to 0. Opens always take precedence.
+     "priority": integer
+ }
+*/
+
+namespace
+{
+    // clang-format off
+    namespace ix = irods::experimental;
+
+    using json      = nlohmann::json;
+    using log       = irods::experimental::log;
+    using operation = std::function<int(rsComm_t*, bytesBuf_t*)>;
+    // clang-format on
+
+    auto call_prestage_to_cache(irods::api_entry* _api, rsComm_t* _comm, bytesBuf_t* _input) -> int
+    {
+        return _api->call_handler<bytesBuf_t*>(_comm, _input);
+    } // call_prestage_to_cache
+
+    auto throw_if_not_a_root_resource(const std::string& _resource) -> void
+    {
+        irods::resource_ptr resc;
+        if (const auto err = resc_mgr.resolve(_resource, resc); !err.ok()) {
+            THROW(err.code(), fmt::format("Resource [{}] does not exist.", _resource));
+        }
+
+        irods::resource_ptr parent;
+        if (resc->get_parent(parent).ok()) {
+            THROW(DIRECT_CHILD_ACCESS, fmt::format("Resource [{}] is not a root resource.", _resource));
+        }
+    } // throw_if_not_a_root_resource
+
+    auto rs_prestage_to_cache(rsComm_t* _comm, bytesBuf_t* _input) -> int
+    {
+        if (!_input || !_input->buf || _input->len <= 0) {
+            log::api::error("Missing JSON input");
+            return SYS_INVALID_INPUT_PARAM;
+        }
+
+        std::string gql;
+        std::string resource;
+        int priority = irods::stage_priority_prefetch;
+
+        try {
+            const auto input = json::parse(std::string(static_cast<const char*>(_input->buf), _input->len));
+
+            gql = input.at("query").get<std::string>();
+            resource = input.at("resource").get<std::string>();
+
+            if (const auto iter = input.find("priority"); iter != std::end(input)) {
+                priority = iter->get<int>();
+            }
+        }
+        catch (const json::exception& e) {
+            log::api::error("Failed to parse input into JSON [error_code={}]", e.what());
+            return SYS_INVALID_INPUT_PARAM;
+        }
+
+        // Opens must not queue behind prefetches.
+        if (priority >= irods::stage_priority_open) {
+            priority = irods::stage_priority_open - 1;
+        }
+
+        try {
+            throw_if_not_a_root_resource(resource);
+
+            auto& stage_queue = irods::get_stage_queue();
+            int queued = 0;
+
+            // The stages run in the background. Rows naming the same data object (e.g.
+            // one per replica) are coalesced by the stage queue.
+            for (auto&& row : ix::query_builder{}.build<rsComm_t>(*_comm, gql)) {
+                if (row.size() < 2) {
+                    THROW(SYS_INVALID_INPUT_PARAM, "The query must select COLL_NAME and DATA_NAME.");
+                }
+
+                const auto logical_path = fmt::format("{}/{}", row[0], row[1]);
+                stage_queue.submit(irods::make_stage_request(*_comm, logical_path, resource), priority);
+                ++queued;
+            }
+
+            log::api::debug("Queued [{}] data objects for staging to the cache of [{}].", queued, resource);
+
+            return queued;
+        }
+        catch (const irods::exception& e) {
+            log::api::error(e.what());
+            addRErrorMsg(&_comm->rError, e.code(), e.client_display_what());
+            return e.code();
+        }
+        catch (const std::exception& e) {
+            log::api::error(e.what());
+            addRErrorMsg(&_comm->rError, SYS_UNKNOWN_ERROR, "Cannot process request due to an unexpected error.");
+            return SYS_UNKNOWN_ERROR;
+        }
+    } // rs_prestage_to_cache
+
+    const operation op = rs_prestage_to_cache;
+    #define CALL_PRESTAGE_TO_CACHE call_prestage_to_cache
+} // anonymous namespace
+
+#else // RODS_SERVER
+
+//
+// Client-side Implementation
+//
+
+namespace
+{
+    using operation = std::function<int(rsComm_t*, bytesBuf_t*)>;
+    const operation op{};
+    #define CALL_PRESTAGE_TO_CACHE nullptr
+} // anonymous namespace
+
+#endif // RODS_SERVER
+
+// The plugin factory function must always be defined.
+extern "C"
+auto plugin_factory(const std::string& _instance_name,
+                    const std::string& _context) -> irods::api_entry*
+{
+#ifdef RODS_SERVER
+    irods::client_api_whitelist::instance().add(PRESTAGE_TO_CACHE_APN);
+#endif // RODS_SERVER
+
+    // clang-format off
+    irods::apidef_t def{PRESTAGE_TO_CACHE_APN,      // API number
+                        RODS_API_VERSION,           // API version
+                        REMOTE_USER_AUTH,           // Client auth
+                        REMOTE_USER_AUTH,           // Proxy auth
+                        "BytesBuf_PI", 0,           // In PI / bs flag
+                        nullptr, 0,                 // Out PI / bs flag
+                        op,                         // Operation
+                        "api_prestage_to_cache",    // Operation name
+                        nullptr,                    // Clear function
+                        (funcPtr) CALL_PRESTAGE_TO_CACHE};
+    // clang-format on
+
+    auto* api = new irods::api_entry{def};
+
+    api->in_pack_key = "BytesBuf_PI";
+    api->in_pack_value = BytesBuf_PI;
+
+    return api;
+}
@@ -0,0 +1,241 @@
+#include "api_plugin_number.h"
+#include "rodsDef.h"
+#include "rcConnect.h"
+#include "rodsPackInstruct.h"
+#include "apiHandler.hpp"
+#include "client_api_whitelist.hpp"
+
+#include <functional>
+
+#ifdef RODS_SERVER
+
+//
+// Server-side Implementation
+//
+
+#include "read_collection_batch.h"
+
+#include "miscUtil.h"
+#include "rodsErrorTable.h"
+#include "rsGlobalExtern.hpp"
+#include "irods_server_api_call.hpp"
+#include "irods_re_serialization.hpp"
+#include "irods_logger.hpp"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+/*
+ The expected JSON format:
+ ~~~~~~~~~~~~~~~~~~~~~~~~~
+ {
+     // The handle returned by rcOpenCollection.
+     "handle": integer,
+
+     // Optional. Clamped to [1, max_batch_size].
+     "max_entries": integer
+ }
+*/
+
+namespace
+{
+    // clang-format off
+    using json      = nlohmann::json;
+    using operation = std::function<int(rsComm_t*, bytesBuf_t*, bytesBuf_t**)>;
+    // clang-format on
+
+    constexpr int default_batch_size = 512;
+    constexpr int max_batch_size = 4096;
+
+    //
+    // Function Prototypes
+    //
+
+    auto call_read_collection_batch(irods::api_entry*, rsComm_t*, bytesBuf_t*, bytesBuf_t**) -> int;
+    auto is_input_valid(const bytesBuf_t*) -> std::tuple<bool, std::string>;
+    auto to_json_array(const collEnt_t&) -> json;
+    auto to_bytes_buffer(std::string_view _s) -> bytesBuf_t*;
+    auto rs_read_collection_batch(rsComm_t*, bytesBuf_t*, bytesBuf_t**) -> int;
+
+    //
+    // Function Implementations
+    //
+
+    auto call_read_collection_batch(irods::api_entry* _api,
+                                    rsComm_t* _comm,
+                                    bytesBuf_t* _input,
+                                    bytesBuf_t** _output) -> int
+    {
+        return _api->call_handler<bytesBuf_t*, bytesBuf_t**>(_comm, _input, _output);
+    }
+
+    auto is_input_valid(const bytesBuf_t* _input) -> std::tuple<bool, std::string>
+    {
+        if (!_input) {
+            return {false, "Missing JSON input"};
+        }
+
+        if (_input->len <= 0) {
+            return {false, "Length of buffer must be greater than zero"};
+        }
+
+        if (!_input->buf) {
+            return {false, "Missing input buffer"};
+        }
+
+        return {true, ""};
+    }
+
+    auto to_json_array(const collEnt_t& _e) -> json
+    {
+        constexpr auto str = [](const char* _s) { return _s ? _s : ""; };
+
+        // The field order is part of the wire format. See read_collection_batch.h.
+        return json::array({
+            static_cast<int>(_e.objType),
+            str(COLL_OBJ_T == _e.objType ? _e.collName : _e.dataName),
+            _e.dataSize,
+            _e.dataMode,
+            str(_e.dataId),
+            str(_e.createTime),
+            str(_e.modifyTime),
+            str(_e.chksum),
+            str(_e.ownerName),
+            str(_e.dataType)
+        });
+    }
+
+    auto to_bytes_buffer(std::string_view _s) -> bytesBuf_t*
+    {
+        constexpr auto allocate = [](const auto bytes) noexcept
+        {
+            return std::memset(std::malloc(bytes), 0, bytes);
+        };
+
+        const auto buf_size = _s.length() + 1;
+
+        auto* buf = static_cast<char*>(allocate(sizeof(char) * buf_size));
+        std::strncpy(buf, _s.data(), _s.length());
+
+        auto* bbp = static_cast<bytesBuf_t*>(allocate(sizeof(bytesBuf_t)));
+        bbp->len = buf_size;
+        bbp->buf = buf;
+
+        return bbp;
+    }
+
+    auto rs_read_collection_batch(rsComm_t* _comm, bytesBuf_t* _input, bytesBuf_t** _output) -> int
+    {
+        using log = irods::experimental::log;
+
+        if (const auto [valid, msg] = is_input_valid(_input); !valid) {
+            log::api::error(msg);
+            return SYS_INVALID_INPUT_PARAM;
+        }
+
+        int handle = -1;
+        int max_entries = default_batch_size;
+
+        try {
+            const auto input = json::parse(std::string(static_cast<const char*>(_input->buf), _input->len));
+
+            handle = input.at("handle").get<int>();
+
+            if (const auto iter = input.find("max_entries"); iter != std::end(input)) {
+                max_entries = std::clamp(iter->get<int>(), 1, max_batch_size);
+            }
+        }
+        catch (const json::exception& e) {
+            log::api::error("Failed to parse input into JSON [error_code={}]", e.what());
+            return SYS_INVALID_INPUT_PARAM;
+        }
+
+        if (handle < 0 ||
+            static_cast<std::size_t>(handle) >= CollHandle.size() ||
+            CollHandle[handle].inuseFlag != FD_INUSE)
+        {
+            log::api::error("Collection handle out of range [handle={}]", handle);
+            return SYS_FILE_DESC_OUT_OF_RANGE;
+        }
+
+        auto& coll_handle = CollHandle[handle];
+        auto entries = json::array();
+
+        // The strings referenced by a collEnt_t point into the current GenQuery page,
+        // so each entry must be serialized before the next one is read.
+        for (int i = 0; i < max_entries; ++i) {
+            collEnt_t entry{};
+
+            if (const auto ec = readCollection(&coll_handle, &entry); ec < 0) {
+                if (CAT_NO_ROWS_FOUND == ec && !entries.empty()) {
+                    break;
+                }
+
+                return ec;
+            }
+
+            entries.push_back(to_json_array(entry));
+        }
+
+        *_output = to_bytes_buffer(entries.dump());
+
+        return 0;
+    }
+
+    const operation op = rs_read_collection_batch;
+    #define CALL_READ_COLLECTION_BATCH call_read_collection_batch
+} // anonymous namespace
+
+#else // RODS_SERVER
+
+//
+// Client-side Implementation
+//
+
+namespace
+{
+    using operation = std::function<int(rsComm_t*, bytesBuf_t*, bytesBuf_t**)>;
+    const operation op{};
+    #define CALL_READ_COLLECTION_BATCH nullptr
+} // anonymous namespace
+
+#endif // RODS_SERVER
+
+// The plugin factory function must always be defined.
+extern "C"
+auto plugin_factory(const std::string& _instance_name,
+                    const std::string& _context) -> irods::api_entry*
+{
+#ifdef RODS_SERVER
+    irods::client_api_whitelist::instance().add(READ_COLLECTION_BATCH_APN);
+#endif // RODS_SERVER
+
+    // clang-format off
+    irods::apidef_t def{READ_COLLECTION_BATCH_APN,      // API number
+                        RODS_API_VERSION,               // API version
+                        REMOTE_USER_AUTH,               // Client auth
+                        REMOTE_USER_AUTH,               // Proxy auth
+                        "BytesBuf_PI", 0,               // In PI / bs flag
+                        "BytesBuf_PI", 0,               // Out PI / bs flag
+                        op,                             // Operation
+                        "api_read_collection_batch",    // Operation name
+                        nullptr,                        // Null clear function
+                        (funcPtr) CALL_READ_COLLECTION_BATCH};
+    // clang-format on
+
+    auto* api = new irods::api_entry{def};
+
+    api->in_pack_key = "BytesBuf_PI";
+    api->in_pack_value = BytesBuf_PI;
+
+    api->out_pack_key = "BytesBuf_PI";
+    api->out_pack_value = BytesBuf_PI;
+
+    return api;
+}
@@ -16,9 +16,12 @@
 
 #include "replica_close.h"
 
+#include "catalog_commit_queue.hpp"
 #include "objDesc.hpp"
 #include "rsFileClose.hpp"
 #include "rsFileStat.hpp"
+#include "rsGenQuery.hpp"
+#include "icatDefines.h"
 #include "rsModDataObjMeta.hpp"
 #include "irods_server_api_call.hpp"
 #include "irods_re_serialization.hpp"
@@ -28,6 +31,8 @@
 #include "irods_exception.hpp"
 #include "replica_access_table.hpp"
 #include "irods_logger.hpp"
+#include "irods_at_scope_exit.hpp"
+#include "irods_re_structs.hpp"
 
 #define IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
 #include "filesystem.hpp"
@@ -51,6 +56,7 @@ namespace
 {
     namespace ix = irods::experimental;
     namespace fs = irods::experimental::filesystem;
+    namespace ic = irods::experimental::catalog;
 
     // clang-format off
     using json      = nlohmann::json;
@@ -100,6 +106,15 @@ namespace
                                std::string_view _new_status,
                                bool _send_notifications) -> int;
 
+    auto check_permission_to_modify_replica(rsComm_t& _comm, const l1desc_t& _l1desc) -> int;
+
+    auto commit_replica_update(rsComm_t& _comm,
+                               ic::commit_queue& _queue,
+                               const l1desc_t& _l1desc,
+                               bool _update_size,
+                               bool _update_status,
+                               bool _send_notifications) -> int;
+
     auto free_l1_descriptor(int _l1desc_index) -> int;
 
     //
@@ -303,6 +318,137 @@ namespace
         return rsModDataObjMeta(&_comm, &input);
     }
 
+    auto check_permission_to_modify_replica(rsComm_t& _comm, const l1desc_t& _l1desc) -> int
+    {
+        // The same check the database plugin makes before it modifies a replica.
+        genQueryInp_t input{};
+        genQueryOut_t* output{};
+
+        irods::at_scope_exit free_query{[&input, &output] {
+            clearGenQueryInp(&input);
+            freeGenQueryOut(&output);
+        }};
+
+        addKeyVal(&input.condInput, USER_NAME_CLIENT_KW, _comm.clientUser.userName);
+        addKeyVal(&input.condInput, RODS_ZONE_CLIENT_KW, _comm.clientUser.rodsZone);
+        addKeyVal(&input.condInput, ACCESS_PERMISSION_KW, ACCESS_MODIFY_METADATA);
+
+        const auto condition = fmt::format("= '{}'", _l1desc.dataObjInfo->dataId);
+        addInxVal(&input.sqlCondInp, COL_D_DATA_ID, condition.data());
+        addInxIval(&input.selectInp, COL_D_DATA_ID, 1);
+
+        input.maxRows = 1;
+
+        if (const auto ec = rsGenQuery(&_comm, &input, &output); ec < 0) {
+            return CAT_NO_ROWS_FOUND == ec ? CAT_NO_ACCESS_PERMISSION : ec;
+        }
+
+        return 0;
+    }
+
+    auto commit_replica_update(rsComm_t& _comm,
+                               ic::commit_queue& _queue,
+                               const l1desc_t& _l1desc,
+                               bool _update_size,
+                               bool _update_status,
+                               bool _send_notifications) -> int
+    {
+        ic::replica_update update;
+        update.data_id = _l1desc.dataObjInfo->dataId;
+        update.resc_id = _l1desc.dataObjInfo->rescId;
+
+        if (_update_size) {
+            const auto size_on_disk = get_file_size(_comm, _l1desc);
+
+            if (size_on_disk < 0) {
+                log::api::error("Failed to retrieve the replica's size on disk [error_code={}].", size_on_disk);
+                return size_on_disk;
+            }
+
+            // If the size of the replica has changed since opening it, then update the size.
+            if (_l1desc.dataObjInfo->dataSize != size_on_disk) {
+                update.size = size_on_disk;
+                update.modify_ts = current_time_in_seconds();
+            }
+            // If the contents of the replica has changed, then update the last modified timestamp.
+            else if (_l1desc.bytesWritten > 0) {
+                update.modify_ts = current_time_in_seconds();
+            }
+        }
+
+        if (_update_status) {
+            update.replica_status = GOOD_REPLICA;
+        }
+
+        if (!update.size && !update.modify_ts && !update.replica_status) {
+            return 0;
+        }
+
+        // The policy of rsModDataObjMeta sees the same input as it would for an
+        // immediate update.
+        dataObjInfo_t info{};
+        std::strncpy(info.objPath, _l1desc.dataObjInfo->objPath, MAX_NAME_LEN);
+        std::strncpy(info.rescHier, _l1desc.dataObjInfo->rescHier, MAX_NAME_LEN);
+
+        keyValPair_t reg_params{};
+        irods::at_scope_exit clear_reg_params{[&reg_params] { clearKeyVal(&reg_params); }};
+
+        if (update.replica_status) {
+            addKeyVal(&reg_params, REPL_STATUS_KW, REPLICA_STATUS_GOOD);
+        }
+
+        if (update.size) {
+            addKeyVal(&reg_params, DATA_SIZE_KW, std::to_string(*update.size).data());
+        }
+
+        if (update.modify_ts) {
+            addKeyVal(&reg_params, DATA_MODIFY_KW, update.modify_ts->data());
+        }
+
+        // Possibly triggers file modified notification.
+        if (_send_notifications) {
+            addKeyVal(&reg_params, OPEN_TYPE_KW, std::to_string(_l1desc.openType).data());
+        }
+
+        ruleExecInfo_t rei{};
+        rei.rsComm = &_comm;
+        rei.uoic = &_comm.clientUser;
+        rei.uoip = &_comm.proxyUser;
+        rei.doi = &info;
+        rei.condInputData = &reg_params;
+
+        if (auto ec = applyRule("acPreProcForModifyDataObjMeta", nullptr, &rei, NO_SAVE_REI); ec < 0) {
+            ec = rei.status < 0 ? rei.status : ec;
+            log::api::error("acPreProcForModifyDataObjMeta failed [error_code={}].", ec);
+            return ec;
+        }
+
+        if (const auto ec = check_permission_to_modify_replica(_comm, _l1desc); ec < 0) {
+            log::api::error("Not permitted to modify the replica [error_code={}].", ec);
+            return ec;
+        }
+
+        if (const auto ec = _queue.submit(update); ec < 0) {
+            return ec;
+        }
+
+        if (auto ec = applyRule("acPostProcForModifyDataObjMeta", nullptr, &rei, NO_SAVE_REI); ec < 0) {
+            ec = rei.status < 0 ? rei.status : ec;
+            log::api::error("acPostProcForModifyDataObjMeta failed [error_code={}].", ec);
+            return ec;
+        }
+
+        if (!_send_notifications || (OPEN_FOR_WRITE_TYPE != _l1desc.openType && CREATE_TYPE != _l1desc.openType)) {
+            return 0;
+        }
+
+        modDataObjMeta_t input{};
+        input.dataObjInfo = &info;
+        input.regParam = &reg_params;
+
+        return _call_file_modified_for_modification(&_comm, &input);
+    }
+
     auto free_l1_descriptor(int _l1desc_index) -> int
     {
         if (const auto ec = freeL1desc(_l1desc_index); ec != 0) {
@@ -337,7 +483,7 @@ namespace
             return ec;
         }
 
-        if (l1desc_index < 3 || l1desc_index >= NUM_L1_DESC) {
+        if (l1desc_index < 3 || l1desc_index >= L1desc.size()) {
             log::api::error("L1 descriptor index is out of range [error_code={}, fd={}].", BAD_INPUT_DESC_INDEX, l1desc_index);
             return BAD_INPUT_DESC_INDEX;
         }
@@ -374,9 +520,22 @@ namespace
             if (is_write_operation) {
                 const auto update_size = !json_input.contains("update_size") || json_input.at("update_size").get<bool>();
                 const auto update_status = !json_input.contains("update_status") || json_input.at("update_status").get<bool>();
+                const auto compute_checksum = json_input.contains("compute_checksum") && json_input.at("compute_checksum").get<bool>();
+
+                // Update the replica's information in the catalog if requested. When group commits
+                // are enabled, the update is committed together with those of the closes in other
+                // agents, unless the session uses a ticket or the replica is not registered yet.
+                auto* queue = ic::replica_update_queue();
+                const auto is_registered = l1desc.dataObjInfo->dataId > 0 && l1desc.dataObjInfo->rescId > 0;
 
-                // Update the replica's information in the catalog if requested.
-                if (update_size && update_status) {
+                if (queue && is_registered && (update_size || update_status)) {
+                    if (const auto ec = commit_replica_update(*_comm, *queue, l1desc, update_size, update_status, send_notifications); ec != 0) {
+                        log::api::error("Failed to update the replica information in the catalog [error_code={}].", ec);
+                        update_replica_status(*_comm, l1desc, REPLICA_STATUS_STALE, send_notifications);
+                        return ec;
+                    }
+                }
+                else if (update_size && update_status) {
                     if (const auto ec = update_replica_size_and_status(*_comm, l1desc, send_notifications); ec != 0) {
                         log::api::error("Failed to update the replica size and status in the catalog [error_code={}].", ec);
                         update_replica_status(*_comm, l1desc, REPLICA_STATUS_STALE, send_notifications);
@@ -399,7 +558,7 @@ namespace
                 }
 
                 // [Re]compute a checksum for the replica if requested.
-                if (json_input.contains("compute_checksum") && json_input.at("compute_checksum").get<bool>()) {
+                if (compute_checksum) {
                     const auto& info = *l1desc.dataObjInfo;
                     constexpr const auto calculation = irods::experimental::replica::verification_calculation::always;
                     irods::experimental::replica::replica_checksum(*_comm, info.objPath, info.replNum, calculation);
@@ -34,6 +34,7 @@
 #include "irods_error.hpp"
 #include "irods_stacktrace.hpp"
 #include "irods_server_properties.hpp"
+#include "irods_tracing.hpp"
 
 #include <cctype>
 #include <string>
@@ -87,6 +88,36 @@ static const short MAX_NUMBER_ICAT_COLUMS = 32;
 static SQLLEN resultDataSizeArray[ MAX_NUMBER_ICAT_COLUMS ];
 
 
+/*
+  Execute a statement inside a trace span named after its first keyword
+  (e.g. "db select"). Only the text of the statement is recorded, never
+  the values of the bind variables.
+*/
+static SQLRETURN
+execSqlTraced( icatSessionStruct* icss, HSTMT hstmt, const char* sql ) {
+    irods::experimental::tracing::span span{"db", irods::experimental::tracing::span_kind::client};
+
+    if ( span.recording() ) {
+        std::string operation = "db ";
+
+        for ( const char* p = sql; *p && !std::isspace( static_cast<unsigned char>( *p ) ); ++p ) {
+            operation += static_cast<char>( std::tolower( static_cast<unsigned char>( *p ) ) );
+        }
+
+        span.set_name( operation );
+        span.set_attribute( "db.system", icss->database_plugin_type );
+        span.set_attribute( "db.statement", sql );
+    }
+
+    const SQLRETURN stat = SQLExecDirect( hstmt, ( unsigned char * )sql, strlen( sql ) );
+
+    if ( stat == SQL_ERROR ) {
+        span.set_error( "SQL_ERROR" );
+    }
+
+    return stat;
+}
+
 /*
   call SQLError to get error information and log it
 */
@@ -462,7 +493,7 @@ _cllExecSqlNoResult(
 
     rodsLogSql( sql );
 
-    stat = SQLExecDirect( myHstmt, ( unsigned char * )sql, strlen( sql ) );
+    stat = execSqlTraced( icss, myHstmt, sql );
     SQL_INT_OR_LEN rowCount = 0;
     SQLRowCount( myHstmt, ( SQL_INT_OR_LEN * )&rowCount );
     switch ( stat ) {
@@ -586,7 +617,7 @@ cllExecSqlWithResult( icatSessionStruct *icss, int *stmtNum, const char *sql ) {
     }
 
     rodsLogSql( sql );
-    stat = SQLExecDirect( hstmt, ( unsigned char * )sql, strlen( sql ) );
+    stat = execSqlTraced( icss, hstmt, sql );
 
     switch ( stat ) {
     case SQL_SUCCESS:
@@ -771,7 +802,7 @@ cllExecSqlWithResultBV(
         }
     }
     rodsLogSql( sql );
-    stat = SQLExecDirect( hstmt, ( unsigned char * )sql, strlen( sql ) );
+    stat = execSqlTraced( icss, hstmt, sql );
 
     switch ( stat ) {
     case SQL_SUCCESS:
@@ -0,0 +1,1318 @@
+////////////////////////////////////////////////////////////////////////////
+// Plugin defining a block compression resource.
+//
+// Stores the replicas on its only child in independent compressed blocks,
+// followed by an index of the blocks, so that any range of a replica can be
+// read without inflating what comes before it.
+////////////////////////////////////////////////////////////////////////////
+
+// =-=-=-=-=-=-=-
+// irods includes
+#include "msParam.h"
+#include "rcConnect.h"
+#include "miscServerFunct.hpp"
+
+// =-=-=-=-=-=-=-
+#include "irods_resource_plugin.hpp"
+#include "irods_file_object.hpp"
+#include "irods_collection_object.hpp"
+#include "irods_hierarchy_parser.hpp"
+#include "irods_error.hpp"
+#include "irods_kvp_string_parser.hpp"
+#include "irods_resource_redirect.hpp"
+#include "irods_logger.hpp"
+#include "block_compression.hpp"
+
+// =-=-=-=-=-=-=-
+// stl includes
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// =-=-=-=-=-=-=-
+// system includes
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace bc = irods::experimental::block_compression;
+
+// =-=-=-=-=-=-=-
+// 1. Define utility functions that the operations might need
+const std::string BLOCK_SIZE( "block_size" );
+const std::string COMPRESSION_LEVEL( "compression_level" );
+const std::string THREADS( "threads" );
+const std::string READAHEAD( "readahead" );
+const std::string BLOCKCOMPRESS_CONFIG( "blockcompress_config" ); // parsed form of the keys above
+
+// The largest read or write handed to the child at once.
+constexpr std::size_t MAX_CHILD_IO_SIZE = 16 * 1024 * 1024;
+
+struct blockcompress_config {
+    std::uint32_t block_size        = bc::default_block_size;
+    int           compression_level = 1;
+    int           threads           = 4;
+    std::size_t   readahead         = 4;
+};
+
+// =-=-=-=-=-=-=-
+// A writer shared by the descriptors open for writing on a replica. Parallel
+// transfers open the replica once per thread, and only the last close writes
+// the index.
+struct shared_writer {
+    std::mutex                    mutex;
+    std::unique_ptr< bc::writer > writer;
+    int                           descriptors = 0;
+};
+
+// =-=-=-=-=-=-=-
+// State of the descriptors handed to the server, keyed by the descriptor of
+// the child
+struct open_replica {
+    std::string                       path;
+    std::shared_ptr< shared_writer >  writer;
+
+    // Set when a compressed replica is open for reading
+    std::unique_ptr< bc::reader >     reader;
+    std::int64_t                      offset = 0;
+};
+
+static std::mutex open_replicas_mutex;
+static std::unordered_map< int, open_replica > open_replicas;
+static std::unordered_map< std::string, std::shared_ptr< shared_writer > > shared_writers;
+
+// =-=-=-=-=-=-=-
+/// @brief Returns the first child resource of the specified resource
+irods::error blockcompress_get_first_child_resc(
+    irods::plugin_property_map& _props,
+    irods::resource_ptr&        _resc ) {
+
+    irods::resource_child_map* cmap_ref;
+    _props.get< irods::resource_child_map* >(
+            irods::RESC_CHILD_MAP_PROP,
+            cmap_ref );
+
+    if ( cmap_ref->size() != 1 ) {
+        return ERROR( -1, fmt::format( "blockcompress_get_first_child_resc - Block compression resource can have 1 and only 1 child. This resource has {}", cmap_ref->size() ) );
+    }
+
+    _resc = cmap_ref->begin()->second.second;
+    return SUCCESS();
+
+} // blockcompress_get_first_child_resc
+
+// =-=-=-=-=-=-=-
+/// @brief Check the general parameters passed in to most plugin functions
+irods::error blockcompress_check_params(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = _ctx.valid();
+    if ( !ret.ok() ) {
+        return PASSMSG( " - resource context is invalid.", ret );
+    }
+
+    return SUCCESS();
+
+} // blockcompress_check_params
+
+blockcompress_config blockcompress_get_config(
+    irods::plugin_context& _ctx ) {
+    blockcompress_config config;
+    _ctx.prop_map().get< blockcompress_config >( BLOCKCOMPRESS_CONFIG, config );
+    return config;
+
+} // blockcompress_get_config
+
+// =-=-=-=-=-=-=-
+/// @brief Calls _operation on the child with the file object of _ctx
+template< typename... types_t >
+irods::error blockcompress_forward(
+    irods::plugin_context& _ctx,
+    const std::string&     _operation,
+    types_t...             _args ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    ret = resc->call< types_t... >( _ctx.comm(), _operation, _ctx.fco(), _args... );
+    return PASSMSG( fmt::format( "failed calling child {}.", _operation ), ret );
+
+} // blockcompress_forward
+
+// =-=-=-=-=-=-=-
+/// @brief Moves the descriptor of _fco on the child to _offset
+void blockcompress_child_seek(
+    rsComm_t*                     _comm,
+    irods::resource_ptr&          _child,
+    const irods::file_object_ptr& _fco,
+    long long                     _offset,
+    int                           _whence,
+    long long*                    _position = nullptr ) {
+    irods::error ret = _child->call< const long long, const int >(
+                           _comm, irods::RESOURCE_OP_LSEEK, _fco, _offset, _whence );
+    if ( !ret.ok() ) {
+        THROW( ret.code(), ret.result() );
+    }
+
+    if ( _position ) {
+        *_position = ret.code();
+    }
+
+} // blockcompress_child_seek
+
+// =-=-=-=-=-=-=-
+/// @brief Returns positioned I/O on the replica open on the child through _fco
+bc::file_io blockcompress_child_io(
+    rsComm_t*              _comm,
+    irods::resource_ptr    _child,
+    irods::file_object_ptr _fco ) {
+    bc::file_io io;
+
+    io.read = [ = ]( std::int64_t _offset, void* _buffer, std::size_t _size ) mutable -> std::size_t {
+        blockcompress_child_seek( _comm, _child, _fco, _offset, SEEK_SET );
+
+        std::size_t total = 0;
+        while ( total < _size ) {
+            const int len = static_cast< int >( std::min( _size - total, MAX_CHILD_IO_SIZE ) );
+            irods::error ret = _child->call< void*, const int >(
+                                   _comm, irods::RESOURCE_OP_READ, _fco, static_cast< char* >( _buffer ) + total, len );
+            if ( !ret.ok() ) {
+                THROW( ret.code(), ret.result() );
+            }
+
+            if ( 0 == ret.code() ) {
+                break;
+            }
+
+            total += ret.code();
+        }
+
+        return total;
+    };
+
+    io.write = [ = ]( std::int64_t _offset, const void* _buffer, std::size_t _size ) mutable {
+        blockcompress_child_seek( _comm, _child, _fco, _offset, SEEK_SET );
+
+        std::size_t total = 0;
+        while ( total < _size ) {
+            const int len = static_cast< int >( std::min( _size - total, MAX_CHILD_IO_SIZE ) );
+            irods::error ret = _child->call< const void*, const int >(
+                                   _comm, irods::RESOURCE_OP_WRITE, _fco, static_cast< const char* >( _buffer ) + total, len );
+            if ( !ret.ok() ) {
+                THROW( ret.code(), ret.result() );
+            }
+
+            if ( ret.code() <= 0 ) {
+                THROW( SYS_COPY_LEN_ERR, fmt::format( "short write to [{}]", _fco->physical_path() ) );
+            }
+
+            total += ret.code();
+        }
+    };
+
+    return io;
+
+} // blockcompress_child_io
+
+// =-=-=-=-=-=-=-
+/// @brief Returns the size of the replica open on the child through _fco
+std::int64_t blockcompress_child_size(
+    rsComm_t*                     _comm,
+    irods::resource_ptr&          _child,
+    const irods::file_object_ptr& _fco ) {
+    long long size = 0;
+    blockcompress_child_seek( _comm, _child, _fco, 0, SEEK_END, &size );
+    return size;
+
+} // blockcompress_child_size
+
+// =-=-=-=-=-=-=-
+/// @brief Opens the replica of _ctx on the child through a copy of its file
+///        object, leaving the descriptor of _ctx untouched
+irods::error blockcompress_open_copy(
+    irods::plugin_context&  _ctx,
+    irods::resource_ptr&    _child,
+    int                     _flags,
+    irods::file_object_ptr& _copy ) {
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    if ( !fco ) {
+        return ERROR( SYS_INVALID_INPUT_PARAM, "blockcompress_open_copy - not a file object." );
+    }
+
+    _copy.reset( new irods::file_object( *fco ) );
+    _copy->flags( _flags );
+
+    irods::error ret = _child->call( _ctx.comm(), irods::RESOURCE_OP_OPEN, _copy );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed calling child open.", ret );
+    }
+
+    return SUCCESS();
+
+} // blockcompress_open_copy
+
+// =-=-=-=-=-=-=-
+/// @brief Starts a new writer for the replica open on the child as _fd.
+///        open_replicas_mutex must be held.
+void blockcompress_add_writer(
+    const blockcompress_config& _config,
+    const std::string&          _path,
+    int                         _fd,
+    bc::block_index             _index,
+    std::int64_t                _end ) {
+    auto shared = std::make_shared< shared_writer >();
+    shared->writer = std::make_unique< bc::writer >( std::move( _index ), _end, _config.threads, _config.compression_level );
+    shared->descriptors = 1;
+
+    shared_writers[ _path ] = shared;
+
+    auto& replica = open_replicas[ _fd ];
+    replica.path = _path;
+    replica.writer = shared;
+
+} // blockcompress_add_writer
+
+// =-=-=-=-=-=-=-
+/// @brief Writes the index of a finished writer and logs how well it compressed
+void blockcompress_finish(
+    bc::writer&        _writer,
+    const bc::file_io& _io,
+    const std::string& _path ) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto file_size = _writer.finish( _io );
+    const auto elapsed = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+
+    irods::experimental::log::resource::debug(
+        "blockcompress: wrote [{}] with {} bytes of content in {} bytes, ratio {:.2f}, index written in {:.3f}s",
+        _path, _writer.size(), file_size,
+        _writer.bytes_compressed() > 0
+            ? static_cast< double >( _writer.bytes_stored() ) / _writer.bytes_compressed()
+            : 1.0,
+        elapsed );
+
+} // blockcompress_finish
+
+// =-=-=-=-=-=-=-
+// 2. Define operations which will be called by the file*
+//    calls declared in server/driver/include/fileDriver.h
+// =-=-=-=-=-=-=-
+
+// =-=-=-=-=-=-=-
+// interface for POSIX create
+irods::error blockcompress_file_create(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto config = blockcompress_get_config( _ctx );
+
+    std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+    ret = resc->call( _ctx.comm(), irods::RESOURCE_OP_CREATE, _ctx.fco() );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed calling child create.", ret );
+    }
+
+    bc::block_index index;
+    index.block_size = config.block_size;
+    blockcompress_add_writer( config, fco->physical_path(), fco->file_descriptor(), std::move( index ), 0 );
+
+    return ret;
+
+} // blockcompress_file_create
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Open
+irods::error blockcompress_file_open(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto config = blockcompress_get_config( _ctx );
+    const std::string path = fco->physical_path();
+    const int flags = fco->flags();
+
+    // =-=-=-=-=-=-=-
+    // readers get a reader of their own, or read the child directly when the
+    // replica was not written by this resource, e.g. registered in place
+    if ( O_RDONLY == ( flags & O_ACCMODE ) ) {
+        ret = resc->call( _ctx.comm(), irods::RESOURCE_OP_OPEN, _ctx.fco() );
+        if ( !ret.ok() ) {
+            return PASSMSG( "failed calling child open.", ret );
+        }
+
+        try {
+            const auto io = blockcompress_child_io( _ctx.comm(), resc, fco );
+            auto index = bc::read_index( io, blockcompress_child_size( _ctx.comm(), resc, fco ) );
+            blockcompress_child_seek( _ctx.comm(), resc, fco, 0, SEEK_SET );
+
+            if ( index ) {
+                auto reader = std::make_unique< bc::reader >( std::move( *index ), config.threads, config.readahead );
+
+                std::lock_guard< std::mutex > lock( open_replicas_mutex );
+                auto& replica = open_replicas[ fco->file_descriptor() ];
+                replica.path = path;
+                replica.reader = std::move( reader );
+            }
+        }
+        catch ( const irods::exception& e ) {
+            resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, _ctx.fco() );
+            return irods::error( e );
+        }
+
+        return ret;
+    }
+
+    // =-=-=-=-=-=-=-
+    // held across the child open so that the first writers of a replica agree
+    // on who reads its index
+    std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+    // =-=-=-=-=-=-=-
+    // the block index is kept by the shared writer of this agent only. a writer
+    // in another agent would write an index of its own blocks over this one
+    if ( getValByKey( &fco->cond_input(), REPLICA_TOKEN_KW ) && 0 == shared_writers.count( path ) ) {
+        return ERROR( USER_INTERMEDIATE_REPLICA_ACCESS,
+                      fmt::format( "[{}] is being written by another agent; "
+                                   "the blockcompress resource does not support shared replica tokens.", path ) );
+    }
+
+    if ( auto itr = shared_writers.find( path ); itr != shared_writers.end() ) {
+        // Another descriptor is writing the replica. Do not truncate what it wrote.
+        fco->flags( flags & ~O_TRUNC );
+        ret = resc->call( _ctx.comm(), irods::RESOURCE_OP_OPEN, _ctx.fco() );
+        fco->flags( flags );
+        if ( !ret.ok() ) {
+            return PASSMSG( "failed calling child open.", ret );
+        }
+
+        ++itr->second->descriptors;
+        auto& replica = open_replicas[ fco->file_descriptor() ];
+        replica.path = path;
+        replica.writer = itr->second;
+
+        return ret;
+    }
+
+    ret = resc->call( _ctx.comm(), irods::RESOURCE_OP_OPEN, _ctx.fco() );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed calling child open.", ret );
+    }
+
+    try {
+        bc::block_index index;
+        index.block_size = config.block_size;
+        std::int64_t end = 0;
+
+        if ( !( flags & O_TRUNC ) ) {
+            end = blockcompress_child_size( _ctx.comm(), resc, fco );
+
+            if ( auto existing = bc::read_index( blockcompress_child_io( _ctx.comm(), resc, fco ), end ); existing ) {
+                index = std::move( *existing );
+            }
+            else if ( end > 0 ) {
+                // A replica which was not written by this resource is updated as it is.
+                blockcompress_child_seek( _ctx.comm(), resc, fco, 0, SEEK_SET );
+                return ret;
+            }
+        }
+
+        blockcompress_add_writer( config, path, fco->file_descriptor(), std::move( index ), end );
+    }
+    catch ( const irods::exception& e ) {
+        resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, _ctx.fco() );
+        return irods::error( e );
+    }
+
+    return ret;
+
+} // blockcompress_file_open
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Read
+irods::error blockcompress_file_read(
+    irods::plugin_context& _ctx,
+    void*                  _buf,
+    const int              _len ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+
+    std::unique_lock< std::mutex > lock( open_replicas_mutex );
+    auto itr = open_replicas.find( fco->file_descriptor() );
+
+    if ( itr == open_replicas.end() ) {
+        lock.unlock();
+        ret = resc->call< void*, const int >( _ctx.comm(), irods::RESOURCE_OP_READ, _ctx.fco(), _buf, _len );
+        return PASSMSG( "failed calling child read.", ret );
+    }
+
+    auto& replica = itr->second;
+    lock.unlock();
+
+    // A descriptor is used by one thread at a time, so its own state needs no lock.
+    irods::error result = SUCCESS();
+
+    try {
+        const auto io = blockcompress_child_io( _ctx.comm(), resc, fco );
+        std::size_t n = 0;
+
+        if ( replica.reader ) {
+            n = replica.reader->read( replica.offset, _buf, _len, io );
+        }
+        else {
+            std::lock_guard< std::mutex > writer_lock( replica.writer->mutex );
+            n = replica.writer->writer->read( replica.offset, _buf, _len, io );
+        }
+
+        replica.offset += n;
+        result.code( n );
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+    }
+
+    return result;
+
+} // blockcompress_file_read
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Write
+irods::error blockcompress_file_write(
+    irods::plugin_context& _ctx,
+    const void*            _buf,
+    const int              _len ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+
+    std::unique_lock< std::mutex > lock( open_replicas_mutex );
+    auto itr = open_replicas.find( fco->file_descriptor() );
+
+    if ( itr == open_replicas.end() || !itr->second.writer ) {
+        lock.unlock();
+        ret = resc->call< const void*, const int >( _ctx.comm(), irods::RESOURCE_OP_WRITE, _ctx.fco(), _buf, _len );
+        return PASSMSG( "failed calling child write.", ret );
+    }
+
+    auto& replica = itr->second;
+    lock.unlock();
+
+    irods::error result = SUCCESS();
+
+    try {
+        const auto io = blockcompress_child_io( _ctx.comm(), resc, fco );
+
+        std::lock_guard< std::mutex > writer_lock( replica.writer->mutex );
+        replica.writer->writer->write( replica.offset, _buf, _len, io );
+        replica.offset += _len;
+        result.code( _len );
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+    }
+
+    return result;
+
+} // blockcompress_file_write
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Close
+irods::error blockcompress_file_close(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    irods::error result = SUCCESS();
+
+    {
+        // =-=-=-=-=-=-=-
+        // held while the index is written so that a new open does not read a
+        // replica which is half finished
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+        if ( auto itr = open_replicas.find( fco->file_descriptor() ); itr != open_replicas.end() ) {
+            auto replica = std::move( itr->second );
+            open_replicas.erase( itr );
+
+            if ( replica.writer && 0 == --replica.writer->descriptors ) {
+                shared_writers.erase( replica.path );
+
+                try {
+                    std::lock_guard< std::mutex > writer_lock( replica.writer->mutex );
+                    blockcompress_finish( *replica.writer->writer,
+                                          blockcompress_child_io( _ctx.comm(), resc, fco ),
+                                          replica.path );
+                }
+                catch ( const irods::exception& e ) {
+                    result = irods::error( e );
+                    irods::log( result );
+                }
+            }
+        }
+    }
+
+    ret = resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, _ctx.fco() );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed calling child close.", ret );
+    }
+
+    return result.ok() ? ret : result;
+
+} // blockcompress_file_close
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Unlink
+irods::error blockcompress_file_unlink(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_UNLINK );
+
+} // blockcompress_file_unlink
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Stat
+irods::error blockcompress_file_stat(
+    irods::plugin_context& _ctx,
+    struct stat*           _statbuf ) {
+    irods::error ret = blockcompress_forward< struct stat* >( _ctx, irods::RESOURCE_OP_STAT, _statbuf );
+    if ( !ret.ok() || !S_ISREG( _statbuf->st_mode ) ) {
+        return ret;
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    if ( !fco ) {
+        return ret;
+    }
+
+    // =-=-=-=-=-=-=-
+    // report the size of the content rather than the size of the blocks
+    {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+        if ( auto itr = shared_writers.find( fco->physical_path() ); itr != shared_writers.end() ) {
+            std::lock_guard< std::mutex > writer_lock( itr->second->mutex );
+            _statbuf->st_size = itr->second->writer->size();
+            return ret;
+        }
+    }
+
+    irods::resource_ptr resc;
+    blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+
+    irods::file_object_ptr copy;
+    irods::error open_ret = blockcompress_open_copy( _ctx, resc, O_RDONLY, copy );
+    if ( !open_ret.ok() ) {
+        return PASS( open_ret );
+    }
+
+    irods::error result = ret;
+
+    try {
+        const auto index = bc::read_index( blockcompress_child_io( _ctx.comm(), resc, copy ), _statbuf->st_size );
+        if ( index ) {
+            _statbuf->st_size = index->size;
+        }
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+    }
+
+    resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, copy );
+
+    return result;
+
+} // blockcompress_file_stat
+
+// =-=-=-=-=-=-=-
+// interface for POSIX lseek
+irods::error blockcompress_file_lseek(
+    irods::plugin_context& _ctx,
+    const long long        _offset,
+    const int              _whence ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+
+    {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+        auto itr = open_replicas.find( fco->file_descriptor() );
+
+        // =-=-=-=-=-=-=-
+        // compressed replicas are read and written at a position of our own
+        if ( itr != open_replicas.end() ) {
+            auto& replica = itr->second;
+            long long position = -1;
+
+            switch ( _whence ) {
+                case SEEK_SET: position = _offset; break;
+                case SEEK_CUR: position = replica.offset + _offset; break;
+                case SEEK_END:
+                    if ( replica.reader ) {
+                        position = replica.reader->size() + _offset;
+                    }
+                    else {
+                        std::lock_guard< std::mutex > writer_lock( replica.writer->mutex );
+                        position = replica.writer->writer->size() + _offset;
+                    }
+                    break;
+            }
+
+            if ( position < 0 ) {
+                return ERROR( UNIX_FILE_LSEEK_ERR - EINVAL,
+                              fmt::format( "Lseek error for \"{}\", offset = {}, whence = {}.",
+                                           fco->physical_path(), _offset, _whence ) );
+            }
+
+            replica.offset = position;
+
+            irods::error result = SUCCESS();
+            result.code( position );
+            return result;
+        }
+    }
+
+    return blockcompress_forward< const long long, const int >( _ctx, irods::RESOURCE_OP_LSEEK, _offset, _whence );
+
+} // blockcompress_file_lseek
+
+// =-=-=-=-=-=-=-
+// interface for POSIX mkdir
+irods::error blockcompress_file_mkdir(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_MKDIR );
+
+} // blockcompress_file_mkdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX rmdir
+irods::error blockcompress_file_rmdir(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_RMDIR );
+
+} // blockcompress_file_rmdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX opendir
+irods::error blockcompress_file_opendir(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_OPENDIR );
+
+} // blockcompress_file_opendir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX closedir
+irods::error blockcompress_file_closedir(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_CLOSEDIR );
+
+} // blockcompress_file_closedir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX readdir
+irods::error blockcompress_file_readdir(
+    irods::plugin_context& _ctx,
+    struct rodsDirent**    _dirent_ptr ) {
+    return blockcompress_forward< struct rodsDirent** >( _ctx, irods::RESOURCE_OP_READDIR, _dirent_ptr );
+
+} // blockcompress_file_readdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX rename
+irods::error blockcompress_file_rename(
+    irods::plugin_context& _ctx,
+    const char*            _new_file_name ) {
+    return blockcompress_forward< const char* >( _ctx, irods::RESOURCE_OP_RENAME, _new_file_name );
+
+} // blockcompress_file_rename
+
+// =-=-=-=-=-=-=-
+// interface to determine free space on a device given a path
+irods::error blockcompress_file_getfs_freespace(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_FREESPACE );
+
+} // blockcompress_file_getfs_freespace
+
+// =-=-=-=-=-=-=-
+// blockcompress_file_truncate - truncates the content of a compressed replica
+irods::error blockcompress_file_truncate(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto config = blockcompress_get_config( _ctx );
+
+    std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+    // =-=-=-=-=-=-=-
+    // a replica open for writing is truncated by its writer, through the
+    // descriptor of one of its writers
+    if ( auto itr = shared_writers.find( fco->physical_path() ); itr != shared_writers.end() ) {
+        auto open = std::find_if( open_replicas.begin(), open_replicas.end(), [ &itr ]( auto&& _entry ) {
+            return _entry.second.writer == itr->second;
+        } );
+
+        if ( open == open_replicas.end() ) {
+            return ERROR( SYS_INTERNAL_ERR, fmt::format( "no descriptor writes [{}]", fco->physical_path() ) );
+        }
+
+        irods::file_object_ptr writer_fco( new irods::file_object( *fco ) );
+        writer_fco->file_descriptor( open->first );
+
+        try {
+            std::lock_guard< std::mutex > writer_lock( itr->second->mutex );
+            itr->second->writer->truncate( fco->size(), blockcompress_child_io( _ctx.comm(), resc, writer_fco ) );
+        }
+        catch ( const irods::exception& e ) {
+            return irods::error( e );
+        }
+
+        return SUCCESS();
+    }
+
+    irods::file_object_ptr copy;
+    ret = blockcompress_open_copy( _ctx, resc, O_RDWR, copy );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    irods::error result = SUCCESS();
+    bool compressed = false;
+
+    try {
+        const auto io = blockcompress_child_io( _ctx.comm(), resc, copy );
+        const auto end = blockcompress_child_size( _ctx.comm(), resc, copy );
+
+        if ( auto index = bc::read_index( io, end ); index ) {
+            compressed = true;
+
+            bc::writer writer{ std::move( *index ), end, config.threads, config.compression_level };
+            writer.truncate( fco->size(), io );
+            blockcompress_finish( writer, io, copy->physical_path() );
+        }
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+    }
+
+    resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, copy );
+
+    if ( !result.ok() || compressed ) {
+        return result;
+    }
+
+    // A replica which was not written by this resource is truncated as it is.
+    ret = resc->call( _ctx.comm(), irods::RESOURCE_OP_TRUNCATE, _ctx.fco() );
+    return PASSMSG( "failed calling child truncate.", ret );
+
+} // blockcompress_file_truncate
+
+// =-=-=-=-=-=-=-
+// blockcompress_file_stage_to_cache - inflates the replica into the cache file
+irods::error blockcompress_file_stage_to_cache(
+    irods::plugin_context& _ctx,
+    const char*            _cache_file_name ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto config = blockcompress_get_config( _ctx );
+
+    irods::file_object_ptr copy;
+    ret = blockcompress_open_copy( _ctx, resc, O_RDONLY, copy );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    const int fd = open( _cache_file_name, O_WRONLY | O_CREAT | O_TRUNC, fco->mode() );
+    if ( fd < 0 ) {
+        const int err = errno;
+        resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, copy );
+        return ERROR( UNIX_FILE_OPEN_ERR - err, fmt::format( "Open error for cache file \"{}\".", _cache_file_name ) );
+    }
+
+    irods::error result = SUCCESS();
+
+    try {
+        const auto io = blockcompress_child_io( _ctx.comm(), resc, copy );
+        const auto end = blockcompress_child_size( _ctx.comm(), resc, copy );
+        auto index = bc::read_index( io, end );
+
+        std::unique_ptr< bc::reader > reader;
+        if ( index ) {
+            reader = std::make_unique< bc::reader >( std::move( *index ), config.threads, config.readahead );
+        }
+
+        std::vector< char > buffer( MAX_CHILD_IO_SIZE );
+        std::int64_t offset = 0;
+
+        while ( true ) {
+            const auto n = reader ? reader->read( offset, buffer.data(), buffer.size(), io )
+                                  : io.read( offset, buffer.data(), std::min< std::int64_t >( buffer.size(), end - offset ) );
+            if ( 0 == n ) {
+                break;
+            }
+
+            if ( pwrite( fd, buffer.data(), n, offset ) != static_cast< ssize_t >( n ) ) {
+                THROW( UNIX_FILE_WRITE_ERR - errno, fmt::format( "Write error for cache file \"{}\".", _cache_file_name ) );
+            }
+
+            offset += n;
+        }
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+        irods::log( result );
+    }
+
+    close( fd );
+    resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, copy );
+
+    return result;
+
+} // blockcompress_file_stage_to_cache
+
+// =-=-=-=-=-=-=-
+// blockcompress_file_sync_to_arch - compresses the cache file into the replica
+irods::error blockcompress_file_sync_to_arch(
+    irods::plugin_context& _ctx,
+    const char*            _cache_file_name ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "bad params.", ret );
+    }
+
+    irods::resource_ptr resc;
+    ret = blockcompress_get_first_child_resc( _ctx.prop_map(), resc );
+    if ( !ret.ok() ) {
+        return PASSMSG( "failed getting the first child resource pointer.", ret );
+    }
+
+    const auto config = blockcompress_get_config( _ctx );
+
+    const int fd = open( _cache_file_name, O_RDONLY );
+    if ( fd < 0 ) {
+        return ERROR( UNIX_FILE_OPEN_ERR - errno, fmt::format( "Open error for cache file \"{}\".", _cache_file_name ) );
+    }
+
+    irods::file_object_ptr copy;
+    ret = blockcompress_open_copy( _ctx, resc, O_WRONLY | O_CREAT | O_TRUNC, copy );
+    if ( !ret.ok() ) {
+        close( fd );
+        return PASS( ret );
+    }
+
+    irods::error result = SUCCESS();
+
+    try {
+        const auto io = blockcompress_child_io( _ctx.comm(), resc, copy );
+
+        bc::block_index index;
+        index.block_size = config.block_size;
+        bc::writer writer{ std::move( index ), 0, config.threads, config.compression_level };
+
+        std::vector< char > buffer( MAX_CHILD_IO_SIZE );
+        ssize_t n = 0;
+        off_t offset = 0;
+
+        while ( ( n = pread( fd, buffer.data(), buffer.size(), offset ) ) > 0 ) {
+            writer.write( offset, buffer.data(), n, io );
+            offset += n;
+        }
+
+        if ( n < 0 ) {
+            THROW( UNIX_FILE_READ_ERR - errno, fmt::format( "Read error for cache file \"{}\".", _cache_file_name ) );
+        }
+
+        blockcompress_finish( writer, io, copy->physical_path() );
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+        irods::log( result );
+    }
+
+    close( fd );
+    resc->call( _ctx.comm(), irods::RESOURCE_OP_CLOSE, copy );
+
+    return result;
+
+} // blockcompress_file_sync_to_arch
+
+// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file registration
+irods::error blockcompress_file_registered(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_REGISTERED );
+
+} // blockcompress_file_registered
+
+// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file unregistration
+irods::error blockcompress_file_unregistered(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_UNREGISTERED );
+
+} // blockcompress_file_unregistered
+
+// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file modification
+irods::error blockcompress_file_modified(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_MODIFIED );
+
+} // blockcompress_file_modified
+
+// =-=-=-=-=-=-=-
+// blockcompress_file_notify - code which would notify the subtree of a change
+irods::error blockcompress_file_notify(
+    irods::plugin_context& _ctx,
+    const std::string*     _opr ) {
+    return blockcompress_forward< const std::string* >( _ctx, irods::RESOURCE_OP_NOTIFY, _opr );
+
+} // blockcompress_file_notify
+
+// =-=-=-=-=-=-=-
+// used to allow the resource to determine which host
+// should provide the requested operation
+irods::error blockcompress_file_resolve_hierarchy(
+    irods::plugin_context&   _ctx,
+    const std::string*       _opr,
+    const std::string*       _curr_host,
+    irods::hierarchy_parser* _out_parser,
+    float*                   _out_vote ) {
+    irods::error ret = blockcompress_check_params( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "blockcompress_file_resolve_hierarchy - invalid resource context.", ret );
+    }
+
+    if ( !_opr || !_curr_host || !_out_parser || !_out_vote ) {
+        return ERROR( SYS_INVALID_INPUT_PARAM, "Invalid input parameter." );
+    }
+
+    _out_parser->add_child( irods::get_resource_name( _ctx ) );
+
+    return blockcompress_forward< const std::string*, const std::string*, irods::hierarchy_parser*, float* >(
+               _ctx, irods::RESOURCE_OP_RESOLVE_RESC_HIER, _opr, _curr_host, _out_parser, _out_vote );
+
+} // blockcompress_file_resolve_hierarchy
+
+// =-=-=-=-=-=-=-
+// blockcompress_file_rebalance - code which would rebalance the subtree
+irods::error blockcompress_file_rebalance(
+    irods::plugin_context& _ctx ) {
+    return blockcompress_forward( _ctx, irods::RESOURCE_OP_REBALANCE );
+
+} // blockcompress_file_rebalance
+
+// =-=-=-=-=-=-=-
+// 3. create derived class to handle block compression resources
+class blockcompress_resource : public irods::resource {
+    public:
+        blockcompress_resource(
+            const std::string& _inst_name,
+            const std::string& _context ) :
+            irods::resource(
+                _inst_name,
+                _context ) {
+            // =-=-=-=-=-=-=-
+            // parse context string into property pairs assuming a ; as a separator
+            irods::kvp_map_t kvp;
+            irods::parse_kvp_string(
+                _context,
+                kvp );
+
+            for ( auto&& [ key, value ] : kvp ) {
+                properties_.set< std::string >( key, value );
+            }
+
+            set_blockcompress_config( kvp );
+
+        } // ctor
+
+        // =-=-=-=-=-=-=-
+        // parse the block and thread settings once. invalid values are logged
+        // and the defaults are kept.
+        void set_blockcompress_config( const irods::kvp_map_t& _kvp ) {
+            blockcompress_config config;
+
+            try {
+                if ( auto itr = _kvp.find( BLOCK_SIZE ); itr != _kvp.end() ) {
+                    config.block_size = std::stoul( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( COMPRESSION_LEVEL ); itr != _kvp.end() ) {
+                    config.compression_level = std::stoi( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( THREADS ); itr != _kvp.end() ) {
+                    config.threads = std::stoi( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( READAHEAD ); itr != _kvp.end() ) {
+                    config.readahead = std::stoull( itr->second );
+                }
+
+                if ( config.block_size < 4096 || config.block_size > 64 * 1024 * 1024 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "block_size must be between 4096 and 67108864" );
+                }
+
+                if ( config.compression_level < 0 || config.compression_level > 9 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "compression_level must be between 0 and 9" );
+                }
+
+                if ( config.threads < 1 || config.threads > 64 || config.readahead < 1 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "threads or readahead out of range" );
+                }
+            }
+            catch ( const irods::exception& e ) {
+                rodsLog( LOG_ERROR, "blockcompress_resource: invalid settings for [%s]. Using the defaults. [%s]",
+                         instance_name_.c_str(), e.client_display_what() );
+                config = blockcompress_config{};
+            }
+            catch ( const std::exception& e ) {
+                rodsLog( LOG_ERROR, "blockcompress_resource: invalid settings for [%s]. Using the defaults. [%s]",
+                         instance_name_.c_str(), e.what() );
+                config = blockcompress_config{};
+            }
+
+            properties_.set< blockcompress_config >( BLOCKCOMPRESS_CONFIG, config );
+        }
+
+        irods::error need_post_disconnect_maintenance_operation( bool& _b ) {
+            _b = false;
+            return SUCCESS();
+        }
+
+        irods::error post_disconnect_maintenance_operation( irods::pdmo_type& ) {
+            return ERROR( -1, "nop" );
+        }
+}; // class blockcompress_resource
+
+// =-=-=-=-=-=-=-
+// 4. create the plugin factory function which will return a dynamically
+//    instantiated object of the previously defined derived resource.  use
+//    the add_operation member to associate a 'call name' to the interfaces
+//    defined above.  for resource plugins these call names are standardized
+//    as used by the irods facing interface defined in
+//    server/drivers/src/fileDriver.c
+extern "C"
+irods::resource* plugin_factory( const std::string& _inst_name, const std::string& _context ) {
+
+    // =-=-=-=-=-=-=-
+    // 4a. create blockcompress_resource
+    blockcompress_resource* resc = new blockcompress_resource( _inst_name, _context );
+
+    // =-=-=-=-=-=-=-
+    // 4b. map function names to operations.  this map will be used to load
+    //     the symbols from the shared object in the delay_load stage of
+    //     plugin loading.
+    using namespace irods;
+    using namespace std;
+    resc->add_operation(
+        RESOURCE_OP_CREATE,
+        function<error(plugin_context&)>(
+            blockcompress_file_create ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_OPEN,
+        function<error(plugin_context&)>(
+            blockcompress_file_open ) );
+
+    resc->add_operation<void*,const int>(
+        irods::RESOURCE_OP_READ,
+        std::function<
+            error(irods::plugin_context&,void*,const int)>(
+                blockcompress_file_read ) );
+
+    resc->add_operation<const void*,const int>(
+        irods::RESOURCE_OP_WRITE,
+        function<error(plugin_context&,const void*,const int)>(
+            blockcompress_file_write ) );
+
+    resc->add_operation(
+        RESOURCE_OP_CLOSE,
+        function<error(plugin_context&)>(
+            blockcompress_file_close ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_UNLINK,
+        function<error(plugin_context&)>(
+            blockcompress_file_unlink ) );
+
+    resc->add_operation<struct stat*>(
+        irods::RESOURCE_OP_STAT,
+        function<error(plugin_context&, struct stat*)>(
+            blockcompress_file_stat ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_MKDIR,
+        function<error(plugin_context&)>(
+            blockcompress_file_mkdir ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_OPENDIR,
+        function<error(plugin_context&)>(
+            blockcompress_file_opendir ) );
+
+    resc->add_operation<struct rodsDirent**>(
+        irods::RESOURCE_OP_READDIR,
+        function<error(plugin_context&,struct rodsDirent**)>(
+            blockcompress_file_readdir ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_RENAME,
+        function<error(plugin_context&, const char*)>(
+            blockcompress_file_rename ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_FREESPACE,
+        function<error(plugin_context&)>(
+            blockcompress_file_getfs_freespace ) );
+
+    resc->add_operation<const long long, const int>(
+        irods::RESOURCE_OP_LSEEK,
+        function<error(plugin_context&, const long long, const int)>(
+            blockcompress_file_lseek ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_RMDIR,
+        function<error(plugin_context&)>(
+            blockcompress_file_rmdir ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_CLOSEDIR,
+        function<error(plugin_context&)>(
+            blockcompress_file_closedir ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_STAGETOCACHE,
+        function<error(plugin_context&, const char*)>(
+            blockcompress_file_stage_to_cache ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_SYNCTOARCH,
+        function<error(plugin_context&, const char*)>(
+            blockcompress_file_sync_to_arch ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_REGISTERED,
+        function<error(plugin_context&)>(
+            blockcompress_file_registered ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_UNREGISTERED,
+        function<error(plugin_context&)>(
+            blockcompress_file_unregistered ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_MODIFIED,
+        function<error(plugin_context&)>(
+            blockcompress_file_modified ) );
+
+    resc->add_operation<const std::string*>(
+        irods::RESOURCE_OP_NOTIFY,
+        function<error(plugin_context&, const std::string*)>(
+            blockcompress_file_notify ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_TRUNCATE,
+        function<error(plugin_context&)>(
+            blockcompress_file_truncate ) );
+
+    resc->add_operation<const std::string*, const std::string*, irods::hierarchy_parser*, float*>(
+        irods::RESOURCE_OP_RESOLVE_RESC_HIER,
+        function<error(plugin_context&,const std::string*, const std::string*, irods::hierarchy_parser*, float*)>(
+            blockcompress_file_resolve_hierarchy ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_REBALANCE,
+        function<error(plugin_context&)>(
+            blockcompress_file_rebalance ) );
+
+    // =-=-=-=-=-=-=-
+    // 4c. return the pointer through the generic interface of an
+    //     irods::resource pointer
+    return dynamic_cast<irods::resource*>( resc );
+
+} // plugin_factory
@@ -26,6 +26,11 @@
 #include "irods_lexical_cast.hpp"
 #include "irods_random.hpp"
 #include "irods_at_scope_exit.hpp"
+#include "irods_query.hpp"
+#include "cache_eviction.hpp"
+#include "dataObjTrim.h"
+#include "rcConnect.h"
+#include "stage_queue.hpp"
 
 // =-=-=-=-=-=-=-
 // stl includes
@@ -34,6 +39,13 @@
 #include <vector>
 #include <string>
 #include <string_view>
+#include <atomic>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
 
 // =-=-=-=-=-=-=-
 // boost includes
@@ -772,6 +784,53 @@ irods::error repl_object(
     return SUCCESS();
 } // repl_object
 
+/// =-=-=-=-=-=-=-
+/// @brief stage the object from the archive to the cache.  the stage runs in
+///        this agent unless the stage queue of the agent is staging the object
+///        already, in which case the open waits for that stage.  a prefetch of
+///        the object which has not started is taken over by this stage.  the
+///        agent running a queued stage sees STAGE_INLINE_KW and stages in
+///        place, as does this agent when the stage it waited for fails.
+irods::error stage_to_cache(
+    irods::plugin_context& _ctx ) {
+    irods::file_object_ptr obj = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    if ( getValByKey( ( keyValPair_t* )&obj->cond_input(), STAGE_INLINE_KW ) ) {
+        return repl_object( _ctx, STAGE_OBJ_KW );
+    }
+
+    irods::hierarchy_parser parser;
+    parser.set_string( obj->resc_hier() );
+
+    std::string root_name;
+    irods::error ret = parser.first_resc( root_name );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    bool staged_here = false;
+    irods::error result = SUCCESS();
+    const int status = irods::get_stage_queue().run(
+                           irods::make_stage_request( *_ctx.comm(), obj->logical_path(), root_name ),
+                           [&_ctx, &staged_here, &result] {
+                               staged_here = true;
+                               result = repl_object( _ctx, STAGE_OBJ_KW );
+                               return result.ok() ? 0 : static_cast<int>( result.code() );
+                           } );
+
+    if ( staged_here ) {
+        return result;
+    }
+
+    if ( status < 0 ) {
+        log::resource::warn( "Queued stage of [{}] failed [error_code={}]; staging in place.",
+                             obj->logical_path(), status );
+        return repl_object( _ctx, STAGE_OBJ_KW );
+    }
+
+    return SUCCESS();
+
+} // stage_to_cache
+
 /// =-=-=-=-=-=-=-
 /// @brief interface for POSIX create
 irods::error compound_file_create(
@@ -877,6 +936,340 @@ irods::error compound_file_write(
 
 } // compound_file_write
 
+// =-=-=-=-=-=-=-
+// eviction of replicas from the cache
+namespace {
+
+    namespace ce = irods::experimental::cache_eviction;
+
+    // Eviction is enabled by naming a policy in the context string, e.g.
+    //   "eviction_policy=gdsf;cache_capacity=1099511627776;high_watermark=90;low_watermark=75"
+    const std::string EVICTION_POLICY_KW( "eviction_policy" );
+    const std::string CACHE_CAPACITY_KW( "cache_capacity" );
+    const std::string HIGH_WATERMARK_KW( "high_watermark" );
+    const std::string LOW_WATERMARK_KW( "low_watermark" );
+    const std::string EVICTION_INTERVAL_KW( "eviction_interval" );
+
+    constexpr int default_high_watermark = 90;
+    constexpr int default_low_watermark = 75;
+    constexpr std::int64_t default_eviction_interval = 60;
+
+    struct eviction_settings {
+        std::string policy;
+        ce::watermarks watermarks;
+        std::int64_t interval;
+        rodsLong_t cache_id;
+        rodsLong_t archive_id;
+    };
+
+    // The service account of the local server, which the evictor uses to trim replicas.
+    struct service_connection_info {
+        std::string host;
+        int port;
+        std::string user_name;
+        std::string zone;
+    };
+
+    template <typename T>
+    T get_numeric_property(
+        irods::plugin_context& _ctx,
+        const std::string&     _key,
+        T                      _default ) {
+        std::string value;
+        if ( !_ctx.prop_map().get< std::string >( _key, value ).ok() || value.empty() ) {
+            return _default;
+        }
+
+        try {
+            return boost::lexical_cast< T >( value );
+        }
+        catch ( const boost::bad_lexical_cast& ) {
+            THROW( SYS_INVALID_INPUT_PARAM, fmt::format( "Invalid value for [{}]: [{}]", _key, value ) );
+        }
+    }
+
+    // Returns the eviction settings of the resource, or nothing if eviction is disabled.
+    std::optional< eviction_settings > get_eviction_settings(
+        irods::plugin_context& _ctx,
+        irods::resource_ptr&   _cache_resc ) {
+        eviction_settings settings{};
+        if ( !_ctx.prop_map().get< std::string >( EVICTION_POLICY_KW, settings.policy ).ok() ||
+             settings.policy.empty() ) {
+            return std::nullopt;
+        }
+
+        // Rejects unknown policies.
+        ce::make_policy( settings.policy );
+
+        settings.watermarks.capacity = get_numeric_property< std::int64_t >( _ctx, CACHE_CAPACITY_KW, 0 );
+        settings.watermarks.high_percent = get_numeric_property< int >( _ctx, HIGH_WATERMARK_KW, default_high_watermark );
+        settings.watermarks.low_percent = get_numeric_property< int >( _ctx, LOW_WATERMARK_KW, default_low_watermark );
+        settings.interval = get_numeric_property< std::int64_t >( _ctx, EVICTION_INTERVAL_KW, default_eviction_interval );
+
+        if ( settings.watermarks.capacity <= 0 ) {
+            THROW( SYS_INVALID_INPUT_PARAM, fmt::format( "[{}] must be set to a positive number of bytes.", CACHE_CAPACITY_KW ) );
+        }
+
+        irods::error ret = _cache_resc->get_property< rodsLong_t >( irods::RESOURCE_ID, settings.cache_id );
+        if ( !ret.ok() ) {
+            THROW( ret.code(), "Failed to get the ID of the cache resource." );
+        }
+
+        irods::resource_ptr arch_resc;
+        if ( !( ret = get_archive( _ctx, arch_resc ) ).ok() ||
+             !( ret = arch_resc->get_property< rodsLong_t >( irods::RESOURCE_ID, settings.archive_id ) ).ok() ) {
+            THROW( ret.code(), "Failed to get the ID of the archive resource." );
+        }
+
+        return settings;
+    }
+
+    // Every compound resource of the agent with the same cache shares the log.
+    std::shared_ptr< ce::access_log > get_access_log(
+        rodsLong_t _resource_id ) {
+        static std::mutex mutex;
+        static std::map< rodsLong_t, std::shared_ptr< ce::access_log > > logs;
+
+        std::lock_guard< std::mutex > lock{ mutex };
+
+        auto& entry = logs[ _resource_id ];
+        if ( !entry ) {
+            entry = std::make_shared< ce::access_log >( _resource_id );
+        }
+
+        return entry;
+    }
+
+    // Evictions which run in the background of the agent. The threads are joined when
+    // they have finished, or when the agent exits.
+    class background_evictions {
+        public:
+            ~background_evictions() {
+                stopping_ = true;
+
+                std::lock_guard< std::mutex > lock{ mutex_ };
+                for ( auto& entry : threads_ ) {
+                    entry.first.join();
+                }
+            }
+
+            const std::atomic< bool >& stopping() const {
+                return stopping_;
+            }
+
+            void add( std::thread&& _thread, std::shared_ptr< std::atomic< bool > > _done ) {
+                std::lock_guard< std::mutex > lock{ mutex_ };
+
+                threads_.erase( std::remove_if( threads_.begin(), threads_.end(), []( auto& _entry ) {
+                    if ( !*_entry.second ) {
+                        return false;
+                    }
+                    _entry.first.join();
+                    return true;
+                } ), threads_.end() );
+
+                threads_.emplace_back( std::move( _thread ), std::move( _done ) );
+            }
+
+        private:
+            std::atomic< bool > stopping_{ false };
+            std::mutex mutex_;
+            std::vector< std::pair< std::thread, std::shared_ptr< std::atomic< bool > > > > threads_;
+    };
+
+    background_evictions& get_background_evictions() {
+        static background_evictions instance;
+        return instance;
+    }
+
+    // The good replicas in the archive, by data ID.
+    struct archived_replica {
+        std::int64_t size;
+        std::string checksum;
+    };
+
+    // Trims replicas from the cache until it is below the low watermark. Only replicas
+    // with a good replica of the same size and checksum in the archive are trimmed.
+    //
+    // The evictor runs on a connection of its own so that it neither shares the state of
+    // the agent nor delays the client.
+    void evict(
+        const eviction_settings&        _settings,
+        ce::access_log&                 _access_log,
+        const service_connection_info&  _service,
+        const std::atomic< bool >&      _stopping ) {
+        rErrMsg_t err_msg{};
+        rcComm_t* conn = _rcConnect( _service.host.c_str(), _service.port,
+                                     _service.user_name.c_str(), _service.zone.c_str(),
+                                     _service.user_name.c_str(), _service.zone.c_str(),
+                                     &err_msg, 0, NO_RECONN );
+        if ( !conn ) {
+            log::resource::error( "Cannot connect to [{}] to evict replicas from the cache [error_code={}]",
+                                  _service.host, err_msg.status );
+            return;
+        }
+
+        irods::at_scope_exit disconnect{ [conn] { rcDisconnect( conn ); } };
+
+        if ( const int ec = clientLogin( conn ); ec < 0 ) {
+            log::resource::error( "Cannot log in to [{}] to evict replicas from the cache [error_code={}]",
+                                  _service.host, ec );
+            return;
+        }
+
+        std::unordered_map< std::int64_t, archived_replica > archived;
+        const auto archive_gql = fmt::format( "select DATA_ID, DATA_SIZE, DATA_CHECKSUM "
+                                              "where DATA_RESC_ID = '{}' and DATA_REPL_STATUS = '1'",
+                                              _settings.archive_id );
+        for ( auto&& row : irods::query< rcComm_t >{ conn, archive_gql } ) {
+            archived[ std::stoll( row[ 0 ] ) ] = { std::stoll( row[ 1 ] ), row[ 2 ] };
+        }
+
+        std::int64_t used_bytes = 0;
+        std::vector< ce::candidate > candidates;
+        std::map< std::pair< std::int64_t, int >, std::int64_t > keys;
+
+        const auto cache_gql = fmt::format( "select DATA_ID, DATA_REPL_NUM, DATA_REPL_STATUS, DATA_SIZE, "
+                                            "DATA_MODIFY_TIME, DATA_CHECKSUM, DATA_PATH, COLL_NAME, DATA_NAME "
+                                            "where DATA_RESC_ID = '{}'",
+                                            _settings.cache_id );
+        for ( auto&& row : irods::query< rcComm_t >{ conn, cache_gql } ) {
+            const auto data_id = std::stoll( row[ 0 ] );
+            const auto replica_number = std::stoi( row[ 1 ] );
+            const auto size = std::stoll( row[ 3 ] );
+
+            used_bytes += size;
+
+            // Replicas being written are never evicted.
+            if ( row[ 2 ] != "0" && row[ 2 ] != "1" ) {
+                continue;
+            }
+
+            const auto archived_iter = archived.find( data_id );
+            if ( archived_iter == archived.end() ) {
+                continue;
+            }
+
+            const auto& archived_replica = archived_iter->second;
+            if ( archived_replica.size != size ||
+                 ( !row[ 5 ].empty() && !archived_replica.checksum.empty() && row[ 5 ] != archived_replica.checksum ) ) {
+                continue;
+            }
+
+            const auto key = ce::make_replica_key( row[ 6 ] );
+            keys[ { data_id, replica_number } ] = key;
+
+            // Replicas which have not been accessed since the log was created are treated
+            // as last accessed when they were modified.
+            const auto record = _access_log.find( key ).value_or( ce::access_record{ std::stoll( row[ 4 ] ), 0, 0.0 } );
+
+            candidates.push_back( { data_id,
+                                    replica_number,
+                                    fmt::format( "{}/{}", row[ 7 ], row[ 8 ] ),
+                                    size,
+                                    record.last_access,
+                                    record.hits,
+                                    ce::gdsf_value( record, size ) } );
+        }
+
+        const auto bytes_to_free = ce::bytes_to_free( used_bytes, _settings.watermarks );
+        if ( bytes_to_free <= 0 ) {
+            return;
+        }
+
+        const auto victims = ce::select_victims( std::move( candidates ), *ce::make_policy( _settings.policy ), bytes_to_free );
+
+        std::int64_t freed_bytes = 0;
+
+        for ( auto&& victim : victims ) {
+            if ( _stopping ) {
+                break;
+            }
+
+            dataObjInp_t trim_inp{};
+            rstrcpy( trim_inp.objPath, victim.logical_path.c_str(), MAX_NAME_LEN );
+            addKeyVal( &trim_inp.condInput, REPL_NUM_KW, std::to_string( victim.replica_number ).c_str() );
+            addKeyVal( &trim_inp.condInput, COPIES_KW, "1" );
+            addKeyVal( &trim_inp.condInput, ADMIN_KW, "" );
+
+            const int ec = rcDataObjTrim( conn, &trim_inp );
+            clearKeyVal( &trim_inp.condInput );
+
+            if ( ec < 0 ) {
+                log::resource::warn( "Cannot evict replica [{}] of [{}] from the cache [error_code={}]",
+                                     victim.replica_number, victim.logical_path, ec );
+                continue;
+            }
+
+            _access_log.erase( keys[ { victim.data_id, victim.replica_number } ] );
+            _access_log.inflate( victim.gdsf_value );
+            freed_bytes += victim.size;
+        }
+
+        log::resource::info( "Evicted [{}] bytes from the cache [resource_id={}, used_bytes={}, policy={}]",
+                             freed_bytes, _settings.cache_id, used_bytes, _settings.policy );
+    }
+
+    // Records an access to the replica in the cache, and starts an eviction in the
+    // background if one is due.
+    void record_cache_access(
+        irods::plugin_context& _ctx,
+        irods::resource_ptr&   _cache_resc ) {
+        try {
+            const auto settings = get_eviction_settings( _ctx, _cache_resc );
+            if ( !settings ) {
+                return;
+            }
+
+            irods::file_object_ptr obj = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+
+            auto access_log = get_access_log( settings->cache_id );
+            const std::int64_t now = std::time( nullptr );
+
+            access_log->record( ce::make_replica_key( obj->physical_path() ), now );
+
+            if ( !access_log->try_start_eviction( now, settings->interval ) ) {
+                return;
+            }
+
+            const rodsEnv& env = _ctx.comm()->myEnv;
+            service_connection_info service{ env.rodsHost, env.rodsPort, env.rodsUserName, env.rodsZone };
+
+            auto& evictions = get_background_evictions();
+            auto done = std::make_shared< std::atomic< bool > >( false );
+
+            // The evictor releases the right to evict once it is done.
+            std::thread evictor;
+            try {
+                evictor = std::thread{ [settings = *settings, access_log, service, &stopping = evictions.stopping(), done] {
+                    try {
+                        evict( settings, *access_log, service, stopping );
+                    }
+                    catch ( const std::exception& e ) {
+                        log::resource::error( "Cache eviction failed [resource_id={}]: {}", settings.cache_id, e.what() );
+                    }
+
+                    access_log->finish_eviction();
+                    *done = true;
+                } };
+            }
+            catch ( const std::system_error& ) {
+                access_log->finish_eviction();
+                throw;
+            }
+
+            evictions.add( std::move( evictor ), std::move( done ) );
+        }
+        catch ( const irods::exception& e ) {
+            log::resource::error( "Cannot record the access to the cache: {}", e.client_display_what() );
+        }
+        catch ( const std::exception& e ) {
+            log::resource::error( "Cannot record the access to the cache: {}", e.what() );
+        }
+    }
+
+} // anonymous namespace
+
 /// =-=-=-=-=-=-=-
 /// @brief interface for POSIX Close
 irods::error compound_file_close(
@@ -904,6 +1297,10 @@ irods::error compound_file_close(
 
     }
 
+    // =-=-=-=-=-=-=-
+    // each open of a replica in the cache counts as one access
+    record_cache_access( _ctx, resc );
+
     return SUCCESS();
 
 } // compound_file_close
@@ -1572,7 +1969,7 @@ irods::error open_for_prefer_archive_policy(
     // =-=-=-=-=-=-=-
     // if the vote is 0 then we do a wholesale stage, not an update
     // otherwise it is an update operation for the stage to cache
-    ret = repl_object( _ctx, STAGE_OBJ_KW );
+    ret = stage_to_cache( _ctx );
     if ( !ret.ok() ) {
         return PASS( ret );
     }
@@ -1782,7 +2179,7 @@ irods::error open_for_prefer_cache_policy(
 
         // =-=-=-=-=-=-=-
         // if the archive has it, then replicate
-        ret = repl_object( _ctx, STAGE_OBJ_KW );
+        ret = stage_to_cache( _ctx );
         if ( !ret.ok() ) {
             return PASS( ret );
         }
@@ -0,0 +1,1393 @@
+// =-=-=-=-=-=-=-
+// irods includes
+#include "msParam.h"
+#include "rcConnect.h"
+#include "miscServerFunct.hpp"
+
+// =-=-=-=-=-=-=-
+#include "irods_resource_plugin.hpp"
+#include "irods_file_object.hpp"
+#include "irods_physical_object.hpp"
+#include "irods_collection_object.hpp"
+#include "irods_hierarchy_parser.hpp"
+#include "irods_resource_redirect.hpp"
+#include "irods_kvp_string_parser.hpp"
+#include "irods_logger.hpp"
+#include "dedup_store.hpp"
+#include "voting.hpp"
+
+// =-=-=-=-=-=-=-
+// stl includes
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// =-=-=-=-=-=-=-
+// boost includes
+#include <boost/filesystem.hpp>
+
+// =-=-=-=-=-=-=-
+// system includes
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace dd = irods::experimental::dedup;
+
+// =-=-=-=-=-=-=-
+// 1. Define utility functions that the operations might need
+const std::string DEFAULT_VAULT_DIR_MODE( "default_vault_directory_mode_kw" );
+const std::string CHUNK_STORE( "chunk_store" );
+const std::string MIN_CHUNK_SIZE( "min_chunk_size" );
+const std::string AVG_CHUNK_SIZE( "avg_chunk_size" );
+const std::string MAX_CHUNK_SIZE( "max_chunk_size" );
+const std::string PREFETCH_THREADS( "prefetch_threads" );
+const std::string PREFETCH_WINDOW( "prefetch_window" );
+const std::string DEDUP_CONFIG( "dedup_config" ); // parsed form of the keys above
+
+// Name of the chunk store inside the vault when chunk_store is not set.
+const std::string DEFAULT_CHUNK_STORE_NAME( ".dedup" );
+
+// Writes go to a plain file beside the replica, which is chunked when the last
+// writer closes it.
+const std::string STAGING_SUFFIX( ".dedup_staging" );
+
+struct dedup_config {
+    std::string             chunk_store;
+    dd::chunking_parameters chunking;
+    int                     prefetch_threads = 4;
+    std::size_t             prefetch_window  = 8;
+};
+
+// =-=-=-=-=-=-=-
+// State of the descriptors handed to the server, keyed by descriptor
+struct open_replica {
+    bool writing = false;
+
+    // Set when a manifest is open for reading
+    std::unique_ptr< dd::manifest_reader > reader;
+    std::int64_t offset = 0;
+};
+
+static std::mutex open_replicas_mutex;
+static std::unordered_map< int, open_replica > open_replicas;
+
+// The number of descriptors open for writing on each staging file. Parallel
+// transfers open the replica once per thread, and only the last close chunks it.
+static std::unordered_map< std::string, int > staging_writers;
+
+// =-=-=-=-=-=-=-
+/// @brief Generates a full path name from the partial physical path and the specified resource's vault path
+irods::error dedup_generate_full_path(
+    irods::plugin_property_map& _prop_map,
+    const std::string&           _phy_path,
+    std::string&                 _ret_string ) {
+    std::string vault_path;
+    irods::error ret = _prop_map.get<std::string>( irods::RESOURCE_PATH, vault_path );
+    if ( !ret.ok() ) {
+        return ERROR( SYS_INVALID_INPUT_PARAM, "resource has no vault path." );
+    }
+
+    if ( _phy_path.compare( 0, 1, "/" ) != 0 &&
+            _phy_path.compare( 0, vault_path.size(), vault_path ) != 0 ) {
+        _ret_string = vault_path + "/" + _phy_path;
+    }
+    else {
+        // The physical path already contains the vault path
+        _ret_string = _phy_path;
+    }
+
+    return SUCCESS();
+
+} // dedup_generate_full_path
+
+// =-=-=-=-=-=-=-
+/// @brief Checks the basic operation parameters and updates the physical path in the file object
+template< typename DEST_TYPE = irods::file_object >
+irods::error dedup_check_params_and_path(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = _ctx.valid< DEST_TYPE >();
+    if ( !ret.ok() ) {
+        return PASSMSG( "resource context is invalid.", ret );
+    }
+
+    irods::data_object_ptr data_obj = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
+    std::string full_path;
+    ret = dedup_generate_full_path( _ctx.prop_map(), data_obj->physical_path(), full_path );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Failed generating full path for object.", ret );
+    }
+
+    data_obj->physical_path( full_path );
+
+    return SUCCESS();
+
+} // dedup_check_params_and_path
+
+// =-=-=-=-=-=-=-
+/// @brief Returns the chunk store of the resource
+dd::chunk_store dedup_get_store(
+    irods::plugin_context& _ctx,
+    const dedup_config&    _config ) {
+    if ( !_config.chunk_store.empty() ) {
+        return dd::chunk_store{ _config.chunk_store };
+    }
+
+    // The vault path is not known when the resource is constructed.
+    std::string vault_path;
+    _ctx.prop_map().get< std::string >( irods::RESOURCE_PATH, vault_path );
+    return dd::chunk_store{ vault_path + "/" + DEFAULT_CHUNK_STORE_NAME };
+
+} // dedup_get_store
+
+dedup_config dedup_get_config(
+    irods::plugin_context& _ctx ) {
+    dedup_config config;
+    _ctx.prop_map().get< dedup_config >( DEDUP_CONFIG, config );
+    return config;
+
+} // dedup_get_config
+
+// =-=-=-=-=-=-=-
+/// @brief Copies the content of the replica at _physical_path, chunked or not, to _fd
+void dedup_copy_content(
+    const dd::chunk_store& _store,
+    const std::string&     _physical_path,
+    int                    _fd ) {
+    if ( const auto m = dd::read_manifest( _physical_path ); m ) {
+        dd::reassemble( _store, *m, _fd );
+        return;
+    }
+
+    // A file registered in place, which was never chunked.
+    const int in = open( _physical_path.c_str(), O_RDONLY );
+    if ( in < 0 ) {
+        THROW( UNIX_FILE_OPEN_ERR - errno, fmt::format( "dedup: cannot open [{}]", _physical_path ) );
+    }
+
+    std::vector< char > buffer( 4 * 1024 * 1024 );
+    ssize_t n = 0;
+    off_t offset = 0;
+
+    while ( ( n = pread( in, buffer.data(), buffer.size(), offset ) ) > 0 ) {
+        if ( pwrite( _fd, buffer.data(), n, offset ) != n ) {
+            const int err = errno;
+            close( in );
+            THROW( UNIX_FILE_WRITE_ERR - err, fmt::format( "dedup: cannot copy [{}]", _physical_path ) );
+        }
+        offset += n;
+    }
+
+    const int err = errno;
+    close( in );
+
+    if ( n < 0 ) {
+        THROW( UNIX_FILE_READ_ERR - err, fmt::format( "dedup: cannot read [{}]", _physical_path ) );
+    }
+
+    if ( ftruncate( _fd, offset ) < 0 ) {
+        THROW( UNIX_FILE_TRUNCATE_ERR - errno, fmt::format( "dedup: cannot truncate the copy of [{}]", _physical_path ) );
+    }
+
+} // dedup_copy_content
+
+// =-=-=-=-=-=-=-
+/// @brief Chunks the file open at _fd and replaces the replica at _physical_path
+///        with its manifest. The chunks of the previous content are released.
+void dedup_store_content(
+    irods::plugin_context& _ctx,
+    const std::string&     _physical_path,
+    int                    _fd ) {
+    using clock = std::chrono::steady_clock;
+
+    const auto config = dedup_get_config( _ctx );
+    auto store = dedup_get_store( _ctx, config );
+    const dd::chunker chunker{ config.chunking };
+
+    struct stat st{};
+    const bool exists = ( stat( _physical_path.c_str(), &st ) == 0 );
+    const auto old_manifest = exists ? dd::read_manifest( _physical_path ) : std::nullopt;
+
+    const auto start = clock::now();
+    auto result = dd::ingest( store, chunker, _fd );
+
+    try {
+        dd::write_manifest( _physical_path, result.file, exists ? ( st.st_mode & 07777 ) : 0600 );
+    }
+    catch ( const irods::exception& ) {
+        dd::release( store, result.file );
+        throw;
+    }
+
+    if ( old_manifest ) {
+        dd::release( store, *old_manifest );
+    }
+
+    const auto seconds = std::chrono::duration< double >( clock::now() - start ).count();
+    const auto stats = store.statistics();
+
+    irods::experimental::log::resource::info(
+        "dedup: stored [{}] [size={}, chunks={}, new_bytes={}, mib_per_second={:.1f}, store_dedup_ratio={:.2f}]",
+        _physical_path, result.file.size, result.file.entries.size(), result.new_bytes,
+        seconds > 0 ? result.file.size / 1048576.0 / seconds : 0.0, stats.dedup_ratio() );
+
+} // dedup_store_content
+
+// =-=-=-=-=-=-=-
+/// @brief Chunks the staging file of _physical_path and removes it
+irods::error dedup_finalize_staging(
+    irods::plugin_context& _ctx,
+    const std::string&     _physical_path ) {
+    const auto staging = _physical_path + STAGING_SUFFIX;
+
+    const int fd = open( staging.c_str(), O_RDONLY );
+    if ( fd < 0 ) {
+        return ERROR( UNIX_FILE_OPEN_ERR - errno, fmt::format( "dedup: cannot open [{}]", staging ) );
+    }
+
+    try {
+        dedup_store_content( _ctx, _physical_path, fd );
+    }
+    catch ( const irods::exception& e ) {
+        close( fd );
+        // The staging file is kept so that the data is not lost.
+        return irods::error( e );
+    }
+
+    close( fd );
+    unlink( staging.c_str() );
+
+    return SUCCESS();
+
+} // dedup_finalize_staging
+
+// =-=-=-=-=-=-=-
+/// @brief Opens the staging file of _physical_path for writing. The first writer
+///        fills it with the current content of the replica unless _truncate is set.
+///        Requires open_replicas_mutex.
+int dedup_open_staging(
+    irods::plugin_context& _ctx,
+    const std::string&     _physical_path,
+    bool                   _truncate,
+    mode_t                 _mode ) {
+    const auto staging = _physical_path + STAGING_SUFFIX;
+    int& writers = staging_writers[ _physical_path ];
+
+    if ( writers > 0 ) {
+        const int fd = open( staging.c_str(), O_RDWR );
+        if ( fd >= 0 ) {
+            ++writers;
+        }
+        return fd < 0 ? UNIX_FILE_OPEN_ERR - errno : fd;
+    }
+
+    const int fd = open( staging.c_str(), O_RDWR | O_CREAT | O_TRUNC, _mode );
+    if ( fd < 0 ) {
+        staging_writers.erase( _physical_path );
+        return UNIX_FILE_OPEN_ERR - errno;
+    }
+
+    if ( !_truncate ) {
+        try {
+            const auto config = dedup_get_config( _ctx );
+            dedup_copy_content( dedup_get_store( _ctx, config ), _physical_path, fd );
+        }
+        catch ( const irods::exception& e ) {
+            close( fd );
+            unlink( staging.c_str() );
+            staging_writers.erase( _physical_path );
+            return e.code();
+        }
+    }
+
+    writers = 1;
+
+    return fd;
+
+} // dedup_open_staging
+
+// =-=-=-=-=-=-=-
+// 2. Define operations which will be called by the file*
+//    calls declared in server/driver/include/fileDriver.h
+// =-=-=-=-=-=-=-
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file registration
+irods::error dedup_file_registered(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file unregistration
+irods::error dedup_file_unregistered(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file modification
+irods::error dedup_file_modified(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file operation
+irods::error dedup_file_notify(
+    irods::plugin_context& _ctx,
+    const std::string* ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+// =-=-=-=-=-=-=-
+// interface to determine free space on a device given a path
+irods::error dedup_file_getfs_freespace(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto path = fco->physical_path().substr( 0, fco->physical_path().find_last_of( '/' ) + 1 );
+
+    struct statvfs statbuf{};
+    if ( statvfs( path.c_str(), &statbuf ) < 0 ) {
+        const int status = UNIX_FILE_GET_FS_FREESPACE_ERR - errno;
+        return ERROR( status, fmt::format( "Statfs error for \"{}\", status = {}.", path, status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( static_cast< rodsLong_t >( statbuf.f_bavail ) * statbuf.f_frsize );
+    return result;
+
+} // dedup_file_getfs_freespace
+
+// =-=-=-=-=-=-=-
+// interface for POSIX create
+irods::error dedup_file_create(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    // =-=-=-=-=-=-=-
+    // the replica itself is created empty so that it exists while the data
+    // is being written to the staging file
+    mode_t myMask = umask( ( mode_t ) 0000 );
+    int placeholder = open( path.c_str(), O_RDWR | O_CREAT | O_EXCL, fco->mode() );
+    int errsav = errno;
+    ( void ) umask( ( mode_t ) myMask );
+
+    if ( placeholder < 0 ) {
+        const int status = UNIX_FILE_CREATE_ERR - errsav;
+        fco->file_descriptor( status );
+        return ERROR( status, fmt::format( "create error for \"{}\", errno = \"{}\".", path, strerror( errsav ) ) );
+    }
+
+    close( placeholder );
+
+    std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+    const int fd = dedup_open_staging( _ctx, path, true, 0600 );
+    if ( fd < 0 ) {
+        unlink( path.c_str() );
+        fco->file_descriptor( fd );
+        return ERROR( fd, fmt::format( "create error for the staging file of \"{}\".", path ) );
+    }
+
+    open_replicas[ fd ].writing = true;
+
+    fco->file_descriptor( fd );
+    irods::error result = SUCCESS();
+    result.code( fd );
+    return result;
+
+} // dedup_file_create
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Open
+irods::error dedup_file_open(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path  = fco->physical_path();
+    const int   flags = fco->flags();
+
+    // =-=-=-=-=-=-=-
+    // writers share the staging file of the replica
+    if ( O_RDONLY != ( flags & O_ACCMODE ) ) {
+        struct stat st{};
+        if ( stat( path.c_str(), &st ) < 0 ) {
+            const int errsav = errno;
+            if ( ENOENT != errsav || !( flags & O_CREAT ) ) {
+                return ERROR( UNIX_FILE_OPEN_ERR - errsav,
+                              fmt::format( "Open error for \"{}\", errno = \"{}\".", path, strerror( errsav ) ) );
+            }
+
+            const int placeholder = open( path.c_str(), O_RDWR | O_CREAT, fco->mode() );
+            if ( placeholder < 0 ) {
+                return ERROR( UNIX_FILE_OPEN_ERR - errno, fmt::format( "Open error for \"{}\".", path ) );
+            }
+            close( placeholder );
+        }
+
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+        // the writers of a staging file are only counted within this agent, so a
+        // write joining the replica token of another agent could be chunked before
+        // it completes
+        if ( getValByKey( &fco->cond_input(), REPLICA_TOKEN_KW ) && 0 == staging_writers.count( path ) ) {
+            return ERROR( USER_INTERMEDIATE_REPLICA_ACCESS,
+                          fmt::format( "\"{}\" is being written by another agent; "
+                                       "the dedup resource does not support shared replica tokens.", path ) );
+        }
+
+        const int fd = dedup_open_staging( _ctx, path, flags & O_TRUNC, 0600 );
+        if ( fd < 0 ) {
+            return ERROR( fd, fmt::format( "Open error for the staging file of \"{}\", flags = \"{}\".", path, flags ) );
+        }
+
+        open_replicas[ fd ].writing = true;
+
+        fco->file_descriptor( fd );
+        irods::error result = SUCCESS();
+        result.code( fd );
+        return result;
+    }
+
+    // =-=-=-=-=-=-=-
+    // readers of a manifest read the chunks through a prefetching reader
+    int fd = open( path.c_str(), O_RDONLY );
+    int errsav = errno;
+    if ( fd < 0 ) {
+        const int status = UNIX_FILE_OPEN_ERR - errsav;
+        return ERROR( status, fmt::format( "Open error for \"{}\", errno = \"{}\", status = \"{}\", flags = \"{}\".",
+                                           path, strerror( errsav ), status, flags ) );
+    }
+
+    try {
+        if ( auto m = dd::read_manifest( path ); m ) {
+            const auto config = dedup_get_config( _ctx );
+
+            std::lock_guard< std::mutex > lock( open_replicas_mutex );
+            open_replicas[ fd ].reader = std::make_unique< dd::manifest_reader >(
+                dedup_get_store( _ctx, config ), std::move( *m ), config.prefetch_threads, config.prefetch_window );
+        }
+    }
+    catch ( const irods::exception& e ) {
+        close( fd );
+        return irods::error( e );
+    }
+
+    fco->file_descriptor( fd );
+    irods::error result = SUCCESS();
+    result.code( fd );
+    return result;
+
+} // dedup_file_open
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Read
+irods::error dedup_file_read(
+    irods::plugin_context& _ctx,
+    void*                  _buf,
+    const int              _len ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const int fd = fco->file_descriptor();
+
+    irods::error result = SUCCESS();
+
+    {
+        std::unique_lock< std::mutex > lock( open_replicas_mutex );
+        auto itr = open_replicas.find( fd );
+
+        if ( itr != open_replicas.end() && itr->second.reader ) {
+            auto& replica = itr->second;
+            lock.unlock();
+
+            // A descriptor is used by one thread at a time, so the reader needs no lock.
+            try {
+                const auto n = replica.reader->read( replica.offset, _buf, _len );
+                replica.offset += n;
+                result.code( n );
+            }
+            catch ( const irods::exception& e ) {
+                result = irods::error( e );
+            }
+
+            return result;
+        }
+    }
+
+    const ssize_t status = read( fd, _buf, _len );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_READ_ERR - errno;
+        return ERROR( err_status, fmt::format( "Read error for file: \"{}\", errno = \"{}\".",
+                                               fco->physical_path(), strerror( errno ) ) );
+    }
+
+    result.code( status );
+    return result;
+
+} // dedup_file_read
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Write
+irods::error dedup_file_write(
+    irods::plugin_context& _ctx,
+    const void*            _buf,
+    const int              _len ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+
+    // =-=-=-=-=-=-=-
+    // writable descriptors are staging files, so this is a plain write
+    const ssize_t status = write( fco->file_descriptor(), _buf, _len );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_WRITE_ERR - errno;
+        return ERROR( err_status, fmt::format( "Write file: \"{}\", errno = \"{}\", status = {}.",
+                                               fco->physical_path(), strerror( errno ), err_status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // dedup_file_write
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Close
+irods::error dedup_file_close(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const int fd = fco->file_descriptor();
+    const auto& path = fco->physical_path();
+
+    open_replica replica;
+    irods::error result = SUCCESS();
+
+    std::unique_lock< std::mutex > lock( open_replicas_mutex );
+
+    if ( auto itr = open_replicas.find( fd ); itr != open_replicas.end() ) {
+        replica = std::move( itr->second );
+        open_replicas.erase( itr );
+    }
+
+    if ( close( fd ) < 0 ) {
+        const int err_status = UNIX_FILE_CLOSE_ERR - errno;
+        result = ERROR( err_status, fmt::format( "Close error for file: \"{}\", errno = \"{}\", status = {}.",
+                                                 path, strerror( errno ), err_status ) );
+    }
+
+    // =-=-=-=-=-=-=-
+    // the last writer chunks the staging file. the lock is held so that a new
+    // writer does not start from the content being replaced.
+    if ( replica.writing ) {
+        if ( auto itr = staging_writers.find( path ); itr != staging_writers.end() && --itr->second <= 0 ) {
+            staging_writers.erase( itr );
+
+            if ( ret = dedup_finalize_staging( _ctx, path ); !ret.ok() ) {
+                return PASSMSG( fmt::format( "Failed to store \"{}\".", path ), ret );
+            }
+        }
+
+        return result;
+    }
+
+    lock.unlock();
+
+    if ( replica.reader && replica.reader->bytes_read() > 0 ) {
+        dd::store_statistics delta;
+        delta.read_bytes        = replica.reader->bytes_read();
+        delta.read_microseconds = replica.reader->microseconds();
+
+        try {
+            auto store = dedup_get_store( _ctx, dedup_get_config( _ctx ) );
+            store.update_statistics( delta );
+        }
+        catch ( const irods::exception& e ) {
+            irods::log( irods::error( e ) );
+        }
+
+        irods::experimental::log::resource::debug( "dedup: read [{}] [bytes={}, microseconds={}]",
+                                                  path, delta.read_bytes, delta.read_microseconds );
+    }
+
+    return result;
+
+} // dedup_file_close
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Unlink
+irods::error dedup_file_unlink(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::data_object_ptr fco = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    std::optional< dd::manifest > m;
+    try {
+        m = dd::read_manifest( path );
+    }
+    catch ( const irods::exception& ) {
+        // Missing or unreadable, let unlink report it.
+    }
+
+    const int status = unlink( path.c_str() );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_UNLINK_ERR - errno;
+        return ERROR( err_status, fmt::format( "Unlink error for \"{}\", errno = \"{}\", status = {}.",
+                                               path, strerror( errno ), err_status ) );
+    }
+
+    // =-=-=-=-=-=-=-
+    // the chunks are released once the replica is gone so that a failure in
+    // between leaks chunks rather than breaking the replica
+    if ( m ) {
+        auto store = dedup_get_store( _ctx, dedup_get_config( _ctx ) );
+        dd::release( store, *m );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // dedup_file_unlink
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Stat
+irods::error dedup_file_stat(
+    irods::plugin_context& _ctx,
+    struct stat*           _statbuf ) {
+    // =-=-=-=-=-=-=-
+    // NOTE:: this function assumes the object's physical path is
+    //        correct and should not have the vault path
+    //        prepended - hcj
+    irods::error ret = _ctx.valid();
+    if ( !ret.ok() ) {
+        return PASSMSG( "resource context is invalid.", ret );
+    }
+
+    irods::data_object_ptr fco = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    const int status = stat( path.c_str(), _statbuf );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_STAT_ERR - errno;
+        return ERROR( err_status, fmt::format( "Stat error for \"{}\", errno = \"{}\", status = {}.",
+                                               path, strerror( errno ), err_status ) );
+    }
+
+    // =-=-=-=-=-=-=-
+    // report the size of the content rather than that of the manifest
+    if ( S_ISREG( _statbuf->st_mode ) ) {
+        try {
+            if ( const auto size = dd::read_manifest_size( path ); size ) {
+                _statbuf->st_size = *size;
+            }
+        }
+        catch ( const irods::exception& e ) {
+            return irods::error( e );
+        }
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // dedup_file_stat
+
+// =-=-=-=-=-=-=-
+// interface for POSIX lseek
+irods::error dedup_file_lseek(
+    irods::plugin_context& _ctx,
+    const long long        _offset,
+    const int              _whence ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const int fd = fco->file_descriptor();
+
+    irods::error result = SUCCESS();
+
+    {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+        auto itr = open_replicas.find( fd );
+
+        // =-=-=-=-=-=-=-
+        // manifests are read at a position of our own
+        if ( itr != open_replicas.end() && itr->second.reader ) {
+            auto& replica = itr->second;
+            long long position = -1;
+
+            switch ( _whence ) {
+                case SEEK_SET: position = _offset; break;
+                case SEEK_CUR: position = replica.offset + _offset; break;
+                case SEEK_END: position = replica.reader->size() + _offset; break;
+            }
+
+            if ( position < 0 ) {
+                return ERROR( UNIX_FILE_LSEEK_ERR - EINVAL,
+                              fmt::format( "Lseek error for \"{}\", offset = {}, whence = {}.",
+                                           fco->physical_path(), _offset, _whence ) );
+            }
+
+            replica.offset = position;
+            result.code( position );
+            return result;
+        }
+    }
+
+    const long long status = lseek( fd, _offset, _whence );
+    if ( status < 0 ) {
+        const long long err_status = UNIX_FILE_LSEEK_ERR - errno;
+        return ERROR( err_status, fmt::format( "Lseek error for \"{}\", errno = \"{}\", status = {}.",
+                                               fco->physical_path(), strerror( errno ), err_status ) );
+    }
+
+    result.code( status );
+    return result;
+
+} // dedup_file_lseek
+
+// =-=-=-=-=-=-=-
+// interface for POSIX mkdir
+irods::error dedup_file_mkdir(
+    irods::plugin_context& _ctx ) {
+    // =-=-=-=-=-=-=-
+    // NOTE :: this function assumes the object's physical path is correct and
+    //         should not have the vault path prepended - hcj
+    irods::error ret = _ctx.valid< irods::collection_object >();
+    if ( !ret.ok() ) {
+        return PASSMSG( "resource context is invalid.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    mode_t myMask = umask( ( mode_t ) 0000 );
+    int    status = mkdir( fco->physical_path().c_str(), fco->mode() );
+    int    errsav = errno;
+    umask( ( mode_t ) myMask );
+
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_MKDIR_ERR - errsav;
+        return ERROR( err_status, fmt::format( "Mkdir error for \"{}\", errno = \"{}\", status = {}.",
+                                               fco->physical_path(), strerror( errsav ), err_status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // dedup_file_mkdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX rmdir
+irods::error dedup_file_rmdir(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    const int status = rmdir( fco->physical_path().c_str() );
+    const int err_status = UNIX_FILE_RMDIR_ERR - errno;
+    return ASSERT_ERROR( status >= 0, err_status, "Rmdir error for \"%s\", errno = \"%s\", status = %d.",
+                         fco->physical_path().c_str(), strerror( errno ), err_status );
+
+} // dedup_file_rmdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX opendir
+irods::error dedup_file_opendir(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    DIR* dir_ptr = opendir( fco->physical_path().c_str() );
+    if ( NULL == dir_ptr ) {
+        const int errsav = errno;
+        const int status = UNIX_FILE_CREATE_ERR - errsav;
+        return ERROR( status, fmt::format( "Open error for \"{}\", errno = \"{}\", status = \"{}\".",
+                                           fco->physical_path(), strerror( errsav ), status ) );
+    }
+
+    fco->directory_pointer( dir_ptr );
+
+    return SUCCESS();
+
+} // dedup_file_opendir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX closedir
+irods::error dedup_file_closedir(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    const int status = closedir( fco->directory_pointer() );
+    const int err_status = UNIX_FILE_CLOSEDIR_ERR - errno;
+    return ASSERT_ERROR( status >= 0, err_status, "Closedir error for \"%s\", errno = \"%s\", status = %d.",
+                         fco->physical_path().c_str(), strerror( errno ), err_status );
+
+} // dedup_file_closedir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX readdir
+irods::error dedup_file_readdir(
+    irods::plugin_context& _ctx,
+    struct rodsDirent**    _dirent_ptr ) {
+    irods::error ret = dedup_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    // =-=-=-=-=-=-=-
+    // the chunk store and staging files are not replicas
+    const auto hidden = []( const char* _name ) {
+        const std::string name{ _name };
+        return DEFAULT_CHUNK_STORE_NAME == name ||
+               ( name.size() > STAGING_SUFFIX.size() &&
+                 0 == name.compare( name.size() - STAGING_SUFFIX.size(), STAGING_SUFFIX.size(), STAGING_SUFFIX ) );
+    };
+
+    errno = 0;
+    struct dirent* tmp_dirent = nullptr;
+    while ( ( tmp_dirent = readdir( fco->directory_pointer() ) ) && hidden( tmp_dirent->d_name ) ) {
+    }
+
+    if ( !tmp_dirent ) {
+        const int status = UNIX_FILE_READDIR_ERR - errno;
+        irods::error result = ASSERT_ERROR( errno == 0, status, "Readdir error, status = %d, errno= \"%s\".",
+                                            status, strerror( errno ) );
+        if ( result.ok() ) {
+            result.code( -1 );
+        }
+        return result;
+    }
+
+    if ( !( *_dirent_ptr ) ) {
+        ( *_dirent_ptr ) = ( rodsDirent_t* ) malloc( sizeof( rodsDirent_t ) );
+    }
+
+    const int status = direntToRodsDirent( ( *_dirent_ptr ), tmp_dirent );
+    if ( status < 0 ) {
+        irods::log( ERROR( status, "direntToRodsDirent failed." ) );
+    }
+
+    return SUCCESS();
+
+} // dedup_file_readdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX rename
+irods::error dedup_file_rename(
+    irods::plugin_context& _ctx,
+    const char*            _new_file_name ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    std::string new_full_path;
+    ret = dedup_generate_full_path( _ctx.prop_map(), _new_file_name, new_full_path );
+    if ( !ret.ok() ) {
+        return PASSMSG( fmt::format( "Unable to generate full path for destination file: \"{}\".", _new_file_name ), ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+
+    mode_t mode = 0750;
+    ret = _ctx.prop_map().get< mode_t >( DEFAULT_VAULT_DIR_MODE, mode );
+    if ( !ret.ok() ) {
+        return PASS( ret );
+    }
+
+    // =-=-=-=-=-=-=-
+    // the manifest moves, the chunks it refers to stay where they are
+    boost::system::error_code ec;
+    boost::filesystem::create_directories( boost::filesystem::path{ new_full_path }.parent_path(), ec );
+    if ( !ec ) {
+        boost::filesystem::permissions( boost::filesystem::path{ new_full_path }.parent_path(),
+                                        static_cast< boost::filesystem::perms >( mode ), ec );
+    }
+
+    const int status = rename( fco->physical_path().c_str(), new_full_path.c_str() );
+    const int errsav = errno;
+
+    // issue 4326 - plugins must set the physical path to the new path
+    const auto old_path = fco->physical_path();
+    fco->physical_path( new_full_path );
+
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_RENAME_ERR - errsav;
+        return ERROR( err_status, fmt::format( "Rename error for \"{}\" to \"{}\", errno = \"{}\", status = {}.",
+                                               old_path, new_full_path, strerror( errsav ), err_status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // dedup_file_rename
+
+// =-=-=-=-=-=-=-
+// interface for POSIX truncate
+irods::error dedup_file_truncate(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr file_obj = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path = file_obj->physical_path();
+
+    std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+    // =-=-=-=-=-=-=-
+    // while the replica is open for writing its content is the staging file
+    if ( staging_writers.count( path ) > 0 ) {
+        const auto staging = path + STAGING_SUFFIX;
+        const int status = truncate( staging.c_str(), file_obj->size() );
+        const int err_status = UNIX_FILE_TRUNCATE_ERR - errno;
+        return ASSERT_ERROR( status >= 0, err_status, "Truncate error for: \"%s\", errno = \"%s\", status = %d.",
+                             staging.c_str(), strerror( errno ), err_status );
+    }
+
+    // =-=-=-=-=-=-=-
+    // otherwise the content is rebuilt, cut and chunked again
+    const int fd = dedup_open_staging( _ctx, path, false, 0600 );
+    if ( fd < 0 ) {
+        return ERROR( fd, fmt::format( "Truncate error for \"{}\".", path ) );
+    }
+
+    staging_writers.erase( path );
+
+    if ( ftruncate( fd, file_obj->size() ) < 0 ) {
+        const int err_status = UNIX_FILE_TRUNCATE_ERR - errno;
+        close( fd );
+        unlink( ( path + STAGING_SUFFIX ).c_str() );
+        return ERROR( err_status, fmt::format( "Truncate error for: \"{}\", errno = \"{}\".", path, strerror( errno ) ) );
+    }
+
+    close( fd );
+
+    return dedup_finalize_staging( _ctx, path );
+
+} // dedup_file_truncate
+
+// =-=-=-=-=-=-=-
+// dedup_file_stage_to_cache - reassembles the replica into the cache file
+irods::error dedup_file_stage_to_cache(
+    irods::plugin_context& _ctx,
+    const char*            _cache_file_name ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+
+    const int fd = open( _cache_file_name, O_WRONLY | O_CREAT | O_TRUNC, fco->mode() );
+    if ( fd < 0 ) {
+        return ERROR( UNIX_FILE_OPEN_ERR - errno, fmt::format( "Open error for cache file \"{}\".", _cache_file_name ) );
+    }
+
+    irods::error result = SUCCESS();
+
+    try {
+        const auto config = dedup_get_config( _ctx );
+        dedup_copy_content( dedup_get_store( _ctx, config ), fco->physical_path(), fd );
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+        irods::log( result );
+    }
+
+    close( fd );
+
+    return result;
+
+} // dedup_file_stage_to_cache
+
+// =-=-=-=-=-=-=-
+// dedup_file_sync_to_arch - chunks the cache file into the replica
+irods::error dedup_file_sync_to_arch(
+    irods::plugin_context& _ctx,
+    const char*            _cache_file_name ) {
+    irods::error ret = dedup_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    const int fd = open( _cache_file_name, O_RDONLY );
+    if ( fd < 0 ) {
+        return ERROR( UNIX_FILE_OPEN_ERR - errno, fmt::format( "Open error for cache file \"{}\".", _cache_file_name ) );
+    }
+
+    irods::error result = SUCCESS();
+
+    try {
+        boost::system::error_code ec;
+        boost::filesystem::create_directories( boost::filesystem::path{ path }.parent_path(), ec );
+
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+        dedup_store_content( _ctx, path, fd );
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+    }
+
+    close( fd );
+
+    return result;
+
+} // dedup_file_sync_to_arch
+
+// =-=-=-=-=-=-=-
+// used to allow the resource to determine which host
+// should provide the requested operation
+irods::error dedup_file_resolve_hierarchy(
+    irods::plugin_context&   _ctx,
+    const std::string*       _opr,
+    const std::string*       _curr_host,
+    irods::hierarchy_parser* _out_parser,
+    float*                   _out_vote )
+{
+    namespace irv = irods::experimental::resource::voting;
+
+    if (irods::error ret = _ctx.valid<irods::file_object>(); !ret.ok()) {
+        return PASSMSG("Invalid resource context.", ret);
+    }
+
+    if (!_opr || !_curr_host || !_out_parser || !_out_vote) {
+        return ERROR(SYS_INVALID_INPUT_PARAM, "Invalid input parameter.");
+    }
+
+    _out_parser->add_child(irods::get_resource_name(_ctx));
+    *_out_vote = irv::vote::zero;
+    try {
+        *_out_vote = irv::calculate(*_opr, _ctx, *_curr_host, *_out_parser);
+        return SUCCESS();
+    }
+    catch(const std::out_of_range& e) {
+        return ERROR(INVALID_OPERATION, e.what());
+    }
+    catch (const irods::exception& e) {
+        return irods::error(e);
+    }
+    return ERROR(SYS_UNKNOWN_ERROR, "An unknown error occurred while resolving hierarchy.");
+} // dedup_file_resolve_hierarchy
+
+// =-=-=-=-=-=-=-
+// dedup_file_rebalance - code which would rebalance the subtree
+irods::error dedup_file_rebalance(
+    irods::plugin_context& _ctx ) {
+    return SUCCESS();
+
+} // dedup_file_rebalance
+
+// =-=-=-=-=-=-=-
+// 3. create derived class to handle deduplicating file system resources
+class dedup_resource : public irods::resource {
+    public:
+        dedup_resource(
+            const std::string& _inst_name,
+            const std::string& _context ) :
+            irods::resource(
+                _inst_name,
+                _context ) {
+            properties_.set<mode_t>( DEFAULT_VAULT_DIR_MODE, 0750 );
+
+            // =-=-=-=-=-=-=-
+            // parse context string into property pairs assuming a ; as a separator
+            irods::kvp_map_t kvp;
+            irods::parse_kvp_string(
+                _context,
+                kvp );
+
+            for ( auto&& [ key, value ] : kvp ) {
+                properties_.set< std::string >( key, value );
+            }
+
+            set_dedup_config( kvp );
+
+        } // ctor
+
+        // =-=-=-=-=-=-=-
+        // parse the chunking and prefetch settings once. invalid values are
+        // logged and the defaults are kept.
+        void set_dedup_config( const irods::kvp_map_t& _kvp ) {
+            dedup_config config;
+
+            try {
+                if ( auto itr = _kvp.find( CHUNK_STORE ); itr != _kvp.end() ) {
+                    config.chunk_store = itr->second;
+                }
+
+                if ( auto itr = _kvp.find( MIN_CHUNK_SIZE ); itr != _kvp.end() ) {
+                    config.chunking.min_size = std::stoull( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( AVG_CHUNK_SIZE ); itr != _kvp.end() ) {
+                    config.chunking.average_size = std::stoull( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( MAX_CHUNK_SIZE ); itr != _kvp.end() ) {
+                    config.chunking.max_size = std::stoull( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( PREFETCH_THREADS ); itr != _kvp.end() ) {
+                    config.prefetch_threads = std::stoi( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( PREFETCH_WINDOW ); itr != _kvp.end() ) {
+                    config.prefetch_window = std::stoull( itr->second );
+                }
+
+                if ( config.prefetch_threads < 1 || config.prefetch_threads > 64 || config.prefetch_window < 1 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "prefetch_threads or prefetch_window out of range" );
+                }
+
+                // Throws if the chunk sizes are invalid.
+                static_cast< void >( dd::chunker{ config.chunking } );
+            }
+            catch ( const irods::exception& e ) {
+                rodsLog( LOG_ERROR, "dedup_resource: invalid settings for [%s]. Using the defaults. [%s]",
+                         instance_name_.c_str(), e.client_display_what() );
+                config = dedup_config{};
+            }
+            catch ( const std::exception& e ) {
+                rodsLog( LOG_ERROR, "dedup_resource: invalid settings for [%s]. Using the defaults. [%s]",
+                         instance_name_.c_str(), e.what() );
+                config = dedup_config{};
+            }
+
+            properties_.set< dedup_config >( DEDUP_CONFIG, config );
+        }
+
+        irods::error need_post_disconnect_maintenance_operation( bool& _b ) {
+            _b = false;
+            return SUCCESS();
+        }
+
+        irods::error post_disconnect_maintenance_operation( irods::pdmo_type& ) {
+            return ERROR( -1, "nop" );
+        }
+}; // class dedup_resource
+
+// =-=-=-=-=-=-=-
+// 4. create the plugin factory function which will return a dynamically
+//    instantiated object of the previously defined derived resource.  use
+//    the add_operation member to associate a 'call name' to the interfaces
+//    defined above.  for resource plugins these call names are standardized
+//    as used by the irods facing interface defined in
+//    server/drivers/src/fileDriver.c
+extern "C"
+irods::resource* plugin_factory( const std::string& _inst_name, const std::string& _context ) {
+
+    // =-=-=-=-=-=-=-
+    // 4a. create dedup_resource
+    dedup_resource* resc = new dedup_resource( _inst_name, _context );
+
+    // =-=-=-=-=-=-=-
+    // 4b. map function names to operations.  this map will be used to load
+    //     the symbols from the shared object in the delay_load stage of
+    //     plugin loading.
+    using namespace irods;
+    using namespace std;
+    resc->add_operation(
+        RESOURCE_OP_CREATE,
+        function<error(plugin_context&)>(
+            dedup_file_create ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_OPEN,
+        function<error(plugin_context&)>(
+            dedup_file_open ) );
+
+    resc->add_operation<void*,const int>(
+        irods::RESOURCE_OP_READ,
+        std::function<
+            error(irods::plugin_context&,void*,const int)>(
+                dedup_file_read ) );
+
+    resc->add_operation<const void*,const int>(
+        irods::RESOURCE_OP_WRITE,
+        function<error(plugin_context&,const void*,const int)>(
+            dedup_file_write ) );
+
+    resc->add_operation(
+        RESOURCE_OP_CLOSE,
+        function<error(plugin_context&)>(
+            dedup_file_close ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_UNLINK,
+        function<error(plugin_context&)>(
+            dedup_file_unlink ) );
+
+    resc->add_operation<struct stat*>(
+        irods::RESOURCE_OP_STAT,
+        function<error(plugin_context&, struct stat*)>(
+            dedup_file_stat ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_MKDIR,
+        function<error(plugin_context&)>(
+            dedup_file_mkdir ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_OPENDIR,
+        function<error(plugin_context&)>(
+            dedup_file_opendir ) );
+
+    resc->add_operation<struct rodsDirent**>(
+        irods::RESOURCE_OP_READDIR,
+        function<error(plugin_context&,struct rodsDirent**)>(
+            dedup_file_readdir ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_RENAME,
+        function<error(plugin_context&, const char*)>(
+            dedup_file_rename ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_FREESPACE,
+        function<error(plugin_context&)>(
+            dedup_file_getfs_freespace ) );
+
+    resc->add_operation<const long long, const int>(
+        irods::RESOURCE_OP_LSEEK,
+        function<error(plugin_context&, const long long, const int)>(
+            dedup_file_lseek ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_RMDIR,
+        function<error(plugin_context&)>(
+            dedup_file_rmdir ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_CLOSEDIR,
+        function<error(plugin_context&)>(
+            dedup_file_closedir ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_STAGETOCACHE,
+        function<error(plugin_context&, const char*)>(
+            dedup_file_stage_to_cache ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_SYNCTOARCH,
+        function<error(plugin_context&, const char*)>(
+            dedup_file_sync_to_arch ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_REGISTERED,
+        function<error(plugin_context&)>(
+            dedup_file_registered ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_UNREGISTERED,
+        function<error(plugin_context&)>(
+            dedup_file_unregistered ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_MODIFIED,
+        function<error(plugin_context&)>(
+            dedup_file_modified ) );
+
+    resc->add_operation<const std::string*>(
+        irods::RESOURCE_OP_NOTIFY,
+        function<error(plugin_context&, const std::string*)>(
+            dedup_file_notify ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_TRUNCATE,
+        function<error(plugin_context&)>(
+            dedup_file_truncate ) );
+
+    resc->add_operation<const std::string*, const std::string*, irods::hierarchy_parser*, float*>(
+        irods::RESOURCE_OP_RESOLVE_RESC_HIER,
+        function<error(plugin_context&,const std::string*, const std::string*, irods::hierarchy_parser*, float*)>(
+            dedup_file_resolve_hierarchy ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_REBALANCE,
+        function<error(plugin_context&)>(
+            dedup_file_rebalance ) );
+
+    // =-=-=-=-=-=-=-
+    // set some properties necessary for backporting to iRODS legacy code
+    resc->set_property< int >( irods::RESOURCE_CHECK_PATH_PERM, 2 );//DO_CHK_PATH_PERM );
+    resc->set_property< int >( irods::RESOURCE_CREATE_PATH,     1 );//CREATE_PATH );
+
+    // =-=-=-=-=-=-=-
+    // 4c. return the pointer through the generic interface of an
+    //     irods::resource pointer
+    return dynamic_cast<irods::resource*>( resc );
+
+} // plugin_factory
@@ -0,0 +1,1529 @@
+// =-=-=-=-=-=-=-
+// irods includes
+#include "msParam.h"
+#include "rcConnect.h"
+#include "miscServerFunct.hpp"
+
+// =-=-=-=-=-=-=-
+#include "irods_resource_plugin.hpp"
+#include "irods_file_object.hpp"
+#include "irods_physical_object.hpp"
+#include "irods_collection_object.hpp"
+#include "irods_hierarchy_parser.hpp"
+#include "irods_resource_redirect.hpp"
+#include "irods_kvp_string_parser.hpp"
+#include "irods_logger.hpp"
+#include "pack_store.hpp"
+#include "voting.hpp"
+
+// =-=-=-=-=-=-=-
+// stl includes
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// =-=-=-=-=-=-=-
+// boost includes
+#include <boost/filesystem.hpp>
+
+// =-=-=-=-=-=-=-
+// system includes
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace pk = irods::experimental::pack;
+
+// =-=-=-=-=-=-=-
+// 1. Define utility functions that the operations might need
+const std::string DEFAULT_VAULT_DIR_MODE( "default_vault_directory_mode_kw" );
+const std::string PACK_DIRECTORY( "pack_directory" );
+const std::string MAX_OBJECT_SIZE( "max_object_size" );
+const std::string MAX_CONTAINER_SIZE( "max_container_size" );
+const std::string COMPACTION_THRESHOLD( "compaction_threshold" );
+const std::string SYNC_APPENDS( "sync_appends" );
+const std::string PACK_CONFIG( "pack_config" ); // parsed form of the keys above
+
+// Name of the container directory inside the vault when pack_directory is not set.
+const std::string DEFAULT_PACK_DIRECTORY_NAME( ".pack" );
+
+struct pack_config {
+    std::string         pack_directory;
+    std::size_t         max_object_size = 1024 * 1024;
+    pk::pack_parameters parameters;
+};
+
+// =-=-=-=-=-=-=-
+// An object being written. It is held in memory and appended to the store when
+// the last descriptor writing it is closed, unless it grows past
+// max_object_size, in which case it is moved to a plain file.
+struct packed_object {
+    std::vector< char > data;
+    int                 mode = 0600;
+    int                 descriptors = 0;
+};
+
+// =-=-=-=-=-=-=-
+// State of the descriptors handed to the server, keyed by descriptor. Plain
+// files, e.g. large objects or files registered in place, have no state.
+struct open_replica {
+    std::string path;
+
+    // Set when a packed object is open for reading. The descriptor is its container.
+    std::optional< pk::location > location;
+
+    // Set when a packed object is open for writing. The descriptor is the
+    // container directory, which only serves as a unique number.
+    std::shared_ptr< packed_object > object;
+
+    std::int64_t offset = 0;
+};
+
+static std::mutex open_replicas_mutex;
+static std::unordered_map< int, open_replica > open_replicas;
+static std::unordered_map< std::string, std::shared_ptr< packed_object > > packed_writers;
+
+// =-=-=-=-=-=-=-
+/// @brief Generates a full path name from the partial physical path and the specified resource's vault path
+irods::error pack_generate_full_path(
+    irods::plugin_property_map& _prop_map,
+    const std::string&           _phy_path,
+    std::string&                 _ret_string ) {
+    std::string vault_path;
+    irods::error ret = _prop_map.get<std::string>( irods::RESOURCE_PATH, vault_path );
+    if ( !ret.ok() ) {
+        return ERROR( SYS_INVALID_INPUT_PARAM, "resource has no vault path." );
+    }
+
+    if ( _phy_path.compare( 0, 1, "/" ) != 0 &&
+            _phy_path.compare( 0, vault_path.size(), vault_path ) != 0 ) {
+        _ret_string = vault_path + "/" + _phy_path;
+    }
+    else {
+        // The physical path already contains the vault path
+        _ret_string = _phy_path;
+    }
+
+    return SUCCESS();
+
+} // pack_generate_full_path
+
+// =-=-=-=-=-=-=-
+/// @brief Checks the basic operation parameters and updates the physical path in the file object
+template< typename DEST_TYPE = irods::file_object >
+irods::error pack_check_params_and_path(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = _ctx.valid< DEST_TYPE >();
+    if ( !ret.ok() ) {
+        return PASSMSG( "resource context is invalid.", ret );
+    }
+
+    irods::data_object_ptr data_obj = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
+    std::string full_path;
+    ret = pack_generate_full_path( _ctx.prop_map(), data_obj->physical_path(), full_path );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Failed generating full path for object.", ret );
+    }
+
+    data_obj->physical_path( full_path );
+
+    return SUCCESS();
+
+} // pack_check_params_and_path
+
+pack_config pack_get_config(
+    irods::plugin_context& _ctx ) {
+    pack_config config;
+    _ctx.prop_map().get< pack_config >( PACK_CONFIG, config );
+    return config;
+
+} // pack_get_config
+
+// =-=-=-=-=-=-=-
+/// @brief Returns the store of the resource. Stores are opened once per process.
+pk::pack_store& pack_get_store(
+    irods::plugin_context& _ctx ) {
+    static std::mutex stores_mutex;
+    static std::map< std::string, std::unique_ptr< pk::pack_store > > stores;
+
+    const auto config = pack_get_config( _ctx );
+    auto directory = config.pack_directory;
+
+    // The vault path is not known when the resource is constructed.
+    if ( directory.empty() ) {
+        std::string vault_path;
+        _ctx.prop_map().get< std::string >( irods::RESOURCE_PATH, vault_path );
+        directory = vault_path + "/" + DEFAULT_PACK_DIRECTORY_NAME;
+    }
+
+    std::lock_guard< std::mutex > lock( stores_mutex );
+
+    auto& store = stores[ directory ];
+    if ( !store ) {
+        store = std::make_unique< pk::pack_store >( directory, config.parameters );
+    }
+
+    return *store;
+
+} // pack_get_store
+
+// =-=-=-=-=-=-=-
+/// @brief Returns the key of the object at _path, which is its path in the vault
+std::string pack_key(
+    irods::plugin_context& _ctx,
+    const std::string&     _path ) {
+    std::string vault_path;
+    _ctx.prop_map().get< std::string >( irods::RESOURCE_PATH, vault_path );
+
+    if ( !vault_path.empty() && _path.size() > vault_path.size() &&
+         0 == _path.compare( 0, vault_path.size(), vault_path ) && '/' == _path[ vault_path.size() ] ) {
+        return _path.substr( vault_path.size() + 1 );
+    }
+
+    return _path;
+
+} // pack_key
+
+// =-=-=-=-=-=-=-
+/// @brief Creates the parent directories of a plain file in the vault
+void pack_create_parent(
+    irods::plugin_context& _ctx,
+    const std::string&     _path ) {
+    mode_t mode = 0750;
+    _ctx.prop_map().get< mode_t >( DEFAULT_VAULT_DIR_MODE, mode );
+
+    const auto parent = boost::filesystem::path{ _path }.parent_path();
+
+    boost::system::error_code ec;
+    if ( boost::filesystem::exists( parent, ec ) ) {
+        return;
+    }
+
+    boost::filesystem::create_directories( parent, ec );
+    if ( ec ) {
+        THROW( UNIX_FILE_MKDIR_ERR - ec.value(), fmt::format( "pack: cannot create [{}]", parent.string() ) );
+    }
+
+    boost::filesystem::permissions( parent, static_cast< boost::filesystem::perms >( mode ), ec );
+
+} // pack_create_parent
+
+// =-=-=-=-=-=-=-
+/// @brief Writes _size bytes at the current position of _fd
+void pack_write_all(
+    int                _fd,
+    const void*        _data,
+    std::size_t        _size,
+    const std::string& _path ) {
+    const auto* p = static_cast< const char* >( _data );
+
+    while ( _size > 0 ) {
+        const ssize_t n = write( _fd, p, _size );
+        if ( n < 0 ) {
+            if ( EINTR == errno ) {
+                continue;
+            }
+            THROW( UNIX_FILE_WRITE_ERR - errno, fmt::format( "pack: cannot write [{}]", _path ) );
+        }
+
+        p += n;
+        _size -= n;
+    }
+
+} // pack_write_all
+
+// =-=-=-=-=-=-=-
+/// @brief Writes _data to a plain file at _path and removes the packed copy of
+///        the object, if any
+void pack_unpack(
+    irods::plugin_context&     _ctx,
+    const std::string&         _path,
+    const std::vector< char >& _data,
+    int                        _mode ) {
+    pack_create_parent( _ctx, _path );
+
+    const int fd = open( _path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, _mode );
+    if ( fd < 0 ) {
+        THROW( UNIX_FILE_CREATE_ERR - errno, fmt::format( "pack: cannot create [{}]", _path ) );
+    }
+
+    try {
+        pack_write_all( fd, _data.data(), _data.size(), _path );
+    }
+    catch ( const irods::exception& ) {
+        close( fd );
+        throw;
+    }
+
+    close( fd );
+
+    pack_get_store( _ctx ).remove( pack_key( _ctx, _path ) );
+
+} // pack_unpack
+
+// =-=-=-=-=-=-=-
+/// @brief Moves an object which outgrew max_object_size to a plain file and
+///        points every descriptor writing it at the file. Requires
+///        open_replicas_mutex.
+void pack_spill(
+    irods::plugin_context&                  _ctx,
+    const std::string&                      _path,
+    const std::shared_ptr< packed_object >& _object ) {
+    pack_unpack( _ctx, _path, _object->data, _object->mode );
+
+    for ( auto itr = open_replicas.begin(); itr != open_replicas.end(); ) {
+        if ( itr->second.object != _object ) {
+            ++itr;
+            continue;
+        }
+
+        const int fd = itr->first;
+
+        // Each descriptor gets a file description of its own, and with it a
+        // position of its own.
+        const int file = open( _path.c_str(), O_RDWR );
+        if ( file < 0 ) {
+            THROW( UNIX_FILE_OPEN_ERR - errno, fmt::format( "pack: cannot open [{}]", _path ) );
+        }
+
+        const int status = dup2( file, fd );
+        const int errsav = errno;
+        close( file );
+
+        if ( status < 0 ) {
+            THROW( UNIX_FILE_OPEN_ERR - errsav, fmt::format( "pack: cannot reopen [{}]", _path ) );
+        }
+
+        // From here on the descriptor is a plain file.
+        lseek( fd, itr->second.offset, SEEK_SET );
+        itr = open_replicas.erase( itr );
+    }
+
+    packed_writers.erase( _path );
+
+    irods::experimental::log::resource::debug(
+        "pack: [{}] grew past the maximum object size and is stored as a plain file", _path );
+
+} // pack_spill
+
+// =-=-=-=-=-=-=-
+/// @brief Opens the container of the packed object _key for reading, looking
+///        the object up again if a compaction removed the container
+int pack_open_container(
+    pk::pack_store&               _store,
+    const std::string&            _key,
+    std::optional< pk::location >& _location ) {
+    for ( int attempt = 0; attempt < 2 && _location; ++attempt ) {
+        const int fd = open( _store.container_path( _location->container ).c_str(), O_RDONLY );
+        if ( fd >= 0 ) {
+            return fd;
+        }
+
+        if ( ENOENT != errno ) {
+            return UNIX_FILE_OPEN_ERR - errno;
+        }
+
+        _store.reload();
+        _location = _store.find( _key );
+    }
+
+    return UNIX_FILE_OPEN_ERR - ENOENT;
+
+} // pack_open_container
+
+// =-=-=-=-=-=-=-
+/// @brief Registers a new descriptor writing the object at _path. Requires
+///        open_replicas_mutex.
+int pack_open_writer(
+    irods::plugin_context&     _ctx,
+    const std::string&         _path,
+    std::vector< char >        _data,
+    int                        _mode ) {
+    // =-=-=-=-=-=-=-
+    // the container directory stands in for the object until it is stored
+    const int fd = open( pack_get_store( _ctx ).directory().c_str(), O_RDONLY | O_DIRECTORY );
+    if ( fd < 0 ) {
+        return UNIX_FILE_OPEN_ERR - errno;
+    }
+
+    auto& object = packed_writers[ _path ];
+    if ( !object ) {
+        object = std::make_shared< packed_object >();
+        object->data = std::move( _data );
+        object->mode = _mode;
+    }
+
+    ++object->descriptors;
+
+    auto& replica = open_replicas[ fd ];
+    replica.path = _path;
+    replica.object = object;
+
+    return fd;
+
+} // pack_open_writer
+
+// =-=-=-=-=-=-=-
+// 2. Define operations which will be called by the file*
+//    calls declared in server/driver/include/fileDriver.h
+// =-=-=-=-=-=-=-
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file registration
+irods::error pack_file_registered(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file unregistration
+irods::error pack_file_unregistered(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file modification
+irods::error pack_file_modified(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+/// =-=-=-=-=-=-=-
+/// @brief interface to notify of a file operation
+irods::error pack_file_notify(
+    irods::plugin_context& _ctx,
+    const std::string* ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    return ASSERT_PASS( ret, "Invalid parameters or physical path." );
+}
+
+// =-=-=-=-=-=-=-
+// interface to determine free space on a device given a path
+irods::error pack_file_getfs_freespace(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    // =-=-=-=-=-=-=-
+    // packed objects have no directory of their own, so ask about the vault
+    std::string vault_path;
+    _ctx.prop_map().get< std::string >( irods::RESOURCE_PATH, vault_path );
+
+    struct statvfs statbuf{};
+    if ( statvfs( vault_path.c_str(), &statbuf ) < 0 ) {
+        const int status = UNIX_FILE_GET_FS_FREESPACE_ERR - errno;
+        return ERROR( status, fmt::format( "Statfs error for \"{}\", status = {}.", vault_path, status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( static_cast< rodsLong_t >( statbuf.f_bavail ) * statbuf.f_frsize );
+    return result;
+
+} // pack_file_getfs_freespace
+
+// =-=-=-=-=-=-=-
+// interface for POSIX create
+irods::error pack_file_create(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    try {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+        struct stat st{};
+        if ( packed_writers.count( path ) > 0 || stat( path.c_str(), &st ) == 0 ||
+             pack_get_store( _ctx ).find( pack_key( _ctx, path ) ) ) {
+            const int status = UNIX_FILE_CREATE_ERR - EEXIST;
+            fco->file_descriptor( status );
+            return ERROR( status, fmt::format( "create error for \"{}\", errno = \"{}\".", path, strerror( EEXIST ) ) );
+        }
+
+        const int fd = pack_open_writer( _ctx, path, {}, fco->mode() );
+        if ( fd < 0 ) {
+            fco->file_descriptor( fd );
+            return ERROR( fd, fmt::format( "create error for \"{}\".", path ) );
+        }
+
+        fco->file_descriptor( fd );
+        irods::error result = SUCCESS();
+        result.code( fd );
+        return result;
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+} // pack_file_create
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Open
+irods::error pack_file_open(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path  = fco->physical_path();
+    const int   flags = fco->flags();
+
+    int fd = -1;
+
+    try {
+        auto& store = pack_get_store( _ctx );
+        const auto key = pack_key( _ctx, path );
+
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+        // =-=-=-=-=-=-=-
+        // an object being written is held in the memory of one agent. a write
+        // joining the replica token of another agent is only possible once the
+        // object has been moved to a plain file
+        struct stat st{};
+        if ( O_RDONLY != ( flags & O_ACCMODE ) &&
+             getValByKey( &fco->cond_input(), REPLICA_TOKEN_KW ) &&
+             0 == packed_writers.count( path ) &&
+             stat( path.c_str(), &st ) < 0 ) {
+            return ERROR( USER_INTERMEDIATE_REPLICA_ACCESS,
+                          fmt::format( "\"{}\" is being written by another agent; "
+                                       "the pack resource does not support shared replica tokens.", path ) );
+        }
+
+        if ( packed_writers.count( path ) > 0 ) {
+            // =-=-=-=-=-=-=-
+            // another descriptor is writing the object. its content is shared
+            // and not truncated again.
+            fd = pack_open_writer( _ctx, path, {}, fco->mode() );
+        }
+        else if ( auto location = store.find( key ); location ) {
+            if ( O_RDONLY == ( flags & O_ACCMODE ) ) {
+                fd = pack_open_container( store, key, location );
+
+                if ( fd >= 0 ) {
+                    auto& replica = open_replicas[ fd ];
+                    replica.path = path;
+                    replica.location = location;
+                }
+            }
+            else {
+                auto data = ( flags & O_TRUNC ) ? std::vector< char >{} : store.read( *location );
+                fd = pack_open_writer( _ctx, path, std::move( data ), fco->mode() );
+            }
+        }
+        else {
+            // =-=-=-=-=-=-=-
+            // large objects and files registered in place are plain files
+            fd = open( path.c_str(), flags & ~O_CREAT );
+
+            if ( fd < 0 ) {
+                const int errsav = errno;
+                fd = UNIX_FILE_OPEN_ERR - errsav;
+
+                if ( ENOENT == errsav && ( flags & O_CREAT ) && O_RDONLY != ( flags & O_ACCMODE ) ) {
+                    fd = pack_open_writer( _ctx, path, {}, fco->mode() );
+                }
+            }
+        }
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    if ( fd < 0 ) {
+        return ERROR( fd, fmt::format( "Open error for \"{}\", status = \"{}\", flags = \"{}\".", path, fd, flags ) );
+    }
+
+    fco->file_descriptor( fd );
+    irods::error result = SUCCESS();
+    result.code( fd );
+    return result;
+
+} // pack_file_open
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Read
+irods::error pack_file_read(
+    irods::plugin_context& _ctx,
+    void*                  _buf,
+    const int              _len ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const int fd = fco->file_descriptor();
+
+    irods::error result = SUCCESS();
+
+    {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+        auto itr = open_replicas.find( fd );
+
+        if ( itr != open_replicas.end() ) {
+            auto& replica = itr->second;
+            const auto size = replica.object ? replica.object->data.size() : replica.location->size;
+            const auto n = static_cast< std::size_t >(
+                std::clamp< std::int64_t >( size - replica.offset, 0, _len ) );
+
+            if ( replica.object ) {
+                std::copy_n( replica.object->data.data() + replica.offset, n, static_cast< char* >( _buf ) );
+            }
+            else if ( n > 0 && pread( fd, _buf, n, replica.location->offset + replica.offset ) != static_cast< ssize_t >( n ) ) {
+                return ERROR( UNIX_FILE_READ_ERR - errno, fmt::format( "Read error for file: \"{}\".", replica.path ) );
+            }
+
+            replica.offset += n;
+            result.code( n );
+            return result;
+        }
+    }
+
+    const ssize_t status = read( fd, _buf, _len );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_READ_ERR - errno;
+        return ERROR( err_status, fmt::format( "Read error for file: \"{}\", errno = \"{}\".",
+                                               fco->physical_path(), strerror( errno ) ) );
+    }
+
+    result.code( status );
+    return result;
+
+} // pack_file_read
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Write
+irods::error pack_file_write(
+    irods::plugin_context& _ctx,
+    const void*            _buf,
+    const int              _len ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const int fd = fco->file_descriptor();
+
+    irods::error result = SUCCESS();
+
+    {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+        auto itr = open_replicas.find( fd );
+
+        if ( itr != open_replicas.end() && itr->second.object ) {
+            auto& replica = itr->second;
+            const auto object = replica.object;
+            const auto end = static_cast< std::size_t >( replica.offset ) + _len;
+
+            if ( end <= pack_get_config( _ctx ).max_object_size ) {
+                if ( object->data.size() < end ) {
+                    object->data.resize( end );
+                }
+
+                std::copy_n( static_cast< const char* >( _buf ), _len, object->data.data() + replica.offset );
+                replica.offset = end;
+                result.code( _len );
+                return result;
+            }
+
+            try {
+                pack_spill( _ctx, replica.path, object );
+            }
+            catch ( const irods::exception& e ) {
+                return irods::error( e );
+            }
+        }
+    }
+
+    // =-=-=-=-=-=-=-
+    // plain files, including objects which were just moved to one
+    const ssize_t status = write( fd, _buf, _len );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_WRITE_ERR - errno;
+        return ERROR( err_status, fmt::format( "Write file: \"{}\", errno = \"{}\", status = {}.",
+                                               fco->physical_path(), strerror( errno ), err_status ) );
+    }
+
+    result.code( status );
+    return result;
+
+} // pack_file_write
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Close
+irods::error pack_file_close(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const int fd = fco->file_descriptor();
+
+    irods::error result = SUCCESS();
+
+    // =-=-=-=-=-=-=-
+    // the last writer appends the object to the store. the lock is held so that
+    // a new descriptor does not start from the content being replaced.
+    std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+    if ( auto itr = open_replicas.find( fd ); itr != open_replicas.end() ) {
+        auto replica = std::move( itr->second );
+        open_replicas.erase( itr );
+
+        if ( replica.object && 0 == --replica.object->descriptors ) {
+            packed_writers.erase( replica.path );
+
+            try {
+                const auto& data = replica.object->data;
+                const auto location = pack_get_store( _ctx ).put( pack_key( _ctx, replica.path ), data.data(), data.size() );
+
+                irods::experimental::log::resource::debug( "pack: stored [{}] [size={}, container={}, offset={}]",
+                                                          replica.path, location.size, location.container, location.offset );
+            }
+            catch ( const irods::exception& e ) {
+                result = irods::error( e );
+                irods::log( result );
+            }
+        }
+    }
+
+    if ( close( fd ) < 0 && result.ok() ) {
+        const int err_status = UNIX_FILE_CLOSE_ERR - errno;
+        result = ERROR( err_status, fmt::format( "Close error for file: \"{}\", errno = \"{}\", status = {}.",
+                                                 fco->physical_path(), strerror( errno ), err_status ) );
+    }
+
+    return result;
+
+} // pack_file_close
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Unlink
+irods::error pack_file_unlink(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::data_object_ptr fco = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    // =-=-=-=-=-=-=-
+    // packed objects are removed by a tombstone, and their space is reclaimed
+    // when their container is compacted
+    try {
+        if ( pack_get_store( _ctx ).remove( pack_key( _ctx, path ) ) ) {
+            return SUCCESS();
+        }
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    const int status = unlink( path.c_str() );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_UNLINK_ERR - errno;
+        return ERROR( err_status, fmt::format( "Unlink error for \"{}\", errno = \"{}\", status = {}.",
+                                               path, strerror( errno ), err_status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // pack_file_unlink
+
+// =-=-=-=-=-=-=-
+// interface for POSIX Stat
+irods::error pack_file_stat(
+    irods::plugin_context& _ctx,
+    struct stat*           _statbuf ) {
+    // =-=-=-=-=-=-=-
+    // NOTE:: this function assumes the object's physical path is
+    //        correct and should not have the vault path
+    //        prepended - hcj
+    irods::error ret = _ctx.valid();
+    if ( !ret.ok() ) {
+        return PASSMSG( "resource context is invalid.", ret );
+    }
+
+    irods::data_object_ptr fco = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    // =-=-=-=-=-=-=-
+    // packed objects take the owner and times of their container
+    try {
+        auto& store = pack_get_store( _ctx );
+        std::optional< std::int64_t > size;
+
+        {
+            std::lock_guard< std::mutex > lock( open_replicas_mutex );
+            if ( auto itr = packed_writers.find( path ); itr != packed_writers.end() ) {
+                size = itr->second->data.size();
+            }
+        }
+
+        const auto location = size ? std::nullopt : store.find( pack_key( _ctx, path ) );
+        if ( location ) {
+            size = location->size;
+        }
+
+        if ( size ) {
+            const auto container = location ? store.container_path( location->container ) : store.directory();
+            if ( stat( container.c_str(), _statbuf ) < 0 ) {
+                memset( _statbuf, 0, sizeof( *_statbuf ) );
+            }
+
+            _statbuf->st_mode  = S_IFREG | 0600;
+            _statbuf->st_nlink = 1;
+            _statbuf->st_size  = *size;
+            return SUCCESS();
+        }
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    const int status = stat( path.c_str(), _statbuf );
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_STAT_ERR - errno;
+        return ERROR( err_status, fmt::format( "Stat error for \"{}\", errno = \"{}\", status = {}.",
+                                               path, strerror( errno ), err_status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // pack_file_stat
+
+// =-=-=-=-=-=-=-
+// interface for POSIX lseek
+irods::error pack_file_lseek(
+    irods::plugin_context& _ctx,
+    const long long        _offset,
+    const int              _whence ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const int fd = fco->file_descriptor();
+
+    irods::error result = SUCCESS();
+
+    {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+        auto itr = open_replicas.find( fd );
+
+        // =-=-=-=-=-=-=-
+        // packed objects are read and written at a position of our own
+        if ( itr != open_replicas.end() ) {
+            auto& replica = itr->second;
+            const long long size = replica.object ? replica.object->data.size() : replica.location->size;
+            long long position = -1;
+
+            switch ( _whence ) {
+                case SEEK_SET: position = _offset; break;
+                case SEEK_CUR: position = replica.offset + _offset; break;
+                case SEEK_END: position = size + _offset; break;
+            }
+
+            if ( position < 0 ) {
+                return ERROR( UNIX_FILE_LSEEK_ERR - EINVAL,
+                              fmt::format( "Lseek error for \"{}\", offset = {}, whence = {}.",
+                                           fco->physical_path(), _offset, _whence ) );
+            }
+
+            replica.offset = position;
+            result.code( position );
+            return result;
+        }
+    }
+
+    const long long status = lseek( fd, _offset, _whence );
+    if ( status < 0 ) {
+        const long long err_status = UNIX_FILE_LSEEK_ERR - errno;
+        return ERROR( err_status, fmt::format( "Lseek error for \"{}\", errno = \"{}\", status = {}.",
+                                               fco->physical_path(), strerror( errno ), err_status ) );
+    }
+
+    result.code( status );
+    return result;
+
+} // pack_file_lseek
+
+// =-=-=-=-=-=-=-
+// interface for POSIX mkdir
+irods::error pack_file_mkdir(
+    irods::plugin_context& _ctx ) {
+    // =-=-=-=-=-=-=-
+    // NOTE :: this function assumes the object's physical path is correct and
+    //         should not have the vault path prepended - hcj
+    irods::error ret = _ctx.valid< irods::collection_object >();
+    if ( !ret.ok() ) {
+        return PASSMSG( "resource context is invalid.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    mode_t myMask = umask( ( mode_t ) 0000 );
+    int    status = mkdir( fco->physical_path().c_str(), fco->mode() );
+    int    errsav = errno;
+    umask( ( mode_t ) myMask );
+
+    if ( status < 0 ) {
+        const int err_status = UNIX_FILE_MKDIR_ERR - errsav;
+        return ERROR( err_status, fmt::format( "Mkdir error for \"{}\", errno = \"{}\", status = {}.",
+                                               fco->physical_path(), strerror( errsav ), err_status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // pack_file_mkdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX rmdir
+irods::error pack_file_rmdir(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    const int status = rmdir( fco->physical_path().c_str() );
+    const int err_status = UNIX_FILE_RMDIR_ERR - errno;
+    return ASSERT_ERROR( status >= 0, err_status, "Rmdir error for \"%s\", errno = \"%s\", status = %d.",
+                         fco->physical_path().c_str(), strerror( errno ), err_status );
+
+} // pack_file_rmdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX opendir
+irods::error pack_file_opendir(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    DIR* dir_ptr = opendir( fco->physical_path().c_str() );
+    if ( NULL == dir_ptr ) {
+        const int errsav = errno;
+        const int status = UNIX_FILE_CREATE_ERR - errsav;
+        return ERROR( status, fmt::format( "Open error for \"{}\", errno = \"{}\", status = \"{}\".",
+                                           fco->physical_path(), strerror( errsav ), status ) );
+    }
+
+    fco->directory_pointer( dir_ptr );
+
+    return SUCCESS();
+
+} // pack_file_opendir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX closedir
+irods::error pack_file_closedir(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    const int status = closedir( fco->directory_pointer() );
+    const int err_status = UNIX_FILE_CLOSEDIR_ERR - errno;
+    return ASSERT_ERROR( status >= 0, err_status, "Closedir error for \"%s\", errno = \"%s\", status = %d.",
+                         fco->physical_path().c_str(), strerror( errno ), err_status );
+
+} // pack_file_closedir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX readdir
+irods::error pack_file_readdir(
+    irods::plugin_context& _ctx,
+    struct rodsDirent**    _dirent_ptr ) {
+    irods::error ret = pack_check_params_and_path< irods::collection_object >( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
+
+    // =-=-=-=-=-=-=-
+    // the container directory is not a replica. packed objects are not listed.
+    errno = 0;
+    struct dirent* tmp_dirent = nullptr;
+    while ( ( tmp_dirent = readdir( fco->directory_pointer() ) ) && DEFAULT_PACK_DIRECTORY_NAME == tmp_dirent->d_name ) {
+    }
+
+    if ( !tmp_dirent ) {
+        const int status = UNIX_FILE_READDIR_ERR - errno;
+        irods::error result = ASSERT_ERROR( errno == 0, status, "Readdir error, status = %d, errno= \"%s\".",
+                                            status, strerror( errno ) );
+        if ( result.ok() ) {
+            result.code( -1 );
+        }
+        return result;
+    }
+
+    if ( !( *_dirent_ptr ) ) {
+        ( *_dirent_ptr ) = ( rodsDirent_t* ) malloc( sizeof( rodsDirent_t ) );
+    }
+
+    const int status = direntToRodsDirent( ( *_dirent_ptr ), tmp_dirent );
+    if ( status < 0 ) {
+        irods::log( ERROR( status, "direntToRodsDirent failed." ) );
+    }
+
+    return SUCCESS();
+
+} // pack_file_readdir
+
+// =-=-=-=-=-=-=-
+// interface for POSIX rename
+irods::error pack_file_rename(
+    irods::plugin_context& _ctx,
+    const char*            _new_file_name ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    std::string new_full_path;
+    ret = pack_generate_full_path( _ctx.prop_map(), _new_file_name, new_full_path );
+    if ( !ret.ok() ) {
+        return PASSMSG( fmt::format( "Unable to generate full path for destination file: \"{}\".", _new_file_name ), ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto old_path = fco->physical_path();
+
+    // issue 4326 - plugins must set the physical path to the new path
+    fco->physical_path( new_full_path );
+
+    // =-=-=-=-=-=-=-
+    // packed objects are appended again under their new key
+    try {
+        if ( pack_get_store( _ctx ).rename( pack_key( _ctx, old_path ), pack_key( _ctx, new_full_path ) ) ) {
+            return SUCCESS();
+        }
+
+        pack_create_parent( _ctx, new_full_path );
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    const int status = rename( old_path.c_str(), new_full_path.c_str() );
+    if ( status < 0 ) {
+        const int errsav = errno;
+        const int err_status = UNIX_FILE_RENAME_ERR - errsav;
+        return ERROR( err_status, fmt::format( "Rename error for \"{}\" to \"{}\", errno = \"{}\", status = {}.",
+                                               old_path, new_full_path, strerror( errsav ), err_status ) );
+    }
+
+    irods::error result = SUCCESS();
+    result.code( status );
+    return result;
+
+} // pack_file_rename
+
+// =-=-=-=-=-=-=-
+// interface for POSIX truncate
+irods::error pack_file_truncate(
+    irods::plugin_context& _ctx ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr file_obj = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path = file_obj->physical_path();
+    const auto size = static_cast< std::size_t >( file_obj->size() );
+
+    try {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+        const auto config = pack_get_config( _ctx );
+        auto& store = pack_get_store( _ctx );
+
+        // =-=-=-=-=-=-=-
+        // while the object is open for writing its content is in memory
+        if ( auto itr = packed_writers.find( path ); itr != packed_writers.end() ) {
+            if ( size > config.max_object_size ) {
+                const auto object = itr->second;
+                pack_spill( _ctx, path, object );
+                return truncate( path.c_str(), size ) < 0
+                    ? ERROR( UNIX_FILE_TRUNCATE_ERR - errno, fmt::format( "Truncate error for: \"{}\".", path ) )
+                    : SUCCESS();
+            }
+
+            itr->second->data.resize( size );
+            return SUCCESS();
+        }
+
+        const auto key = pack_key( _ctx, path );
+        if ( const auto location = store.find( key ); location ) {
+            auto data = store.read( *location );
+            data.resize( size );
+
+            if ( size > config.max_object_size ) {
+                pack_unpack( _ctx, path, data, file_obj->mode() );
+            }
+            else {
+                store.put( key, data.data(), data.size() );
+            }
+
+            return SUCCESS();
+        }
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    const int status = truncate( path.c_str(), size );
+    const int err_status = UNIX_FILE_TRUNCATE_ERR - errno;
+    return ASSERT_ERROR( status >= 0, err_status, "Truncate error for: \"%s\", errno = \"%s\", status = %d.",
+                         path.c_str(), strerror( errno ), err_status );
+
+} // pack_file_truncate
+
+// =-=-=-=-=-=-=-
+// pack_file_stage_to_cache - copies the object into the cache file
+irods::error pack_file_stage_to_cache(
+    irods::plugin_context& _ctx,
+    const char*            _cache_file_name ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    std::vector< char > data;
+
+    try {
+        auto& store = pack_get_store( _ctx );
+        const auto key = pack_key( _ctx, path );
+
+        auto location = store.find( key );
+        if ( location ) {
+            // The container may have been compacted since the lookup.
+            const int fd = pack_open_container( store, key, location );
+            if ( fd < 0 ) {
+                return ERROR( fd, fmt::format( "Open error for the container of \"{}\".", path ) );
+            }
+            close( fd );
+
+            data = store.read( *location );
+        }
+        else {
+            std::ifstream in{ path, std::ios::binary };
+            if ( !in ) {
+                return ERROR( UNIX_FILE_OPEN_ERR - ENOENT, fmt::format( "Open error for \"{}\".", path ) );
+            }
+            data.assign( std::istreambuf_iterator< char >{ in }, std::istreambuf_iterator< char >{} );
+        }
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    const int fd = open( _cache_file_name, O_WRONLY | O_CREAT | O_TRUNC, fco->mode() );
+    if ( fd < 0 ) {
+        return ERROR( UNIX_FILE_OPEN_ERR - errno, fmt::format( "Open error for cache file \"{}\".", _cache_file_name ) );
+    }
+
+    irods::error result = SUCCESS();
+
+    try {
+        pack_write_all( fd, data.data(), data.size(), _cache_file_name );
+    }
+    catch ( const irods::exception& e ) {
+        result = irods::error( e );
+        irods::log( result );
+    }
+
+    close( fd );
+
+    return result;
+
+} // pack_file_stage_to_cache
+
+// =-=-=-=-=-=-=-
+// pack_file_sync_to_arch - packs the cache file, or copies it to a plain file
+//                          when it is too large to pack
+irods::error pack_file_sync_to_arch(
+    irods::plugin_context& _ctx,
+    const char*            _cache_file_name ) {
+    irods::error ret = pack_check_params_and_path( _ctx );
+    if ( !ret.ok() ) {
+        return PASSMSG( "Invalid parameters or physical path.", ret );
+    }
+
+    irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
+    const auto& path = fco->physical_path();
+
+    std::ifstream in{ _cache_file_name, std::ios::binary };
+    if ( !in ) {
+        return ERROR( UNIX_FILE_OPEN_ERR - errno, fmt::format( "Open error for cache file \"{}\".", _cache_file_name ) );
+    }
+
+    const std::vector< char > data{ std::istreambuf_iterator< char >{ in }, std::istreambuf_iterator< char >{} };
+
+    try {
+        std::lock_guard< std::mutex > lock( open_replicas_mutex );
+
+        if ( data.size() > pack_get_config( _ctx ).max_object_size ) {
+            pack_unpack( _ctx, path, data, fco->mode() );
+            return SUCCESS();
+        }
+
+        pack_get_store( _ctx ).put( pack_key( _ctx, path ), data.data(), data.size() );
+
+        // A plain file left by an earlier, larger version of the object.
+        unlink( path.c_str() );
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    return SUCCESS();
+
+} // pack_file_sync_to_arch
+
+// =-=-=-=-=-=-=-
+// used to allow the resource to determine which host
+// should provide the requested operation
+irods::error pack_file_resolve_hierarchy(
+    irods::plugin_context&   _ctx,
+    const std::string*       _opr,
+    const std::string*       _curr_host,
+    irods::hierarchy_parser* _out_parser,
+    float*                   _out_vote )
+{
+    namespace irv = irods::experimental::resource::voting;
+
+    if (irods::error ret = _ctx.valid<irods::file_object>(); !ret.ok()) {
+        return PASSMSG("Invalid resource context.", ret);
+    }
+
+    if (!_opr || !_curr_host || !_out_parser || !_out_vote) {
+        return ERROR(SYS_INVALID_INPUT_PARAM, "Invalid input parameter.");
+    }
+
+    _out_parser->add_child(irods::get_resource_name(_ctx));
+    *_out_vote = irv::vote::zero;
+    try {
+        *_out_vote = irv::calculate(*_opr, _ctx, *_curr_host, *_out_parser);
+        return SUCCESS();
+    }
+    catch(const std::out_of_range& e) {
+        return ERROR(INVALID_OPERATION, e.what());
+    }
+    catch (const irods::exception& e) {
+        return irods::error(e);
+    }
+    return ERROR(SYS_UNKNOWN_ERROR, "An unknown error occurred while resolving hierarchy.");
+} // pack_file_resolve_hierarchy
+
+// =-=-=-=-=-=-=-
+// pack_file_rebalance - compacts the containers which are mostly dead
+irods::error pack_file_rebalance(
+    irods::plugin_context& _ctx ) {
+    try {
+        auto& store = pack_get_store( _ctx );
+        const auto reclaimed = store.compact();
+        const auto stats = store.statistics();
+
+        irods::experimental::log::resource::info(
+            "pack: compacted [{}] [reclaimed_bytes={}, containers={}, objects={}, dead_ratio={:.2f}]",
+            store.directory(), reclaimed, stats.containers, stats.objects, stats.dead_ratio() );
+    }
+    catch ( const irods::exception& e ) {
+        return irods::error( e );
+    }
+
+    return SUCCESS();
+
+} // pack_file_rebalance
+
+// =-=-=-=-=-=-=-
+// 3. create derived class to handle small-file packing resources
+class pack_resource : public irods::resource {
+    public:
+        pack_resource(
+            const std::string& _inst_name,
+            const std::string& _context ) :
+            irods::resource(
+                _inst_name,
+                _context ) {
+            properties_.set<mode_t>( DEFAULT_VAULT_DIR_MODE, 0750 );
+
+            // =-=-=-=-=-=-=-
+            // parse context string into property pairs assuming a ; as a separator
+            irods::kvp_map_t kvp;
+            irods::parse_kvp_string(
+                _context,
+                kvp );
+
+            for ( auto&& [ key, value ] : kvp ) {
+                properties_.set< std::string >( key, value );
+            }
+
+            set_pack_config( kvp );
+
+        } // ctor
+
+        // =-=-=-=-=-=-=-
+        // parse the object and container settings once. invalid values are
+        // logged and the defaults are kept.
+        void set_pack_config( const irods::kvp_map_t& _kvp ) {
+            pack_config config;
+
+            try {
+                if ( auto itr = _kvp.find( PACK_DIRECTORY ); itr != _kvp.end() ) {
+                    config.pack_directory = itr->second;
+                }
+
+                if ( auto itr = _kvp.find( MAX_OBJECT_SIZE ); itr != _kvp.end() ) {
+                    config.max_object_size = std::stoull( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( MAX_CONTAINER_SIZE ); itr != _kvp.end() ) {
+                    config.parameters.max_container_size = std::stoull( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( COMPACTION_THRESHOLD ); itr != _kvp.end() ) {
+                    config.parameters.compaction_threshold = std::stod( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( SYNC_APPENDS ); itr != _kvp.end() ) {
+                    config.parameters.sync = ( "1" == itr->second || "true" == itr->second );
+                }
+
+                if ( config.max_object_size < 1 || config.max_object_size > config.parameters.max_container_size / 2 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "max_object_size must be positive and at most half of max_container_size" );
+                }
+
+                if ( config.parameters.compaction_threshold <= 0 || config.parameters.compaction_threshold > 1 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "compaction_threshold must be in (0, 1]" );
+                }
+            }
+            catch ( const irods::exception& e ) {
+                rodsLog( LOG_ERROR, "pack_resource: invalid settings for [%s]. Using the defaults. [%s]",
+                         instance_name_.c_str(), e.client_display_what() );
+                config = pack_config{};
+            }
+            catch ( const std::exception& e ) {
+                rodsLog( LOG_ERROR, "pack_resource: invalid settings for [%s]. Using the defaults. [%s]",
+                         instance_name_.c_str(), e.what() );
+                config = pack_config{};
+            }
+
+            properties_.set< pack_config >( PACK_CONFIG, config );
+        }
+
+        irods::error need_post_disconnect_maintenance_operation( bool& _b ) {
+            _b = false;
+            return SUCCESS();
+        }
+
+        irods::error post_disconnect_maintenance_operation( irods::pdmo_type& ) {
+            return ERROR( -1, "nop" );
+        }
+}; // class pack_resource
+
+// =-=-=-=-=-=-=-
+// 4. create the plugin factory function which will return a dynamically
+//    instantiated object of the previously defined derived resource.  use
+//    the add_operation member to associate a 'call name' to the interfaces
+//    defined above.  for resource plugins these call names are standardized
+//    as used by the irods facing interface defined in
+//    server/drivers/src/fileDriver.c
+extern "C"
+irods::resource* plugin_factory( const std::string& _inst_name, const std::string& _context ) {
+
+    // =-=-=-=-=-=-=-
+    // 4a. create pack_resource
+    pack_resource* resc = new pack_resource( _inst_name, _context );
+
+    // =-=-=-=-=-=-=-
+    // 4b. map function names to operations.  this map will be used to load
+    //     the symbols from the shared object in the delay_load stage of
+    //     plugin loading.
+    using namespace irods;
+    using namespace std;
+    resc->add_operation(
+        RESOURCE_OP_CREATE,
+        function<error(plugin_context&)>(
+            pack_file_create ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_OPEN,
+        function<error(plugin_context&)>(
+            pack_file_open ) );
+
+    resc->add_operation<void*,const int>(
+        irods::RESOURCE_OP_READ,
+        std::function<
+            error(irods::plugin_context&,void*,const int)>(
+                pack_file_read ) );
+
+    resc->add_operation<const void*,const int>(
+        irods::RESOURCE_OP_WRITE,
+        function<error(plugin_context&,const void*,const int)>(
+            pack_file_write ) );
+
+    resc->add_operation(
+        RESOURCE_OP_CLOSE,
+        function<error(plugin_context&)>(
+            pack_file_close ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_UNLINK,
+        function<error(plugin_context&)>(
+            pack_file_unlink ) );
+
+    resc->add_operation<struct stat*>(
+        irods::RESOURCE_OP_STAT,
+        function<error(plugin_context&, struct stat*)>(
+            pack_file_stat ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_MKDIR,
+        function<error(plugin_context&)>(
+            pack_file_mkdir ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_OPENDIR,
+        function<error(plugin_context&)>(
+            pack_file_opendir ) );
+
+    resc->add_operation<struct rodsDirent**>(
+        irods::RESOURCE_OP_READDIR,
+        function<error(plugin_context&,struct rodsDirent**)>(
+            pack_file_readdir ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_RENAME,
+        function<error(plugin_context&, const char*)>(
+            pack_file_rename ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_FREESPACE,
+        function<error(plugin_context&)>(
+            pack_file_getfs_freespace ) );
+
+    resc->add_operation<const long long, const int>(
+        irods::RESOURCE_OP_LSEEK,
+        function<error(plugin_context&, const long long, const int)>(
+            pack_file_lseek ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_RMDIR,
+        function<error(plugin_context&)>(
+            pack_file_rmdir ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_CLOSEDIR,
+        function<error(plugin_context&)>(
+            pack_file_closedir ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_STAGETOCACHE,
+        function<error(plugin_context&, const char*)>(
+            pack_file_stage_to_cache ) );
+
+    resc->add_operation<const char*>(
+        irods::RESOURCE_OP_SYNCTOARCH,
+        function<error(plugin_context&, const char*)>(
+            pack_file_sync_to_arch ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_REGISTERED,
+        function<error(plugin_context&)>(
+            pack_file_registered ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_UNREGISTERED,
+        function<error(plugin_context&)>(
+            pack_file_unregistered ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_MODIFIED,
+        function<error(plugin_context&)>(
+            pack_file_modified ) );
+
+    resc->add_operation<const std::string*>(
+        irods::RESOURCE_OP_NOTIFY,
+        function<error(plugin_context&, const std::string*)>(
+            pack_file_notify ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_TRUNCATE,
+        function<error(plugin_context&)>(
+            pack_file_truncate ) );
+
+    resc->add_operation<const std::string*, const std::string*, irods::hierarchy_parser*, float*>(
+        irods::RESOURCE_OP_RESOLVE_RESC_HIER,
+        function<error(plugin_context&,const std::string*, const std::string*, irods::hierarchy_parser*, float*)>(
+            pack_file_resolve_hierarchy ) );
+
+    resc->add_operation(
+        irods::RESOURCE_OP_REBALANCE,
+        function<error(plugin_context&)>(
+            pack_file_rebalance ) );
+
+    // =-=-=-=-=-=-=-
+    // set some properties necessary for backporting to iRODS legacy code
+    resc->set_property< int >( irods::RESOURCE_CHECK_PATH_PERM, 2 );//DO_CHK_PATH_PERM );
+    resc->set_property< int >( irods::RESOURCE_CREATE_PATH,     1 );//CREATE_PATH );
+
+    // =-=-=-=-=-=-=-
+    // 4c. return the pointer through the generic interface of an
+    //     irods::resource pointer
+    return dynamic_cast<irods::resource*>( resc );
+
+} // plugin_factory
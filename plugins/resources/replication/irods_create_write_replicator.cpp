@@ -3,6 +3,65 @@
 #include "dataObjRepl.h"
 #include "irods_repl_retry.hpp"
 #include "irods_stacktrace.hpp"
+#include "rcConnect.h"
+#include "rodsConnect.h"
+#include "rsGlobalExtern.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // The progress of the replications started by one fan-out write
+    struct fan_out_state {
+        std::mutex mutex;
+        int succeeded{};
+        std::vector<irods::error> errors;
+    };
+
+    // Opens a server-to-server connection to this server on behalf of the client, so the
+    // replication runs in its own agent and does not share the state of this one.
+    rcComm_t* connect_to_local_server(
+        rsComm_t& _comm ) {
+        const char* host = LocalServerHost->hostName->name;
+        const char* zone = getLocalZoneName();
+
+        rErrMsg_t err_msg{};
+        rcComm_t* conn = _rcConnect( host, static_cast<zoneInfo_t*>( LocalServerHost->zoneInfo )->portNum,
+                                     _comm.myEnv.rodsUserName, zone,
+                                     _comm.clientUser.userName, _comm.clientUser.rodsZone,
+                                     &err_msg, _comm.connectCnt, NO_RECONN );
+        if ( !conn ) {
+            rodsLog( LOG_NOTICE, "%s - failed to connect to [%s]: %d", __FUNCTION__, host, err_msg.status );
+            return nullptr;
+        }
+
+        if ( const int status = clientLogin( conn ); status < 0 ) {
+            rodsLog( LOG_NOTICE, "%s - clientLogin to [%s] failed: %d", __FUNCTION__, host, status );
+            rcDisconnect( conn );
+            return nullptr;
+        }
+
+        return conn;
+    }
+
+    irods::error make_replication_error(
+        int _status,
+        const std::string& _logical_path,
+        const std::string& _source,
+        const std::string& _destination ) {
+        char* sys_error = NULL;
+        auto rods_error = rodsErrorName( _status, &sys_error );
+        irods::error result = ERROR( _status, boost::format( "Failed to replicate the data object: \"%s\" from resource: \"%s\" "
+                                                             "to sibling: \"%s\" - %s %s." ) % _logical_path % _source %
+                                                             _destination % rods_error % sys_error );
+        free( sys_error );
+        return result;
+    }
+
+} // anonymous namespace
 
 namespace irods {
 
@@ -36,6 +95,12 @@ namespace irods {
             child_parser.str( sub_hier, current_resource_ );
 
             file_object object = _object_oper.object();
+
+            bool fan_out = false;
+            if ( _ctx.prop_map().get<bool>( FAN_OUT_KW, fan_out ).ok() && fan_out && _siblings.size() > 1 ) {
+                return replicate_concurrently( _ctx, _siblings, object, sub_hier );
+            }
+
             child_list_t::const_iterator it;
             for ( it = _siblings.begin(); it != _siblings.end(); ++it ) {
                 hierarchy_parser sibling = *it;
@@ -92,4 +157,128 @@ namespace irods {
         return SUCCESS();
     }
 
+    error create_write_replicator::replicate_concurrently(
+        plugin_context& _ctx,
+        const child_list_t& _siblings,
+        const file_object& _object,
+        const std::string& _sub_hier ) {
+
+        const int replicas = static_cast<int>( _siblings.size() ) + 1;
+
+        std::string quorum_str = QUORUM_ALL;
+        _ctx.prop_map().get<std::string>( QUORUM_KW, quorum_str );
+
+        int quorum = replicas;
+        if ( QUORUM_MAJORITY == quorum_str ) {
+            quorum = replicas / 2 + 1;
+        }
+        else if ( QUORUM_ALL != quorum_str ) {
+            quorum = std::clamp( std::atoi( quorum_str.c_str() ), 1, replicas );
+        }
+
+        repl_retry_settings retry_settings{};
+        try {
+            retry_settings = get_repl_retry_settings( _ctx );
+        }
+        catch ( const irods::exception& e ) {
+            return irods::error( e );
+        }
+
+        fan_out_state state;
+        std::vector<std::pair<dataObjInp_t, std::string>> fallback;
+        std::vector<std::thread> workers;
+
+        std::vector<std::string> hierarchy_strings;
+        for ( const auto& sibling : _siblings ) {
+            std::string hierarchy_string;
+            error ret = sibling.str( hierarchy_string );
+            if ( !ret.ok() ) {
+                return PASSMSG( "Failed to get the hierarchy string from the sibling hierarchy parser.", ret );
+            }
+            hierarchy_strings.push_back( hierarchy_string );
+        }
+
+        const auto record = [&state, &_object, this]( int _status, const std::string& _hierarchy_string ) {
+            std::lock_guard<std::mutex> lock{ state.mutex };
+            if ( _status >= 0 ) {
+                ++state.succeeded;
+            }
+            else {
+                state.errors.push_back( make_replication_error( _status, _object.logical_path(), child_, _hierarchy_string ) );
+                irods::log( state.errors.back() );
+            }
+        };
+
+        for ( const auto& hierarchy_string : hierarchy_strings ) {
+            dataObjInp_t dataObjInp;
+            bzero( &dataObjInp, sizeof( dataObjInp ) );
+            rstrcpy( dataObjInp.objPath, _object.logical_path().c_str(), MAX_NAME_LEN );
+            dataObjInp.createMode = _object.mode();
+
+            copyKeyVal( ( keyValPair_t* )&_object.cond_input(), &dataObjInp.condInput );
+            addKeyVal( &dataObjInp.condInput, RESC_HIER_STR_KW, child_.c_str() );
+            addKeyVal( &dataObjInp.condInput, DEST_RESC_HIER_STR_KW, hierarchy_string.c_str() );
+            addKeyVal( &dataObjInp.condInput, RESC_NAME_KW, root_resource_.c_str() );
+            addKeyVal( &dataObjInp.condInput, DEST_RESC_NAME_KW, root_resource_.c_str() );
+            rmKeyVal( &dataObjInp.condInput, ALL_KW );
+            rmKeyVal( &dataObjInp.condInput, IN_PDMO_KW );
+            rmKeyVal( &dataObjInp.condInput, LOCK_TYPE_KW );
+
+            // Each replication runs in an agent of its own, which registers the new replica
+            // in the catalog as soon as it completes. IN_PDMO_KW only has a meaning within this
+            // agent, so the other agent is told not to fan out again with REPL_FAN_OUT_KW,
+            // which is only seen by the file_modified operation of this resource.
+            rcComm_t* conn = connect_to_local_server( *_ctx.comm() );
+            if ( !conn ) {
+                addKeyVal( &dataObjInp.condInput, IN_PDMO_KW, _sub_hier.c_str() );
+                fallback.emplace_back( dataObjInp, hierarchy_string );
+                continue;
+            }
+            addKeyVal( &dataObjInp.condInput, REPL_FAN_OUT_KW, _sub_hier.c_str() );
+
+            workers.emplace_back( [conn, dataObjInp, hierarchy_string, retry_settings, &record]() mutable {
+                const int status = repl_with_retry( retry_settings, [conn, &dataObjInp] {
+                    return rcDataObjRepl( conn, &dataObjInp );
+                } );
+
+                rcDisconnect( conn );
+                clearKeyVal( &dataObjInp.condInput );
+                record( status, hierarchy_string );
+            } );
+        }
+
+        // Siblings which could not be reached through a connection of their own are
+        // replicated by this agent while the others are in progress.
+        for ( auto& [dataObjInp, hierarchy_string] : fallback ) {
+            int status{};
+            try {
+                status = data_obj_repl_with_retry( _ctx, dataObjInp );
+            }
+            catch ( const irods::exception& e ) {
+                status = e.code();
+            }
+            clearKeyVal( &dataObjInp.condInput );
+            record( status, hierarchy_string );
+        }
+
+        // Every replication completes before the operation returns; the quorum only
+        // decides whether the write succeeded.
+        for ( auto& worker : workers ) {
+            worker.join();
+        }
+
+        if ( 1 + state.succeeded >= quorum ) {
+            return SUCCESS();
+        }
+
+        // The quorum cannot be reached; report the failures to the client
+        for ( const auto& e : state.errors ) {
+            addRErrorMsg( &_ctx.comm()->rError, e.code(), e.result().c_str() );
+        }
+
+        return ERROR( state.errors.empty() ? SYS_INTERNAL_ERR : state.errors.back().code(),
+                      boost::format( "[%s] - %d of %d replicas are good; the quorum is %d." ) %
+                      __FUNCTION__ % ( 1 + state.succeeded ) % replicas % quorum );
+    }
+
 }; // namespace irods
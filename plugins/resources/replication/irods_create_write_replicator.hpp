@@ -2,8 +2,11 @@
 #define _IRODS_CREATE_WRITE_REPLICATOR_HPP_
 
 #include "irods_error.hpp"
+#include "irods_file_object.hpp"
 #include "irods_oper_replicator.hpp"
 
+#include <string>
+
 namespace irods {
 
     /**
@@ -21,6 +24,13 @@ namespace irods {
             error replicate( plugin_context& _ctx, const child_list_t& _siblings, const object_oper& _object_oper );
 
         private:
+            /// @brief Replicates to all siblings at the same time and checks the result against the configured quorum
+            error replicate_concurrently(
+                plugin_context& _ctx,
+                const child_list_t& _siblings,
+                const file_object& _object,
+                const std::string& _sub_hier );
+
             std::string root_resource_;
             std::string current_resource_;
             std::string child_;
@@ -7,64 +7,99 @@
 #include <string>
 #include <thread>
 
+namespace {
+    // Keep retrying until success or there are no more attempts left
+    int retry_failed_repl(
+        int status,
+        const irods::repl_retry_settings& _settings,
+        const std::function<int()>& _repl ) {
+
+        auto retry_attempts{ _settings.attempts };
+        auto delay_in_seconds{ _settings.first_delay_in_seconds };
+
+        irods::log(LOG_DEBUG, fmt::format(
+            "[{}:{}] - replication failed, retrying...attempts:[{}],delay:[{}],backoff[{}]",
+            __FUNCTION__, __LINE__, retry_attempts, delay_in_seconds, _settings.backoff_multiplier));
+
+        try {
+            while ( status < 0 && retry_attempts-- > 0 ) {
+                irods::log(LOG_DEBUG, fmt::format("[{}:{}] - retries remaining:[{}]", __FUNCTION__, __LINE__, retry_attempts));
+                std::this_thread::sleep_for( std::chrono::seconds( delay_in_seconds ) );
+                status = _repl();
+                if ( status < 0 && retry_attempts > 0 ) {
+                    delay_in_seconds = boost::numeric_cast< decltype( delay_in_seconds ) >
+                                        ( delay_in_seconds * _settings.backoff_multiplier );
+                }
+            }
+        }
+        catch( const boost::bad_numeric_cast& e ) {
+            // Indicates that delay value is too large to store,
+            // so we should stop retrying (2^32 seconds > 136 years)
+            irods::error err = ERROR( USER_INPUT_OPTION_ERR, e.what() );
+            irods::log( err );
+        }
+
+        return status;
+    }
+} // anonymous namespace
+
 // Replicates a data object and verifies that the bits are correct
 // Retry mechanism triggers based on config in repl context string
 int irods::data_obj_repl_with_retry(
         irods::plugin_context& _ctx,
         dataObjInp_t& dataObjInp ) {
 
-    transferStat_t* trans_stat{ nullptr };
     rmKeyVal(&dataObjInp.condInput, ALL_KW);
-    auto status{ rsDataObjRepl( _ctx.comm(), &dataObjInp, &trans_stat ) };
+
+    const auto repl = [&_ctx, &dataObjInp] {
+        transferStat_t* trans_stat{ nullptr };
+        const auto status{ rsDataObjRepl( _ctx.comm(), &dataObjInp, &trans_stat ) };
+        free( trans_stat );
+        return status;
+    };
+
+    const auto status{ repl() };
     if ( 0 == status ) {
         irods::log(LOG_DEBUG, fmt::format("[{}:{}] - replication succeeded", __FUNCTION__, __LINE__));
-        free( trans_stat );
         return status;
     }
 
     // Throw in the event that repl resource retry settings not set
-    auto retry_attempts{ irods::DEFAULT_RETRY_ATTEMPTS };
-    auto delay_in_seconds{ irods::DEFAULT_RETRY_FIRST_DELAY_IN_SECONDS };
-    auto backoff_multiplier{ irods::DEFAULT_RETRY_BACKOFF_MULTIPLIER };
-    irods::error err{ _ctx.prop_map().get< decltype( retry_attempts ) >
-                          ( irods::RETRY_ATTEMPTS_KW, retry_attempts ) };
+    return retry_failed_repl( status, get_repl_retry_settings( _ctx ), repl );
+}
+
+irods::repl_retry_settings irods::get_repl_retry_settings(
+        irods::plugin_context& _ctx ) {
+
+    repl_retry_settings settings{};
+    irods::error err{ _ctx.prop_map().get< decltype( settings.attempts ) >
+                          ( irods::RETRY_ATTEMPTS_KW, settings.attempts ) };
     if ( !err.ok() ) {
         THROW( err.code(), err.result() );
     }
-    err = _ctx.prop_map().get< decltype( delay_in_seconds ) >
-              ( irods::RETRY_FIRST_DELAY_IN_SECONDS_KW, delay_in_seconds );
+    err = _ctx.prop_map().get< decltype( settings.first_delay_in_seconds ) >
+              ( irods::RETRY_FIRST_DELAY_IN_SECONDS_KW, settings.first_delay_in_seconds );
     if ( !err.ok() ) {
         THROW( err.code(), err.result() );
     }
-    err = _ctx.prop_map().get< decltype( backoff_multiplier ) >
-              ( irods::RETRY_BACKOFF_MULTIPLIER_KW, backoff_multiplier );
+    err = _ctx.prop_map().get< decltype( settings.backoff_multiplier ) >
+              ( irods::RETRY_BACKOFF_MULTIPLIER_KW, settings.backoff_multiplier );
     if ( !err.ok() ) {
         THROW( err.code(), err.result() );
     }
 
-    irods::log(LOG_DEBUG, fmt::format(
-        "[{}:{}] - replication failed, retrying...attempts:[{}],delay:[{}],backoff[{}]",
-        __FUNCTION__, __LINE__, retry_attempts, delay_in_seconds, backoff_multiplier));
+    return settings;
+}
 
-    // Keep retrying until success or there are no more attempts left
-    try {
-        while ( status < 0 && retry_attempts-- > 0 ) {
-            irods::log(LOG_DEBUG, fmt::format("[{}:{}] - retries remaining:[{}]", __FUNCTION__, __LINE__, retry_attempts));
-            std::this_thread::sleep_for( std::chrono::seconds( delay_in_seconds ) );
-            status = rsDataObjRepl( _ctx.comm(), &dataObjInp, &trans_stat );
-            if ( status < 0 && retry_attempts > 0 ) {
-                delay_in_seconds = boost::numeric_cast< decltype( delay_in_seconds ) >
-                                    ( delay_in_seconds * backoff_multiplier );
-            }
-        }
-    }
-    catch( const boost::bad_numeric_cast& e ) {
-        // Indicates that delay value is too large to store,
-        // so we should stop retrying (2^32 seconds > 136 years)
-        irods::error err = ERROR( USER_INPUT_OPTION_ERR, e.what() );
-        irods::log( err );
+int irods::repl_with_retry(
+        const repl_retry_settings& _settings,
+        const std::function<int()>& _repl ) {
+
+    const auto status{ _repl() };
+    if ( 0 == status ) {
+        irods::log(LOG_DEBUG, fmt::format("[{}:{}] - replication succeeded", __FUNCTION__, __LINE__));
+        return status;
     }
 
-    free( trans_stat );
-    return status;
+    return retry_failed_repl( status, _settings, _repl );
 }
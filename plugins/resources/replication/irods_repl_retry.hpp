@@ -3,14 +3,11 @@
 
 #include "dataObjInpOut.h"
 #include "irods_plugin_context.hpp"
+
+#include <functional>
 #include <string>
 
 namespace irods {
-    // throws irods::exception
-    int data_obj_repl_with_retry(
-        irods::plugin_context& _ctx,
-        dataObjInp_t& dataObjInp );
-
     const std::string RETRY_ATTEMPTS_KW{ "retry_attempts" };
     const std::string RETRY_FIRST_DELAY_IN_SECONDS_KW{ "first_retry_delay_in_seconds" };
     const std::string RETRY_BACKOFF_MULTIPLIER_KW{ "backoff_multiplier" };
@@ -18,6 +15,28 @@ namespace irods {
     const uint32_t DEFAULT_RETRY_ATTEMPTS{ 1 };
     const uint32_t DEFAULT_RETRY_FIRST_DELAY_IN_SECONDS{ 1 };
     const double DEFAULT_RETRY_BACKOFF_MULTIPLIER{ 1.0f };
+
+    struct repl_retry_settings {
+        uint32_t attempts{ DEFAULT_RETRY_ATTEMPTS };
+        uint32_t first_delay_in_seconds{ DEFAULT_RETRY_FIRST_DELAY_IN_SECONDS };
+        double backoff_multiplier{ DEFAULT_RETRY_BACKOFF_MULTIPLIER };
+    };
+
+    // throws irods::exception
+    int data_obj_repl_with_retry(
+        irods::plugin_context& _ctx,
+        dataObjInp_t& dataObjInp );
+
+    // Reads the retry settings from the resource properties
+    // throws irods::exception
+    repl_retry_settings get_repl_retry_settings(
+        irods::plugin_context& _ctx );
+
+    // Calls _repl until it returns a status >= 0 or the attempts are exhausted.
+    // Does not touch the plugin context, so it may be called from any thread.
+    int repl_with_retry(
+        const repl_retry_settings& _settings,
+        const std::function<int()>& _repl );
 }
 
 #endif // _IRODS_REPL_RETRY_HPP_
@@ -27,4 +27,15 @@ typedef std::multimap<float, irods::hierarchy_parser, child_comp> redirect_map_t
 const std::string CHILD_LIST_PROP{"child_list"};
 const std::string OBJECT_LIST_PROP{"object_list"};
 
+// When "fan_out=true" is in the context string, a new or modified data object is
+// replicated to all children at the same time instead of one child after another.
+const std::string FAN_OUT_KW{"fan_out"};
+
+// The number of good replicas, counting the one written by the client, that must exist
+// for a fan-out write to succeed: "all" (the default), "majority" or a positive integer.
+// The write always waits for every replication to complete.
+const std::string QUORUM_KW{"quorum"};
+const std::string QUORUM_ALL{"all"};
+const std::string QUORUM_MAJORITY{"majority"};
+
 #endif // _IRODS_REPL_TYPES_HPP_
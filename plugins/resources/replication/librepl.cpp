@@ -488,6 +488,15 @@ irods::error repl_file_modified(irods::plugin_context& _ctx) {
         return SUCCESS();
     }
 
+    // Replications started by a fan-out of this resource run in agents of their own, which
+    // must not fan out again
+    if (const auto fan_out{getValByKey(&file_obj->cond_input(), REPL_FAN_OUT_KW)}; fan_out) {
+        sub_parser.set_string(fan_out);
+        if (sub_parser.resc_in_hier(name)) {
+            return SUCCESS();
+        }
+    }
+
     // The selected child resource is not added to the child list property
     // Only replicate if the selected child resource is not in the list
     // TODO: Replace with a query
@@ -1684,6 +1693,38 @@ class repl_resource : public irods::resource {
                 if ( kvp_map.find( READ_KW ) != kvp_map.end() ) {
                     properties_.set< std::string >( READ_KW, kvp_map[ READ_KW ] );
                 }
+
+                if ( kvp_map.find( FAN_OUT_KW ) != kvp_map.end() ) {
+                    properties_.set< bool >( FAN_OUT_KW, "true" == kvp_map[ FAN_OUT_KW ] || "1" == kvp_map[ FAN_OUT_KW ] );
+                }
+
+                if ( kvp_map.find( QUORUM_KW ) != kvp_map.end() ) {
+                    const auto& quorum = kvp_map[ QUORUM_KW ];
+                    bool valid = ( QUORUM_ALL == quorum || QUORUM_MAJORITY == quorum );
+                    if ( !valid ) {
+                        try {
+                            valid = boost::lexical_cast< int >( quorum ) > 0;
+                        }
+                        catch ( const boost::bad_lexical_cast& ) {
+                        }
+                    }
+
+                    if ( valid ) {
+                        properties_.set< std::string >( QUORUM_KW, quorum );
+                    }
+                    else {
+                        irods::log( ERROR( SYS_INVALID_INPUT_PARAM,
+                                        boost::format(
+                                        "[%s] - [%s] for resource [%s] must be \"%s\", \"%s\" or a positive integer, not [%s]; using default value [%s]") %
+                                        __FUNCTION__ %
+                                        QUORUM_KW %
+                                        _inst_name %
+                                        QUORUM_ALL %
+                                        QUORUM_MAJORITY %
+                                        quorum %
+                                        QUORUM_ALL ) );
+                    }
+                }
             } // ctor
 
         irods::error post_disconnect_maintenance_operation(
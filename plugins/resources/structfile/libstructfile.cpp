@@ -8,6 +8,7 @@
 #include "irods_hierarchy_parser.hpp"
 #include "irods_resource_backport.hpp"
 #include "apiHeaderAll.h"
+#include "dataObjOpr.hpp"
 #include "rsFileOpen.hpp"
 #include "rsFileStat.hpp"
 #include "rsFileRead.hpp"
@@ -24,10 +25,21 @@
 #include "rsFileReaddir.hpp"
 #include "rsFileRename.hpp"
 #include "rsFileTruncate.hpp"
+#include "irods_exception.hpp"
+#include "irods_server_properties.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "parallel_gzip.hpp"
+#include "tar_member_index.hpp"
+#include "thread_pool.hpp"
 
 // =-=-=-=-=-=-=-
 // stl includes
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <thread>
 #include <sstream>
 #include <vector>
 #include <string>
@@ -55,6 +67,7 @@ typedef struct structFileDesc {
 } structFileDesc_t;
 
 #define CACHE_DIR_STR "cacheDir"
+#define MEMBER_INDEX_STR "memberIndex"
 
 typedef struct tarSubFileDesc {
     int inuseFlag;
@@ -62,6 +75,11 @@ typedef struct tarSubFileDesc {
     int fd;                         /* the fd of the opened cached subFile */
     char cacheFilePath[MAX_NAME_LEN];   /* the phy path name of the cached
                                          * subFile */
+    int inPlace;                    /* fd is the tar file itself, positioned
+                                     * within the member */
+    rodsLong_t memberOffset;        /* the offset of the member in the tar file */
+    rodsLong_t memberSize;
+    rodsLong_t position;            /* the offset within the member */
 } tarSubFileDesc_t;
 
 #define NUM_TAR_SUB_FILE_DESC 20
@@ -88,6 +106,11 @@ const int NUM_STRUCT_FILE_DESC = 16;
 structFileDesc_t PluginStructFileDesc[ NUM_STRUCT_FILE_DESC  ];
 tarSubFileDesc_t PluginTarSubFileDesc[ NUM_TAR_SUB_FILE_DESC ];
 
+// =-=-=-=-=-=-=-=-
+// member indexes of the uncompressed tar files in PluginStructFileDesc,
+// loaded on first access to a member which is not staged
+std::optional<irods::experimental::tar::member_index> PluginStructFileIndex[ NUM_STRUCT_FILE_DESC ];
+
 // =-=-=-=-=-=-=-=-
 // manager of resource plugins which are resolved and cached
 extern irods::resource_manager resc_mgr;
@@ -99,6 +122,9 @@ extern irods::resource_manager resc_mgr;
 irods::error tarfilesystem_resource_start( irods::plugin_property_map& ) {
     memset( PluginStructFileDesc, 0, sizeof( structFileDesc_t ) * NUM_STRUCT_FILE_DESC );
     memset( PluginTarSubFileDesc, 0, sizeof( tarSubFileDesc_t ) * NUM_TAR_SUB_FILE_DESC );
+    for ( auto& index : PluginStructFileIndex ) {
+        index.reset();
+    }
     return SUCCESS();
 }
 
@@ -108,6 +134,9 @@ irods::error tarfilesystem_resource_start( irods::plugin_property_map& ) {
 irods::error tarfilesystem_resource_stop( irods::plugin_property_map& ) {
     memset( PluginStructFileDesc, 0, sizeof( structFileDesc_t ) * NUM_STRUCT_FILE_DESC );
     memset( PluginTarSubFileDesc, 0, sizeof( tarSubFileDesc_t ) * NUM_TAR_SUB_FILE_DESC );
+    for ( auto& index : PluginStructFileIndex ) {
+        index.reset();
+    }
     return SUCCESS();
 }
 
@@ -146,6 +175,7 @@ struct cb_ctx_t {
     char              loc_[ NAME_LEN ];
     structFileDesc_t* desc_;
     bytesBuf_t        read_buf;
+    irods::experimental::gzip::parallel_writer* gzip_;
 };
 
 // =-=-=-=-=-=-=-
@@ -310,6 +340,62 @@ ssize_t irods_file_write(
 
 } // irods_file_write
 
+// =-=-=-=-=-=-=-
+// WRITE callback which compresses the archive on several threads
+// before it is written via the irods rsFile API
+ssize_t irods_file_write_gzip(
+    struct archive* _arch,
+    void*           _data,
+    const void*     _buff,
+    size_t          _len ) {
+    if ( !_arch ||
+            !_data ||
+            !_buff ) {
+        rodsLog( LOG_ERROR, "irods_file_write_gzip - null input" );
+        return ARCHIVE_FATAL;
+    }
+
+    cb_ctx_t* cb_ctx = static_cast< cb_ctx_t* >( _data );
+
+    try {
+        cb_ctx->gzip_->write( _buff, _len );
+    }
+    catch ( const irods::exception& e ) {
+        irods::log( e );
+        return -1;
+    }
+
+    return _len;
+
+} // irods_file_write_gzip
+
+// =-=-=-=-=-=-=-
+// CLOSE callback which flushes the compressed archive before
+// the file is closed
+int irods_file_close_gzip(
+    struct archive* _arch,
+    void*           _data ) {
+    if ( !_arch ||
+            !_data ) {
+        rodsLog( LOG_ERROR, "irods_file_close_gzip - null input" );
+        return ARCHIVE_FATAL;
+    }
+
+    cb_ctx_t* cb_ctx = static_cast< cb_ctx_t* >( _data );
+
+    try {
+        cb_ctx->gzip_->close();
+    }
+    catch ( const irods::exception& e ) {
+        irods::log( e );
+        irods_file_close( _arch, _data );
+        return ARCHIVE_FATAL;
+    }
+
+    return irods_file_close( _arch, _data );
+
+} // irods_file_close_gzip
+
 // =-=-=-=-=-=-=-
 // call archive file extraction for struct file
 irods::error extract_file( int _index ) {
@@ -593,6 +679,7 @@ int free_struct_file_desc( int _idx ) {
     }
 
     memset( &PluginStructFileDesc[ _idx ], 0, sizeof( structFileDesc_t ) );
+    PluginStructFileIndex[ _idx ].reset();
 
     return 0;
 
@@ -616,13 +703,15 @@ int match_struct_file_desc( specColl_t* _spec_coll ) {
 } // match_struct_file_desc
 
 // =-=-=-=-=-=-=-
-// local function to manage the open of a tar file
+// local function to manage the open of a tar file. the tar file is
+// extracted into its cache dir unless _stage is false
 irods::error tar_struct_file_open(
     rsComm_t*          _comm,
     specColl_t*        _spec_coll,
     int&               _struct_desc_index,
     const std::string& _resc_hier,
-    std::string&       _resc_host ) {
+    std::string&       _resc_host,
+    bool               _stage = true ) {
     int status                  = 0;
     specCollCache_t* spec_cache = 0;
 
@@ -639,48 +728,48 @@ irods::error tar_struct_file_open(
     }
 
     // =-=-=-=-=-=-=-
-    // look for opened PluginStructFileDesc
+    // look for opened PluginStructFileDesc. it may not have been staged
+    // yet so the host is resolved either way
     _struct_desc_index = match_struct_file_desc( _spec_coll );
-    if ( _struct_desc_index > 0 ) {
-        return SUCCESS();
-    }
-
-    // =-=-=-=-=-=-=-
-    // alloc and trap bad alloc
-    if ( ( _struct_desc_index = alloc_struct_file_desc() ) < 0 ) {
-        return ERROR( _struct_desc_index, "tar_struct_file_open - call to allocStructFileDesc failed." );
-    }
-
-    // =-=-=-=-=-=-=-
-    // [ mwan? :: Have to do this because  _spec_coll could come from a remote host ]
-    // NOTE :: i dont see any remote server to server comms here
-    if ( ( status = getSpecCollCache( _comm,  _spec_coll->collection, 0, &spec_cache ) ) >= 0 ) {
+    const bool matched = _struct_desc_index > 0;
+    if ( !matched ) {
         // =-=-=-=-=-=-=-
-        // copy pointer to cached special collection
-        PluginStructFileDesc[ _struct_desc_index ].specColl = &spec_cache->specColl;
-        if ( !PluginStructFileDesc[ _struct_desc_index ].specColl ) {
-
+        // alloc and trap bad alloc
+        if ( ( _struct_desc_index = alloc_struct_file_desc() ) < 0 ) {
+            return ERROR( _struct_desc_index, "tar_struct_file_open - call to allocStructFileDesc failed." );
         }
 
         // =-=-=-=-=-=-=-
-        // copy over physical path and resource name since getSpecCollCache
-        // does not give phyPath nor resource
-        if ( strlen( _spec_coll->phyPath ) > 0 ) { // JMC - backport 4517
-            rstrcpy( spec_cache->specColl.phyPath,  _spec_coll->phyPath, MAX_NAME_LEN );
+        // [ mwan? :: Have to do this because  _spec_coll could come from a remote host ]
+        // NOTE :: i dont see any remote server to server comms here
+        if ( ( status = getSpecCollCache( _comm,  _spec_coll->collection, 0, &spec_cache ) ) >= 0 ) {
+            // =-=-=-=-=-=-=-
+            // copy pointer to cached special collection
+            PluginStructFileDesc[ _struct_desc_index ].specColl = &spec_cache->specColl;
+            if ( !PluginStructFileDesc[ _struct_desc_index ].specColl ) {
+
+            }
+
+            // =-=-=-=-=-=-=-
+            // copy over physical path and resource name since getSpecCollCache
+            // does not give phyPath nor resource
+            if ( strlen( _spec_coll->phyPath ) > 0 ) { // JMC - backport 4517
+                rstrcpy( spec_cache->specColl.phyPath,  _spec_coll->phyPath, MAX_NAME_LEN );
+            }
+            if ( strlen( spec_cache->specColl.resource ) == 0 ) {
+                rstrcpy( spec_cache->specColl.resource,  _spec_coll->resource, NAME_LEN );
+            }
         }
-        if ( strlen( spec_cache->specColl.resource ) == 0 ) {
-            rstrcpy( spec_cache->specColl.resource,  _spec_coll->resource, NAME_LEN );
+        else {
+            // =-=-=-=-=-=-=-
+            // special collection is local to this server ??
+            PluginStructFileDesc[ _struct_desc_index ].specColl =  _spec_coll;
         }
-    }
-    else {
-        // =-=-=-=-=-=-=-
-        // special collection is local to this server ??
-        PluginStructFileDesc[ _struct_desc_index ].specColl =  _spec_coll;
-    }
 
-    // =-=-=-=-=-=-=-
-    // cache pointer to comm struct
-    PluginStructFileDesc[ _struct_desc_index ].rsComm = _comm;
+        // =-=-=-=-=-=-=-
+        // cache pointer to comm struct
+        PluginStructFileDesc[ _struct_desc_index ].rsComm = _comm;
+    } // if !matched
 
     // =-=-=-=-=-=-=-
     // resolve the child resource by name
@@ -696,7 +785,9 @@ irods::error tar_struct_file_open(
         msg << _spec_coll->resource;
         msg << "], status: ";
         msg << resc_err.code();
-        free_struct_file_desc( _struct_desc_index );
+        if ( !matched ) {
+            free_struct_file_desc( _struct_desc_index );
+        }
         return PASSMSG( msg.str(), resc_err );
     }
 
@@ -723,10 +814,14 @@ irods::error tar_struct_file_open(
 
     // =-=-=-=-=-=-=-
     // stage the tar file so we can get at its tasty innards
-    irods::error stage_err = stage_tar_struct_file( _struct_desc_index, _resc_host );
-    if ( !stage_err.ok() ) {
-        free_struct_file_desc( _struct_desc_index );
-        return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+    if ( _stage ) {
+        irods::error stage_err = stage_tar_struct_file( _struct_desc_index, _resc_host );
+        if ( !stage_err.ok() ) {
+            if ( !matched ) {
+                free_struct_file_desc( _struct_desc_index );
+            }
+            return PASSMSG( "stage_tar_struct_file failed.", stage_err );
+        }
     }
 
     // =-=-=-=-=-=-=-
@@ -796,6 +891,461 @@ int free_tar_sub_file_desc( int _idx ) {
     return 0;
 }
 
+// =-=-=-=-=-=-=-
+// the physical path of the member index stored next to the tar file
+std::string member_index_physical_path( const specColl_t* _spec_coll ) {
+    return std::string( _spec_coll->phyPath ) + "." + MEMBER_INDEX_STR;
+
+} // member_index_physical_path
+
+// =-=-=-=-=-=-=-
+// the path of the member index may also be the physical path of a data
+// object, whose file must never be read, written or removed as an index.
+// returns 0 when no data object is registered at the path
+int check_member_index_path( int _index ) {
+    specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+    const int status = chkOrphanFile( PluginStructFileDesc[ _index ].rsComm,
+                                      member_index_physical_path( spec_coll ).c_str(),
+                                      spec_coll->rescHier, NULL );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    return 1 == status ? 0 : CATALOG_ALREADY_HAS_ITEM_BY_THAT_NAME;
+
+} // check_member_index_path
+
+// =-=-=-=-=-=-=-
+// open a file of the struct file via irods api. returns the fd
+int open_struct_file_path( rsComm_t*          _comm,
+                           specColl_t*        _spec_coll,
+                           const std::string& _path,
+                           const std::string& _host,
+                           int                _flags ) {
+    fileOpenInp_t f_inp;
+    memset( &f_inp, 0, sizeof( f_inp ) );
+    rstrcpy( f_inp.resc_name_,    _spec_coll->resource, MAX_NAME_LEN );
+    rstrcpy( f_inp.resc_hier_,    _spec_coll->rescHier, MAX_NAME_LEN );
+    rstrcpy( f_inp.objPath,       _spec_coll->objPath,  MAX_NAME_LEN );
+    rstrcpy( f_inp.addr.hostAddr, _host.c_str(),        NAME_LEN );
+    rstrcpy( f_inp.fileName,      _path.c_str(),        MAX_NAME_LEN );
+    f_inp.mode       = getDefFileMode();
+    f_inp.flags      = _flags;
+    f_inp.otherFlags = NO_CHK_PERM_FLAG;
+    return rsFileOpen( _comm, &f_inp );
+
+} // open_struct_file_path
+
+int close_struct_file_path( rsComm_t* _comm, int _fd ) {
+    fileCloseInp_t fileCloseInp;
+    memset( &fileCloseInp, 0, sizeof( fileCloseInp ) );
+    fileCloseInp.fileInx = _fd;
+    return rsFileClose( _comm, &fileCloseInp );
+
+} // close_struct_file_path
+
+// =-=-=-=-=-=-=-
+// move the position of an open file via irods api
+int seek_struct_file_path( rsComm_t* _comm, int _fd, rodsLong_t _offset ) {
+    fileLseekInp_t fileLseekInp;
+    memset( &fileLseekInp, 0, sizeof( fileLseekInp ) );
+    fileLseekInp.fileInx = _fd;
+    fileLseekInp.offset  = _offset;
+    fileLseekInp.whence  = SEEK_SET;
+
+    fileLseekOut_t* fileLseekOut = NULL;
+    int status = rsFileLseek( _comm, &fileLseekInp, &fileLseekOut );
+    free( fileLseekOut );
+    return status;
+
+} // seek_struct_file_path
+
+// =-=-=-=-=-=-=-
+// read up to _len bytes at _offset of an open file via irods api.
+// returns the number of bytes read, which is short only at the end
+// of the file
+rodsLong_t read_struct_file_path( rsComm_t*  _comm,
+                                  int        _fd,
+                                  rodsLong_t _offset,
+                                  void*      _buf,
+                                  rodsLong_t _len ) {
+    int status = seek_struct_file_path( _comm, _fd, _offset );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    rodsLong_t total = 0;
+    while ( total < _len ) {
+        fileReadInp_t fileReadInp;
+        bytesBuf_t    fileReadOutBBuf;
+        memset( &fileReadInp, 0, sizeof( fileReadInp ) );
+        memset( &fileReadOutBBuf, 0, sizeof( fileReadOutBBuf ) );
+        fileReadInp.fileInx = _fd;
+        fileReadInp.len     = static_cast< int >( std::min< rodsLong_t >( _len - total, 1024 * 1024 ) );
+        fileReadOutBBuf.buf = static_cast< char* >( _buf ) + total;
+
+        status = rsFileRead( _comm, &fileReadInp, &fileReadOutBBuf );
+        if ( status < 0 ) {
+            return status;
+        }
+
+        if ( status == 0 ) {
+            break;
+        }
+
+        total += status;
+    }
+
+    return total;
+
+} // read_struct_file_path
+
+// =-=-=-=-=-=-=-
+// read the member index stored next to the tar file
+irods::error read_member_index_file( int _index, const std::string& _host, std::string& _data ) {
+    rsComm_t*   comm      = PluginStructFileDesc[ _index ].rsComm;
+    specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+    int fd = open_struct_file_path( comm, spec_coll, member_index_physical_path( spec_coll ), _host, O_RDONLY );
+    if ( fd < 0 ) {
+        return ERROR( fd, "read_member_index_file - failed to open the member index" );
+    }
+
+    std::vector< char > buf( 1024 * 1024 );
+    rodsLong_t offset = 0;
+    while ( true ) {
+        rodsLong_t status = read_struct_file_path( comm, fd, offset, buf.data(), buf.size() );
+        if ( status < 0 ) {
+            close_struct_file_path( comm, fd );
+            return ERROR( status, "read_member_index_file - failed to read the member index" );
+        }
+
+        _data.append( buf.data(), status );
+        offset += status;
+
+        if ( status < static_cast< rodsLong_t >( buf.size() ) ) {
+            break;
+        }
+    }
+
+    close_struct_file_path( comm, fd );
+
+    return SUCCESS();
+
+} // read_member_index_file
+
+// =-=-=-=-=-=-=-
+// store the member index next to the tar file
+irods::error write_member_index_file( int _index, const std::string& _host, const std::string& _data ) {
+    rsComm_t*   comm      = PluginStructFileDesc[ _index ].rsComm;
+    specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+    // =-=-=-=-=-=-=-
+    // an existing file is only replaced by the caller once it is known to be
+    // a member index
+    int fd = open_struct_file_path( comm, spec_coll, member_index_physical_path( spec_coll ), _host,
+                                    O_WRONLY | O_CREAT | O_EXCL );
+    if ( fd < 0 ) {
+        return ERROR( fd, "write_member_index_file - failed to create the member index" );
+    }
+
+    std::size_t offset = 0;
+    while ( offset < _data.size() ) {
+        const int len = static_cast< int >( std::min< std::size_t >( _data.size() - offset, 1024 * 1024 ) );
+
+        fileWriteInp_t fileWriteInp;
+        memset( &fileWriteInp, 0, sizeof( fileWriteInp ) );
+        fileWriteInp.fileInx = fd;
+        fileWriteInp.len     = len;
+
+        bytesBuf_t write_buf;
+        write_buf.buf = const_cast< char* >( _data.data() + offset );
+        write_buf.len = len;
+
+        int status = rsFileWrite( comm, &fileWriteInp, &write_buf );
+        if ( status <= 0 ) {
+            close_struct_file_path( comm, fd );
+            return ERROR( status < 0 ? status : SYS_COPY_LEN_ERR,
+                          "write_member_index_file - failed to write the member index" );
+        }
+
+        offset += status;
+    }
+
+    int status = close_struct_file_path( comm, fd );
+    if ( status < 0 ) {
+        return ERROR( status, "write_member_index_file - failed to close the member index" );
+    }
+
+    return SUCCESS();
+
+} // write_member_index_file
+
+// =-=-=-=-=-=-=-
+// remove the member index stored next to the tar file. a file at the path
+// of the index which is not one is left alone
+int remove_member_index_file( int _index, const std::string& _host ) {
+    specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+    int status = check_member_index_path( _index );
+    if ( status < 0 ) {
+        return status;
+    }
+
+    std::string data;
+    irods::error read_err = read_member_index_file( _index, _host, data );
+    if ( !read_err.ok() ) {
+        return read_err.code();
+    }
+
+    if ( !irods::experimental::tar::member_index::is_serialized( data ) ) {
+        return SYS_INVALID_FILE_PATH;
+    }
+
+    fileUnlinkInp_t fileUnlinkInp;
+    memset( &fileUnlinkInp, 0, sizeof( fileUnlinkInp ) );
+    snprintf( fileUnlinkInp.fileName,      MAX_NAME_LEN, "%s", member_index_physical_path( spec_coll ).c_str() );
+    snprintf( fileUnlinkInp.addr.hostAddr, NAME_LEN,     "%s", _host.c_str() );
+    snprintf( fileUnlinkInp.rescHier,      MAX_NAME_LEN, "%s", spec_coll->rescHier );
+    snprintf( fileUnlinkInp.objPath,       MAX_NAME_LEN, "%s", spec_coll->objPath );
+    return rsFileUnlink( PluginStructFileDesc[ _index ].rsComm, &fileUnlinkInp );
+
+} // remove_member_index_file
+
+// =-=-=-=-=-=-=-
+// load the member index of an uncompressed tar file into
+// PluginStructFileIndex. the index stored next to the tar file is
+// used if it describes the current tar file, otherwise the headers
+// of the tar file are read and the index is stored for next time
+irods::error load_member_index( int _index, const std::string& _host ) {
+    namespace tar = irods::experimental::tar;
+
+    if ( PluginStructFileIndex[ _index ] ) {
+        return SUCCESS();
+    }
+
+    rsComm_t*   comm      = PluginStructFileDesc[ _index ].rsComm;
+    specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+    if ( !comm || !spec_coll ) {
+        return ERROR( SYS_INTERNAL_NULL_INPUT_ERR, "load_member_index - null comm or spec coll" );
+    }
+
+    // =-=-=-=-=-=-=-
+    // the size and modification time identify the version of the tar file
+    fileStatInp_t file_stat_inp;
+    memset( &file_stat_inp, 0, sizeof( file_stat_inp ) );
+    rstrcpy( file_stat_inp.fileName, spec_coll->phyPath, MAX_NAME_LEN );
+    snprintf( file_stat_inp.addr.hostAddr,  NAME_LEN,     "%s", _host.c_str() );
+    snprintf( file_stat_inp.rescHier,       MAX_NAME_LEN, "%s", spec_coll->rescHier );
+    snprintf( file_stat_inp.objPath,        MAX_NAME_LEN, "%s", spec_coll->objPath );
+
+    rodsStat_t* file_stat_out = NULL;
+    int status = rsFileStat( comm, &file_stat_inp, &file_stat_out );
+    if ( status < 0 || NULL == file_stat_out ) {
+        std::stringstream msg;
+        msg << "load_member_index - failed on call to rsFileStat for [";
+        msg << spec_coll->phyPath;
+        msg << "]";
+        return ERROR( status, msg.str() );
+    }
+
+    const rodsLong_t archive_size  = file_stat_out->st_size;
+    const rodsLong_t archive_mtime = file_stat_out->st_mtim;
+    free( file_stat_out );
+
+    // =-=-=-=-=-=-=-
+    // the index is neither read nor stored where a data object is registered
+    const int path_status = check_member_index_path( _index );
+
+    std::string data;
+    if ( 0 == path_status && read_member_index_file( _index, _host, data ).ok() ) {
+        PluginStructFileIndex[ _index ] = tar::member_index::deserialize( data, archive_size, archive_mtime );
+        if ( PluginStructFileIndex[ _index ] ) {
+            return SUCCESS();
+        }
+    }
+
+    // =-=-=-=-=-=-=-
+    // index the tar file, reading only the headers of its members
+    int fd = open_struct_file_path( comm, spec_coll, spec_coll->phyPath, _host, O_RDONLY );
+    if ( fd < 0 ) {
+        std::stringstream msg;
+        msg << "load_member_index - failed to open [";
+        msg << spec_coll->phyPath;
+        msg << "]";
+        return ERROR( fd, msg.str() );
+    }
+
+    try {
+        PluginStructFileIndex[ _index ] = tar::member_index::build(
+            [comm, fd]( std::int64_t _offset, void* _buf, std::int64_t _size ) {
+                return read_struct_file_path( comm, fd, _offset, _buf, _size );
+            } );
+    }
+    catch ( const irods::exception& e ) {
+        close_struct_file_path( comm, fd );
+        return irods::error( e );
+    }
+
+    close_struct_file_path( comm, fd );
+
+    if ( !PluginStructFileIndex[ _index ] ) {
+        std::stringstream msg;
+        msg << "load_member_index - [";
+        msg << spec_coll->phyPath;
+        msg << "] is not an uncompressed tar file";
+        return ERROR( SYS_TAR_STRUCT_FILE_EXTRACT_ERR, msg.str() );
+    }
+
+    // =-=-=-=-=-=-=-
+    // the index is only a shortcut, so failing to store it is not an error
+    if ( 0 != path_status ) {
+        rodsLog( LOG_DEBUG, "load_member_index - not storing the member index of [%s], status = %d",
+                 spec_coll->phyPath, path_status );
+        return SUCCESS();
+    }
+
+    // =-=-=-=-=-=-=-
+    // an index of an older version of the tar file is replaced
+    if ( tar::member_index::is_serialized( data ) ) {
+        remove_member_index_file( _index, _host );
+    }
+
+    irods::error write_err = write_member_index_file(
+                                 _index, _host, PluginStructFileIndex[ _index ]->serialize( archive_size, archive_mtime ) );
+    if ( !write_err.ok() ) {
+        rodsLog( LOG_NOTICE, "load_member_index - failed to store the member index of [%s], status = %d",
+                 spec_coll->phyPath, write_err.code() );
+    }
+
+    return SUCCESS();
+
+} // load_member_index
+
+// =-=-=-=-=-=-=-
+// find the member of the tar file at a sub file path
+irods::error find_tar_member( int                                      _index,
+                              const std::string&                       _sub_file_path,
+                              const irods::experimental::tar::member*& _member ) {
+    specColl_t* spec_coll = PluginStructFileDesc[ _index ].specColl;
+
+    // =-=-=-=-=-=-=-
+    // subFilePath is composed by appending the path of the member to the
+    // collection of the struct file
+    const std::size_t len = strlen( spec_coll->collection );
+    if ( _sub_file_path.compare( 0, len, spec_coll->collection ) != 0 ||
+            _sub_file_path.size() <= len + 1 ||
+            _sub_file_path[ len ] != '/' ) {
+        std::stringstream msg;
+        msg << "find_tar_member - collection [";
+        msg << spec_coll->collection;
+        msg << "] sub file path [";
+        msg << _sub_file_path;
+        msg << "] mismatch";
+        return ERROR( SYS_STRUCT_FILE_PATH_ERR, msg.str() );
+    }
+
+    _member = PluginStructFileIndex[ _index ]->find( std::string_view( _sub_file_path ).substr( len + 1 ) );
+    if ( !_member ) {
+        std::stringstream msg;
+        msg << "find_tar_member - [";
+        msg << _sub_file_path;
+        msg << "] is not in the member index";
+        return ERROR( SYS_STRUCT_FILE_PATH_ERR, msg.str() );
+    }
+
+    return SUCCESS();
+
+} // find_tar_member
+
+// =-=-=-=-=-=-=-
+// open a regular member of a tar file which has not been staged for
+// reading in place
+irods::error open_tar_member_in_place( irods::structured_object_ptr _fco,
+                                       int                          _struct_file_index,
+                                       const std::string&           _host ) {
+    irods::error index_err = load_member_index( _struct_file_index, _host );
+    if ( !index_err.ok() ) {
+        return PASSMSG( "open_tar_member_in_place - load_member_index failed.", index_err );
+    }
+
+    const irods::experimental::tar::member* member = nullptr;
+    irods::error find_err = find_tar_member( _struct_file_index, _fco->sub_file_path(), member );
+    if ( !find_err.ok() ) {
+        return PASSMSG( "open_tar_member_in_place - find_tar_member failed.", find_err );
+    }
+
+    if ( !member->is_regular_file() ) {
+        return ERROR( SYS_STRUCT_FILE_PATH_ERR, "open_tar_member_in_place - member is not a regular file" );
+    }
+
+    int sub_index = alloc_tar_sub_file_desc();
+    if ( sub_index < 0 ) {
+        return ERROR( sub_index, "open_tar_member_in_place - alloc_tar_sub_file_desc failed." );
+    }
+
+    rsComm_t*   comm      = _fco->comm();
+    specColl_t* spec_coll = PluginStructFileDesc[ _struct_file_index ].specColl;
+
+    int fd = open_struct_file_path( comm, spec_coll, spec_coll->phyPath, _host, O_RDONLY );
+    if ( fd < 0 ) {
+        free_tar_sub_file_desc( sub_index );
+        return ERROR( fd, "open_tar_member_in_place - failed to open the tar file" );
+    }
+
+    int status = seek_struct_file_path( comm, fd, member->offset );
+    if ( status < 0 ) {
+        close_struct_file_path( comm, fd );
+        free_tar_sub_file_desc( sub_index );
+        return ERROR( status, "open_tar_member_in_place - failed to seek to the member" );
+    }
+
+    tarSubFileDesc_t& desc = PluginTarSubFileDesc[ sub_index ];
+    desc.structFileInx = _struct_file_index;
+    desc.fd            = fd;
+    desc.inPlace       = 1;
+    desc.memberOffset  = member->offset;
+    desc.memberSize    = member->size;
+    desc.position      = 0;
+
+    PluginStructFileDesc[ _struct_file_index ].openCnt++;
+    _fco->file_descriptor( sub_index );
+
+    return CODE( sub_index );
+
+} // open_tar_member_in_place
+
+// =-=-=-=-=-=-=-
+// stat a member of a tar file which has not been staged from its
+// member index
+irods::error stat_tar_member( irods::structured_object_ptr _fco,
+                              int                          _struct_file_index,
+                              const std::string&           _host,
+                              struct stat*                 _statbuf ) {
+    irods::error index_err = load_member_index( _struct_file_index, _host );
+    if ( !index_err.ok() ) {
+        return PASSMSG( "stat_tar_member - load_member_index failed.", index_err );
+    }
+
+    const irods::experimental::tar::member* member = nullptr;
+    irods::error find_err = find_tar_member( _struct_file_index, _fco->sub_file_path(), member );
+    if ( !find_err.ok() ) {
+        return PASSMSG( "stat_tar_member - find_tar_member failed.", find_err );
+    }
+
+    memset( _statbuf, 0, sizeof( struct stat ) );
+    _statbuf->st_size  = member->size;
+    _statbuf->st_mode  = ( member->mode & 07777 ) | ( member->is_directory() ? S_IFDIR : S_IFREG );
+    _statbuf->st_nlink = 1;
+    _statbuf->st_mtime = member->mtime;
+    _statbuf->st_atime = member->mtime;
+    _statbuf->st_ctime = member->mtime;
+
+    return CODE( 0 );
+
+} // stat_tar_member
+
 // =-=-=-=-=-=-=-
 // interface for POSIX create
 irods::error tar_file_create(
@@ -927,11 +1477,13 @@ irods::error tar_file_open(
     }
 
     // =-=-=-=-=-=-=-
-    // open and stage the tar file, get its index
+    // open the tar file, get its index. a member opened for reading is
+    // read in place if the tar file is not staged already
+    const bool read_only = ( fco->flags() & O_ACCMODE ) == O_RDONLY;
     int struct_file_index = 0;
     std::string resc_host;
     irods::error open_err =  tar_struct_file_open( comm, spec_coll, struct_file_index,
-                             fco->resc_hier(), resc_host );
+                             fco->resc_hier(), resc_host, !read_only );
     if ( !open_err.ok() ) {
         std::stringstream msg;
         msg << "tar_struct_file_open error for [";
@@ -943,6 +1495,24 @@ irods::error tar_file_open(
     // use the cached specColl. specColl may have changed
     spec_coll = PluginStructFileDesc[ struct_file_index ].specColl;
 
+    if ( strlen( spec_coll->cacheDir ) == 0 ) {
+        irods::error in_place_err = open_tar_member_in_place( fco, struct_file_index, resc_host );
+        if ( in_place_err.ok() ) {
+            return in_place_err;
+        }
+
+        // =-=-=-=-=-=-=-
+        // compressed tar files, zip files and members which are not regular
+        // files are served from the cache dir
+        rodsLog( LOG_DEBUG, "tar_file_open_plugin - staging [%s]: %s",
+                 spec_coll->objPath, in_place_err.result().c_str() );
+
+        irods::error stage_err = stage_tar_struct_file( struct_file_index, resc_host );
+        if ( !stage_err.ok() ) {
+            return PASSMSG( "tar_file_open_plugin - stage_tar_struct_file failed.", stage_err );
+        }
+    }
+
     // =-=-=-=-=-=-=-
     // allocate yet another index into another table
     int sub_index = alloc_tar_sub_file_desc();
@@ -1023,14 +1593,25 @@ irods::error tar_file_read(
         return ERROR( SYS_STRUCT_FILE_DESC_ERR, msg.str() );
     }
 
+    // =-=-=-=-=-=-=-
+    // a member read in place ends where the next header of the tar file begins
+    tarSubFileDesc_t& desc = PluginTarSubFileDesc[ fco->file_descriptor() ];
+    int len = _len;
+    if ( desc.inPlace ) {
+        len = static_cast< int >( std::max< rodsLong_t >( 0, std::min< rodsLong_t >( _len, desc.memberSize - desc.position ) ) );
+        if ( len == 0 ) {
+            return CODE( 0 );
+        }
+    }
+
     // =-=-=-=-=-=-=-
     // build a read structure and make the rs call
     fileReadInp_t fileReadInp;
     bytesBuf_t fileReadOutBBuf;
     memset( &fileReadInp, 0, sizeof( fileReadInp ) );
     memset( &fileReadOutBBuf, 0, sizeof( fileReadOutBBuf ) );
-    fileReadInp.fileInx = PluginTarSubFileDesc[ fco->file_descriptor() ].fd;
-    fileReadInp.len     = _len;
+    fileReadInp.fileInx = desc.fd;
+    fileReadInp.len     = len;
     fileReadOutBBuf.buf = _buf;
 
     // =-=-=-=-=-=-=-
@@ -1040,6 +1621,7 @@ irods::error tar_file_read(
         return ERROR( status, "rsFileRead failed" );
     }
     else {
+        desc.position += status;
         return CODE( status );
     }
 
@@ -1074,6 +1656,10 @@ irods::error tar_file_write(
         return ERROR( SYS_STRUCT_FILE_DESC_ERR, msg.str() );
     }
 
+    if ( PluginTarSubFileDesc[ fco->file_descriptor() ].inPlace ) {
+        return ERROR( SYS_INVALID_OPR_TYPE, "tar_file_write_plugin - sub file is open for reading only" );
+    }
+
     // =-=-=-=-=-=-=-
     // build a write structure and make the rs call
     const fileWriteInp_t fileWriteInp{
@@ -1277,11 +1863,11 @@ irods::error tar_file_stat(
     }
 
     // =-=-=-=-=-=-=-
-    // open and stage the tar file, get its index
+    // open the tar file, get its index
     int struct_file_index = 0;
     std::string resc_host;
     irods::error open_err =  tar_struct_file_open( comm, spec_coll, struct_file_index,
-                             fco->resc_hier(), resc_host );
+                             fco->resc_hier(), resc_host, false );
     if ( !open_err.ok() ) {
         std::stringstream msg;
         msg << "tar_file_stat_plugin - tar_struct_file_open error for [";
@@ -1293,6 +1879,20 @@ irods::error tar_file_stat(
     // use the cached specColl. specColl may have changed
     spec_coll = PluginStructFileDesc[ struct_file_index ].specColl;
 
+    // =-=-=-=-=-=-=-
+    // stat the member from the member index if the tar file is not staged
+    if ( strlen( spec_coll->cacheDir ) == 0 ) {
+        irods::error index_err = stat_tar_member( fco, struct_file_index, resc_host, _statbuf );
+        if ( index_err.ok() ) {
+            return index_err;
+        }
+
+        irods::error stage_err = stage_tar_struct_file( struct_file_index, resc_host );
+        if ( !stage_err.ok() ) {
+            return PASSMSG( "tar_file_stat_plugin - stage_tar_struct_file failed.", stage_err );
+        }
+    }
+
 
     // =-=-=-=-=-=-=-
     // build a file stat structure to pass off to the server api call
@@ -1364,11 +1964,43 @@ irods::error tar_file_lseek(
         return ERROR( -1, "tar_file_lseek_plugin - null comm pointer in structure_object" );
     }
 
+    // =-=-=-=-=-=-=-
+    // a member read in place is positioned relative to its start
+    tarSubFileDesc_t& desc = PluginTarSubFileDesc[ fco->file_descriptor() ];
+    if ( desc.inPlace ) {
+        rodsLong_t position = 0;
+        switch ( _whence ) {
+            case SEEK_SET:
+                position = _offset;
+                break;
+            case SEEK_CUR:
+                position = desc.position + _offset;
+                break;
+            case SEEK_END:
+                position = desc.memberSize + _offset;
+                break;
+            default:
+                return ERROR( UNIX_FILE_LSEEK_ERR - EINVAL, "tar_file_lseek_plugin - invalid whence" );
+        }
+
+        if ( position < 0 ) {
+            return ERROR( UNIX_FILE_LSEEK_ERR - EINVAL, "tar_file_lseek_plugin - negative offset" );
+        }
+
+        int status = seek_struct_file_path( comm, desc.fd, desc.memberOffset + position );
+        if ( status < 0 ) {
+            return ERROR( status, "rsFileLseek failed" );
+        }
+
+        desc.position = position;
+        return CODE( position );
+    }
+
     // =-=-=-=-=-=-=-
     // build a lseek structure and make the rs call
     fileLseekInp_t fileLseekInp;
     memset( &fileLseekInp, 0, sizeof( fileLseekInp ) );
-    fileLseekInp.fileInx = PluginTarSubFileDesc[ fco->file_descriptor() ].fd;
+    fileLseekInp.fileInx = desc.fd;
     fileLseekInp.offset  = _offset;
     fileLseekInp.whence  = _whence;
 
@@ -2043,23 +2675,182 @@ irods::error tar_file_extract(
 
 } // tar_file_extract_plugin
 
+// =-=-=-=-=-=-=-
+// a member of a bundle read ahead of the archive writer
+struct prefetched_member {
+    int                 error_;     // errno of a failed open or read
+    bool                in_memory_; // data_ holds the whole file
+    rodsLong_t          size_;
+    std::time_t         mtime_;
+    std::vector< char > data_;
+};
+
+// =-=-=-=-=-=-=-
+// files up to this size are read whole by the prefetcher, larger ones
+// are streamed by the archive writer
+const rodsLong_t MAX_PREFETCH_FILE_SIZE = 4 * 1024 * 1024;
+
+// =-=-=-=-=-=-=-
+// read a member of a bundle, or prepare the kernel for its reading
+prefetched_member prefetch_member( const boost::filesystem::path& _path ) {
+    prefetched_member member{};
+
+    int fd = open( _path.c_str(), O_RDONLY );
+    if ( -1 == fd ) {
+        member.error_ = errno;
+        return member;
+    }
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 ) {
+        member.error_ = errno;
+        close( fd );
+        return member;
+    }
+
+    member.size_  = st.st_size;
+    member.mtime_ = st.st_mtime;
+
+    if ( member.size_ > MAX_PREFETCH_FILE_SIZE ) {
+        posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+        close( fd );
+        return member;
+    }
+
+    member.data_.resize( member.size_ );
+    rodsLong_t offset = 0;
+    while ( offset < member.size_ ) {
+        ssize_t len = read( fd, member.data_.data() + offset, member.size_ - offset );
+        if ( len < 0 ) {
+            member.error_ = errno;
+            close( fd );
+            return member;
+        }
+
+        if ( len == 0 ) {
+            break;
+        }
+
+        offset += len;
+    }
+
+    // =-=-=-=-=-=-=-
+    // a file which shrank is archived with the size it has now
+    member.data_.resize( offset );
+    member.size_      = offset;
+    member.in_memory_ = true;
+    close( fd );
+
+    return member;
+
+} // prefetch_member
+
+// =-=-=-=-=-=-=-
+// reads the members of a bundle on a thread pool ahead of the archive
+// writer, so that the latency of opening and reading many small files
+// overlaps with the writing and compression of the archive
+class member_prefetcher {
+    public:
+        member_prefetcher(
+            const std::vector< boost::filesystem::path >& _listing,
+            int                                           _threads ) :
+            listing_( _listing ),
+            futures_( _listing.size() ),
+            window_( 4 * std::max( _threads, 1 ) ),
+            next_( 0 ),
+            pool_( std::max( _threads, 1 ) ) {
+        } // ctor
+
+        ~member_prefetcher() {
+            pool_.stop();
+            pool_.join();
+        } // dtor
+
+        // =-=-=-=-=-=-=-
+        // wait for member _index. members are taken in order
+        prefetched_member get( std::size_t _index ) {
+            for ( ; next_ < listing_.size() && next_ < _index + window_; ++next_ ) {
+                auto promise = std::make_shared< std::promise< prefetched_member > >();
+                futures_[ next_ ] = promise->get_future();
+
+                irods::thread_pool::post( pool_, [promise, path = listing_[ next_ ]] {
+                    promise->set_value( prefetch_member( path ) );
+                } );
+            }
+
+            return futures_[ _index ].get();
+        } // get
+
+    private:
+        const std::vector< boost::filesystem::path >&   listing_;
+        std::vector< std::future< prefetched_member > > futures_;
+        std::size_t                                     window_;
+        std::size_t                                     next_;
+        irods::thread_pool                              pool_;
+
+}; // class member_prefetcher
+
+// =-=-=-=-=-=-=-
+// the number of threads which read and compress the members of a bundle
+int get_bundle_thread_count() {
+    try {
+        return std::max( 1, irods::get_advanced_setting< const int >( irods::CFG_NUMBER_OF_BUNDLE_THREADS ) );
+    }
+    catch ( const irods::exception& ) {
+        return std::clamp( static_cast< int >( std::thread::hardware_concurrency() ), 1, 4 );
+    }
+
+} // get_bundle_thread_count
+
 // =-=-=-=-=-=-=-
 // helper function to write an archive entry
 irods::error write_file_to_archive( const boost::filesystem::path _path,
                                     const std::string&            _cache_dir,
+                                    prefetched_member&            _member,
                                     struct archive*               _archive ) {
-    namespace fs = boost::filesystem;
+    std::string path_name  = _path.string();
+
+    if ( _member.error_ ) {
+        std::stringstream msg;
+        msg << "write_file_to_archive - failed to read file [";
+        msg << path_name;
+        msg << "] with error [";
+        msg << strerror( _member.error_ );
+        msg << "]";
+        return ERROR( UNIX_FILE_READ_ERR - _member.error_, msg.str() );
+    }
+
+    // =-=-=-=-=-=-=-
+    // JMC :: i didnt use ifstream as readsome() garbled the file
+    //     :: some reason.  revisit this for windows
+    // =-=-=-=-=-=-=-
+    // open a file which is too large to have been read ahead
+    int fd = -1;
+    if ( !_member.in_memory_ ) {
+        fd = open( path_name.c_str(), O_RDONLY );
+        if ( -1 == fd )  {
+            std::stringstream msg;
+            msg << "write_file_to_archive - failed to open file for read [";
+            msg << path_name;
+            msg << "] with error [";
+            msg << strerror( errno );
+            msg << "]";
+            return ERROR( -1, msg.str() );
+        }
+
+        posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+    }
+
     struct archive_entry* entry = archive_entry_new();
 
     // =-=-=-=-=-=-=-
     // strip arch path from file name for header entry
-    std::string path_name  = _path.string();
     std::string strip_file = path_name.substr( _cache_dir.size() + 1 ); // add one for the last '/'
     archive_entry_set_pathname( entry, strip_file.c_str() );
 
     // =-=-=-=-=-=-=-
-    // ask for the file size
-    archive_entry_set_size( entry, fs::file_size( _path ) );
+    // set the size as read by the prefetcher
+    archive_entry_set_size( entry, _member.size_ );
     archive_entry_set_filetype( entry, AE_IFREG );
 
     // =-=-=-=-=-=-=-
@@ -2070,8 +2861,7 @@ irods::error write_file_to_archive( const boost::filesystem::path _path,
 
     // =-=-=-=-=-=-=-
     // set the time for the file
-    std::time_t tt = last_write_time( _path );
-    archive_entry_set_mtime( entry, tt, 0 );
+    archive_entry_set_mtime( entry, _member.mtime_, 0 );
 
     // =-=-=-=-=-=-=-
     // write out the header to the archive
@@ -2082,39 +2872,44 @@ irods::error write_file_to_archive( const boost::filesystem::path _path,
         msg << "] with error string [";
         msg << archive_error_string( _archive );
         msg << "]";
+        archive_entry_free( entry );
+        if ( -1 != fd ) {
+            close( fd );
+        }
         return ERROR( -1, msg.str() );
     }
 
+    archive_entry_free( entry );
+
     // =-=-=-=-=-=-=-
-    // JMC :: i didnt use ifstream as readsome() garbled the file
-    //     :: some reason.  revisit this for windows
-    // =-=-=-=-=-=-=-
-    // open the file in question
-    int fd = open( path_name.c_str(), O_RDONLY );
-    if ( -1 == fd )  {
+    // add the file to the archive
+    la_ssize_t status = 0;
+    if ( _member.in_memory_ ) {
+        if ( !_member.data_.empty() ) {
+            status = archive_write_data( _archive, _member.data_.data(), _member.data_.size() );
+        }
+    }
+    else {
+        std::vector< char > buff( 1024 * 1024 );
+        ssize_t len = read( fd, buff.data(), buff.size() );
+        while ( len > 0 && status >= 0 ) {
+            status = archive_write_data( _archive, buff.data(), len );
+            len = read( fd, buff.data(), buff.size() );
+        }
+
+        close( fd );
+    }
+
+    if ( status < 0 ) {
         std::stringstream msg;
-        msg << "write_file_to_archive - failed to open file for read [";
+        msg << "write_file_to_archive - failed to write data for [";
         msg << path_name;
-        msg << "] with error [";
-        msg << strerror( errno );
+        msg << "] with error string [";
+        msg << archive_error_string( _archive );
         msg << "]";
         return ERROR( -1, msg.str() );
     }
 
-    // =-=-=-=-=-=-=-
-    // read in the file and add it to the archive
-    char buff[ 16384 ];
-    int len = read( fd, buff, sizeof( buff ) );
-    while ( len > 0 ) {
-        archive_write_data( _archive, buff, len );
-        len = read( fd, buff, sizeof( buff ) );
-    }
-
-    // =-=-=-=-=-=-=-
-    // clean up
-    close( fd );
-    archive_entry_free( entry );
-
     return SUCCESS();
 
 } // write_file_to_archive
@@ -2258,6 +3053,11 @@ irods::error bundle_cache_dir( int         _index,
 
     }
 
+    // =-=-=-=-=-=-=-
+    // the members are read and gzip compression is done on this many threads
+    const int thread_count = get_bundle_thread_count();
+    const bool parallel_gzip = _data_type == GZIP_TAR_DT_STR && thread_count > 1;
+
     // =-=-=-=-=-=-=-
     // set the compression flags given data_type
     if ( _data_type == ZIP_DT_STR ) {
@@ -2273,7 +3073,7 @@ irods::error bundle_cache_dir( int         _index,
         }
 
     }
-    else if ( _data_type == GZIP_TAR_DT_STR ) {
+    else if ( _data_type == GZIP_TAR_DT_STR && !parallel_gzip ) {
         if ( archive_write_add_filter_gzip( arch ) != ARCHIVE_OK ) {
             std::stringstream msg;
             msg << "bundle_cache_dir - failed to set compression to gzip for archive [";
@@ -2333,6 +3133,12 @@ irods::error bundle_cache_dir( int         _index,
         return PASSMSG( "bundle_cache_dir - failed in get_loc_for_hier_string", ret );
     }
 
+    // =-=-=-=-=-=-=-
+    // hand the archive to the callbacks in large blocks, each of which is
+    // an rsFileWrite, without padding the last one
+    archive_write_set_bytes_per_block( arch, 1024 * 1024 );
+    archive_write_set_bytes_in_last_block( arch, 1 );
+
     // =-=-=-=-=-=-=-
     // create a context to pass to the callbacks
     cb_ctx_t cb_ctx;
@@ -2340,14 +3146,28 @@ irods::error bundle_cache_dir( int         _index,
     cb_ctx.desc_ = &PluginStructFileDesc[ _index ];
     snprintf( cb_ctx.loc_, sizeof( cb_ctx.loc_ ), "%s", location.c_str() );
 
+    // =-=-=-=-=-=-=-
+    // compress the tar stream on several threads in place of the
+    // single threaded gzip filter of libarchive
+    std::optional< irods::experimental::gzip::parallel_writer > gzip;
+    if ( parallel_gzip ) {
+        gzip.emplace( [arch, &cb_ctx]( const void* _data, std::size_t _size ) {
+                          if ( irods_file_write( arch, &cb_ctx, _data, _size ) != static_cast< ssize_t >( _size ) ) {
+                              THROW( SYS_COPY_LEN_ERR, "bundle_cache_dir - failed to write the compressed archive" );
+                          }
+                      },
+                      thread_count );
+        cb_ctx.gzip_ = &*gzip;
+    }
+
     // =-=-=-=-=-=-=-
     // open the spec coll physical path for archival
     if ( archive_write_open(
                 arch,
                 &cb_ctx,
                 irods_file_open_for_write,
-                irods_file_write,
-                irods_file_close ) < ARCHIVE_OK ) {
+                parallel_gzip ? irods_file_write_gzip : irods_file_write,
+                parallel_gzip ? irods_file_close_gzip : irods_file_close ) < ARCHIVE_OK ) {
         std::stringstream msg;
         msg << "bundle_cache_dir - failed to open archive file [";
         msg << spec_coll->phyPath;
@@ -2358,13 +3178,16 @@ irods::error bundle_cache_dir( int         _index,
     }
 
     // =-=-=-=-=-=-=-
-    // iterate over the dir listing and archive the files
+    // iterate over the dir listing and archive the files. the files
+    // are read ahead on the thread pool of the prefetcher
     std::string cache_dir( spec_coll->cacheDir );
     irods::error arch_err = SUCCESS();
+    member_prefetcher prefetcher( listing, thread_count );
     for ( size_t i = 0; i < listing.size(); ++i ) {
         // =-=-=-=-=-=-=-
         // strip off archive path from the filename
-        irods::error ret = write_file_to_archive( listing[ i ].string(), cache_dir, arch );
+        prefetched_member member = prefetcher.get( i );
+        irods::error ret = write_file_to_archive( listing[ i ].string(), cache_dir, member, arch );
 
         if ( !ret.ok() ) {
             std::stringstream msg;
@@ -2378,8 +3201,17 @@ irods::error bundle_cache_dir( int         _index,
     } // for i
 
     // =-=-=-=-=-=-=-
-    // close the archive and clean up
-    archive_write_close( arch );
+    // close the archive and clean up. closing writes the rest of the
+    // archive, so it may fail as well
+    if ( archive_write_close( arch ) < ARCHIVE_WARN ) {
+        std::stringstream msg;
+        msg << "bundle_cache_dir - failed to close archive file [";
+        msg << spec_coll->phyPath;
+        msg << "] with error string [";
+        msg << archive_error_string( arch );
+        msg << "]";
+        arch_err = ERROR( -1, msg.str() );
+    }
     archive_write_free( arch );
 
     // =-=-=-=-=-=-=-
@@ -2417,6 +3249,22 @@ irods::error sync_cache_dir_to_tar_file( int         _index,
         return PASSMSG( "sync_cache_dir_to_tar_file - failed in bundle.", bundle_err );
     }
 
+    // =-=-=-=-=-=-=-
+    // the members have moved, so index the new tar file. the stored index is
+    // removed first since the new tar file may have the same size and
+    // modification time as the old one
+    PluginStructFileIndex[ _index ].reset();
+    remove_member_index_file( _index, _host );
+
+    const std::string data_type( PluginStructFileDesc[ _index ].dataType );
+    if ( data_type != ZIP_DT_STR && data_type != GZIP_TAR_DT_STR && data_type != BZIP2_TAR_DT_STR ) {
+        irods::error index_err = load_member_index( _index, _host );
+        if ( !index_err.ok() ) {
+            rodsLog( LOG_NOTICE, "sync_cache_dir_to_tar_file - failed to index [%s], status = %d",
+                     spec_coll->phyPath, index_err.code() );
+        }
+    }
+
     // =-=-=-=-=-=-=-
     // create a file stat structure for the rs call
     fileStatInp_t file_stat_inp;
@@ -2514,6 +3362,7 @@ irods::error tar_file_sync(
     // delete operation
     if ( ( fco->opr_type() & DELETE_STRUCT_FILE ) != 0 ) {
         /* remove cache and the struct file */
+        remove_member_index_file( struct_file_index, resc_host );
         free_struct_file_desc( struct_file_index );
         return SUCCESS();
     }
@@ -2582,6 +3431,13 @@ irods::error tar_file_sync(
 
     } // if we have a cache dir
 
+    // =-=-=-=-=-=-=-
+    // the collection is being unmounted, so its index is no longer needed
+    if ( ( fco->opr_type() & PURGE_STRUCT_FILE_CACHE ) != 0 ) {
+        PluginStructFileIndex[ struct_file_index ].reset();
+        remove_member_index_file( struct_file_index, resc_host );
+    }
+
     free_struct_file_desc( struct_file_index );
 
     return SUCCESS();
@@ -17,6 +17,8 @@
 #include "irods_resource_redirect.hpp"
 #include "irods_stacktrace.hpp"
 #include "irods_re_structs.hpp"
+#include "irods_kvp_string_parser.hpp"
+#include "coprocess.hpp"
 #include "voting.hpp"
 
 // =-=-=-=-=-=-=-
@@ -58,6 +60,96 @@ inline irods::error univ_mss_check_param(
 /// @brief token to index the script property
 const std::string SCRIPT_PROP( "script" );
 
+// =-=-=-=-=-=-=-
+/// @brief token to index the driver property.  the driver is a long-lived
+///        program in msiExecCmd_bin which serves the operations over the
+///        request/response protocol described in coprocess.hpp
+const std::string DRIVER_PROP( "driver" );
+
+// =-=-=-=-=-=-=-
+/// @brief true when the program is a single file name within msiExecCmd_bin.
+///        the driver is not run through rsExecCmd, so this is the only check
+///        of its path.
+bool is_exec_cmd_file_name( const std::string& _program ) {
+    return _program.find( '/' ) == std::string::npos &&
+           _program.find( ".." ) == std::string::npos;
+}
+
+/// =-=-=-=-=-=-=-
+/// @brief run an operation of the mss interface.  the operation is sent to
+///        the driver of the resource when one is configured, otherwise the
+///        script is executed through rsExecCmd.  the standard output of the
+///        operation is returned in _output, and its standard error in _error
+///        when the script is executed.
+int univ_mss_execute(
+    irods::plugin_context&          _ctx,
+    const std::string&              _operation,
+    const std::vector<std::string>& _args,
+    std::string*                    _output = nullptr,
+    std::string*                    _error = nullptr ) {
+    std::string driver;
+    if ( _ctx.prop_map().get< std::string >( DRIVER_PROP, driver ).ok() ) {
+        if ( !is_exec_cmd_file_name( driver ) ) {
+            rodsLog( LOG_ERROR, "univ_mss_execute - bad driver path [%s]", driver.c_str() );
+            errno = 0;
+            return BAD_EXEC_CMD_PATH;
+        }
+
+        try {
+            auto& cp = irods::get_coprocess( std::string( CMD_DIR ) + "/" + driver );
+            const auto response = cp.call( _operation, _args );
+            if ( _output ) {
+                *_output = response.output;
+            }
+            if ( 0 != response.status ) {
+                rodsLog( LOG_ERROR, "univ_mss_execute - [%s] failed with status [%d]: %s",
+                         _operation.c_str(), response.status, response.output.c_str() );
+                errno = 0;
+                return -1;
+            }
+            return 0;
+        }
+        catch ( const irods::exception& e ) {
+            irods::log( irods::error( e ) );
+            errno = 0;
+            return e.code();
+        }
+    }
+
+    std::string script;
+    irods::error err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
+    if ( !err.ok() ) {
+        irods::log( PASS( err ) );
+        return err.code();
+    }
+
+    std::string cmd_argv = _operation;
+    for ( const auto& arg : _args ) {
+        cmd_argv += " '" + arg + "'";
+    }
+
+    execCmd_t execCmdInp;
+    bzero( &execCmdInp, sizeof( execCmdInp ) );
+    snprintf( execCmdInp.cmd, sizeof( execCmdInp.cmd ), "%s", script.c_str() );
+    snprintf( execCmdInp.cmdArgv, sizeof( execCmdInp.cmdArgv ), "%s", cmd_argv.c_str() );
+    snprintf( execCmdInp.execAddr, sizeof( execCmdInp.execAddr ), "%s", "localhost" );
+
+    execCmdOut_t *execCmdOut = NULL;
+    const int status = _rsExecCmd( &execCmdInp, &execCmdOut );
+    if ( execCmdOut ) {
+        if ( _output && execCmdOut->stdoutBuf.buf ) {
+            _output->assign( static_cast<char*>( execCmdOut->stdoutBuf.buf ), execCmdOut->stdoutBuf.len );
+        }
+        if ( _error && execCmdOut->stderrBuf.buf ) {
+            _error->assign( static_cast<char*>( execCmdOut->stderrBuf.buf ), execCmdOut->stderrBuf.len );
+        }
+    }
+    freeCmdExecOut( execCmdOut );
+
+    return status;
+
+} // univ_mss_execute
+
 /// =-=-=-=-=-=-=-
 /// @brief interface for POSIX create
 irods::error univ_mss_file_create(
@@ -117,28 +209,12 @@ irods::error univ_mss_file_unlink(
 
     }
 
-    // =-=-=-=-=-=-=-
-    // get the script property
-    std::string script;
-    err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
-    if ( !err.ok() ) {
-        return PASSMSG( __FUNCTION__, err );
-    }
-
     // =-=-=-=-=-=-=-
     // snag a ref to the fco
     irods::data_object_ptr fco = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
     std::string filename = fco->physical_path();
 
-    execCmd_t execCmdInp;
-    memset( &execCmdInp, 0, sizeof( execCmdInp ) );
-    snprintf( execCmdInp.cmd, sizeof( execCmdInp.cmd ), "%s", script.c_str() );
-    snprintf( execCmdInp.cmdArgv, sizeof( execCmdInp.cmdArgv ), "rm '%s'", filename.c_str() );
-    snprintf( execCmdInp.execAddr, sizeof( execCmdInp.execAddr ), "localhost" );
-
-    execCmdOut_t *execCmdOut = NULL;
-    int status = _rsExecCmd( &execCmdInp, &execCmdOut );
-    freeCmdExecOut( execCmdOut );
+    int status = univ_mss_execute( _ctx, "rm", { filename } );
 
     if ( status < 0 ) {
         status = UNIV_MSS_UNLINK_ERR - errno;
@@ -169,14 +245,6 @@ irods::error univ_mss_file_stat(
 
     }
 
-    // =-=-=-=-=-=-=-
-    // get the script property
-    std::string script;
-    err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
-    if ( !err.ok() ) {
-        return PASSMSG( __FUNCTION__, err );
-    }
-
     // =-=-=-=-=-=-=-
     // snag a ref to the fco
     irods::data_object_ptr fco = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
@@ -184,25 +252,17 @@ irods::error univ_mss_file_stat(
 
 
     int i, status;
-    execCmd_t execCmdInp;
-    char cmdArgv[HUGE_NAME_LEN] = "";
     const char *delim1 = ":\n";
     const char *delim2 = "-";
     const char *delim3 = ".";
-    execCmdOut_t *execCmdOut = NULL;
+    std::string outputStr;
     struct tm mytm;
     time_t myTime;
 
-    bzero( &execCmdInp, sizeof( execCmdInp ) );
-    rstrcpy( execCmdInp.cmd, script.c_str(), LONG_NAME_LEN );
-    snprintf( cmdArgv, sizeof( cmdArgv ), "stat '%s' ", filename.c_str() );
-    rstrcpy( execCmdInp.cmdArgv, cmdArgv, HUGE_NAME_LEN );
-    rstrcpy( execCmdInp.execAddr, "localhost", LONG_NAME_LEN );
-    status = _rsExecCmd( &execCmdInp, &execCmdOut );
-
-    if ( status == 0 && NULL != execCmdOut ) { // JMC cppcheck - nullptr
-        if ( execCmdOut->stdoutBuf.buf != NULL ) {
-            const std::string outputStr(static_cast<char*>(execCmdOut->stdoutBuf.buf), execCmdOut->stdoutBuf.len);
+    status = univ_mss_execute( _ctx, "stat", { filename }, &outputStr );
+
+    if ( status == 0 ) {
+        if ( !outputStr.empty() ) {
             std::vector<std::string> output_tokens;
             boost::algorithm::split( output_tokens, outputStr, boost::is_any_of( delim1 ) );
             _statbuf->st_dev = atoi( output_tokens[0].c_str() );
@@ -247,12 +307,10 @@ irods::error univ_mss_file_stat(
         msg << "univ_mss_file_stat - failed for [";
         msg << filename;
         msg << "]";
-        freeCmdExecOut( execCmdOut );
         return ERROR( status, msg.str() );
 
     }
 
-    freeCmdExecOut( execCmdOut );
     return CODE( status );
 
 } // univ_mss_file_stat
@@ -282,34 +340,19 @@ irods::error univ_mss_file_chmod(
 
     }
 
-    // =-=-=-=-=-=-=-
-    // get the script property
-    std::string script;
-    err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
-    if ( !err.ok() ) {
-        return PASSMSG( __FUNCTION__, err );
-    }
-
     // =-=-=-=-=-=-=-
     // snag a ref to the fco
     irods::data_object_ptr fco = boost::dynamic_pointer_cast< irods::data_object >( _ctx.fco() );
     std::string filename = fco->physical_path();
 
     int mode = fco->mode();
-    int status = 0;
-    execCmd_t execCmdInp;
-
     if ( mode != getDefDirMode() ) {
         mode = getDefFileMode();
     }
 
-    bzero( &execCmdInp, sizeof( execCmdInp ) );
-    snprintf( execCmdInp.cmd, sizeof( execCmdInp.cmd ), "%s", script.c_str() );
-    snprintf( execCmdInp.cmdArgv, sizeof( execCmdInp.cmdArgv ), "chmod '%s' %o", filename.c_str(), mode );
-    snprintf( execCmdInp.execAddr, sizeof( execCmdInp.execAddr ), "%s", "localhost" );
-    execCmdOut_t *execCmdOut = NULL;
-    status = _rsExecCmd( &execCmdInp, &execCmdOut );
-    freeCmdExecOut( execCmdOut );
+    char mode_str[16];
+    snprintf( mode_str, sizeof( mode_str ), "%o", mode );
+    int status = univ_mss_execute( _ctx, "chmod", { filename, mode_str } );
 
     if ( status < 0 ) {
         status = UNIV_MSS_CHMOD_ERR - errno;
@@ -340,29 +383,12 @@ irods::error univ_mss_file_mkdir(
 
     }
 
-    // =-=-=-=-=-=-=-
-    // get the script property
-    std::string script;
-    err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
-    if ( !err.ok() ) {
-        return PASSMSG( __FUNCTION__, err );
-    }
-
     // =-=-=-=-=-=-=-
     // snag a ref to the fco
     irods::collection_object_ptr fco = boost::dynamic_pointer_cast< irods::collection_object >( _ctx.fco() );
     std::string dirname = fco->physical_path();
 
-    int status = 0;
-    execCmd_t execCmdInp;
-
-    bzero( &execCmdInp, sizeof( execCmdInp ) );
-    snprintf( execCmdInp.cmd, sizeof( execCmdInp.cmd ), "%s", script.c_str() );
-    snprintf( execCmdInp.cmdArgv, sizeof( execCmdInp.cmdArgv ), "mkdir '%s'", dirname.c_str() );
-    snprintf( execCmdInp.execAddr, sizeof( execCmdInp.execAddr ), "%s", "localhost" );
-    execCmdOut_t *execCmdOut = NULL;
-    status = _rsExecCmd( &execCmdInp, &execCmdOut );
-    freeCmdExecOut( execCmdOut );
+    int status = univ_mss_execute( _ctx, "mkdir", { dirname } );
     if ( status < 0 ) {
         status = UNIV_MSS_MKDIR_ERR - errno;
         std::stringstream msg;
@@ -429,14 +455,6 @@ irods::error univ_mss_file_rename(
 
     }
 
-    // =-=-=-=-=-=-=-
-    // get the script property
-    std::string script;
-    err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
-    if ( !err.ok() ) {
-        return PASSMSG( __FUNCTION__, err );
-    }
-
     // =-=-=-=-=-=-=-
     // snag a ref to the fco
     irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
@@ -465,15 +483,7 @@ irods::error univ_mss_file_rename(
     int status = 0;
     err = univ_mss_file_mkdir( context );
 
-    execCmd_t execCmdInp;
-
-    bzero( &execCmdInp, sizeof( execCmdInp ) );
-    snprintf( execCmdInp.cmd, sizeof( execCmdInp.cmd ), "%s", script.c_str() );
-    snprintf( execCmdInp.cmdArgv, sizeof( execCmdInp.cmdArgv ), "mv '%s' '%s'", filename.c_str(), _new_file_name );
-    snprintf( execCmdInp.execAddr, sizeof( execCmdInp.execAddr ), "%s", "localhost" );
-    execCmdOut_t *execCmdOut = NULL;
-    status = _rsExecCmd( &execCmdInp, &execCmdOut );
-    freeCmdExecOut( execCmdOut );
+    status = univ_mss_execute( _ctx, "mv", { filename, _new_file_name } );
 
     if ( status < 0 ) {
         status = UNIV_MSS_RENAME_ERR - errno;
@@ -531,28 +541,7 @@ irods::error univ_mss_file_stage_to_cache(
     irods::file_object_ptr fco = boost::dynamic_pointer_cast< irods::file_object >( _ctx.fco() );
     std::string filename = fco->physical_path();
 
-    // =-=-=-=-=-=-=-
-    // get the script property
-    std::string script;
-    err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
-    if ( !err.ok() ) {
-        return PASSMSG( __FUNCTION__, err );
-    }
-
-    int status = 0;
-
-    std::stringstream cmdArgv;
-    cmdArgv << "stageToCache '" << filename << "' '" << _cache_file_name << "'";
-
-    execCmd_t execCmdInp;
-    bzero( &execCmdInp, sizeof( execCmdInp ) );
-    snprintf( execCmdInp.cmd, sizeof( execCmdInp.cmd ), "%s",  script.c_str() );
-    snprintf( execCmdInp.cmdArgv, sizeof( execCmdInp.cmdArgv ), "%s", cmdArgv.str().c_str() );
-    snprintf( execCmdInp.execAddr, sizeof( execCmdInp.execAddr ), "%s", "localhost" );
-
-    execCmdOut_t *execCmdOut = NULL;
-    status = _rsExecCmd( &execCmdInp, &execCmdOut );
-    freeCmdExecOut( execCmdOut );
+    int status = univ_mss_execute( _ctx, "stageToCache", { filename, _cache_file_name } );
 
     if ( status < 0 ) {
         status = UNIV_MSS_STAGETOCACHE_ERR - errno;
@@ -615,22 +604,9 @@ irods::error univ_mss_file_sync_to_arch(
     int status = 0;
     err = univ_mss_file_mkdir( context );
 
-    execCmdOut_t* execCmdOut = NULL;
-
-    // =-=-=-=-=-=-=-
-    // get the script property
-    std::string script;
-    err = _ctx.prop_map().get< std::string >( SCRIPT_PROP, script );
-    if ( !err.ok() ) {
-        return PASSMSG( __FUNCTION__, err );
-    }
-
-    execCmd_t execCmdInp;
-    bzero( &execCmdInp, sizeof( execCmdInp ) );
-    rstrcpy( execCmdInp.cmd, script.c_str(), LONG_NAME_LEN );
-    snprintf( execCmdInp.cmdArgv, sizeof( execCmdInp.cmdArgv ), "syncToArch %s %s", _cache_file_name, filename.c_str() );
-    rstrcpy( execCmdInp.execAddr, "localhost", LONG_NAME_LEN );
-    status = _rsExecCmd( &execCmdInp, &execCmdOut );
+    std::string output;
+    std::string error;
+    status = univ_mss_execute( _ctx, "syncToArch", { _cache_file_name, filename }, &output, &error );
     if ( status == 0 ) {
         err = univ_mss_file_chmod( _ctx );
         if ( !err.ok() ) {
@@ -646,12 +622,11 @@ irods::error univ_mss_file_sync_to_arch(
         msg << filename;
         msg << "] failed.";
         msg << "   stdout buff [";
-        msg << execCmdOut->stdoutBuf.buf;
+        msg << output;
         msg << "]   stderr buff [";
-        msg << execCmdOut->stderrBuf.buf;
+        msg << error;
         msg << "]  status [";
-        msg << execCmdOut->status << "]";
-        freeCmdExecOut( execCmdOut );
+        msg << status << "]";
         return ERROR( status, msg.str() );
     }
 
@@ -750,26 +725,35 @@ irods::error univ_mss_file_rebalance(
 
 // =-=-=-=-=-=-=-
 // 3. create derived class to handle universal mss resources
-//    context string will hold the script to be called.
+//    context string will hold the script to be called, or a list of
+//    key-value pairs naming the script and the driver, e.g.
+//    "script=univMSSInterface.sh;driver=univMSSDriver"
 class univ_mss_resource : public irods::resource {
     public:
         univ_mss_resource( const std::string& _inst_name,
                            const std::string& _context ) :
             irods::resource( _inst_name, _context ) {
 
-            // =-=-=-=-=-=-=-
-            // check the context string for inappropriate path behavior
-            if ( context_.find( "/" ) != std::string::npos ) {
-                std::stringstream msg;
-                msg << "univmss resource :: the path [";
-                msg << context_;
-                msg << "] should be a single file name which should reside in msiExecCmd_bin";
-                rodsLog( LOG_ERROR, "[%s]", msg.str().c_str() );
+            if ( context_.find( irods::KVP_DEF_ASSOCIATION ) == std::string::npos ) {
+                // =-=-=-=-=-=-=-
+                // assign context string as the univ mss script to call
+                set_program_property( SCRIPT_PROP, context_ );
+                return;
             }
 
-            // =-=-=-=-=-=-=-
-            // assign context string as the univ mss script to call
-            properties_.set< std::string >( SCRIPT_PROP, context_ );
+            irods::kvp_map_t kvp;
+            irods::error ret = irods::parse_kvp_string( context_, kvp );
+            if ( !ret.ok() ) {
+                irods::log( PASS( ret ) );
+                return;
+            }
+
+            for ( const auto& prop : { SCRIPT_PROP, DRIVER_PROP } ) {
+                auto itr = kvp.find( prop );
+                if ( itr != kvp.end() ) {
+                    set_program_property( prop, itr->second );
+                }
+            }
         }
 
         // =-=-=-=-=-=-
@@ -785,6 +769,22 @@ class univ_mss_resource : public irods::resource {
             return ERROR( -1, "nop" );
         }
 
+    private:
+        void set_program_property( const std::string& _prop, const std::string& _program ) {
+            // =-=-=-=-=-=-=-
+            // check the program for inappropriate path behavior
+            // a driver with such a path is refused by univ_mss_execute
+            if ( !is_exec_cmd_file_name( _program ) ) {
+                std::stringstream msg;
+                msg << "univmss resource :: the path [";
+                msg << _program;
+                msg << "] should be a single file name which should reside in msiExecCmd_bin";
+                rodsLog( LOG_ERROR, "[%s]", msg.str().c_str() );
+            }
+
+            properties_.set< std::string >( _prop, _program );
+        }
+
 }; // class univ_mss_resource
 
 // =-=-=-=-=-=-=-
@@ -19,6 +19,8 @@
 #include "irods_kvp_string_parser.hpp"
 #include "irods_logger.hpp"
 #include "voting.hpp"
+#include "io_engine.hpp"
+#include "direct_io.hpp"
 
 // =-=-=-=-=-=-=-
 // stl includes
@@ -26,6 +28,8 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <mutex>
+#include <unordered_map>
 
 // =-=-=-=-=-=-=-
 // boost includes
@@ -83,6 +87,59 @@
 const std::string DEFAULT_VAULT_DIR_MODE( "default_vault_directory_mode_kw" );
 const std::string HIGH_WATER_MARK( "high_water_mark" ); // no longer used
 const std::string REQUIRED_FREE_INODES_FOR_CREATE("required_free_inodes_for_create"); // no longer used
+const std::string IO_ENGINE( "io_engine" );
+const std::string IO_ENGINE_QUEUE_DEPTH( "io_engine_queue_depth" );
+const std::string IO_ENGINE_REQUEST_SIZE( "io_engine_request_size" );
+const std::string IO_ENGINE_CONFIG( "io_engine_config" ); // parsed form of the three keys above
+const std::string DIRECT_IO( "direct_io" );
+const std::string DIRECT_IO_ALIGNMENT( "direct_io_alignment" );
+const std::string DIRECT_IO_MINIMUM_SIZE( "direct_io_minimum_size" );
+const std::string DIRECT_IO_CONFIG( "direct_io_config" ); // parsed form of the three keys above
+
+// =-=-=-=-=-=-=-
+// O_DIRECT companion descriptors, keyed by the regular descriptor they belong to
+static std::mutex direct_fd_mutex;
+static std::unordered_map< int, int > direct_fds;
+
+static void open_direct_companion(
+    irods::plugin_context& _ctx,
+    const std::string&     _path,
+    const int              _fd,
+    const int              _flags ) {
+    irods::direct_io::config config;
+    _ctx.prop_map().get< irods::direct_io::config >( DIRECT_IO_CONFIG, config );
+
+    // positional writes cannot honor O_APPEND
+    if ( !config.enabled || ( _flags & O_APPEND ) ) {
+        return;
+    }
+
+    const int direct_fd = irods::direct_io::open_companion( _path.c_str(), _flags );
+    if ( direct_fd < 0 ) {
+        rodsLog( LOG_DEBUG, "open_direct_companion: O_DIRECT is not available for [%s], errno = [%d]. Using the page cache.",
+                 _path.c_str(), -direct_fd );
+        return;
+    }
+
+    std::lock_guard< std::mutex > lock( direct_fd_mutex );
+    direct_fds[ _fd ] = direct_fd;
+} // open_direct_companion
+
+static int get_direct_companion(
+    const int _fd ) {
+    std::lock_guard< std::mutex > lock( direct_fd_mutex );
+    const auto itr = direct_fds.find( _fd );
+    return itr == direct_fds.end() ? -1 : itr->second;
+} // get_direct_companion
+
+static void close_direct_companion(
+    const int _fd ) {
+    std::lock_guard< std::mutex > lock( direct_fd_mutex );
+    if ( const auto itr = direct_fds.find( _fd ); itr != direct_fds.end() ) {
+        close( itr->second );
+        direct_fds.erase( itr );
+    }
+} // close_direct_companion
 
 // =-=-=-=-=-=-=-
 // NOTE: All storage resources must do this on the physical path stored in the file object and then update
@@ -574,6 +631,8 @@ irods::error unix_file_create(
                     irods::log(result);
                 }
                 else {
+                    open_direct_companion( _ctx, fco->physical_path(), fd, O_RDWR );
+
                     // =-=-=-=-=-=-=-
                     // cache file descriptor in out-variable
                     fco->file_descriptor( fd );
@@ -671,6 +730,8 @@ irods::error unix_file_open(
             result = ERROR( status, msg.str() );
         }
         else {
+            open_direct_companion( _ctx, fco->physical_path(), fd, flags );
+
             // =-=-=-=-=-=-=-
             // cache status in the file object
             fco->file_descriptor( fd );
@@ -703,13 +764,18 @@ irods::error unix_file_read(
 
         // =-=-=-=-=-=-=-
         // make the call to read
-        int status = read( fco->file_descriptor(), _buf, _len );
+        irods::io_engine::config io_config;
+        _ctx.prop_map().get< irods::io_engine::config >( IO_ENGINE_CONFIG, io_config );
+        irods::direct_io::config direct_io_config;
+        _ctx.prop_map().get< irods::direct_io::config >( DIRECT_IO_CONFIG, direct_io_config );
+        int status = irods::direct_io::read( direct_io_config, io_config, fco->file_descriptor(),
+                                               get_direct_companion( fco->file_descriptor() ), _buf, _len );
 
         // =-=-=-=-=-=-=-
         // pass along an error if it was not successful
-        int err_status = UNIX_FILE_READ_ERR - errno;
+        int err_status = UNIX_FILE_READ_ERR + status;
         if ( !( result = ASSERT_ERROR( status >= 0, err_status, "Read error for file: \"%s\", errno = \"%s\".",
-                                       fco->physical_path().c_str(), strerror( errno ) ) ).ok() ) {
+                                       fco->physical_path().c_str(), strerror( -status ) ) ).ok() ) {
             result.code( err_status );
         }
         else {
@@ -742,13 +808,18 @@ irods::error unix_file_write(
 
         // =-=-=-=-=-=-=-
         // make the call to write
-        int status = write( fco->file_descriptor(), _buf, _len );
+        irods::io_engine::config io_config;
+        _ctx.prop_map().get< irods::io_engine::config >( IO_ENGINE_CONFIG, io_config );
+        irods::direct_io::config direct_io_config;
+        _ctx.prop_map().get< irods::direct_io::config >( DIRECT_IO_CONFIG, direct_io_config );
+        int status = irods::direct_io::write( direct_io_config, io_config, fco->file_descriptor(),
+                                               get_direct_companion( fco->file_descriptor() ), _buf, _len );
 
         // =-=-=-=-=-=-=-
         // pass along an error if it was not successful
-        int err_status = UNIX_FILE_WRITE_ERR - errno;
+        int err_status = UNIX_FILE_WRITE_ERR + status;
         if ( !( result = ASSERT_ERROR( status >= 0, err_status, "Write file: \"%s\", errno = \"%s\", status = %d.",
-                                       fco->physical_path().c_str(), strerror( errno ), err_status ) ).ok() ) {
+                                       fco->physical_path().c_str(), strerror( -status ), err_status ) ).ok() ) {
             result.code( err_status );
         }
         else {
@@ -779,6 +850,7 @@ irods::error unix_file_close(
 
         // =-=-=-=-=-=-=-
         // make the call to close
+        close_direct_companion( fco->file_descriptor() );
         int status = close( fco->file_descriptor() );
 
         // =-=-=-=-=-=-=-
@@ -1369,8 +1441,87 @@ class unixfilesystem_resource : public irods::resource {
                         itr->second );
                 } // for itr
 
+                set_io_engine_config( kvp );
+                set_direct_io_config( kvp );
+
         } // ctor
 
+        // =-=-=-=-=-=-=-
+        // parse the optional I/O engine settings once so that read and write
+        // do not have to do it on every call. invalid values are logged and
+        // the default is kept.
+        void set_io_engine_config( const irods::kvp_map_t& _kvp ) {
+            irods::io_engine::config io_config;
+
+            try {
+                if ( auto itr = _kvp.find( IO_ENGINE ); itr != _kvp.end() ) {
+                    io_config.type = irods::io_engine::to_engine_type( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( IO_ENGINE_QUEUE_DEPTH ); itr != _kvp.end() ) {
+                    io_config.queue_depth = std::stoi( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( IO_ENGINE_REQUEST_SIZE ); itr != _kvp.end() ) {
+                    io_config.request_size = std::stoll( itr->second );
+                }
+
+                if ( io_config.queue_depth < 1 || io_config.request_size < 4096 || io_config.request_size > 1024 * 1024 * 1024 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "io_engine_queue_depth or io_engine_request_size out of range" );
+                }
+            }
+            catch ( const irods::exception& e ) {
+                rodsLog( LOG_ERROR, "unixfilesystem_resource: invalid I/O engine settings for [%s]. Using posix I/O. [%s]",
+                         instance_name_.c_str(), e.client_display_what() );
+                io_config = irods::io_engine::config{};
+            }
+            catch ( const std::exception& e ) {
+                rodsLog( LOG_ERROR, "unixfilesystem_resource: invalid I/O engine settings for [%s]. Using posix I/O. [%s]",
+                         instance_name_.c_str(), e.what() );
+                io_config = irods::io_engine::config{};
+            }
+
+            properties_.set< irods::io_engine::config >( IO_ENGINE_CONFIG, io_config );
+        }
+
+        // =-=-=-=-=-=-=-
+        // parse the optional O_DIRECT settings. invalid values are logged and
+        // direct I/O stays disabled.
+        void set_direct_io_config( const irods::kvp_map_t& _kvp ) {
+            irods::direct_io::config config;
+
+            try {
+                if ( auto itr = _kvp.find( DIRECT_IO ); itr != _kvp.end() ) {
+                    config.enabled = ( "true" == itr->second || "1" == itr->second );
+                }
+
+                if ( auto itr = _kvp.find( DIRECT_IO_ALIGNMENT ); itr != _kvp.end() ) {
+                    config.alignment = std::stoll( itr->second );
+                }
+
+                if ( auto itr = _kvp.find( DIRECT_IO_MINIMUM_SIZE ); itr != _kvp.end() ) {
+                    config.minimum_size = std::stoll( itr->second );
+                }
+
+                const bool power_of_two = config.alignment > 0 && 0 == ( config.alignment & ( config.alignment - 1 ) );
+                if ( !power_of_two || config.alignment < 512 || config.alignment > 1024 * 1024 ) {
+                    THROW( SYS_INVALID_INPUT_PARAM, "direct_io_alignment must be a power of two between 512 and 1048576" );
+                }
+            }
+            catch ( const irods::exception& e ) {
+                rodsLog( LOG_ERROR, "unixfilesystem_resource: invalid direct I/O settings for [%s]. Direct I/O is disabled. [%s]",
+                         instance_name_.c_str(), e.client_display_what() );
+                config = irods::direct_io::config{};
+            }
+            catch ( const std::exception& e ) {
+                rodsLog( LOG_ERROR, "unixfilesystem_resource: invalid direct I/O settings for [%s]. Direct I/O is disabled. [%s]",
+                         instance_name_.c_str(), e.what() );
+                config = irods::direct_io::config{};
+            }
+
+            properties_.set< irods::direct_io::config >( DIRECT_IO_CONFIG, config );
+        }
+
         irods::error need_post_disconnect_maintenance_operation( bool& _b ) {
             _b = false;
             return SUCCESS();
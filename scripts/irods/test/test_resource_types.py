@@ -3978,6 +3978,46 @@ OUTPUT ruleExecOut
             self.admin.assert_icommand(['iadmin', 'modresc', 'unix3Resc', 'host', test.settings.HOSTNAME_3])
             self.admin.assert_icommand(['iadmin', 'rmresc', test_resc])
 
+    def fan_out_replica_statuses(self, filename):
+        _, out, _ = self.admin.assert_icommand(
+            ['iquest', '%s', "select DATA_REPL_STATUS where DATA_NAME = '{0}'".format(filename)], 'STDOUT', '1')
+        return sorted(out.split())
+
+    def test_fan_out_replicates_to_every_child_once(self):
+        filename = 'test_fan_out_replicates_to_every_child_once'
+        lib.make_file(filename, 4 * 1024 * 1024 + 1)
+
+        self.admin.assert_icommand(['iadmin', 'modresc', 'demoResc', 'context', 'fan_out=true'])
+        try:
+            # The put returns once every replication has completed, and the agents doing the
+            # replications do not fan out again
+            self.admin.assert_icommand(['iput', filename])
+            self.assertEqual(self.fan_out_replica_statuses(filename), ['1', '1', '1'])
+
+            # An overwrite is fanned out the same way
+            self.admin.assert_icommand(['iput', '-f', filename])
+            self.assertEqual(self.fan_out_replica_statuses(filename), ['1', '1', '1'])
+            self.admin.assert_icommand(['ils', '-L', filename], 'STDOUT_MULTILINE', [' 0 ', ' 1 ', ' 2 '])
+        finally:
+            self.admin.assert_icommand(['iadmin', 'modresc', 'demoResc', 'context', 'null'])
+            self.admin.run_icommand(['irm', '-f', filename])
+            os.unlink(filename)
+
+    def test_fan_out_with_a_quorum_waits_for_every_replication(self):
+        filename = 'test_fan_out_with_a_quorum_waits_for_every_replication'
+        lib.make_file(filename, 4 * 1024 * 1024 + 1)
+
+        self.admin.assert_icommand(['iadmin', 'modresc', 'demoResc', 'context', 'fan_out=true;quorum=1'])
+        try:
+            # The quorum is met by the replica the client wrote, but the replications to the
+            # other children still complete before the put returns
+            self.admin.assert_icommand(['iput', filename])
+            self.assertEqual(self.fan_out_replica_statuses(filename), ['1', '1', '1'])
+        finally:
+            self.admin.assert_icommand(['iadmin', 'modresc', 'demoResc', 'context', 'null'])
+            self.admin.run_icommand(['irm', '-f', filename])
+            os.unlink(filename)
+
 class Test_Resource_MultiLayered(ChunkyDevTest, ResourceSuite, unittest.TestCase):
 
     def setUp(self):
@@ -6,5 +6,6 @@
 
 int rsModDataObjMeta( rsComm_t *rsComm, modDataObjMeta_t *modDataObjMetaInp );
 int _rsModDataObjMeta( rsComm_t *rsComm, modDataObjMeta_t *modDataObjMetaInp );
+int _call_file_modified_for_modification( rsComm_t *rsComm, modDataObjMeta_t *modDataObjMetaInp );
 
 #endif
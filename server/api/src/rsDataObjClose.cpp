@@ -389,6 +389,9 @@ namespace
         if (const char* pdmo_kw = getValByKey(&_inp.condInput, IN_PDMO_KW); pdmo_kw) {
             reg_param[IN_PDMO_KW] = pdmo_kw;
         }
+        if (cond_input.contains(REPL_FAN_OUT_KW)) {
+            reg_param[REPL_FAN_OUT_KW] = cond_input.at(REPL_FAN_OUT_KW);
+        }
         if (cond_input.contains(SYNC_OBJ_KW)) {
             reg_param[SYNC_OBJ_KW] = cond_input.at(SYNC_OBJ_KW);
         }
@@ -811,7 +814,7 @@ auto l3Close(RsComm* _comm, const int _fd) -> int
 int rsDataObjClose(rsComm_t* rsComm, openedDataObjInp_t* dataObjCloseInp)
 {
     const auto fd = dataObjCloseInp->l1descInx;
-    if (fd < 3 || fd >= NUM_L1_DESC) {
+    if (fd < 3 || fd >= L1desc.size()) {
         rodsLog(LOG_NOTICE,
             "rsDataObjClose: l1descInx %d out of range", fd);
         return SYS_FILE_DESC_OUT_OF_RANGE;
@@ -15,6 +15,7 @@
 #include "irods_hasher_factory.hpp"
 #include "irods_server_properties.hpp"
 #include "MD5Strategy.hpp"
+#include "io_engine.hpp"
 
 #define SVR_MD5_BUF_SZ (1024*1024)
 
@@ -208,6 +209,7 @@ int fileChksum(
     // =-=-=-=-=-=-=-
     // do an inital read of the file
     char buffer[SVR_MD5_BUF_SZ];
+    irods::io_engine::registered_buffer registered_buf{ buffer, sizeof( buffer ) };
     irods::error read_err = fileRead(
                                 rsComm,
                                 file_obj,
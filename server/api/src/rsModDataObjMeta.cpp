@@ -16,9 +16,6 @@
 
 #include "boost/format.hpp"
 
-int _call_file_modified_for_modification(
-    rsComm_t*         rsComm,
-    modDataObjMeta_t* modDataObjMetaInp );
 int
 rsModDataObjMeta( rsComm_t *rsComm, modDataObjMeta_t *modDataObjMetaInp ) {
     int status;
@@ -314,6 +311,10 @@ int _call_file_modified_for_modification(
         if (sync) {
             addKeyVal((keyValPair_t*)&file_obj->cond_input(), SYNC_OBJ_KW, sync);
         }
+        const auto fan_out{getValByKey(regParam, REPL_FAN_OUT_KW)};
+        if (fan_out) {
+            addKeyVal((keyValPair_t*)&file_obj->cond_input(), REPL_FAN_OUT_KW, fan_out);
+        }
         const auto repl_status{getValByKey(regParam, REPL_STATUS_KW)};
         if (repl_status) {
             addKeyVal((keyValPair_t*)&file_obj->cond_input(), REPL_STATUS_KW, repl_status);
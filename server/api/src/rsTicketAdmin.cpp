@@ -8,6 +8,7 @@
 #include "icatHighLevelRoutines.hpp"
 #include "miscServerFunct.hpp"
 #include "irods_configuration_keywords.hpp"
+#include "catalog_commit_queue.hpp"
 
 int
 rsTicketAdmin( rsComm_t *rsComm, ticketAdminInp_t *ticketAdminInp ) {
@@ -75,5 +76,12 @@ _rsTicketAdmin( rsComm_t *rsComm, ticketAdminInp_t *ticketAdminInp ) {
     status = chlModTicket( rsComm, ticketAdminInp->arg1,
                            ticketAdminInp->arg2, ticketAdminInp->arg3,
                            ticketAdminInp->arg4, ticketAdminInp->arg5 );
+
+    // The write-byte limit of the ticket is only enforced when the database
+    // plugin updates the replicas closed in this session.
+    if ( status >= 0 && strcmp( ticketAdminInp->arg1, "session" ) == 0 ) {
+        irods::experimental::catalog::commit_replica_updates_immediately();
+    }
+
     return status;
 }
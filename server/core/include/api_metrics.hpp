@@ -0,0 +1,138 @@
+#ifndef IRODS_API_METRICS_HPP
+#define IRODS_API_METRICS_HPP
+
+/// \file
+
+#include <json.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Per-API performance counters shared by every agent of a server.
+///
+/// The counters live in a shared memory mapping created by the main server before it
+/// forks the agent factory, so every agent inherits it. The mapping is divided into
+/// stripes and each agent records into the stripe selected by its PID, which keeps
+/// agents running the same API from contending on the same cache lines. Readers
+/// aggregate all stripes.
+///
+/// Recording a call only involves relaxed atomic increments. No locks are taken.
+///
+/// \since 4.3.0
+namespace irods::experimental::api_metrics
+{
+    /// Latencies are recorded in a log-linear histogram (in the style of HDR histograms)
+    /// with 8 buckets per power of two, giving a relative error of at most 12.5%.
+    ///
+    /// Values are in microseconds. Values beyond the last bucket are clamped to it.
+    inline constexpr int histogram_sub_bucket_bits = 3;
+    inline constexpr std::size_t histogram_sub_bucket_count = std::size_t{1} << histogram_sub_bucket_bits;
+    inline constexpr int histogram_max_exponent = 35; // ~9.5 hours
+    inline constexpr std::size_t histogram_bucket_count =
+        histogram_sub_bucket_count + (histogram_max_exponent - histogram_sub_bucket_bits + 1) * histogram_sub_bucket_count;
+
+    /// Returns the histogram bucket holding \p _microseconds.
+    auto bucket_index(std::uint64_t _microseconds) noexcept -> std::size_t;
+
+    /// Returns the smallest value held by the bucket at \p _index.
+    auto bucket_lower_bound(std::size_t _index) noexcept -> std::uint64_t;
+
+    /// The aggregated counters for a single API.
+    struct api_statistics
+    {
+        int api_number = 0;
+        std::uint64_t calls = 0;
+        std::uint64_t errors = 0;
+        std::uint64_t bytes_received = 0;
+        std::uint64_t bytes_sent = 0;
+        std::uint64_t total_microseconds = 0;
+        std::uint64_t max_microseconds = 0;
+        std::array<std::uint64_t, histogram_bucket_count> histogram{};
+
+        /// Returns an upper bound for the latency (in microseconds) below which
+        /// \p _percentile percent of the calls completed.
+        auto percentile(double _percentile) const noexcept -> std::uint64_t;
+    }; // struct api_statistics
+
+    /// Everything collected since the server started.
+    struct statistics
+    {
+        std::vector<api_statistics> apis;
+
+        /// Calls which were not recorded because every slot of the stripe was in use.
+        std::uint64_t untracked_calls = 0;
+    }; // struct statistics
+
+    /// Creates the shared counters.
+    ///
+    /// Must be called by the main server before any agent is forked. Calling it more
+    /// than once has no effect.
+    ///
+    /// \throws std::system_error If the shared memory cannot be mapped.
+    auto init() -> void;
+
+    /// Releases the shared counters. Only the process which called init() releases them.
+    auto deinit() noexcept -> void;
+
+    /// Records a completed API call. Does nothing if init() has not been called.
+    ///
+    /// \param[in] _api_number     The API number of the call.
+    /// \param[in] _elapsed        The time spent handling the call, including the reply.
+    /// \param[in] _status         The result of the call. Negative values count as errors.
+    /// \param[in] _bytes_received The size of the request (input struct and byte stream).
+    /// \param[in] _bytes_sent     The size of the byte stream returned to the client.
+    auto record(int _api_number,
+                std::chrono::microseconds _elapsed,
+                int _status,
+                std::uint64_t _bytes_received,
+                std::uint64_t _bytes_sent) noexcept -> void;
+
+    /// Sums the counters of every agent.
+    ///
+    /// \return The statistics of every API called at least once, sorted by API number.
+    auto collect() -> statistics;
+
+    /// Converts statistics to JSON (used by the control plane).
+    auto to_json(const statistics& _stats) -> nlohmann::json;
+
+    /// Converts statistics to the Prometheus text exposition format.
+    auto to_prometheus_text(const statistics& _stats) -> std::string;
+
+    /// Serves the metrics over HTTP for Prometheus (GET /metrics).
+    ///
+    /// The server runs on its own thread until the object is destroyed.
+    class prometheus_endpoint
+    {
+    public:
+        /// \param[in] _port The TCP port to listen on (all interfaces).
+        ///
+        /// \throws std::system_error If the port cannot be bound.
+        explicit prometheus_endpoint(int _port);
+
+        prometheus_endpoint(const prometheus_endpoint&) = delete;
+        auto operator=(const prometheus_endpoint&) -> prometheus_endpoint& = delete;
+
+        ~prometheus_endpoint();
+
+        /// Returns the port the endpoint is listening on.
+        auto port() const noexcept -> int;
+
+    private:
+        auto run() -> void;
+        auto handle(int _client) -> void;
+
+        int socket_;
+        int port_;
+        std::atomic<bool> stop_;
+        std::thread thread_;
+    }; // class prometheus_endpoint
+} // namespace irods::experimental::api_metrics
+
+#endif // IRODS_API_METRICS_HPP
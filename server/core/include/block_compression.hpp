@@ -0,0 +1,219 @@
+#ifndef IRODS_BLOCK_COMPRESSION_HPP
+#define IRODS_BLOCK_COMPRESSION_HPP
+
+/// \file
+
+#include "thread_pool.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+/// A file format which compresses data in independent fixed-size blocks.
+///
+/// Each block is deflated on its own and appended to the file. An index of the
+/// blocks and a trailer pointing at it are written when the file is closed, so any
+/// byte of the content can be read by inflating a single block.
+///
+/// A file is laid out as follows. All integers are little-endian.
+///
+///   [stored blocks, in any order]
+///   [index: block size (u32), reserved (u32), content size (i64), block count (u64),
+///           then for every block: offset (u64), stored size (u32), size (u32),
+///           flags (u32), reserved (u32)]
+///   [trailer: index offset (u64), index size (u64), 16-byte magic]
+///
+/// A block with a stored size of zero was never written and reads as zeros.
+///
+/// \since 4.3.0
+namespace irods::experimental::block_compression
+{
+    constexpr std::uint32_t default_block_size = 256 * 1024;
+
+    /// The block is stored as it is because deflate did not make it smaller.
+    constexpr std::uint32_t stored_raw = 1;
+
+    /// Positioned I/O on the file holding the compressed content.
+    ///
+    /// Both functions must throw to report an error.
+    struct file_io
+    {
+        /// Reads up to _size bytes at _offset and returns the number of bytes read,
+        /// which is less than _size only at the end of the file.
+        std::function<std::size_t(std::int64_t _offset, void* _buffer, std::size_t _size)> read;
+
+        /// Writes _size bytes at _offset.
+        std::function<void(std::int64_t _offset, const void* _buffer, std::size_t _size)> write;
+    }; // struct file_io
+
+    struct block_entry
+    {
+        std::uint64_t offset = 0;
+        std::uint32_t stored_size = 0;
+        std::uint32_t size = 0;
+        std::uint32_t flags = 0;
+    }; // struct block_entry
+
+    struct block_index
+    {
+        std::uint32_t block_size = default_block_size;
+        std::int64_t size = 0;
+
+        /// Indexed by block number.
+        std::vector<block_entry> blocks;
+    }; // struct block_index
+
+    /// Reads the index of the file of \p _file_size bytes behind \p _io.
+    ///
+    /// Returns nothing if the file was not written in this format, e.g. a file
+    /// registered in place, which is then read as it is.
+    ///
+    /// \throws irods::exception If the file cannot be read or its index is damaged.
+    auto read_index(const file_io& _io, std::int64_t _file_size) -> std::optional<block_index>;
+
+    /// Writes the content of a file, compressing full blocks on a thread pool.
+    ///
+    /// Blocks are appended after the end of the existing file in the order they are
+    /// completed, so writes may arrive at any offset. A block which is written again
+    /// is appended again and its old copy is left unused.
+    ///
+    /// Not thread-safe.
+    class writer
+    {
+    public:
+        /// \param[in] _index   The index of the existing content, or an empty index
+        ///                     for a new file.
+        /// \param[in] _end     The size of the existing file. Blocks are appended here.
+        /// \param[in] _threads The number of threads which compress blocks.
+        /// \param[in] _level   The zlib compression level.
+        writer(block_index _index, std::int64_t _end, int _threads, int _level);
+
+        writer(const writer&) = delete;
+        auto operator=(const writer&) -> writer& = delete;
+
+        ~writer();
+
+        /// The size of the content.
+        auto size() const noexcept -> std::int64_t { return index_.size; }
+
+        /// \throws irods::exception
+        auto write(std::int64_t _offset, const void* _buffer, std::size_t _size, const file_io& _io) -> void;
+
+        /// Reads the content as written so far. Returns the number of bytes read.
+        ///
+        /// \throws irods::exception
+        auto read(std::int64_t _offset, void* _buffer, std::size_t _size, const file_io& _io) -> std::size_t;
+
+        /// \throws irods::exception
+        auto truncate(std::int64_t _size, const file_io& _io) -> void;
+
+        /// Stores the remaining blocks and writes the index and the trailer.
+        ///
+        /// Returns the size of the file.
+        ///
+        /// \throws irods::exception
+        auto finish(const file_io& _io) -> std::int64_t;
+
+        /// The number of bytes stored, and the number of bytes they hold.
+        auto bytes_stored() const noexcept -> std::int64_t { return bytes_stored_; }
+        auto bytes_compressed() const noexcept -> std::int64_t { return bytes_compressed_; }
+
+    private:
+        struct block
+        {
+            std::size_t number = 0;
+            std::vector<char> input;
+            std::vector<char> output;
+            std::uint32_t flags = 0;
+            bool done = false;
+            int error = 0;
+        }; // struct block
+
+        struct open_block
+        {
+            std::vector<char> data;
+            std::size_t bytes_written = 0;
+        }; // struct open_block
+
+        // Returns the block being written, loading its existing content first.
+        auto load(std::size_t _number, const file_io& _io) -> open_block&;
+
+        // Hands a block to the pool for compression.
+        auto submit(std::size_t _number, const file_io& _io) -> void;
+
+        // Appends the compressed blocks at the front of the queue to the file. Waits
+        // until the queue holds at most _max_pending blocks.
+        auto drain(std::size_t _max_pending, const file_io& _io) -> void;
+
+        auto block_length(std::size_t _number) const noexcept -> std::size_t;
+
+        block_index index_;
+        std::int64_t end_;
+        int level_;
+        std::size_t max_pending_;
+
+        std::map<std::size_t, open_block> open_blocks_;
+        std::deque<std::shared_ptr<block>> pending_;
+
+        std::int64_t bytes_stored_;
+        std::int64_t bytes_compressed_;
+
+        std::mutex mutex_;
+        std::condition_variable done_;
+
+        // Declared last so that the threads stop before the members they use are
+        // destroyed.
+        irods::thread_pool pool_;
+    }; // class writer
+
+    /// Reads the content of a file, inflating the blocks after the one being read
+    /// on a thread pool.
+    ///
+    /// Not thread-safe.
+    class reader
+    {
+    public:
+        /// \param[in] _threads The number of threads which inflate blocks.
+        /// \param[in] _window  The number of blocks inflated ahead of the one being read.
+        reader(block_index _index, int _threads, std::size_t _window);
+
+        reader(const reader&) = delete;
+        auto operator=(const reader&) -> reader& = delete;
+
+        ~reader();
+
+        auto size() const noexcept -> std::int64_t { return index_.size; }
+
+        /// Reads up to \p _size bytes at \p _offset into \p _buffer.
+        ///
+        /// Returns the number of bytes read, which is less than \p _size only at the
+        /// end of the content.
+        ///
+        /// \throws irods::exception
+        auto read(std::int64_t _offset, void* _buffer, std::size_t _size, const file_io& _io) -> std::size_t;
+
+    private:
+        using block_data = std::shared_ptr<const std::vector<char>>;
+
+        // Schedules the blocks in [_first, _first + window) and forgets the blocks
+        // outside of it. Neighbouring stored blocks are read from the file at once.
+        auto prefetch(std::size_t _first, const file_io& _io) -> void;
+
+        block_index index_;
+        std::size_t window_;
+        std::map<std::size_t, std::shared_future<block_data>> loaded_;
+
+        // Declared last so that the threads stop before the members they use are
+        // destroyed.
+        irods::thread_pool pool_;
+    }; // class reader
+} // namespace irods::experimental::block_compression
+
+#endif // IRODS_BLOCK_COMPRESSION_HPP
@@ -0,0 +1,187 @@
+#ifndef IRODS_CACHE_EVICTION_HPP
+#define IRODS_CACHE_EVICTION_HPP
+
+/// \file
+
+#include <sys/types.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irods::experimental::interprocess
+{
+    template <typename T>
+    class shared_memory_object;
+} // namespace irods::experimental::interprocess
+
+/// Policies for choosing the replicas to evict from the cache of a compound resource.
+///
+/// Accesses to the cache are recorded in an access log shared by the agents of the
+/// server. When the replicas in the cache exceed the high watermark, a policy orders
+/// the replicas which can be evicted, and the first ones are trimmed until the cache
+/// is below the low watermark.
+///
+/// \since 4.3.0
+namespace irods::experimental::cache_eviction
+{
+    /// A replica in the cache which may be evicted.
+    struct candidate
+    {
+        std::int64_t data_id;
+        int replica_number;
+        std::string logical_path;
+        std::int64_t size;
+
+        // From the access log, or derived from the catalog if the replica has not been
+        // accessed since the log was created.
+        std::int64_t last_access;
+        std::uint32_t hits;
+        double gdsf_value;
+    }; // struct candidate
+
+    class policy
+    {
+    public:
+        virtual ~policy() = default;
+
+        /// Returns whether \p _lhs should be evicted before \p _rhs.
+        virtual auto evict_before(const candidate& _lhs, const candidate& _rhs) const -> bool = 0;
+    }; // class policy
+
+    /// Returns the policy named \p _name:
+    /// - "lru":  Evicts the least recently used replicas first.
+    /// - "lfu":  Evicts the least frequently used replicas first.
+    /// - "gdsf": Greedy-Dual-Size-Frequency. Evicts the replicas with the lowest
+    ///           frequency per byte first, aged so that formerly popular replicas
+    ///           eventually leave the cache.
+    ///
+    /// \throws irods::exception If there is no such policy.
+    auto make_policy(std::string_view _name) -> std::unique_ptr<policy>;
+
+    /// Returns the first candidates in the order of \p _policy whose sizes add up to
+    /// at least \p _bytes_to_free, or all of them.
+    auto select_victims(std::vector<candidate> _candidates,
+                        const policy& _policy,
+                        std::int64_t _bytes_to_free) -> std::vector<candidate>;
+
+    struct watermarks
+    {
+        /// The number of bytes the cache may hold.
+        std::int64_t capacity;
+
+        /// Eviction starts when the cache holds more than this percentage of the capacity.
+        int high_percent;
+
+        /// Eviction stops once the cache holds no more than this percentage of the capacity.
+        int low_percent;
+    }; // struct watermarks
+
+    /// Returns the number of bytes to evict when the cache holds \p _used_bytes.
+    auto bytes_to_free(std::int64_t _used_bytes, const watermarks& _watermarks) noexcept -> std::int64_t;
+
+    struct access_record
+    {
+        std::int64_t last_access;
+        std::uint32_t hits;
+
+        /// The GDSF aging value at the time of the last access.
+        double inflation;
+    }; // struct access_record
+
+    /// Returns the GDSF value of a replica of \p _size bytes accessed as in \p _record.
+    auto gdsf_value(const access_record& _record, std::int64_t _size) noexcept -> double;
+
+    /// Returns the key of the replica at \p _physical_path in the access log.
+    ///
+    /// The log is fed by the open and close operations of the resource, which know the
+    /// physical path of a replica but not its data ID.
+    auto make_replica_key(std::string_view _physical_path) noexcept -> std::int64_t;
+
+    /// Removes the access logs left in shared memory by an earlier run of the server,
+    /// and identifies this run in the access logs created by its agents.
+    ///
+    /// Must be called by the main server before any agent is forked.
+    auto init_access_logs() -> void;
+
+    /// Removes the access logs from shared memory. Only the process which called
+    /// init_access_logs() removes them.
+    auto deinit_access_logs() noexcept -> void;
+
+    /// The accesses to the replicas of one cache resource, shared by the processes of
+    /// the server. Replicas are identified by the keys returned by make_replica_key().
+    ///
+    /// The log has a fixed capacity. When the slots a replica may occupy are full, the
+    /// least recently used one is reused, so the log retains the most recent accesses.
+    /// Replicas which are not in the log are treated as neither recent nor frequent.
+    class access_log
+    {
+    public:
+        /// The number of replicas the log can hold.
+        static constexpr std::size_t capacity = 32768;
+
+        /// Opens the log of the resource \p _resource_id, creating it if necessary.
+        explicit access_log(std::int64_t _resource_id);
+
+        access_log(const access_log&) = delete;
+        auto operator=(const access_log&) -> access_log& = delete;
+
+        ~access_log();
+
+        /// Records an access to the replica of \p _key at \p _time (seconds since the
+        /// epoch).
+        auto record(std::int64_t _key, std::int64_t _time) -> void;
+
+        auto find(std::int64_t _key) const -> std::optional<access_record>;
+
+        /// Forgets the replica of \p _key, e.g. after it has been evicted.
+        auto erase(std::int64_t _key) -> void;
+
+        /// Returns the GDSF aging value, which is the value of the last replica evicted.
+        auto inflation() const -> double;
+
+        /// Raises the GDSF aging value to \p _value.
+        auto inflate(double _value) -> void;
+
+        /// Claims the right to evict for the calling process.
+        ///
+        /// Fails if another living process holds it, or if the previous eviction check
+        /// started less than \p _interval seconds before \p _now.
+        auto try_start_eviction(std::int64_t _now, std::int64_t _interval) -> bool;
+
+        /// Releases the right claimed by try_start_eviction().
+        auto finish_eviction() -> void;
+
+        /// Removes the log from shared memory.
+        auto remove() -> void;
+
+        struct slot
+        {
+            std::int64_t key;
+            std::int64_t last_access;
+            std::uint32_t hits;
+            double inflation;
+        }; // struct slot
+
+        struct table
+        {
+            double inflation;
+            std::int64_t last_check;
+            pid_t evictor;
+
+            // The run of the server the evictor belongs to. A process of another run
+            // may have been given the same PID.
+            std::int64_t evictor_server_instance;
+            std::array<slot, capacity> slots;
+        }; // struct table
+
+    private:
+        std::unique_ptr<interprocess::shared_memory_object<table>> table_;
+    }; // class access_log
+} // namespace irods::experimental::cache_eviction
+
+#endif // IRODS_CACHE_EVICTION_HPP
@@ -0,0 +1,155 @@
+#ifndef IRODS_CATALOG_COMMIT_QUEUE_HPP
+#define IRODS_CATALOG_COMMIT_QUEUE_HPP
+
+/// \file
+
+#include "nanodbc/nanodbc.h"
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irods::experimental::catalog
+{
+    /// Defines how the catalog updates made by replica closes are committed.
+    ///
+    /// \since 4.3.0
+    enum class commit_mode
+    {
+        /// Every close updates the catalog by itself through rsModDataObjMeta.
+        immediate,
+
+        /// A close waits until its update is committed. Updates which arrive from any
+        /// agent while another batch is being committed are committed together in the
+        /// next transaction. A close which returned successfully is durable.
+        group
+    }; // enum class commit_mode
+
+    /// \throws irods::exception If \p _name is not "immediate" or "group".
+    ///
+    /// \since 4.3.0
+    auto to_commit_mode(std::string_view _name) -> commit_mode;
+
+    /// The columns of a replica which are changed when it is closed. Columns which
+    /// are not set are left alone.
+    ///
+    /// \since 4.3.0
+    struct replica_update
+    {
+        std::uint64_t data_id = 0;
+        std::uint64_t resc_id = 0;
+
+        std::optional<std::int64_t> size;
+        std::optional<std::string> modify_ts;
+        std::optional<int> replica_status;
+    }; // struct replica_update
+
+    /// Updates R_DATA_MAIN with \p _updates, in order. The caller provides the
+    /// transaction.
+    ///
+    /// \throws nanodbc::database_error
+    ///
+    /// \since 4.3.0
+    auto apply_replica_updates(nanodbc::connection& _db_conn, const std::vector<replica_update>& _updates) -> void;
+
+    /// Group-commits the replica updates of every process forked from the one which
+    /// created it.
+    ///
+    /// The updates are collected in an anonymous shared mapping. A process which
+    /// submits an update while no batch is being committed commits the queued updates
+    /// itself, with its own commit function, and the processes which submit updates in
+    /// the meantime wait for the next batch. No thread is started.
+    ///
+    /// Batches are committed one at a time and in the order their updates were
+    /// submitted, so a later update of a replica always wins. If the process committing
+    /// a batch dies, the batch is reported as failed to the processes waiting for it.
+    ///
+    /// Thread-safe and process-safe.
+    ///
+    /// \since 4.3.0
+    class commit_queue
+    {
+    public:
+        /// Commits a batch in a single transaction. Throws if the transaction fails,
+        /// in which case none of the batch is committed.
+        using commit_function = std::function<void(const std::vector<replica_update>&)>;
+
+        /// \param[in] _max_batch_size The largest number of updates committed in one
+        ///                            transaction. Submitters wait while the batch
+        ///                            being collected is full.
+        /// \param[in] _commit         Commits the batches of this process. The copy
+        ///                            inherited by a forked process commits its batches.
+        ///
+        /// \throws irods::exception   If the arguments are invalid.
+        /// \throws std::system_error  If the shared memory cannot be mapped.
+        commit_queue(std::size_t _max_batch_size, commit_function _commit);
+
+        commit_queue(const commit_queue&) = delete;
+        auto operator=(const commit_queue&) -> commit_queue& = delete;
+
+        /// Unmaps the shared memory. The process which created the queue also destroys
+        /// its synchronization primitives.
+        ~commit_queue();
+
+        auto max_batch_size() const noexcept -> std::size_t { return max_batch_size_; }
+
+        /// Queues \p _update and waits until it is committed.
+        ///
+        /// \returns The error code of the transaction which held the update.
+        auto submit(const replica_update& _update) -> int;
+
+    private:
+        struct shared_state;
+        class robust_lock;
+
+        // Commits the open batch. The caller holds \p _lock and still holds it on
+        // return.
+        auto commit_open_batch(robust_lock& _lock) -> void;
+
+        // Fails the batch of a process which died while committing it.
+        auto abandon_batch_of_dead_leader() -> void;
+
+        std::size_t max_batch_size_;
+        commit_function commit_;
+        pid_t owner_pid_;
+        std::size_t mapping_size_;
+        shared_state* state_;
+    }; // class commit_queue
+
+    /// Creates the queue shared by the agents for the updates made by replica closes.
+    ///
+    /// Must be called by the main server before any agent is forked. Does nothing
+    /// unless the replica_close_commit_mode advanced setting is "group" and this server
+    /// is the catalog provider. Each agent commits over a connection of its own to the
+    /// catalog, opened the first time it commits a batch.
+    ///
+    /// \since 4.3.0
+    auto init_replica_update_queue() -> void;
+
+    /// Releases the queue created by init_replica_update_queue().
+    ///
+    /// \since 4.3.0
+    auto deinit_replica_update_queue() noexcept -> void;
+
+    /// Makes the replica closes of this agent commit immediately.
+    ///
+    /// Called when the client sets a session ticket. Only the database plugin charges
+    /// the bytes written under a ticket against its write-byte limit.
+    ///
+    /// \since 4.3.0
+    auto commit_replica_updates_immediately() noexcept -> void;
+
+    /// Returns the queue for the updates made by replica closes, or nullptr if the
+    /// replica closes of this agent commit immediately.
+    ///
+    /// \since 4.3.0
+    auto replica_update_queue() noexcept -> commit_queue*;
+} // namespace irods::experimental::catalog
+
+#endif // IRODS_CATALOG_COMMIT_QUEUE_HPP
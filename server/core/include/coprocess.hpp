@@ -0,0 +1,124 @@
+#ifndef IRODS_COPROCESS_HPP
+#define IRODS_COPROCESS_HPP
+
+/// \file
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// A long-lived helper process which serves requests read from its standard input.
+///
+/// Plugins which delegate work to an external program (e.g. the univmss resource) can
+/// start the program once and send it many requests, instead of forking and executing
+/// it for every operation.
+///
+/// The standard input and output of the program are connected to a socket. Requests
+/// and responses are framed by their length:
+///
+/// \verbatim
+///     <length of payload in bytes, in decimal>\n<payload>
+/// \endverbatim
+///
+/// The payload of a request is the request ID, a space and the operation, followed by
+/// each argument on a line of its own:
+///
+/// \verbatim
+///     <id> <operation>\n<argument>\n<argument>...
+/// \endverbatim
+///
+/// The payload of a response is the ID of the request, a space and the status of the
+/// operation (0 on success), followed by the output of the operation, if any:
+///
+/// \verbatim
+///     <id> <status>\n<output>
+/// \endverbatim
+///
+/// Requests may be pipelined: more requests can be sent before the responses to earlier
+/// ones arrive, and the program may respond in any order. The program exits when its
+/// standard input is closed.
+///
+/// \since 4.3.0
+namespace irods
+{
+    class coprocess
+    {
+    public:
+        struct response
+        {
+            int status;
+            std::string output;
+        }; // struct response
+
+        /// Starts \p _program with the arguments \p _args.
+        ///
+        /// \throws irods::exception If the program cannot be started.
+        explicit coprocess(const std::string& _program, const std::vector<std::string>& _args = {});
+
+        coprocess(const coprocess&) = delete;
+        auto operator=(const coprocess&) -> coprocess& = delete;
+
+        /// Closes the standard input of the program and waits for it to exit. The
+        /// program is killed if it does not exit within a few seconds.
+        ~coprocess();
+
+        /// Sends a request without waiting for the response.
+        ///
+        /// \throws irods::exception If an argument contains a newline or the request
+        ///                          cannot be sent.
+        ///
+        /// \return The ID to pass to wait().
+        auto submit(std::string_view _operation, const std::vector<std::string>& _args) -> std::uint64_t;
+
+        /// Waits for the response to a request sent by submit().
+        ///
+        /// \throws irods::exception If the program exits or sends a malformed response.
+        auto wait(std::uint64_t _id) -> response;
+
+        /// Sends a request and waits for the response.
+        auto call(std::string_view _operation, const std::vector<std::string>& _args) -> response
+        {
+            return wait(submit(_operation, _args));
+        }
+
+        /// Returns false once the connection to the program has failed.
+        auto running() const noexcept -> bool { return fd_ >= 0; }
+
+        auto pid() const noexcept -> pid_t { return pid_; }
+
+        /// Returns whether the program was started by the calling process rather than
+        /// by a process it was forked from.
+        auto owned() const noexcept -> bool;
+
+        /// Forgets the program without waiting for it. Used by forked children, which
+        /// must leave the program of their parent alone.
+        auto release() noexcept -> void;
+
+    private:
+        auto fail(int _ec, const std::string& _msg) -> void;
+
+        auto read_available(bool _block) -> void;
+
+        pid_t owner_;
+        pid_t pid_;
+        int fd_;
+        std::uint64_t next_id_;
+        std::string in_;
+        std::map<std::uint64_t, response> responses_;
+    }; // class coprocess
+
+    /// Returns the coprocess running \p _program for the calling process, starting it
+    /// if it is not running.
+    ///
+    /// Each process gets its own coprocess. Coprocesses inherited across fork() are
+    /// replaced, and coprocesses which failed are restarted.
+    ///
+    /// \throws irods::exception If the program cannot be started.
+    auto get_coprocess(const std::string& _program) -> coprocess&;
+} // namespace irods
+
+#endif // IRODS_COPROCESS_HPP
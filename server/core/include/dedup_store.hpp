@@ -0,0 +1,238 @@
+#ifndef IRODS_DEDUP_STORE_HPP
+#define IRODS_DEDUP_STORE_HPP
+
+/// \file
+
+#include "thread_pool.hpp"
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Content-defined chunking and a content-addressed chunk store.
+///
+/// A file is cut into chunks at positions chosen by a rolling hash of its content,
+/// so an insertion or deletion only changes the chunks around it. Each chunk is
+/// stored once under the SHA-256 digest of its content, and the file is replaced
+/// by a manifest listing its chunks.
+///
+/// \since 4.3.0
+namespace irods::experimental::dedup
+{
+    using digest = std::array<unsigned char, 32>;
+
+    /// Returns the SHA-256 digest of \p _size bytes at \p _data.
+    auto hash(const void* _data, std::size_t _size) -> digest;
+
+    /// Returns \p _digest as lowercase hexadecimal.
+    auto to_hex(const digest& _digest) -> std::string;
+
+    struct chunking_parameters
+    {
+        std::size_t min_size = 16 * 1024;
+        std::size_t average_size = 64 * 1024;
+        std::size_t max_size = 256 * 1024;
+    }; // struct chunking_parameters
+
+    /// Finds chunk boundaries with a gear-based rolling hash, normalized so that the
+    /// sizes of the chunks gather around the average (FastCDC).
+    class chunker
+    {
+    public:
+        /// \throws irods::exception If the sizes are not increasing or the average
+        ///                          size is not a power of two.
+        explicit chunker(const chunking_parameters& _params);
+
+        /// Returns the size of the chunk which starts at \p _data.
+        ///
+        /// \p _size must be at least max_size() unless the data ends before that.
+        auto next(const unsigned char* _data, std::size_t _size) const noexcept -> std::size_t;
+
+        auto max_size() const noexcept -> std::size_t { return params_.max_size; }
+
+    private:
+        chunking_parameters params_;
+        std::uint64_t mask_small_;
+        std::uint64_t mask_large_;
+    }; // class chunker
+
+    struct store_statistics
+    {
+        /// The size of all files stored through manifests.
+        std::int64_t logical_bytes = 0;
+
+        /// The size of the chunks in the store.
+        std::int64_t stored_bytes = 0;
+
+        std::int64_t chunks = 0;
+
+        /// Bytes chunked and stored, and the time it took.
+        std::int64_t ingested_bytes = 0;
+        std::int64_t ingest_microseconds = 0;
+
+        /// Bytes read back through manifests, and the time it took.
+        std::int64_t read_bytes = 0;
+        std::int64_t read_microseconds = 0;
+
+        auto dedup_ratio() const noexcept -> double
+        {
+            return stored_bytes > 0 ? static_cast<double>(logical_bytes) / stored_bytes : 1.0;
+        }
+    }; // struct store_statistics
+
+    /// A directory of chunks named by their digests. Each chunk carries a count of
+    /// the manifests which refer to it and is removed when the count drops to zero.
+    ///
+    /// Any number of processes may use the same store at once.
+    class chunk_store
+    {
+    public:
+        explicit chunk_store(std::string _root);
+
+        auto root() const noexcept -> const std::string& { return root_; }
+
+        /// Returns the path of the file which holds the chunk \p _id.
+        auto path(const digest& _id) const -> std::string;
+
+        /// Adds a reference to the chunk \p _id, storing \p _data if the chunk is new.
+        ///
+        /// Returns true if the chunk was stored.
+        ///
+        /// \throws irods::exception
+        auto add(const digest& _id, const void* _data, std::size_t _size) -> bool;
+
+        /// Reads the chunk \p _id, which must hold \p _size bytes.
+        ///
+        /// \throws irods::exception
+        auto read(const digest& _id, std::size_t _size) const -> std::vector<char>;
+
+        /// Drops a reference to the chunk \p _id.
+        ///
+        /// Returns the size of the chunk if it was removed, and zero otherwise.
+        ///
+        /// \throws irods::exception
+        auto release(const digest& _id) -> std::int64_t;
+
+        /// Adds \p _delta to the statistics of the store and returns the result.
+        ///
+        /// \throws irods::exception
+        auto update_statistics(const store_statistics& _delta) -> store_statistics;
+
+        /// \throws irods::exception
+        auto statistics() const -> store_statistics;
+
+    private:
+        std::string root_;
+    }; // class chunk_store
+
+    struct manifest_entry
+    {
+        digest id;
+        std::uint32_t size;
+    }; // struct manifest_entry
+
+    struct manifest
+    {
+        std::int64_t size = 0;
+        std::vector<manifest_entry> entries;
+    }; // struct manifest
+
+    /// Reads the manifest at \p _path.
+    ///
+    /// Returns nothing if the file is not a manifest, e.g. a file registered in
+    /// place, which is then read as it is.
+    ///
+    /// \throws irods::exception If the file cannot be read.
+    auto read_manifest(const std::string& _path) -> std::optional<manifest>;
+
+    /// Returns the size of the file described by the manifest at \p _path, or
+    /// nothing if the file is not a manifest.
+    ///
+    /// \throws irods::exception If the file cannot be read.
+    auto read_manifest_size(const std::string& _path) -> std::optional<std::int64_t>;
+
+    /// Replaces the file at \p _path with \p _manifest.
+    ///
+    /// \throws irods::exception
+    auto write_manifest(const std::string& _path, const manifest& _manifest, int _mode) -> void;
+
+    struct ingest_result
+    {
+        manifest file;
+        std::int64_t new_bytes = 0;
+        std::int64_t new_chunks = 0;
+    }; // struct ingest_result
+
+    /// Chunks the file open at \p _fd and adds its chunks to \p _store.
+    ///
+    /// If an error occurs, the references already added are dropped.
+    ///
+    /// \throws irods::exception
+    auto ingest(chunk_store& _store, const chunker& _chunker, int _fd) -> ingest_result;
+
+    /// Drops the references of \p _manifest and updates the statistics of the store.
+    /// Errors are logged.
+    auto release(chunk_store& _store, const manifest& _manifest) -> void;
+
+    /// Writes the content described by \p _manifest to \p _fd.
+    ///
+    /// \throws irods::exception
+    auto reassemble(const chunk_store& _store, const manifest& _manifest, int _fd) -> void;
+
+    /// Reads the content described by a manifest, loading the chunks after the one
+    /// being read on a thread pool.
+    class manifest_reader
+    {
+    public:
+        /// \param[in] _threads The number of threads which load chunks.
+        /// \param[in] _window  The number of chunks loaded ahead of the one being read.
+        manifest_reader(chunk_store _store, manifest _manifest, int _threads, std::size_t _window);
+
+        manifest_reader(const manifest_reader&) = delete;
+        auto operator=(const manifest_reader&) -> manifest_reader& = delete;
+
+        ~manifest_reader();
+
+        auto size() const noexcept -> std::int64_t { return manifest_.size; }
+
+        /// Reads up to \p _size bytes at \p _offset into \p _buffer.
+        ///
+        /// Returns the number of bytes read, which is less than \p _size only at the
+        /// end of the content.
+        ///
+        /// \throws irods::exception If a chunk cannot be read.
+        auto read(std::int64_t _offset, void* _buffer, std::size_t _size) -> std::size_t;
+
+        /// The number of bytes returned by read() and the time spent in it.
+        auto bytes_read() const noexcept -> std::int64_t { return bytes_read_; }
+        auto microseconds() const noexcept -> std::int64_t { return microseconds_; }
+
+    private:
+        using chunk_data = std::shared_ptr<const std::vector<char>>;
+
+        auto chunk_at(std::int64_t _offset) const -> std::size_t;
+
+        // Schedules the loads of the chunks in [_first, _first + window) and forgets
+        // the chunks outside of it.
+        auto prefetch(std::size_t _first) -> void;
+
+        chunk_store store_;
+        manifest manifest_;
+        std::vector<std::int64_t> offsets_;
+        std::size_t window_;
+        std::map<std::size_t, std::shared_future<chunk_data>> loaded_;
+        std::int64_t bytes_read_;
+        std::int64_t microseconds_;
+
+        // Declared last so that the threads stop before the members they use are
+        // destroyed.
+        irods::thread_pool pool_;
+    }; // class manifest_reader
+} // namespace irods::experimental::dedup
+
+#endif // IRODS_DEDUP_STORE_HPP
@@ -0,0 +1,70 @@
+#ifndef IRODS_DIRECT_IO_HPP
+#define IRODS_DIRECT_IO_HPP
+
+/// \file
+
+#include "io_engine.hpp"
+#include "rodsType.h"
+
+/// Large-block I/O that bypasses the page cache.
+///
+/// A file is accessed through two descriptors: the regular descriptor, which owns
+/// the file position, and a companion descriptor opened with O_DIRECT. For each
+/// large request, the block-aligned middle section goes through the companion
+/// descriptor and the unaligned head and tail go through the page cache. Small
+/// requests only use the page cache.
+///
+/// All functions return a non-negative value on success, or a negative errno value
+/// on failure.
+namespace irods::direct_io
+{
+    /// \since 4.3.0
+    struct config
+    {
+        bool enabled = false;
+
+        /// The alignment required by the device for offsets, lengths and memory.
+        /// Must be a power of two.
+        rodsLong_t alignment = 4096;
+
+        /// Requests smaller than this always go through the page cache.
+        rodsLong_t minimum_size = 1024 * 1024;
+    }; // struct config
+
+    /// Opens a companion O_DIRECT descriptor for an already opened file.
+    ///
+    /// \param[in] _path  The path of the file.
+    /// \param[in] _flags The flags used to open the regular descriptor. Only the access
+    ///                   mode is honored.
+    ///
+    /// \return The companion descriptor.
+    ///
+    /// \since 4.3.0
+    auto open_companion(const char* _path, int _flags) -> int;
+
+    /// Reads up to \p _length bytes from the current file position of \p _fd.
+    ///
+    /// The file position of \p _fd is advanced by the number of bytes read.
+    ///
+    /// \since 4.3.0
+    auto read(const config& _config,
+              const io_engine::config& _io_config,
+              int _fd,
+              int _direct_fd,
+              void* _buffer,
+              rodsLong_t _length) -> rodsLong_t;
+
+    /// Writes \p _length bytes at the current file position of \p _fd.
+    ///
+    /// The file position of \p _fd is advanced by the number of bytes written.
+    ///
+    /// \since 4.3.0
+    auto write(const config& _config,
+               const io_engine::config& _io_config,
+               int _fd,
+               int _direct_fd,
+               const void* _buffer,
+               rodsLong_t _length) -> rodsLong_t;
+} // namespace irods::direct_io
+
+#endif // IRODS_DIRECT_IO_HPP
@@ -0,0 +1,107 @@
+#ifndef IRODS_IO_ENGINE_HPP
+#define IRODS_IO_ENGINE_HPP
+
+/// \file
+
+#include "rodsType.h"
+
+#include <cstddef>
+#include <string>
+
+/// Block I/O backends for storage resources that operate on POSIX file descriptors.
+///
+/// A single read or write request that is larger than the configured request size
+/// is split into request-sized pieces. The pieces are submitted together so that the
+/// device sees a queue depth greater than one. Requests that fit in a single piece
+/// are always serviced by a plain read(2) or write(2).
+///
+/// All functions return the number of bytes transferred, or a negative errno value
+/// on failure.
+namespace irods::io_engine
+{
+    /// The backend used to service large requests.
+    ///
+    /// \since 4.3.0
+    enum class engine_type
+    {
+        posix,       ///< One blocking system call per request. This is the default.
+        io_uring,    ///< Linux io_uring. Falls back to thread_pool if unavailable.
+        thread_pool  ///< Pieces are serviced by a pool of queue_depth threads.
+    }; // enum class engine_type
+
+    /// Describes how requests are to be serviced.
+    ///
+    /// \since 4.3.0
+    struct config
+    {
+        engine_type type = engine_type::posix;
+
+        /// The maximum number of pieces in flight for a single request.
+        int queue_depth = 8;
+
+        /// The size of each piece in bytes.
+        rodsLong_t request_size = 1024 * 1024;
+    }; // struct config
+
+    /// Converts \p _name ("posix", "io_uring" or "thread_pool") to an engine_type.
+    ///
+    /// \throws irods::exception If \p _name does not name a supported engine.
+    ///
+    /// \since 4.3.0
+    auto to_engine_type(const std::string& _name) -> engine_type;
+
+    /// Returns whether io_uring can be used by the calling thread.
+    ///
+    /// \since 4.3.0
+    auto io_uring_available() -> bool;
+
+    /// Reads up to \p _length bytes from the current file position of \p _fd.
+    ///
+    /// The file position is advanced by the number of bytes read.
+    ///
+    /// \since 4.3.0
+    auto read(const config& _config, int _fd, void* _buffer, rodsLong_t _length) -> rodsLong_t;
+
+    /// Writes \p _length bytes at the current file position of \p _fd.
+    ///
+    /// The file position is advanced by the number of bytes written.
+    ///
+    /// \since 4.3.0
+    auto write(const config& _config, int _fd, const void* _buffer, rodsLong_t _length) -> rodsLong_t;
+
+    /// Reads up to \p _length bytes starting at \p _offset. The file position is not modified.
+    ///
+    /// \since 4.3.0
+    auto pread(const config& _config, int _fd, void* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t;
+
+    /// Writes \p _length bytes starting at \p _offset. The file position is not modified.
+    ///
+    /// \since 4.3.0
+    auto pwrite(const config& _config, int _fd, const void* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t;
+
+    /// Registers a long-lived transfer buffer with the I/O engine of the calling thread.
+    ///
+    /// While an instance is alive, io_uring requests that target memory inside the
+    /// buffer use pre-registered (fixed) buffers, which saves the kernel from mapping
+    /// the pages on every request. Engines other than io_uring ignore registrations.
+    ///
+    /// Instances must be destroyed on the thread that created them and before the
+    /// buffer is released.
+    ///
+    /// \since 4.3.0
+    class registered_buffer
+    {
+    public:
+        registered_buffer(void* _buffer, std::size_t _size);
+
+        registered_buffer(const registered_buffer&) = delete;
+        auto operator=(const registered_buffer&) -> registered_buffer& = delete;
+
+        ~registered_buffer();
+
+    private:
+        void* buffer_;
+    }; // class registered_buffer
+} // namespace irods::io_engine
+
+#endif // IRODS_IO_ENGINE_HPP
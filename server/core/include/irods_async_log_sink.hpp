@@ -0,0 +1,313 @@
+#ifndef IRODS_ASYNC_LOG_SINK_HPP
+#define IRODS_ASYNC_LOG_SINK_HPP
+
+/// \file
+
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace irods::experimental
+{
+    /// A bounded, lock-free queue which supports any number of producers and consumers.
+    ///
+    /// Each slot carries a sequence number which tells producers and consumers whether
+    /// the slot is ready for them, so neither side ever takes a lock. The capacity is
+    /// rounded up to the next power of two.
+    ///
+    /// \since 4.3.0
+    template <typename T>
+    class mpmc_ring_buffer
+    {
+    public:
+        explicit mpmc_ring_buffer(std::size_t _capacity)
+            : cells_{}
+            , mask_{round_up_to_power_of_two(_capacity) - 1}
+            , enqueue_pos_{0}
+            , dequeue_pos_{0}
+        {
+            cells_.reset(new cell[mask_ + 1]);
+
+            for (std::size_t i = 0; i <= mask_; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpmc_ring_buffer(const mpmc_ring_buffer&) = delete;
+        auto operator=(const mpmc_ring_buffer&) -> mpmc_ring_buffer& = delete;
+
+        /// Moves \p _value into the buffer.
+        ///
+        /// \return A boolean indicating whether the value was added. \p _value is left
+        ///         untouched if the buffer is full.
+        auto try_push(T& _value) -> bool
+        {
+            cell* c;
+            auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+
+            while (true) {
+                c = &cells_[pos & mask_];
+                const auto seq = c->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+                if (0 == diff) {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+
+            c->value = std::move(_value);
+            c->sequence.store(pos + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /// Moves the oldest value in the buffer into \p _value.
+        ///
+        /// \return A boolean indicating whether a value was removed.
+        auto try_pop(T& _value) -> bool
+        {
+            cell* c;
+            auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+
+            while (true) {
+                c = &cells_[pos & mask_];
+                const auto seq = c->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+
+                if (0 == diff) {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = dequeue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+
+            _value = std::move(c->value);
+            c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        auto capacity() const noexcept -> std::size_t
+        {
+            return mask_ + 1;
+        }
+
+    private:
+        static auto round_up_to_power_of_two(std::size_t _n) noexcept -> std::size_t
+        {
+            std::size_t n = 2;
+
+            while (n < _n) {
+                n <<= 1;
+            }
+
+            return n;
+        }
+
+        // Each cell occupies its own cache line(s) so that producers and consumers
+        // working on neighboring cells do not contend.
+        struct alignas(64) cell
+        {
+            std::atomic<std::size_t> sequence;
+            T value;
+        }; // struct cell
+
+        std::unique_ptr<cell[]> cells_;
+        const std::size_t mask_;
+
+        alignas(64) std::atomic<std::size_t> enqueue_pos_;
+        alignas(64) std::atomic<std::size_t> dequeue_pos_;
+    }; // class mpmc_ring_buffer
+
+    /// A log message waiting to be written.
+    ///
+    /// \since 4.3.0
+    struct log_entry
+    {
+        spdlog::level::level_enum level = spdlog::level::info;
+        std::chrono::system_clock::time_point time;
+        std::string message;
+    }; // struct log_entry
+
+    /// The destination of an async_log_sink.
+    ///
+    /// Targets are only ever used by the background thread of the sink that owns them,
+    /// so they do not need to be thread-safe.
+    ///
+    /// \since 4.3.0
+    class log_target
+    {
+    public:
+        virtual ~log_target() = default;
+
+        /// Writes \p _count entries, as efficiently as the destination allows.
+        virtual auto write(const log_entry* _entries, std::size_t _count) -> void = 0;
+
+        virtual auto flush() -> void {}
+    }; // class log_target
+
+    /// Sends messages to the local syslog daemon (e.g. rsyslog).
+    ///
+    /// A batch of messages is sent with a single sendmmsg() call over a connection to
+    /// /dev/log. The messages use the same format, facility (LOG_LOCAL0) and identity
+    /// as the synchronous syslog sink. If the daemon cannot be reached, the batch is
+    /// passed to syslog() one message at a time instead.
+    ///
+    /// \since 4.3.0
+    class syslog_log_target : public log_target
+    {
+    public:
+        syslog_log_target();
+
+        syslog_log_target(const syslog_log_target&) = delete;
+        auto operator=(const syslog_log_target&) -> syslog_log_target& = delete;
+
+        ~syslog_log_target();
+
+        auto write(const log_entry* _entries, std::size_t _count) -> void override;
+
+    private:
+        auto connect() -> bool;
+        auto disconnect() -> void;
+        auto send(const log_entry* _entries, std::size_t _count) -> bool;
+
+        int socket_;
+        std::vector<std::string> datagrams_;
+    }; // class syslog_log_target
+
+    /// Appends messages to a file, one per line, bypassing syslog entirely.
+    ///
+    /// Each batch is written with a single write() call. The file is opened with
+    /// O_APPEND, so several processes may share it.
+    ///
+    /// \since 4.3.0
+    class file_log_target : public log_target
+    {
+    public:
+        /// \throws std::system_error If the file cannot be opened.
+        explicit file_log_target(const std::string& _path);
+
+        file_log_target(const file_log_target&) = delete;
+        auto operator=(const file_log_target&) -> file_log_target& = delete;
+
+        ~file_log_target();
+
+        auto write(const log_entry* _entries, std::size_t _count) -> void override;
+
+    private:
+        int fd_;
+        std::string buffer_;
+    }; // class file_log_target
+
+    /// A sink which hands messages to a background thread instead of writing them.
+    ///
+    /// Logging only costs the caller a copy of the message and a push onto a lock-free
+    /// ring buffer. The background thread drains the buffer in batches and passes each
+    /// batch to the log_target.
+    ///
+    /// The background thread is stopped before the process forks (after writing every
+    /// message logged so far) and restarted in both the parent and the child, so the
+    /// sink keeps working in forked agents.
+    ///
+    /// \since 4.3.0
+    class async_log_sink : public spdlog::sinks::sink
+    {
+    public:
+        /// Defines what happens to a message logged while the ring buffer is full.
+        enum class overflow_policy
+        {
+            /// The message is discarded. The number of discarded messages is reported
+            /// through the target once there is space again.
+            drop,
+
+            /// The caller waits until the background thread frees up a slot.
+            block
+        }; // enum class overflow_policy
+
+        /// The maximum number of messages handed to the target at once.
+        static constexpr std::size_t max_batch_size = 256;
+
+        /// \param[in] _target   The destination of the messages.
+        /// \param[in] _capacity The number of messages the background thread can fall
+        ///                      behind by.
+        /// \param[in] _policy   Defines what happens when the ring buffer is full.
+        async_log_sink(std::unique_ptr<log_target> _target, std::size_t _capacity, overflow_policy _policy);
+
+        async_log_sink(const async_log_sink&) = delete;
+        auto operator=(const async_log_sink&) -> async_log_sink& = delete;
+
+        /// Writes every message still in the ring buffer before returning.
+        ~async_log_sink();
+
+        auto log(const spdlog::details::log_msg& _msg) -> void override;
+
+        /// Waits until every message logged before the call has been written.
+        auto flush() -> void override;
+
+        // Messages are written as-is, so there is nothing to format.
+        auto set_pattern(const std::string&) -> void override {}
+        auto set_formatter(std::unique_ptr<spdlog::formatter>) -> void override {}
+
+        /// Returns the number of messages discarded so far under overflow_policy::drop.
+        auto dropped() const noexcept -> std::uint64_t;
+
+    private:
+        auto start() -> void;
+        auto stop() -> void;
+        auto run() -> void;
+        auto wake_worker() -> void;
+        auto report_dropped_messages() -> void;
+        auto discard_pending_messages() -> void;
+
+        static auto register_fork_handlers() -> void;
+        static auto prepare_fork() -> void;
+        static auto after_fork_in_parent() -> void;
+        static auto after_fork_in_child() -> void;
+
+        const std::unique_ptr<log_target> target_;
+        const overflow_policy policy_;
+        mpmc_ring_buffer<log_entry> buffer_;
+
+        // The worker sleeps on the condition variable when the buffer is empty.
+        // Producers only take the mutex if the worker has announced that it is asleep.
+        std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::condition_variable written_;
+        std::atomic<bool> worker_sleeping_;
+        std::atomic<int> flush_waiters_;
+        bool stop_requested_;
+        std::thread worker_;
+
+        // The number of messages added to and removed from the ring buffer.
+        std::atomic<std::uint64_t> pushed_;
+        std::atomic<std::uint64_t> processed_;
+        std::atomic<std::uint64_t> dropped_;
+        std::uint64_t dropped_reported_;
+    }; // class async_log_sink
+} // namespace irods::experimental
+
+#endif // IRODS_ASYNC_LOG_SINK_HPP
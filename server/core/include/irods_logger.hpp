@@ -15,6 +15,7 @@
 #include <iomanip>
 #include <sstream>
 #include <chrono>
+#include <cstddef>
 
 #ifdef IRODS_ENABLE_SYSLOG
     #define SPDLOG_ENABLE_SYSLOG
@@ -64,6 +65,27 @@ namespace irods::experimental
             struct rule_engine {};
         }; // struct category
 
+        /// Defines where messages are written and whether callers wait for them.
+        ///
+        /// \since 4.3.0
+        struct sink_config
+        {
+            /// Messages are appended to this file instead of being sent to syslog.
+            /// Ignored when empty or when writing to stdout.
+            std::string file;
+
+            /// If true, messages are handed to a background thread which writes them
+            /// in batches. Otherwise, the caller writes each message itself.
+            bool asynchronous = false;
+
+            /// The number of messages the background thread can fall behind by.
+            std::size_t buffer_size = 8192;
+
+            /// If true, callers wait for space when the buffer is full. Otherwise,
+            /// the message is dropped (and the number of dropped messages is logged).
+            bool block_when_full = false;
+        }; // struct sink_config
+
         template <typename Category> class logger_config;
         template <typename Category> class logger;
 
@@ -88,8 +110,10 @@ namespace irods::experimental
         log& operator=(const log&) = delete;
 
         static void init(bool _write_to_stdout = false, bool _enable_test_mode = false) noexcept;
+        static void init(bool _write_to_stdout, bool _enable_test_mode, const sink_config& _sink_config) noexcept;
         static auto to_level(const std::string& _level) -> level;
         static auto get_level_from_config(const std::string& _category) -> level;
+        static auto get_sink_config_from_config() -> sink_config;
         static void set_error_object(rError_t* _error) noexcept;
         static void write_to_error_object(bool _value) noexcept;
         static void set_request_api_number(int _api_number) noexcept;
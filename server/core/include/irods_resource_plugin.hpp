@@ -39,6 +39,9 @@ namespace irods {
                 properties_.set(
                     RESC_PARENT_PROP,
                     parent_ );
+
+                // trace every operation, including those invoked by parent resources
+                span_name_prefix_ = "plugin:";
             } // ctor
 
             // =-=-=-=-=-=-=-
@@ -0,0 +1,89 @@
+#ifndef IRODS_L1DESC_TABLE_HPP
+#define IRODS_L1DESC_TABLE_HPP
+
+/// \file
+
+#include "objDesc.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace irods
+{
+    /// A growable table of L1 descriptors.
+    ///
+    /// Descriptors are stored in fixed-size blocks that are never moved, so an index
+    /// (and any reference obtained through it) stays valid for as long as the agent
+    /// runs. Free indices are kept on a free list, which makes allocation and release
+    /// constant-time operations.
+    ///
+    /// The table is owned by a single agent and is only accessed by the thread that
+    /// services API requests, so no synchronization is performed.
+    ///
+    /// \since 4.3.0
+    class l1desc_table
+    {
+    public:
+        /// Indices below this value are reserved and never handed out.
+        static constexpr int first_index = 3;
+
+        /// The number of descriptors in each block.
+        static constexpr int block_size = 256;
+
+        /// The table never grows beyond this many descriptors.
+        static constexpr int max_size = 64 * 1024;
+
+        /// Creates a table that can hold at least \p _initial_size descriptors without growing.
+        explicit l1desc_table(int _initial_size);
+
+        l1desc_table(const l1desc_table&) = delete;
+        auto operator=(const l1desc_table&) -> l1desc_table& = delete;
+
+        /// Returns the descriptor at \p _index. The index must be less than size().
+        auto operator[](int _index) noexcept -> l1desc_t&
+        {
+            return blocks_[_index / block_size][_index % block_size];
+        }
+
+        auto operator[](int _index) const noexcept -> const l1desc_t&
+        {
+            return blocks_[_index / block_size][_index % block_size];
+        }
+
+        /// Returns the number of addressable descriptors, including the reserved ones.
+        auto size() const noexcept -> int
+        {
+            return static_cast<int>(blocks_.size()) * block_size;
+        }
+
+        /// Returns whether \p _index refers to a descriptor that can be handed out.
+        auto is_valid_index(int _index) const noexcept -> bool
+        {
+            return _index >= first_index && _index < size();
+        }
+
+        /// Marks a free descriptor as in use and returns its index.
+        ///
+        /// \return The index of the descriptor, or SYS_OUT_OF_FILE_DESC if the table
+        ///         cannot grow any further.
+        auto allocate() -> int;
+
+        /// Returns \p _index to the free list.
+        ///
+        /// The caller is responsible for resetting the descriptor first.
+        auto release(int _index) -> void;
+
+        /// Resets every descriptor, shrinks the table to its initial size and rebuilds
+        /// the free list.
+        auto reset() -> void;
+
+    private:
+        auto grow() -> bool;
+
+        const int initial_blocks_;
+        std::vector<std::unique_ptr<l1desc_t[]>> blocks_;
+        std::vector<int> free_list_;
+    }; // class l1desc_table
+} // namespace irods
+
+#endif // IRODS_L1DESC_TABLE_HPP
@@ -20,7 +20,7 @@
 
 #include <string>
 
-#define NUM_L1_DESC     1026    /* number of L1Desc */
+#define NUM_L1_DESC     1026    /* initial number of L1Desc. the table grows on demand */
 
 #define CHK_ORPHAN_CNT_LIMIT  20  /* number of failed check before stopping */
 /* definition for getNumThreads */
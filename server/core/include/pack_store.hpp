@@ -0,0 +1,237 @@
+#ifndef IRODS_PACK_STORE_HPP
+#define IRODS_PACK_STORE_HPP
+
+/// \file
+
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Log-structured containers holding many small objects.
+///
+/// Objects are appended to the newest container of a directory as records
+/// carrying their key, so millions of small writes become sequential appends to
+/// a handful of large files. Removing an object appends a tombstone. When a
+/// container grows past its maximum size it is sealed by appending an index of
+/// its records, and a new container is started. Sealed containers which are
+/// mostly dead are compacted by copying their live records to the newest
+/// container and removing them.
+///
+/// A container is laid out as follows. All integers are little-endian.
+///
+///   [records: magic (u32), type (u32), key size (u32), header crc (u32),
+///             data size (u64), data crc (u32), reserved (u32), key, data]
+///   [once sealed, an index record whose data lists every record before it:
+///             count (u64), then for every record: type (u32), key size (u32),
+///             record offset (u64), data size (u64), key]
+///   [once sealed, a trailer: index record offset (u64), index record size (u64),
+///             16-byte magic]
+///
+/// \since 4.3.0
+namespace irods::experimental::pack
+{
+    struct pack_parameters
+    {
+        /// A container is sealed once the next record would take it past this size.
+        std::uint64_t max_container_size = 256 * 1024 * 1024;
+
+        /// The fraction of dead bytes at which a sealed container is compacted.
+        double compaction_threshold = 0.5;
+
+        /// Flush every record to disk before the append returns.
+        bool sync = false;
+    }; // struct pack_parameters
+
+    /// Where the content of an object lies.
+    struct location
+    {
+        std::uint64_t container = 0;
+
+        /// The offset of the content in the container.
+        std::uint64_t offset = 0;
+
+        std::uint64_t size = 0;
+    }; // struct location
+
+    struct store_statistics
+    {
+        std::int64_t containers = 0;
+        std::int64_t objects = 0;
+
+        /// The size of the records which hold the content of the objects.
+        std::int64_t live_bytes = 0;
+
+        /// The size of all records, including overwritten content and tombstones.
+        std::int64_t total_bytes = 0;
+
+        auto dead_ratio() const noexcept -> double
+        {
+            return total_bytes > 0 ? 1.0 - static_cast<double>(live_bytes) / total_bytes : 0.0;
+        }
+    }; // struct store_statistics
+
+    /// The containers of a directory and an index of the objects they hold.
+    ///
+    /// Any number of processes may use the same directory at once. Appends are
+    /// serialized with a lock file, and every operation first reads the records
+    /// appended by other processes since the last one.
+    ///
+    /// Thread-safe.
+    class pack_store
+    {
+    public:
+        /// Reads the containers in \p _directory, creating it if necessary.
+        ///
+        /// \throws irods::exception
+        pack_store(std::string _directory, pack_parameters _params);
+
+        pack_store(const pack_store&) = delete;
+        auto operator=(const pack_store&) -> pack_store& = delete;
+
+        ~pack_store();
+
+        auto directory() const noexcept -> const std::string& { return directory_; }
+
+        auto container_path(std::uint64_t _container) const -> std::string;
+
+        /// Appends the content of the object \p _key, replacing its previous content.
+        ///
+        /// \throws irods::exception
+        auto put(const std::string& _key, const void* _data, std::size_t _size) -> location;
+
+        /// Appends a tombstone for the object \p _key.
+        ///
+        /// Returns false if the store does not hold the object.
+        ///
+        /// \throws irods::exception
+        auto remove(const std::string& _key) -> bool;
+
+        /// Moves the content of the object \p _from to \p _to.
+        ///
+        /// Returns false if the store does not hold \p _from.
+        ///
+        /// \throws irods::exception
+        auto rename(const std::string& _from, const std::string& _to) -> bool;
+
+        /// \throws irods::exception
+        auto find(const std::string& _key) -> std::optional<location>;
+
+        /// Reads the content at \p _location.
+        ///
+        /// \throws irods::exception With UNIX_FILE_OPEN_ERR - ENOENT if the container
+        ///                          was removed by a compaction. Call reload() and
+        ///                          find the object again.
+        auto read(const location& _location) const -> std::vector<char>;
+
+        /// Forgets the index and reads every container again.
+        ///
+        /// \throws irods::exception
+        auto reload() -> void;
+
+        /// Compacts the sealed containers whose fraction of dead bytes reached the
+        /// threshold, oldest first. Returns the number of bytes reclaimed.
+        ///
+        /// Tombstones only count as dead in the oldest container. Elsewhere they
+        /// may still hide content in an older container and are carried over.
+        ///
+        /// \throws irods::exception
+        auto compact() -> std::int64_t;
+
+        /// Compacts \p _container regardless of the threshold. The newest container
+        /// and containers which are not sealed are left alone.
+        ///
+        /// Returns the number of bytes reclaimed.
+        ///
+        /// \throws irods::exception
+        auto compact(std::uint64_t _container) -> std::int64_t;
+
+        /// \throws irods::exception
+        auto statistics() -> store_statistics;
+
+    private:
+        struct container
+        {
+            // The end of the last record read.
+            std::uint64_t end = 0;
+
+            std::uint64_t total_bytes = 0;
+            std::uint64_t live_bytes = 0;
+            std::uint64_t tombstone_bytes = 0;
+            bool sealed = false;
+        }; // struct container
+
+        struct record
+        {
+            std::uint32_t type = 0;
+            std::string key;
+            std::uint64_t offset = 0;
+            std::uint64_t data_size = 0;
+        }; // struct record
+
+        // Reads the records appended since the last call. The caller holds mutex_
+        // and the lock file.
+        auto catch_up() -> void;
+
+        // Reads the records of _id from its end.
+        auto load(std::uint64_t _id, container& _container) -> void;
+
+        // Calls _func for every record in [_from, _size) of the container open at
+        // _fd. Returns the end of the last complete record, and whether the
+        // container is sealed.
+        auto scan(int _fd,
+                  std::uint64_t _from,
+                  std::uint64_t _size,
+                  const std::function<void(const record&)>& _func) const -> std::pair<std::uint64_t, bool>;
+
+        // Reads the records of a sealed container from its index. Returns false if
+        // the container has no valid trailer.
+        auto read_index(int _fd, std::uint64_t _size, const std::function<void(const record&)>& _func) const
+            -> bool;
+
+        // Updates the index with a record of container _id. Returns the container
+        // which lost the previous content of the key, if any.
+        auto apply(std::uint64_t _id, const record& _record) -> std::optional<std::uint64_t>;
+
+        // Appends a record to the newest container, starting a new one when it is
+        // full. The caller holds mutex_ and the lock file.
+        auto append(std::uint32_t _type, const std::string& _key, const void* _data, std::size_t _size)
+            -> std::optional<std::uint64_t>;
+
+        auto seal(std::uint64_t _id, container& _container) -> void;
+
+        auto open_active(std::uint64_t _id) -> int;
+
+        auto compact_locked(std::uint64_t _id) -> std::int64_t;
+
+        auto needs_compaction(std::uint64_t _id) const -> bool;
+
+        // Compacts on the background thread unless a compaction is pending.
+        auto compact_in_background() -> void;
+
+        std::string directory_;
+        pack_parameters params_;
+        int lock_fd_;
+        int active_fd_;
+        std::uint64_t active_id_;
+
+        std::map<std::uint64_t, container> containers_;
+        std::unordered_map<std::string, location> index_;
+
+        std::mutex mutex_;
+        std::atomic<bool> compaction_pending_;
+
+        // Declared last so that the thread stops before the members it uses are
+        // destroyed.
+        irods::thread_pool pool_;
+    }; // class pack_store
+} // namespace irods::experimental::pack
+
+#endif // IRODS_PACK_STORE_HPP
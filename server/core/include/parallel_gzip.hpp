@@ -0,0 +1,114 @@
+#ifndef IRODS_PARALLEL_GZIP_HPP
+#define IRODS_PARALLEL_GZIP_HPP
+
+/// \file
+
+#include "thread_pool.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// Compression of a stream into the gzip format on several threads.
+///
+/// The input is cut into blocks which are deflated independently, each primed with
+/// the last 32 KiB of the block before it so that little compression is lost. The
+/// compressed blocks are joined into a single gzip member, so the output can be read
+/// by any gzip decoder.
+///
+/// \since 4.3.0
+namespace irods::experimental::gzip
+{
+    /// Receives the compressed stream. Called on the thread which writes to the
+    /// writer, in the order of the stream, and not before the first block of the
+    /// stream is compressed.
+    ///
+    /// Must throw to report an error.
+    using sink_function = std::function<void(const void* _data, std::size_t _size)>;
+
+    class parallel_writer
+    {
+    public:
+        /// The size of the blocks the input is cut into.
+        static constexpr std::size_t default_block_size = 128 * 1024;
+
+        /// \param[in] _sink       Receives the compressed stream.
+        /// \param[in] _threads    The number of threads which compress blocks.
+        /// \param[in] _level      The zlib compression level.
+        /// \param[in] _block_size The size of the blocks the input is cut into.
+        parallel_writer(sink_function _sink,
+                        int _threads,
+                        int _level = -1,
+                        std::size_t _block_size = default_block_size);
+
+        parallel_writer(const parallel_writer&) = delete;
+        auto operator=(const parallel_writer&) -> parallel_writer& = delete;
+
+        /// Waits for the threads to stop. A stream which was not closed is incomplete.
+        ~parallel_writer();
+
+        /// Appends \p _size bytes to the stream.
+        ///
+        /// \throws irods::exception If a block could not be compressed.
+        /// \throws Anything the sink throws.
+        auto write(const void* _data, std::size_t _size) -> void;
+
+        /// Compresses the rest of the stream and writes the gzip trailer.
+        ///
+        /// \throws irods::exception If a block could not be compressed.
+        /// \throws Anything the sink throws.
+        auto close() -> void;
+
+        /// The number of bytes written to the writer.
+        auto bytes_in() const noexcept -> std::uint64_t { return bytes_in_; }
+
+        /// The number of bytes passed to the sink.
+        auto bytes_out() const noexcept -> std::uint64_t { return bytes_out_; }
+
+    private:
+        struct block
+        {
+            std::vector<char> input;
+            std::vector<char> dictionary;
+            std::vector<char> output;
+            unsigned long crc = 0;
+            bool last = false;
+            bool done = false;
+            int error = 0;
+        }; // struct block
+
+        auto submit(bool _last) -> void;
+
+        // Passes the compressed blocks at the front of the queue to the sink. Waits
+        // until the queue holds at most _max_pending blocks.
+        auto drain(std::size_t _max_pending) -> void;
+
+        auto emit(const void* _data, std::size_t _size) -> void;
+
+        sink_function sink_;
+        int level_;
+        std::size_t block_size_;
+        std::size_t max_pending_;
+
+        std::shared_ptr<block> current_;
+        std::deque<std::shared_ptr<block>> pending_;
+
+        unsigned long crc_;
+        std::uint64_t bytes_in_;
+        std::uint64_t bytes_out_;
+        bool closed_;
+
+        std::mutex mutex_;
+        std::condition_variable done_;
+
+        // Declared last so that the threads stop before the members they use are
+        // destroyed.
+        irods::thread_pool pool_;
+    }; // class parallel_writer
+} // namespace irods::experimental::gzip
+
+#endif // IRODS_PARALLEL_GZIP_HPP
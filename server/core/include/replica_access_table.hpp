@@ -3,6 +3,7 @@
 
 /// \file
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 #include <stdexcept>
@@ -29,6 +30,11 @@ namespace irods::experimental
     /// the iRODS streaming operations and voting mechanisms to control multi-process
     /// write access to a single replica.
     ///
+    /// Entries are spread across a fixed number of shards, each guarded by its own lock,
+    /// so that agents working on different replicas rarely contend with one another. An
+    /// entry is placed in the shard selected by its (data id, replica number) tuple, and
+    /// the shard is also encoded in the replica token.
+    ///
     /// \since 4.2.9
     class replica_access_table
     {
@@ -40,6 +46,11 @@ namespace irods::experimental
         using replica_number_type     = std::uint32_t;
         // clang-format on
 
+        /// The size of the shared memory segment used when no size is passed to init().
+        ///
+        /// \since 4.3.0
+        static constexpr std::size_t default_segment_size = 8 * 1024 * 1024;
+
         /// A class that is used to restore previously removed entries.
         ///
         /// \see erase_pid(replica_token_view_type, pid_t)
@@ -70,7 +81,9 @@ namespace irods::experimental
         ///
         /// While calling deinit() is preferred, it is not necessary since this function
         /// will delete any memory used by a previous instance of the process.
-        static auto init() noexcept -> void;
+        ///
+        /// \param[in] _segment_size The size of the shared memory segment in bytes.
+        static auto init(std::size_t _segment_size = default_segment_size) noexcept -> void;
 
         /// Cleans up any memory previously allocated by calling init().
         static auto deinit() noexcept -> void;
@@ -88,6 +101,7 @@ namespace irods::experimental
         /// \param[in] _pid            The process id of the agent handling the request.
         ///
         /// \throws replica_access_table_error If an entry exists matching the arguments.
+        /// \throws replica_access_table_error If the table is full.
         ///
         /// \return A newly generated replica token.
         auto create_new_entry(data_id_type _data_id,
@@ -103,6 +117,7 @@ namespace irods::experimental
         ///
         /// \throws replica_access_table_error If the token is invalid.
         /// \throws replica_access_table_error If the data id and/or replica number are invalid.
+        /// \throws replica_access_table_error If the table is full.
         auto append_pid(replica_token_view_type _token,
                         data_id_type _data_id,
                         replica_number_type _replica_number,
@@ -147,11 +162,22 @@ namespace irods::experimental
         /// \param[in] _pid The PID to remove.
         auto erase_pid(pid_t _pid) -> void;
 
+        /// Removes every PID belonging to a process that no longer exists.
+        ///
+        /// This is done automatically when the table runs out of memory.
+        ///
+        /// \return The number of PIDs removed.
+        ///
+        /// \since 4.3.0
+        auto erase_dead_pids() -> std::size_t;
+
         /// Restores a previously removed entry.
         ///
         /// The entry will appear as if it was never removed.
         ///
         /// \param[in] _entry A reference to a previously erased entry.
+        ///
+        /// \throws replica_access_table_error If the table is full.
         auto restore(const restorable_entry& _entry) -> void;
 
     private:
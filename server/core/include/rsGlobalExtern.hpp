@@ -11,6 +11,7 @@
 #include "apiHandler.hpp"
 #include "fileOpr.hpp"
 #include "objDesc.hpp"
+#include "l1desc_table.hpp"
 #include "querySpecColl.h"
 #include "miscUtil.h"
 #include "authenticate.h"
@@ -33,7 +34,7 @@ extern rodsServerHost_t *HostConfigHead;
 extern zoneInfo_t *ZoneInfoHead;
 extern int RescGrpInit;
 extern fileDesc_t FileDesc[NUM_FILE_DESC];
-extern l1desc_t L1desc[NUM_L1_DESC];
+extern irods::l1desc_table L1desc;
 extern specCollDesc_t SpecCollDesc[NUM_SPEC_COLL_DESC];
 extern std::vector<collHandle_t> CollHandle;;
 
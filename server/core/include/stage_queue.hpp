@@ -0,0 +1,190 @@
+#ifndef IRODS_STAGE_QUEUE_HPP
+#define IRODS_STAGE_QUEUE_HPP
+
+/// \file
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct RsComm;
+
+/// Stages data objects from the archive of a compound resource to its cache.
+///
+/// Prefetches, queued by the prestage_to_cache API, are staged in the background. Each
+/// of them runs in an agent of its own, reached through a connection to the local
+/// server, which opens the data object through the compound resource with
+/// STAGE_INLINE_KW set. That agent stages the replica exactly as an open always has,
+/// and registers it in the catalog before the stage completes. Prefetches are served
+/// in order of priority, then in the order they were submitted.
+///
+/// Opens stage in the calling agent through run(), so an open which has nothing to
+/// coalesce with costs no more than it did without the queue. A request for a data
+/// object which is already queued or being staged is coalesced with the earlier one:
+/// an open waits for a running stage, and takes over a prefetch which has not started.
+///
+/// \since 4.3.0
+namespace irods
+{
+    /// The priority of the stages needed by opens.
+    inline constexpr int stage_priority_open = std::numeric_limits<int>::max();
+
+    /// The default priority of prefetches.
+    inline constexpr int stage_priority_prefetch = 0;
+
+    struct stage_request
+    {
+        /// The data object to stage.
+        std::string logical_path;
+
+        /// The root resource of the hierarchy containing the compound resource.
+        std::string resource;
+
+        // The identity used to connect to the local server.
+        std::string host;
+        int port;
+        std::string proxy_user_name;
+        std::string proxy_zone;
+        std::string client_user_name;
+        std::string client_zone;
+    }; // struct stage_request
+
+    /// Returns a request to stage \p _logical_path on behalf of the client of \p _comm.
+    auto make_stage_request(const RsComm& _comm,
+                            const std::string& _logical_path,
+                            const std::string& _resource) -> stage_request;
+
+    /// Stages \p _request through a connection to the local server.
+    ///
+    /// \return 0 on success, otherwise an iRODS error code.
+    auto stage_through_local_agent(const stage_request& _request) -> int;
+
+    class stage_queue
+    {
+    public:
+        using stage_function = std::function<int(const stage_request&)>;
+
+        /// \param[in] _workers      The number of stages run concurrently.
+        /// \param[in] _stage        The function which stages a data object.
+        /// \param[in] _grace_period How long the destructor waits for running stages
+        ///                          before it interrupts them.
+        stage_queue(int _workers,
+                    stage_function _stage,
+                    std::chrono::milliseconds _grace_period = std::chrono::seconds{5});
+
+        stage_queue(const stage_queue&) = delete;
+        auto operator=(const stage_queue&) -> stage_queue& = delete;
+
+        /// Discards the stages which have not started, which complete with
+        /// SYS_THREAD_ENCOUNTERED_INTERRUPT, and joins the workers. Stages still running
+        /// after the grace period are interrupted (see set_interrupt()).
+        ~stage_queue();
+
+        /// Registers \p _interrupt, which makes the stage running in the calling worker
+        /// return early, e.g. by shutting down the connection it waits on. Called by the
+        /// destructor if the stage outlasts the grace period. Passing nullptr clears it.
+        ///
+        /// Does nothing unless called by a stage function run by a worker.
+        static auto set_interrupt(std::function<void()> _interrupt) -> void;
+
+        /// Queues a stage, unless the data object is already queued or being staged.
+        ///
+        /// \return The status of the stage, which is shared by coalesced requests.
+        auto submit(const stage_request& _request, int _priority) -> std::shared_future<int>;
+
+        /// Stages a data object in the calling thread with \p _stage, unless it is being
+        /// staged already, in which case that stage is waited for instead. A queued stage
+        /// of the data object is taken over and completes with the status of \p _stage.
+        ///
+        /// \return The status of the stage.
+        auto run(const stage_request& _request, const std::function<int()>& _stage) -> int;
+
+        /// Returns the number of stages which have not started.
+        auto queued() const -> std::size_t;
+
+        /// Returns the number of stages which are running.
+        auto running() const -> std::size_t;
+
+    private:
+        struct entry
+        {
+            std::string key;
+            stage_request request;
+            int priority;
+            std::uint64_t sequence;
+            std::promise<int> promise;
+            std::shared_future<int> status;
+        }; // struct entry
+
+        struct by_priority
+        {
+            auto operator()(const std::shared_ptr<entry>& _lhs, const std::shared_ptr<entry>& _rhs) const -> bool
+            {
+                if (_lhs->priority != _rhs->priority) {
+                    return _lhs->priority > _rhs->priority;
+                }
+
+                return _lhs->sequence < _rhs->sequence;
+            }
+        }; // struct by_priority
+
+        // The state is shared with the workers.
+        struct state
+        {
+            state(std::size_t _max_workers, stage_function _stage);
+
+            const std::size_t max_workers;
+            const stage_function stage;
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool stopping;
+            std::uint64_t next_sequence;
+
+            // Queued and running stages by data object.
+            std::map<std::string, std::shared_ptr<entry>> entries;
+
+            // Queued stages in the order they will run.
+            std::set<std::shared_ptr<entry>, by_priority> queue;
+
+            std::size_t running;
+
+            // Workers are started on demand, so processes which never stage anything do
+            // not carry idle threads.
+            std::size_t workers;
+            std::vector<std::thread> threads;
+
+            // The interrupts of the running stages by worker.
+            std::map<std::thread::id, std::function<void()>> interrupts;
+        }; // struct state
+
+        static auto work(std::shared_ptr<state> _state) -> void;
+
+        // The state of the queue the calling thread works for, if any.
+        static thread_local state* worker_state_;
+
+        std::shared_ptr<state> state_;
+        std::chrono::milliseconds grace_period_;
+    }; // class stage_queue
+
+    /// Returns the stage queue of the calling process, which stages through
+    /// stage_through_local_agent().
+    ///
+    /// Queues inherited across fork() are replaced, because their workers do not exist
+    /// in the child.
+    auto get_stage_queue() -> stage_queue&;
+} // namespace irods
+
+#endif // IRODS_STAGE_QUEUE_HPP
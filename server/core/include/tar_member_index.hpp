@@ -0,0 +1,102 @@
+#ifndef IRODS_TAR_MEMBER_INDEX_HPP
+#define IRODS_TAR_MEMBER_INDEX_HPP
+
+/// \file
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// An index of the members of an uncompressed tar file.
+///
+/// The index maps the name of each member to the location of its data in the tar file,
+/// so that a member can be read in place without extracting the tar file. Building the
+/// index reads only the headers of the members.
+///
+/// \since 4.3.0
+namespace irods::experimental::tar
+{
+    struct member
+    {
+        /// The path of the member relative to the root of the tar file, without a
+        /// leading "./" or a trailing slash.
+        std::string name;
+
+        /// The offset of the first byte of the member's data in the tar file.
+        std::int64_t offset;
+
+        std::int64_t size;
+        std::int64_t mtime;
+        std::uint32_t mode;
+
+        /// The type flag of the tar header, e.g. '0' for a regular file or '5' for a
+        /// directory.
+        char type;
+
+        auto is_regular_file() const noexcept -> bool { return type == '0'; }
+        auto is_directory() const noexcept -> bool { return type == '5'; }
+    }; // struct member
+
+    /// Reads up to \p _size bytes at \p _offset of the tar file into \p _buffer.
+    ///
+    /// Returns the number of bytes read, which is less than \p _size only at the end of
+    /// the file, or a negative iRODS error code.
+    using read_function = std::function<std::int64_t(std::int64_t _offset, void* _buffer, std::int64_t _size)>;
+
+    class member_index
+    {
+    public:
+        /// Indexes the tar file read by \p _read.
+        ///
+        /// Supports the ustar, GNU and pax formats. Sparse files and other members
+        /// which cannot be read in place are left out of the index.
+        ///
+        /// Returns nothing if the file is not an uncompressed tar file, e.g. if it is
+        /// compressed or a zip file.
+        ///
+        /// \throws irods::exception If the file cannot be read or is truncated.
+        static auto build(const read_function& _read) -> std::optional<member_index>;
+
+        /// Restores an index written by serialize().
+        ///
+        /// Returns nothing if \p _data is not an index, or if it was written for a tar
+        /// file with a different size or modification time.
+        static auto deserialize(std::string_view _data,
+                                std::int64_t _archive_size,
+                                std::int64_t _archive_mtime) -> std::optional<member_index>;
+
+        /// Returns true if \p _data was written by serialize(), for any version of any
+        /// tar file.
+        static auto is_serialized(std::string_view _data) -> bool;
+
+        /// Returns the index in a form which can be stored with the tar file.
+        ///
+        /// \p _archive_size and \p _archive_mtime identify the version of the tar file
+        /// the index describes.
+        auto serialize(std::int64_t _archive_size, std::int64_t _archive_mtime) const -> std::string;
+
+        /// Returns the member named \p _name, or a null pointer if there is none.
+        ///
+        /// If the tar file holds several members with the same name, the last one is
+        /// returned, as it is the one extraction leaves behind.
+        auto find(std::string_view _name) const -> const member*;
+
+        /// Returns the members in the order of the tar file.
+        auto members() const noexcept -> const std::vector<member>& { return members_; }
+
+    private:
+        member_index() = default;
+
+        auto index_names() -> void;
+
+        std::vector<member> members_;
+
+        // Sorted by name. Refers to the last member with each name.
+        std::vector<std::size_t> by_name_;
+    }; // class member_index
+} // namespace irods::experimental::tar
+
+#endif // IRODS_TAR_MEMBER_INDEX_HPP
@@ -0,0 +1,55 @@
+#ifndef IRODS_ZERO_COPY_HPP
+#define IRODS_ZERO_COPY_HPP
+
+/// \file
+
+#include "rodsType.h"
+
+#include <string>
+#include <vector>
+
+/// Helpers for moving data between a vault file and a portal socket (or between
+/// two vault files) without copying it through a user-space buffer.
+///
+/// Each function moves exactly \p _length bytes starting at \p _offset of the
+/// file descriptor. The file position of the file descriptor is not modified.
+///
+/// If the kernel or the file system cannot perform the operation and no data has
+/// been moved yet, \p _unsupported is set to true and zero is returned. The caller
+/// is expected to fall back to buffered I/O in that case.
+///
+/// On failure, a negative iRODS error code is returned.
+
+namespace irods::zero_copy
+{
+    /// Returns whether the bytes of a replica can be moved to or from the file of
+    /// its leaf resource without passing through the resource plugins.
+    ///
+    /// This is only true when the leaf is a unixfilesystem resource and every
+    /// resource above it passes bytes through unchanged. Resources which transform
+    /// the bytes they store (e.g. blockcompress, dedup and pack) keep the file of
+    /// their child in a format of their own.
+    ///
+    /// \param[in] _resource_types The type of each resource of the hierarchy, from
+    ///                            the root to the leaf.
+    ///
+    /// \since 4.3.0
+    auto is_pass_through_hierarchy(const std::vector<std::string>& _resource_types) -> bool;
+
+    /// Receives data from \p _sock and writes it into \p _fd using splice(2).
+    ///
+    /// \since 4.3.0
+    auto receive_from_socket(int _sock, int _fd, rodsLong_t _offset, rodsLong_t _length, bool& _unsupported) -> rodsLong_t;
+
+    /// Reads data from \p _fd and sends it over \p _sock using sendfile(2).
+    ///
+    /// \since 4.3.0
+    auto send_to_socket(int _fd, int _sock, rodsLong_t _offset, rodsLong_t _length, bool& _unsupported) -> rodsLong_t;
+
+    /// Copies data from \p _src_fd to \p _dst_fd at the same offset using copy_file_range(2).
+    ///
+    /// \since 4.3.0
+    auto copy_file_range(int _src_fd, int _dst_fd, rodsLong_t _offset, rodsLong_t _length, bool& _unsupported) -> rodsLong_t;
+} // namespace irods::zero_copy
+
+#endif // IRODS_ZERO_COPY_HPP
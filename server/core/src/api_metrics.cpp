@@ -0,0 +1,491 @@
+#include "api_metrics.hpp"
+
+#include "apiNumberMap.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace irods::experimental::api_metrics
+{
+    namespace
+    {
+        // The number of stripes. Each agent records into stripe (PID % stripe_count).
+        constexpr std::size_t stripe_count = 8;
+
+        // The number of distinct APIs each stripe can track.
+        constexpr std::size_t slots_per_stripe = 256;
+
+        using counter_type = std::atomic<std::uint64_t>;
+
+        static_assert(counter_type::is_always_lock_free, "Shared counters must be lock-free.");
+        static_assert(std::atomic<int>::is_always_lock_free, "Shared counters must be lock-free.");
+
+        // The counters for one API within a stripe. Zero-initialized memory is a valid,
+        // unused slot.
+        struct alignas(64) slot
+        {
+            std::atomic<int> api_number; // 0 means unused.
+            counter_type calls;
+            counter_type errors;
+            counter_type bytes_received;
+            counter_type bytes_sent;
+            counter_type total_microseconds;
+            counter_type max_microseconds;
+            counter_type histogram[histogram_bucket_count];
+        }; // struct slot
+
+        struct stripe
+        {
+            slot slots[slots_per_stripe];
+            counter_type untracked_calls;
+        }; // struct stripe
+
+        struct shared_counters
+        {
+            stripe stripes[stripe_count];
+        }; // struct shared_counters
+
+        shared_counters* g_counters = nullptr;
+        pid_t g_owner_pid = 0;
+
+        // The stripe of the calling process. Reset in forked children so that each
+        // process computes its own.
+        stripe* g_stripe = nullptr;
+
+        auto current_stripe() noexcept -> stripe&
+        {
+            if (!g_stripe) {
+                g_stripe = &g_counters->stripes[getpid() % stripe_count];
+            }
+
+            return *g_stripe;
+        }
+
+        // Returns the slot for the API, claiming an unused one if necessary.
+        auto find_slot(stripe& _stripe, int _api_number) noexcept -> slot*
+        {
+            const auto start = (static_cast<std::uint32_t>(_api_number) * 2654435761u) % slots_per_stripe;
+
+            for (std::size_t i = 0; i < slots_per_stripe; ++i) {
+                auto& s = _stripe.slots[(start + i) % slots_per_stripe];
+                auto current = s.api_number.load(std::memory_order_acquire);
+
+                if (current == _api_number) {
+                    return &s;
+                }
+
+                if (0 == current) {
+                    if (s.api_number.compare_exchange_strong(current, _api_number, std::memory_order_acq_rel) ||
+                        current == _api_number)
+                    {
+                        return &s;
+                    }
+                }
+            }
+
+            return nullptr;
+        }
+
+        auto api_name(int _api_number) -> std::string
+        {
+            if (const auto iter = irods::api_number_names.find(_api_number); iter != std::end(irods::api_number_names)) {
+                return iter->second;
+            }
+
+            return std::to_string(_api_number);
+        }
+
+        auto write_all(int _fd, const std::string& _data) -> void
+        {
+            const char* p = _data.data();
+            auto remaining = _data.size();
+
+            while (remaining > 0) {
+                const auto n = send(_fd, p, remaining, MSG_NOSIGNAL);
+
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+
+                    return;
+                }
+
+                p += n;
+                remaining -= n;
+            }
+        }
+    } // anonymous namespace
+
+    auto bucket_index(std::uint64_t _microseconds) noexcept -> std::size_t
+    {
+        if (_microseconds < histogram_sub_bucket_count) {
+            return _microseconds;
+        }
+
+        const int exponent = 63 - __builtin_clzll(_microseconds);
+
+        if (exponent > histogram_max_exponent) {
+            return histogram_bucket_count - 1;
+        }
+
+        const auto shift = exponent - histogram_sub_bucket_bits;
+        const auto sub_bucket = (_microseconds >> shift) & (histogram_sub_bucket_count - 1);
+
+        return histogram_sub_bucket_count + shift * histogram_sub_bucket_count + sub_bucket;
+    }
+
+    auto bucket_lower_bound(std::size_t _index) noexcept -> std::uint64_t
+    {
+        if (_index < histogram_sub_bucket_count) {
+            return _index;
+        }
+
+        const auto shift = (_index - histogram_sub_bucket_count) / histogram_sub_bucket_count;
+        const auto sub_bucket = (_index - histogram_sub_bucket_count) % histogram_sub_bucket_count;
+
+        return (histogram_sub_bucket_count + sub_bucket) << shift;
+    }
+
+    auto api_statistics::percentile(double _percentile) const noexcept -> std::uint64_t
+    {
+        if (0 == calls) {
+            return 0;
+        }
+
+        const auto target = static_cast<std::uint64_t>(std::ceil(_percentile / 100.0 * calls));
+        std::uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < histogram_bucket_count; ++i) {
+            seen += histogram[i];
+
+            if (seen >= std::max<std::uint64_t>(target, 1)) {
+                if (i + 1 == histogram_bucket_count) {
+                    return max_microseconds;
+                }
+
+                return std::min(bucket_lower_bound(i + 1) - 1, max_microseconds);
+            }
+        }
+
+        return max_microseconds;
+    }
+
+    auto init() -> void
+    {
+        if (g_counters) {
+            return;
+        }
+
+        // An anonymous shared mapping is inherited by every process forked from this
+        // one and disappears with the last of them. The pages are zero-filled, which
+        // is a valid initial state, and are only allocated once they are touched.
+        void* p = mmap(nullptr, sizeof(shared_counters), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if (MAP_FAILED == p) {
+            throw std::system_error{errno, std::generic_category(), "api_metrics: cannot map shared memory"};
+        }
+
+        g_counters = static_cast<shared_counters*>(p);
+        g_owner_pid = getpid();
+
+        pthread_atfork(nullptr, nullptr, [] { g_stripe = nullptr; });
+    }
+
+    auto deinit() noexcept -> void
+    {
+        if (g_counters && getpid() == g_owner_pid) {
+            munmap(g_counters, sizeof(shared_counters));
+            g_counters = nullptr;
+        }
+    }
+
+    auto record(int _api_number,
+                std::chrono::microseconds _elapsed,
+                int _status,
+                std::uint64_t _bytes_received,
+                std::uint64_t _bytes_sent) noexcept -> void
+    {
+        if (!g_counters || 0 == _api_number) {
+            return;
+        }
+
+        auto& stripe = current_stripe();
+        auto* s = find_slot(stripe, _api_number);
+
+        if (!s) {
+            stripe.untracked_calls.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const auto us = static_cast<std::uint64_t>(std::max<std::chrono::microseconds::rep>(0, _elapsed.count()));
+
+        s->calls.fetch_add(1, std::memory_order_relaxed);
+        s->total_microseconds.fetch_add(us, std::memory_order_relaxed);
+        s->histogram[bucket_index(us)].fetch_add(1, std::memory_order_relaxed);
+
+        if (_status < 0) {
+            s->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (_bytes_received > 0) {
+            s->bytes_received.fetch_add(_bytes_received, std::memory_order_relaxed);
+        }
+
+        if (_bytes_sent > 0) {
+            s->bytes_sent.fetch_add(_bytes_sent, std::memory_order_relaxed);
+        }
+
+        auto max = s->max_microseconds.load(std::memory_order_relaxed);
+        while (us > max && !s->max_microseconds.compare_exchange_weak(max, us, std::memory_order_relaxed));
+    }
+
+    auto collect() -> statistics
+    {
+        statistics stats;
+
+        if (!g_counters) {
+            return stats;
+        }
+
+        std::map<int, api_statistics> apis;
+
+        for (auto& stripe : g_counters->stripes) {
+            stats.untracked_calls += stripe.untracked_calls.load(std::memory_order_relaxed);
+
+            for (auto& s : stripe.slots) {
+                const auto api_number = s.api_number.load(std::memory_order_acquire);
+
+                if (0 == api_number) {
+                    continue;
+                }
+
+                auto& a = apis[api_number];
+                a.api_number = api_number;
+                a.calls += s.calls.load(std::memory_order_relaxed);
+                a.errors += s.errors.load(std::memory_order_relaxed);
+                a.bytes_received += s.bytes_received.load(std::memory_order_relaxed);
+                a.bytes_sent += s.bytes_sent.load(std::memory_order_relaxed);
+                a.total_microseconds += s.total_microseconds.load(std::memory_order_relaxed);
+                a.max_microseconds = std::max(a.max_microseconds, s.max_microseconds.load(std::memory_order_relaxed));
+
+                for (std::size_t i = 0; i < histogram_bucket_count; ++i) {
+                    a.histogram[i] += s.histogram[i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        stats.apis.reserve(apis.size());
+
+        for (auto& [api_number, a] : apis) {
+            // A slot may have been claimed by an agent which has not finished recording yet.
+            if (a.calls > 0) {
+                stats.apis.push_back(std::move(a));
+            }
+        }
+
+        return stats;
+    }
+
+    auto to_json(const statistics& _stats) -> nlohmann::json
+    {
+        auto apis = nlohmann::json::array();
+
+        for (const auto& a : _stats.apis) {
+            apis.push_back({
+                {"api_number", a.api_number},
+                {"api_name", api_name(a.api_number)},
+                {"calls", a.calls},
+                {"errors", a.errors},
+                {"bytes_received", a.bytes_received},
+                {"bytes_sent", a.bytes_sent},
+                {"latency_microseconds", {
+                    {"mean", a.total_microseconds / a.calls},
+                    {"p50", a.percentile(50)},
+                    {"p90", a.percentile(90)},
+                    {"p99", a.percentile(99)},
+                    {"max", a.max_microseconds}
+                }}
+            });
+        }
+
+        return {{"apis", apis}, {"untracked_calls", _stats.untracked_calls}};
+    }
+
+    auto to_prometheus_text(const statistics& _stats) -> std::string
+    {
+        std::ostringstream out;
+
+        const auto labels = [](const api_statistics& _a) {
+            return "api=\"" + api_name(_a.api_number) + "\",api_number=\"" + std::to_string(_a.api_number) + '"';
+        };
+
+        const auto counter = [&](const char* _name, const char* _help, auto _member) {
+            out << "# HELP " << _name << ' ' << _help << '\n';
+            out << "# TYPE " << _name << " counter\n";
+
+            for (const auto& a : _stats.apis) {
+                out << _name << '{' << labels(a) << "} " << a.*_member << '\n';
+            }
+        };
+
+        counter("irods_api_calls_total", "The number of API calls handled.", &api_statistics::calls);
+        counter("irods_api_errors_total", "The number of API calls which returned an error.", &api_statistics::errors);
+        counter("irods_api_received_bytes_total", "The number of bytes received with API requests.", &api_statistics::bytes_received);
+        counter("irods_api_sent_bytes_total", "The number of bytes of data returned by API calls.", &api_statistics::bytes_sent);
+
+        // Prometheus histograms are cumulative. Powers of two between 64us and ~67s
+        // keep the number of series reasonable.
+        out << "# HELP irods_api_duration_seconds The time spent handling API calls.\n";
+        out << "# TYPE irods_api_duration_seconds histogram\n";
+
+        for (const auto& a : _stats.apis) {
+            std::uint64_t cumulative = 0;
+            std::size_t i = 0;
+
+            for (int exponent = 6; exponent <= 26; ++exponent) {
+                const auto bound = std::uint64_t{1} << exponent;
+
+                for (; i < histogram_bucket_count && bucket_lower_bound(i) < bound; ++i) {
+                    cumulative += a.histogram[i];
+                }
+
+                out << "irods_api_duration_seconds_bucket{" << labels(a) << ",le=\"" << bound / 1e6 << "\"} " << cumulative << '\n';
+            }
+
+            out << "irods_api_duration_seconds_bucket{" << labels(a) << ",le=\"+Inf\"} " << a.calls << '\n';
+            out << "irods_api_duration_seconds_sum{" << labels(a) << "} " << a.total_microseconds / 1e6 << '\n';
+            out << "irods_api_duration_seconds_count{" << labels(a) << "} " << a.calls << '\n';
+        }
+
+        out << "# HELP irods_api_untracked_calls_total API calls which could not be recorded.\n";
+        out << "# TYPE irods_api_untracked_calls_total counter\n";
+        out << "irods_api_untracked_calls_total " << _stats.untracked_calls << '\n';
+
+        return out.str();
+    }
+
+    //
+    // prometheus_endpoint
+    //
+
+    prometheus_endpoint::prometheus_endpoint(int _port)
+        : socket_{socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)}
+        , port_{_port}
+        , stop_{false}
+        , thread_{}
+    {
+        if (socket_ < 0) {
+            throw std::system_error{errno, std::generic_category(), "prometheus_endpoint: cannot create socket"};
+        }
+
+        const int enable = 1;
+        setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<std::uint16_t>(_port));
+
+        if (bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(socket_, 16) != 0) {
+            const auto ec = errno;
+            close(socket_);
+            throw std::system_error{ec, std::generic_category(), "prometheus_endpoint: cannot listen on port " + std::to_string(_port)};
+        }
+
+        // Supports port 0 (any port), which is useful for testing.
+        socklen_t len = sizeof(addr);
+        if (getsockname(socket_, reinterpret_cast<sockaddr*>(&addr), &len) == 0) {
+            port_ = ntohs(addr.sin_port);
+        }
+
+        thread_ = std::thread{[this] { run(); }};
+    }
+
+    prometheus_endpoint::~prometheus_endpoint()
+    {
+        stop_.store(true);
+        thread_.join();
+        close(socket_);
+    }
+
+    auto prometheus_endpoint::port() const noexcept -> int
+    {
+        return port_;
+    }
+
+    auto prometheus_endpoint::run() -> void
+    {
+        while (!stop_.load()) {
+            // Wake up periodically to notice the stop request.
+            pollfd pfd{socket_, POLLIN, 0};
+
+            if (poll(&pfd, 1, 250) <= 0) {
+                continue;
+            }
+
+            const int client = accept4(socket_, nullptr, nullptr, SOCK_CLOEXEC);
+
+            if (client < 0) {
+                continue;
+            }
+
+            try {
+                handle(client);
+            }
+            catch (...) {
+            }
+
+            close(client);
+        }
+    }
+
+    auto prometheus_endpoint::handle(int _client) -> void
+    {
+        // Don't let a slow client hold up the endpoint.
+        timeval timeout{5, 0};
+        setsockopt(_client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(_client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // Only the request line matters.
+        std::string request;
+        char buffer[1024];
+
+        while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+            const auto n = recv(_client, buffer, sizeof(buffer), 0);
+
+            if (n <= 0) {
+                return;
+            }
+
+            request.append(buffer, n);
+        }
+
+        const auto request_line = request.substr(0, request.find("\r\n"));
+
+        if (request_line.rfind("GET /metrics ", 0) != 0 && request_line.rfind("GET / ", 0) != 0) {
+            write_all(_client, "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            return;
+        }
+
+        const auto body = to_prometheus_text(collect());
+
+        write_all(_client, "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body);
+    }
+} // namespace irods::experimental::api_metrics
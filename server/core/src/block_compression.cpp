@@ -0,0 +1,537 @@
+#include "block_compression.hpp"
+
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+
+#include <fmt/format.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace irods::experimental::block_compression
+{
+    namespace
+    {
+        constexpr char trailer_magic[16] = "iRODS-blockz-v1";
+        constexpr std::size_t trailer_size = 2 * sizeof(std::uint64_t) + sizeof(trailer_magic);
+        constexpr std::size_t index_header_size = 24;
+        constexpr std::size_t index_entry_size = 24;
+
+        // Neighbouring blocks are read from the file together, up to this many bytes.
+        constexpr std::size_t max_read_size = 16 * 1024 * 1024;
+
+        auto put_le32(unsigned char* _p, std::uint32_t _v) noexcept -> void
+        {
+            for (int i = 0; i < 4; ++i) {
+                _p[i] = static_cast<unsigned char>(_v >> (8 * i));
+            }
+        }
+
+        auto put_le64(unsigned char* _p, std::uint64_t _v) noexcept -> void
+        {
+            for (int i = 0; i < 8; ++i) {
+                _p[i] = static_cast<unsigned char>(_v >> (8 * i));
+            }
+        }
+
+        auto get_le32(const unsigned char* _p) noexcept -> std::uint32_t
+        {
+            std::uint32_t v = 0;
+            for (int i = 3; i >= 0; --i) {
+                v = (v << 8) | _p[i];
+            }
+            return v;
+        }
+
+        auto get_le64(const unsigned char* _p) noexcept -> std::uint64_t
+        {
+            std::uint64_t v = 0;
+            for (int i = 7; i >= 0; --i) {
+                v = (v << 8) | _p[i];
+            }
+            return v;
+        }
+
+        auto number_of_blocks(std::int64_t _size, std::uint32_t _block_size) noexcept -> std::size_t
+        {
+            return static_cast<std::size_t>((_size + _block_size - 1) / _block_size);
+        }
+
+        auto read_fully(const file_io& _io, std::int64_t _offset, void* _buffer, std::size_t _size) -> void
+        {
+            if (_io.read(_offset, _buffer, _size) != _size) {
+                THROW(SYS_COPY_LEN_ERR, fmt::format("block_compression: short read of {} bytes at offset {}", _size, _offset));
+            }
+        }
+
+        // Returns the _length bytes of content held by the stored block _stored. The
+        // bytes past the end of the stored content are zeros.
+        auto inflate_block(const block_entry& _entry, const char* _stored, std::size_t _length) -> std::vector<char>
+        {
+            std::vector<char> data(std::max<std::size_t>(_length, _entry.size));
+
+            if (_entry.flags & stored_raw) {
+                std::memcpy(data.data(), _stored, _entry.size);
+            }
+            else {
+                auto size = static_cast<uLongf>(_entry.size);
+                const auto ec = uncompress(reinterpret_cast<Bytef*>(data.data()), &size,
+                                           reinterpret_cast<const Bytef*>(_stored), _entry.stored_size);
+
+                if (Z_OK != ec || size != _entry.size) {
+                    THROW(SYS_LIBRARY_ERROR, fmt::format("block_compression: inflate failed with zlib error [{}]", ec));
+                }
+            }
+
+            data.resize(_length);
+
+            return data;
+        } // inflate_block
+
+        auto read_block(const file_io& _io, const block_entry& _entry, std::size_t _length) -> std::vector<char>
+        {
+            if (0 == _entry.stored_size) {
+                return std::vector<char>(_length);
+            }
+
+            std::vector<char> stored(_entry.stored_size);
+            read_fully(_io, _entry.offset, stored.data(), stored.size());
+
+            return inflate_block(_entry, stored.data(), _length);
+        } // read_block
+    } // anonymous namespace
+
+    auto read_index(const file_io& _io, std::int64_t _file_size) -> std::optional<block_index>
+    {
+        if (_file_size < static_cast<std::int64_t>(trailer_size + index_header_size)) {
+            return std::nullopt;
+        }
+
+        unsigned char trailer[trailer_size]{};
+        read_fully(_io, _file_size - trailer_size, trailer, sizeof(trailer));
+
+        if (std::memcmp(trailer + 16, trailer_magic, sizeof(trailer_magic)) != 0) {
+            return std::nullopt;
+        }
+
+        const auto index_offset = get_le64(trailer);
+        const auto index_size = get_le64(trailer + 8);
+
+        if (index_size < index_header_size || 0 != (index_size - index_header_size) % index_entry_size ||
+            index_offset + index_size + trailer_size != static_cast<std::uint64_t>(_file_size))
+        {
+            THROW(SYS_INTERNAL_ERR, "block_compression: the trailer is damaged");
+        }
+
+        std::vector<unsigned char> data(index_size);
+        read_fully(_io, index_offset, data.data(), data.size());
+
+        block_index index;
+        index.block_size = get_le32(data.data());
+        index.size = static_cast<std::int64_t>(get_le64(data.data() + 8));
+
+        const auto count = get_le64(data.data() + 16);
+
+        if (0 == index.block_size || index.size < 0 || count != (index_size - index_header_size) / index_entry_size ||
+            count != number_of_blocks(index.size, index.block_size))
+        {
+            THROW(SYS_INTERNAL_ERR, "block_compression: the index is damaged");
+        }
+
+        index.blocks.resize(count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto* p = data.data() + index_header_size + i * index_entry_size;
+            auto& e = index.blocks[i];
+
+            e.offset = get_le64(p);
+            e.stored_size = get_le32(p + 8);
+            e.size = get_le32(p + 12);
+            e.flags = get_le32(p + 16);
+
+            if (e.size > index.block_size || e.offset + e.stored_size > index_offset ||
+                ((e.flags & stored_raw) && e.stored_size != e.size))
+            {
+                THROW(SYS_INTERNAL_ERR, fmt::format("block_compression: entry {} of the index is damaged", i));
+            }
+        }
+
+        return index;
+    } // read_index
+
+    writer::writer(block_index _index, std::int64_t _end, int _threads, int _level)
+        : index_{std::move(_index)}
+        , end_{_end}
+        , level_{_level}
+        , max_pending_{2 * static_cast<std::size_t>(std::max(_threads, 1))}
+        , open_blocks_{}
+        , pending_{}
+        , bytes_stored_{}
+        , bytes_compressed_{}
+        , mutex_{}
+        , done_{}
+        , pool_{std::max(_threads, 1)}
+    {
+        if (0 == index_.block_size) {
+            THROW(SYS_INVALID_INPUT_PARAM, "block_compression: the block size must not be zero");
+        }
+    } // writer
+
+    writer::~writer()
+    {
+        pool_.stop();
+        pool_.join();
+    } // ~writer
+
+    auto writer::block_length(std::size_t _number) const noexcept -> std::size_t
+    {
+        const auto start = static_cast<std::int64_t>(_number) * index_.block_size;
+        return static_cast<std::size_t>(std::clamp<std::int64_t>(index_.size - start, 0, index_.block_size));
+    } // writer::block_length
+
+    auto writer::load(std::size_t _number, const file_io& _io) -> open_block&
+    {
+        if (const auto iter = open_blocks_.find(_number); iter != std::end(open_blocks_)) {
+            return iter->second;
+        }
+
+        // The block may still be on its way to the file.
+        const auto in_flight = std::any_of(std::begin(pending_), std::end(pending_),
+                                           [_number](const auto& _b) { return _b->number == _number; });
+        if (in_flight) {
+            drain(0, _io);
+        }
+
+        open_block b;
+
+        if (_number < index_.blocks.size()) {
+            b.data = read_block(_io, index_.blocks[_number], index_.block_size);
+        }
+        else {
+            b.data.resize(index_.block_size);
+        }
+
+        return open_blocks_.emplace(_number, std::move(b)).first->second;
+    } // writer::load
+
+    auto writer::write(std::int64_t _offset, const void* _buffer, std::size_t _size, const file_io& _io) -> void
+    {
+        if (_offset < 0) {
+            THROW(SYS_INVALID_INPUT_PARAM, "block_compression: negative offset");
+        }
+
+        const auto* p = static_cast<const char*>(_buffer);
+
+        while (_size > 0) {
+            const auto number = static_cast<std::size_t>(_offset / index_.block_size);
+            const auto within = static_cast<std::size_t>(_offset % index_.block_size);
+            const auto n = std::min<std::size_t>(_size, index_.block_size - within);
+
+            auto& b = load(number, _io);
+            std::memcpy(b.data.data() + within, p, n);
+            b.bytes_written += n;
+
+            p += n;
+            _size -= n;
+            _offset += n;
+            index_.size = std::max(index_.size, _offset);
+
+            // Writes usually cover each byte once, so a block is complete once it has
+            // received as many bytes as it holds. If it was not, a later write loads
+            // it again.
+            if (b.bytes_written >= index_.block_size) {
+                submit(number, _io);
+            }
+        }
+    } // writer::write
+
+    auto writer::read(std::int64_t _offset, void* _buffer, std::size_t _size, const file_io& _io) -> std::size_t
+    {
+        drain(0, _io);
+
+        auto* out = static_cast<char*>(_buffer);
+        std::size_t total = 0;
+
+        while (total < _size && _offset < index_.size) {
+            const auto number = static_cast<std::size_t>(_offset / index_.block_size);
+            const auto within = static_cast<std::size_t>(_offset % index_.block_size);
+            const auto n = std::min(_size - total, block_length(number) - within);
+
+            if (const auto iter = open_blocks_.find(number); iter != std::end(open_blocks_)) {
+                std::memcpy(out + total, iter->second.data.data() + within, n);
+            }
+            else if (number < index_.blocks.size()) {
+                const auto data = read_block(_io, index_.blocks[number], block_length(number));
+                std::memcpy(out + total, data.data() + within, n);
+            }
+            else {
+                std::memset(out + total, 0, n);
+            }
+
+            total += n;
+            _offset += n;
+        }
+
+        return total;
+    } // writer::read
+
+    auto writer::truncate(std::int64_t _size, const file_io& _io) -> void
+    {
+        if (_size < 0) {
+            THROW(SYS_INVALID_INPUT_PARAM, "block_compression: negative size");
+        }
+
+        drain(0, _io);
+
+        const auto count = number_of_blocks(_size, index_.block_size);
+
+        open_blocks_.erase(open_blocks_.lower_bound(count), std::end(open_blocks_));
+
+        if (index_.blocks.size() > count) {
+            index_.blocks.resize(count);
+        }
+
+        // The bytes cut from the last block must read as zeros if the content grows
+        // again.
+        if (const auto within = static_cast<std::size_t>(_size % index_.block_size); within > 0) {
+            const auto number = count - 1;
+
+            if (open_blocks_.count(number) > 0 ||
+                (number < index_.blocks.size() && index_.blocks[number].stored_size > 0))
+            {
+                auto& b = load(number, _io);
+                std::fill(std::begin(b.data) + within, std::end(b.data), 0);
+            }
+        }
+
+        index_.size = _size;
+    } // writer::truncate
+
+    auto writer::finish(const file_io& _io) -> std::int64_t
+    {
+        while (!open_blocks_.empty()) {
+            submit(std::begin(open_blocks_)->first, _io);
+        }
+
+        drain(0, _io);
+
+        index_.blocks.resize(number_of_blocks(index_.size, index_.block_size));
+
+        std::vector<unsigned char> data(index_header_size + index_.blocks.size() * index_entry_size + trailer_size);
+
+        put_le32(data.data(), index_.block_size);
+        put_le64(data.data() + 8, index_.size);
+        put_le64(data.data() + 16, index_.blocks.size());
+
+        auto* p = data.data() + index_header_size;
+        for (auto&& e : index_.blocks) {
+            put_le64(p, e.offset);
+            put_le32(p + 8, e.stored_size);
+            put_le32(p + 12, e.size);
+            put_le32(p + 16, e.flags);
+            p += index_entry_size;
+        }
+
+        put_le64(p, end_);
+        put_le64(p + 8, data.size() - trailer_size);
+        std::memcpy(p + 16, trailer_magic, sizeof(trailer_magic));
+
+        _io.write(end_, data.data(), data.size());
+        end_ += data.size();
+
+        return end_;
+    } // writer::finish
+
+    auto writer::submit(std::size_t _number, const file_io& _io) -> void
+    {
+        auto node = open_blocks_.extract(_number);
+
+        auto b = std::make_shared<block>();
+        b->number = _number;
+        b->input = std::move(node.mapped().data);
+        b->input.resize(block_length(_number));
+
+        // Bound the memory held by blocks waiting for the file.
+        drain(max_pending_ - 1, _io);
+
+        pending_.push_back(b);
+
+        irods::thread_pool::post(pool_, [this, b, level = level_] {
+            auto size = compressBound(static_cast<uLong>(b->input.size()));
+            b->output.resize(size);
+
+            const auto ec = compress2(reinterpret_cast<Bytef*>(b->output.data()), &size,
+                                      reinterpret_cast<const Bytef*>(b->input.data()),
+                                      static_cast<uLong>(b->input.size()), level);
+            b->output.resize(size);
+
+            // Data which does not compress is stored as it is, so it also costs
+            // nothing to read.
+            if (Z_OK == ec && b->output.size() >= b->input.size()) {
+                b->flags = stored_raw;
+                b->output.clear();
+            }
+
+            {
+                std::lock_guard lock{mutex_};
+                b->error = ec;
+                b->done = true;
+            }
+
+            done_.notify_all();
+        });
+    } // writer::submit
+
+    auto writer::drain(std::size_t _max_pending, const file_io& _io) -> void
+    {
+        while (!pending_.empty()) {
+            auto& b = pending_.front();
+
+            {
+                std::unique_lock lock{mutex_};
+
+                if (pending_.size() <= _max_pending && !b->done) {
+                    return;
+                }
+
+                done_.wait(lock, [&b] { return b->done; });
+            }
+
+            if (Z_OK != b->error) {
+                THROW(SYS_LIBRARY_ERROR, fmt::format("block_compression: deflate failed with zlib error [{}]", b->error));
+            }
+
+            const auto& stored = (b->flags & stored_raw) ? b->input : b->output;
+
+            if (!stored.empty()) {
+                _io.write(end_, stored.data(), stored.size());
+            }
+
+            if (index_.blocks.size() <= b->number) {
+                index_.blocks.resize(b->number + 1);
+            }
+
+            index_.blocks[b->number] = {static_cast<std::uint64_t>(end_),
+                                        static_cast<std::uint32_t>(stored.size()),
+                                        static_cast<std::uint32_t>(b->input.size()),
+                                        b->flags};
+
+            end_ += stored.size();
+            bytes_stored_ += b->input.size();
+            bytes_compressed_ += stored.size();
+
+            pending_.pop_front();
+        }
+    } // writer::drain
+
+    reader::reader(block_index _index, int _threads, std::size_t _window)
+        : index_{std::move(_index)}
+        , window_{std::max<std::size_t>(_window, 1)}
+        , loaded_{}
+        , pool_{std::max(_threads, 1)}
+    {
+    } // reader
+
+    reader::~reader()
+    {
+        pool_.stop();
+        pool_.join();
+    } // ~reader
+
+    auto reader::prefetch(std::size_t _first, const file_io& _io) -> void
+    {
+        const auto last = std::min(_first + window_, index_.blocks.size());
+
+        for (auto iter = std::begin(loaded_); iter != std::end(loaded_);) {
+            if (iter->first < _first || iter->first >= last) {
+                iter = loaded_.erase(iter);
+            }
+            else {
+                ++iter;
+            }
+        }
+
+        const auto length = [this](std::size_t _number) {
+            const auto start = static_cast<std::int64_t>(_number) * index_.block_size;
+            return static_cast<std::size_t>(std::min<std::int64_t>(index_.size - start, index_.block_size));
+        };
+
+        for (auto i = _first; i < last;) {
+            if (loaded_.count(i) > 0) {
+                ++i;
+                continue;
+            }
+
+            const auto& first = index_.blocks[i];
+
+            if (0 == first.stored_size) {
+                std::promise<block_data> p;
+                p.set_value(std::make_shared<const std::vector<char>>(length(i)));
+                loaded_.emplace(i, p.get_future().share());
+                ++i;
+                continue;
+            }
+
+            // Extend the run over the following blocks which are stored right after
+            // this one and not loaded yet.
+            auto end = i + 1;
+            auto run_size = static_cast<std::size_t>(first.stored_size);
+
+            while (end < last && loaded_.count(end) == 0) {
+                const auto& e = index_.blocks[end];
+
+                if (0 == e.stored_size || e.offset != first.offset + run_size || run_size + e.stored_size > max_read_size) {
+                    break;
+                }
+
+                run_size += e.stored_size;
+                ++end;
+            }
+
+            auto stored = std::make_shared<std::vector<char>>(run_size);
+            read_fully(_io, first.offset, stored->data(), stored->size());
+
+            for (auto j = i; j < end; ++j) {
+                auto promise = std::make_shared<std::promise<block_data>>();
+                loaded_.emplace(j, promise->get_future().share());
+
+                irods::thread_pool::post(pool_, [promise, stored, entry = index_.blocks[j],
+                                                 within = index_.blocks[j].offset - first.offset,
+                                                 n = length(j)] {
+                    try {
+                        auto data = inflate_block(entry, stored->data() + within, n);
+                        promise->set_value(std::make_shared<const std::vector<char>>(std::move(data)));
+                    }
+                    catch (...) {
+                        promise->set_exception(std::current_exception());
+                    }
+                });
+            }
+
+            i = end;
+        }
+    } // reader::prefetch
+
+    auto reader::read(std::int64_t _offset, void* _buffer, std::size_t _size, const file_io& _io) -> std::size_t
+    {
+        auto* out = static_cast<char*>(_buffer);
+        std::size_t total = 0;
+
+        while (total < _size && _offset < index_.size) {
+            const auto number = static_cast<std::size_t>(_offset / index_.block_size);
+            const auto within = static_cast<std::size_t>(_offset % index_.block_size);
+
+            prefetch(number, _io);
+
+            const auto data = loaded_.at(number).get();
+            const auto n = std::min(_size - total, data->size() - within);
+
+            std::memcpy(out + total, data->data() + within, n);
+            total += n;
+            _offset += n;
+        }
+
+        return total;
+    } // reader::read
+} // namespace irods::experimental::block_compression
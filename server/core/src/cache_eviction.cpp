@@ -0,0 +1,334 @@
+#include "cache_eviction.hpp"
+
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+#include "shared_memory_object.hpp"
+
+#include <fmt/format.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <tuple>
+
+namespace irods::experimental::cache_eviction
+{
+    namespace
+    {
+        // clang-format off
+        using slot  = access_log::slot;
+        using table = access_log::table;
+        // clang-format on
+
+        // A replica occupies one of this many consecutive slots.
+        constexpr std::size_t probe_length = 32;
+
+        // Marks a slot which never held a replica.
+        constexpr std::int64_t empty_key = 0;
+
+        // Marks a slot which held a replica that was erased.
+        constexpr std::int64_t erased_key = -1;
+
+        constexpr std::string_view segment_name_prefix = "irods_cache_access_log_";
+
+        // Identifies the run of the server. Inherited by the agents.
+        std::int64_t g_server_instance = 0;
+
+        // The process which called init_access_logs().
+        pid_t g_owner_pid = 0;
+
+        class lru_policy : public policy
+        {
+        public:
+            auto evict_before(const candidate& _lhs, const candidate& _rhs) const -> bool override
+            {
+                return std::tie(_lhs.last_access, _lhs.hits) < std::tie(_rhs.last_access, _rhs.hits);
+            }
+        }; // class lru_policy
+
+        class lfu_policy : public policy
+        {
+        public:
+            auto evict_before(const candidate& _lhs, const candidate& _rhs) const -> bool override
+            {
+                return std::tie(_lhs.hits, _lhs.last_access) < std::tie(_rhs.hits, _rhs.last_access);
+            }
+        }; // class lfu_policy
+
+        class gdsf_policy : public policy
+        {
+        public:
+            auto evict_before(const candidate& _lhs, const candidate& _rhs) const -> bool override
+            {
+                return std::tie(_lhs.gdsf_value, _lhs.last_access) < std::tie(_rhs.gdsf_value, _rhs.last_access);
+            }
+        }; // class gdsf_policy
+
+        auto first_slot(std::int64_t _key) noexcept -> std::size_t
+        {
+            // Fibonacci hashing spreads the keys across the table.
+            constexpr std::uint64_t multiplier = 11400714819323198485ull;
+            return (static_cast<std::uint64_t>(_key) * multiplier) % access_log::capacity;
+        }
+
+        template <typename Table, typename Function>
+        auto for_each_probe(Table& _table, std::int64_t _key, Function _func) -> void
+        {
+            const auto first = first_slot(_key);
+
+            for (std::size_t i = 0; i < probe_length; ++i) {
+                if (_func(_table.slots[(first + i) % access_log::capacity])) {
+                    return;
+                }
+            }
+        }
+
+        auto find_slot(const table& _table, std::int64_t _key) -> const slot*
+        {
+            const slot* found = nullptr;
+
+            for_each_probe(_table, _key, [&](const slot& _s) {
+                if (_s.key == _key) {
+                    found = &_s;
+                }
+                return found != nullptr;
+            });
+
+            return found;
+        }
+
+        auto is_alive(pid_t _pid) noexcept -> bool
+        {
+            return 0 == kill(_pid, 0) || EPERM == errno;
+        }
+
+        // Removes every access log from shared memory.
+        auto remove_access_logs() noexcept -> void
+        {
+            namespace fs = boost::filesystem;
+
+            // POSIX shared memory objects appear under /dev/shm on Linux.
+            boost::system::error_code ec;
+
+            for (fs::directory_iterator it{"/dev/shm", ec}, end; !ec && it != end; it.increment(ec)) {
+                const auto name = it->path().filename().string();
+
+                if (0 == name.compare(0, segment_name_prefix.size(), segment_name_prefix)) {
+                    boost::interprocess::shared_memory_object::remove(name.c_str());
+                }
+            }
+        }
+    } // anonymous namespace
+
+    auto make_policy(std::string_view _name) -> std::unique_ptr<policy>
+    {
+        if ("lru" == _name) {
+            return std::make_unique<lru_policy>();
+        }
+
+        if ("lfu" == _name) {
+            return std::make_unique<lfu_policy>();
+        }
+
+        if ("gdsf" == _name) {
+            return std::make_unique<gdsf_policy>();
+        }
+
+        THROW(SYS_INVALID_INPUT_PARAM, fmt::format("Unknown cache eviction policy [{}].", _name));
+    } // make_policy
+
+    auto select_victims(std::vector<candidate> _candidates,
+                        const policy& _policy,
+                        std::int64_t _bytes_to_free) -> std::vector<candidate>
+    {
+        const auto compare = [&_policy](const candidate& _lhs, const candidate& _rhs) {
+            return _policy.evict_before(_lhs, _rhs);
+        };
+
+        // Only the victims need to be ordered, so the candidates are ordered in growing
+        // batches until enough bytes have been found.
+        std::size_t sorted = 0;
+        std::int64_t freed = 0;
+
+        while (freed < _bytes_to_free && sorted < _candidates.size()) {
+            const auto batch = std::min(_candidates.size(), std::max<std::size_t>(64, sorted * 2));
+            const auto first = std::next(std::begin(_candidates), sorted);
+            const auto middle = std::next(std::begin(_candidates), batch);
+
+            std::partial_sort(first, middle, std::end(_candidates), compare);
+
+            for (; sorted < batch && freed < _bytes_to_free; ++sorted) {
+                freed += _candidates[sorted].size;
+            }
+        }
+
+        _candidates.resize(sorted);
+
+        return _candidates;
+    } // select_victims
+
+    auto bytes_to_free(std::int64_t _used_bytes, const watermarks& _watermarks) noexcept -> std::int64_t
+    {
+        const auto high = _watermarks.capacity / 100 * _watermarks.high_percent;
+
+        if (_used_bytes <= high) {
+            return 0;
+        }
+
+        const auto low = _watermarks.capacity / 100 * _watermarks.low_percent;
+
+        return _used_bytes - std::min(low, high);
+    } // bytes_to_free
+
+    auto gdsf_value(const access_record& _record, std::int64_t _size) noexcept -> double
+    {
+        // GDSF with a uniform cost: H = L + frequency / size
+        return _record.inflation + static_cast<double>(_record.hits) / std::max<std::int64_t>(_size, 1);
+    } // gdsf_value
+
+    auto make_replica_key(std::string_view _physical_path) noexcept -> std::int64_t
+    {
+        // 64-bit FNV-1a. Unlike std::hash, the value is the same in every process.
+        std::uint64_t hash = 14695981039346656037ull;
+
+        for (const unsigned char c : _physical_path) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+
+        const auto key = static_cast<std::int64_t>(hash);
+
+        // Keys must not collide with the markers of unused slots.
+        return (key == empty_key || key == erased_key) ? 1 : key;
+    } // make_replica_key
+
+    auto init_access_logs() -> void
+    {
+        remove_access_logs();
+
+        g_server_instance = std::chrono::system_clock::now().time_since_epoch().count();
+        g_owner_pid = getpid();
+    } // init_access_logs
+
+    auto deinit_access_logs() noexcept -> void
+    {
+        if (g_owner_pid == getpid()) {
+            remove_access_logs();
+        }
+    } // deinit_access_logs
+
+    access_log::access_log(std::int64_t _resource_id)
+        : table_{std::make_unique<interprocess::shared_memory_object<table>>(
+              fmt::format("{}{}", segment_name_prefix, _resource_id))}
+    {
+    } // access_log
+
+    access_log::~access_log() = default;
+
+    auto access_log::record(std::int64_t _key, std::int64_t _time) -> void
+    {
+        table_->atomic_exec([&](table& _table) {
+            slot* target = nullptr;
+            slot* vacant = nullptr;
+            slot* oldest = nullptr;
+
+            for_each_probe(_table, _key, [&](slot& _s) {
+                if (_s.key == _key) {
+                    target = &_s;
+                    return true;
+                }
+
+                if (_s.key == empty_key || _s.key == erased_key) {
+                    if (!vacant) {
+                        vacant = &_s;
+                    }
+                }
+                else if (!oldest || _s.last_access < oldest->last_access) {
+                    oldest = &_s;
+                }
+
+                return false;
+            });
+
+            if (!target) {
+                target = vacant ? vacant : oldest;
+                *target = slot{_key, 0, 0, 0.0};
+            }
+
+            target->last_access = std::max(target->last_access, _time);
+            ++target->hits;
+            target->inflation = _table.inflation;
+        });
+    } // record
+
+    auto access_log::find(std::int64_t _key) const -> std::optional<access_record>
+    {
+        return table_->atomic_exec([&](const table& _table) -> std::optional<access_record> {
+            if (const auto* s = find_slot(_table, _key); s) {
+                return access_record{s->last_access, s->hits, s->inflation};
+            }
+
+            return std::nullopt;
+        });
+    } // find
+
+    auto access_log::erase(std::int64_t _key) -> void
+    {
+        table_->atomic_exec([&](table& _table) {
+            if (auto* s = const_cast<slot*>(find_slot(_table, _key)); s) {
+                *s = slot{erased_key, 0, 0, 0.0};
+            }
+        });
+    } // erase
+
+    auto access_log::inflation() const -> double
+    {
+        return table_->atomic_exec([](const table& _table) { return _table.inflation; });
+    } // inflation
+
+    auto access_log::inflate(double _value) -> void
+    {
+        table_->atomic_exec([_value](table& _table) {
+            _table.inflation = std::max(_table.inflation, _value);
+        });
+    } // inflate
+
+    auto access_log::try_start_eviction(std::int64_t _now, std::int64_t _interval) -> bool
+    {
+        return table_->atomic_exec([&](table& _table) {
+            if (_table.evictor > 0 && _table.evictor_server_instance == g_server_instance && is_alive(_table.evictor)) {
+                return false;
+            }
+
+            if (_now - _table.last_check < _interval) {
+                return false;
+            }
+
+            _table.last_check = _now;
+            _table.evictor = getpid();
+            _table.evictor_server_instance = g_server_instance;
+
+            return true;
+        });
+    } // try_start_eviction
+
+    auto access_log::finish_eviction() -> void
+    {
+        table_->atomic_exec([](table& _table) {
+            if (_table.evictor == getpid()) {
+                _table.evictor = 0;
+            }
+        });
+    } // finish_eviction
+
+    auto access_log::remove() -> void
+    {
+        table_->remove();
+    } // remove
+} // namespace irods::experimental::cache_eviction
@@ -0,0 +1,531 @@
+#include "catalog_commit_queue.hpp"
+
+#include "catalog.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_exception.hpp"
+#include "irods_logger.hpp"
+#include "irods_server_properties.hpp"
+#include "miscServerFunct.hpp"
+#include "rodsErrorTable.h"
+
+#include "fmt/format.h"
+#include "nanodbc/nanodbc.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+namespace irods::experimental::catalog
+{
+    namespace
+    {
+        using log = irods::experimental::log;
+
+        // The columns of an update, as a bit mask. Selects the prepared statement.
+        constexpr int size_column = 1;
+        constexpr int modify_ts_column = 2;
+        constexpr int replica_status_column = 4;
+
+        auto columns_of(const replica_update& _update) noexcept -> int
+        {
+            return (_update.size ? size_column : 0) |
+                   (_update.modify_ts ? modify_ts_column : 0) |
+                   (_update.replica_status ? replica_status_column : 0);
+        }
+
+        auto make_sql(int _columns) -> std::string
+        {
+            std::string sql{"update R_DATA_MAIN set"};
+
+            if (_columns & size_column) {
+                sql += " data_size = ?,";
+            }
+
+            if (_columns & modify_ts_column) {
+                sql += " modify_ts = ?,";
+            }
+
+            if (_columns & replica_status_column) {
+                sql += " data_is_dirty = ?,";
+            }
+
+            sql.pop_back();
+            sql += " where data_id = ? and resc_id = ?";
+
+            return sql;
+        }
+
+        auto make_commit_function(bool _synchronous_commit) -> commit_queue::commit_function
+        {
+            // The connection is opened by the first commit and reopened after a
+            // database error.
+            return [db = std::optional<std::tuple<std::string, nanodbc::connection>>{},
+                    _synchronous_commit](const std::vector<replica_update>& _updates) mutable {
+                try {
+                    if (!db) {
+                        db = new_database_connection();
+                    }
+
+                    auto& [db_type, db_conn] = *db;
+
+                    execute_transaction(db_conn, [&](nanodbc::transaction& _trans) -> int {
+                        if (!_synchronous_commit && "postgres" == db_type) {
+                            nanodbc::just_execute(db_conn, "set local synchronous_commit to off");
+                        }
+
+                        apply_replica_updates(db_conn, _updates);
+                        _trans.commit();
+
+                        return 0;
+                    });
+                }
+                catch (const nanodbc::database_error& e) {
+                    db.reset();
+                    THROW(SYS_LIBRARY_ERROR, e.what());
+                }
+            };
+        }
+    } // anonymous namespace
+
+    auto to_commit_mode(std::string_view _name) -> commit_mode
+    {
+        if ("immediate" == _name) {
+            return commit_mode::immediate;
+        }
+
+        if ("group" == _name) {
+            return commit_mode::group;
+        }
+
+        THROW(SYS_INVALID_INPUT_PARAM, fmt::format("Invalid commit mode [{}]", _name));
+    } // to_commit_mode
+
+    auto apply_replica_updates(nanodbc::connection& _db_conn, const std::vector<replica_update>& _updates) -> void
+    {
+        // Each combination of columns is prepared once per batch.
+        std::array<std::optional<nanodbc::statement>, 8> statements;
+
+        for (auto&& u : _updates) {
+            const auto columns = columns_of(u);
+
+            if (0 == columns) {
+                continue;
+            }
+
+            auto& statement = statements[columns];
+
+            if (!statement) {
+                const auto sql = make_sql(columns);
+                log::database::debug("statement:[{}]", sql);
+
+                statement.emplace(_db_conn);
+                prepare(*statement, sql);
+            }
+
+            // The values must outlive the call to execute().
+            const std::uint64_t size = u.size.value_or(0);
+            const int replica_status = u.replica_status.value_or(0);
+
+            short index = 0;
+
+            if (u.size) {
+                statement->bind(index++, &size);
+            }
+
+            if (u.modify_ts) {
+                statement->bind(index++, u.modify_ts->c_str());
+            }
+
+            if (u.replica_status) {
+                statement->bind(index++, &replica_status);
+            }
+
+            statement->bind(index++, &u.data_id);
+            statement->bind(index, &u.resc_id);
+
+            execute(*statement);
+        }
+    } // apply_replica_updates
+
+
+    // An update in shared memory.
+    struct update_slot
+    {
+        std::uint64_t data_id;
+        std::uint64_t resc_id;
+        std::int64_t size;
+        int replica_status;
+        int columns;
+        char modify_ts[32];
+    }; // struct update_slot
+
+    struct batch_result
+    {
+        std::uint64_t sequence;
+        int error_code;
+    }; // struct batch_result
+
+    // The results of the most recent batches. A process waiting for a batch reads
+    // its result once woken, long before this many other batches complete.
+    constexpr std::size_t result_count = 256;
+
+    struct commit_queue::shared_state
+    {
+        pthread_mutex_t mutex;
+        pthread_cond_t changed;
+
+        // The process committing a batch, or 0.
+        pid_t leader;
+
+        // The sequence number of the batch being committed.
+        std::uint64_t committing;
+
+        // The sequence number of the batch being collected, and the number of updates
+        // it holds.
+        std::uint64_t open;
+        std::size_t count;
+
+        // Every batch up to this one has been committed or has failed.
+        std::uint64_t completed;
+
+        std::array<batch_result, result_count> results;
+
+        // The updates of the open batch follow the state.
+        auto slots() noexcept -> update_slot*
+        {
+            return reinterpret_cast<update_slot*>(this + 1);
+        }
+    }; // struct commit_queue::shared_state
+
+    // Locks a mutex shared by processes. Recovers the mutex if its owner died while
+    // holding it.
+    class commit_queue::robust_lock
+    {
+    public:
+        explicit robust_lock(pthread_mutex_t& _mutex)
+            : mutex_{_mutex}
+        {
+            lock();
+        }
+
+        robust_lock(const robust_lock&) = delete;
+        auto operator=(const robust_lock&) -> robust_lock& = delete;
+
+        ~robust_lock()
+        {
+            unlock();
+        }
+
+        auto lock() -> void
+        {
+            recover(pthread_mutex_lock(&mutex_));
+        }
+
+        auto unlock() -> void
+        {
+            pthread_mutex_unlock(&mutex_);
+        }
+
+        // Waits at most one second, so that a dead leader is noticed.
+        auto wait(pthread_cond_t& _cond) -> void
+        {
+            timespec deadline{};
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            ++deadline.tv_sec;
+
+            recover(pthread_cond_timedwait(&_cond, &mutex_, &deadline));
+        }
+
+    private:
+        auto recover(int _ec) -> void
+        {
+            if (EOWNERDEAD == _ec) {
+                pthread_mutex_consistent(&mutex_);
+            }
+        }
+
+        pthread_mutex_t& mutex_;
+    }; // class commit_queue::robust_lock
+
+    namespace
+    {
+
+        auto to_slot(const replica_update& _update, update_slot& _slot) noexcept -> void
+        {
+            _slot.data_id = _update.data_id;
+            _slot.resc_id = _update.resc_id;
+            _slot.size = _update.size.value_or(0);
+            _slot.replica_status = _update.replica_status.value_or(0);
+            _slot.columns = columns_of(_update);
+            _slot.modify_ts[0] = '\0';
+
+            if (_update.modify_ts) {
+                std::strncpy(_slot.modify_ts, _update.modify_ts->c_str(), sizeof(_slot.modify_ts) - 1);
+                _slot.modify_ts[sizeof(_slot.modify_ts) - 1] = '\0';
+            }
+        }
+
+        auto from_slot(const update_slot& _slot) -> replica_update
+        {
+            replica_update u;
+            u.data_id = _slot.data_id;
+            u.resc_id = _slot.resc_id;
+
+            if (_slot.columns & size_column) {
+                u.size = _slot.size;
+            }
+
+            if (_slot.columns & modify_ts_column) {
+                u.modify_ts = _slot.modify_ts;
+            }
+
+            if (_slot.columns & replica_status_column) {
+                u.replica_status = _slot.replica_status;
+            }
+
+            return u;
+        }
+
+        // The queue of the server, inherited by every agent.
+        std::unique_ptr<commit_queue> g_queue;
+        pid_t g_owner_pid;
+
+        // Whether the client of this agent set a session ticket.
+        bool g_commit_immediately = false;
+    } // anonymous namespace
+
+    commit_queue::commit_queue(std::size_t _max_batch_size, commit_function _commit)
+        : max_batch_size_{_max_batch_size}
+        , commit_{std::move(_commit)}
+        , owner_pid_{getpid()}
+        , mapping_size_{sizeof(shared_state) + _max_batch_size * sizeof(update_slot)}
+        , state_{}
+    {
+        if (!commit_) {
+            THROW(SYS_INVALID_INPUT_PARAM, "A commit function is required");
+        }
+
+        if (0 == max_batch_size_) {
+            THROW(SYS_INVALID_INPUT_PARAM, "The maximum batch size must be greater than zero");
+        }
+
+        // An anonymous shared mapping is inherited by every process forked from this
+        // one and disappears with the last of them.
+        void* p = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if (MAP_FAILED == p) {
+            throw std::system_error{errno, std::generic_category(), "commit_queue: cannot map shared memory"};
+        }
+
+        state_ = new (p) shared_state{};
+        state_->open = 1;
+
+        pthread_mutexattr_t mutex_attrs;
+        pthread_mutexattr_init(&mutex_attrs);
+        pthread_mutexattr_setpshared(&mutex_attrs, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&mutex_attrs, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&state_->mutex, &mutex_attrs);
+        pthread_mutexattr_destroy(&mutex_attrs);
+
+        pthread_condattr_t cond_attrs;
+        pthread_condattr_init(&cond_attrs);
+        pthread_condattr_setpshared(&cond_attrs, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setclock(&cond_attrs, CLOCK_MONOTONIC);
+        pthread_cond_init(&state_->changed, &cond_attrs);
+        pthread_condattr_destroy(&cond_attrs);
+    } // commit_queue
+
+    commit_queue::~commit_queue()
+    {
+        if (getpid() == owner_pid_) {
+            pthread_cond_destroy(&state_->changed);
+            pthread_mutex_destroy(&state_->mutex);
+        }
+
+        munmap(state_, mapping_size_);
+    } // ~commit_queue
+
+    auto commit_queue::submit(const replica_update& _update) -> int
+    {
+        robust_lock lock{state_->mutex};
+
+        // Any process may commit a full batch which nobody is committing, even if
+        // none of its updates are its own.
+        while (state_->count == max_batch_size_) {
+            if (0 == state_->leader) {
+                commit_open_batch(lock);
+                continue;
+            }
+
+            lock.wait(state_->changed);
+            abandon_batch_of_dead_leader();
+        }
+
+        const auto sequence = state_->open;
+        to_slot(_update, state_->slots()[state_->count++]);
+
+        while (state_->completed < sequence) {
+            // Nobody is committing, so the open batch is the one holding the update.
+            if (0 == state_->leader) {
+                commit_open_batch(lock);
+                continue;
+            }
+
+            lock.wait(state_->changed);
+            abandon_batch_of_dead_leader();
+        }
+
+        if (const auto& result = state_->results[sequence % result_count]; result.sequence == sequence) {
+            return result.error_code;
+        }
+
+        log::database::error("The result of a replica update batch was overwritten before it was read. [batch={}]", sequence);
+
+        return SYS_INTERNAL_ERR;
+    } // submit
+
+    auto commit_queue::commit_open_batch(robust_lock& _lock) -> void
+    {
+        const auto sequence = state_->open;
+
+        std::vector<replica_update> updates;
+        updates.reserve(state_->count);
+        std::transform(state_->slots(), state_->slots() + state_->count, std::back_inserter(updates), from_slot);
+
+        state_->leader = getpid();
+        state_->committing = sequence;
+        state_->count = 0;
+        ++state_->open;
+
+        // Submitters waiting for room in the open batch can proceed.
+        pthread_cond_broadcast(&state_->changed);
+
+        _lock.unlock();
+
+        int ec = 0;
+
+        try {
+            commit_(updates);
+            log::database::debug("Committed [{}] replica updates in one transaction.", updates.size());
+        }
+        catch (const irods::exception& e) {
+            log::database::error(e.client_display_what());
+            ec = e.code();
+        }
+        catch (const std::exception& e) {
+            log::database::error(e.what());
+            ec = SYS_INTERNAL_ERR;
+        }
+
+        _lock.lock();
+
+        // The batch was failed already if this process was taken for dead.
+        if (state_->committing == sequence && state_->leader == getpid()) {
+            state_->results[sequence % result_count] = {sequence, ec};
+            state_->completed = sequence;
+            state_->leader = 0;
+        }
+
+        pthread_cond_broadcast(&state_->changed);
+    } // commit_open_batch
+
+    auto commit_queue::abandon_batch_of_dead_leader() -> void
+    {
+        if (0 == state_->leader || kill(state_->leader, 0) == 0 || ESRCH != errno) {
+            return;
+        }
+
+        log::database::error("The agent committing a batch of replica updates died. The batch may not be committed. "
+                             "[pid={}, batch={}]", state_->leader, state_->committing);
+
+        state_->results[state_->committing % result_count] = {state_->committing, SYS_INTERNAL_ERR};
+        state_->completed = state_->committing;
+        state_->leader = 0;
+
+        pthread_cond_broadcast(&state_->changed);
+    } // abandon_batch_of_dead_leader
+
+    auto init_replica_update_queue() -> void
+    {
+        if (g_queue) {
+            return;
+        }
+
+        try {
+            const auto& mode = irods::get_advanced_setting<const std::string>(irods::CFG_REPLICA_CLOSE_COMMIT_MODE);
+
+            if (commit_mode::immediate == to_commit_mode(mode)) {
+                return;
+            }
+        }
+        catch (const irods::exception& e) {
+            // The setting is optional.
+            if (SYS_INVALID_INPUT_PARAM == e.code()) {
+                log::database::error("Invalid value for [{}]. Committing replica closes immediately.",
+                                     irods::CFG_REPLICA_CLOSE_COMMIT_MODE);
+            }
+
+            return;
+        }
+
+        // Consumers cannot reach the database, so their closes go through the
+        // provider as before.
+        if (std::string role; !get_catalog_service_role(role).ok() || irods::CFG_SERVICE_ROLE_PROVIDER != role) {
+            log::database::debug("Replica close batching only applies to the catalog provider.");
+            return;
+        }
+
+        std::size_t max_batch_size = 256;
+        bool synchronous_commit = true;
+
+        try {
+            if (const auto n = irods::get_advanced_setting<const int>(irods::CFG_REPLICA_CLOSE_COMMIT_BATCH_SIZE); n > 0) {
+                max_batch_size = n;
+            }
+        }
+        catch (const irods::exception&) {}
+
+        try {
+            synchronous_commit = irods::get_advanced_setting<const bool>(irods::CFG_REPLICA_CLOSE_SYNCHRONOUS_COMMIT);
+        }
+        catch (const irods::exception&) {}
+
+        try {
+            g_queue = std::make_unique<commit_queue>(max_batch_size, make_commit_function(synchronous_commit));
+            g_owner_pid = getpid();
+        }
+        catch (const std::system_error& e) {
+            log::database::error("{}. Committing replica closes immediately.", e.what());
+        }
+    } // init_replica_update_queue
+
+    auto deinit_replica_update_queue() noexcept -> void
+    {
+        if (g_queue && getpid() == g_owner_pid) {
+            g_queue.reset();
+        }
+    } // deinit_replica_update_queue
+
+    auto commit_replica_updates_immediately() noexcept -> void
+    {
+        g_commit_immediately = true;
+    } // commit_replica_updates_immediately
+
+    auto replica_update_queue() noexcept -> commit_queue*
+    {
+        return g_commit_immediately ? nullptr : g_queue.get();
+    } // replica_update_queue
+} // namespace irods::experimental::catalog
@@ -0,0 +1,335 @@
+#include "coprocess.hpp"
+
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    // How long the destructor waits for the program to exit before killing it.
+    constexpr auto exit_timeout = std::chrono::seconds{5};
+
+    auto reap(pid_t _pid, bool _kill) noexcept -> void
+    {
+        if (_kill) {
+            kill(_pid, SIGKILL);
+        }
+
+        while (waitpid(_pid, nullptr, 0) < 0 && EINTR == errno);
+    }
+} // anonymous namespace
+
+namespace irods
+{
+    coprocess::coprocess(const std::string& _program, const std::vector<std::string>& _args)
+        : owner_{getpid()}
+        , pid_{-1}
+        , fd_{-1}
+        , next_id_{0}
+        , in_{}
+        , responses_{}
+    {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) < 0) {
+            THROW(SYS_SOCK_OPEN_ERR - errno, fmt::format("Cannot create the socket for coprocess [{}].", _program));
+        }
+
+        // Reports a failure to execute the program. It is closed by a successful exec.
+        int exec_error[2];
+        if (pipe2(exec_error, O_CLOEXEC) < 0) {
+            const int ec = errno;
+            close(sockets[0]);
+            close(sockets[1]);
+            THROW(SYS_PIPE_ERROR - ec, fmt::format("Cannot create the pipe for coprocess [{}].", _program));
+        }
+
+        // The argument vector is built before forking, which keeps the child free of allocations.
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(_program.c_str()));
+        for (auto&& a : _args) {
+            argv.push_back(const_cast<char*>(a.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        const long max_fd = std::min(sysconf(_SC_OPEN_MAX), 65536L);
+
+        pid_ = fork();
+
+        if (0 == pid_) {
+            dup2(sockets[1], STDIN_FILENO);
+            dup2(sockets[1], STDOUT_FILENO);
+
+            // The program must not hold on to the client connection and files of the agent.
+            const int err_fd = exec_error[1];
+            for (int fd = 3; fd < max_fd; ++fd) {
+                if (fd != err_fd) {
+                    close(fd);
+                }
+            }
+
+            execv(argv[0], argv.data());
+
+            const int ec = errno;
+            [[maybe_unused]] const auto n = write(err_fd, &ec, sizeof(ec));
+            _exit(127);
+        }
+
+        close(sockets[1]);
+        close(exec_error[1]);
+
+        if (pid_ < 0) {
+            const int ec = errno;
+            close(sockets[0]);
+            close(exec_error[0]);
+            THROW(SYS_FORK_ERROR - ec, fmt::format("Cannot fork coprocess [{}].", _program));
+        }
+
+        int ec = 0;
+        ssize_t n;
+        while ((n = read(exec_error[0], &ec, sizeof(ec))) < 0 && EINTR == errno);
+        close(exec_error[0]);
+
+        if (n > 0) {
+            close(sockets[0]);
+            reap(pid_, false);
+            THROW(SYS_FORK_ERROR - ec, fmt::format("Cannot execute coprocess [{}]: {}", _program, std::strerror(ec)));
+        }
+
+        fd_ = sockets[0];
+    } // coprocess
+
+    coprocess::~coprocess()
+    {
+        if (!owned()) {
+            release();
+            return;
+        }
+
+        if (fd_ < 0) {
+            return;
+        }
+
+        // The program exits when it reads the end of its input.
+        close(fd_);
+        fd_ = -1;
+
+        const auto deadline = std::chrono::steady_clock::now() + exit_timeout;
+
+        while (std::chrono::steady_clock::now() < deadline) {
+            const auto ec = waitpid(pid_, nullptr, WNOHANG);
+
+            if (ec == pid_ || (ec < 0 && EINTR != errno)) {
+                return;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+
+        reap(pid_, true);
+    } // ~coprocess
+
+    auto coprocess::owned() const noexcept -> bool
+    {
+        return getpid() == owner_;
+    } // owned
+
+    auto coprocess::release() noexcept -> void
+    {
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+
+        pid_ = -1;
+    } // release
+
+    auto coprocess::submit(std::string_view _operation, const std::vector<std::string>& _args) -> std::uint64_t
+    {
+        if (fd_ < 0) {
+            THROW(SYS_SOCK_WRITE_ERR, "The coprocess is not running.");
+        }
+
+        const auto newline = [](std::string_view _s) { return _s.find('\n') != std::string_view::npos; };
+
+        if (newline(_operation) || std::any_of(std::begin(_args), std::end(_args), newline)) {
+            THROW(SYS_INVALID_INPUT_PARAM, "Coprocess requests cannot contain newlines.");
+        }
+
+        const auto id = next_id_++;
+
+        auto payload = fmt::format("{} {}", id, _operation);
+        for (auto&& a : _args) {
+            payload += '\n';
+            payload += a;
+        }
+
+        const auto request = fmt::format("{}\n{}", payload.size(), payload);
+
+        // Responses are read while the request is written. Otherwise the program could
+        // block writing responses to pipelined requests while this process blocks
+        // writing a request the program is not reading.
+        for (std::size_t offset = 0; offset < request.size();) {
+            pollfd pfd{fd_, POLLIN | POLLOUT, 0};
+
+            if (poll(&pfd, 1, -1) < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                fail(SYS_SOCK_WRITE_ERR - errno, "Cannot poll the coprocess.");
+            }
+
+            if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+                read_available(false);
+            }
+
+            if (pfd.revents & POLLOUT) {
+                const auto n = send(fd_, request.data() + offset, request.size() - offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+                if (n < 0) {
+                    if (EINTR == errno || EAGAIN == errno || EWOULDBLOCK == errno) {
+                        continue;
+                    }
+
+                    fail(SYS_SOCK_WRITE_ERR - errno, "Cannot send a request to the coprocess.");
+                }
+
+                offset += n;
+            }
+        }
+
+        return id;
+    } // submit
+
+    auto coprocess::wait(std::uint64_t _id) -> response
+    {
+        if (_id >= next_id_) {
+            THROW(SYS_INVALID_INPUT_PARAM, fmt::format("No coprocess request has the ID [{}].", _id));
+        }
+
+        auto iter = responses_.find(_id);
+
+        while (iter == std::end(responses_)) {
+            if (fd_ < 0) {
+                THROW(SYS_SOCK_READ_ERR, "The coprocess is not running.");
+            }
+
+            read_available(true);
+            iter = responses_.find(_id);
+        }
+
+        auto r = std::move(iter->second);
+        responses_.erase(iter);
+
+        return r;
+    } // wait
+
+    auto coprocess::fail(int _ec, const std::string& _msg) -> void
+    {
+        close(fd_);
+        fd_ = -1;
+
+        reap(pid_, true);
+
+        THROW(_ec, _msg);
+    } // fail
+
+    auto coprocess::read_available(bool _block) -> void
+    {
+        char buffer[64 * 1024];
+
+        const auto n = recv(fd_, buffer, sizeof(buffer), _block ? 0 : MSG_DONTWAIT);
+
+        if (n < 0) {
+            if (EINTR == errno || EAGAIN == errno || EWOULDBLOCK == errno) {
+                return;
+            }
+
+            fail(SYS_SOCK_READ_ERR - errno, "Cannot read from the coprocess.");
+        }
+
+        if (0 == n) {
+            fail(SYS_SOCK_READ_ERR, "The coprocess exited.");
+        }
+
+        in_.append(buffer, n);
+
+        std::size_t offset = 0;
+
+        while (true) {
+            const auto header_end = in_.find('\n', offset);
+            if (header_end == std::string::npos) {
+                break;
+            }
+
+            std::size_t length = 0;
+            const auto header = std::string_view{in_}.substr(offset, header_end - offset);
+
+            if (header.empty() || !std::all_of(std::begin(header), std::end(header), [](char _c) { return _c >= '0' && _c <= '9'; })) {
+                fail(SYS_SOCK_READ_ERR, "The coprocess sent a malformed response.");
+            }
+
+            for (char c : header) {
+                length = length * 10 + (c - '0');
+            }
+
+            if (in_.size() - header_end - 1 < length) {
+                break;
+            }
+
+            const auto payload = std::string_view{in_}.substr(header_end + 1, length);
+            offset = header_end + 1 + length;
+
+            // "<id> <status>\n<output>"
+            const auto line_end = std::min(payload.find('\n'), payload.size());
+            const auto line = std::string(payload.substr(0, line_end));
+
+            unsigned long long id{};
+            int status{};
+            if (std::sscanf(line.c_str(), "%llu %d", &id, &status) != 2) {
+                fail(SYS_SOCK_READ_ERR, "The coprocess sent a malformed response.");
+            }
+
+            const auto output = line_end < payload.size() ? payload.substr(line_end + 1) : std::string_view{};
+            responses_[id] = response{status, std::string{output}};
+        }
+
+        in_.erase(0, offset);
+    } // read_available
+
+    auto get_coprocess(const std::string& _program) -> coprocess&
+    {
+        static std::map<std::string, std::unique_ptr<coprocess>> coprocesses;
+
+        auto& cp = coprocesses[_program];
+
+        if (cp && cp->owned() && cp->running()) {
+            return *cp;
+        }
+
+        if (cp && !cp->owned()) {
+            cp->release();
+        }
+
+        cp.reset();
+        cp = std::make_unique<coprocess>(_program);
+
+        return *cp;
+    } // get_coprocess
+} // namespace irods
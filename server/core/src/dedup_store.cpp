@@ -0,0 +1,738 @@
+#include "dedup_store.hpp"
+
+#include "irods_at_scope_exit.hpp"
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+#include <json.hpp>
+#include <openssl/evp.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace irods::experimental::dedup
+{
+    namespace
+    {
+        // The reference count at the front of every chunk file.
+        constexpr std::size_t chunk_header_size = sizeof(std::uint64_t);
+
+        constexpr char manifest_magic[16] = "iRODS-dedup-v1\n";
+        constexpr std::size_t manifest_header_size = sizeof(manifest_magic) + 2 * sizeof(std::uint64_t);
+        constexpr std::size_t manifest_entry_size = sizeof(std::uint32_t) + std::tuple_size_v<digest>;
+
+        // The gear table of the rolling hash. Generated with splitmix64 so that chunk
+        // boundaries, and therefore digests, never change between builds.
+        constexpr auto make_gear_table() -> std::array<std::uint64_t, 256>
+        {
+            std::array<std::uint64_t, 256> table{};
+            std::uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+            for (auto& v : table) {
+                std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                v = z ^ (z >> 31);
+            }
+
+            return table;
+        } // make_gear_table
+
+        constexpr auto gear = make_gear_table();
+
+        // A mask of the top _bits bits. The top bits of a gear hash depend on the most
+        // bytes.
+        constexpr auto top_bits(int _bits) noexcept -> std::uint64_t
+        {
+            return ~std::uint64_t{0} << (64 - _bits);
+        }
+
+        auto put_le64(unsigned char* _p, std::uint64_t _v) noexcept -> void
+        {
+            for (int i = 0; i < 8; ++i) {
+                _p[i] = static_cast<unsigned char>(_v >> (8 * i));
+            }
+        }
+
+        auto get_le64(const unsigned char* _p) noexcept -> std::uint64_t
+        {
+            std::uint64_t v = 0;
+            for (int i = 7; i >= 0; --i) {
+                v = (v << 8) | _p[i];
+            }
+            return v;
+        }
+
+        auto put_le32(unsigned char* _p, std::uint32_t _v) noexcept -> void
+        {
+            for (int i = 0; i < 4; ++i) {
+                _p[i] = static_cast<unsigned char>(_v >> (8 * i));
+            }
+        }
+
+        auto get_le32(const unsigned char* _p) noexcept -> std::uint32_t
+        {
+            std::uint32_t v = 0;
+            for (int i = 3; i >= 0; --i) {
+                v = (v << 8) | _p[i];
+            }
+            return v;
+        }
+
+        auto full_pread(int _fd, void* _buffer, std::size_t _size, off_t _offset) -> std::size_t
+        {
+            auto* p = static_cast<char*>(_buffer);
+            std::size_t total = 0;
+
+            while (total < _size) {
+                const auto n = ::pread(_fd, p + total, _size - total, _offset + total);
+
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    THROW(UNIX_FILE_READ_ERR - errno, "dedup: read error");
+                }
+
+                if (0 == n) {
+                    break;
+                }
+
+                total += n;
+            }
+
+            return total;
+        } // full_pread
+
+        auto full_pwrite(int _fd, const void* _buffer, std::size_t _size, off_t _offset) -> void
+        {
+            const auto* p = static_cast<const char*>(_buffer);
+            std::size_t total = 0;
+
+            while (total < _size) {
+                const auto n = ::pwrite(_fd, p + total, _size - total, _offset + total);
+
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    THROW(UNIX_FILE_WRITE_ERR - errno, "dedup: write error");
+                }
+
+                total += n;
+            }
+        } // full_pwrite
+
+        // Opens the chunk file at _path and locks it. Retries if the file was removed
+        // between the open and the lock, so the caller always holds the lock on the
+        // file the path names.
+        auto open_and_lock(const std::string& _path, int _flags) -> int
+        {
+            while (true) {
+                const int fd = ::open(_path.c_str(), _flags | O_CLOEXEC, 0600);
+
+                if (fd < 0) {
+                    if (ENOENT == errno && (_flags & O_CREAT)) {
+                        boost::system::error_code ec;
+                        boost::filesystem::create_directories(boost::filesystem::path{_path}.parent_path(), ec);
+
+                        if (!ec) {
+                            continue;
+                        }
+                    }
+
+                    return -errno;
+                }
+
+                if (::flock(fd, LOCK_EX) < 0) {
+                    const int err = errno;
+                    ::close(fd);
+                    return -err;
+                }
+
+                struct stat st{};
+                if (::fstat(fd, &st) == 0 && st.st_nlink > 0) {
+                    return fd;
+                }
+
+                // Removed by the last release of the chunk.
+                ::close(fd);
+            }
+        } // open_and_lock
+
+        auto microseconds_since(std::chrono::steady_clock::time_point _start) -> std::int64_t
+        {
+            using namespace std::chrono;
+            return duration_cast<microseconds>(steady_clock::now() - _start).count();
+        }
+    } // anonymous namespace
+
+    auto hash(const void* _data, std::size_t _size) -> digest
+    {
+        digest d{};
+        unsigned int length = 0;
+
+        if (!EVP_Digest(_data, _size, d.data(), &length, EVP_sha256(), nullptr) || length != d.size()) {
+            THROW(SYS_LIBRARY_ERROR, "dedup: SHA-256 failed");
+        }
+
+        return d;
+    } // hash
+
+    auto to_hex(const digest& _digest) -> std::string
+    {
+        constexpr char digits[] = "0123456789abcdef";
+
+        std::string hex(2 * _digest.size(), '0');
+        for (std::size_t i = 0; i < _digest.size(); ++i) {
+            hex[2 * i] = digits[_digest[i] >> 4];
+            hex[2 * i + 1] = digits[_digest[i] & 0xf];
+        }
+
+        return hex;
+    } // to_hex
+
+    chunker::chunker(const chunking_parameters& _params)
+        : params_{_params}
+        , mask_small_{}
+        , mask_large_{}
+    {
+        const auto avg = params_.average_size;
+
+        if (params_.min_size < 64 || params_.min_size >= avg || avg >= params_.max_size ||
+            params_.max_size > std::numeric_limits<std::uint32_t>::max() || 0 != (avg & (avg - 1)))
+        {
+            THROW(SYS_INVALID_INPUT_PARAM,
+                  fmt::format("dedup: invalid chunk sizes [min={}, average={}, max={}]",
+                              params_.min_size, avg, params_.max_size));
+        }
+
+        int bits = 0;
+        while ((std::size_t{1} << bits) < avg) {
+            ++bits;
+        }
+
+        // Cutting is harder before the average size and easier after it, which
+        // narrows the distribution of chunk sizes.
+        mask_small_ = top_bits(std::min(bits + 2, 63));
+        mask_large_ = top_bits(std::max(bits - 2, 1));
+    } // chunker
+
+    auto chunker::next(const unsigned char* _data, std::size_t _size) const noexcept -> std::size_t
+    {
+        if (_size <= params_.min_size) {
+            return _size;
+        }
+
+        const auto end = std::min(_size, params_.max_size);
+        const auto normal = std::min(end, params_.average_size);
+
+        std::uint64_t h = 0;
+        std::size_t i = params_.min_size;
+
+        for (; i < normal; ++i) {
+            h = (h << 1) + gear[_data[i]];
+            if (0 == (h & mask_small_)) {
+                return i + 1;
+            }
+        }
+
+        for (; i < end; ++i) {
+            h = (h << 1) + gear[_data[i]];
+            if (0 == (h & mask_large_)) {
+                return i + 1;
+            }
+        }
+
+        return end;
+    } // chunker::next
+
+    chunk_store::chunk_store(std::string _root)
+        : root_{std::move(_root)}
+    {
+    } // chunk_store
+
+    auto chunk_store::path(const digest& _id) const -> std::string
+    {
+        const auto hex = to_hex(_id);
+        return fmt::format("{}/{}/{}/{}", root_, hex.substr(0, 2), hex.substr(2, 2), hex);
+    } // chunk_store::path
+
+    auto chunk_store::add(const digest& _id, const void* _data, std::size_t _size) -> bool
+    {
+        const auto p = path(_id);
+        const int fd = open_and_lock(p, O_RDWR | O_CREAT);
+
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR + fd, fmt::format("dedup: cannot open chunk [{}]", p));
+        }
+
+        // Closing the descriptor releases the lock.
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+
+        unsigned char header[chunk_header_size]{};
+        const auto n = full_pread(fd, header, sizeof(header), 0);
+        const auto refs = (n == sizeof(header)) ? get_le64(header) : 0;
+
+        // A chunk without references is new, or was left behind by a failed add.
+        const bool stored = (0 == refs);
+
+        if (stored) {
+            if (::ftruncate(fd, 0) < 0) {
+                THROW(UNIX_FILE_TRUNCATE_ERR - errno, fmt::format("dedup: cannot truncate chunk [{}]", p));
+            }
+            full_pwrite(fd, _data, _size, chunk_header_size);
+        }
+
+        // The count is written last, so a chunk with references is always complete.
+        put_le64(header, refs + 1);
+        full_pwrite(fd, header, sizeof(header), 0);
+
+        return stored;
+    } // chunk_store::add
+
+    auto chunk_store::read(const digest& _id, std::size_t _size) const -> std::vector<char>
+    {
+        const auto p = path(_id);
+        const int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("dedup: cannot open chunk [{}]", p));
+        }
+
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+
+        std::vector<char> data(_size);
+        if (full_pread(fd, data.data(), _size, chunk_header_size) != _size) {
+            THROW(SYS_COPY_LEN_ERR, fmt::format("dedup: chunk [{}] is truncated", p));
+        }
+
+        return data;
+    } // chunk_store::read
+
+    auto chunk_store::release(const digest& _id) -> std::int64_t
+    {
+        const auto p = path(_id);
+        const int fd = open_and_lock(p, O_RDWR);
+
+        if (fd < 0) {
+            if (-ENOENT == fd) {
+                return 0;
+            }
+            THROW(UNIX_FILE_OPEN_ERR + fd, fmt::format("dedup: cannot open chunk [{}]", p));
+        }
+
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+
+        unsigned char header[chunk_header_size]{};
+        const auto refs = (full_pread(fd, header, sizeof(header), 0) == sizeof(header)) ? get_le64(header) : 0;
+
+        if (refs > 1) {
+            put_le64(header, refs - 1);
+            full_pwrite(fd, header, sizeof(header), 0);
+            return 0;
+        }
+
+        struct stat st{};
+        ::fstat(fd, &st);
+
+        // Removed while locked. Anyone waiting on the lock sees the link count drop
+        // to zero and opens the path again.
+        if (::unlink(p.c_str()) < 0 && ENOENT != errno) {
+            THROW(UNIX_FILE_UNLINK_ERR - errno, fmt::format("dedup: cannot remove chunk [{}]", p));
+        }
+
+        return std::max<std::int64_t>(st.st_size - chunk_header_size, 0);
+    } // chunk_store::release
+
+    auto chunk_store::update_statistics(const store_statistics& _delta) -> store_statistics
+    {
+        const auto p = root_ + "/statistics.json";
+
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(root_, ec);
+
+        const int fd = ::open(p.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("dedup: cannot open [{}]", p));
+        }
+
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+
+        if (::flock(fd, LOCK_EX) < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("dedup: cannot lock [{}]", p));
+        }
+
+        std::string text(4096, '\0');
+        text.resize(full_pread(fd, text.data(), text.size(), 0));
+
+        store_statistics s;
+
+        if (!text.empty()) {
+            const auto json = nlohmann::json::parse(text, nullptr, false);
+
+            if (json.is_object()) {
+                s.logical_bytes = json.value("logical_bytes", std::int64_t{});
+                s.stored_bytes = json.value("stored_bytes", std::int64_t{});
+                s.chunks = json.value("chunks", std::int64_t{});
+                s.ingested_bytes = json.value("ingested_bytes", std::int64_t{});
+                s.ingest_microseconds = json.value("ingest_microseconds", std::int64_t{});
+                s.read_bytes = json.value("read_bytes", std::int64_t{});
+                s.read_microseconds = json.value("read_microseconds", std::int64_t{});
+            }
+        }
+
+        s.logical_bytes += _delta.logical_bytes;
+        s.stored_bytes += _delta.stored_bytes;
+        s.chunks += _delta.chunks;
+        s.ingested_bytes += _delta.ingested_bytes;
+        s.ingest_microseconds += _delta.ingest_microseconds;
+        s.read_bytes += _delta.read_bytes;
+        s.read_microseconds += _delta.read_microseconds;
+
+        const auto mib_per_second = [](std::int64_t _bytes, std::int64_t _us) {
+            return _us > 0 ? (_bytes / 1048576.0) / (_us / 1e6) : 0.0;
+        };
+
+        const auto out = nlohmann::json{{"logical_bytes", s.logical_bytes},
+                                        {"stored_bytes", s.stored_bytes},
+                                        {"chunks", s.chunks},
+                                        {"dedup_ratio", s.dedup_ratio()},
+                                        {"ingested_bytes", s.ingested_bytes},
+                                        {"ingest_microseconds", s.ingest_microseconds},
+                                        {"ingest_mib_per_second", mib_per_second(s.ingested_bytes, s.ingest_microseconds)},
+                                        {"read_bytes", s.read_bytes},
+                                        {"read_microseconds", s.read_microseconds},
+                                        {"read_mib_per_second", mib_per_second(s.read_bytes, s.read_microseconds)}}.dump(4);
+
+        if (::ftruncate(fd, 0) < 0) {
+            THROW(UNIX_FILE_TRUNCATE_ERR - errno, fmt::format("dedup: cannot truncate [{}]", p));
+        }
+        full_pwrite(fd, out.data(), out.size(), 0);
+
+        return s;
+    } // chunk_store::update_statistics
+
+    auto chunk_store::statistics() const -> store_statistics
+    {
+        return const_cast<chunk_store*>(this)->update_statistics({});
+    } // chunk_store::statistics
+
+    auto read_manifest(const std::string& _path) -> std::optional<manifest>
+    {
+        const int fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("dedup: cannot open [{}]", _path));
+        }
+
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+
+        unsigned char header[manifest_header_size]{};
+        if (full_pread(fd, header, sizeof(header), 0) != sizeof(header) ||
+            std::memcmp(header, manifest_magic, sizeof(manifest_magic)) != 0)
+        {
+            return std::nullopt;
+        }
+
+        manifest m;
+        m.size = static_cast<std::int64_t>(get_le64(header + sizeof(manifest_magic)));
+        const auto count = get_le64(header + sizeof(manifest_magic) + 8);
+
+        struct stat st{};
+        if (::fstat(fd, &st) < 0 ||
+            static_cast<std::uint64_t>(st.st_size) != manifest_header_size + count * manifest_entry_size)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<unsigned char> data(count * manifest_entry_size);
+        if (full_pread(fd, data.data(), data.size(), manifest_header_size) != data.size()) {
+            THROW(SYS_COPY_LEN_ERR, fmt::format("dedup: manifest [{}] is truncated", _path));
+        }
+
+        m.entries.resize(count);
+        std::int64_t total = 0;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto* p = data.data() + i * manifest_entry_size;
+            m.entries[i].size = get_le32(p);
+            std::copy(p + 4, p + manifest_entry_size, m.entries[i].id.begin());
+            total += m.entries[i].size;
+        }
+
+        if (total != m.size) {
+            THROW(SYS_INTERNAL_ERR, fmt::format("dedup: manifest [{}] is inconsistent", _path));
+        }
+
+        return m;
+    } // read_manifest
+
+    auto read_manifest_size(const std::string& _path) -> std::optional<std::int64_t>
+    {
+        const int fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("dedup: cannot open [{}]", _path));
+        }
+
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+
+        unsigned char header[manifest_header_size]{};
+        if (full_pread(fd, header, sizeof(header), 0) != sizeof(header) ||
+            std::memcmp(header, manifest_magic, sizeof(manifest_magic)) != 0)
+        {
+            return std::nullopt;
+        }
+
+        return static_cast<std::int64_t>(get_le64(header + sizeof(manifest_magic)));
+    } // read_manifest_size
+
+    auto write_manifest(const std::string& _path, const manifest& _manifest, int _mode) -> void
+    {
+        std::vector<unsigned char> data(manifest_header_size + _manifest.entries.size() * manifest_entry_size);
+
+        std::memcpy(data.data(), manifest_magic, sizeof(manifest_magic));
+        put_le64(data.data() + sizeof(manifest_magic), _manifest.size);
+        put_le64(data.data() + sizeof(manifest_magic) + 8, _manifest.entries.size());
+
+        auto* p = data.data() + manifest_header_size;
+        for (auto&& e : _manifest.entries) {
+            put_le32(p, e.size);
+            std::copy(e.id.begin(), e.id.end(), p + 4);
+            p += manifest_entry_size;
+        }
+
+        // Written beside the target and renamed over it, so readers see the old or
+        // the new manifest and never a partial one.
+        const auto tmp = fmt::format("{}.dedup_manifest.{}", _path, getpid());
+        const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, _mode);
+        if (fd < 0) {
+            THROW(UNIX_FILE_CREATE_ERR - errno, fmt::format("dedup: cannot create [{}]", tmp));
+        }
+
+        try {
+            full_pwrite(fd, data.data(), data.size(), 0);
+        }
+        catch (...) {
+            ::close(fd);
+            ::unlink(tmp.c_str());
+            throw;
+        }
+
+        ::close(fd);
+
+        if (::rename(tmp.c_str(), _path.c_str()) < 0) {
+            const int err = errno;
+            ::unlink(tmp.c_str());
+            THROW(UNIX_FILE_RENAME_ERR - err, fmt::format("dedup: cannot replace [{}]", _path));
+        }
+    } // write_manifest
+
+    auto ingest(chunk_store& _store, const chunker& _chunker, int _fd) -> ingest_result
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        ingest_result result;
+
+        try {
+            // Room for several chunks, so the buffer is refilled rarely.
+            std::vector<unsigned char> buffer(4 * _chunker.max_size());
+            std::size_t begin = 0;
+            std::size_t end = 0;
+            off_t offset = 0;
+            bool eof = false;
+
+            while (true) {
+                if (!eof && end - begin < _chunker.max_size()) {
+                    std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                    end -= begin;
+                    begin = 0;
+
+                    const auto n = full_pread(_fd, buffer.data() + end, buffer.size() - end, offset);
+                    offset += n;
+                    end += n;
+                    eof = (end < buffer.size());
+                }
+
+                if (begin == end) {
+                    break;
+                }
+
+                const auto size = _chunker.next(buffer.data() + begin, end - begin);
+                const auto id = hash(buffer.data() + begin, size);
+
+                result.file.entries.push_back({id, static_cast<std::uint32_t>(size)});
+                result.file.size += size;
+
+                if (_store.add(id, buffer.data() + begin, size)) {
+                    result.new_bytes += size;
+                    ++result.new_chunks;
+                }
+
+                begin += size;
+            }
+        }
+        catch (...) {
+            release(_store, result.file);
+            throw;
+        }
+
+        store_statistics delta;
+        delta.logical_bytes = result.file.size;
+        delta.stored_bytes = result.new_bytes;
+        delta.chunks = result.new_chunks;
+        delta.ingested_bytes = result.file.size;
+        delta.ingest_microseconds = microseconds_since(start);
+
+        try {
+            _store.update_statistics(delta);
+        }
+        catch (const irods::exception& e) {
+            rodsLog(LOG_ERROR, "dedup: cannot update the statistics of [%s]: %s",
+                    _store.root().c_str(), e.client_display_what());
+        }
+
+        return result;
+    } // ingest
+
+    auto release(chunk_store& _store, const manifest& _manifest) -> void
+    {
+        store_statistics delta;
+        delta.logical_bytes = -_manifest.size;
+
+        for (auto&& e : _manifest.entries) {
+            try {
+                if (const auto removed = _store.release(e.id); removed > 0) {
+                    delta.stored_bytes -= removed;
+                    --delta.chunks;
+                }
+            }
+            catch (const irods::exception& e) {
+                rodsLog(LOG_ERROR, "dedup: %s", e.client_display_what());
+            }
+        }
+
+        try {
+            _store.update_statistics(delta);
+        }
+        catch (const irods::exception& e) {
+            rodsLog(LOG_ERROR, "dedup: cannot update the statistics of [%s]: %s",
+                    _store.root().c_str(), e.client_display_what());
+        }
+    } // release
+
+    auto reassemble(const chunk_store& _store, const manifest& _manifest, int _fd) -> void
+    {
+        off_t offset = 0;
+
+        for (auto&& e : _manifest.entries) {
+            const auto data = _store.read(e.id, e.size);
+            full_pwrite(_fd, data.data(), data.size(), offset);
+            offset += data.size();
+        }
+
+        if (::ftruncate(_fd, offset) < 0) {
+            THROW(UNIX_FILE_TRUNCATE_ERR - errno, "dedup: cannot truncate the reassembled file");
+        }
+    } // reassemble
+
+    manifest_reader::manifest_reader(chunk_store _store, manifest _manifest, int _threads, std::size_t _window)
+        : store_{std::move(_store)}
+        , manifest_{std::move(_manifest)}
+        , offsets_{}
+        , window_{std::max<std::size_t>(_window, 1)}
+        , loaded_{}
+        , bytes_read_{}
+        , microseconds_{}
+        , pool_{std::max(_threads, 1)}
+    {
+        offsets_.reserve(manifest_.entries.size());
+
+        std::int64_t offset = 0;
+        for (auto&& e : manifest_.entries) {
+            offsets_.push_back(offset);
+            offset += e.size;
+        }
+    } // manifest_reader
+
+    manifest_reader::~manifest_reader()
+    {
+        pool_.stop();
+        pool_.join();
+    } // ~manifest_reader
+
+    auto manifest_reader::chunk_at(std::int64_t _offset) const -> std::size_t
+    {
+        const auto iter = std::upper_bound(std::begin(offsets_), std::end(offsets_), _offset);
+        return std::distance(std::begin(offsets_), iter) - 1;
+    } // manifest_reader::chunk_at
+
+    auto manifest_reader::prefetch(std::size_t _first) -> void
+    {
+        const auto last = std::min(_first + window_, manifest_.entries.size());
+
+        for (auto iter = std::begin(loaded_); iter != std::end(loaded_);) {
+            if (iter->first < _first || iter->first >= last) {
+                iter = loaded_.erase(iter);
+            }
+            else {
+                ++iter;
+            }
+        }
+
+        for (auto i = _first; i < last; ++i) {
+            if (loaded_.count(i) > 0) {
+                continue;
+            }
+
+            auto promise = std::make_shared<std::promise<chunk_data>>();
+            loaded_.emplace(i, promise->get_future().share());
+
+            // The task owns everything it uses, so it may outlive this reader's
+            // interest in the chunk.
+            irods::thread_pool::post(pool_, [promise, store = store_, entry = manifest_.entries[i]] {
+                try {
+                    promise->set_value(std::make_shared<const std::vector<char>>(store.read(entry.id, entry.size)));
+                }
+                catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+        }
+    } // manifest_reader::prefetch
+
+    auto manifest_reader::read(std::int64_t _offset, void* _buffer, std::size_t _size) -> std::size_t
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        auto* out = static_cast<char*>(_buffer);
+        std::size_t total = 0;
+
+        while (total < _size && _offset < manifest_.size) {
+            const auto i = chunk_at(_offset);
+            prefetch(i);
+
+            const auto data = loaded_.at(i).get();
+            const auto within = static_cast<std::size_t>(_offset - offsets_[i]);
+            const auto n = std::min(_size - total, data->size() - within);
+
+            std::memcpy(out + total, data->data() + within, n);
+            total += n;
+            _offset += n;
+        }
+
+        bytes_read_ += total;
+        microseconds_ += microseconds_since(start);
+
+        return total;
+    } // manifest_reader::read
+} // namespace irods::experimental::dedup
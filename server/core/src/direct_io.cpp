@@ -0,0 +1,229 @@
+#include "direct_io.hpp"
+
+#include "rodsLog.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    namespace io = irods::io_engine;
+
+    enum class direction
+    {
+        read,
+        write
+    };
+
+    // The largest number of bytes moved by a single O_DIRECT system call.
+    // This is also the size of the bounce buffer.
+    constexpr rodsLong_t max_direct_request_size = 8 * 1024 * 1024;
+
+    // An aligned buffer used when the caller's memory is not suitably aligned.
+    class bounce_buffer
+    {
+    public:
+        bounce_buffer() = default;
+
+        bounce_buffer(const bounce_buffer&) = delete;
+        auto operator=(const bounce_buffer&) -> bounce_buffer& = delete;
+
+        ~bounce_buffer()
+        {
+            std::free(data_);
+        }
+
+        // Returns a buffer of max_direct_request_size bytes aligned to _alignment,
+        // or nullptr if the memory could not be allocated.
+        auto get(rodsLong_t _alignment) -> char*
+        {
+            if (data_ && _alignment <= alignment_) {
+                return data_;
+            }
+
+            std::free(data_);
+            data_ = nullptr;
+
+            void* p = nullptr;
+            if (posix_memalign(&p, _alignment, max_direct_request_size) != 0) {
+                return nullptr;
+            }
+
+            data_ = static_cast<char*>(p);
+            alignment_ = _alignment;
+
+            return data_;
+        }
+
+    private:
+        char* data_ = nullptr;
+        rodsLong_t alignment_ = 0;
+    }; // class bounce_buffer
+
+    thread_local bounce_buffer bounce;
+
+    auto is_aligned(const void* _p, rodsLong_t _alignment) noexcept -> bool
+    {
+        return reinterpret_cast<std::uintptr_t>(_p) % _alignment == 0;
+    }
+
+    auto buffered(direction _dir, const io::config& _io_config, int _fd, char* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t
+    {
+        return (direction::read == _dir)
+            ? io::pread(_io_config, _fd, _buffer, _length, _offset)
+            : io::pwrite(_io_config, _fd, _buffer, _length, _offset);
+    }
+
+    // Transfers an aligned section through the O_DIRECT descriptor.
+    //
+    // Stops early, without an error, when the device rejects the request or a short
+    // transfer leaves the position unaligned. The caller finishes the remainder
+    // through the page cache. A short read therefore also covers end-of-file.
+    auto direct(direction _dir, rodsLong_t _alignment, int _direct_fd, char* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t
+    {
+        const bool use_bounce_buffer = !is_aligned(_buffer, _alignment);
+        char* bounce_data = use_bounce_buffer ? bounce.get(_alignment) : nullptr;
+
+        if (use_bounce_buffer && !bounce_data) {
+            return 0;
+        }
+
+        rodsLong_t done = 0;
+
+        while (done < _length) {
+            const auto request = std::min(_length - done, max_direct_request_size);
+            char* data = use_bounce_buffer ? bounce_data : _buffer + done;
+
+            if (direction::write == _dir && use_bounce_buffer) {
+                std::memcpy(data, _buffer + done, request);
+            }
+
+            const auto n = (direction::read == _dir)
+                ? ::pread(_direct_fd, data, request, _offset + done)
+                : ::pwrite(_direct_fd, data, request, _offset + done);
+
+            if (n < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                if (EINVAL == errno) {
+                    rodsLog(LOG_DEBUG, "direct_io: O_DIRECT request rejected [alignment=%lld]. Using the page cache.", _alignment);
+                    break;
+                }
+
+                return -errno;
+            }
+
+            if (direction::read == _dir && use_bounce_buffer) {
+                std::memcpy(_buffer + done, data, n);
+            }
+
+            done += n;
+
+            if (n < request) {
+                break;
+            }
+        }
+
+        return done;
+    }
+
+    auto transfer(direction _dir,
+                  const irods::direct_io::config& _config,
+                  const io::config& _io_config,
+                  int _fd,
+                  int _direct_fd,
+                  char* _buffer,
+                  rodsLong_t _length) -> rodsLong_t
+    {
+        if (!_config.enabled || _direct_fd < 0 || _length < _config.minimum_size) {
+            return (direction::read == _dir)
+                ? io::read(_io_config, _fd, _buffer, _length)
+                : io::write(_io_config, _fd, _buffer, _length);
+        }
+
+        const auto position = lseek(_fd, 0, SEEK_CUR);
+        if (position < 0) {
+            return -errno;
+        }
+
+        const auto alignment = _config.alignment;
+        rodsLong_t done = 0;
+
+        // Unaligned head.
+        const auto head = std::min(_length, (alignment - position % alignment) % alignment);
+        if (head > 0) {
+            const auto n = buffered(_dir, _io_config, _fd, _buffer, head, position);
+            if (n < 0) {
+                return n;
+            }
+
+            done += n;
+        }
+
+        // Aligned middle. Skipped if the head came up short (end-of-file).
+        if (done == head) {
+            if (const auto middle = (_length - done) / alignment * alignment; middle > 0) {
+                const auto n = direct(_dir, alignment, _direct_fd, _buffer + done, middle, position + done);
+                if (n < 0) {
+                    return n;
+                }
+
+                done += n;
+            }
+
+            // Tail, plus whatever the direct section did not complete.
+            if (done < _length) {
+                const auto n = buffered(_dir, _io_config, _fd, _buffer + done, _length - done, position + done);
+                if (n < 0) {
+                    return n;
+                }
+
+                done += n;
+            }
+        }
+
+        if (lseek(_fd, position + done, SEEK_SET) < 0) {
+            return -errno;
+        }
+
+        return done;
+    }
+} // anonymous namespace
+
+namespace irods::direct_io
+{
+    auto open_companion(const char* _path, int _flags) -> int
+    {
+        const int fd = ::open(_path, (_flags & O_ACCMODE) | O_DIRECT | O_CLOEXEC);
+        return fd < 0 ? -errno : fd;
+    }
+
+    auto read(const config& _config,
+              const io_engine::config& _io_config,
+              int _fd,
+              int _direct_fd,
+              void* _buffer,
+              rodsLong_t _length) -> rodsLong_t
+    {
+        return transfer(direction::read, _config, _io_config, _fd, _direct_fd, static_cast<char*>(_buffer), _length);
+    }
+
+    auto write(const config& _config,
+               const io_engine::config& _io_config,
+               int _fd,
+               int _direct_fd,
+               const void* _buffer,
+               rodsLong_t _length) -> rodsLong_t
+    {
+        auto* buffer = const_cast<char*>(static_cast<const char*>(_buffer));
+        return transfer(direction::write, _config, _io_config, _fd, _direct_fd, buffer, _length);
+    }
+} // namespace irods::direct_io
@@ -32,6 +32,7 @@
 #include "irods_threads.hpp"
 #include "irods_server_properties.hpp"
 #include "irods_random.hpp"
+#include "irods_tracing.hpp"
 
 #include <vector>
 #include <set>
@@ -959,6 +960,18 @@ initRsCommWithStartupPack( rsComm_t *rsComm, startupPack_t *startupPack ) {
             rstrcpy( rsComm->option, tmpStr, LONG_NAME_LEN );
         }
     }
+
+    // The trace context of the client is not part of the option the client is known by.
+    // The spans of this agent become part of the client's trace.
+    {
+        std::string option = rsComm->option;
+
+        if ( const auto ctx = irods::experimental::tracing::extract_from_startup_pack_option( option ); ctx ) {
+            irods::experimental::tracing::set_remote_parent( *ctx );
+            rstrcpy( rsComm->option, option.c_str(), LONG_NAME_LEN );
+        }
+    }
+
     if ( rsComm->sock != 0 ) {
         /* remove error messages from xmsLog */
         setLocalAddr( rsComm->sock, &rsComm->localAddr );
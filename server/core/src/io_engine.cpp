@@ -0,0 +1,601 @@
+#include "io_engine.hpp"
+
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "thread_pool.hpp"
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  define IRODS_IO_ENGINE_HAVE_IO_URING
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    namespace io = irods::io_engine;
+
+    enum class direction
+    {
+        read,
+        write
+    };
+
+    // A piece of a larger request.
+    struct piece
+    {
+        char* buffer;
+        rodsLong_t length;
+        rodsLong_t offset;
+        rodsLong_t result;
+    };
+
+    //
+    // Registered buffers (per thread)
+    //
+
+    struct buffer_registry
+    {
+        std::vector<iovec> buffers;
+
+        // Incremented every time the set of buffers changes so that the io_uring
+        // instance knows when to re-register.
+        std::uint64_t generation = 0;
+    };
+
+    thread_local buffer_registry registry;
+
+    //
+    // Synchronous helpers
+    //
+
+    // Transfers the whole piece unless end-of-file is reached or an error occurs.
+    auto transfer_fully(direction _dir, int _fd, char* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t
+    {
+        rodsLong_t done = 0;
+
+        while (done < _length) {
+            const auto n = (direction::read == _dir)
+                ? ::pread(_fd, _buffer + done, _length - done, _offset + done)
+                : ::pwrite(_fd, _buffer + done, _length - done, _offset + done);
+
+            if (n < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                return -errno;
+            }
+
+            if (0 == n) {
+                break;
+            }
+
+            done += n;
+        }
+
+        return done;
+    }
+
+    auto split(char* _buffer, rodsLong_t _length, rodsLong_t _offset, rodsLong_t _request_size) -> std::vector<piece>
+    {
+        std::vector<piece> pieces;
+        pieces.reserve((_length + _request_size - 1) / _request_size);
+
+        for (rodsLong_t done = 0; done < _length; done += _request_size) {
+            pieces.push_back({_buffer + done, std::min(_request_size, _length - done), _offset + done, 0});
+        }
+
+        return pieces;
+    }
+
+    // Completes short pieces synchronously and returns the number of contiguous bytes
+    // transferred from the start of the request, or the first error.
+    auto finish(direction _dir, int _fd, std::vector<piece>& _pieces) -> rodsLong_t
+    {
+        rodsLong_t total = 0;
+
+        for (auto& p : _pieces) {
+            if (p.result < 0) {
+                return p.result;
+            }
+
+            if (p.result < p.length) {
+                const auto rest = transfer_fully(_dir, _fd, p.buffer + p.result, p.length - p.result, p.offset + p.result);
+
+                if (rest < 0) {
+                    return rest;
+                }
+
+                p.result += rest;
+            }
+
+            total += p.result;
+
+            // A short read means end-of-file. Anything after this point is not part
+            // of the contiguous result.
+            if (p.result < p.length) {
+                break;
+            }
+        }
+
+        return total;
+    }
+
+    //
+    // Thread pool engine
+    //
+
+    // Returns the pool which services the engines configured with a queue depth
+    // of _size. Each pool has exactly that many threads.
+    auto thread_pool_for(int _size) -> irods::thread_pool&
+    {
+        // Created lazily so that they always belong to the agent process and never
+        // to a parent that forks afterwards.
+        static std::mutex mutex;
+        static std::map<int, std::unique_ptr<irods::thread_pool>> pools;
+
+        std::lock_guard<std::mutex> lock{mutex};
+
+        auto& pool = pools[_size];
+        if (!pool) {
+            pool = std::make_unique<irods::thread_pool>(_size);
+        }
+
+        return *pool;
+    }
+
+    auto submit_to_thread_pool(direction _dir, const io::config& _config, int _fd, std::vector<piece>& _pieces) -> void
+    {
+        const auto depth = std::max(_config.queue_depth, 1);
+        const auto workers = std::min<std::size_t>(depth, _pieces.size());
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t next = 0;
+        std::size_t remaining = workers;
+
+        auto& pool = thread_pool_for(depth);
+
+        // Each worker takes the next piece once it is done with its current one,
+        // so no more than queue_depth pieces of this request are in flight.
+        for (std::size_t i = 0; i < workers; ++i) {
+            irods::thread_pool::post(pool, [&, _dir, _fd] {
+                std::unique_lock<std::mutex> lock{mutex};
+
+                while (next < _pieces.size()) {
+                    auto& p = _pieces[next++];
+
+                    lock.unlock();
+                    p.result = transfer_fully(_dir, _fd, p.buffer, p.length, p.offset);
+                    lock.lock();
+                }
+
+                --remaining;
+                lock.unlock();
+
+                cv.notify_one();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [&remaining] { return 0 == remaining; });
+    }
+
+#ifdef IRODS_IO_ENGINE_HAVE_IO_URING
+    //
+    // io_uring engine
+    //
+    // A minimal ring built directly on top of the system calls so that no
+    // additional library is required at build or run time.
+    //
+
+    class uring
+    {
+    public:
+        explicit uring(unsigned _entries)
+        {
+            io_uring_params params{};
+
+            fd_ = static_cast<int>(syscall(__NR_io_uring_setup, _entries, &params));
+            if (fd_ < 0) {
+                return;
+            }
+
+            sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+            const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_mmap) {
+                sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+            }
+
+            sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+            if (MAP_FAILED == sq_ring_) {
+                sq_ring_ = nullptr;
+                release();
+                return;
+            }
+
+            if (single_mmap) {
+                cq_ring_ = sq_ring_;
+            }
+            else {
+                cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+                if (MAP_FAILED == cq_ring_) {
+                    cq_ring_ = nullptr;
+                    release();
+                    return;
+                }
+            }
+
+            sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+            if (MAP_FAILED == sqes_) {
+                sqes_ = nullptr;
+                release();
+                return;
+            }
+
+            auto* sq = static_cast<char*>(sq_ring_);
+            sq_tail_  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sq_mask_  = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+            auto* cq = static_cast<char*>(cq_ring_);
+            cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes_    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            entries_ = params.sq_entries;
+        }
+
+        uring(const uring&) = delete;
+        auto operator=(const uring&) -> uring& = delete;
+
+        ~uring()
+        {
+            release();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return fd_ >= 0;
+        }
+
+        // Runs all pieces through the ring while keeping at most _queue_depth of them in flight.
+        auto run(direction _dir, int _fd, std::vector<piece>& _pieces, int _queue_depth) -> int
+        {
+            sync_registered_buffers();
+
+            const auto depth = std::min<std::size_t>(std::max(_queue_depth, 1), entries_);
+            std::vector<iovec> iovecs(_pieces.size());
+
+            std::size_t next = 0;
+            std::size_t completed = 0;
+            unsigned in_flight = 0;
+            unsigned unsubmitted = 0;
+
+            while (completed < _pieces.size()) {
+                while (next < _pieces.size() && in_flight < depth) {
+                    prepare(_dir, _fd, _pieces[next], iovecs[next], next);
+                    ++next;
+                    ++in_flight;
+                    ++unsubmitted;
+                }
+
+                const auto submitted = enter(unsubmitted, 1);
+                if (submitted >= 0) {
+                    unsubmitted -= submitted;
+                }
+                // Anything but a transient condition means the ring itself is unusable.
+                else if (-EINTR != submitted && -EAGAIN != submitted && -EBUSY != submitted) {
+                    release();
+                    return submitted;
+                }
+
+                // Reaping completions frees up room in the completion queue, which
+                // is what the kernel needs to accept the remaining submissions after
+                // -EBUSY.
+                unsigned reaped = 0;
+
+                for (unsigned head = *cq_head_; head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE); ++head) {
+                    const auto& cqe = cqes_[head & cq_mask_];
+                    _pieces[cqe.user_data].result = cqe.res;
+                    ++completed;
+                    --in_flight;
+                    ++reaped;
+                    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+                }
+
+                if (submitted < 0 && 0 == reaped) {
+                    std::this_thread::yield();
+                }
+            }
+
+            return 0;
+        }
+
+        auto sync_registered_buffers() -> void
+        {
+            if (registry.generation == registered_generation_) {
+                return;
+            }
+
+            if (buffers_registered_) {
+                syscall(__NR_io_uring_register, fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+                buffers_registered_ = false;
+            }
+
+            if (!registry.buffers.empty()) {
+                // Registration can fail (e.g. RLIMIT_MEMLOCK). The buffers are then
+                // simply used as regular buffers.
+                buffers_registered_ = syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+                                              registry.buffers.data(), registry.buffers.size()) == 0;
+            }
+
+            registered_generation_ = registry.generation;
+        }
+
+    private:
+        auto prepare(direction _dir, int _fd, piece& _piece, iovec& _iov, std::uint64_t _id) -> void
+        {
+            const unsigned tail = *sq_tail_;
+            const unsigned index = tail & sq_mask_;
+
+            auto& sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+
+            sqe.fd = _fd;
+            sqe.off = _piece.offset;
+            sqe.user_data = _id;
+
+            if (const auto buf_index = find_registered_buffer(_piece); buf_index >= 0) {
+                sqe.opcode = (direction::read == _dir) ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+                sqe.addr = reinterpret_cast<std::uint64_t>(_piece.buffer);
+                sqe.len = static_cast<std::uint32_t>(_piece.length);
+                sqe.buf_index = static_cast<std::uint16_t>(buf_index);
+            }
+            else {
+                _iov.iov_base = _piece.buffer;
+                _iov.iov_len = _piece.length;
+
+                sqe.opcode = (direction::read == _dir) ? IORING_OP_READV : IORING_OP_WRITEV;
+                sqe.addr = reinterpret_cast<std::uint64_t>(&_iov);
+                sqe.len = 1;
+            }
+
+            sq_array_[index] = index;
+            __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        auto enter(unsigned _to_submit, unsigned _min_complete) -> int
+        {
+            const auto ec = syscall(__NR_io_uring_enter, fd_, _to_submit, _min_complete, IORING_ENTER_GETEVENTS, nullptr, 0);
+            return ec < 0 ? -errno : static_cast<int>(ec);
+        }
+
+        auto find_registered_buffer(const piece& _piece) const -> int
+        {
+            if (!buffers_registered_) {
+                return -1;
+            }
+
+            for (std::size_t i = 0; i < registry.buffers.size(); ++i) {
+                const auto* begin = static_cast<const char*>(registry.buffers[i].iov_base);
+                const auto* end = begin + registry.buffers[i].iov_len;
+
+                if (_piece.buffer >= begin && _piece.buffer + _piece.length <= end) {
+                    return static_cast<int>(i);
+                }
+            }
+
+            return -1;
+        }
+
+        auto release() -> void
+        {
+            if (sqes_) {
+                munmap(sqes_, sqes_size_);
+            }
+
+            if (cq_ring_ && cq_ring_ != sq_ring_) {
+                munmap(cq_ring_, cq_ring_size_);
+            }
+
+            if (sq_ring_) {
+                munmap(sq_ring_, sq_ring_size_);
+            }
+
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+
+            fd_ = -1;
+            sq_ring_ = cq_ring_ = nullptr;
+            sqes_ = nullptr;
+        }
+
+        int fd_ = -1;
+        unsigned entries_ = 0;
+
+        void* sq_ring_ = nullptr;
+        void* cq_ring_ = nullptr;
+        io_uring_sqe* sqes_ = nullptr;
+        std::size_t sq_ring_size_ = 0;
+        std::size_t cq_ring_size_ = 0;
+        std::size_t sqes_size_ = 0;
+
+        unsigned* sq_tail_ = nullptr;
+        unsigned* sq_array_ = nullptr;
+        unsigned sq_mask_ = 0;
+
+        unsigned* cq_head_ = nullptr;
+        unsigned* cq_tail_ = nullptr;
+        io_uring_cqe* cqes_ = nullptr;
+        unsigned cq_mask_ = 0;
+
+        bool buffers_registered_ = false;
+        std::uint64_t registered_generation_ = 0;
+    }; // class uring
+
+    // The number of submission queue entries requested for each thread's ring.
+    constexpr unsigned ring_entries = 64;
+
+    thread_local std::unique_ptr<uring> ring;
+    thread_local bool ring_initialized = false;
+
+    // Returns the ring of the calling thread, creating it on first use.
+    // Returns nullptr if io_uring cannot be used.
+    auto thread_ring() -> uring*
+    {
+        if (!ring_initialized) {
+            ring_initialized = true;
+            ring = std::make_unique<uring>(ring_entries);
+
+            if (!*ring) {
+                rodsLog(LOG_DEBUG, "io_engine: io_uring is not available [errno=%d]. Using the thread pool engine.", errno);
+                ring.reset();
+            }
+        }
+
+        return (ring && *ring) ? ring.get() : nullptr;
+    }
+#endif // IRODS_IO_ENGINE_HAVE_IO_URING
+
+    auto transfer(direction _dir, const io::config& _config, int _fd, char* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t
+    {
+        if (io::engine_type::posix == _config.type || _length <= _config.request_size || _config.request_size <= 0) {
+            return transfer_fully(_dir, _fd, _buffer, _length, _offset);
+        }
+
+        auto pieces = split(_buffer, _length, _offset, _config.request_size);
+
+#ifdef IRODS_IO_ENGINE_HAVE_IO_URING
+        if (io::engine_type::io_uring == _config.type) {
+            if (auto* ring = thread_ring(); ring) {
+                if (const auto ec = ring->run(_dir, _fd, pieces, _config.queue_depth); ec < 0) {
+                    return ec;
+                }
+
+                return finish(_dir, _fd, pieces);
+            }
+        }
+#endif
+
+        submit_to_thread_pool(_dir, _config, _fd, pieces);
+
+        return finish(_dir, _fd, pieces);
+    }
+
+    auto transfer_at_file_position(direction _dir, const io::config& _config, int _fd, char* _buffer, rodsLong_t _length) -> rodsLong_t
+    {
+        if (io::engine_type::posix == _config.type || _length <= _config.request_size) {
+            const auto n = (direction::read == _dir) ? ::read(_fd, _buffer, _length) : ::write(_fd, _buffer, _length);
+            return n < 0 ? -errno : n;
+        }
+
+        const auto offset = lseek(_fd, 0, SEEK_CUR);
+        if (offset < 0) {
+            return -errno;
+        }
+
+        const auto n = transfer(_dir, _config, _fd, _buffer, _length, offset);
+
+        if (n > 0 && lseek(_fd, offset + n, SEEK_SET) < 0) {
+            return -errno;
+        }
+
+        return n;
+    }
+} // anonymous namespace
+
+namespace irods::io_engine
+{
+    auto to_engine_type(const std::string& _name) -> engine_type
+    {
+        if ("posix" == _name) {
+            return engine_type::posix;
+        }
+
+        if ("io_uring" == _name) {
+            return engine_type::io_uring;
+        }
+
+        if ("thread_pool" == _name) {
+            return engine_type::thread_pool;
+        }
+
+        THROW(SYS_INVALID_INPUT_PARAM, "Invalid I/O engine [" + _name + "]");
+    }
+
+    auto io_uring_available() -> bool
+    {
+#ifdef IRODS_IO_ENGINE_HAVE_IO_URING
+        return thread_ring() != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    auto read(const config& _config, int _fd, void* _buffer, rodsLong_t _length) -> rodsLong_t
+    {
+        return transfer_at_file_position(direction::read, _config, _fd, static_cast<char*>(_buffer), _length);
+    }
+
+    auto write(const config& _config, int _fd, const void* _buffer, rodsLong_t _length) -> rodsLong_t
+    {
+        auto* buffer = const_cast<char*>(static_cast<const char*>(_buffer));
+        return transfer_at_file_position(direction::write, _config, _fd, buffer, _length);
+    }
+
+    auto pread(const config& _config, int _fd, void* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t
+    {
+        return transfer(direction::read, _config, _fd, static_cast<char*>(_buffer), _length, _offset);
+    }
+
+    auto pwrite(const config& _config, int _fd, const void* _buffer, rodsLong_t _length, rodsLong_t _offset) -> rodsLong_t
+    {
+        auto* buffer = const_cast<char*>(static_cast<const char*>(_buffer));
+        return transfer(direction::write, _config, _fd, buffer, _length, _offset);
+    }
+
+    registered_buffer::registered_buffer(void* _buffer, std::size_t _size)
+        : buffer_{_buffer}
+    {
+        registry.buffers.push_back({_buffer, _size});
+        ++registry.generation;
+    }
+
+    registered_buffer::~registered_buffer()
+    {
+        auto& buffers = registry.buffers;
+        buffers.erase(std::remove_if(std::begin(buffers), std::end(buffers),
+                                     [this](const iovec& _iov) { return _iov.iov_base == buffer_; }),
+                      std::end(buffers));
+        ++registry.generation;
+
+#ifdef IRODS_IO_ENGINE_HAVE_IO_URING
+        // The kernel keeps the pages of the buffer pinned until the ring drops its
+        // registration. Do that now rather than on the next request.
+        if (ring && *ring) {
+            ring->sync_registered_buffers();
+        }
+#endif
+    }
+} // namespace irods::io_engine
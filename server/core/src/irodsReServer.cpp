@@ -62,9 +62,9 @@ namespace {
         const bool write_to_stdout,
         const bool enable_test_mode)
     {
-        logger::init(write_to_stdout, enable_test_mode);
-
         irods::server_properties::instance().capture();
+
+        logger::init(write_to_stdout, enable_test_mode, logger::get_sink_config_from_config());
         logger::server::set_level(logger::get_level_from_config(irods::CFG_LOG_LEVEL_CATEGORY_SERVER_KW));
         logger::legacy::set_level(logger::get_level_from_config(irods::CFG_LOG_LEVEL_CATEGORY_LEGACY_KW));
         logger::delay_server::set_level(logger::get_level_from_config(irods::CFG_LOG_LEVEL_CATEGORY_DELAY_SERVER_KW));
@@ -0,0 +1,446 @@
+#include "irods_async_log_sink.hpp"
+
+#include <json.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <system_error>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+namespace irods::experimental
+{
+    namespace
+    {
+        // The sinks whose background threads must be restarted around fork().
+        std::mutex sinks_mutex;
+        std::vector<async_log_sink*> sinks;
+
+        auto to_syslog_priority(spdlog::level::level_enum _level) noexcept -> int
+        {
+            // Matches spdlog::sinks::syslog_sink.
+            switch (_level) {
+                case spdlog::level::trace:    return LOG_DEBUG;
+                case spdlog::level::debug:    return LOG_DEBUG;
+                case spdlog::level::warn:     return LOG_WARNING;
+                case spdlog::level::err:      return LOG_ERR;
+                case spdlog::level::critical: return LOG_CRIT;
+                default:                      return LOG_INFO;
+            }
+        }
+    } // anonymous namespace
+
+    //
+    // syslog_log_target
+    //
+
+    syslog_log_target::syslog_log_target()
+        : socket_{-1}
+        , datagrams_{}
+    {
+        // Used by the fallback path. Same options as the synchronous sink.
+        openlog(nullptr, LOG_PID, LOG_LOCAL0);
+        connect();
+    }
+
+    syslog_log_target::~syslog_log_target()
+    {
+        disconnect();
+        closelog();
+    }
+
+    auto syslog_log_target::write(const log_entry* _entries, std::size_t _count) -> void
+    {
+        if (send(_entries, _count)) {
+            return;
+        }
+
+        for (std::size_t i = 0; i < _count; ++i) {
+            const auto& msg = _entries[i].message;
+            syslog(to_syslog_priority(_entries[i].level), "%.*s", static_cast<int>(msg.size()), msg.data());
+        }
+    }
+
+    auto syslog_log_target::connect() -> bool
+    {
+        socket_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        if (socket_ < 0) {
+            return false;
+        }
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, _PATH_LOG, sizeof(addr.sun_path) - 1);
+
+        if (::connect(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            disconnect();
+            return false;
+        }
+
+        return true;
+    }
+
+    auto syslog_log_target::disconnect() -> void
+    {
+        if (socket_ >= 0) {
+            close(socket_);
+            socket_ = -1;
+        }
+    }
+
+    auto syslog_log_target::send(const log_entry* _entries, std::size_t _count) -> bool
+    {
+        if (socket_ < 0 && !connect()) {
+            return false;
+        }
+
+        // Build the messages exactly like syslog(3): "<PRI>Mmm dd hh:mm:ss ident[pid]: message".
+        const auto header_suffix = std::string{program_invocation_short_name} + '[' + std::to_string(getpid()) + "]: ";
+
+        datagrams_.resize(_count);
+
+        std::vector<iovec> iovecs(_count);
+        std::vector<mmsghdr> headers(_count);
+
+        for (std::size_t i = 0; i < _count; ++i) {
+            const auto t = std::chrono::system_clock::to_time_t(_entries[i].time);
+            std::tm tm{};
+            localtime_r(&t, &tm);
+
+            char timestamp[32]{};
+            std::strftime(timestamp, sizeof(timestamp), "%h %e %T ", &tm);
+
+            auto& d = datagrams_[i];
+            d = '<' + std::to_string(LOG_LOCAL0 | to_syslog_priority(_entries[i].level)) + '>';
+            d += timestamp;
+            d += header_suffix;
+            d += _entries[i].message;
+
+            iovecs[i] = {d.data(), d.size()};
+            headers[i] = {};
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        std::size_t sent = 0;
+        bool reconnected = false;
+
+        while (sent < _count) {
+            const auto n = sendmmsg(socket_, headers.data() + sent, _count - sent, 0);
+
+            if (n > 0) {
+                sent += n;
+            }
+            else if (n < 0 && EINTR == errno) {
+                continue;
+            }
+            else if (!reconnected) {
+                // The daemon may have been restarted.
+                reconnected = true;
+                disconnect();
+
+                if (!connect()) {
+                    break;
+                }
+            }
+            else {
+                break;
+            }
+        }
+
+        if (sent < _count) {
+            // Hand whatever is left to the fallback path.
+            for (std::size_t i = sent; i < _count; ++i) {
+                const auto& msg = _entries[i].message;
+                syslog(to_syslog_priority(_entries[i].level), "%.*s", static_cast<int>(msg.size()), msg.data());
+            }
+        }
+
+        return true;
+    }
+
+    //
+    // file_log_target
+    //
+
+    file_log_target::file_log_target(const std::string& _path)
+        : fd_{open(_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640)}
+        , buffer_{}
+    {
+        if (fd_ < 0) {
+            throw std::system_error{errno, std::generic_category(), "file_log_target: cannot open [" + _path + ']'};
+        }
+    }
+
+    file_log_target::~file_log_target()
+    {
+        close(fd_);
+    }
+
+    auto file_log_target::write(const log_entry* _entries, std::size_t _count) -> void
+    {
+        buffer_.clear();
+
+        for (std::size_t i = 0; i < _count; ++i) {
+            buffer_ += _entries[i].message;
+            buffer_ += '\n';
+        }
+
+        const char* p = buffer_.data();
+        auto remaining = buffer_.size();
+
+        while (remaining > 0) {
+            const auto n = ::write(fd_, p, remaining);
+
+            if (n < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                // There is nowhere to report the error.
+                return;
+            }
+
+            p += n;
+            remaining -= n;
+        }
+    }
+
+    //
+    // async_log_sink
+    //
+
+    async_log_sink::async_log_sink(std::unique_ptr<log_target> _target, std::size_t _capacity, overflow_policy _policy)
+        : target_{std::move(_target)}
+        , policy_{_policy}
+        , buffer_{_capacity}
+        , mutex_{}
+        , work_available_{}
+        , written_{}
+        , worker_sleeping_{false}
+        , flush_waiters_{0}
+        , stop_requested_{false}
+        , worker_{}
+        , pushed_{0}
+        , processed_{0}
+        , dropped_{0}
+        , dropped_reported_{0}
+    {
+        register_fork_handlers();
+
+        std::lock_guard lock{sinks_mutex};
+        start();
+        sinks.push_back(this);
+    }
+
+    async_log_sink::~async_log_sink()
+    {
+        {
+            std::lock_guard lock{sinks_mutex};
+            sinks.erase(std::remove(std::begin(sinks), std::end(sinks), this), std::end(sinks));
+        }
+
+        stop();
+    }
+
+    auto async_log_sink::log(const spdlog::details::log_msg& _msg) -> void
+    {
+        log_entry entry{_msg.level, _msg.time, std::string(_msg.payload.data(), _msg.payload.size())};
+
+        if (!buffer_.try_push(entry)) {
+            if (overflow_policy::drop == policy_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // Spin briefly before backing off, as the worker usually frees a slot quickly.
+            for (int attempt = 0; !buffer_.try_push(entry); ++attempt) {
+                wake_worker();
+
+                if (attempt < 64) {
+                    std::this_thread::yield();
+                }
+                else {
+                    std::this_thread::sleep_for(std::chrono::microseconds{50});
+                }
+            }
+        }
+
+        pushed_.fetch_add(1);
+        wake_worker();
+    }
+
+    auto async_log_sink::flush() -> void
+    {
+        const auto target = pushed_.load();
+
+        std::unique_lock lock{mutex_};
+
+        ++flush_waiters_;
+        written_.wait(lock, [this, target] { return processed_.load() >= target; });
+        --flush_waiters_;
+    }
+
+    auto async_log_sink::dropped() const noexcept -> std::uint64_t
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    auto async_log_sink::start() -> void
+    {
+        stop_requested_ = false;
+        worker_ = std::thread{[this] { run(); }};
+    }
+
+    auto async_log_sink::stop() -> void
+    {
+        if (!worker_.joinable()) {
+            return;
+        }
+
+        {
+            std::lock_guard lock{mutex_};
+            stop_requested_ = true;
+        }
+
+        work_available_.notify_one();
+        worker_.join();
+    }
+
+    auto async_log_sink::run() -> void
+    {
+        std::vector<log_entry> batch(max_batch_size);
+
+        while (true) {
+            std::size_t count = 0;
+
+            while (count < max_batch_size && buffer_.try_pop(batch[count])) {
+                ++count;
+            }
+
+            if (count > 0) {
+                target_->write(batch.data(), count);
+                processed_.fetch_add(count);
+
+                report_dropped_messages();
+
+                if (flush_waiters_.load() > 0) {
+                    target_->flush();
+                    { std::lock_guard lock{mutex_}; }
+                    written_.notify_all();
+                }
+
+                continue;
+            }
+
+            std::unique_lock lock{mutex_};
+
+            // The buffer has been drained, so every message logged before the stop
+            // request has been written.
+            if (stop_requested_) {
+                break;
+            }
+
+            // Announce that the worker is about to sleep before checking for work one
+            // last time. A producer either sees the flag (and wakes the worker through
+            // the mutex) or its message is seen by the predicate.
+            worker_sleeping_.store(true);
+            work_available_.wait_for(lock, std::chrono::seconds{1}, [this] {
+                return stop_requested_ || pushed_.load() != processed_.load();
+            });
+            worker_sleeping_.store(false);
+        }
+    }
+
+    auto async_log_sink::wake_worker() -> void
+    {
+        if (worker_sleeping_.load()) {
+            { std::lock_guard lock{mutex_}; }
+            work_available_.notify_one();
+        }
+    }
+
+    auto async_log_sink::report_dropped_messages() -> void
+    {
+        const auto dropped = dropped_.load(std::memory_order_relaxed);
+
+        if (dropped == dropped_reported_) {
+            return;
+        }
+
+        const nlohmann::json msg{
+            {"log_category", "server"},
+            {"log_level", "warn"},
+            {"log_facility", "local0"},
+            {"log_message", "Log messages were dropped because the log buffer was full."},
+            {"dropped_messages", std::to_string(dropped - dropped_reported_)},
+            {"server_pid", getpid()}
+        };
+
+        const log_entry entry{spdlog::level::warn, std::chrono::system_clock::now(), msg.dump()};
+        target_->write(&entry, 1);
+
+        dropped_reported_ = dropped;
+    }
+
+    auto async_log_sink::discard_pending_messages() -> void
+    {
+        log_entry entry;
+
+        while (buffer_.try_pop(entry)) {
+            processed_.fetch_add(1);
+        }
+    }
+
+    auto async_log_sink::register_fork_handlers() -> void
+    {
+        static const int ec = pthread_atfork(prepare_fork, after_fork_in_parent, after_fork_in_child);
+        static_cast<void>(ec);
+    }
+
+    auto async_log_sink::prepare_fork() -> void
+    {
+        // The lock is held until the fork completes so that no sink can be created or
+        // destroyed in the meantime. It is released by the thread that acquired it in
+        // both the parent and the child.
+        sinks_mutex.lock();
+
+        for (auto* sink : sinks) {
+            sink->stop();
+
+            // Keeps producers from holding the mutex when the process is copied.
+            sink->mutex_.lock();
+        }
+    }
+
+    auto async_log_sink::after_fork_in_parent() -> void
+    {
+        for (auto* sink : sinks) {
+            sink->mutex_.unlock();
+            sink->start();
+        }
+
+        sinks_mutex.unlock();
+    }
+
+    auto async_log_sink::after_fork_in_child() -> void
+    {
+        for (auto* sink : sinks) {
+            // Messages logged by other threads of the parent while the fork was in
+            // progress are written by the parent.
+            sink->discard_pending_messages();
+            sink->mutex_.unlock();
+            sink->start();
+        }
+
+        sinks_mutex.unlock();
+    }
+} // namespace irods::experimental
@@ -21,7 +21,7 @@ namespace irods
             return FD_INUSE == L1desc[_index].inuseFlag;
         };
 
-        for (l1_index_type index = 3; index < NUM_L1_DESC && index_is_open(index); ++index) {
+        for (l1_index_type index = 3; index < L1desc.size() && index_is_open(index); ++index) {
             auto& fd = L1desc[index];
             const auto repl = irods::experimental::replica::make_replica_proxy(*fd.dataObjInfo);
 
@@ -1,5 +1,7 @@
 #include "irods_logger.hpp"
 
+#include "irods_configuration_keywords.hpp"
+#include "irods_exception.hpp"
 #include "irods_server_properties.hpp"
 
 #include <fstream>
@@ -13,7 +15,10 @@
 #include "boost/interprocess/sync/scoped_lock.hpp"
 
 #ifdef IRODS_ENABLE_SYSLOG
+    #include "irods_async_log_sink.hpp"
+
     #include "spdlog/sinks/base_sink.h"
+    #include "spdlog/sinks/basic_file_sink.h"
     #include "spdlog/sinks/syslog_sink.h"
 #endif // IRODS_ENABLE_SYSLOG
 
@@ -122,20 +127,66 @@ namespace irods::experimental
         ipc::named_mutex mutex_;
         const pid_t owner_pid_;
     }; // class stdout_ipc_sink
+
+    auto make_syslog_sink() -> spdlog::sink_ptr
+    {
+        std::string id = "";
+        const bool enable_formatting = false;
+        return std::make_shared<spdlog::sinks::syslog_sink_mt>(id, LOG_PID, LOG_LOCAL0, enable_formatting);
+    }
+
+    auto make_sink(const log::sink_config& _config) -> spdlog::sink_ptr
+    {
+        if (_config.asynchronous) {
+            std::unique_ptr<log_target> target;
+
+            if (_config.file.empty()) {
+                target = std::make_unique<syslog_log_target>();
+            }
+            else {
+                target = std::make_unique<file_log_target>(_config.file);
+            }
+
+            const auto policy = _config.block_when_full
+                ? async_log_sink::overflow_policy::block
+                : async_log_sink::overflow_policy::drop;
+
+            return std::make_shared<async_log_sink>(std::move(target), _config.buffer_size, policy);
+        }
+
+        if (!_config.file.empty()) {
+            auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(_config.file);
+            sink->set_pattern("%v");
+            return sink;
+        }
+
+        return make_syslog_sink();
+    }
 #endif // IRODS_ENABLE_SYSLOG
 
     void log::init(bool _write_to_stdout, bool _enable_test_mode) noexcept
+    {
+        init(_write_to_stdout, _enable_test_mode, sink_config{});
+    }
+
+    void log::init(bool _write_to_stdout, bool _enable_test_mode, const sink_config& _sink_config) noexcept
     {
 #ifdef IRODS_ENABLE_SYSLOG
         std::vector<spdlog::sink_ptr> sinks;
+        std::string sink_error;
 
         if (_write_to_stdout) {
             sinks.push_back(std::make_shared<stdout_ipc_sink>());
         }
         else {
-            std::string id = "";
-            const bool enable_formatting = false;
-            sinks.push_back(std::make_shared<spdlog::sinks::syslog_sink_mt>(id, LOG_PID, LOG_LOCAL0, enable_formatting));
+            try {
+                sinks.push_back(make_sink(_sink_config));
+            }
+            catch (const std::exception& e) {
+                // Fall back to syslog so that messages are not lost.
+                sink_error = e.what();
+                sinks.push_back(make_syslog_sink());
+            }
         }
 
         if (_enable_test_mode) {
@@ -144,6 +195,11 @@ namespace irods::experimental
 
         log_ = std::make_shared<spdlog::logger>("composite_logger", std::begin(sinks), std::end(sinks));
         log_->set_level(spdlog::level::trace); // Log everything!
+
+        if (!sink_error.empty()) {
+            log::server::error({{"log_message", "Cannot create log sink. Logging to syslog instead."},
+                                {"error", sink_error}});
+        }
 #endif // IRODS_ENABLE_SYSLOG
     }
 
@@ -169,18 +225,46 @@ namespace irods::experimental
 
     auto log::get_level_from_config(const std::string& _category) -> log::level
     {
+        const auto& log_level = irods::server_config().log_level;
+
+        if (const auto iter = log_level.find(_category); iter != std::end(log_level)) {
+            return to_level(iter->second);
+        }
+
+        log::server::warn({{"log_message", "Cannot get 'log_level' for log category. "
+                                           "Defaulting to 'info'."},
+                           {"requested_category",  _category}});
+
+        return log::level::info;
+    }
+
+    auto log::get_sink_config_from_config() -> sink_config
+    {
+        sink_config config;
+
         try {
-            using map_type = std::unordered_map<std::string, boost::any>;
-            const auto& log_level = irods::get_server_property<const map_type&>(irods::CFG_LOG_LEVEL_KW);
-            return to_level(boost::any_cast<const std::string&>(log_level.at(_category)));
+            config.asynchronous = irods::get_advanced_setting<const bool>(irods::CFG_ASYNCHRONOUS_LOGGING);
         }
-        catch (const std::exception&) {
-            log::server::warn({{"log_message", "Cannot get 'log_level' for log category. "
-                                               "Defaulting to 'info'."},
-                               {"requested_category",  _category}});
+        catch (const irods::exception&) {}
+
+        try {
+            if (const auto size = irods::get_advanced_setting<const int>(irods::CFG_LOG_BUFFER_SIZE); size > 0) {
+                config.buffer_size = size;
+            }
         }
+        catch (const irods::exception&) {}
 
-        return log::level::info;
+        try {
+            config.block_when_full = irods::get_advanced_setting<const std::string>(irods::CFG_LOG_OVERFLOW_POLICY) == "block";
+        }
+        catch (const irods::exception&) {}
+
+        try {
+            config.file = irods::get_advanced_setting<const std::string>(irods::CFG_LOG_FILE_PATH);
+        }
+        catch (const irods::exception&) {}
+
+        return config;
     }
 
     void log::set_error_object(rError_t* _error) noexcept
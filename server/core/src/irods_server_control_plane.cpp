@@ -21,6 +21,7 @@
 #include "irods_server_state.hpp"
 #include "irods_exception.hpp"
 #include "irods_stacktrace.hpp"
+#include "api_metrics.hpp"
 
 #include "boost/lexical_cast.hpp"
 
@@ -427,6 +428,23 @@ namespace irods {
         return SUCCESS();
     } // operation_status
 
+    static error operation_metrics(
+        const std::string&, // _wait_option,
+        const size_t, //       _wait_seconds,
+        std::string& _output )
+    {
+        rodsEnv my_env;
+        _reloadRodsEnv( my_env );
+
+        auto obj = irods::experimental::api_metrics::to_json(irods::experimental::api_metrics::collect());
+        obj["hostname"] = my_env.rodsHost;
+
+        _output += obj.dump(4);
+        _output += ",";
+
+        return SUCCESS();
+    } // operation_metrics
+
     static error operation_ping(
         const std::string&, // _wait_option,
         const size_t, //       _wait_seconds,
@@ -520,6 +538,7 @@ namespace irods {
         }
         else {
             op_map_[ SERVER_CONTROL_SHUTDOWN ] = server_operation_shutdown;
+            op_map_[ SERVER_CONTROL_METRICS ]  = operation_metrics;
 
         }
 
@@ -1,6 +1,7 @@
 #include "rods.h"
 #include "fileOpr.hpp"
 #include "dataObjOpr.hpp"
+#include "l1desc_table.hpp"
 #include "miscUtil.h"
 #include "openCollection.h"
 
@@ -26,7 +27,7 @@ int RescGrpInit = 0;    /* whether initRescGrp has been called */
 /* global fileDesc */
 
 fileDesc_t FileDesc[NUM_FILE_DESC];
-l1desc_t L1desc[NUM_L1_DESC];
+irods::l1desc_table L1desc{NUM_L1_DESC};
 specCollDesc_t SpecCollDesc[NUM_SPEC_COLL_DESC];
 std::vector<collHandle_t> CollHandle;
 
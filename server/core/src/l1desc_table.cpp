@@ -0,0 +1,72 @@
+#include "l1desc_table.hpp"
+
+#include "fileOpr.hpp"
+#include "rodsErrorTable.h"
+
+#include <algorithm>
+
+namespace irods
+{
+    l1desc_table::l1desc_table(int _initial_size)
+        : initial_blocks_{(_initial_size + block_size - 1) / block_size}
+        , blocks_{}
+        , free_list_{}
+    {
+        reset();
+    }
+
+    auto l1desc_table::allocate() -> int
+    {
+        while (true) {
+            if (free_list_.empty() && !grow()) {
+                return SYS_OUT_OF_FILE_DESC;
+            }
+
+            const auto index = free_list_.back();
+            free_list_.pop_back();
+
+            // An index can appear on the free list more than once if it was released
+            // more than once. Skip entries that were handed out in the meantime.
+            auto& desc = (*this)[index];
+            if (desc.inuseFlag <= FD_FREE) {
+                desc.inuseFlag = FD_INUSE;
+                return index;
+            }
+        }
+    }
+
+    auto l1desc_table::release(int _index) -> void
+    {
+        if (is_valid_index(_index)) {
+            free_list_.push_back(_index);
+        }
+    }
+
+    auto l1desc_table::reset() -> void
+    {
+        blocks_.clear();
+        free_list_.clear();
+
+        for (int i = 0; i < initial_blocks_; ++i) {
+            grow();
+        }
+    }
+
+    auto l1desc_table::grow() -> bool
+    {
+        const auto old_size = size();
+
+        if (old_size + block_size > max_size) {
+            return false;
+        }
+
+        blocks_.push_back(std::make_unique<l1desc_t[]>(block_size));
+
+        // Push in descending order so that the lowest indices are handed out first.
+        for (int index = old_size + block_size - 1; index >= std::max(old_size, first_index); --index) {
+            free_list_.push_back(index);
+        }
+
+        return true;
+    }
+} // namespace irods
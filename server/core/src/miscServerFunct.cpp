@@ -65,10 +65,16 @@ char *__loc1;
 #include "irods_random.hpp"
 #include "irods_resource_manager.hpp"
 #include "irods_default_paths.hpp"
+#include "irods_resource_backport.hpp"
+#include "irods_resource_constants.hpp"
+#include "irods_tracing.hpp"
+#include "zero_copy.hpp"
+#include "io_engine.hpp"
 using leaf_bundle_t = irods::resource_manager::leaf_bundle_t;
 
 #include <iomanip>
 #include <fstream>
+#include <optional>
 
 #include <boost/filesystem.hpp>
 
@@ -91,6 +97,60 @@ int _l3Close( rsComm_t *rsComm, int l3descInx ) {
     return rsFileClose( rsComm, &fileCloseInp );
 } // _l3Close
 
+// Returns the kernel file descriptor behind an L3 descriptor when data can be
+// moved between it and a socket or another file without passing through the
+// resource plugin, otherwise -1.
+//
+// This is only true for local unixfilesystem leaf resources whose parents all
+// pass bytes through unchanged. Because the resource plugin is bypassed,
+// resource read/write PEPs do not fire, which is why the feature must be
+// enabled explicitly in the advanced settings.
+int getZeroCopyFd( int l3descInx ) {
+    try {
+        if ( !irods::get_advanced_setting<const bool>( irods::CFG_ZERO_COPY_FOR_PARA_TRANS ) ) {
+            return -1;
+        }
+    }
+    catch ( const irods::exception& ) {
+        return -1;
+    }
+
+    if ( l3descInx < 3 || l3descInx >= NUM_FILE_DESC ) {
+        return -1;
+    }
+
+    const fileDesc_t& desc = FileDesc[l3descInx];
+
+    if ( desc.inuseFlag != FD_INUSE || desc.fd < 0 || !desc.rescHier ||
+         !desc.rodsServerHost || desc.rodsServerHost->localFlag != LOCAL_HOST ) {
+        return -1;
+    }
+
+    // A coordinating resource such as blockcompress stores the bytes of the
+    // replica in the file of its child in a format of its own.
+    irods::hierarchy_parser parser;
+    if ( !parser.set_string( desc.rescHier ).ok() ) {
+        return -1;
+    }
+
+    std::vector<std::string> resc_types;
+    for ( const auto& resc_name : parser ) {
+        irods::resource_ptr resc;
+        std::string resc_type;
+        if ( !resc_mgr.resolve( resc_name, resc ).ok() ||
+             !resc->get_property<std::string>( irods::RESOURCE_TYPE, resc_type ).ok() ) {
+            return -1;
+        }
+        resc_types.push_back( resc_type );
+    }
+
+    if ( !irods::zero_copy::is_pass_through_hierarchy( resc_types ) ) {
+        return -1;
+    }
+
+    return desc.fd;
+} // getZeroCopyFd
+
 }
 
 int
@@ -100,6 +160,13 @@ svrToSvrConnectNoLogin( rsComm_t *rsComm, rodsServerHost_t *rodsServerHost ) {
 
 
     if ( rodsServerHost->conn == NULL ) { /* a connection already */
+        // the remote agent records its spans as children of this one
+        irods::experimental::tracing::span span{"svr_to_svr_connect", irods::experimental::tracing::span_kind::client};
+
+        if ( span.recording() ) {
+            span.set_attribute( "net.peer.name", rodsServerHost->hostName->name );
+        }
+
         if ( getenv( RECONNECT_ENV ) != NULL ) {
             reconnFlag = RECONN_TIMEOUT;
         }
@@ -701,6 +768,11 @@ partialDataPut( portalTransferInp_t *myInput ) {
     }
 
     buf = ( unsigned char* )malloc( ( 2 * trans_buff_size ) + sizeof( unsigned char ) );
+    // Unregistered before the buffer is freed.
+    std::optional<irods::io_engine::registered_buffer> registered_buf;
+    registered_buf.emplace( buf, static_cast<std::size_t>( 2 * trans_buff_size ) );
+
+    int zeroCopyFd = use_encryption_flg ? -1 : getZeroCopyFd( destL3descInx );
 
     while ( bytesToGet > 0 ) {
         int toread0;
@@ -727,10 +799,35 @@ partialDataPut( portalTransferInp_t *myInput ) {
                 _l3Close( myInput->rsComm, destL3descInx );
             }
             CLOSE_SOCK( srcFd );
+            registered_buf.reset();
             free( buf );
             return;
         }
 
+        if ( zeroCopyFd >= 0 ) {
+            bool unsupported = false;
+            const rodsLong_t moved = irods::zero_copy::receive_from_socket(
+                                         srcFd, zeroCopyFd, myOffset, toread0, unsupported );
+            if ( moved < 0 ) {
+                myInput->status = moved;
+                break;
+            }
+            else if ( unsupported ) {
+                // nothing was consumed from the socket. continue with the buffered path.
+                zeroCopyFd = -1;
+                if ( _l3Lseek( myInput->rsComm, destL3descInx, myOffset, SEEK_SET ) < 0 ) {
+                    myInput->status = SYS_COPY_LEN_ERR;
+                    break;
+                }
+            }
+            else {
+                FileDesc[destL3descInx].writtenFlag = 1;
+                bytesToGet -= moved;
+                myOffset   += moved;
+                continue;
+            }
+        }
+
         while ( toread0 > 0 ) {
             int toread1 = 0;
 
@@ -835,6 +932,7 @@ partialDataPut( portalTransferInp_t *myInput ) {
         }
     }           /* while loop bytesToGet */
 
+    registered_buf.reset();
     free( buf );
 
     applyRuleForSvrPortal( srcFd, PUT_OPR, 1, myOffset - myInput->offset, myInput->rsComm );
@@ -920,6 +1018,9 @@ void partialDataGet(
 
     size_t buf_size = ( 2 * trans_buff_size ) * sizeof( unsigned char ) ;
     unsigned char * buf = ( unsigned char* )malloc( buf_size );
+    // Unregistered before the buffer is freed.
+    std::optional<irods::io_engine::registered_buffer> registered_buf;
+    registered_buf.emplace( buf, buf_size );
 
     bytesToGet = myInput->size;
 
@@ -931,6 +1032,8 @@ void partialDataGet(
         return;
     }
 
+    int zeroCopyFd = use_encryption_flg ? -1 : getZeroCopyFd( srcL3descInx );
+
     while ( bytesToGet > 0 ) {
         int toread0;
         int bytesRead;
@@ -956,10 +1059,34 @@ void partialDataGet(
                 _l3Close( myInput->rsComm, srcL3descInx );
             }
             CLOSE_SOCK( destFd );
+            registered_buf.reset();
             free( buf );
             return;
         }
 
+        if ( zeroCopyFd >= 0 ) {
+            bool unsupported = false;
+            const rodsLong_t moved = irods::zero_copy::send_to_socket(
+                                         zeroCopyFd, destFd, myOffset, toread0, unsupported );
+            if ( moved < 0 ) {
+                myInput->status = moved;
+                break;
+            }
+            else if ( unsupported ) {
+                // nothing was sent. continue with the buffered path.
+                zeroCopyFd = -1;
+                if ( _l3Lseek( myInput->rsComm, srcL3descInx, myOffset, SEEK_SET ) < 0 ) {
+                    myInput->status = SYS_COPY_LEN_ERR;
+                    break;
+                }
+            }
+            else {
+                bytesToGet -= moved;
+                myOffset   += moved;
+                continue;
+            }
+        }
+
         while ( toread0 > 0 ) {
             int toread1;
 
@@ -1075,6 +1202,7 @@ void partialDataGet(
         }
     }           /* while loop bytesToGet */
 
+    registered_buf.reset();
     free( buf );
 
     applyRuleForSvrPortal( destFd, GET_OPR, 1, myOffset - myInput->offset, myInput->rsComm );
@@ -1683,10 +1811,38 @@ sameHostPartialCopy( portalTransferInp_t *myInput ) {
         return;
     }
 
-    buf = malloc( trans_buff_size );
-
     toCopy = myInput->size;
 
+    const int srcZeroCopyFd = getZeroCopyFd( srcL3descInx );
+    const int destZeroCopyFd = getZeroCopyFd( destL3descInx );
+    if ( srcZeroCopyFd >= 0 && destZeroCopyFd >= 0 ) {
+        bool unsupported = false;
+        const rodsLong_t copied = irods::zero_copy::copy_file_range(
+                                      srcZeroCopyFd, destZeroCopyFd, myInput->offset, toCopy, unsupported );
+        if ( !unsupported ) {
+            if ( copied < 0 ) {
+                myInput->status = copied;
+            }
+            else {
+                FileDesc[destL3descInx].writtenFlag = 1;
+                myInput->bytesWritten = copied;
+                if ( copied < toCopy && ( myInput->flags & NO_CHK_COPY_LEN_FLAG ) == 0 ) {
+                    myInput->status = SYS_COPY_LEN_ERR;
+                    rodsLog( LOG_ERROR,
+                             "sameHostPartialCopy: toCopy %lld, bytesCopied %lld",
+                             toCopy, copied );
+                }
+            }
+            if ( myInput->threadNum > 0 ) {
+                _l3Close( myInput->rsComm, destL3descInx );
+                _l3Close( myInput->rsComm, srcL3descInx );
+            }
+            return;
+        }
+    }
+
+    buf = malloc( trans_buff_size );
+
     while ( toCopy > 0 ) {
         int toRead;
 
@@ -32,32 +32,27 @@
 
 int
 initL1desc() {
-    memset( L1desc, 0, sizeof( L1desc ) );
+    L1desc.reset();
     return 0;
 }
 
 int
 allocL1desc() {
-    int i;
+    const int i = L1desc.allocate();
 
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
-        if ( L1desc[i].inuseFlag <= FD_FREE ) {
-            L1desc[i].inuseFlag = FD_INUSE;
-            return i;
-        };
+    if ( i < 0 ) {
+        rodsLog( LOG_NOTICE,
+                 "allocL1desc: out of L1desc" );
     }
 
-    rodsLog( LOG_NOTICE,
-             "allocL1desc: out of L1desc" );
-
-    return SYS_OUT_OF_FILE_DESC;
+    return i;
 }
 
 int
 isL1descInuse() {
     int i;
 
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
+    for ( i = 3; i < L1desc.size(); i++ ) {
         if ( L1desc[i].inuseFlag == FD_INUSE ) {
             return 1;
         };
@@ -112,7 +107,7 @@ closeAllL1desc( rsComm_t *rsComm ) {
     if ( rsComm == NULL ) {
         return 0;
     }
-    for ( i = 3; i < NUM_L1_DESC; i++ ) {
+    for ( i = 3; i < L1desc.size(); i++ ) {
         if ( L1desc[i].inuseFlag == FD_INUSE &&
                 L1desc[i].l3descInx > 2 ) {
             l3Close( rsComm, i );
@@ -123,7 +118,7 @@ closeAllL1desc( rsComm_t *rsComm ) {
 
 int
 freeL1desc( int l1descInx ) {
-    if ( l1descInx < 3 || l1descInx >= NUM_L1_DESC ) {
+    if ( !L1desc.is_valid_index( l1descInx ) ) {
         rodsLog( LOG_NOTICE, "freeL1desc: l1descInx %d out of range", l1descInx );
         return SYS_FILE_DESC_OUT_OF_RANGE;
     }
@@ -149,6 +144,7 @@ freeL1desc( int l1descInx ) {
     L1desc[l1descInx].replica_token.clear();
 
     memset( &L1desc[l1descInx], 0, sizeof( l1desc_t ) );
+    L1desc.release( l1descInx );
 
     return 0;
 }
@@ -284,7 +280,7 @@ initDataObjInfoWithInp( dataObjInfo_t *dataObjInfo, dataObjInp_t *dataObjInp ) {
 int
 getL1descIndexByDataObjInfo( const dataObjInfo_t * dataObjInfo ) {
     int index;
-    for ( index = 3; index < NUM_L1_DESC; index++ ) {
+    for ( index = 3; index < L1desc.size(); index++ ) {
         if ( L1desc[index].dataObjInfo == dataObjInfo ) {
             return index;
         }
@@ -0,0 +1,922 @@
+#include "pack_store.hpp"
+
+#include "irods_at_scope_exit.hpp"
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+#include <zlib.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace irods::experimental::pack
+{
+    namespace
+    {
+        constexpr std::uint32_t record_magic = 0x31524b50; // "PKR1"
+        constexpr std::uint32_t put_record = 1;
+        constexpr std::uint32_t tombstone_record = 2;
+        constexpr std::uint32_t index_record = 3;
+
+        constexpr std::size_t header_size = 32;
+        constexpr std::size_t index_entry_size = 24;
+        constexpr std::size_t max_key_size = 64 * 1024;
+
+        constexpr char trailer_magic[16] = "iRODS-pack-v01\n";
+        constexpr std::size_t trailer_size = 2 * sizeof(std::uint64_t) + sizeof(trailer_magic);
+
+        // Containers are read through a buffer of this size.
+        constexpr std::size_t scan_buffer_size = 1024 * 1024;
+
+        auto put_le32(unsigned char* _p, std::uint32_t _v) noexcept -> void
+        {
+            for (int i = 0; i < 4; ++i) {
+                _p[i] = static_cast<unsigned char>(_v >> (8 * i));
+            }
+        }
+
+        auto put_le64(unsigned char* _p, std::uint64_t _v) noexcept -> void
+        {
+            for (int i = 0; i < 8; ++i) {
+                _p[i] = static_cast<unsigned char>(_v >> (8 * i));
+            }
+        }
+
+        auto get_le32(const unsigned char* _p) noexcept -> std::uint32_t
+        {
+            std::uint32_t v = 0;
+            for (int i = 3; i >= 0; --i) {
+                v = (v << 8) | _p[i];
+            }
+            return v;
+        }
+
+        auto get_le64(const unsigned char* _p) noexcept -> std::uint64_t
+        {
+            std::uint64_t v = 0;
+            for (int i = 7; i >= 0; --i) {
+                v = (v << 8) | _p[i];
+            }
+            return v;
+        }
+
+        auto full_pread(int _fd, void* _buffer, std::size_t _size, off_t _offset) -> std::size_t
+        {
+            auto* p = static_cast<char*>(_buffer);
+            std::size_t total = 0;
+
+            while (total < _size) {
+                const auto n = ::pread(_fd, p + total, _size - total, _offset + total);
+
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    THROW(UNIX_FILE_READ_ERR - errno, "pack: read error");
+                }
+
+                if (0 == n) {
+                    break;
+                }
+
+                total += n;
+            }
+
+            return total;
+        } // full_pread
+
+        auto full_pwrite(int _fd, const void* _buffer, std::size_t _size, off_t _offset) -> void
+        {
+            const auto* p = static_cast<const char*>(_buffer);
+            std::size_t total = 0;
+
+            while (total < _size) {
+                const auto n = ::pwrite(_fd, p + total, _size - total, _offset + total);
+
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    THROW(UNIX_FILE_WRITE_ERR - errno, "pack: write error");
+                }
+
+                total += n;
+            }
+        } // full_pwrite
+
+        auto file_size(int _fd) -> std::uint64_t
+        {
+            struct stat st{};
+            if (::fstat(_fd, &st) < 0) {
+                THROW(UNIX_FILE_STAT_ERR - errno, "pack: cannot stat a container");
+            }
+            return st.st_size;
+        }
+
+        auto crc(std::uint32_t _crc, const void* _data, std::size_t _size) noexcept -> std::uint32_t
+        {
+            return static_cast<std::uint32_t>(crc32(_crc, static_cast<const Bytef*>(_data), static_cast<uInt>(_size)));
+        }
+
+        // The crc of a record header, which covers every field but itself, and the key.
+        auto header_crc(const unsigned char* _header, const char* _key, std::size_t _key_size) noexcept
+            -> std::uint32_t
+        {
+            auto v = crc(0, _header, 12);
+            v = crc(v, _header + 16, header_size - 16);
+            return crc(v, _key, _key_size);
+        }
+
+        // Returns the header and key of a record.
+        auto make_record_prefix(std::uint32_t _type, const std::string& _key, const void* _data, std::size_t _size)
+            -> std::vector<unsigned char>
+        {
+            std::vector<unsigned char> prefix(header_size + _key.size());
+            auto* h = prefix.data();
+
+            put_le32(h, record_magic);
+            put_le32(h + 4, _type);
+            put_le32(h + 8, static_cast<std::uint32_t>(_key.size()));
+            put_le64(h + 16, _size);
+            put_le32(h + 24, crc(0, _data, _size));
+            put_le32(h + 12, header_crc(h, _key.data(), _key.size()));
+            std::memcpy(h + header_size, _key.data(), _key.size());
+
+            return prefix;
+        } // make_record_prefix
+
+        // Holds the lock file of a store.
+        class file_lock
+        {
+        public:
+            file_lock(int _fd, int _operation)
+                : fd_{_fd}
+            {
+                while (::flock(fd_, _operation) < 0) {
+                    if (EINTR != errno) {
+                        THROW(UNIX_FILE_OPEN_ERR - errno, "pack: cannot lock the store");
+                    }
+                }
+            }
+
+            file_lock(const file_lock&) = delete;
+            auto operator=(const file_lock&) -> file_lock& = delete;
+
+            ~file_lock()
+            {
+                ::flock(fd_, LOCK_UN);
+            }
+
+        private:
+            int fd_;
+        }; // class file_lock
+
+        auto record_bytes(std::size_t _key_size, std::uint64_t _data_size) noexcept -> std::uint64_t
+        {
+            return header_size + _key_size + _data_size;
+        }
+
+        // Returns the id of the container named _name, or zero if it is not a container.
+        auto parse_container_name(const std::string& _name) -> std::uint64_t
+        {
+            if (_name.size() != 21 || _name.compare(16, 5, ".pack") != 0) {
+                return 0;
+            }
+
+            std::uint64_t id = 0;
+            for (std::size_t i = 0; i < 16; ++i) {
+                const char c = _name[i];
+                if (c >= '0' && c <= '9') {
+                    id = (id << 4) | (c - '0');
+                }
+                else if (c >= 'a' && c <= 'f') {
+                    id = (id << 4) | (c - 'a' + 10);
+                }
+                else {
+                    return 0;
+                }
+            }
+
+            return id;
+        } // parse_container_name
+    } // anonymous namespace
+
+    pack_store::pack_store(std::string _directory, pack_parameters _params)
+        : directory_{std::move(_directory)}
+        , params_{_params}
+        , lock_fd_{-1}
+        , active_fd_{-1}
+        , active_id_{0}
+        , containers_{}
+        , index_{}
+        , mutex_{}
+        , compaction_pending_{false}
+        , pool_{1}
+    {
+        if (params_.max_container_size < header_size + trailer_size) {
+            THROW(SYS_INVALID_INPUT_PARAM, "pack: the maximum container size is too small");
+        }
+
+        if (params_.compaction_threshold <= 0 || params_.compaction_threshold > 1) {
+            THROW(SYS_INVALID_INPUT_PARAM, "pack: the compaction threshold must be in (0, 1]");
+        }
+
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(directory_, ec);
+        if (ec) {
+            THROW(UNIX_FILE_MKDIR_ERR - ec.value(), fmt::format("pack: cannot create [{}]", directory_));
+        }
+
+        lock_fd_ = ::open((directory_ + "/lock").c_str(), O_RDWR | O_CREAT, 0600);
+        if (lock_fd_ < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("pack: cannot open the lock file of [{}]", directory_));
+        }
+
+        std::lock_guard<std::mutex> lock{mutex_};
+        file_lock store_lock{lock_fd_, LOCK_SH};
+        catch_up();
+    } // pack_store
+
+    pack_store::~pack_store()
+    {
+        pool_.join();
+
+        if (active_fd_ >= 0) {
+            ::close(active_fd_);
+        }
+
+        if (lock_fd_ >= 0) {
+            ::close(lock_fd_);
+        }
+    } // ~pack_store
+
+    auto pack_store::container_path(std::uint64_t _container) const -> std::string
+    {
+        return fmt::format("{}/{:016x}.pack", directory_, _container);
+    }
+
+    auto pack_store::put(const std::string& _key, const void* _data, std::size_t _size) -> location
+    {
+        bool compact = false;
+        location result;
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            file_lock store_lock{lock_fd_, LOCK_EX};
+            catch_up();
+
+            const auto previous = append(put_record, _key, _data, _size);
+            result = index_.at(_key);
+            compact = previous && needs_compaction(*previous);
+        }
+
+        if (compact) {
+            compact_in_background();
+        }
+
+        return result;
+    } // put
+
+    auto pack_store::remove(const std::string& _key) -> bool
+    {
+        bool compact = false;
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            file_lock store_lock{lock_fd_, LOCK_EX};
+            catch_up();
+
+            if (index_.find(_key) == std::end(index_)) {
+                return false;
+            }
+
+            const auto previous = append(tombstone_record, _key, nullptr, 0);
+            compact = previous && needs_compaction(*previous);
+        }
+
+        if (compact) {
+            compact_in_background();
+        }
+
+        return true;
+    } // remove
+
+    auto pack_store::rename(const std::string& _from, const std::string& _to) -> bool
+    {
+        bool compact = false;
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            file_lock store_lock{lock_fd_, LOCK_EX};
+            catch_up();
+
+            const auto itr = index_.find(_from);
+            if (itr == std::end(index_)) {
+                return false;
+            }
+
+            // Objects are small, so the content is copied rather than referred to.
+            const auto data = read(itr->second);
+
+            auto previous = append(put_record, _to, data.data(), data.size());
+            compact = previous && needs_compaction(*previous);
+
+            previous = append(tombstone_record, _from, nullptr, 0);
+            compact = compact || (previous && needs_compaction(*previous));
+        }
+
+        if (compact) {
+            compact_in_background();
+        }
+
+        return true;
+    } // rename
+
+    auto pack_store::find(const std::string& _key) -> std::optional<location>
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        file_lock store_lock{lock_fd_, LOCK_SH};
+        catch_up();
+
+        if (const auto itr = index_.find(_key); itr != std::end(index_)) {
+            return itr->second;
+        }
+
+        return std::nullopt;
+    } // find
+
+    auto pack_store::read(const location& _location) const -> std::vector<char>
+    {
+        const auto path = container_path(_location.container);
+
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("pack: cannot open [{}]", path));
+        }
+
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+
+        std::vector<char> data(_location.size);
+        if (full_pread(fd, data.data(), data.size(), _location.offset) != data.size()) {
+            THROW(SYS_COPY_LEN_ERR, fmt::format("pack: short read of {} bytes from [{}]", data.size(), path));
+        }
+
+        return data;
+    } // read
+
+    auto pack_store::reload() -> void
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        file_lock store_lock{lock_fd_, LOCK_SH};
+
+        containers_.clear();
+        index_.clear();
+
+        if (active_fd_ >= 0) {
+            ::close(active_fd_);
+            active_fd_ = -1;
+        }
+
+        catch_up();
+    } // reload
+
+    auto pack_store::compact() -> std::int64_t
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        file_lock store_lock{lock_fd_, LOCK_EX};
+        catch_up();
+
+        std::int64_t reclaimed = 0;
+        std::uint64_t last = 0;
+
+        // Looked up again after every compaction, because compacting the oldest
+        // container turns the tombstones of the next one into dead bytes.
+        while (true) {
+            const auto itr = std::find_if(containers_.upper_bound(last), std::end(containers_), [this](auto&& _entry) {
+                return needs_compaction(_entry.first);
+            });
+
+            if (itr == std::end(containers_)) {
+                return reclaimed;
+            }
+
+            last = itr->first;
+            reclaimed += compact_locked(last);
+        }
+    } // compact
+
+    auto pack_store::compact(std::uint64_t _container) -> std::int64_t
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        file_lock store_lock{lock_fd_, LOCK_EX};
+        catch_up();
+
+        return compact_locked(_container);
+    } // compact
+
+    auto pack_store::statistics() -> store_statistics
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        file_lock store_lock{lock_fd_, LOCK_SH};
+        catch_up();
+
+        store_statistics stats;
+        stats.containers = containers_.size();
+        stats.objects = index_.size();
+
+        for (auto&& entry : containers_) {
+            stats.live_bytes += entry.second.live_bytes;
+            stats.total_bytes += entry.second.total_bytes;
+        }
+
+        return stats;
+    } // statistics
+
+    auto pack_store::catch_up() -> void
+    {
+        if (containers_.empty()) {
+            std::vector<std::uint64_t> ids;
+
+            for (auto&& entry : boost::filesystem::directory_iterator{directory_}) {
+                if (const auto id = parse_container_name(entry.path().filename().string()); id > 0) {
+                    ids.push_back(id);
+                }
+            }
+
+            std::sort(std::begin(ids), std::end(ids));
+
+            for (auto id : ids) {
+                load(id, containers_[id]);
+            }
+
+            return;
+        }
+
+        // Containers are only ever added after the newest one, once it is sealed.
+        while (true) {
+            auto& [id, newest] = *containers_.rbegin();
+
+            if (!newest.sealed) {
+                load(id, newest);
+
+                if (!newest.sealed) {
+                    return;
+                }
+            }
+
+            const auto next = id + 1;
+            struct stat st{};
+            if (::stat(container_path(next).c_str(), &st) < 0) {
+                return;
+            }
+
+            load(next, containers_[next]);
+        }
+    } // catch_up
+
+    auto pack_store::load(std::uint64_t _id, container& _container) -> void
+    {
+        const bool active = _id == active_id_ && active_fd_ >= 0;
+        const int fd = active ? active_fd_ : ::open(container_path(_id).c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (ENOENT == errno) {
+                // Compacted by another process since the directory was listed.
+                return;
+            }
+
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("pack: cannot open [{}]", container_path(_id)));
+        }
+
+        const irods::at_scope_exit close_fd{[fd, active] {
+            if (!active) {
+                ::close(fd);
+            }
+        }};
+
+        const auto size = file_size(fd);
+        if (size <= _container.end) {
+            return;
+        }
+
+        const auto apply_record = [this, _id](const record& _record) { apply(_id, _record); };
+
+        // A sealed container is read from its index rather than record by record.
+        if (0 == _container.end && read_index(fd, size, apply_record)) {
+            _container.end = size;
+            _container.sealed = true;
+            return;
+        }
+
+        const auto [end, sealed] = scan(fd, _container.end, size, apply_record);
+        _container.end = end;
+        _container.sealed = sealed;
+    } // load
+
+    auto pack_store::scan(int _fd,
+                          std::uint64_t _from,
+                          std::uint64_t _size,
+                          const std::function<void(const record&)>& _func) const -> std::pair<std::uint64_t, bool>
+    {
+        std::vector<unsigned char> buffer(scan_buffer_size);
+        std::uint64_t buffer_offset = 0;
+        std::uint64_t buffer_size = 0;
+
+        // Returns the _n bytes at _offset, reading them into the buffer unless it
+        // already holds them.
+        const auto fetch = [&](std::uint64_t _offset, std::size_t _n) -> const unsigned char* {
+            if (_offset < buffer_offset || _offset + _n > buffer_offset + buffer_size) {
+                if (_n > buffer.size()) {
+                    buffer.resize(_n);
+                }
+
+                buffer_offset = _offset;
+                buffer_size = full_pread(_fd, buffer.data(), std::min<std::uint64_t>(buffer.size(), _size - _offset), _offset);
+
+                if (buffer_size < _n) {
+                    return nullptr;
+                }
+            }
+
+            return buffer.data() + (_offset - buffer_offset);
+        };
+
+        auto offset = _from;
+
+        while (offset + header_size <= _size) {
+            unsigned char header[header_size];
+            const auto* h = fetch(offset, header_size);
+            if (!h) {
+                break;
+            }
+            std::memcpy(header, h, header_size);
+
+            const auto type = get_le32(header + 4);
+            const auto key_size = get_le32(header + 8);
+            const auto data_size = get_le64(header + 16);
+
+            // The end of the container, or a record which a process did not finish.
+            if (get_le32(header) != record_magic || type < put_record || type > index_record ||
+                key_size > max_key_size || data_size > _size) {
+                break;
+            }
+
+            const auto end = offset + record_bytes(key_size, data_size);
+            if (end > _size) {
+                break;
+            }
+
+            const auto* k = fetch(offset + header_size, key_size);
+            if (!k) {
+                break;
+            }
+
+            record r{type, std::string(reinterpret_cast<const char*>(k), key_size), offset, data_size};
+
+            if (get_le32(header + 12) != header_crc(header, r.key.data(), r.key.size())) {
+                break;
+            }
+
+            if (index_record == type) {
+                return {_size, true};
+            }
+
+            _func(r);
+            offset = end;
+        }
+
+        return {offset, false};
+    } // scan
+
+    auto pack_store::read_index(int _fd, std::uint64_t _size, const std::function<void(const record&)>& _func) const
+        -> bool
+    {
+        if (_size < header_size + trailer_size) {
+            return false;
+        }
+
+        unsigned char trailer[trailer_size];
+        if (full_pread(_fd, trailer, trailer_size, _size - trailer_size) != trailer_size ||
+            std::memcmp(trailer + 16, trailer_magic, sizeof(trailer_magic)) != 0)
+        {
+            return false;
+        }
+
+        const auto index_offset = get_le64(trailer);
+        const auto index_size = get_le64(trailer + 8);
+
+        if (index_size < header_size || index_offset > _size || index_offset + index_size + trailer_size != _size) {
+            return false;
+        }
+
+        std::vector<unsigned char> index(index_size);
+        if (full_pread(_fd, index.data(), index.size(), index_offset) != index.size()) {
+            return false;
+        }
+
+        const auto* h = index.data();
+        const auto* data = h + header_size;
+        const auto data_size = index_size - header_size;
+
+        if (get_le32(h) != record_magic || get_le32(h + 4) != index_record || get_le32(h + 8) != 0 ||
+            get_le32(h + 12) != header_crc(h, nullptr, 0) || get_le64(h + 16) != data_size ||
+            get_le32(h + 24) != crc(0, data, data_size) || data_size < sizeof(std::uint64_t))
+        {
+            return false;
+        }
+
+        // The index is read in full before any record is applied, so that a damaged
+        // index falls back to a scan without leaving half of it behind.
+        std::vector<record> records(get_le64(data));
+        std::size_t position = sizeof(std::uint64_t);
+
+        for (auto&& r : records) {
+            if (position + index_entry_size > data_size) {
+                return false;
+            }
+
+            const auto* e = data + position;
+            r.type = get_le32(e);
+            const auto key_size = get_le32(e + 4);
+            r.offset = get_le64(e + 8);
+            r.data_size = get_le64(e + 16);
+            position += index_entry_size;
+
+            if (position + key_size > data_size || (put_record != r.type && tombstone_record != r.type)) {
+                return false;
+            }
+
+            r.key.assign(reinterpret_cast<const char*>(data + position), key_size);
+            position += key_size;
+        }
+
+        for (auto&& r : records) {
+            _func(r);
+        }
+
+        return true;
+    } // read_index
+
+    auto pack_store::apply(std::uint64_t _id, const record& _record) -> std::optional<std::uint64_t>
+    {
+        auto& c = containers_[_id];
+        const auto bytes = record_bytes(_record.key.size(), _record.data_size);
+        c.total_bytes += bytes;
+
+        std::optional<std::uint64_t> previous;
+
+        if (auto itr = index_.find(_record.key); itr != std::end(index_)) {
+            previous = itr->second.container;
+
+            if (auto old = containers_.find(*previous); old != std::end(containers_)) {
+                old->second.live_bytes -= std::min(old->second.live_bytes, record_bytes(_record.key.size(), itr->second.size));
+            }
+
+            index_.erase(itr);
+        }
+
+        if (put_record == _record.type) {
+            index_[_record.key] = location{_id, _record.offset + header_size + _record.key.size(), _record.data_size};
+            c.live_bytes += bytes;
+        }
+        else {
+            c.tombstone_bytes += bytes;
+        }
+
+        return previous;
+    } // apply
+
+    auto pack_store::append(std::uint32_t _type, const std::string& _key, const void* _data, std::size_t _size)
+        -> std::optional<std::uint64_t>
+    {
+        if (_key.size() > max_key_size) {
+            THROW(SYS_INVALID_INPUT_PARAM, fmt::format("pack: the key is longer than {} bytes", max_key_size));
+        }
+
+        const auto bytes = record_bytes(_key.size(), _size);
+
+        if (containers_.empty()) {
+            containers_[1];
+        }
+
+        auto itr = std::prev(std::end(containers_));
+
+        if (itr->second.sealed || (itr->second.end > 0 && itr->second.end + bytes > params_.max_container_size)) {
+            if (!itr->second.sealed) {
+                seal(itr->first, itr->second);
+            }
+
+            itr = containers_.emplace(itr->first + 1, container{}).first;
+        }
+
+        auto& c = itr->second;
+        const int fd = open_active(itr->first);
+
+        // Drop what a process which died in the middle of an append left behind.
+        if (file_size(fd) > c.end && ::ftruncate(fd, c.end) < 0) {
+            THROW(UNIX_FILE_TRUNCATE_ERR - errno, fmt::format("pack: cannot truncate [{}]", container_path(itr->first)));
+        }
+
+        auto buffer = make_record_prefix(_type, _key, _data, _size);
+        buffer.insert(std::end(buffer), static_cast<const unsigned char*>(_data), static_cast<const unsigned char*>(_data) + _size);
+        full_pwrite(fd, buffer.data(), buffer.size(), c.end);
+
+        if (params_.sync && ::fdatasync(fd) < 0) {
+            THROW(UNIX_FILE_FSYNC_ERR - errno, fmt::format("pack: cannot flush [{}]", container_path(itr->first)));
+        }
+
+        const auto previous = apply(itr->first, record{_type, _key, c.end, _size});
+        c.end += bytes;
+
+        return previous;
+    } // append
+
+    auto pack_store::seal(std::uint64_t _id, container& _container) -> void
+    {
+        const int fd = open_active(_id);
+
+        if (file_size(fd) > _container.end && ::ftruncate(fd, _container.end) < 0) {
+            THROW(UNIX_FILE_TRUNCATE_ERR - errno, fmt::format("pack: cannot truncate [{}]", container_path(_id)));
+        }
+
+        std::vector<unsigned char> entries(sizeof(std::uint64_t));
+        std::uint64_t count = 0;
+
+        scan(fd, 0, _container.end, [&entries, &count](const record& _record) {
+            const auto position = entries.size();
+            entries.resize(position + index_entry_size + _record.key.size());
+
+            auto* e = entries.data() + position;
+            put_le32(e, _record.type);
+            put_le32(e + 4, static_cast<std::uint32_t>(_record.key.size()));
+            put_le64(e + 8, _record.offset);
+            put_le64(e + 16, _record.data_size);
+            std::memcpy(e + index_entry_size, _record.key.data(), _record.key.size());
+
+            ++count;
+        });
+
+        put_le64(entries.data(), count);
+
+        auto buffer = make_record_prefix(index_record, {}, entries.data(), entries.size());
+        buffer.insert(std::end(buffer), std::begin(entries), std::end(entries));
+
+        unsigned char trailer[trailer_size];
+        put_le64(trailer, _container.end);
+        put_le64(trailer + 8, buffer.size());
+        std::memcpy(trailer + 16, trailer_magic, sizeof(trailer_magic));
+        buffer.insert(std::end(buffer), trailer, trailer + trailer_size);
+
+        full_pwrite(fd, buffer.data(), buffer.size(), _container.end);
+
+        if (params_.sync && ::fdatasync(fd) < 0) {
+            THROW(UNIX_FILE_FSYNC_ERR - errno, fmt::format("pack: cannot flush [{}]", container_path(_id)));
+        }
+
+        _container.end += buffer.size();
+        _container.sealed = true;
+    } // seal
+
+    auto pack_store::open_active(std::uint64_t _id) -> int
+    {
+        if (_id == active_id_ && active_fd_ >= 0) {
+            return active_fd_;
+        }
+
+        if (active_fd_ >= 0) {
+            ::close(active_fd_);
+            active_fd_ = -1;
+        }
+
+        const auto path = container_path(_id);
+        active_fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0600);
+        if (active_fd_ < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("pack: cannot open [{}]", path));
+        }
+
+        active_id_ = _id;
+
+        return active_fd_;
+    } // open_active
+
+    auto pack_store::compact_locked(std::uint64_t _id) -> std::int64_t
+    {
+        const auto itr = containers_.find(_id);
+        if (itr == std::end(containers_) || !itr->second.sealed || _id == containers_.rbegin()->first) {
+            return 0;
+        }
+
+        const auto path = container_path(_id);
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (ENOENT == errno) {
+                // Compacted by another process.
+                containers_.erase(itr);
+                return 0;
+            }
+
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("pack: cannot open [{}]", path));
+        }
+
+        const irods::at_scope_exit close_fd{[fd] { ::close(fd); }};
+        const auto size = file_size(fd);
+
+        // A tombstone must outlive the content it removes, which may still be in an
+        // older container.
+        std::vector<std::string> tombstones;
+        if (containers_.begin()->first < _id) {
+            const auto keep_tombstone = [this, &tombstones](const record& _record) {
+                if (tombstone_record == _record.type && index_.find(_record.key) == std::end(index_)) {
+                    tombstones.push_back(_record.key);
+                }
+            };
+
+            if (!read_index(fd, size, keep_tombstone)) {
+                scan(fd, 0, size, keep_tombstone);
+            }
+        }
+
+        std::vector<std::pair<std::string, location>> live;
+        for (auto&& [key, loc] : index_) {
+            if (loc.container == _id) {
+                live.emplace_back(key, loc);
+            }
+        }
+
+        std::int64_t copied = 0;
+        std::vector<char> data;
+
+        for (auto&& [key, loc] : live) {
+            data.resize(loc.size);
+            if (full_pread(fd, data.data(), data.size(), loc.offset) != data.size()) {
+                THROW(SYS_COPY_LEN_ERR, fmt::format("pack: short read of {} bytes from [{}]", data.size(), path));
+            }
+
+            append(put_record, key, data.data(), data.size());
+            copied += record_bytes(key.size(), data.size());
+        }
+
+        for (auto&& key : tombstones) {
+            append(tombstone_record, key, nullptr, 0);
+            copied += record_bytes(key.size(), 0);
+        }
+
+        // The copies must be on disk before the originals are removed.
+        if (!live.empty() || !tombstones.empty()) {
+            if (::fdatasync(active_fd_) < 0) {
+                THROW(UNIX_FILE_FSYNC_ERR - errno, fmt::format("pack: cannot flush [{}]", container_path(active_id_)));
+            }
+        }
+
+        if (::unlink(path.c_str()) < 0) {
+            THROW(UNIX_FILE_UNLINK_ERR - errno, fmt::format("pack: cannot remove [{}]", path));
+        }
+
+        containers_.erase(_id);
+
+        const auto reclaimed = static_cast<std::int64_t>(size) - copied;
+        rodsLog(LOG_DEBUG, "pack: compacted [%s], moved %zu objects and reclaimed %lld bytes",
+                path.c_str(), live.size(), static_cast<long long>(reclaimed));
+
+        return reclaimed;
+    } // compact_locked
+
+    auto pack_store::needs_compaction(std::uint64_t _id) const -> bool
+    {
+        const auto itr = containers_.find(_id);
+        if (itr == std::end(containers_) || !itr->second.sealed || _id == containers_.rbegin()->first) {
+            return false;
+        }
+
+        const auto& c = itr->second;
+        const auto kept = c.live_bytes + (itr == std::begin(containers_) ? 0 : c.tombstone_bytes);
+
+        return c.total_bytes > 0 && 1.0 - static_cast<double>(kept) / c.total_bytes >= params_.compaction_threshold;
+    } // needs_compaction
+
+    auto pack_store::compact_in_background() -> void
+    {
+        if (compaction_pending_.exchange(true)) {
+            return;
+        }
+
+        irods::thread_pool::post(pool_, [this] {
+            try {
+                compact();
+            }
+            catch (const irods::exception& e) {
+                rodsLog(LOG_ERROR, "pack: compaction of [%s] failed: %s", directory_.c_str(), e.client_display_what());
+            }
+
+            compaction_pending_ = false;
+        });
+    } // compact_in_background
+} // namespace irods::experimental::pack
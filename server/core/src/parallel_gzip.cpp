@@ -0,0 +1,198 @@
+#include "parallel_gzip.hpp"
+
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+
+#include <fmt/format.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace irods::experimental::gzip
+{
+    namespace
+    {
+        // The largest distance a deflate match may reach back.
+        constexpr std::size_t window_size = 32 * 1024;
+
+        // Compresses _block as a piece of a raw deflate stream. Every block but the last
+        // ends on a byte boundary, so the pieces can be joined.
+        auto deflate_block(int _level, std::vector<char>& _input, const std::vector<char>& _dictionary,
+                           std::vector<char>& _output, bool _last) -> int
+        {
+            z_stream zs{};
+
+            if (const auto ec = deflateInit2(&zs, _level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY); ec != Z_OK) {
+                return ec;
+            }
+
+            if (!_dictionary.empty()) {
+                const auto ec = deflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(_dictionary.data()),
+                                                     static_cast<uInt>(_dictionary.size()));
+                if (ec != Z_OK) {
+                    deflateEnd(&zs);
+                    return ec;
+                }
+            }
+
+            // A sync flush adds at most a few bytes beyond the bound.
+            _output.resize(deflateBound(&zs, static_cast<uLong>(_input.size())) + 16);
+
+            zs.next_in = reinterpret_cast<Bytef*>(_input.data());
+            zs.avail_in = static_cast<uInt>(_input.size());
+            zs.next_out = reinterpret_cast<Bytef*>(_output.data());
+            zs.avail_out = static_cast<uInt>(_output.size());
+
+            const auto ec = deflate(&zs, _last ? Z_FINISH : Z_SYNC_FLUSH);
+            const auto expected = _last ? Z_STREAM_END : Z_OK;
+
+            _output.resize(zs.total_out);
+            deflateEnd(&zs);
+
+            return (ec == expected && zs.avail_in == 0) ? Z_OK : (ec == Z_OK ? Z_BUF_ERROR : ec);
+        } // deflate_block
+
+        auto put_le32(unsigned char* _p, std::uint32_t _value) noexcept -> void
+        {
+            for (int i = 0; i < 4; ++i) {
+                _p[i] = static_cast<unsigned char>(_value >> (8 * i));
+            }
+        } // put_le32
+    } // anonymous namespace
+
+    parallel_writer::parallel_writer(sink_function _sink, int _threads, int _level, std::size_t _block_size)
+        : sink_{std::move(_sink)}
+        , level_{_level}
+        , block_size_{std::clamp<std::size_t>(_block_size, window_size, std::numeric_limits<uInt>::max() / 2)}
+        , max_pending_{2 * static_cast<std::size_t>(std::max(_threads, 1))}
+        , current_{std::make_shared<block>()}
+        , pending_{}
+        , crc_{crc32(0, Z_NULL, 0)}
+        , bytes_in_{}
+        , bytes_out_{}
+        , closed_{}
+        , mutex_{}
+        , done_{}
+        , pool_{std::max(_threads, 1)}
+    {
+        current_->input.reserve(block_size_);
+    } // parallel_writer
+
+    parallel_writer::~parallel_writer()
+    {
+        pool_.stop();
+        pool_.join();
+    } // ~parallel_writer
+
+    auto parallel_writer::write(const void* _data, std::size_t _size) -> void
+    {
+        if (closed_) {
+            THROW(SYS_INTERNAL_ERR, "parallel_writer: write after close");
+        }
+
+        const auto* p = static_cast<const char*>(_data);
+
+        while (_size > 0) {
+            const auto n = std::min(_size, block_size_ - current_->input.size());
+            current_->input.insert(std::end(current_->input), p, p + n);
+            p += n;
+            _size -= n;
+            bytes_in_ += n;
+
+            if (current_->input.size() == block_size_) {
+                submit(false);
+            }
+        }
+    } // write
+
+    auto parallel_writer::close() -> void
+    {
+        if (closed_) {
+            return;
+        }
+
+        closed_ = true;
+        submit(true);
+        drain(0);
+
+        std::array<unsigned char, 8> trailer{};
+        put_le32(trailer.data(), static_cast<std::uint32_t>(crc_));
+        put_le32(trailer.data() + 4, static_cast<std::uint32_t>(bytes_in_));
+        emit(trailer.data(), trailer.size());
+    } // close
+
+    auto parallel_writer::submit(bool _last) -> void
+    {
+        auto b = std::move(current_);
+        b->last = _last;
+
+        current_ = std::make_shared<block>();
+        current_->input.reserve(block_size_);
+
+        // The next block is primed with the end of this one.
+        const auto dictionary_size = std::min(window_size, b->input.size());
+        current_->dictionary.assign(std::end(b->input) - dictionary_size, std::end(b->input));
+
+        // Bound the memory held by blocks waiting for the sink.
+        drain(max_pending_ - 1);
+
+        pending_.push_back(b);
+
+        irods::thread_pool::post(pool_, [this, b, level = level_] {
+            b->crc = crc32(0, reinterpret_cast<const Bytef*>(b->input.data()), static_cast<uInt>(b->input.size()));
+            const auto ec = deflate_block(level, b->input, b->dictionary, b->output, b->last);
+
+            {
+                std::lock_guard lock{mutex_};
+                b->error = ec;
+                b->done = true;
+            }
+
+            done_.notify_all();
+        });
+    } // submit
+
+    auto parallel_writer::drain(std::size_t _max_pending) -> void
+    {
+        while (!pending_.empty()) {
+            auto& b = pending_.front();
+
+            {
+                std::unique_lock lock{mutex_};
+
+                if (pending_.size() <= _max_pending && !b->done) {
+                    return;
+                }
+
+                done_.wait(lock, [&b] { return b->done; });
+            }
+
+            if (b->error != Z_OK) {
+                THROW(SYS_LIBRARY_ERROR, fmt::format("parallel_writer: deflate failed with zlib error [{}]", b->error));
+            }
+
+            crc_ = crc32_combine(crc_, b->crc, static_cast<z_off_t>(b->input.size()));
+            emit(b->output.data(), b->output.size());
+
+            pending_.pop_front();
+        }
+    } // drain
+
+    auto parallel_writer::emit(const void* _data, std::size_t _size) -> void
+    {
+        // The sink is not used before the first block is ready, so the destination of
+        // the stream may be opened after the writer is constructed.
+        if (0 == bytes_out_) {
+            // The gzip header: no name, no modification time, unknown OS.
+            const std::array<unsigned char, 10> header{0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff};
+            sink_(header.data(), header.size());
+            bytes_out_ += header.size();
+        }
+
+        sink_(_data, _size);
+        bytes_out_ += _size;
+    } // emit
+} // namespace irods::experimental::gzip
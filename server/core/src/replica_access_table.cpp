@@ -5,13 +5,18 @@
 #include <boost/interprocess/containers/map.hpp>
 #include <boost/interprocess/containers/vector.hpp>
 #include <boost/interprocess/containers/string.hpp>
-#include <boost/interprocess/sync/named_mutex.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/interprocess/exceptions.hpp>
 
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include <signal.h>
+
+#include <cerrno>
+#include <charconv>
 #include <memory>
 #include <algorithm>
 #include <vector>
@@ -53,17 +58,58 @@ namespace irods::experimental
         using mapped_type          = access_entry;
         using value_type           = std::pair<const key_type, mapped_type>;
         using value_allocator_type = bi::allocator<value_type, segment_manager_type>;
-        using map_type             = bi::map<key_type, mapped_type, std::less<key_type>, value_allocator_type>;
         // clang-format on
-        
+
+        // Allows lookups by replica_token_view_type. Building a key_type for a lookup
+        // would allocate in shared memory, which serializes every process on the lock
+        // held by the segment manager.
+        struct key_compare
+        {
+            using is_transparent = void;
+
+            static auto view(const key_type& _k) noexcept -> replica_token_view_type
+            {
+                return {_k.data(), _k.size()};
+            }
+
+            static auto view(replica_token_view_type _k) noexcept -> replica_token_view_type
+            {
+                return _k;
+            }
+
+            template <typename T, typename U>
+            auto operator()(const T& _lhs, const U& _rhs) const noexcept -> bool
+            {
+                return view(_lhs) < view(_rhs);
+            }
+        }; // struct key_compare
+
+        using map_type = bi::map<key_type, mapped_type, key_compare, value_allocator_type>;
+
+        // A subset of the table. Each shard is guarded by its own lock so that agents
+        // working on different replicas do not wait on one another.
+        struct shard
+        {
+            explicit shard(const void_allocator_type& _allocator)
+                : mutex{}
+                , entries{key_compare{}, _allocator}
+            {
+            }
+
+            bi::interprocess_mutex mutex;
+            map_type entries;
+        }; // struct shard
+
         //
         // Global Variables
         //
 
         // The following variables define the names of shared memory objects and other properties.
-        const char* g_mutex_name = "irods_replica_access_table_mutex";
         const char* g_segment_name = "irods_replica_access_table";
-        const std::size_t g_segment_size = 1'000'000; // TODO This could be a knob.
+
+        // The number of shards. The shard index is stored in the first byte of each
+        // replica token, so this must not exceed 256.
+        constexpr std::size_t g_shard_count = 64;
 
         // A flag used to indicate whether the replica access table has been initialized or not.
         bool g_initialized = false;
@@ -76,25 +122,116 @@ namespace irods::experimental
         // Allocating on the heap allows us to know when the replica access table is constructed/destructed.
         std::unique_ptr<bi::managed_shared_memory> g_segment;
         std::unique_ptr<void_allocator_type> g_allocator;
-        std::unique_ptr<bi::named_mutex> g_mutex;
-        map_type* g_fd_info_map;
+        shard* g_shards;
+
+        // Returns the index of the shard holding the entry for a replica.
+        auto shard_index(data_id_type _data_id, replica_number_type _replica_number) noexcept -> std::size_t
+        {
+            // Data ids are sequential, so the bits are mixed (MurmurHash3 finalizer) to
+            // spread neighboring data objects across shards.
+            auto h = _data_id ^ (static_cast<std::uint64_t>(_replica_number) << 48);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+
+            return h % g_shard_count;
+        }
+
+        // Returns the index of the shard encoded in a replica token, or -1 if the token
+        // is malformed.
+        auto shard_index(replica_token_view_type _token) noexcept -> int
+        {
+            unsigned int index{};
+
+            if (_token.size() < 2) {
+                return -1;
+            }
+
+            const auto* last = _token.data() + 2;
+
+            if (const auto [ptr, ec] = std::from_chars(_token.data(), last, index, 16);
+                ec != std::errc{} || ptr != last || index >= g_shard_count)
+            {
+                return -1;
+            }
+
+            return static_cast<int>(index);
+        }
+
+        auto get_shard(replica_token_view_type _token) noexcept -> shard*
+        {
+            const auto index = shard_index(_token);
+            return index < 0 ? nullptr : &g_shards[index];
+        }
 
         // Returns a new replica token (i.e. UUID) allocated in shared memory.
-        auto generate_replica_token() -> key_type
+        //
+        // The first byte of the UUID holds the shard index. The caller must hold the lock
+        // on the shard.
+        auto generate_replica_token(const shard& _shard, std::size_t _shard_index) -> key_type
         {
+            const auto make_uuid = [_shard_index] {
+                auto uuid = boost::uuids::random_generator{}();
+                uuid.data[0] = static_cast<std::uint8_t>(_shard_index);
+                return to_string(uuid);
+            };
+
             key_type uuid{*g_allocator};
             uuid.reserve(36);
-            uuid = to_string(boost::uuids::random_generator{}()).data();
+            uuid = make_uuid().data();
 
-            while (g_fd_info_map->find(uuid) != g_fd_info_map->end()) {
-                uuid = to_string(boost::uuids::random_generator{}()).data();
+            while (_shard.entries.find(uuid) != _shard.entries.end()) {
+                uuid = make_uuid().data();
             }
 
             return uuid;
         }
+
+        auto is_process_alive(pid_t _pid) noexcept -> bool
+        {
+            return kill(_pid, 0) == 0 || errno != ESRCH;
+        }
+
+        // Removes the PIDs of dead processes from an entry and returns the number of
+        // PIDs removed. The caller must hold the lock on the shard.
+        auto remove_dead_pids(access_entry& _entry) -> std::size_t
+        {
+            auto& pids = _entry.agent_pids;
+            const auto size = pids.size();
+
+            pids.erase(std::remove_if(std::begin(pids), std::end(pids), [](pid_t _pid) { return !is_process_alive(_pid); }),
+                       std::end(pids));
+
+            return size - pids.size();
+        }
+
+        // Invokes "_func", which must lock the shards it needs. If the shared memory
+        // segment is exhausted, entries belonging to dead processes are evicted and
+        // "_func" is invoked one more time.
+        template <typename Function>
+        auto retry_on_bad_alloc(Function _func) -> decltype(_func())
+        {
+            try {
+                return _func();
+            }
+            catch (const bi::bad_alloc&) {
+                // No shard lock is held at this point. Holding one while evicting would
+                // risk a deadlock with another process doing the same.
+                if (replica_access_table::instance().erase_dead_pids() == 0) {
+                    throw replica_access_table_error{"replica_access_table: Out of memory"};
+                }
+            }
+
+            try {
+                return _func();
+            }
+            catch (const bi::bad_alloc&) {
+                throw replica_access_table_error{"replica_access_table: Out of memory"};
+            }
+        }
     } // anonymous namespace
 
-    auto replica_access_table::init() noexcept -> void
+    auto replica_access_table::init(std::size_t _segment_size) noexcept -> void
     {
         if (g_initialized) {
             return;
@@ -102,21 +239,18 @@ namespace irods::experimental
 
         g_initialized = true;
 
-        bi::named_mutex::remove(g_mutex_name);
         bi::shared_memory_object::remove(g_segment_name);
 
         g_owner_pid = getpid();
-        g_segment = std::make_unique<bi::managed_shared_memory>(bi::create_only, g_segment_name, g_segment_size);
+        g_segment = std::make_unique<bi::managed_shared_memory>(bi::create_only, g_segment_name, _segment_size);
         g_allocator = std::make_unique<void_allocator_type>(g_segment->get_segment_manager());
-        g_mutex = std::make_unique<bi::named_mutex>(bi::create_only, g_mutex_name);
-        g_fd_info_map = g_segment->construct<map_type>("fd_info_map")(std::less<key_type>{}, *g_allocator);
+        g_shards = g_segment->construct<shard>("shards")[g_shard_count](*g_allocator);
     }
 
     auto replica_access_table::deinit() noexcept -> void
     {
         // Only allow the process that called init() to remove the shared memory.
         if (g_initialized && getpid() == g_owner_pid) {
-            bi::named_mutex::remove(g_mutex_name);
             bi::shared_memory_object::remove(g_segment_name);
         }
     }
@@ -131,23 +265,28 @@ namespace irods::experimental
                                                 replica_number_type _replica_number,
                                                 pid_t _pid) -> replica_token_type
     {
-        bi::scoped_lock lk{*g_mutex};
+        return retry_on_bad_alloc([_data_id, _replica_number, _pid] {
+            const auto index = shard_index(_data_id, _replica_number);
+            auto& shard = g_shards[index];
 
-        const auto end = g_fd_info_map->end();
-        const auto exists = [_data_id, _replica_number](const value_type& v)
-        {
-            return v.second.data_id == _data_id && v.second.replica_number == _replica_number;
-        };
+            bi::scoped_lock lk{shard.mutex};
 
-        if (auto iter = std::find_if(g_fd_info_map->begin(), end, exists); iter != end) {
-            throw replica_access_table_error{"replica_access_table: Entry already exists"};
-        }
+            const auto end = shard.entries.end();
+            const auto exists = [_data_id, _replica_number](const value_type& v)
+            {
+                return v.second.data_id == _data_id && v.second.replica_number == _replica_number;
+            };
 
-        auto uuid = generate_replica_token();
-        mapped_type v{_data_id, _replica_number, access_entry::container_type{{_pid}, *g_allocator}};
-        g_fd_info_map->insert(value_type{uuid, v});
+            if (auto iter = std::find_if(shard.entries.begin(), end, exists); iter != end) {
+                throw replica_access_table_error{"replica_access_table: Entry already exists"};
+            }
+
+            auto uuid = generate_replica_token(shard, index);
+            mapped_type v{_data_id, _replica_number, access_entry::container_type{{_pid}, *g_allocator}};
+            shard.entries.insert(value_type{uuid, v});
 
-        return uuid.data();
+            return replica_token_type{uuid.data()};
+        });
     }
 
     auto replica_access_table::append_pid(replica_token_view_type _token,
@@ -155,29 +294,34 @@ namespace irods::experimental
                                           replica_number_type _replica_number,
                                           pid_t _pid) -> void
     {
-        bi::scoped_lock lk{*g_mutex};
+        retry_on_bad_alloc([_token, _data_id, _replica_number, _pid] {
+            auto& shard = g_shards[shard_index(_data_id, _replica_number)];
 
-        const key_type key{_token.data(), *g_allocator};
-        auto iter = g_fd_info_map->find(key);
-        
-        if (iter == g_fd_info_map->end()) {
-            throw replica_access_table_error{"replica_access_table: Invalid token"};
-        }
+            bi::scoped_lock lk{shard.mutex};
 
-        auto& [k, v] = *iter;
-        
-        if (v.data_id != _data_id || v.replica_number != _replica_number) {
-            throw replica_access_table_error{"replica_access_table: Invalid data id or replica number"};
-        }
+            auto iter = shard.entries.find(_token);
+
+            if (iter == shard.entries.end()) {
+                throw replica_access_table_error{"replica_access_table: Invalid token"};
+            }
 
-        v.agent_pids.push_back(_pid);
+            auto& [k, v] = *iter;
+
+            if (v.data_id != _data_id || v.replica_number != _replica_number) {
+                throw replica_access_table_error{"replica_access_table: Invalid data id or replica number"};
+            }
+
+            v.agent_pids.push_back(_pid);
+        });
     }
 
     auto replica_access_table::contains(data_id_type _data_id, replica_number_type _replica_number) -> bool
     {
-        bi::scoped_lock lk{*g_mutex};
+        auto& shard = g_shards[shard_index(_data_id, _replica_number)];
+
+        bi::scoped_lock lk{shard.mutex};
 
-        for (auto&& [k, v] : *g_fd_info_map) {
+        for (auto&& [k, v] : shard.entries) {
             if (v.data_id == _data_id && v.replica_number == _replica_number) {
                 return true;
             }
@@ -190,11 +334,15 @@ namespace irods::experimental
                                         data_id_type _data_id,
                                         replica_number_type _replica_number) -> bool
     {
-        bi::scoped_lock lk{*g_mutex};
+        auto* shard = get_shard(_token);
 
-        const key_type key{_token.data(), *g_allocator};
+        if (!shard) {
+            return false;
+        }
+
+        bi::scoped_lock lk{shard->mutex};
 
-        if (const auto iter = g_fd_info_map->find(key); iter != g_fd_info_map->end()) {
+        if (const auto iter = shard->entries.find(_token); iter != shard->entries.end()) {
             return iter->second.data_id == _data_id &&
                    iter->second.replica_number == _replica_number;
         }
@@ -205,11 +353,15 @@ namespace irods::experimental
     auto replica_access_table::erase_pid(replica_token_view_type _token, pid_t _pid)
         -> std::optional<restorable_entry_type>
     {
-        bi::scoped_lock lk{*g_mutex};
+        auto* shard = get_shard(_token);
 
-        const key_type key{_token.data(), *g_allocator};
+        if (!shard) {
+            return std::nullopt;
+        }
 
-        if (const auto iter = g_fd_info_map->find(key); iter != g_fd_info_map->end()) {
+        bi::scoped_lock lk{shard->mutex};
+
+        if (const auto iter = shard->entries.find(_token); iter != shard->entries.end()) {
             auto& pids = iter->second.agent_pids;
 
             if (const auto pos = std::find(pids.begin(), pids.end(), _pid); pos != pids.end()) {
@@ -218,7 +370,7 @@ namespace irods::experimental
                 pids.erase(pos);
 
                 if (pids.empty()) {
-                    g_fd_info_map->erase(iter);
+                    shard->entries.erase(iter);
                 }
 
                 return entry;
@@ -230,47 +382,76 @@ namespace irods::experimental
 
     auto replica_access_table::erase_pid(pid_t _pid) -> void
     {
-        bi::scoped_lock lk{*g_mutex};
+        for (std::size_t i = 0; i < g_shard_count; ++i) {
+            auto& shard = g_shards[i];
 
-        std::vector<const key_type*> keys_to_remove;
+            bi::scoped_lock lk{shard.mutex};
 
-        for (auto&& [k, v] : *g_fd_info_map) {
-            auto end = std::end(v.agent_pids);
-            v.agent_pids.erase(std::remove(std::begin(v.agent_pids), end, _pid), end);
+            for (auto iter = shard.entries.begin(); iter != shard.entries.end();) {
+                auto& pids = iter->second.agent_pids;
+                pids.erase(std::remove(std::begin(pids), std::end(pids), _pid), std::end(pids));
 
-            // Remember which entries have an empty PID list.
-            if (v.agent_pids.empty()) {
-                keys_to_remove.push_back(&k);
+                if (pids.empty()) {
+                    iter = shard.entries.erase(iter);
+                }
+                else {
+                    ++iter;
+                }
             }
         }
+    }
+
+    auto replica_access_table::erase_dead_pids() -> std::size_t
+    {
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < g_shard_count; ++i) {
+            auto& shard = g_shards[i];
 
-        for (auto&& k : keys_to_remove) {
-            g_fd_info_map->erase(*k);
+            bi::scoped_lock lk{shard.mutex};
+
+            for (auto iter = shard.entries.begin(); iter != shard.entries.end();) {
+                count += remove_dead_pids(iter->second);
+
+                if (iter->second.agent_pids.empty()) {
+                    iter = shard.entries.erase(iter);
+                }
+                else {
+                    ++iter;
+                }
+            }
         }
+
+        return count;
     }
 
     auto replica_access_table::restore(const restorable_entry_type& _entry) -> void
     {
-        bi::scoped_lock lk{*g_mutex};
+        retry_on_bad_alloc([&_entry] {
+            auto* shard = get_shard(_entry.token);
 
-        const key_type key{_entry.token.data(), *g_allocator};
+            if (!shard) {
+                throw replica_access_table_error{"replica_access_table: Invalid token"};
+            }
 
-        if (auto iter = g_fd_info_map->find(key); iter != g_fd_info_map->end()) {
-            auto& [k, v] = *iter;
+            bi::scoped_lock lk{shard->mutex};
 
-            if (v.data_id != _entry.data_id || v.replica_number != _entry.replica_number) {
-                throw replica_access_table_error{"replica_access_table: Invalid data id or replica number"};
-            }
+            if (auto iter = shard->entries.find(replica_token_view_type{_entry.token}); iter != shard->entries.end()) {
+                auto& [k, v] = *iter;
 
-            v.agent_pids.push_back(_entry.pid);
-        }
-        else {
-            mapped_type value{_entry.data_id,
-                              _entry.replica_number,
-                              access_entry::container_type{{_entry.pid}, *g_allocator}};
+                if (v.data_id != _entry.data_id || v.replica_number != _entry.replica_number) {
+                    throw replica_access_table_error{"replica_access_table: Invalid data id or replica number"};
+                }
 
-            g_fd_info_map->insert(value_type{key, value});
-        }
+                v.agent_pids.push_back(_entry.pid);
+            }
+            else {
+                mapped_type value{_entry.data_id,
+                                  _entry.replica_number,
+                                  access_entry::container_type{{_entry.pid}, *g_allocator}};
+
+                shard->entries.insert(value_type{key_type{_entry.token.data(), *g_allocator}, value});
+            }
+        });
     }
 } // namespace irods::experimental
-
@@ -27,6 +27,7 @@
 #include "procLog.h"
 #include "initServer.hpp"
 #include "replica_access_table.hpp"
+#include "irods_tracing.hpp"
 
 #include "sockCommNetworkInterface.hpp"
 #include "sslSockComm.h"
@@ -38,6 +39,7 @@
 #include "sys/wait.h"
 
 #include <memory>
+#include <system_error>
 
 namespace ix = irods::experimental;
 
@@ -182,6 +184,62 @@ int receiveDataFromServer( int conn_tmp_socket ) {
     return status;
 }
 
+// Enables tracing if a trace file is configured. The agents inherit the configuration.
+static void init_tracing()
+{
+    namespace tracing = irods::experimental::tracing;
+    using log = irods::experimental::log;
+
+    try {
+        const auto& file = irods::get_advanced_setting<const std::string>(irods::CFG_TRACE_FILE_PATH);
+
+        if (file.empty()) {
+            return;
+        }
+
+        tracing::config config{file};
+
+        try {
+            double ratio{};
+
+            // The configuration holds 0 and 1 as integers.
+            try {
+                ratio = irods::get_advanced_setting<const double>(irods::CFG_TRACE_SAMPLING_RATIO);
+            }
+            catch (const irods::exception& e) {
+                if (e.code() != INVALID_ANY_CAST) {
+                    throw;
+                }
+
+                ratio = irods::get_advanced_setting<const int>(irods::CFG_TRACE_SAMPLING_RATIO);
+            }
+
+            if (ratio >= 0.0 && ratio <= 1.0) {
+                config.sampling_ratio = ratio;
+            }
+            else {
+                log::agent_factory::error("Invalid value for advanced setting [{}]. Must be between 0 and 1. "
+                                          "Recording every trace [value={}].",
+                                          irods::CFG_TRACE_SAMPLING_RATIO, ratio);
+            }
+        }
+        catch (const irods::exception&) {
+            // Every trace is recorded by default.
+        }
+
+        tracing::init(config);
+
+        log::agent_factory::info("Recording trace spans in [{}] (sampling ratio = {}).", file, config.sampling_ratio);
+    }
+    catch (const irods::exception&) {
+        // The setting is optional.
+    }
+    catch (const std::system_error& e) {
+        log::agent_factory::error({{"log_message", "Cannot enable tracing."},
+                                   {"error", e.what()}});
+    }
+}
+
 void
 irodsAgentSignalExit( int ) {
     int reaped_pid, child_status;
@@ -212,6 +270,8 @@ runIrodsAgentFactory( sockaddr_un agent_addr ) {
 
     log::agent_factory::info("Initializing agent factory ...");
 
+    init_tracing();
+
     signal( SIGINT, irodsAgentSignalExit );
     signal( SIGHUP, irodsAgentSignalExit );
     signal( SIGTERM, irodsAgentSignalExit );
@@ -559,6 +619,8 @@ runIrodsAgentFactory( sockaddr_un agent_addr ) {
     new_net_obj->to_server( &rsComm );
     status = agentMain( &rsComm );
 
+    irods::experimental::tracing::flush();
+
     // call initialization for network plugin as negotiated
     ret = sockAgentStop( new_net_obj );
     if ( !ret.ok() ) {
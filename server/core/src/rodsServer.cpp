@@ -20,6 +20,9 @@
 #include "sockCommNetworkInterface.hpp"
 #include "irods_random.hpp"
 #include "replica_access_table.hpp"
+#include "api_metrics.hpp"
+#include "cache_eviction.hpp"
+#include "catalog_commit_queue.hpp"
 #include "irods_logger.hpp"
 
 #include <pthread.h>
@@ -148,8 +151,8 @@ namespace
 
     void init_logger(bool _write_to_stdout = false, bool _enable_test_mode = false)
     {
-        ix::log::init(_write_to_stdout, _enable_test_mode);
         irods::server_properties::instance().capture();
+        ix::log::init(_write_to_stdout, _enable_test_mode, ix::log::get_sink_config_from_config());
         ix::log::server::set_level(ix::log::get_level_from_config(irods::CFG_LOG_LEVEL_CATEGORY_SERVER_KW));
         ix::log::set_server_type("server");
 
@@ -256,9 +259,54 @@ main( int argc, char **argv )
 
     ix::log::server::info("Initializing server ...");
 
-    irods::experimental::replica_access_table::init();
+    const auto replica_access_table_size = []() -> std::size_t {
+        // The table is mapped before any agent is forked, so an unreasonable size
+        // would keep the server from starting.
+        constexpr int max_size_in_megabytes = 1024;
+
+        try {
+            const auto size_in_megabytes = irods::get_advanced_setting<const int>(irods::CFG_REPLICA_ACCESS_TABLE_SIZE);
+
+            if (size_in_megabytes <= 0) {
+                ix::log::server::error("Invalid value for advanced setting [{}]. Using default of {} bytes [value={}].",
+                                       irods::CFG_REPLICA_ACCESS_TABLE_SIZE,
+                                       ix::replica_access_table::default_segment_size,
+                                       size_in_megabytes);
+                return ix::replica_access_table::default_segment_size;
+            }
+
+            if (size_in_megabytes > max_size_in_megabytes) {
+                ix::log::server::warn("Advanced setting [{}] exceeds the maximum. Using {} megabytes [value={}].",
+                                      irods::CFG_REPLICA_ACCESS_TABLE_SIZE,
+                                      max_size_in_megabytes,
+                                      size_in_megabytes);
+                return max_size_in_megabytes * std::size_t{1024 * 1024};
+            }
+
+            return size_in_megabytes * std::size_t{1024 * 1024};
+        }
+        catch (const irods::exception&) {
+            return ix::replica_access_table::default_segment_size;
+        }
+    }();
+
+    irods::experimental::replica_access_table::init(replica_access_table_size);
     irods::at_scope_exit deinit_fd_table{[] { irods::experimental::replica_access_table::deinit(); }};
 
+    // Must be created before any agent is forked so that every agent shares the counters.
+    irods::experimental::api_metrics::init();
+    irods::at_scope_exit deinit_api_metrics{[] { irods::experimental::api_metrics::deinit(); }};
+
+    // Must be called before any agent is forked so that the agents can tell the
+    // evictions of this run from those of an earlier one.
+    irods::experimental::cache_eviction::init_access_logs();
+    irods::at_scope_exit deinit_access_logs{[] { irods::experimental::cache_eviction::deinit_access_logs(); }};
+
+    // Must be created before any agent is forked so that the agents commit replica
+    // closes together.
+    irods::experimental::catalog::init_replica_update_queue();
+    irods::at_scope_exit deinit_replica_update_queue{[] { irods::experimental::catalog::deinit_replica_update_queue(); }};
+
     /* start of irodsReServer has been moved to serverMain */
     signal( SIGTTIN, SIG_IGN );
     signal( SIGTTOU, SIG_IGN );
@@ -439,6 +487,23 @@ int serverMain(
         irods::server_control_plane ctrl_plane(
             irods::CFG_SERVER_CONTROL_PLANE_PORT );
 
+        // The Prometheus endpoint is disabled unless a port is configured.
+        std::unique_ptr<irods::experimental::api_metrics::prometheus_endpoint> metrics_endpoint;
+
+        try {
+            if (const auto port = irods::get_advanced_setting<const int>(irods::CFG_PROMETHEUS_METRICS_PORT); port > 0) {
+                metrics_endpoint = std::make_unique<irods::experimental::api_metrics::prometheus_endpoint>(port);
+                ix::log::server::info("Serving API metrics for Prometheus on port [{}].", port);
+            }
+        }
+        catch (const irods::exception&) {
+            // The setting is optional.
+        }
+        catch (const std::system_error& e) {
+            ix::log::server::error({{"log_message", "Cannot start the Prometheus metrics endpoint."},
+                                    {"error", e.what()}});
+        }
+
         status = startProcConnReqThreads();
         if(status < 0) {
             rodsLog(LOG_ERROR, "[%s] - Error in startProcConnReqThreads()", __FUNCTION__);
@@ -30,6 +30,9 @@ jmp_buf Jenv;
 #include "irods_hierarchy_parser.hpp"
 #include "irods_api_number_validator.hpp"
 #include "irods_logger.hpp"
+#include "api_metrics.hpp"
+#include "irods_tracing.hpp"
+#include "apiNumberMap.h"
 
 #define MAKE_IRODS_ERROR_MAP
 #include "rodsErrorTable.h"
@@ -37,6 +40,8 @@ jmp_buf Jenv;
 
 #include <iterator>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 
 namespace ix = irods::experimental;
 
@@ -54,10 +59,11 @@ namespace
     }
 } // anonymous namespace
 
-int rsApiHandler(rsComm_t*   rsComm,
-                 int         apiNumber,
-                 bytesBuf_t* inputStructBBuf,
-                 bytesBuf_t* bsBBuf)
+static int handle_api_request(rsComm_t*      rsComm,
+                              int            apiNumber,
+                              bytesBuf_t*    inputStructBBuf,
+                              bytesBuf_t*    bsBBuf,
+                              std::uint64_t& bytesSent)
 {
     using log = ix::log;
 
@@ -229,6 +235,10 @@ int rsApiHandler(rsComm_t*   rsComm,
                      myArgv[3]);
     }
 
+    if ( myOutBsBBuf.len > 0 ) {
+        bytesSent = myOutBsBBuf.len;
+    }
+
     if ( retVal != SYS_NO_HANDLER_REPLY_MSG ) {
         status = sendAndProcApiReply
                  ( rsComm, apiInx, retVal, myOutStruct, &myOutBsBBuf );
@@ -253,6 +263,43 @@ int rsApiHandler(rsComm_t*   rsComm,
     }
 }
 
+int rsApiHandler(rsComm_t*   rsComm,
+                 int         apiNumber,
+                 bytesBuf_t* inputStructBBuf,
+                 bytesBuf_t* bsBBuf)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t bytes_sent = 0;
+
+    ix::tracing::span span{"api", ix::tracing::span_kind::server};
+
+    if (span.recording()) {
+        if (const auto iter = irods::api_number_names.find(apiNumber); iter != std::end(irods::api_number_names)) {
+            span.set_name(iter->second);
+        }
+
+        span.set_attribute("irods.api_number", apiNumber);
+        span.set_attribute("irods.client_user", rsComm->clientUser.userName);
+        span.set_attribute("irods.proxy_user", rsComm->proxyUser.userName);
+        span.set_attribute("net.peer.ip", rsComm->clientAddr);
+    }
+
+    const int status = handle_api_request(rsComm, apiNumber, inputStructBBuf, bsBBuf, bytes_sent);
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    const std::uint64_t bytes_received = std::max(0, inputStructBBuf->len) + std::max(0, bsBBuf->len);
+
+    // SYS_NO_HANDLER_REPLY_MSG means the handler sent the reply itself.
+    ix::api_metrics::record(apiNumber, elapsed, SYS_NO_HANDLER_REPLY_MSG == status ? 0 : status, bytes_received, bytes_sent);
+
+    if (status < 0 && SYS_NO_HANDLER_REPLY_MSG != status) {
+        span.set_attribute("irods.error_code", status);
+        span.set_error(rodsErrorName(status, nullptr));
+    }
+
+    return status;
+}
+
 int
 sendAndProcApiReply( rsComm_t * rsComm, int apiInx, int status,
                      void * myOutStruct, bytesBuf_t * myOutBsBBuf ) {
@@ -486,6 +533,14 @@ handlePortalOpr( rsComm_t * rsComm ) {
 
     oprType = rsComm->portalOpr->oprType;
 
+    ix::tracing::span span{PUT_OPR == oprType ? "portal put" : "portal get"};
+
+    if ( span.recording() ) {
+        const auto& dataOprInp = rsComm->portalOpr->dataOprInp;
+        span.set_attribute( "irods.data_size", dataOprInp.dataSize );
+        span.set_attribute( "irods.threads", dataOprInp.numThreads );
+    }
+
     switch ( oprType ) {
     case PUT_OPR:
     case GET_OPR:
@@ -500,6 +555,11 @@ handlePortalOpr( rsComm_t * rsComm ) {
         status = SYS_INVALID_PORTAL_OPR;
         break;
     }
+
+    if ( status < 0 ) {
+        span.set_error( rodsErrorName( status, nullptr ) );
+    }
+
     return status;
 }
 
@@ -0,0 +1,347 @@
+#include "stage_queue.hpp"
+
+#include "dataObjClose.h"
+#include "dataObjOpen.h"
+#include "irods_at_scope_exit.hpp"
+#include "irods_exception.hpp"
+#include "irods_logger.hpp"
+#include "rcConnect.h"
+#include "rcMisc.h"
+#include "rodsConnect.h"
+#include "rodsErrorTable.h"
+#include "rsGlobalExtern.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    using log = irods::experimental::log;
+
+    // The number of stages each agent runs concurrently.
+    constexpr int default_stage_workers = 4;
+} // anonymous namespace
+
+namespace irods
+{
+    auto make_stage_request(const RsComm& _comm,
+                            const std::string& _logical_path,
+                            const std::string& _resource) -> stage_request
+    {
+        // The stage must run on this server, which the host of the agent's environment
+        // need not be.
+        return {_logical_path,
+                _resource,
+                LocalServerHost->hostName->name,
+                static_cast<zoneInfo_t*>(LocalServerHost->zoneInfo)->portNum,
+                _comm.myEnv.rodsUserName,
+                getLocalZoneName(),
+                _comm.clientUser.userName,
+                _comm.clientUser.rodsZone};
+    } // make_stage_request
+
+    auto stage_through_local_agent(const stage_request& _request) -> int
+    {
+        rErrMsg_t err_msg{};
+        rcComm_t* conn = _rcConnect(_request.host.c_str(), _request.port,
+                                    _request.proxy_user_name.c_str(), _request.proxy_zone.c_str(),
+                                    _request.client_user_name.c_str(), _request.client_zone.c_str(),
+                                    &err_msg, 0, NO_RECONN);
+        if (!conn) {
+            log::server::error("Cannot connect to [{}] to stage [{}] [error_code={}]",
+                               _request.host, _request.logical_path, err_msg.status);
+            return err_msg.status < 0 ? err_msg.status : USER_SOCK_CONNECT_ERR;
+        }
+
+        irods::at_scope_exit disconnect{[conn] { rcDisconnect(conn); }};
+
+        // Lets the queue interrupt the stage if the agent exits while it is running.
+        stage_queue::set_interrupt([sock = conn->sock] { shutdown(sock, SHUT_RDWR); });
+        irods::at_scope_exit clear_interrupt{[] { stage_queue::set_interrupt(nullptr); }};
+
+        if (const int ec = clientLogin(conn); ec < 0) {
+            log::server::error("Cannot log in to [{}] to stage [{}] [error_code={}]",
+                               _request.host, _request.logical_path, ec);
+            return ec;
+        }
+
+        // Opening the data object through the compound resource stages it to the cache.
+        dataObjInp_t open_inp{};
+        rstrcpy(open_inp.objPath, _request.logical_path.c_str(), MAX_NAME_LEN);
+        open_inp.openFlags = O_RDONLY;
+        addKeyVal(&open_inp.condInput, RESC_NAME_KW, _request.resource.c_str());
+        addKeyVal(&open_inp.condInput, STAGE_INLINE_KW, "");
+
+        const int fd = rcDataObjOpen(conn, &open_inp);
+        clearKeyVal(&open_inp.condInput);
+
+        if (fd < 0) {
+            log::server::error("Cannot stage [{}] to the cache of [{}] [error_code={}]",
+                               _request.logical_path, _request.resource, fd);
+            return fd;
+        }
+
+        openedDataObjInp_t close_inp{};
+        close_inp.l1descInx = fd;
+
+        const int ec = rcDataObjClose(conn, &close_inp);
+
+        return ec < 0 ? ec : 0;
+    } // stage_through_local_agent
+
+    stage_queue::state::state(std::size_t _max_workers, stage_function _stage)
+        : max_workers{_max_workers}
+        , stage{std::move(_stage)}
+        , mutex{}
+        , cv{}
+        , stopping{false}
+        , next_sequence{0}
+        , entries{}
+        , queue{}
+        , running{0}
+        , workers{0}
+        , threads{}
+        , interrupts{}
+    {
+    } // state
+
+    thread_local stage_queue::state* stage_queue::worker_state_ = nullptr;
+
+    stage_queue::stage_queue(int _workers, stage_function _stage, std::chrono::milliseconds _grace_period)
+        : state_{std::make_shared<state>(static_cast<std::size_t>(std::max(_workers, 1)), std::move(_stage))}
+        , grace_period_{_grace_period}
+    {
+    } // stage_queue
+
+    stage_queue::~stage_queue()
+    {
+        auto& s = *state_;
+        std::vector<std::thread> threads;
+
+        {
+            std::unique_lock lock{s.mutex};
+            s.stopping = true;
+
+            // Prefetches are speculative, so they do not hold up the exit of the agent.
+            for (auto&& e : s.queue) {
+                s.entries.erase(e->key);
+                e->promise.set_value(SYS_THREAD_ENCOUNTERED_INTERRUPT);
+            }
+
+            s.queue.clear();
+            s.cv.notify_all();
+
+            if (!s.cv.wait_for(lock, grace_period_, [&s] { return 0 == s.workers; })) {
+                log::server::info("Interrupting {} running stage(s).", s.interrupts.size());
+
+                for (auto&& [id, interrupt] : s.interrupts) {
+                    interrupt();
+                }
+            }
+
+            threads = std::move(s.threads);
+        }
+
+        // The workers must not outlive the agent's logger and other statics.
+        for (auto&& t : threads) {
+            t.join();
+        }
+    } // ~stage_queue
+
+    auto stage_queue::set_interrupt(std::function<void()> _interrupt) -> void
+    {
+        if (!worker_state_) {
+            return;
+        }
+
+        auto& s = *worker_state_;
+        std::lock_guard lock{s.mutex};
+
+        if (_interrupt) {
+            s.interrupts.insert_or_assign(std::this_thread::get_id(), std::move(_interrupt));
+        }
+        else {
+            s.interrupts.erase(std::this_thread::get_id());
+        }
+    } // set_interrupt
+
+    auto stage_queue::submit(const stage_request& _request, int _priority) -> std::shared_future<int>
+    {
+        // Resource names cannot contain a slash, so the key is unique.
+        auto key = _request.resource + _request.logical_path;
+
+        auto& s = *state_;
+        std::lock_guard lock{s.mutex};
+
+        if (auto iter = s.entries.find(key); iter != std::end(s.entries)) {
+            auto& e = iter->second;
+
+            // A stage which has not started is moved ahead of the stages it now outranks.
+            if (_priority > e->priority) {
+                if (auto queued = s.queue.find(e); queued != std::end(s.queue)) {
+                    s.queue.erase(queued);
+                    e->priority = _priority;
+                    s.queue.insert(e);
+                }
+            }
+
+            return e->status;
+        }
+
+        auto e = std::make_shared<entry>();
+        e->key = key;
+        e->request = _request;
+        e->priority = _priority;
+        e->sequence = s.next_sequence++;
+        e->status = e->promise.get_future().share();
+
+        s.entries.emplace(std::move(key), e);
+        s.queue.insert(e);
+
+        if (s.workers < s.max_workers && s.workers < s.queue.size() + s.running) {
+            s.threads.emplace_back(work, state_);
+            ++s.workers;
+        }
+
+        s.cv.notify_one();
+
+        return e->status;
+    } // submit
+
+    auto stage_queue::run(const stage_request& _request, const std::function<int()>& _stage) -> int
+    {
+        auto key = _request.resource + _request.logical_path;
+
+        auto& s = *state_;
+        std::shared_ptr<entry> e;
+
+        {
+            std::unique_lock lock{s.mutex};
+
+            if (auto iter = s.entries.find(key); iter != std::end(s.entries)) {
+                e = iter->second;
+
+                auto queued = s.queue.find(e);
+                if (queued == std::end(s.queue)) {
+                    auto status = e->status;
+                    lock.unlock();
+                    return status.get();
+                }
+
+                s.queue.erase(queued);
+            }
+            else {
+                // Registered so that prefetches of the data object coalesce with this stage.
+                e = std::make_shared<entry>();
+                e->key = key;
+                e->request = _request;
+                e->priority = stage_priority_open;
+                e->sequence = s.next_sequence++;
+                e->status = e->promise.get_future().share();
+
+                s.entries.emplace(std::move(key), e);
+            }
+
+            ++s.running;
+        }
+
+        int status{};
+
+        try {
+            status = _stage();
+        }
+        catch (const irods::exception& ex) {
+            status = ex.code();
+        }
+        catch (const std::exception&) {
+            status = SYS_INTERNAL_ERR;
+        }
+
+        std::lock_guard lock{s.mutex};
+
+        --s.running;
+        s.entries.erase(e->key);
+        e->promise.set_value(status);
+
+        return status;
+    } // run
+
+    auto stage_queue::queued() const -> std::size_t
+    {
+        std::lock_guard lock{state_->mutex};
+        return state_->queue.size();
+    } // queued
+
+    auto stage_queue::running() const -> std::size_t
+    {
+        std::lock_guard lock{state_->mutex};
+        return state_->running;
+    } // running
+
+    auto stage_queue::work(std::shared_ptr<state> _state) -> void
+    {
+        auto& s = *_state;
+        worker_state_ = &s;
+
+        std::unique_lock lock{s.mutex};
+
+        while (true) {
+            s.cv.wait(lock, [&s] { return s.stopping || !s.queue.empty(); });
+
+            // Stages which have not started are discarded by the destructor.
+            if (s.queue.empty()) {
+                --s.workers;
+                s.cv.notify_all();
+                return;
+            }
+
+            auto e = *std::begin(s.queue);
+            s.queue.erase(std::begin(s.queue));
+            ++s.running;
+
+            lock.unlock();
+
+            int status{};
+
+            try {
+                status = s.stage(e->request);
+            }
+            catch (const irods::exception& ex) {
+                status = ex.code();
+            }
+            catch (const std::exception&) {
+                status = SYS_INTERNAL_ERR;
+            }
+
+            lock.lock();
+
+            s.interrupts.erase(std::this_thread::get_id());
+
+            // Later requests for the data object start a new stage.
+            --s.running;
+            s.entries.erase(e->key);
+            e->promise.set_value(status);
+        }
+    } // work
+
+    auto get_stage_queue() -> stage_queue&
+    {
+        static pid_t owner = -1;
+        static std::unique_ptr<stage_queue> queue;
+
+        if (!queue || owner != getpid()) {
+            // The workers of an inherited queue do not exist in this process, so it
+            // cannot be destroyed (joining them would fail).
+            [[maybe_unused]] auto* inherited = queue.release();
+
+            queue = std::make_unique<stage_queue>(default_stage_workers, stage_through_local_agent);
+            owner = getpid();
+        }
+
+        return *queue;
+    } // get_stage_queue
+} // namespace irods
@@ -0,0 +1,520 @@
+#include "tar_member_index.hpp"
+
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace irods::experimental::tar
+{
+    namespace
+    {
+        constexpr std::int64_t block_size = 512;
+
+        // Headers are read in chunks of this size, so that the headers of small members
+        // which follow each other are read at once.
+        constexpr std::int64_t read_ahead_size = 64 * 1024;
+
+        // Identifies the serialized form of an index.
+        constexpr std::string_view index_magic = "irods_tar_member_index";
+        constexpr int index_version = 1;
+
+        // Offsets and lengths of the fields of a tar header.
+        // clang-format off
+        constexpr std::size_t name_offset     = 0;   constexpr std::size_t name_length     = 100;
+        constexpr std::size_t mode_offset     = 100; constexpr std::size_t mode_length     = 8;
+        constexpr std::size_t size_offset     = 124; constexpr std::size_t size_length     = 12;
+        constexpr std::size_t mtime_offset    = 136; constexpr std::size_t mtime_length    = 12;
+        constexpr std::size_t checksum_offset = 148; constexpr std::size_t checksum_length = 8;
+        constexpr std::size_t type_offset     = 156;
+        constexpr std::size_t magic_offset    = 257;
+        constexpr std::size_t prefix_offset   = 345; constexpr std::size_t prefix_length   = 155;
+        // clang-format on
+
+        using header = std::array<char, block_size>;
+
+        // Serves reads of the tar file from a buffer filled by larger reads.
+        class buffered_reader
+        {
+        public:
+            explicit buffered_reader(const read_function& _read)
+                : read_{_read}
+                , start_{0}
+                , buffer_{}
+            {
+            }
+
+            // Reads exactly _size bytes at _offset. Returns false if the file ends first.
+            auto read(std::int64_t _offset, char* _buffer, std::int64_t _size) -> bool
+            {
+                const auto end = start_ + static_cast<std::int64_t>(buffer_.size());
+
+                if (_offset < start_ || _offset + _size > end) {
+                    fill(_offset, std::max(_size, read_ahead_size));
+                }
+
+                const auto available = start_ + static_cast<std::int64_t>(buffer_.size()) - _offset;
+                if (available < _size) {
+                    return false;
+                }
+
+                std::memcpy(_buffer, buffer_.data() + (_offset - start_), _size);
+
+                return true;
+            }
+
+        private:
+            auto fill(std::int64_t _offset, std::int64_t _size) -> void
+            {
+                buffer_.resize(_size);
+
+                std::int64_t filled = 0;
+
+                while (filled < _size) {
+                    const auto n = read_(_offset + filled, buffer_.data() + filled, _size - filled);
+
+                    if (n < 0) {
+                        THROW(static_cast<int>(n), fmt::format("Cannot read the tar file at offset [{}].", _offset + filled));
+                    }
+
+                    if (n == 0) {
+                        break;
+                    }
+
+                    filled += n;
+                }
+
+                buffer_.resize(filled);
+                start_ = _offset;
+            }
+
+            const read_function& read_;
+            std::int64_t start_;
+            std::vector<char> buffer_;
+        }; // class buffered_reader
+
+        auto field(const header& _header, std::size_t _offset, std::size_t _length) -> std::string_view
+        {
+            const auto* first = _header.data() + _offset;
+            return {first, strnlen(first, _length)};
+        }
+
+        // Parses a numeric field, which is octal, or base-256 for values too large for
+        // octal (a GNU extension).
+        auto parse_number(const header& _header, std::size_t _offset, std::size_t _length) -> std::optional<std::int64_t>
+        {
+            const auto* first = reinterpret_cast<const unsigned char*>(_header.data() + _offset);
+            const auto* last = first + _length;
+
+            if (*first & 0x80) {
+                // Negative values are of no use for sizes and times.
+                if (*first & 0x40) {
+                    return std::nullopt;
+                }
+
+                std::uint64_t value = *first & 0x3f;
+
+                for (const auto* p = first + 1; p != last; ++p) {
+                    if (value > (std::numeric_limits<std::uint64_t>::max() >> 9)) {
+                        return std::nullopt;
+                    }
+
+                    value = (value << 8) | *p;
+                }
+
+                return static_cast<std::int64_t>(value);
+            }
+
+            while (first != last && (*first == ' ' || *first == '\0')) {
+                ++first;
+            }
+
+            std::int64_t value = 0;
+
+            for (; first != last && *first >= '0' && *first <= '7'; ++first) {
+                value = value * 8 + (*first - '0');
+            }
+
+            if (first != last && *first != ' ' && *first != '\0') {
+                return std::nullopt;
+            }
+
+            return value;
+        }
+
+        auto is_valid_header(const header& _header) -> bool
+        {
+            const auto expected = parse_number(_header, checksum_offset, checksum_length);
+            if (!expected) {
+                return false;
+            }
+
+            // The checksum is computed with the checksum field filled with spaces. Some
+            // old tar implementations treat the bytes as signed.
+            std::int64_t unsigned_sum = 0;
+            std::int64_t signed_sum = 0;
+
+            for (std::size_t i = 0; i < _header.size(); ++i) {
+                const bool in_checksum = i >= checksum_offset && i < checksum_offset + checksum_length;
+                const char c = in_checksum ? ' ' : _header[i];
+
+                unsigned_sum += static_cast<unsigned char>(c);
+                signed_sum += static_cast<signed char>(c);
+            }
+
+            return *expected == unsigned_sum || *expected == signed_sum;
+        }
+
+        auto is_zero_block(const header& _header) -> bool
+        {
+            return std::all_of(std::begin(_header), std::end(_header), [](char _c) { return _c == '\0'; });
+        }
+
+        auto round_up_to_block(std::int64_t _size) -> std::int64_t
+        {
+            return (_size + block_size - 1) / block_size * block_size;
+        }
+
+        auto normalize_name(std::string _name) -> std::string
+        {
+            std::string_view view = _name;
+
+            while (true) {
+                if (view.substr(0, 2) == "./") {
+                    view.remove_prefix(2);
+                }
+                else if (view.substr(0, 1) == "/") {
+                    view.remove_prefix(1);
+                }
+                else {
+                    break;
+                }
+            }
+
+            while (!view.empty() && view.back() == '/') {
+                view.remove_suffix(1);
+            }
+
+            return std::string{view};
+        }
+
+        struct extended_attributes
+        {
+            std::optional<std::string> path;
+            std::optional<std::int64_t> size;
+        };
+
+        // Parses the records of a pax extended header: "<length> <key>=<value>\n"
+        auto parse_pax_records(std::string_view _data) -> extended_attributes
+        {
+            extended_attributes attrs;
+
+            while (!_data.empty()) {
+                std::size_t length = 0;
+                const auto [ptr, ec] = std::from_chars(_data.data(), _data.data() + _data.size(), length);
+
+                if (ec != std::errc{} || length == 0 || length > _data.size()) {
+                    break;
+                }
+
+                auto record = _data.substr(0, length);
+                _data.remove_prefix(length);
+
+                record.remove_prefix(ptr - record.data());
+                if (record.empty() || record.front() != ' ' || record.back() != '\n') {
+                    continue;
+                }
+
+                record = record.substr(1, record.size() - 2);
+
+                const auto equals = record.find('=');
+                if (equals == std::string_view::npos) {
+                    continue;
+                }
+
+                const auto key = record.substr(0, equals);
+                const auto value = record.substr(equals + 1);
+
+                if (key == "path") {
+                    attrs.path = std::string{value};
+                }
+                else if (key == "size") {
+                    std::int64_t size = 0;
+                    if (std::from_chars(value.data(), value.data() + value.size(), size).ec == std::errc{} && size >= 0) {
+                        attrs.size = size;
+                    }
+                }
+            }
+
+            return attrs;
+        }
+
+        auto read_data(buffered_reader& _reader, std::int64_t _offset, std::int64_t _size) -> std::string
+        {
+            std::string data(_size, '\0');
+
+            if (!_reader.read(_offset, data.data(), _size)) {
+                THROW(SYS_TAR_STRUCT_FILE_EXTRACT_ERR, fmt::format("The tar file ends within the entry at offset [{}].", _offset));
+            }
+
+            return data;
+        }
+
+        // Reads one integer followed by _terminator from the front of _data.
+        template <typename T>
+        auto consume_number(std::string_view& _data, T& _value, char _terminator = ' ') -> bool
+        {
+            const auto [ptr, ec] = std::from_chars(_data.data(), _data.data() + _data.size(), _value);
+
+            if (ec != std::errc{} || ptr == _data.data() + _data.size() || *ptr != _terminator) {
+                return false;
+            }
+
+            _data.remove_prefix(ptr - _data.data() + 1);
+
+            return true;
+        }
+    } // anonymous namespace
+
+    auto member_index::build(const read_function& _read) -> std::optional<member_index>
+    {
+        buffered_reader reader{_read};
+        member_index index;
+
+        extended_attributes pending;
+        std::int64_t offset = 0;
+        header h{};
+
+        while (true) {
+            if (!reader.read(offset, h.data(), block_size)) {
+                // An empty or short file is not a tar file. A tar file which ends without
+                // the end-of-archive blocks is read up to its last member.
+                if (offset == 0) {
+                    return std::nullopt;
+                }
+
+                break;
+            }
+
+            if (is_zero_block(h)) {
+                break;
+            }
+
+            if (!is_valid_header(h)) {
+                // Compressed tar files and other formats are recognized by their first block.
+                if (offset == 0) {
+                    return std::nullopt;
+                }
+
+                THROW(SYS_TAR_STRUCT_FILE_EXTRACT_ERR, fmt::format("Invalid tar header at offset [{}].", offset));
+            }
+
+            const auto header_size = parse_number(h, size_offset, size_length);
+            if (!header_size || *header_size < 0) {
+                THROW(SYS_TAR_STRUCT_FILE_EXTRACT_ERR, fmt::format("Invalid size in the tar header at offset [{}].", offset));
+            }
+
+            const auto data_offset = offset + block_size;
+            auto type = h[type_offset];
+
+            // Type '\0' is a regular file in pre-POSIX archives, and type '7' (contiguous
+            // file) is read like a regular file.
+            if (type == '\0' || type == '7') {
+                type = '0';
+            }
+
+            switch (type) {
+                // GNU long name of the next member.
+                case 'L': {
+                    const auto data = read_data(reader, data_offset, *header_size);
+                    pending.path = std::string{data.c_str()};
+                    break;
+                }
+
+                // pax extended header of the next member.
+                case 'x': {
+                    auto attrs = parse_pax_records(read_data(reader, data_offset, *header_size));
+                    if (attrs.path) {
+                        pending.path = std::move(attrs.path);
+                    }
+                    if (attrs.size) {
+                        pending.size = attrs.size;
+                    }
+                    break;
+                }
+
+                // GNU long link name and pax global header. Neither is needed to read a
+                // member.
+                case 'K':
+                case 'g':
+                    break;
+
+                default: {
+                    std::string name;
+
+                    if (pending.path) {
+                        name = std::move(*pending.path);
+                    }
+                    else {
+                        const auto prefix = field(h, prefix_offset, prefix_length);
+                        const bool ustar = field(h, magic_offset, 5) == "ustar";
+
+                        name = (ustar && !prefix.empty())
+                            ? fmt::format("{}/{}", prefix, field(h, name_offset, name_length))
+                            : std::string{field(h, name_offset, name_length)};
+                    }
+
+                    const auto size = pending.size.value_or(*header_size);
+
+                    // Links, devices and sparse files are left out, since their data
+                    // cannot be read in place.
+                    if (type == '0' || type == '5') {
+                        index.members_.push_back({normalize_name(std::move(name)),
+                                                  data_offset,
+                                                  type == '0' ? size : 0,
+                                                  parse_number(h, mtime_offset, mtime_length).value_or(0),
+                                                  static_cast<std::uint32_t>(parse_number(h, mode_offset, mode_length).value_or(0)),
+                                                  type});
+                    }
+
+                    offset = data_offset + round_up_to_block(size);
+                    pending = {};
+                    continue;
+                }
+            }
+
+            offset = data_offset + round_up_to_block(*header_size);
+        }
+
+        index.index_names();
+
+        return index;
+    } // build
+
+    auto member_index::is_serialized(std::string_view _data) -> bool
+    {
+        return _data.size() > index_magic.size() &&
+               _data.substr(0, index_magic.size()) == index_magic &&
+               _data[index_magic.size()] == ' ';
+    } // is_serialized
+
+    auto member_index::deserialize(std::string_view _data,
+                                   std::int64_t _archive_size,
+                                   std::int64_t _archive_mtime) -> std::optional<member_index>
+    {
+        const auto line_end = _data.find('\n');
+        if (line_end == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        auto first_line = _data.substr(0, line_end + 1);
+        _data.remove_prefix(line_end + 1);
+
+        if (!is_serialized(first_line)) {
+            return std::nullopt;
+        }
+
+        first_line.remove_prefix(index_magic.size() + 1);
+
+        int version{};
+        std::int64_t archive_size{};
+        std::int64_t archive_mtime{};
+        std::size_t count{};
+
+        if (!consume_number(first_line, version) || version != index_version ||
+            !consume_number(first_line, archive_size) || archive_size != _archive_size ||
+            !consume_number(first_line, archive_mtime) || archive_mtime != _archive_mtime ||
+            !consume_number(first_line, count, '\n') || !first_line.empty())
+        {
+            return std::nullopt;
+        }
+
+        member_index index;
+        index.members_.reserve(std::min<std::size_t>(count, _data.size() / 8));
+
+        for (std::size_t i = 0; i < count; ++i) {
+            member m{};
+            std::size_t name_length{};
+
+            if (!consume_number(_data, m.offset) ||
+                !consume_number(_data, m.size) ||
+                !consume_number(_data, m.mtime) ||
+                !consume_number(_data, m.mode) ||
+                _data.size() < 2 || _data[1] != ' ')
+            {
+                return std::nullopt;
+            }
+
+            m.type = _data[0];
+            _data.remove_prefix(2);
+
+            if (!consume_number(_data, name_length) || _data.size() < name_length + 1 || _data[name_length] != '\n') {
+                return std::nullopt;
+            }
+
+            m.name = std::string{_data.substr(0, name_length)};
+            _data.remove_prefix(name_length + 1);
+
+            index.members_.push_back(std::move(m));
+        }
+
+        if (!_data.empty()) {
+            return std::nullopt;
+        }
+
+        index.index_names();
+
+        return index;
+    } // deserialize
+
+    auto member_index::serialize(std::int64_t _archive_size, std::int64_t _archive_mtime) const -> std::string
+    {
+        // The name is the last field and carries its length, so it may contain any character.
+        auto data = fmt::format("{} {} {} {} {}\n", index_magic, index_version, _archive_size, _archive_mtime, members_.size());
+
+        for (auto&& m : members_) {
+            data += fmt::format("{} {} {} {} {} {} {}\n", m.offset, m.size, m.mtime, m.mode, m.type, m.name.size(), m.name);
+        }
+
+        return data;
+    } // serialize
+
+    auto member_index::find(std::string_view _name) const -> const member*
+    {
+        const auto iter = std::lower_bound(std::begin(by_name_), std::end(by_name_), _name,
+                                           [this](std::size_t _i, std::string_view _name) {
+                                               return members_[_i].name < _name;
+                                           });
+
+        if (iter == std::end(by_name_) || members_[*iter].name != _name) {
+            return nullptr;
+        }
+
+        return &members_[*iter];
+    } // find
+
+    auto member_index::index_names() -> void
+    {
+        by_name_.resize(members_.size());
+        std::iota(std::begin(by_name_), std::end(by_name_), 0);
+
+        // Members with the same name stay in the order of the tar file, so the last
+        // one of each run is the one to keep.
+        std::stable_sort(std::begin(by_name_), std::end(by_name_), [this](std::size_t _lhs, std::size_t _rhs) {
+            return members_[_lhs].name < members_[_rhs].name;
+        });
+
+        const auto last = std::unique(std::rbegin(by_name_), std::rend(by_name_), [this](std::size_t _lhs, std::size_t _rhs) {
+            return members_[_lhs].name == members_[_rhs].name;
+        });
+
+        by_name_.erase(std::begin(by_name_), last.base());
+    } // index_names
+} // namespace irods::experimental::tar
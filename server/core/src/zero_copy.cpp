@@ -0,0 +1,218 @@
+#include "zero_copy.hpp"
+
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+namespace
+{
+    // The largest number of bytes moved by a single system call.
+    // Linux never transfers more than this in one call anyway.
+    constexpr rodsLong_t max_bytes_per_call = 0x7ffff000;
+
+    // The requested capacity of the pipe used by splice(2).
+    constexpr int pipe_capacity = 1024 * 1024;
+
+    // The coordinating resources which read and write the file of their child
+    // unchanged.
+    constexpr std::array<std::string_view, 7> pass_through_resource_types{
+        "compound", "deferred", "load_balanced", "passthru", "random", "replication", "roundrobin"
+    };
+
+    auto is_unsupported(int _errno) noexcept -> bool
+    {
+        return ENOSYS == _errno || EINVAL == _errno || EXDEV == _errno ||
+               EOPNOTSUPP == _errno || EBADF == _errno;
+    }
+
+    class pipe_pair
+    {
+    public:
+        pipe_pair() noexcept
+            : fds_{-1, -1}
+        {
+            if (pipe2(fds_, O_CLOEXEC) == 0) {
+                // Failure here is not fatal. The pipe will simply be smaller.
+                fcntl(fds_[1], F_SETPIPE_SZ, pipe_capacity);
+            }
+        }
+
+        ~pipe_pair()
+        {
+            if (fds_[0] >= 0) {
+                close(fds_[0]);
+                close(fds_[1]);
+            }
+        }
+
+        pipe_pair(const pipe_pair&) = delete;
+        auto operator=(const pipe_pair&) -> pipe_pair& = delete;
+
+        explicit operator bool() const noexcept { return fds_[0] >= 0; }
+
+        auto read_end() const noexcept -> int { return fds_[0]; }
+        auto write_end() const noexcept -> int { return fds_[1]; }
+
+    private:
+        int fds_[2];
+    };
+} // anonymous namespace
+
+namespace irods::zero_copy
+{
+    auto is_pass_through_hierarchy(const std::vector<std::string>& _resource_types) -> bool
+    {
+        if (_resource_types.empty() || "unixfilesystem" != _resource_types.back()) {
+            return false;
+        }
+
+        return std::all_of(std::begin(_resource_types), std::end(_resource_types) - 1, [](const std::string& _type) {
+            return std::find(std::begin(pass_through_resource_types), std::end(pass_through_resource_types), _type) !=
+                   std::end(pass_through_resource_types);
+        });
+    }
+
+    auto receive_from_socket(int _sock, int _fd, rodsLong_t _offset, rodsLong_t _length, bool& _unsupported) -> rodsLong_t
+    {
+        _unsupported = false;
+
+        pipe_pair pipe;
+
+        if (!pipe) {
+            _unsupported = true;
+            return 0;
+        }
+
+        loff_t offset = _offset;
+        rodsLong_t bytes_moved = 0;
+
+        while (bytes_moved < _length) {
+            const auto request = std::min(_length - bytes_moved, static_cast<rodsLong_t>(pipe_capacity));
+            const auto in_pipe = splice(_sock, nullptr, pipe.write_end(), nullptr, request, SPLICE_F_MOVE | SPLICE_F_MORE);
+
+            if (in_pipe < 0) {
+                if (EINTR == errno || EAGAIN == errno) {
+                    continue;
+                }
+
+                if (0 == bytes_moved && is_unsupported(errno)) {
+                    _unsupported = true;
+                    return 0;
+                }
+
+                rodsLog(LOG_ERROR, "zero_copy::receive_from_socket: splice from socket failed, errno = %d", errno);
+                return SYS_COPY_LEN_ERR - errno;
+            }
+
+            if (0 == in_pipe) {
+                rodsLog(LOG_ERROR, "zero_copy::receive_from_socket: peer closed the socket after %lld of %lld bytes",
+                        bytes_moved, _length);
+                return SYS_COPY_LEN_ERR;
+            }
+
+            // Drain the pipe completely before reading more from the socket.
+            // Once data has been pulled from the socket, there is no way to fall back.
+            for (auto remaining = in_pipe; remaining > 0;) {
+                const auto out = splice(pipe.read_end(), nullptr, _fd, &offset, remaining, SPLICE_F_MOVE | SPLICE_F_MORE);
+
+                if (out < 0) {
+                    if (EINTR == errno || EAGAIN == errno) {
+                        continue;
+                    }
+
+                    rodsLog(LOG_ERROR, "zero_copy::receive_from_socket: splice into file failed, errno = %d", errno);
+                    return SYS_COPY_LEN_ERR - errno;
+                }
+
+                remaining -= out;
+            }
+
+            bytes_moved += in_pipe;
+        }
+
+        return bytes_moved;
+    } // receive_from_socket
+
+    auto send_to_socket(int _fd, int _sock, rodsLong_t _offset, rodsLong_t _length, bool& _unsupported) -> rodsLong_t
+    {
+        _unsupported = false;
+
+        off_t offset = _offset;
+        rodsLong_t bytes_moved = 0;
+
+        while (bytes_moved < _length) {
+            const auto request = std::min(_length - bytes_moved, max_bytes_per_call);
+            const auto sent = sendfile(_sock, _fd, &offset, request);
+
+            if (sent < 0) {
+                if (EINTR == errno || EAGAIN == errno) {
+                    continue;
+                }
+
+                if (0 == bytes_moved && is_unsupported(errno)) {
+                    _unsupported = true;
+                    return 0;
+                }
+
+                rodsLog(LOG_ERROR, "zero_copy::send_to_socket: sendfile failed, errno = %d", errno);
+                return SYS_COPY_LEN_ERR - errno;
+            }
+
+            if (0 == sent) {
+                rodsLog(LOG_ERROR, "zero_copy::send_to_socket: unexpected end of file after %lld of %lld bytes",
+                        bytes_moved, _length);
+                return SYS_COPY_LEN_ERR;
+            }
+
+            bytes_moved += sent;
+        }
+
+        return bytes_moved;
+    } // send_to_socket
+
+    auto copy_file_range(int _src_fd, int _dst_fd, rodsLong_t _offset, rodsLong_t _length, bool& _unsupported) -> rodsLong_t
+    {
+        _unsupported = false;
+
+        loff_t src_offset = _offset;
+        loff_t dst_offset = _offset;
+        rodsLong_t bytes_moved = 0;
+
+        while (bytes_moved < _length) {
+            const auto request = std::min(_length - bytes_moved, max_bytes_per_call);
+            const auto copied = ::copy_file_range(_src_fd, &src_offset, _dst_fd, &dst_offset, request, 0);
+
+            if (copied < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                if (0 == bytes_moved && is_unsupported(errno)) {
+                    _unsupported = true;
+                    return 0;
+                }
+
+                rodsLog(LOG_ERROR, "zero_copy::copy_file_range: copy_file_range failed, errno = %d", errno);
+                return SYS_COPY_LEN_ERR - errno;
+            }
+
+            if (0 == copied) {
+                // The source is shorter than expected. Report what was copied and let
+                // the caller decide whether this is an error.
+                break;
+            }
+
+            bytes_moved += copied;
+        }
+
+        return bytes_moved;
+    } // copy_file_range
+} // namespace irods::zero_copy
@@ -0,0 +1,18 @@
+set(IRODS_TEST_TARGET irods_async_log_sink)
+
+set(IRODS_TEST_SOURCE_FILES ${CMAKE_CURRENT_SOURCE_DIR}/src/main.cpp
+                            ${CMAKE_CURRENT_SOURCE_DIR}/src/test_async_log_sink.cpp)
+
+set(IRODS_TEST_INCLUDE_PATH ${CMAKE_SOURCE_DIR}/server/core/include
+                            ${IRODS_EXTERNALS_FULLPATH_CATCH2}/include
+                            ${IRODS_EXTERNALS_FULLPATH_BOOST}/include
+                            ${IRODS_EXTERNALS_FULLPATH_FMT}/include)
+
+set(IRODS_TEST_LINK_LIBRARIES irods_common
+                              ${IRODS_EXTERNALS_FULLPATH_BOOST}/lib/libboost_filesystem.so
+                              ${IRODS_EXTERNALS_FULLPATH_BOOST}/lib/libboost_system.so
+                              ${IRODS_EXTERNALS_FULLPATH_FMT}/lib/libfmt.so)
+
+# Must match the definitions irods_common is built with.
+set(IRODS_TEST_COMPILE_DEFINITIONS SPDLOG_FMT_EXTERNAL
+                                   SPDLOG_NO_TLS)
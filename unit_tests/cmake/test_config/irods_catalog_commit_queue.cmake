@@ -0,0 +1,17 @@
+set(IRODS_TEST_TARGET irods_catalog_commit_queue)
+
+set(IRODS_TEST_SOURCE_FILES ${CMAKE_CURRENT_SOURCE_DIR}/src/main.cpp
+                            ${CMAKE_CURRENT_SOURCE_DIR}/src/test_catalog_commit_queue.cpp)
+
+set(IRODS_TEST_INCLUDE_PATH ${CMAKE_BINARY_DIR}/lib/core/include
+                            ${CMAKE_SOURCE_DIR}/lib/core/include
+                            ${CMAKE_SOURCE_DIR}/server/core/include
+                            ${IRODS_EXTERNALS_FULLPATH_CATCH2}/include
+                            ${IRODS_EXTERNALS_FULLPATH_BOOST}/include
+                            ${IRODS_EXTERNALS_FULLPATH_FMT}/include
+                            ${IRODS_EXTERNALS_FULLPATH_NANODBC}/include)
+
+set(IRODS_TEST_LINK_LIBRARIES irods_common
+                              irods_server
+                              ${IRODS_EXTERNALS_FULLPATH_FMT}/lib/libfmt.so
+                              ${IRODS_EXTERNALS_FULLPATH_NANODBC}/lib/libnanodbc.so)
@@ -20,6 +20,7 @@
 #include "client_connection.hpp"
 #include "connection_pool.hpp"
 #include "filesystem.hpp"
+#include "filesystem/parallel_recursive_collection_iterator.hpp"
 #include "resource_administration.hpp"
 #include "irods_at_scope_exit.hpp"
 #include "irods_client_api_table.hpp"
@@ -431,6 +432,58 @@ TEST_CASE("filesystem")
             REQUIRE(expected_entries == entries);
         }
 
+        SECTION("parallel recursive collection iterator")
+        {
+            const auto mode = GENERATE(fs::client::traversal_mode::parallel, fs::client::traversal_mode::single_query);
+
+            fs::client::parallel_traversal_options opts;
+            opts.mode = mode;
+            opts.max_open_collections = 3;
+
+            // The iterator's workers need connections of their own.
+            irods::connection_pool worker_pool{opts.max_open_collections,
+                                               env.rodsHost,
+                                               env.rodsPort,
+                                               env.rodsUserName,
+                                               env.rodsZone,
+                                               refresh_time};
+
+            // Capture the results of the iterator in a vector.
+            std::vector<std::string> entries;
+
+            for (auto&& e : fs::client::parallel_recursive_collection_iterator{worker_pool, sandbox, opts}) {
+                entries.push_back(e.path().string());
+
+                if (e.is_data_object()) {
+                    REQUIRE_FALSE(e.data_id().empty());
+                }
+            }
+
+            std::sort(std::begin(entries), std::end(entries));
+
+            // The sorted list of paths that the "entries" vector must match.
+            const std::vector expected_entries{
+                col1.string(),
+                (col1 / "f1.txt").string(),
+                (col1 / "f2.txt").string(),
+                (col1 / "f3.txt").string(),
+                col2.string(),
+                (sandbox / "f1.txt").string(),
+                (sandbox / "f2.txt").string(),
+                (sandbox / "f3.txt").string()
+            };
+
+            REQUIRE(expected_entries == entries);
+
+            // Abandoning the iterator before the end must not block.
+            {
+                fs::client::parallel_recursive_collection_iterator iter{worker_pool, sandbox, opts};
+                REQUIRE(fs::client::parallel_recursive_collection_iterator{} != iter);
+            }
+
+            REQUIRE_THROWS(fs::client::parallel_recursive_collection_iterator{worker_pool, sandbox / "missing.d", opts});
+        }
+
         // Clean-up.
         REQUIRE(fs::client::remove(conn, sandbox / "f1.txt", fs::remove_options::no_trash));
         REQUIRE(fs::client::remove(conn, sandbox / "f2.txt", fs::remove_options::no_trash));
@@ -0,0 +1,161 @@
+#include "catch.hpp"
+
+#include "api_metrics.hpp"
+#include "apiNumber.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace metrics = irods::experimental::api_metrics;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    auto find_api(const metrics::statistics& _stats, int _api_number) -> const metrics::api_statistics*
+    {
+        const auto iter = std::find_if(std::begin(_stats.apis), std::end(_stats.apis), [_api_number](auto& _a) {
+            return _a.api_number == _api_number;
+        });
+
+        return iter != std::end(_stats.apis) ? &*iter : nullptr;
+    }
+
+    auto http_get(int _port, const std::string& _path) -> std::string
+    {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        REQUIRE(fd >= 0);
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(_port);
+        REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+        const auto request = "GET " + _path + " HTTP/1.0\r\n\r\n";
+        REQUIRE(send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()));
+
+        std::string response;
+        char buffer[4096];
+
+        for (ssize_t n; (n = recv(fd, buffer, sizeof(buffer), 0)) > 0;) {
+            response.append(buffer, n);
+        }
+
+        close(fd);
+
+        return response;
+    }
+} // anonymous namespace
+
+TEST_CASE("api_metrics histogram buckets")
+{
+    CHECK(metrics::bucket_index(0) == 0);
+    CHECK(metrics::bucket_index(7) == 7);
+    CHECK(metrics::bucket_index(std::uint64_t{1} << 50) == metrics::histogram_bucket_count - 1);
+
+    for (std::uint64_t v = 1; v < (std::uint64_t{1} << 36); v = v * 3 / 2 + 1) {
+        const auto i = metrics::bucket_index(v);
+        const auto lower = metrics::bucket_lower_bound(i);
+        const auto upper = metrics::bucket_lower_bound(i + 1);
+
+        REQUIRE(lower <= v);
+        REQUIRE(v < upper);
+
+        // The width of a bucket never exceeds 1/8 of its lower bound.
+        REQUIRE((upper - lower) * 8 <= std::max<std::uint64_t>(lower, 8));
+    }
+}
+
+TEST_CASE("api_metrics")
+{
+    metrics::init();
+
+    const auto before = metrics::collect();
+    const auto* old = find_api(before, DATA_OBJ_OPEN_AN);
+    const auto old_calls = old ? old->calls : 0;
+    const auto old_errors = old ? old->errors : 0;
+
+    SECTION("calls recorded by forked processes are aggregated")
+    {
+        constexpr int processes = 4;
+        constexpr int calls_per_process = 1000;
+
+        for (int p = 0; p < processes; ++p) {
+            if (fork() == 0) {
+                for (int i = 0; i < calls_per_process; ++i) {
+                    // Every tenth call fails and takes 10ms. The others take 100us.
+                    const bool fail = (0 == i % 10);
+                    metrics::record(DATA_OBJ_OPEN_AN, fail ? 10ms : 100us, fail ? -1 : 0, 100, 10);
+                }
+
+                _exit(0);
+            }
+        }
+
+        for (int p = 0; p < processes; ++p) {
+            int status{};
+            wait(&status);
+            REQUIRE(WIFEXITED(status));
+        }
+
+        const auto stats = metrics::collect();
+        const auto* a = find_api(stats, DATA_OBJ_OPEN_AN);
+        REQUIRE(a);
+
+        CHECK(a->calls - old_calls == processes * calls_per_process);
+        CHECK(a->errors - old_errors == processes * calls_per_process / 10);
+        CHECK(a->max_microseconds == 10'000);
+
+        if (0 == old_calls) {
+            CHECK(a->bytes_received == processes * calls_per_process * 100);
+            CHECK(a->bytes_sent == processes * calls_per_process * 10);
+
+            // The percentiles are upper bounds within 12.5% of the real value.
+            CHECK(a->percentile(50) >= 100);
+            CHECK(a->percentile(50) < 113);
+            CHECK(a->percentile(99) == 10'000);
+        }
+    }
+
+    SECTION("the statistics can be exported")
+    {
+        metrics::record(DATA_OBJ_CLOSE_AN, 250us, 0, 0, 0);
+
+        const auto stats = metrics::collect();
+
+        const auto json = metrics::to_json(stats);
+        const auto iter = std::find_if(std::begin(json.at("apis")), std::end(json.at("apis")), [](auto& _a) {
+            return _a.at("api_number").template get<int>() == DATA_OBJ_CLOSE_AN;
+        });
+        REQUIRE(iter != std::end(json.at("apis")));
+        CHECK(iter->at("api_name").get<std::string>() == "DATA_OBJ_CLOSE_AN");
+
+        const auto text = metrics::to_prometheus_text(stats);
+        CHECK(text.find("# TYPE irods_api_duration_seconds histogram") != std::string::npos);
+        CHECK(text.find("irods_api_calls_total{api=\"DATA_OBJ_CLOSE_AN\",api_number=\"") != std::string::npos);
+        CHECK(text.find("le=\"+Inf\"") != std::string::npos);
+    }
+
+    SECTION("the prometheus endpoint serves the metrics over HTTP")
+    {
+        metrics::record(DATA_OBJ_CLOSE_AN, 250us, 0, 0, 0);
+
+        metrics::prometheus_endpoint endpoint{0};
+        REQUIRE(endpoint.port() > 0);
+
+        const auto response = http_get(endpoint.port(), "/metrics");
+        CHECK(response.rfind("HTTP/1.0 200 OK\r\n", 0) == 0);
+        CHECK(response.find("irods_api_calls_total{api=\"DATA_OBJ_CLOSE_AN\"") != std::string::npos);
+
+        CHECK(http_get(endpoint.port(), "/other").rfind("HTTP/1.0 404", 0) == 0);
+    }
+}
@@ -0,0 +1,387 @@
+#include "catch.hpp"
+
+#include "irods_async_log_sink.hpp"
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/basic_file_sink.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ix = irods::experimental;
+namespace fs = boost::filesystem;
+
+namespace
+{
+    // Records every message and optionally holds up the background thread until
+    // it is released.
+    class recording_target : public ix::log_target
+    {
+    public:
+        auto write(const ix::log_entry* _entries, std::size_t _count) -> void override
+        {
+            std::unique_lock lock{mutex_};
+            cv_.wait(lock, [this] { return !held_; });
+
+            for (std::size_t i = 0; i < _count; ++i) {
+                messages_.push_back(_entries[i].message);
+            }
+
+            ++batches_;
+        }
+
+        auto hold() -> void
+        {
+            std::lock_guard lock{mutex_};
+            held_ = true;
+        }
+
+        auto release() -> void
+        {
+            {
+                std::lock_guard lock{mutex_};
+                held_ = false;
+            }
+
+            cv_.notify_all();
+        }
+
+        auto messages() -> std::vector<std::string>
+        {
+            std::lock_guard lock{mutex_};
+            return messages_;
+        }
+
+        auto batches() -> int
+        {
+            std::lock_guard lock{mutex_};
+            return batches_;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool held_ = false;
+        std::vector<std::string> messages_;
+        int batches_ = 0;
+    }; // class recording_target
+
+    auto read_lines(const fs::path& _p) -> std::vector<std::string>
+    {
+        std::vector<std::string> lines;
+        std::ifstream in{_p.c_str()};
+
+        for (std::string line; std::getline(in, line);) {
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+} // anonymous namespace
+
+TEST_CASE("mpmc_ring_buffer")
+{
+    SECTION("capacity is rounded up to a power of two")
+    {
+        CHECK(ix::mpmc_ring_buffer<int>{5}.capacity() == 8);
+        CHECK(ix::mpmc_ring_buffer<int>{8}.capacity() == 8);
+    }
+
+    SECTION("values are popped in the order they were pushed")
+    {
+        ix::mpmc_ring_buffer<std::string> buffer{4};
+
+        for (auto s : {"a", "b", "c", "d"}) {
+            std::string v = s;
+            REQUIRE(buffer.try_push(v));
+        }
+
+        // The buffer is full, so the value must not be moved from.
+        std::string v = "e";
+        CHECK_FALSE(buffer.try_push(v));
+        CHECK(v == "e");
+
+        for (auto s : {"a", "b", "c", "d"}) {
+            REQUIRE(buffer.try_pop(v));
+            CHECK(v == s);
+        }
+
+        CHECK_FALSE(buffer.try_pop(v));
+    }
+
+    SECTION("concurrent producers and consumers see every value exactly once")
+    {
+        constexpr int producers = 4;
+        constexpr int values_per_producer = 100'000;
+
+        ix::mpmc_ring_buffer<int> buffer{1024};
+        std::vector<int> seen(producers * values_per_producer);
+        std::atomic<int> popped{0};
+
+        std::vector<std::thread> threads;
+
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&buffer, p] {
+                for (int i = 0; i < values_per_producer; ++i) {
+                    int v = p * values_per_producer + i;
+
+                    while (!buffer.try_push(v)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (int c = 0; c < 2; ++c) {
+            threads.emplace_back([&] {
+                int v;
+
+                while (popped.load() < producers * values_per_producer) {
+                    if (buffer.try_pop(v)) {
+                        ++seen[v];
+                        ++popped;
+                    }
+                    else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        CHECK(std::all_of(std::begin(seen), std::end(seen), [](int _n) { return 1 == _n; }));
+    }
+}
+
+TEST_CASE("async_log_sink")
+{
+    using policy = ix::async_log_sink::overflow_policy;
+
+    SECTION("messages are written in batches by the background thread")
+    {
+        auto target = std::make_unique<recording_target>();
+        auto& recorder = *target;
+
+        // Hold up the first batch so that the remaining messages pile up.
+        recorder.hold();
+
+        auto sink = std::make_shared<ix::async_log_sink>(std::move(target), 1024, policy::block);
+        spdlog::logger logger{"test", sink};
+
+        for (int i = 0; i < 500; ++i) {
+            logger.info("message {}", i);
+        }
+
+        recorder.release();
+        sink->flush();
+
+        const auto messages = recorder.messages();
+        REQUIRE(messages.size() == 500);
+        CHECK(messages.front() == "message 0");
+        CHECK(messages.back() == "message 499");
+        CHECK(recorder.batches() < 500);
+        CHECK(sink->dropped() == 0);
+    }
+
+    SECTION("messages are dropped and reported when the buffer is full")
+    {
+        auto target = std::make_unique<recording_target>();
+        auto& recorder = *target;
+        recorder.hold();
+
+        auto sink = std::make_shared<ix::async_log_sink>(std::move(target), 8, policy::drop);
+        spdlog::logger logger{"test", sink};
+
+        constexpr int total = 100;
+
+        for (int i = 0; i < total; ++i) {
+            logger.info("message {}", i);
+        }
+
+        CHECK(sink->dropped() > 0);
+
+        recorder.release();
+        sink->flush();
+
+        const auto messages = recorder.messages();
+        const auto reports = std::count_if(std::begin(messages), std::end(messages), [](const std::string& _m) {
+            return _m.find("dropped_messages") != std::string::npos;
+        });
+
+        CHECK(reports > 0);
+        CHECK(messages.size() - reports + sink->dropped() == total);
+    }
+
+    SECTION("callers wait for space when the buffer is full under the block policy")
+    {
+        auto target = std::make_unique<recording_target>();
+        auto& recorder = *target;
+
+        auto sink = std::make_shared<ix::async_log_sink>(std::move(target), 8, policy::block);
+        spdlog::logger logger{"test", sink};
+
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&logger] {
+                for (int i = 0; i < 1000; ++i) {
+                    logger.info("message {}", i);
+                }
+            });
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        sink->flush();
+
+        CHECK(recorder.messages().size() == 4000);
+        CHECK(sink->dropped() == 0);
+    }
+
+    SECTION("the file target appends one line per message")
+    {
+        const auto path = fs::temp_directory_path() / fs::unique_path("irods_async_log_sink_%%%%-%%%%.log");
+        const auto remove_file = std::shared_ptr<void>{nullptr, [&path](void*) { fs::remove(path); }};
+
+        {
+            auto sink = std::make_shared<ix::async_log_sink>(
+                std::make_unique<ix::file_log_target>(path.string()), 64, policy::block);
+            spdlog::logger logger{"test", sink};
+
+            for (int i = 0; i < 1000; ++i) {
+                logger.info("message {}", i);
+            }
+
+            // The destructor writes whatever is left.
+        }
+
+        const auto lines = read_lines(path);
+        REQUIRE(lines.size() == 1000);
+        CHECK(lines.front() == "message 0");
+        CHECK(lines.back() == "message 999");
+    }
+
+    SECTION("the sink keeps working in both processes after a fork")
+    {
+        const auto path = fs::temp_directory_path() / fs::unique_path("irods_async_log_sink_%%%%-%%%%.log");
+        const auto remove_file = std::shared_ptr<void>{nullptr, [&path](void*) { fs::remove(path); }};
+
+        auto sink = std::make_shared<ix::async_log_sink>(
+            std::make_unique<ix::file_log_target>(path.string()), 64, policy::block);
+        spdlog::logger logger{"test", sink};
+
+        logger.info("before fork");
+
+        if (const auto pid = fork(); 0 == pid) {
+            logger.info("child");
+            sink->flush();
+            _exit(0);
+        }
+        else {
+            REQUIRE(pid > 0);
+            logger.info("parent");
+            sink->flush();
+
+            int status{};
+            waitpid(pid, &status, 0);
+            REQUIRE(WIFEXITED(status));
+        }
+
+        auto lines = read_lines(path);
+        std::sort(std::begin(lines), std::end(lines));
+        CHECK(lines == std::vector<std::string>{"before fork", "child", "parent"});
+    }
+}
+
+// Measures how long a log call takes when several threads log at the same time.
+//
+// Run with: irods_async_log_sink "[benchmark]"
+TEST_CASE("async_log_sink latency benchmark", "[.][benchmark]")
+{
+    using policy = ix::async_log_sink::overflow_policy;
+
+    constexpr int threads = 8;
+    constexpr int messages_per_thread = 20'000;
+
+    const auto path = fs::temp_directory_path() / fs::unique_path("irods_async_log_sink_%%%%-%%%%.log");
+    const auto remove_file = std::shared_ptr<void>{nullptr, [&path](void*) { fs::remove(path); }};
+
+    const auto measure = [&](const char* _name, spdlog::sink_ptr _sink) {
+        spdlog::logger logger{"benchmark", _sink};
+
+        // A payload similar in size to the JSON produced by irods::experimental::log.
+        const std::string payload(300, 'x');
+
+        std::vector<std::thread> workers;
+        std::vector<std::vector<double>> latencies(threads);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                auto& l = latencies[t];
+                l.reserve(messages_per_thread);
+
+                for (int i = 0; i < messages_per_thread; ++i) {
+                    const auto s = std::chrono::steady_clock::now();
+                    logger.info(payload);
+                    l.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - s).count());
+                }
+            });
+        }
+
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        const auto logging_done = std::chrono::steady_clock::now();
+        _sink->flush();
+        const auto all_written = std::chrono::steady_clock::now();
+
+        std::vector<double> all;
+
+        for (auto& l : latencies) {
+            all.insert(std::end(all), std::begin(l), std::end(l));
+        }
+
+        std::sort(std::begin(all), std::end(all));
+
+        const auto ms = [](auto _d) { return std::chrono::duration<double, std::milli>(_d).count(); };
+
+        WARN(_name << ": p50 " << all[all.size() / 2] << " ns, p99 " << all[all.size() * 99 / 100]
+                   << " ns, max " << all.back() << " ns per call; logging took " << ms(logging_done - start)
+                   << " ms, writing everything took " << ms(all_written - start) << " ms");
+    };
+
+    {
+        auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path.string());
+        sink->set_pattern("%v");
+        measure("synchronous file sink", sink);
+    }
+
+    measure("async file sink (block)",
+            std::make_shared<ix::async_log_sink>(std::make_unique<ix::file_log_target>(path.string()), 8192, policy::block));
+
+    {
+        auto sink = std::make_shared<ix::async_log_sink>(std::make_unique<ix::file_log_target>(path.string()), 8192, policy::drop);
+        measure("async file sink (drop)", sink);
+        WARN("dropped " << sink->dropped() << " of " << threads * messages_per_thread << " messages");
+    }
+}
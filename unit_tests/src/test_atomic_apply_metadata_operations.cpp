@@ -6,12 +6,15 @@
 #include "irods_client_api_table.hpp"
 #include "irods_pack_table.hpp"
 #include "connection_pool.hpp"
-#include "filesystem/path.hpp"
+#include "filesystem.hpp"
 #include "irods_at_scope_exit.hpp"
 
 #include "json.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <string>
+#include <vector>
 
 namespace fs = irods::experimental::filesystem;
 
@@ -250,6 +253,37 @@ TEST_CASE("atomic_apply_metadata_operations")
         REQUIRE(json_error_string == "{}"s);
     }
 
+    SECTION("operations naming the same AVU are applied in order")
+    {
+        const auto json_input = json{
+            {"entity_name", user_home},
+            {"entity_type", "collection"},
+            {"operations", json::array({
+                {{"operation", "add"}, {"attribute", "a0"}, {"value", "v0"}, {"units", "u0"}},
+                {{"operation", "add"}, {"attribute", "a1"}, {"value", "v1"}, {"units", "u1"}},
+                {{"operation", "remove"}, {"attribute", "a0"}, {"value", "v0"}, {"units", "u0"}},
+                {{"operation", "add"}, {"attribute", "a0"}, {"value", "v0"}, {"units", "u0"}},
+                {{"operation", "add"}, {"attribute", "a0"}, {"value", "v0"}, {"units", "u0"}},
+                {{"operation", "remove"}, {"attribute", "a1"}, {"value", "v1"}, {"units", "u1"}}
+            })}
+        }.dump();
+
+        char* json_error_string{};
+
+        REQUIRE(rc_atomic_apply_metadata_operations(conn_ptr, json_input.c_str(), &json_error_string) == 0);
+        REQUIRE(json_error_string == "{}"s);
+
+        const auto metadata = fs::client::get_metadata(conn, user_home);
+        const auto count = [&metadata](const std::string& _attribute) {
+            return std::count_if(std::begin(metadata), std::end(metadata), [&_attribute](auto& _md) {
+                return _md.attribute == _attribute;
+            });
+        };
+
+        CHECK(count("a0") == 1);
+        CHECK(count("a1") == 0);
+    }
+
     SECTION("users")
     {
         const auto json_input = json{
@@ -314,6 +348,76 @@ TEST_CASE("atomic_apply_metadata_operations")
     }
 }
 
+// Compares attaching many AVUs to a collection in a single request with attaching them
+// one at a time through rcModAVUMetadata.
+//
+// Run with: irods_atomic_apply_metadata_operations "[benchmark]"
+TEST_CASE("atomic_apply_metadata_operations benchmark", "[.][benchmark]")
+{
+    using namespace std::string_literals;
+
+    auto& api_table = irods::get_client_api_table();
+    auto& pck_table = irods::get_pack_table();
+    init_api_table(api_table, pck_table);
+
+    rodsEnv env;
+    REQUIRE(getRodsEnv(&env) >= 0);
+
+    irods::connection_pool conn_pool{1, env.rodsHost, env.rodsPort, env.rodsUserName, env.rodsZone, 600};
+
+    auto conn = conn_pool.get_connection();
+
+    const auto collection = fs::path{env.rodsHome} / "atomic_apply_metadata_operations_benchmark";
+    REQUIRE(fs::client::create_collection(conn, collection));
+
+    irods::at_scope_exit remove_collection{[&] {
+        fs::client::remove_all(conn, collection, fs::remove_options::no_trash);
+    }};
+
+    constexpr int avu_count = 10'000;
+
+    std::vector<fs::metadata> metadata;
+    metadata.reserve(avu_count);
+
+    for (int i = 0; i < avu_count; ++i) {
+        metadata.push_back({"benchmark_attr_" + std::to_string(i), "benchmark_value_" + std::to_string(i % 100), "benchmark_units"});
+    }
+
+    const auto measure = [](auto&& _func) {
+        const auto start = std::chrono::steady_clock::now();
+        _func();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const auto apply = [&](const char* _operation) {
+        auto operations = json::array();
+
+        for (auto&& md : metadata) {
+            operations.push_back({{"operation", _operation}, {"attribute", md.attribute}, {"value", md.value}, {"units", md.units}});
+        }
+
+        const auto json_input = json{{"entity_name", collection.string()}, {"entity_type", "collection"}, {"operations", operations}}.dump();
+
+        char* json_error_string{};
+        REQUIRE(rc_atomic_apply_metadata_operations(&static_cast<rcComm_t&>(conn), json_input.c_str(), &json_error_string) == 0);
+        REQUIRE(json_error_string == "{}"s);
+    };
+
+    const auto per_avu = measure([&] {
+        for (auto&& md : metadata) {
+            fs::client::add_metadata(conn, collection, md);
+        }
+    });
+
+    apply("remove");
+
+    const auto batched = measure([&] { apply("add"); });
+
+    REQUIRE(fs::client::get_metadata(conn, collection).size() == avu_count);
+
+    WARN("attaching " << avu_count << " AVUs: " << per_avu << "s one at a time, " << batched << "s in one request");
+}
+
 auto contains_error_information(const char* _json_string) -> bool
 {
     try {
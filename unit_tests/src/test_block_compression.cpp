@@ -0,0 +1,192 @@
+#include "catch.hpp"
+
+#include "block_compression.hpp"
+#include "irods_exception.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace bc = irods::experimental::block_compression;
+
+namespace
+{
+    // A file held in memory.
+    struct memory_file
+    {
+        std::vector<char> bytes;
+        std::size_t reads = 0;
+
+        auto io() -> bc::file_io
+        {
+            return {[this](std::int64_t _offset, void* _buffer, std::size_t _size) -> std::size_t {
+                        ++reads;
+                        const auto n = std::min<std::size_t>(_size, std::max<std::int64_t>(bytes.size() - _offset, 0));
+                        std::memcpy(_buffer, bytes.data() + _offset, n);
+                        return n;
+                    },
+                    [this](std::int64_t _offset, const void* _buffer, std::size_t _size) {
+                        if (bytes.size() < _offset + _size) {
+                            bytes.resize(_offset + _size);
+                        }
+                        std::memcpy(bytes.data() + _offset, _buffer, _size);
+                    }};
+        }
+    };
+
+    // Data drawn from eight symbols, which compresses to less than half.
+    auto make_input(std::size_t _size) -> std::vector<char>
+    {
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> dist{0, 7};
+
+        std::vector<char> data(_size);
+        std::generate(std::begin(data), std::end(data), [&] { return static_cast<char>('a' + dist(gen)); });
+
+        return data;
+    }
+
+    auto read_all(bc::reader& _reader, const bc::file_io& _io) -> std::vector<char>
+    {
+        std::vector<char> data(_reader.size());
+        std::size_t offset = 0;
+
+        while (offset < data.size()) {
+            const auto n = _reader.read(offset, data.data() + offset, std::min<std::size_t>(100'000, data.size() - offset), _io);
+            REQUIRE(n > 0);
+            offset += n;
+        }
+
+        return data;
+    }
+
+    auto make_index(std::uint32_t _block_size) -> bc::block_index
+    {
+        bc::block_index index;
+        index.block_size = _block_size;
+        return index;
+    }
+} // anonymous namespace
+
+TEST_CASE("block compression round trip")
+{
+    memory_file file;
+    const auto io = file.io();
+    const auto input = make_input(3 * 1024 * 1024 + 1234);
+
+    {
+        bc::writer w{make_index(64 * 1024), 0, 4, 1};
+
+        for (std::size_t offset = 0; offset < input.size(); offset += 10'000) {
+            w.write(offset, input.data() + offset, std::min<std::size_t>(10'000, input.size() - offset), io);
+        }
+
+        const auto file_size = w.finish(io);
+        CHECK(file_size == static_cast<std::int64_t>(file.bytes.size()));
+        CHECK(w.bytes_compressed() < w.bytes_stored());
+    }
+
+    CHECK(file.bytes.size() < input.size() / 2);
+
+    const auto index = bc::read_index(io, file.bytes.size());
+    REQUIRE(index);
+    CHECK(index->size == static_cast<std::int64_t>(input.size()));
+    CHECK(index->blocks.size() == 49);
+
+    SECTION("the reader returns the content")
+    {
+        bc::reader r{*index, 4, 4};
+        CHECK(read_all(r, io) == input);
+    }
+
+    SECTION("random access inflates only the blocks it needs")
+    {
+        bc::reader r{*index, 2, 1};
+        file.reads = 0;
+
+        std::vector<char> buffer(100);
+        const std::int64_t offset = 2 * 1024 * 1024 + 5;
+        CHECK(r.read(offset, buffer.data(), buffer.size(), io) == buffer.size());
+        CHECK(std::equal(std::begin(buffer), std::end(buffer), std::begin(input) + offset));
+        CHECK(file.reads == 1);
+
+        // Reading past the end returns what is left.
+        CHECK(r.read(input.size() - 10, buffer.data(), buffer.size(), io) == 10);
+        CHECK(r.read(input.size(), buffer.data(), buffer.size(), io) == 0);
+    }
+
+    SECTION("existing content can be rewritten in place")
+    {
+        bc::writer w{*index, static_cast<std::int64_t>(file.bytes.size()), 2, 1};
+
+        auto expected = input;
+        const std::vector<char> patch(100'000, 'Z');
+        std::copy(std::begin(patch), std::end(patch), std::begin(expected) + 1'000'000);
+        w.write(1'000'000, patch.data(), patch.size(), io);
+
+        std::vector<char> buffer(10);
+        CHECK(w.read(1'099'995, buffer.data(), buffer.size(), io) == buffer.size());
+        CHECK(std::equal(std::begin(buffer), std::end(buffer), std::begin(expected) + 1'099'995));
+
+        w.finish(io);
+
+        const auto updated = bc::read_index(io, file.bytes.size());
+        REQUIRE(updated);
+        bc::reader r{*updated, 2, 4};
+        CHECK(read_all(r, io) == expected);
+    }
+
+    SECTION("truncation zeroes the bytes it cuts")
+    {
+        bc::writer w{*index, static_cast<std::int64_t>(file.bytes.size()), 2, 1};
+        w.truncate(100'000, io);
+        w.truncate(200'000, io);
+        w.finish(io);
+
+        const auto updated = bc::read_index(io, file.bytes.size());
+        REQUIRE(updated);
+        CHECK(updated->size == 200'000);
+
+        bc::reader r{*updated, 2, 4};
+        const auto content = read_all(r, io);
+        CHECK(std::equal(std::begin(content), std::begin(content) + 100'000, std::begin(input)));
+        CHECK(std::all_of(std::begin(content) + 100'000, std::end(content), [](char _c) { return _c == 0; }));
+    }
+}
+
+TEST_CASE("block compression of sparse and incompressible data")
+{
+    memory_file file;
+    const auto io = file.io();
+
+    std::vector<char> noise(200'000);
+    std::mt19937 gen{7};
+    std::generate(std::begin(noise), std::end(noise), [&] { return static_cast<char>(gen()); });
+
+    bc::writer w{make_index(64 * 1024), 0, 2, 6};
+
+    // Written out of order, with a hole in front.
+    w.write(500'000, noise.data() + 100'000, 100'000, io);
+    w.write(400'000, noise.data(), 100'000, io);
+    w.finish(io);
+
+    const auto index = bc::read_index(io, file.bytes.size());
+    REQUIRE(index);
+    CHECK(index->size == 600'000);
+    CHECK(index->blocks[0].stored_size == 0);
+    CHECK((index->blocks[7].flags & bc::stored_raw) != 0);
+
+    bc::reader r{*index, 2, 4};
+    const auto content = read_all(r, io);
+    CHECK(std::all_of(std::begin(content), std::begin(content) + 400'000, [](char _c) { return _c == 0; }));
+    CHECK(std::equal(std::begin(noise), std::end(noise), std::begin(content) + 400'000));
+}
+
+TEST_CASE("files in other formats are not indexed")
+{
+    memory_file file;
+    file.bytes = make_input(1000);
+    CHECK_FALSE(bc::read_index(file.io(), file.bytes.size()));
+    CHECK_FALSE(bc::read_index(file.io(), 0));
+}
@@ -0,0 +1,218 @@
+#include "catch.hpp"
+
+#include "cache_eviction.hpp"
+#include "irods_exception.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ce = irods::experimental::cache_eviction;
+
+namespace
+{
+    auto make_candidate(std::int64_t _data_id,
+                        std::int64_t _size,
+                        std::int64_t _last_access,
+                        std::uint32_t _hits) -> ce::candidate
+    {
+        return {_data_id,
+                0,
+                "/tempZone/home/rods/" + std::to_string(_data_id),
+                _size,
+                _last_access,
+                _hits,
+                static_cast<double>(_hits) / _size};
+    }
+
+    auto data_ids(const std::vector<ce::candidate>& _candidates) -> std::vector<std::int64_t>
+    {
+        std::vector<std::int64_t> ids;
+        std::transform(std::begin(_candidates), std::end(_candidates), std::back_inserter(ids),
+                       [](const ce::candidate& _c) { return _c.data_id; });
+        return ids;
+    }
+
+    // Each test uses a log of its own so that runs in parallel do not interfere.
+    auto unique_resource_id() -> std::int64_t
+    {
+        static std::int64_t counter = 0;
+        return -(static_cast<std::int64_t>(getpid()) * 1000 + ++counter);
+    }
+} // anonymous namespace
+
+TEST_CASE("cache eviction policies")
+{
+    // clang-format off
+    const std::vector<ce::candidate> candidates{
+        make_candidate(1, 1000, 300, 1),  // recent, rare
+        make_candidate(2, 1000, 100, 50), // old, frequent
+        make_candidate(3, 10,   200, 2),  // small
+        make_candidate(4, 5000, 250, 5)   // large
+    };
+    // clang-format on
+
+    SECTION("lru evicts the least recently used replicas first")
+    {
+        const auto victims = ce::select_victims(candidates, *ce::make_policy("lru"), 1'000'000);
+        CHECK(data_ids(victims) == std::vector<std::int64_t>{2, 3, 4, 1});
+    }
+
+    SECTION("lfu evicts the least frequently used replicas first")
+    {
+        const auto victims = ce::select_victims(candidates, *ce::make_policy("lfu"), 1'000'000);
+        CHECK(data_ids(victims) == std::vector<std::int64_t>{1, 3, 4, 2});
+    }
+
+    SECTION("gdsf evicts the replicas with the fewest hits per byte first")
+    {
+        const auto victims = ce::select_victims(candidates, *ce::make_policy("gdsf"), 1'000'000);
+        CHECK(data_ids(victims) == std::vector<std::int64_t>{4, 1, 2, 3});
+    }
+
+    SECTION("unknown policies are rejected")
+    {
+        CHECK_THROWS_AS(ce::make_policy("fifo"), irods::exception);
+    }
+}
+
+TEST_CASE("select_victims stops once enough bytes are freed")
+{
+    std::vector<ce::candidate> candidates;
+
+    for (int i = 1; i <= 1000; ++i) {
+        candidates.push_back(make_candidate(i, 100, 1000 - i, 1));
+    }
+
+    CHECK(ce::select_victims(candidates, *ce::make_policy("lru"), 0).empty());
+
+    // The newest replicas have the lowest data IDs, so the victims are the highest.
+    const auto victims = ce::select_victims(candidates, *ce::make_policy("lru"), 25'050);
+    REQUIRE(victims.size() == 251);
+    CHECK(victims.front().data_id == 1000);
+    CHECK(victims.back().data_id == 750);
+}
+
+TEST_CASE("bytes_to_free")
+{
+    const ce::watermarks wm{1000, 90, 75};
+
+    CHECK(ce::bytes_to_free(0, wm) == 0);
+    CHECK(ce::bytes_to_free(900, wm) == 0);
+    CHECK(ce::bytes_to_free(901, wm) == 151);
+    CHECK(ce::bytes_to_free(2000, wm) == 1250);
+
+    // A low watermark above the high watermark frees down to the high watermark.
+    CHECK(ce::bytes_to_free(1000, {1000, 80, 95}) == 200);
+}
+
+TEST_CASE("make_replica_key")
+{
+    const auto key = ce::make_replica_key("/var/lib/irods/cacheVault/home/rods/foo");
+
+    CHECK(key == ce::make_replica_key("/var/lib/irods/cacheVault/home/rods/foo"));
+    CHECK(key != ce::make_replica_key("/var/lib/irods/cacheVault/home/rods/bar"));
+    CHECK(key != 0);
+    CHECK(key != -1);
+}
+
+TEST_CASE("access_log")
+{
+    ce::access_log log{unique_resource_id()};
+
+    SECTION("accesses are counted")
+    {
+        CHECK_FALSE(log.find(42));
+
+        log.record(42, 1000);
+        log.record(42, 2000);
+
+        const auto r = log.find(42);
+        REQUIRE(r);
+        CHECK(r->last_access == 2000);
+        CHECK(r->hits == 2);
+        CHECK(ce::gdsf_value(*r, 100) == Approx(0.02));
+
+        log.erase(42);
+        CHECK_FALSE(log.find(42));
+
+        // A replica recorded after an erasure starts over.
+        log.record(42, 3000);
+        REQUIRE(log.find(42));
+        CHECK(log.find(42)->hits == 1);
+    }
+
+    SECTION("the gdsf values of later accesses are aged by the inflation")
+    {
+        log.record(1, 1000);
+        log.inflate(5.0);
+        log.inflate(2.0);
+        CHECK(log.inflation() == 5.0);
+
+        log.record(2, 1000);
+        CHECK(ce::gdsf_value(*log.find(1), 100) == Approx(0.01));
+        CHECK(ce::gdsf_value(*log.find(2), 100) == Approx(5.01));
+    }
+
+    SECTION("the log keeps the most recent accesses when full")
+    {
+        constexpr auto count = static_cast<std::int64_t>(2 * ce::access_log::capacity);
+
+        for (std::int64_t i = 1; i <= count; ++i) {
+            log.record(i, i);
+        }
+
+        CHECK(log.find(count));
+        CHECK(log.find(count - 1));
+        CHECK_FALSE(log.find(1));
+    }
+
+    SECTION("one process at a time evicts, at most once per interval")
+    {
+        CHECK(log.try_start_eviction(1000, 60));
+        CHECK_FALSE(log.try_start_eviction(2000, 60));
+
+        log.finish_eviction();
+        CHECK_FALSE(log.try_start_eviction(1059, 60));
+        CHECK(log.try_start_eviction(1060, 60));
+        log.finish_eviction();
+    }
+
+    SECTION("the log is shared")
+    {
+        const auto resource_id = unique_resource_id();
+
+        ce::access_log a{resource_id};
+        ce::access_log b{resource_id};
+
+        a.record(7, 1000);
+        CHECK(b.find(7));
+
+        b.remove();
+    }
+
+    log.remove();
+}
+
+TEST_CASE("access logs do not outlive a run of the server")
+{
+    const auto resource_id = unique_resource_id();
+
+    ce::access_log log{resource_id};
+    log.record(7, 1000);
+    REQUIRE(log.try_start_eviction(1000, 60));
+
+    ce::init_access_logs();
+
+    // The evictor belongs to the earlier run, even though a process with its PID is alive.
+    CHECK(log.try_start_eviction(2000, 60));
+
+    // A log opened by this run starts empty.
+    ce::access_log fresh{resource_id};
+    CHECK_FALSE(fresh.find(7));
+
+    ce::deinit_access_logs();
+}
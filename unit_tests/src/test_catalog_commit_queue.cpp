@@ -0,0 +1,254 @@
+#include "catch.hpp"
+
+#include "catalog_commit_queue.hpp"
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace ic = irods::experimental::catalog;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Stands in for the catalog. Lives in shared memory so that the batches
+    // committed by forked processes are recorded too.
+    struct fake_catalog
+    {
+        static auto create() -> fake_catalog*
+        {
+            void* p = mmap(nullptr, sizeof(fake_catalog), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            REQUIRE(MAP_FAILED != p);
+            return new (p) fake_catalog{};
+        }
+
+        static auto destroy(fake_catalog* _catalog) -> void
+        {
+            munmap(_catalog, sizeof(fake_catalog));
+        }
+
+        auto commit_function() -> ic::commit_queue::commit_function
+        {
+            return [this](const std::vector<ic::replica_update>& _updates) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{latency_in_ms});
+
+                if (fail) {
+                    THROW(SYS_LIBRARY_ERROR, "commit failed");
+                }
+
+                // Batches are committed one at a time.
+                ++batches;
+
+                for (auto&& u : _updates) {
+                    sizes[u.data_id] = u.size.value_or(-1);
+                    ++updates;
+                }
+            };
+        }
+
+        int latency_in_ms = 0;
+        bool fail = false;
+
+        std::atomic<std::size_t> batches{0};
+        std::atomic<std::size_t> updates{0};
+        std::array<std::int64_t, 64> sizes{};
+    };
+
+    // Unmaps the fake catalog at the end of a test.
+    struct scoped_catalog
+    {
+        scoped_catalog()
+            : catalog{fake_catalog::create()}
+        {
+        }
+
+        ~scoped_catalog()
+        {
+            fake_catalog::destroy(catalog);
+        }
+
+        fake_catalog* catalog;
+    };
+
+    auto make_update(std::uint64_t _data_id, std::int64_t _size) -> ic::replica_update
+    {
+        ic::replica_update u;
+        u.data_id = _data_id;
+        u.resc_id = 10001;
+        u.size = _size;
+        u.replica_status = 1;
+        return u;
+    }
+} // anonymous namespace
+
+TEST_CASE("commit modes are parsed")
+{
+    CHECK(ic::to_commit_mode("immediate") == ic::commit_mode::immediate);
+    CHECK(ic::to_commit_mode("group") == ic::commit_mode::group);
+    CHECK_THROWS_AS(ic::to_commit_mode("deferred"), irods::exception);
+    CHECK_THROWS_AS(ic::to_commit_mode("lazy"), irods::exception);
+}
+
+TEST_CASE("commit_queue rejects invalid parameters")
+{
+    scoped_catalog sc;
+
+    CHECK_THROWS_AS(ic::commit_queue(0, sc.catalog->commit_function()), irods::exception);
+    CHECK_THROWS_AS(ic::commit_queue(16, nullptr), irods::exception);
+}
+
+TEST_CASE("commit_queue commits an update by itself when nothing else is queued")
+{
+    scoped_catalog sc;
+    auto& catalog = *sc.catalog;
+
+    ic::commit_queue queue{16, catalog.commit_function()};
+
+    CHECK(queue.submit(make_update(1, 100)) == 0);
+    CHECK(queue.submit(make_update(2, 200)) == 0);
+    CHECK(catalog.batches == 2);
+    CHECK(catalog.sizes[2] == 200);
+
+    SECTION("a failed commit is reported to the update waiting for it")
+    {
+        catalog.fail = true;
+        CHECK(queue.submit(make_update(3, 300)) == SYS_LIBRARY_ERROR);
+
+        catalog.fail = false;
+        CHECK(queue.submit(make_update(3, 300)) == 0);
+        CHECK(catalog.sizes[3] == 300);
+    }
+}
+
+TEST_CASE("commit_queue groups the updates of concurrent threads")
+{
+    scoped_catalog sc;
+    auto& catalog = *sc.catalog;
+    catalog.latency_in_ms = 5;
+
+    constexpr int thread_count = 8;
+    constexpr int updates_per_thread = 25;
+
+    ic::commit_queue queue{4, catalog.commit_function()};
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < updates_per_thread; ++i) {
+                // Every thread updates one replica over and over.
+                if (queue.submit(make_update(t, i)) != 0) {
+                    ++failures;
+                }
+            }
+        });
+    }
+
+    for (auto&& t : threads) {
+        t.join();
+    }
+
+    CHECK(failures == 0);
+    CHECK(catalog.updates == thread_count * updates_per_thread);
+    CHECK(catalog.batches < thread_count * updates_per_thread);
+
+    // No batch holds more updates than the maximum.
+    CHECK(catalog.batches * queue.max_batch_size() >= catalog.updates);
+
+    // The last update of each replica is the one committed last.
+    for (int t = 0; t < thread_count; ++t) {
+        CHECK(catalog.sizes[t] == updates_per_thread - 1);
+    }
+}
+
+TEST_CASE("commit_queue groups the updates of forked processes")
+{
+    scoped_catalog sc;
+    auto& catalog = *sc.catalog;
+    catalog.latency_in_ms = 5;
+
+    constexpr int process_count = 6;
+    constexpr int updates_per_process = 20;
+
+    ic::commit_queue queue{64, catalog.commit_function()};
+
+    std::vector<pid_t> children;
+
+    for (int p = 0; p < process_count; ++p) {
+        const auto pid = fork();
+        REQUIRE(pid >= 0);
+
+        if (0 == pid) {
+            int failures = 0;
+
+            for (int i = 0; i < updates_per_process; ++i) {
+                if (queue.submit(make_update(p, i)) != 0) {
+                    ++failures;
+                }
+            }
+
+            _exit(failures);
+        }
+
+        children.push_back(pid);
+    }
+
+    for (auto pid : children) {
+        int status = 0;
+        REQUIRE(waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+    }
+
+    CHECK(catalog.updates == process_count * updates_per_process);
+    CHECK(catalog.batches < process_count * updates_per_process);
+
+    for (int p = 0; p < process_count; ++p) {
+        CHECK(catalog.sizes[p] == updates_per_process - 1);
+    }
+}
+
+TEST_CASE("commit_queue abandons the batch of a process which died while committing it")
+{
+    scoped_catalog sc;
+    auto& catalog = *sc.catalog;
+
+    const auto parent = getpid();
+
+    ic::commit_queue queue{16, [&catalog, parent](const std::vector<ic::replica_update>& _updates) {
+        // The child dies in the middle of its commit.
+        if (getpid() != parent) {
+            _exit(0);
+        }
+
+        catalog.commit_function()(_updates);
+    }};
+
+    const auto pid = fork();
+    REQUIRE(pid >= 0);
+
+    if (0 == pid) {
+        queue.submit(make_update(1, 100));
+        _exit(1);
+    }
+
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WEXITSTATUS(status) == 0);
+
+    // The next update notices that the committer is gone and commits in its place.
+    CHECK(queue.submit(make_update(2, 200)) == 0);
+    CHECK(catalog.sizes[2] == 200);
+    CHECK(catalog.sizes[1] == 0);
+}
@@ -0,0 +1,144 @@
+#include "catch.hpp"
+
+#include "concurrent_transfer_scheduler.hpp"
+#include "getRodsEnv.h"
+#include "rodsErrorTable.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // A restart file in /tmp, as iput and iget keep one with --retries.
+    struct restart_file
+    {
+        restart_file()
+            : restart{}
+        {
+            char path[] = "/tmp/irods_concurrent_transfer_scheduler_XXXXXX";
+            restart.fd = mkstemp(path);
+            REQUIRE(restart.fd > 0);
+            std::strncpy(restart.restartFile, path, MAX_NAME_LEN - 1);
+        }
+
+        ~restart_file()
+        {
+            close(restart.fd);
+            unlink(restart.restartFile);
+        }
+
+        rodsRestart_t restart;
+    };
+
+    auto path_of(int _i) -> std::string
+    {
+        return "/tempZone/home/rods/file_" + std::to_string(_i);
+    }
+
+    // Transfers which complete in the reverse order of their submission.
+    auto reversed(int _i, int _count) -> irods::concurrent_transfer_scheduler::transfer_function
+    {
+        return [delay = (_count - _i) * 5ms](rcComm_t&) {
+            std::this_thread::sleep_for(delay);
+            return 0;
+        };
+    }
+} // anonymous namespace
+
+TEST_CASE("concurrent_transfer_scheduler records transfers in submission order")
+{
+    rodsEnv env;
+    _getRodsEnv(env);
+
+    restart_file rf;
+    constexpr int count = 12;
+
+    irods::concurrent_transfer_scheduler scheduler{4, env, rf.restart};
+
+    for (int i = 0; i < count; ++i) {
+        REQUIRE(scheduler.submit(path_of(i), 0, reversed(i % 4, 4)) == 0);
+
+        // The restart point only ever names the last of a contiguous run of
+        // completed transfers.
+        if (rf.restart.doneCnt > 0) {
+            CHECK(rf.restart.lastDonePath == path_of(rf.restart.doneCnt - 1));
+        }
+    }
+
+    REQUIRE(scheduler.wait() == 0);
+    CHECK(rf.restart.doneCnt == count);
+    CHECK(rf.restart.lastDonePath == path_of(count - 1));
+}
+
+TEST_CASE("concurrent_transfer_scheduler pins the restart point at a failed transfer")
+{
+    rodsEnv env;
+    _getRodsEnv(env);
+
+    restart_file rf;
+
+    irods::concurrent_transfer_scheduler scheduler{4, env, rf.restart};
+
+    int ec = 0;
+    for (int i = 0; i < 20 && ec == 0; ++i) {
+        ec = scheduler.submit(path_of(i), 0, [i](rcComm_t&) {
+            std::this_thread::sleep_for(5ms);
+            return 2 == i ? SYS_COPY_LEN_ERR : 0;
+        });
+    }
+
+    // Submission stops once the failure is seen, instead of waiting for the
+    // window to drain past it.
+    CHECK(ec == SYS_COPY_LEN_ERR);
+    CHECK(scheduler.wait() == SYS_COPY_LEN_ERR);
+
+    // The transfers completed after the failure are not recorded.
+    CHECK(rf.restart.doneCnt == 2);
+    CHECK(rf.restart.lastDonePath == path_of(1));
+}
+
+TEST_CASE("concurrent_transfer_scheduler keeps going after a failure without a restart file")
+{
+    rodsEnv env;
+    _getRodsEnv(env);
+
+    rodsRestart_t restart{};
+
+    irods::concurrent_transfer_scheduler scheduler{2, env, restart};
+
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(scheduler.submit(path_of(i), 0, [i](rcComm_t&) { return 0 == i ? SYS_COPY_LEN_ERR : 0; }) == 0);
+    }
+
+    CHECK(scheduler.wait() == SYS_COPY_LEN_ERR);
+    CHECK(restart.doneCnt == 0);
+}
+
+TEST_CASE("concurrent_transfer_scheduler forces the transfers after a resume")
+{
+    rodsEnv env;
+    _getRodsEnv(env);
+
+    rodsRestart_t restart{};
+
+    irods::concurrent_transfer_scheduler scheduler{3, env, restart};
+    CHECK_FALSE(scheduler.overwrite_required());
+
+    // Up to max_in_flight() transfers may have completed past the restart point.
+    scheduler.resumed();
+
+    for (int i = 0; i < scheduler.max_in_flight(); ++i) {
+        CHECK(scheduler.overwrite_required());
+    }
+
+    CHECK_FALSE(scheduler.overwrite_required());
+}
@@ -0,0 +1,258 @@
+#include "catch.hpp"
+
+#include "coprocess.hpp"
+#include "irods_exception.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+    // A driver in the style of univMSSInterface.sh. When arguments are passed, it runs
+    // a single operation like the script executed by rsExecCmd. Otherwise it serves
+    // length-prefixed requests read from its standard input.
+    constexpr const char* mock_driver = R"(#!/bin/bash
+export LC_ALL=C
+
+run () {
+    case "$1" in
+        mkdir|chmod|rm|mv|syncToArch|stageToCache) status=0; output="" ;;
+        stat)  status=0; output="2049:1234:33188:1:1000:1000:0:$((${#2} * 10)):4096:8:2021-01-01-00.00.00:2021-01-01-00.00.00:2021-01-01-00.00.00" ;;
+        echo)  status=0; output="${*:2}" ;;
+        big)   status=0; printf -v output '%*s' 100000 ''; output=${output// /x} ;;
+        fail)  status=3; output="failed" ;;
+        exit)  exit 0 ;;
+        *)     status=1; output="unknown operation" ;;
+    esac
+}
+
+if [ $# -gt 0 ]; then
+    run "$@"
+    printf '%s' "$output"
+    exit $status
+fi
+
+while read -r length && read -r -N "$length" payload; do
+    IFS=$'\n' read -r -d '' -a lines <<< "$payload"
+    id=${lines[0]%% *}
+    run "${lines[0]#* }" "${lines[@]:1}"
+    response="$id $status"$'\n'"$output"
+    printf '%d\n%s' "${#response}" "$response"
+done
+)";
+
+    auto write_mock_driver(const fs::path& _dir) -> std::string
+    {
+        const auto path = _dir / "mock_driver.sh";
+
+        {
+            std::ofstream out{path.c_str()};
+            out << mock_driver;
+        }
+
+        fs::permissions(path, fs::owner_all);
+
+        return path.string();
+    }
+
+    struct temp_directory
+    {
+        temp_directory()
+            : path{fs::temp_directory_path() / fs::unique_path("irods_coprocess_%%%%-%%%%")}
+        {
+            fs::create_directory(path);
+        }
+
+        ~temp_directory()
+        {
+            fs::remove_all(path);
+        }
+
+        fs::path path;
+    };
+} // anonymous namespace
+
+TEST_CASE("coprocess")
+{
+    temp_directory dir;
+    const auto driver = write_mock_driver(dir.path);
+
+    irods::coprocess cp{driver};
+    REQUIRE(cp.running());
+
+    SECTION("requests receive the output and status of their operation")
+    {
+        const auto r = cp.call("echo", {"a b", "c"});
+        CHECK(r.status == 0);
+        CHECK(r.output == "a b c");
+
+        const auto failed = cp.call("fail", {});
+        CHECK(failed.status == 3);
+        CHECK(failed.output == "failed");
+
+        CHECK(cp.call("mkdir", {"/archive/dir"}).status == 0);
+        CHECK(cp.call("unknown", {}).status == 1);
+    }
+
+    SECTION("pipelined requests are matched to their responses")
+    {
+        constexpr int requests = 2000;
+
+        std::vector<std::uint64_t> ids;
+        for (int i = 0; i < requests; ++i) {
+            ids.push_back(cp.submit("echo", {std::to_string(i)}));
+        }
+
+        // The responses fill the socket buffers long before the last request is sent.
+        for (int i = requests - 1; i >= 0; --i) {
+            const auto r = cp.wait(ids[i]);
+            REQUIRE(r.status == 0);
+            REQUIRE(r.output == std::to_string(i));
+        }
+    }
+
+    SECTION("responses may be larger than the socket buffers")
+    {
+        const auto r = cp.call("big", {});
+        CHECK(r.status == 0);
+        CHECK(r.output == std::string(100000, 'x'));
+    }
+
+    SECTION("arguments cannot contain newlines")
+    {
+        CHECK_THROWS_AS(cp.submit("echo", {"a\nb"}), irods::exception);
+        CHECK(cp.running());
+    }
+
+    SECTION("the coprocess fails when the program exits")
+    {
+        CHECK_THROWS_AS(cp.call("exit", {}), irods::exception);
+        CHECK_FALSE(cp.running());
+        CHECK_THROWS_AS(cp.call("echo", {"x"}), irods::exception);
+    }
+
+    SECTION("the program is stopped by the destructor")
+    {
+        pid_t pid;
+
+        {
+            irods::coprocess other{driver};
+            pid = other.pid();
+            CHECK(other.call("echo", {"x"}).output == "x");
+        }
+
+        // The program has exited and been reaped.
+        CHECK(kill(pid, 0) < 0);
+        CHECK(0 == kill(cp.pid(), 0));
+    }
+}
+
+TEST_CASE("coprocess startup failure")
+{
+    CHECK_THROWS_AS(irods::coprocess{"/nonexistent/driver"}, irods::exception);
+}
+
+TEST_CASE("get_coprocess")
+{
+    temp_directory dir;
+    const auto driver = write_mock_driver(dir.path);
+
+    auto& cp = irods::get_coprocess(driver);
+    CHECK(&cp == &irods::get_coprocess(driver));
+
+    const auto pid = cp.pid();
+
+    SECTION("a failed coprocess is restarted")
+    {
+        CHECK_THROWS(cp.call("exit", {}));
+        CHECK(irods::get_coprocess(driver).call("echo", {"x"}).output == "x");
+    }
+
+    SECTION("a forked child starts its own coprocess and leaves the parent's alone")
+    {
+        const pid_t child = fork();
+
+        if (0 == child) {
+            auto& mine = irods::get_coprocess(driver);
+            const bool ok = mine.pid() != pid && mine.call("echo", {"x"}).output == "x";
+            std::exit(ok ? 0 : 1);
+        }
+
+        int status{};
+        REQUIRE(waitpid(child, &status, 0) == child);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+
+        CHECK(irods::get_coprocess(driver).pid() == pid);
+        CHECK(irods::get_coprocess(driver).call("echo", {"y"}).output == "y");
+    }
+}
+
+// Compares sending operations to a long-lived driver with executing the driver for
+// every operation, as the univmss resource does through rsExecCmd.
+//
+// Run with: irods_coprocess "[benchmark]"
+TEST_CASE("coprocess benchmark", "[.][benchmark]")
+{
+    temp_directory dir;
+    const auto driver = write_mock_driver(dir.path);
+
+    constexpr int operations = 2000;
+
+    const auto measure = [](auto&& _func) {
+        const auto start = std::chrono::steady_clock::now();
+        _func();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / operations;
+    };
+
+    const auto fork_per_operation = measure([&] {
+        for (int i = 0; i < operations; ++i) {
+            const auto path = "/archive/file_" + std::to_string(i);
+            char* argv[] = {const_cast<char*>(driver.c_str()), const_cast<char*>("stat"), const_cast<char*>(path.c_str()), nullptr};
+
+            pid_t pid;
+            REQUIRE(posix_spawn(&pid, driver.c_str(), nullptr, nullptr, argv, environ) == 0);
+
+            int status{};
+            REQUIRE(waitpid(pid, &status, 0) == pid);
+            REQUIRE(WEXITSTATUS(status) == 0);
+        }
+    });
+
+    irods::coprocess cp{driver};
+
+    const auto one_at_a_time = measure([&] {
+        for (int i = 0; i < operations; ++i) {
+            REQUIRE(cp.call("stat", {"/archive/file_" + std::to_string(i)}).status == 0);
+        }
+    });
+
+    const auto pipelined = measure([&] {
+        std::vector<std::uint64_t> ids;
+        for (int i = 0; i < operations; ++i) {
+            ids.push_back(cp.submit("stat", {"/archive/file_" + std::to_string(i)}));
+        }
+
+        for (auto id : ids) {
+            REQUIRE(cp.wait(id).status == 0);
+        }
+    });
+
+    WARN("stat: " << fork_per_operation << " us per operation with one process per operation, "
+                  << one_at_a_time << " us with a coprocess, "
+                  << pipelined << " us with pipelined requests");
+}
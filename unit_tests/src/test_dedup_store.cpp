@@ -0,0 +1,253 @@
+#include "catch.hpp"
+
+#include "dedup_store.hpp"
+#include "irods_exception.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace dd = irods::experimental::dedup;
+namespace fs = boost::filesystem;
+
+namespace
+{
+    struct temp_directory
+    {
+        temp_directory()
+            : path{fs::temp_directory_path() / fs::unique_path("irods_dedup_store_%%%%-%%%%")}
+        {
+            fs::create_directory(path);
+        }
+
+        ~temp_directory()
+        {
+            fs::remove_all(path);
+        }
+
+        fs::path path;
+    };
+
+    auto make_input(std::size_t _size, std::uint32_t _seed = 42) -> std::vector<unsigned char>
+    {
+        std::mt19937 gen{_seed};
+        std::uniform_int_distribution<int> dist{0, 255};
+
+        std::vector<unsigned char> data(_size);
+        std::generate(std::begin(data), std::end(data), [&] { return static_cast<unsigned char>(dist(gen)); });
+
+        return data;
+    }
+
+    // Returns the chunks of _data as (offset, size) pairs.
+    auto cut(const dd::chunker& _chunker, const std::vector<unsigned char>& _data)
+        -> std::vector<std::pair<std::size_t, std::size_t>>
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> chunks;
+
+        for (std::size_t offset = 0; offset < _data.size();) {
+            const auto size = _chunker.next(_data.data() + offset, _data.size() - offset);
+            chunks.emplace_back(offset, size);
+            offset += size;
+        }
+
+        return chunks;
+    }
+
+    auto chunk_digests(const dd::chunker& _chunker, const std::vector<unsigned char>& _data) -> std::set<std::string>
+    {
+        std::set<std::string> digests;
+
+        for (auto&& [offset, size] : cut(_chunker, _data)) {
+            digests.insert(dd::to_hex(dd::hash(_data.data() + offset, size)));
+        }
+
+        return digests;
+    }
+
+    auto write_file(const fs::path& _path, const std::vector<unsigned char>& _data) -> int
+    {
+        const int fd = ::open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        REQUIRE(fd >= 0);
+        REQUIRE(::write(fd, _data.data(), _data.size()) == static_cast<ssize_t>(_data.size()));
+        return fd;
+    }
+} // anonymous namespace
+
+TEST_CASE("hash")
+{
+    const std::string abc = "abc";
+    CHECK(dd::to_hex(dd::hash(abc.data(), abc.size())) ==
+          "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST_CASE("chunker")
+{
+    const dd::chunker chunker{dd::chunking_parameters{}};
+    const auto data = make_input(8 * 1024 * 1024);
+
+    SECTION("chunks lie within the configured sizes")
+    {
+        const auto chunks = cut(chunker, data);
+
+        for (std::size_t i = 0; i + 1 < chunks.size(); ++i) {
+            CHECK(chunks[i].second >= 16 * 1024);
+            CHECK(chunks[i].second <= 256 * 1024);
+        }
+
+        // Normalized chunking keeps the mean near the average size.
+        const auto mean = data.size() / chunks.size();
+        CHECK(mean > 32 * 1024);
+        CHECK(mean < 128 * 1024);
+    }
+
+    SECTION("an insertion only changes the chunks around it")
+    {
+        auto shifted = data;
+        const auto insertion = make_input(100, 7);
+        shifted.insert(std::begin(shifted) + data.size() / 2, std::begin(insertion), std::end(insertion));
+
+        const auto before = chunk_digests(chunker, data);
+        const auto after = chunk_digests(chunker, shifted);
+
+        std::vector<std::string> common;
+        std::set_intersection(std::begin(before), std::end(before), std::begin(after), std::end(after),
+                              std::back_inserter(common));
+
+        CHECK(before.size() - common.size() <= 2);
+    }
+
+    SECTION("invalid sizes are rejected")
+    {
+        CHECK_THROWS_AS(dd::chunker(dd::chunking_parameters{64 * 1024, 64 * 1024, 256 * 1024}), irods::exception);
+        CHECK_THROWS_AS(dd::chunker(dd::chunking_parameters{16 * 1024, 60 * 1024, 256 * 1024}), irods::exception);
+    }
+}
+
+TEST_CASE("chunk_store")
+{
+    temp_directory dir;
+    dd::chunk_store store{dir.path.string()};
+
+    const std::string data = "the content of a chunk";
+    const auto id = dd::hash(data.data(), data.size());
+
+    SECTION("chunks are stored once and removed with their last reference")
+    {
+        CHECK(store.add(id, data.data(), data.size()));
+        CHECK_FALSE(store.add(id, data.data(), data.size()));
+
+        const auto content = store.read(id, data.size());
+        CHECK(std::string(std::begin(content), std::end(content)) == data);
+
+        CHECK(store.release(id) == 0);
+        CHECK(fs::exists(store.path(id)));
+
+        CHECK(store.release(id) == static_cast<std::int64_t>(data.size()));
+        CHECK_FALSE(fs::exists(store.path(id)));
+
+        // Releasing a chunk which is gone is not an error.
+        CHECK(store.release(id) == 0);
+    }
+
+    SECTION("reading a missing chunk throws")
+    {
+        CHECK_THROWS_AS(store.read(id, data.size()), irods::exception);
+    }
+}
+
+TEST_CASE("ingest and read back")
+{
+    temp_directory dir;
+    dd::chunk_store store{(dir.path / "store").string()};
+    const dd::chunker chunker{dd::chunking_parameters{}};
+
+    const auto data = make_input(4 * 1024 * 1024 + 123);
+    const int fd = write_file(dir.path / "file", data);
+
+    const auto first = dd::ingest(store, chunker, fd);
+    CHECK(first.file.size == static_cast<std::int64_t>(data.size()));
+    CHECK(first.new_bytes == first.file.size);
+
+    // The same content again stores nothing new.
+    const auto second = dd::ingest(store, chunker, fd);
+    CHECK(second.new_bytes == 0);
+    CHECK(second.new_chunks == 0);
+    ::close(fd);
+
+    auto stats = store.statistics();
+    CHECK(stats.logical_bytes == 2 * first.file.size);
+    CHECK(stats.stored_bytes == first.file.size);
+    CHECK(stats.dedup_ratio() == Approx(2.0));
+
+    SECTION("manifests round trip")
+    {
+        const auto path = (dir.path / "manifest").string();
+        dd::write_manifest(path, first.file, 0600);
+
+        const auto m = dd::read_manifest(path);
+        REQUIRE(m);
+        CHECK(m->size == first.file.size);
+        REQUIRE(m->entries.size() == first.file.entries.size());
+        CHECK(std::equal(std::begin(m->entries), std::end(m->entries), std::begin(first.file.entries),
+                         [](auto&& _a, auto&& _b) { return _a.id == _b.id && _a.size == _b.size; }));
+        CHECK(dd::read_manifest_size(path) == first.file.size);
+
+        // Plain files are not manifests.
+        CHECK_FALSE(dd::read_manifest((dir.path / "file").string()));
+    }
+
+    SECTION("reassemble restores the content")
+    {
+        const auto out = dir.path / "reassembled";
+        const int out_fd = ::open(out.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        REQUIRE(out_fd >= 0);
+        dd::reassemble(store, first.file, out_fd);
+
+        std::vector<unsigned char> content(data.size() + 1);
+        CHECK(::pread(out_fd, content.data(), content.size(), 0) == static_cast<ssize_t>(data.size()));
+        content.resize(data.size());
+        CHECK(content == data);
+        ::close(out_fd);
+    }
+
+    SECTION("the reader returns any range of the content")
+    {
+        dd::manifest_reader reader{store, first.file, 4, 4};
+        CHECK(reader.size() == first.file.size);
+
+        std::vector<unsigned char> content(data.size());
+        std::size_t offset = 0;
+        while (offset < content.size()) {
+            // A size which does not divide the chunks evenly.
+            const auto n = reader.read(offset, content.data() + offset, std::min<std::size_t>(100'003, content.size() - offset));
+            REQUIRE(n > 0);
+            offset += n;
+        }
+        CHECK(content == data);
+
+        std::vector<unsigned char> tail(1000);
+        CHECK(reader.read(data.size() - 10, tail.data(), tail.size()) == 10);
+        CHECK(std::equal(std::begin(tail), std::begin(tail) + 10, std::end(data) - 10));
+
+        CHECK(reader.read(data.size(), tail.data(), tail.size()) == 0);
+    }
+
+    SECTION("releasing the manifests removes the chunks")
+    {
+        dd::release(store, first.file);
+        dd::release(store, second.file);
+
+        stats = store.statistics();
+        CHECK(stats.logical_bytes == 0);
+        CHECK(stats.stored_bytes == 0);
+        CHECK(stats.chunks == 0);
+    }
+}
@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include "direct_io.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    namespace dio = irods::direct_io;
+
+    auto make_pattern(std::size_t _size) -> std::vector<char>
+    {
+        std::vector<char> data(_size);
+        std::mt19937 gen{1234};
+        std::generate(std::begin(data), std::end(data), [&gen] { return static_cast<char>(gen()); });
+        return data;
+    }
+} // anonymous namespace
+
+TEST_CASE("direct_io")
+{
+    // O_DIRECT is not supported by every file system (e.g. tmpfs), so the test file
+    // is created in the working directory rather than in /tmp.
+    std::string path = "irods_test_direct_io_XXXXXX";
+    const int fd = mkstemp(path.data());
+    REQUIRE(fd >= 0);
+
+    const int direct_fd = dio::open_companion(path.c_str(), O_RDWR);
+
+    if (direct_fd < 0) {
+        WARN("O_DIRECT is not supported in the working directory. Only the page cache path is tested.");
+    }
+
+    dio::config config;
+    config.enabled = true;
+    config.alignment = 4096;
+    config.minimum_size = 64 * 1024;
+
+    const irods::io_engine::config io_config;
+
+    // One byte past the start so that the source buffer is never aligned, which
+    // forces the bounce buffer to be used.
+    const auto storage = make_pattern(3 * 1024 * 1024 + 4321 + 1);
+    const char* data = storage.data() + 1;
+    const rodsLong_t size = storage.size() - 1;
+
+    SECTION("unaligned write produces the same file as a buffered write")
+    {
+        constexpr off_t start = 1000;
+        REQUIRE(lseek(fd, start, SEEK_SET) == start);
+
+        REQUIRE(dio::write(config, io_config, fd, direct_fd, data, size) == size);
+        CHECK(lseek(fd, 0, SEEK_CUR) == start + size);
+
+        struct stat st{};
+        REQUIRE(fstat(fd, &st) == 0);
+        CHECK(st.st_size == start + size);
+
+        std::vector<char> out(size);
+        REQUIRE(pread(fd, out.data(), out.size(), start) == size);
+        CHECK(std::equal(std::begin(out), std::end(out), data));
+    }
+
+    SECTION("read stops at end-of-file and advances the file position")
+    {
+        REQUIRE(pwrite(fd, data, size, 0) == size);
+
+        constexpr off_t start = 5;
+        REQUIRE(lseek(fd, start, SEEK_SET) == start);
+
+        std::vector<char> out(size + 8192);
+        REQUIRE(dio::read(config, io_config, fd, direct_fd, out.data() + 1, size) == size - start);
+        CHECK(lseek(fd, 0, SEEK_CUR) == size);
+        CHECK(std::equal(data + start, data + size, out.data() + 1));
+
+        CHECK(dio::read(config, io_config, fd, direct_fd, out.data(), size) == 0);
+    }
+
+    SECTION("small requests use the page cache")
+    {
+        REQUIRE(dio::write(config, io_config, fd, direct_fd, data, 100) == 100);
+        CHECK(lseek(fd, 0, SEEK_CUR) == 100);
+    }
+
+    if (direct_fd >= 0) {
+        close(direct_fd);
+    }
+
+    close(fd);
+    unlink(path.c_str());
+}
@@ -12,8 +12,13 @@
 #include <boost/filesystem.hpp>
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <thread>
 
 #include <unistd.h>
 
@@ -23,6 +28,120 @@ namespace io = irods::experimental::io;
 auto get_hostname() noexcept -> std::string;
 auto create_resource_vault(const std::string& _vault_name) -> boost::filesystem::path;
 
+namespace
+{
+    // A transport backed by a string. Each call sleeps for "latency" to mimic a
+    // round trip to the server.
+    class memory_transport : public io::transport<char>
+    {
+    public:
+        explicit memory_transport(std::chrono::microseconds _latency = {})
+            : latency_{_latency}
+        {
+        }
+
+        // clang-format off
+        bool open(const fs::path&, std::ios_base::openmode) override                                    { return do_open(); }
+        bool open(const fs::path&, const io::replica_number&, std::ios_base::openmode) override         { return do_open(); }
+        bool open(const fs::path&, const io::root_resource_name&, std::ios_base::openmode) override     { return do_open(); }
+        bool open(const fs::path&, const io::leaf_resource_name&, std::ios_base::openmode) override     { return do_open(); }
+        bool open(const io::replica_token&, const fs::path&, const io::replica_number&, std::ios_base::openmode) override     { return do_open(); }
+        bool open(const io::replica_token&, const fs::path&, const io::leaf_resource_name&, std::ios_base::openmode) override { return do_open(); }
+        // clang-format on
+
+        bool close(const io::on_close_success* = nullptr) override
+        {
+            open_ = false;
+            return true;
+        }
+
+        std::streamsize receive(char* _buffer, std::streamsize _buffer_size) override
+        {
+            simulate_round_trip();
+
+            const auto n = std::min<std::streamsize>(_buffer_size, data.size() - position_);
+            std::copy_n(data.data() + position_, n, _buffer);
+            position_ += n;
+
+            return n;
+        }
+
+        std::streamsize send(const char* _buffer, std::streamsize _buffer_size) override
+        {
+            simulate_round_trip();
+
+            if (position_ + _buffer_size > static_cast<std::streamsize>(data.size())) {
+                data.resize(position_ + _buffer_size);
+            }
+
+            std::copy_n(_buffer, _buffer_size, data.data() + position_);
+            position_ += _buffer_size;
+
+            return _buffer_size;
+        }
+
+        pos_type seekpos(off_type _offset, std::ios_base::seekdir _dir) override
+        {
+            simulate_round_trip();
+
+            switch (_dir) {
+                case std::ios_base::beg: position_ = _offset; break;
+                case std::ios_base::cur: position_ += _offset; break;
+                default:                 position_ = data.size() + _offset; break;
+            }
+
+            return position_;
+        }
+
+        // clang-format off
+        bool is_open() const noexcept override                           { return open_; }
+        int file_descriptor() const noexcept override                    { return 3; }
+        const io::root_resource_name& root_resource_name() const override { return root_resc_; }
+        const io::leaf_resource_name& leaf_resource_name() const override { return leaf_resc_; }
+        const io::replica_number& replica_number() const override         { return replica_number_; }
+        const io::replica_token& replica_token() const override           { return replica_token_; }
+        // clang-format on
+
+        std::string data;
+        std::atomic<int> round_trips{0};
+
+    private:
+        bool do_open()
+        {
+            position_ = 0;
+            return open_ = true;
+        }
+
+        void simulate_round_trip()
+        {
+            ++round_trips;
+
+            if (latency_.count() > 0) {
+                std::this_thread::sleep_for(latency_);
+            }
+        }
+
+        std::chrono::microseconds latency_;
+        std::streamsize position_ = 0;
+        bool open_ = false;
+        io::root_resource_name root_resc_;
+        io::leaf_resource_name leaf_resc_;
+        io::replica_number replica_number_{0};
+        io::replica_token replica_token_;
+    }; // class memory_transport
+
+    auto make_lines(int _count) -> std::string
+    {
+        std::string lines;
+
+        for (int i = 0; i < _count; ++i) {
+            lines += "line number " + std::to_string(i) + '\n';
+        }
+
+        return lines;
+    }
+} // anonymous namespace
+
 TEST_CASE("dstream", "[iostreams]")
 {
     load_client_api_plugins();
@@ -292,6 +411,173 @@ TEST_CASE("dstream", "[iostreams]")
     }
 }
 
+TEST_CASE("dstream buffering", "[iostreams]")
+{
+    const auto async = GENERATE(false, true);
+    const auto buffer_size = GENERATE(1, 7, 4096, 64 * 1024);
+
+    memory_transport tp;
+    const auto expected = make_lines(5000);
+
+    SECTION("line by line writes are coalesced")
+    {
+        {
+            io::odstream out;
+            REQUIRE(out.rdbuf()->pubsetbuf(nullptr, buffer_size));
+            out.rdbuf()->asynchronous_io(async);
+            out.open(tp, "/tempZone/home/rods/foo");
+            REQUIRE(out);
+
+            std::istringstream lines{expected};
+
+            for (std::string line; std::getline(lines, line);) {
+                out << line << '\n';
+            }
+        }
+
+        CHECK(tp.data == expected);
+        CHECK(tp.round_trips <= static_cast<int>(expected.size() / buffer_size) + 1);
+    }
+
+    SECTION("formatted reads see every byte")
+    {
+        tp.data = expected;
+
+        io::idstream in;
+        REQUIRE(in.rdbuf()->pubsetbuf(nullptr, buffer_size));
+        in.rdbuf()->asynchronous_io(async);
+        in.open(tp, "/tempZone/home/rods/foo");
+        REQUIRE(in);
+
+        std::string contents;
+        for (std::string line; std::getline(in, line);) {
+            contents += line + '\n';
+        }
+
+        CHECK(contents == expected);
+    }
+
+    SECTION("tellg and seekg account for buffered input")
+    {
+        tp.data = expected;
+
+        io::idstream in;
+        REQUIRE(in.rdbuf()->pubsetbuf(nullptr, buffer_size));
+        in.rdbuf()->asynchronous_io(async);
+        in.open(tp, "/tempZone/home/rods/foo");
+
+        std::string word;
+        REQUIRE(in >> word);
+        CHECK(in.tellg() == static_cast<std::streamoff>(word.size()));
+
+        REQUIRE(in.seekg(1000));
+        std::string buf(100, '\0');
+        REQUIRE(in.read(buf.data(), buf.size()));
+        CHECK(buf == expected.substr(1000, 100));
+        CHECK(in.tellg() == 1100);
+    }
+
+    SECTION("writing after reading starts at the read position")
+    {
+        tp.data = expected;
+
+        {
+            io::dstream ds;
+            REQUIRE(ds.rdbuf()->pubsetbuf(nullptr, buffer_size));
+            ds.rdbuf()->asynchronous_io(async);
+            ds.open(tp, "/tempZone/home/rods/foo");
+
+            std::string buf(10, '\0');
+            REQUIRE(ds.read(buf.data(), buf.size()));
+            REQUIRE(ds.write("XYZ", 3));
+        }
+
+        CHECK(tp.data.size() == expected.size());
+        CHECK(tp.data.substr(0, 13) == expected.substr(0, 10) + "XYZ");
+        CHECK(tp.data.substr(13) == expected.substr(13));
+    }
+
+    SECTION("large reads and writes bypass the buffer")
+    {
+        const std::string big(3 * buffer_size + 5, 'x');
+
+        {
+            io::odstream out;
+            REQUIRE(out.rdbuf()->pubsetbuf(nullptr, buffer_size));
+            out.rdbuf()->asynchronous_io(async);
+            out.open(tp, "/tempZone/home/rods/foo");
+            REQUIRE(out.write("ab", 2));
+            REQUIRE(out.write(big.data(), big.size()));
+        }
+
+        CHECK(tp.data == "ab" + big);
+
+        io::idstream in;
+        REQUIRE(in.rdbuf()->pubsetbuf(nullptr, buffer_size));
+        in.rdbuf()->asynchronous_io(async);
+        in.open(tp, "/tempZone/home/rods/foo");
+
+        std::string out(tp.data.size() + 10, '\0');
+        in.read(out.data(), out.size());
+        CHECK(in.gcount() == static_cast<std::streamsize>(tp.data.size()));
+        CHECK(out.substr(0, in.gcount()) == tp.data);
+    }
+}
+
+// Compares the old fixed 4 KiB buffer with larger and asynchronous buffers over a
+// transport that takes 200 microseconds per call.
+//
+// Run with: irods_dstream "[benchmark]"
+TEST_CASE("dstream buffering benchmark", "[.][benchmark]")
+{
+    using clock = std::chrono::steady_clock;
+
+    const auto lines = make_lines(200'000);
+
+    const auto run = [&lines](std::size_t _buffer_size, bool _async) {
+        memory_transport tp{std::chrono::microseconds{200}};
+
+        const auto start = clock::now();
+
+        {
+            io::odstream out;
+            out.rdbuf()->pubsetbuf(nullptr, _buffer_size);
+            out.rdbuf()->asynchronous_io(_async);
+            out.open(tp, "/tempZone/home/rods/foo");
+            out << lines;
+        }
+
+        const auto write_time = clock::now() - start;
+
+        std::size_t count = 0;
+
+        {
+            io::idstream in;
+            in.rdbuf()->pubsetbuf(nullptr, _buffer_size);
+            in.rdbuf()->asynchronous_io(_async);
+            in.open(tp, "/tempZone/home/rods/foo");
+
+            for (std::string line; std::getline(in, line);) {
+                ++count;
+            }
+        }
+
+        const auto read_time = clock::now() - start - write_time;
+
+        REQUIRE(count == 200'000);
+
+        using std::chrono::milliseconds;
+        WARN("buffer_size=" << _buffer_size << " async=" << _async
+             << " write_ms=" << std::chrono::duration_cast<milliseconds>(write_time).count()
+             << " read_ms=" << std::chrono::duration_cast<milliseconds>(read_time).count()
+             << " round_trips=" << tp.round_trips);
+    };
+
+    run(4096, false);
+    run(1024 * 1024, false);
+    run(1024 * 1024, true);
+}
+
 auto get_hostname() noexcept -> std::string
 {
     char hostname[250];
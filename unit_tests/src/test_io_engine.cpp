@@ -0,0 +1,171 @@
+#include "catch.hpp"
+
+#include "io_engine.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    namespace io = irods::io_engine;
+
+    auto make_temp_file() -> std::pair<std::string, int>
+    {
+        std::string path = "/tmp/irods_test_io_engine_XXXXXX";
+        const int fd = mkstemp(path.data());
+        REQUIRE(fd >= 0);
+        return {path, fd};
+    }
+
+    auto make_pattern(std::size_t _size) -> std::vector<char>
+    {
+        std::vector<char> data(_size);
+        std::mt19937 gen{42};
+        std::generate(std::begin(data), std::end(data), [&gen] { return static_cast<char>(gen()); });
+        return data;
+    }
+
+    auto make_config(io::engine_type _type) -> io::config
+    {
+        io::config config;
+        config.type = _type;
+        config.queue_depth = 4;
+        config.request_size = 256 * 1024;
+        return config;
+    }
+} // anonymous namespace
+
+TEST_CASE("io_engine")
+{
+    const auto type = GENERATE(io::engine_type::posix, io::engine_type::thread_pool, io::engine_type::io_uring);
+    const auto config = make_config(type);
+
+    auto [path, fd] = make_temp_file();
+
+    // Not a multiple of the request size, so the last piece is a partial one.
+    const auto data = make_pattern(3 * 1024 * 1024 + 1234);
+
+    SECTION("write and read advance the file position")
+    {
+        REQUIRE(io::write(config, fd, data.data(), data.size()) == static_cast<rodsLong_t>(data.size()));
+        CHECK(lseek(fd, 0, SEEK_CUR) == static_cast<off_t>(data.size()));
+
+        REQUIRE(lseek(fd, 0, SEEK_SET) == 0);
+
+        std::vector<char> out(data.size());
+        REQUIRE(io::read(config, fd, out.data(), out.size()) == static_cast<rodsLong_t>(out.size()));
+        CHECK(lseek(fd, 0, SEEK_CUR) == static_cast<off_t>(data.size()));
+        CHECK(data == out);
+    }
+
+    SECTION("read stops at end-of-file")
+    {
+        REQUIRE(io::pwrite(config, fd, data.data(), data.size(), 0) == static_cast<rodsLong_t>(data.size()));
+
+        constexpr rodsLong_t offset = 1024 * 1024;
+        std::vector<char> out(data.size(), 0);
+        REQUIRE(io::pread(config, fd, out.data(), out.size(), offset) == static_cast<rodsLong_t>(data.size() - offset));
+        CHECK(std::equal(std::begin(data) + offset, std::end(data), std::begin(out)));
+        CHECK(lseek(fd, 0, SEEK_CUR) == 0);
+    }
+
+    SECTION("registered buffers")
+    {
+        std::vector<char> buffer = data;
+        io::registered_buffer registration{buffer.data(), buffer.size()};
+
+        REQUIRE(io::pwrite(config, fd, buffer.data(), buffer.size(), 0) == static_cast<rodsLong_t>(buffer.size()));
+
+        std::fill(std::begin(buffer), std::end(buffer), 0);
+        REQUIRE(io::pread(config, fd, buffer.data(), buffer.size(), 0) == static_cast<rodsLong_t>(buffer.size()));
+        CHECK(data == buffer);
+    }
+
+    SECTION("requests are split into more pieces than the queue depth")
+    {
+        for (int depth : {1, 3}) {
+            auto shallow = config;
+            shallow.queue_depth = depth;
+
+            REQUIRE(io::pwrite(shallow, fd, data.data(), data.size(), 0) == static_cast<rodsLong_t>(data.size()));
+
+            std::vector<char> out(data.size());
+            REQUIRE(io::pread(shallow, fd, out.data(), out.size(), 0) == static_cast<rodsLong_t>(out.size()));
+            CHECK(data == out);
+        }
+    }
+
+    SECTION("errors are reported as negative errno values")
+    {
+        std::vector<char> out(data.size());
+        CHECK(io::pread(config, -1, out.data(), out.size(), 0) == -EBADF);
+    }
+
+    close(fd);
+    unlink(path.c_str());
+}
+
+TEST_CASE("io_engine to_engine_type")
+{
+    CHECK(io::to_engine_type("posix") == io::engine_type::posix);
+    CHECK(io::to_engine_type("io_uring") == io::engine_type::io_uring);
+    CHECK(io::to_engine_type("thread_pool") == io::engine_type::thread_pool);
+    CHECK_THROWS(io::to_engine_type("aio"));
+}
+
+// A small fio-like workload: sequential writes followed by random reads in
+// transfer-buffer-sized requests, reported per engine.
+//
+// Run with: irods_io_engine "[benchmark]"
+TEST_CASE("io_engine benchmark - throughput", "[.][benchmark]")
+{
+    using clock_type = std::chrono::steady_clock;
+
+    constexpr rodsLong_t file_size = 512 * 1024 * 1024;
+    constexpr rodsLong_t block_size = 4 * 1024 * 1024;
+    constexpr int block_count = file_size / block_size;
+
+    std::vector<char> buffer = make_pattern(block_size);
+
+    std::vector<int> random_blocks(block_count);
+    std::iota(std::begin(random_blocks), std::end(random_blocks), 0);
+    std::shuffle(std::begin(random_blocks), std::end(random_blocks), std::mt19937{7});
+
+    for (auto type : {io::engine_type::posix, io::engine_type::thread_pool, io::engine_type::io_uring}) {
+        auto config = make_config(type);
+        config.queue_depth = 8;
+        config.request_size = 512 * 1024;
+
+        auto [path, fd] = make_temp_file();
+        io::registered_buffer registration{buffer.data(), buffer.size()};
+
+        const auto write_start = clock_type::now();
+        for (int i = 0; i < block_count; ++i) {
+            REQUIRE(io::pwrite(config, fd, buffer.data(), block_size, i * block_size) == block_size);
+        }
+        fdatasync(fd);
+        const std::chrono::duration<double> write_time = clock_type::now() - write_start;
+
+        const auto read_start = clock_type::now();
+        for (auto i : random_blocks) {
+            REQUIRE(io::pread(config, fd, buffer.data(), block_size, i * block_size) == block_size);
+        }
+        const std::chrono::duration<double> read_time = clock_type::now() - read_start;
+
+        const char* name = (io::engine_type::posix == type) ? "posix" : (io::engine_type::thread_pool == type) ? "thread_pool" : "io_uring";
+        const double mib = static_cast<double>(file_size) / (1024 * 1024);
+
+        WARN(name << ": sequential write " << mib / write_time.count() << " MiB/s, random read "
+                  << mib / read_time.count() << " MiB/s (" << block_count / read_time.count() << " IOPS)");
+
+        close(fd);
+        unlink(path.c_str());
+    }
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include "fileOpr.hpp"
+#include "l1desc_table.hpp"
+#include "rodsErrorTable.h"
+
+#include <set>
+
+TEST_CASE("l1desc_table")
+{
+    irods::l1desc_table table{10};
+
+    SECTION("indices are handed out in ascending order starting after the reserved ones")
+    {
+        CHECK(table.allocate() == irods::l1desc_table::first_index);
+        CHECK(table.allocate() == irods::l1desc_table::first_index + 1);
+        CHECK(table.allocate() == irods::l1desc_table::first_index + 2);
+        CHECK(table[irods::l1desc_table::first_index].inuseFlag == FD_INUSE);
+    }
+
+    SECTION("released indices are reused")
+    {
+        const auto a = table.allocate();
+        const auto b = table.allocate();
+
+        table[a].inuseFlag = FD_FREE;
+        table.release(a);
+
+        CHECK(table.allocate() == a);
+        CHECK(table.allocate() != b);
+    }
+
+    SECTION("the table grows and references remain valid")
+    {
+        const auto first = table.allocate();
+        auto& desc = table[first];
+        desc.l3descInx = 42;
+
+        std::set<int> indices{first};
+        for (int i = 0; i < 2000; ++i) {
+            const auto index = table.allocate();
+            REQUIRE(index > 0);
+            CHECK(indices.insert(index).second);
+        }
+
+        CHECK(table.size() >= 2000);
+        CHECK(&desc == &table[first]);
+        CHECK(table[first].l3descInx == 42);
+    }
+
+    SECTION("duplicate releases do not hand out an index twice")
+    {
+        const auto a = table.allocate();
+
+        table[a].inuseFlag = FD_FREE;
+        table.release(a);
+        table.release(a);
+
+        CHECK(table.allocate() == a);
+        CHECK(table.allocate() != a);
+    }
+
+    SECTION("allocation fails once the maximum size is reached")
+    {
+        int last = 0;
+        for (int i = irods::l1desc_table::first_index; i < irods::l1desc_table::max_size; ++i) {
+            last = table.allocate();
+        }
+
+        CHECK(last == irods::l1desc_table::max_size - 1);
+        CHECK(table.allocate() == SYS_OUT_OF_FILE_DESC);
+    }
+
+    SECTION("reset frees every descriptor")
+    {
+        for (int i = 0; i < 500; ++i) {
+            table.allocate();
+        }
+
+        table.reset();
+
+        CHECK(table.size() == irods::l1desc_table::block_size);
+        CHECK(table.allocate() == irods::l1desc_table::first_index);
+    }
+
+    SECTION("reserved and out-of-range indices are invalid")
+    {
+        CHECK_FALSE(table.is_valid_index(0));
+        CHECK_FALSE(table.is_valid_index(irods::l1desc_table::first_index - 1));
+        CHECK(table.is_valid_index(irods::l1desc_table::first_index));
+        CHECK_FALSE(table.is_valid_index(table.size()));
+    }
+}
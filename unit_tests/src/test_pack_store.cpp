@@ -0,0 +1,239 @@
+#include "catch.hpp"
+
+#include "pack_store.hpp"
+#include "irods_exception.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+namespace pk = irods::experimental::pack;
+namespace fs = boost::filesystem;
+
+namespace
+{
+    struct temp_directory
+    {
+        temp_directory()
+            : path{fs::temp_directory_path() / fs::unique_path("irods_pack_store_%%%%-%%%%")}
+        {
+            fs::create_directory(path);
+        }
+
+        ~temp_directory()
+        {
+            fs::remove_all(path);
+        }
+
+        fs::path path;
+    };
+
+    auto content_of(const std::string& _key) -> std::string
+    {
+        return "the content of " + _key;
+    }
+
+    auto put(pk::pack_store& _store, const std::string& _key) -> pk::location
+    {
+        const auto content = content_of(_key);
+        return _store.put(_key, content.data(), content.size());
+    }
+
+    auto read(pk::pack_store& _store, const std::string& _key) -> std::string
+    {
+        const auto loc = _store.find(_key);
+        REQUIRE(loc);
+        const auto data = _store.read(*loc);
+        return std::string(std::begin(data), std::end(data));
+    }
+
+    auto container_count(const fs::path& _directory) -> std::size_t
+    {
+        std::size_t count = 0;
+        for (auto&& entry : fs::directory_iterator{_directory}) {
+            count += entry.path().extension() == ".pack";
+        }
+        return count;
+    }
+} // anonymous namespace
+
+TEST_CASE("pack_store holds objects")
+{
+    temp_directory dir;
+    pk::pack_store store{dir.path.string(), pk::pack_parameters{}};
+
+    put(store, "a/b/c");
+    put(store, "a/b/d");
+    CHECK(read(store, "a/b/c") == content_of("a/b/c"));
+    CHECK(read(store, "a/b/d") == content_of("a/b/d"));
+    CHECK_FALSE(store.find("a/b/e"));
+
+    SECTION("an object is overwritten by a new record")
+    {
+        const std::string update = "new content";
+        store.put("a/b/c", update.data(), update.size());
+        CHECK(read(store, "a/b/c") == update);
+        CHECK(store.statistics().objects == 2);
+    }
+
+    SECTION("removing an object leaves a tombstone")
+    {
+        CHECK(store.remove("a/b/c"));
+        CHECK_FALSE(store.find("a/b/c"));
+        CHECK_FALSE(store.remove("a/b/c"));
+
+        pk::pack_store other{dir.path.string(), pk::pack_parameters{}};
+        CHECK_FALSE(other.find("a/b/c"));
+        CHECK(read(other, "a/b/d") == content_of("a/b/d"));
+    }
+
+    SECTION("renaming moves the content")
+    {
+        CHECK(store.rename("a/b/c", "x/y"));
+        CHECK_FALSE(store.find("a/b/c"));
+        CHECK(read(store, "x/y") == content_of("a/b/c"));
+        CHECK_FALSE(store.rename("a/b/c", "x/z"));
+    }
+
+    SECTION("records appended by another process are seen")
+    {
+        pk::pack_store other{dir.path.string(), pk::pack_parameters{}};
+        put(other, "from/other");
+        other.remove("a/b/d");
+
+        CHECK(read(store, "from/other") == content_of("from/other"));
+        CHECK_FALSE(store.find("a/b/d"));
+    }
+
+    SECTION("empty objects are stored")
+    {
+        store.put("empty", nullptr, 0);
+        const auto loc = store.find("empty");
+        REQUIRE(loc);
+        CHECK(loc->size == 0);
+    }
+}
+
+TEST_CASE("pack_store seals full containers")
+{
+    temp_directory dir;
+    pk::pack_parameters params;
+    params.max_container_size = 4096;
+
+    {
+        pk::pack_store store{dir.path.string(), params};
+        for (int i = 0; i < 500; ++i) {
+            put(store, "object/" + std::to_string(i));
+        }
+        store.remove("object/7");
+    }
+
+    CHECK(container_count(dir.path) > 5);
+
+    // Sealed containers are read back from their index.
+    pk::pack_store store{dir.path.string(), params};
+    CHECK(store.statistics().objects == 499);
+    CHECK(read(store, "object/0") == content_of("object/0"));
+    CHECK(read(store, "object/499") == content_of("object/499"));
+    CHECK_FALSE(store.find("object/7"));
+}
+
+TEST_CASE("pack_store compacts dead containers")
+{
+    temp_directory dir;
+    pk::pack_parameters params;
+    params.max_container_size = 4096;
+
+    // No container becomes entirely dead, so nothing is compacted in the
+    // background while the objects are removed.
+    params.compaction_threshold = 1.0;
+
+    {
+        pk::pack_store store{dir.path.string(), params};
+        for (int i = 0; i < 500; ++i) {
+            put(store, "object/" + std::to_string(i));
+        }
+
+        // Removes three of every four objects.
+        for (int i = 0; i < 500; ++i) {
+            if (i % 4 != 0) {
+                store.remove("object/" + std::to_string(i));
+            }
+        }
+    }
+
+    params.compaction_threshold = 0.5;
+    pk::pack_store store{dir.path.string(), params};
+
+    const auto count = container_count(dir.path);
+    const auto before = store.statistics();
+    const auto reclaimed = store.compact();
+    CHECK(reclaimed > 0);
+    CHECK(container_count(dir.path) < count);
+
+    const auto after = store.statistics();
+    CHECK(after.objects == 125);
+    CHECK(after.total_bytes < before.total_bytes);
+    CHECK(after.dead_ratio() < before.dead_ratio());
+
+    // Nothing is left to compact, and tombstones are not copied over and over.
+    CHECK(store.compact() == 0);
+
+    // Neither the store nor another process sees removed objects come back.
+    pk::pack_store other{dir.path.string(), params};
+    for (int i = 0; i < 500; ++i) {
+        const auto key = "object/" + std::to_string(i);
+
+        if (i % 4 == 0) {
+            CHECK(read(store, key) == content_of(key));
+            CHECK(read(other, key) == content_of(key));
+        }
+        else {
+            CHECK_FALSE(store.find(key));
+            CHECK_FALSE(other.find(key));
+        }
+    }
+}
+
+TEST_CASE("pack_store drops a record which was not finished")
+{
+    temp_directory dir;
+    const auto container = (dir.path / "0000000000000001.pack").string();
+
+    {
+        pk::pack_store store{dir.path.string(), pk::pack_parameters{}};
+        put(store, "first");
+    }
+
+    // Half of a record, as left by a process which died while appending it.
+    {
+        std::ofstream out{container, std::ios::app | std::ios::binary};
+        out << "PKR1 and some more";
+    }
+
+    pk::pack_store store{dir.path.string(), pk::pack_parameters{}};
+    CHECK(read(store, "first") == content_of("first"));
+
+    put(store, "second");
+
+    pk::pack_store other{dir.path.string(), pk::pack_parameters{}};
+    CHECK(read(other, "first") == content_of("first"));
+    CHECK(read(other, "second") == content_of("second"));
+    CHECK(other.statistics().objects == 2);
+}
+
+TEST_CASE("pack_store rejects invalid parameters")
+{
+    temp_directory dir;
+    pk::pack_parameters params;
+
+    params.compaction_threshold = 0;
+    CHECK_THROWS_AS(pk::pack_store(dir.path.string(), params), irods::exception);
+
+    params = pk::pack_parameters{};
+    params.max_container_size = 10;
+    CHECK_THROWS_AS(pk::pack_store(dir.path.string(), params), irods::exception);
+}
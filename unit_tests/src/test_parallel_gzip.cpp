@@ -0,0 +1,140 @@
+#include "catch.hpp"
+
+#include "parallel_gzip.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gzip = irods::experimental::gzip;
+
+namespace
+{
+    // Text-like data which compresses well, with some noise.
+    auto make_input(std::size_t _size, unsigned _seed = 42) -> std::string
+    {
+        const std::vector<std::string> words{"irods ", "replica ", "resource ", "collection ", "data ", "object "};
+
+        std::mt19937 gen{_seed};
+        std::string s;
+        s.reserve(_size + 16);
+
+        while (s.size() < _size) {
+            if (gen() % 16 == 0) {
+                s += static_cast<char>(gen());
+            }
+            else {
+                s += words[gen() % words.size()];
+            }
+        }
+
+        s.resize(_size);
+        return s;
+    }
+
+    auto compress(const std::string& _input, int _threads, std::size_t _write_size = 7919) -> std::string
+    {
+        std::string out;
+        gzip::parallel_writer writer{[&out](const void* _data, std::size_t _size) {
+                                         out.append(static_cast<const char*>(_data), _size);
+                                     },
+                                     _threads};
+
+        for (std::size_t i = 0; i < _input.size(); i += _write_size) {
+            writer.write(_input.data() + i, std::min(_write_size, _input.size() - i));
+        }
+
+        writer.close();
+
+        CHECK(writer.bytes_in() == _input.size());
+        CHECK(writer.bytes_out() == out.size());
+
+        return out;
+    }
+
+    auto decompress(const std::string& _input) -> std::string
+    {
+        z_stream zs{};
+        REQUIRE(inflateInit2(&zs, 16 + MAX_WBITS) == Z_OK);
+
+        std::string out;
+        std::vector<char> buf(64 * 1024);
+
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(_input.data()));
+        zs.avail_in = static_cast<uInt>(_input.size());
+
+        int ec = Z_OK;
+        while (ec == Z_OK) {
+            zs.next_out = reinterpret_cast<Bytef*>(buf.data());
+            zs.avail_out = static_cast<uInt>(buf.size());
+            ec = inflate(&zs, Z_NO_FLUSH);
+            out.append(buf.data(), buf.size() - zs.avail_out);
+        }
+
+        // The whole input is one gzip member and its trailer matched.
+        CHECK(ec == Z_STREAM_END);
+        CHECK(zs.avail_in == 0);
+        inflateEnd(&zs);
+
+        return out;
+    }
+} // anonymous namespace
+
+TEST_CASE("parallel_writer produces a single gzip member")
+{
+    const auto threads = GENERATE(1, 4);
+    const auto size = GENERATE(std::size_t{0},
+                               std::size_t{1},
+                               gzip::parallel_writer::default_block_size - 1,
+                               gzip::parallel_writer::default_block_size,
+                               gzip::parallel_writer::default_block_size + 1,
+                               std::size_t{5'000'000});
+
+    const auto input = make_input(size);
+    const auto output = compress(input, threads);
+
+    CHECK(decompress(output) == input);
+
+    if (size > 1000) {
+        CHECK(output.size() < input.size() / 2);
+    }
+}
+
+TEST_CASE("parallel_writer output does not depend on the number of threads")
+{
+    const auto input = make_input(3'000'000);
+    CHECK(compress(input, 1) == compress(input, 8));
+}
+
+TEST_CASE("parallel_writer loses little compression to the block boundaries")
+{
+    const auto input = make_input(4'000'000);
+
+    const auto bound = compressBound(static_cast<uLong>(input.size()));
+    std::string single(bound, '\0');
+    auto single_size = bound;
+    REQUIRE(compress2(reinterpret_cast<Bytef*>(single.data()), &single_size,
+                      reinterpret_cast<const Bytef*>(input.data()), static_cast<uLong>(input.size()),
+                      Z_DEFAULT_COMPRESSION) == Z_OK);
+
+    // Within 2% of one deflate stream over the whole input.
+    CHECK(compress(input, 4).size() < single_size * 1.02);
+}
+
+TEST_CASE("parallel_writer passes on the errors of the sink")
+{
+    gzip::parallel_writer writer{[](const void*, std::size_t _size) {
+                                     if (_size > 10) {
+                                         throw std::runtime_error{"full"};
+                                     }
+                                 },
+                                 2};
+
+    const auto input = make_input(1'000'000);
+
+    CHECK_THROWS_AS(writer.write(input.data(), input.size()), std::runtime_error);
+}
@@ -0,0 +1,128 @@
+#include "catch.hpp"
+
+#include "rodsClient.h"
+#include "connection_pool.hpp"
+#include "filesystem.hpp"
+#include "openCollection.h"
+#include "closeCollection.h"
+#include "read_collection_batch.h"
+#include "irods_at_scope_exit.hpp"
+
+#include <json.hpp>
+
+#include <cstdlib>
+#include <set>
+#include <string>
+
+TEST_CASE("read_collection_batch")
+{
+    // clang-format off
+    namespace fs = irods::experimental::filesystem;
+    using json   = nlohmann::json;
+    // clang-format on
+
+    load_client_api_plugins();
+
+    rodsEnv env;
+    _getRodsEnv(env);
+
+    auto conn_pool = irods::make_connection_pool(2);
+    auto conn = conn_pool->get_connection();
+    const auto sandbox = fs::path{env.rodsHome} / "unit_testing_sandbox";
+
+    if (!fs::client::exists(conn, sandbox)) {
+        REQUIRE(fs::client::create_collection(conn, sandbox));
+    }
+
+    irods::at_scope_exit remove_sandbox{[&conn, &sandbox] {
+        REQUIRE(fs::client::remove_all(conn, sandbox, fs::remove_options::no_trash));
+    }};
+
+    // More entries than fit in a single batch.
+    constexpr int entry_count = 600;
+
+    std::set<fs::path> expected;
+
+    for (int i = 0; i < entry_count; ++i) {
+        const auto p = sandbox / ("col." + std::to_string(i));
+        REQUIRE(fs::client::create_collection(conn, p));
+        expected.insert(p);
+    }
+
+    SECTION("collection_iterator visits every entry exactly once")
+    {
+        std::set<fs::path> visited;
+
+        for (auto&& e : fs::client::collection_iterator{conn, sandbox}) {
+            CHECK(e.is_collection());
+            CHECK(visited.insert(e.path()).second);
+        }
+
+        CHECK(visited == expected);
+    }
+
+    SECTION("the caller's connection can be used while the next batch is read ahead")
+    {
+        auto read_ahead_conn = conn_pool->get_connection();
+        std::set<fs::path> visited;
+
+        for (auto&& e : fs::client::collection_iterator{conn, read_ahead_conn, sandbox}) {
+            CHECK(fs::client::exists(conn, e.path()));
+            CHECK(visited.insert(e.path()).second);
+        }
+
+        CHECK(visited == expected);
+    }
+
+    SECTION("the API honors max_entries and reports the end of the collection")
+    {
+        collInp_t input{};
+        std::strncpy(input.collName, sandbox.c_str(), sandbox.string().size());
+
+        const auto handle = rcOpenCollection(static_cast<rcComm_t*>(conn), &input);
+        REQUIRE(handle >= 0);
+
+        irods::at_scope_exit close_collection{[&conn, handle] {
+            rcCloseCollection(static_cast<rcComm_t*>(conn), handle);
+        }};
+
+        const auto json_input = json{{"handle", handle}, {"max_entries", 100}}.dump();
+        int total = 0;
+
+        while (true) {
+            char* json_output{};
+            const auto ec = rc_read_collection_batch(static_cast<rcComm_t*>(conn), json_input.c_str(), &json_output);
+
+            if (ec == CAT_NO_ROWS_FOUND) {
+                break;
+            }
+
+            REQUIRE(ec == 0);
+
+            irods::at_scope_exit free_output{[json_output] { std::free(json_output); }};
+
+            const auto entries = json::parse(json_output);
+            REQUIRE(entries.is_array());
+            REQUIRE_FALSE(entries.empty());
+            CHECK(entries.size() <= 100);
+
+            for (auto&& e : entries) {
+                REQUIRE(e.size() == 10);
+                CHECK(e.at(0).get<int>() == COLL_OBJ_T);
+                CHECK(expected.count(e.at(1).get<std::string>()) == 1);
+            }
+
+            total += entries.size();
+        }
+
+        CHECK(total == entry_count);
+    }
+
+    SECTION("invalid handles are rejected")
+    {
+        const auto json_input = json{{"handle", -1}}.dump();
+        char* json_output{};
+
+        CHECK(rc_read_collection_batch(static_cast<rcComm_t*>(conn), json_input.c_str(), &json_output) == SYS_FILE_DESC_OUT_OF_RANGE);
+    }
+}
@@ -11,8 +11,10 @@
 #include "irods_at_scope_exit.hpp"
 
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -68,11 +70,12 @@ TEST_CASE("replica_access_table")
         auto entry = rat.erase_pid(info.token, info.pid);
         REQUIRE(entry);
 
-        auto [data_id, replica_number] = *entry;
+        const auto data_id = entry->data_id;
+        const auto replica_number = entry->replica_number;
         REQUIRE_FALSE(rat.contains(data_id, replica_number));
         REQUIRE_FALSE(rat.contains(info.token, data_id, replica_number));
 
-        rat.restore(info.token, data_id, replica_number, info.pid);
+        rat.restore(*entry);
         REQUIRE(rat.contains(data_id, replica_number));
         REQUIRE(rat.contains(info.token, data_id, replica_number));
     }
@@ -84,7 +87,8 @@ TEST_CASE("replica_access_table")
 
         // Because there are two PIDs associated with the same (token, data_id, replica_number)
         // tuple, the entry still exists in the table. However, only one PID remains in the PID list.
-        auto [data_id, replica_number] = *entry_1;
+        const auto data_id = entry_1->data_id;
+        const auto replica_number = entry_1->replica_number;
         REQUIRE(rat.contains(data_id, replica_number));
         REQUIRE(rat.contains(infos[0].token, data_id, replica_number));
 
@@ -96,8 +100,8 @@ TEST_CASE("replica_access_table")
 
         // Show that the restore member function restores the previously removed entry.
         // Restoring the entry does not generate a new token.
-        rat.restore(infos[0].token, data_id, replica_number, infos[0].pid);
-        rat.restore(infos[1].token, data_id, replica_number, infos[1].pid);
+        rat.restore(*entry_1);
+        rat.restore(*entry_2);
         REQUIRE(rat.contains(data_id, replica_number));
         REQUIRE(rat.contains(infos[0].token, data_id, replica_number));
     }
@@ -118,6 +122,180 @@ TEST_CASE("replica_access_table")
 #endif // IRODS_ENABLE_ALL_UNIT_TESTS
 }
 
+TEST_CASE("replica_access_table shards")
+{
+#ifdef IRODS_ENABLE_ALL_UNIT_TESTS
+    ix::replica_access_table::init();
+    irods::at_scope_exit cleanup{[] { ix::replica_access_table::deinit(); }};
+
+    auto& rat = ix::replica_access_table::instance();
+    const auto pid = getpid();
+
+    SECTION("tokens resolve to the shard of their replica")
+    {
+        std::vector<std::string> tokens;
+
+        for (int data_id = 1; data_id <= 500; ++data_id) {
+            tokens.push_back(rat.create_new_entry(data_id, data_id % 3, pid));
+        }
+
+        for (int data_id = 1; data_id <= 500; ++data_id) {
+            const auto& token = tokens[data_id - 1];
+            REQUIRE(rat.contains(token, data_id, data_id % 3));
+            REQUIRE_FALSE(rat.contains(token, data_id, data_id % 3 + 1));
+
+            // Appending requires the token and the replica to match.
+            REQUIRE_NOTHROW(rat.append_pid(token, data_id, data_id % 3, pid));
+            REQUIRE_THROWS(rat.append_pid(token, data_id + 1, data_id % 3, pid));
+        }
+
+        rat.erase_pid(pid);
+
+        for (int data_id = 1; data_id <= 500; ++data_id) {
+            REQUIRE_FALSE(rat.contains(data_id, data_id % 3));
+        }
+    }
+
+    SECTION("malformed tokens are rejected")
+    {
+        REQUIRE_FALSE(rat.contains("", 1, 0));
+        REQUIRE_FALSE(rat.contains("zz", 1, 0));
+        REQUIRE_FALSE(rat.erase_pid("not-a-token", pid));
+        REQUIRE_THROWS(rat.append_pid("not-a-token", 1, 0, pid));
+    }
+
+    SECTION("PIDs of dead processes are erased")
+    {
+        const auto child = fork();
+        REQUIRE(child >= 0);
+
+        if (child == 0) {
+            rat.create_new_entry(42, 0, getpid());
+            _exit(0);
+        }
+
+        int status{};
+        REQUIRE(waitpid(child, &status, 0) == child);
+        REQUIRE(rat.contains(42, 0));
+
+        const auto token = rat.create_new_entry(43, 0, pid);
+
+        REQUIRE(rat.erase_dead_pids() == 1);
+        REQUIRE_FALSE(rat.contains(42, 0));
+        REQUIRE(rat.contains(token, 43, 0));
+
+        rat.erase_pid(token, pid);
+    }
+
+    SECTION("a full table evicts PIDs of dead processes")
+    {
+        // Fill the table from a child process, which then exits without cleaning up.
+        const auto child = fork();
+        REQUIRE(child >= 0);
+
+        if (child == 0) {
+            try {
+                for (ix::replica_access_table::data_id_type data_id = 1;; ++data_id) {
+                    rat.create_new_entry(data_id, 0, getpid());
+                }
+            }
+            catch (const ix::replica_access_table_error&) {
+            }
+
+            _exit(0);
+        }
+
+        int status{};
+        REQUIRE(waitpid(child, &status, 0) == child);
+
+        // The child used every data id starting at 1.
+        std::string token;
+        REQUIRE_NOTHROW(token = rat.create_new_entry(0, 0, pid));
+        REQUIRE(rat.contains(token, 0, 0));
+
+        rat.erase_pid(pid);
+    }
+#endif // IRODS_ENABLE_ALL_UNIT_TESTS
+}
+
+// Measures the time it takes several agents to open and close replicas concurrently.
+//
+// Run with: irods_replica_access_table "[benchmark]"
+TEST_CASE("replica_access_table contention benchmark", "[.][benchmark]")
+{
+    ix::replica_access_table::init();
+    irods::at_scope_exit cleanup{[] { ix::replica_access_table::deinit(); }};
+
+    constexpr int process_count = 16;
+    constexpr int iterations = 20'000;
+
+    auto& rat = ix::replica_access_table::instance();
+
+    // "distinct" simulates agents writing different data objects. "shared" simulates
+    // agents writing parallel streams of the same replica, which always lands in a
+    // single shard.
+    for (const bool shared : {false, true}) {
+        std::vector<std::string> tokens;
+
+        for (int p = 0; p < process_count; ++p) {
+            if (!shared || p == 0) {
+                tokens.push_back(rat.create_new_entry(shared ? 1 : 1000 + p, 0, getpid()));
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<pid_t> children;
+
+        for (int p = 0; p < process_count; ++p) {
+            const auto child = fork();
+            REQUIRE(child >= 0);
+
+            if (child == 0) {
+                const auto& token = tokens[shared ? 0 : p];
+                const auto self = getpid();
+                int ec = 0;
+
+                try {
+                    rat.append_pid(token, shared ? 1 : 1000 + p, 0, self);
+
+                    for (int i = 0; i < iterations; ++i) {
+                        if (auto entry = rat.erase_pid(token, self); entry) {
+                            rat.restore(*entry);
+                        }
+                        else {
+                            ec = 1;
+                            break;
+                        }
+                    }
+
+                    rat.erase_pid(token, self);
+                }
+                catch (...) {
+                    ec = 1;
+                }
+
+                _exit(ec);
+            }
+
+            children.push_back(child);
+        }
+
+        for (auto child : children) {
+            int status{};
+            REQUIRE(waitpid(child, &status, 0) == child);
+            REQUIRE(WIFEXITED(status));
+            REQUIRE(WEXITSTATUS(status) == 0);
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        WARN((shared ? "shared replica" : "distinct replicas") << ": " << process_count << " processes x "
+             << iterations << " erase/restore pairs in " << elapsed.count() << " ms");
+
+        rat.erase_pid(getpid());
+    }
+}
+
 auto insert_new_entry(ix::replica_access_table& rat, access_info& info) -> void
 {
     info.token = rat.create_new_entry(info.data_id, info.replica_number, info.pid);
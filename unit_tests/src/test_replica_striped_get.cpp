@@ -0,0 +1,63 @@
+#include "catch.hpp"
+
+#include "objInfo.h"
+#include "replica_striped_get.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    auto replica_numbers(const std::vector<irods::stripe_source>& _sources) -> std::vector<int>
+    {
+        std::vector<int> numbers;
+        std::transform(std::begin(_sources), std::end(_sources), std::back_inserter(numbers),
+                       [](const irods::stripe_source& _s) { return _s.replica_number; });
+        return numbers;
+    }
+} // anonymous namespace
+
+TEST_CASE("select_stripe_sources")
+{
+    SECTION("only good replicas are read from")
+    {
+        const auto sources = irods::select_stripe_sources({{0, GOOD_REPLICA, "a.example.org"},
+                                                           {1, STALE_REPLICA, "b.example.org"},
+                                                           {2, INTERMEDIATE_REPLICA, "c.example.org"},
+                                                           {3, GOOD_REPLICA, "d.example.org"}});
+
+        CHECK(replica_numbers(sources) == std::vector<int>{0, 3});
+        CHECK(sources[1].host == "d.example.org");
+    }
+
+    SECTION("at most one replica is read from each host")
+    {
+        const auto sources = irods::select_stripe_sources({{4, GOOD_REPLICA, "a.example.org"},
+                                                           {2, GOOD_REPLICA, "b.example.org"},
+                                                           {1, GOOD_REPLICA, "a.example.org"}});
+
+        CHECK(replica_numbers(sources) == std::vector<int>{1, 2});
+    }
+
+    SECTION("replicas without a host are ignored")
+    {
+        const auto sources = irods::select_stripe_sources({{0, GOOD_REPLICA, ""},
+                                                           {1, GOOD_REPLICA, "EMPTY_RESC_HOST"}});
+
+        CHECK(sources.empty());
+    }
+}
+
+TEST_CASE("stripe_channel_count")
+{
+    // Two ranges per replica by default.
+    CHECK(irods::stripe_channel_count(2, 0) == 4);
+    CHECK(irods::stripe_channel_count(3, 0) == 6);
+
+    // The number of threads asked for wins, within limits.
+    CHECK(irods::stripe_channel_count(3, 5) == 5);
+    CHECK(irods::stripe_channel_count(3, 100) == 16);
+    CHECK(irods::stripe_channel_count(20, 0) == 16);
+}
@@ -0,0 +1,127 @@
+#include "catch.hpp"
+
+#include "irods_server_properties.hpp"
+#include "irods_configuration_keywords.hpp"
+#include "irods_at_scope_exit.hpp"
+#include "rodsErrorTable.h"
+
+#include <boost/any.hpp>
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+TEST_CASE("server_properties snapshot")
+{
+    using map_type = std::unordered_map<std::string, boost::any>;
+
+    auto& props = irods::server_properties::instance();
+
+    // Restore the properties modified by each section.
+    irods::at_scope_exit restore_properties{
+        [&props,
+         advanced_settings = irods::get_server_property<const map_type>(irods::CFG_ADVANCED_SETTINGS_KW),
+         zone_name = irods::get_server_property<const std::string>(irods::CFG_ZONE_NAME)] {
+            props.set_property<map_type>(irods::CFG_ADVANCED_SETTINGS_KW, advanced_settings);
+            props.set_property<std::string>(irods::CFG_ZONE_NAME, zone_name);
+        }};
+
+    SECTION("the snapshot matches the string-key API")
+    {
+        const auto& snapshot = irods::server_config();
+
+        REQUIRE(snapshot.zone_name);
+        CHECK(*snapshot.zone_name == irods::get_server_property<std::string>(irods::CFG_ZONE_NAME));
+
+        REQUIRE(snapshot.advanced_settings.transfer_buffer_size_for_parallel_transfer_in_megabytes);
+        CHECK(*snapshot.advanced_settings.transfer_buffer_size_for_parallel_transfer_in_megabytes ==
+              irods::get_advanced_setting<int>(irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS));
+
+        CHECK_FALSE(snapshot.log_level.empty());
+    }
+
+    SECTION("setting a property publishes a new snapshot")
+    {
+        const auto* old_snapshot = &irods::server_config();
+
+        props.set_property<int>({irods::CFG_ADVANCED_SETTINGS_KW, irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS}, 12345);
+        props.set_property<std::string>(irods::CFG_ZONE_NAME, "snapshot_zone");
+
+        const auto& snapshot = irods::server_config();
+
+        // Previously published snapshots are never modified.
+        CHECK(&snapshot != old_snapshot);
+        CHECK(old_snapshot->zone_name != snapshot.zone_name);
+
+        CHECK(snapshot.advanced_settings.transfer_buffer_size_for_parallel_transfer_in_megabytes == 12345);
+        CHECK(snapshot.zone_name == "snapshot_zone");
+
+        // The compatibility layer serves reads from the snapshot.
+        CHECK(&irods::get_advanced_setting<const int>(irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS) ==
+              &*snapshot.advanced_settings.transfer_buffer_size_for_parallel_transfer_in_megabytes);
+        CHECK(irods::get_server_property<const std::string>(irods::CFG_ZONE_NAME) == "snapshot_zone");
+    }
+
+    SECTION("properties that are not in the snapshot are read from the configuration")
+    {
+        props.set_property<std::string>({irods::CFG_ADVANCED_SETTINGS_KW, "snapshot_test_setting"}, "value");
+        CHECK(irods::get_advanced_setting<const std::string>("snapshot_test_setting") == "value");
+    }
+
+    SECTION("errors are reported exactly as before")
+    {
+        props.set_property<std::string>({irods::CFG_ADVANCED_SETTINGS_KW, irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS}, "not an int");
+
+        CHECK_FALSE(irods::server_config().advanced_settings.transfer_buffer_size_for_parallel_transfer_in_megabytes);
+
+        try {
+            irods::get_advanced_setting<const int>(irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS);
+            FAIL("expected an exception");
+        }
+        catch (const irods::exception& e) {
+            CHECK(e.code() == INVALID_ANY_CAST);
+        }
+
+        try {
+            irods::get_advanced_setting<const int>("no_such_setting");
+            FAIL("expected an exception");
+        }
+        catch (const irods::exception& e) {
+            CHECK(e.code() == KEY_NOT_FOUND);
+        }
+    }
+}
+
+// Compares the cost of reading an advanced setting through the old map walk (which
+// non-const types still use), the compatibility layer and the snapshot.
+//
+// Run with: irods_server_properties "[benchmark]"
+TEST_CASE("server_properties lookup benchmark", "[.][benchmark]")
+{
+    constexpr int iterations = 1'000'000;
+
+    const auto measure = [](const char* _name, auto _func) {
+        long long sum = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < iterations; ++i) {
+            sum += _func();
+        }
+
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        WARN(_name << ": " << elapsed.count() / iterations << " ns per lookup (checksum " << sum << ')');
+    };
+
+    measure("map walk (get_advanced_setting<int>)", [] {
+        return irods::get_advanced_setting<int>(irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS);
+    });
+
+    measure("compatibility layer (get_advanced_setting<const int>)", [] {
+        return irods::get_advanced_setting<const int>(irods::CFG_TRANS_BUFFER_SIZE_FOR_PARA_TRANS);
+    });
+
+    measure("snapshot (server_config())", [] {
+        return *irods::server_config().advanced_settings.transfer_buffer_size_for_parallel_transfer_in_megabytes;
+    });
+}
@@ -0,0 +1,271 @@
+#include "catch.hpp"
+
+#include "irods_exception.hpp"
+#include "rodsErrorTable.h"
+#include "stage_queue.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    auto make_request(const std::string& _logical_path) -> irods::stage_request
+    {
+        irods::stage_request r{};
+        r.logical_path = _logical_path;
+        r.resource = "compResc";
+        return r;
+    }
+
+    // A stage function which records the order of the stages and blocks until released.
+    class recorder
+    {
+    public:
+        auto stage(const irods::stage_request& _request) -> int
+        {
+            std::unique_lock lock{mutex_};
+            order_.push_back(_request.logical_path);
+            cv_.notify_all();
+            cv_.wait(lock, [this] { return released_; });
+            return 0;
+        }
+
+        auto wait_for_stages(std::size_t _count) -> void
+        {
+            std::unique_lock lock{mutex_};
+            cv_.wait(lock, [&] { return order_.size() >= _count; });
+        }
+
+        auto release() -> void
+        {
+            {
+                std::lock_guard lock{mutex_};
+                released_ = true;
+            }
+
+            cv_.notify_all();
+        }
+
+        auto order() -> std::vector<std::string>
+        {
+            std::lock_guard lock{mutex_};
+            return order_;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::vector<std::string> order_;
+        bool released_ = false;
+    };
+} // anonymous namespace
+
+TEST_CASE("stage_queue")
+{
+    recorder r;
+
+    SECTION("requests for the same data object are coalesced")
+    {
+        irods::stage_queue q{2, [&r](auto& _request) { return r.stage(_request); }};
+
+        auto first = q.submit(make_request("/tempZone/home/rods/a"), irods::stage_priority_prefetch);
+        r.wait_for_stages(1);
+
+        // The stage is running. A second request waits for it rather than staging again.
+        auto second = q.submit(make_request("/tempZone/home/rods/a"), irods::stage_priority_open);
+        CHECK(q.running() == 1);
+        CHECK(q.queued() == 0);
+
+        r.release();
+        CHECK(first.get() == 0);
+        CHECK(second.get() == 0);
+        CHECK(r.order().size() == 1);
+
+        // Once the stage has completed, a new request stages the data object again.
+        CHECK(q.submit(make_request("/tempZone/home/rods/a"), irods::stage_priority_open).get() == 0);
+        CHECK(r.order().size() == 2);
+    }
+
+    SECTION("stages run in order of priority and opens overtake prefetches")
+    {
+        irods::stage_queue q{1, [&r](auto& _request) { return r.stage(_request); }};
+
+        // Occupies the only worker.
+        auto blocker = q.submit(make_request("/tempZone/home/rods/blocker"), irods::stage_priority_prefetch);
+        r.wait_for_stages(1);
+
+        auto a = q.submit(make_request("/tempZone/home/rods/a"), irods::stage_priority_prefetch);
+        auto b = q.submit(make_request("/tempZone/home/rods/b"), irods::stage_priority_prefetch);
+        auto c = q.submit(make_request("/tempZone/home/rods/c"), 5);
+        auto d = q.submit(make_request("/tempZone/home/rods/d"), irods::stage_priority_prefetch);
+        CHECK(q.queued() == 4);
+
+        // An open of a prefetched data object raises the priority of its stage.
+        auto d_open = q.submit(make_request("/tempZone/home/rods/d"), irods::stage_priority_open);
+        CHECK(q.queued() == 4);
+
+        r.release();
+        CHECK(d_open.get() == 0);
+        CHECK(a.get() == 0);
+        CHECK(b.get() == 0);
+
+        const std::vector<std::string> expected{"/tempZone/home/rods/blocker",
+                                                "/tempZone/home/rods/d",
+                                                "/tempZone/home/rods/c",
+                                                "/tempZone/home/rods/a",
+                                                "/tempZone/home/rods/b"};
+        CHECK(r.order() == expected);
+    }
+
+    SECTION("the data object and resource identify a stage")
+    {
+        irods::stage_queue q{1, [&r](auto& _request) { return r.stage(_request); }};
+
+        auto request = make_request("/tempZone/home/rods/a");
+        auto first = q.submit(request, irods::stage_priority_prefetch);
+
+        request.resource = "otherCompResc";
+        auto second = q.submit(request, irods::stage_priority_prefetch);
+
+        r.release();
+        CHECK(first.get() == 0);
+        CHECK(second.get() == 0);
+        CHECK(r.order().size() == 2);
+    }
+
+    SECTION("the destructor discards the stages which have not started")
+    {
+        std::vector<std::shared_future<int>> status;
+        std::thread releaser;
+
+        {
+            irods::stage_queue q{1, [&r](auto& _request) { return r.stage(_request); }};
+
+            for (int i = 0; i < 10; ++i) {
+                status.push_back(q.submit(make_request("/tempZone/home/rods/" + std::to_string(i)), i));
+            }
+
+            r.wait_for_stages(1);
+
+            // Completes the running stage within the grace period of the destructor.
+            releaser = std::thread{[&r] {
+                std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                r.release();
+            }};
+        }
+
+        releaser.join();
+
+        // The destructor joined the worker, so every stage has completed.
+        int discarded = 0;
+        for (auto&& s : status) {
+            REQUIRE(s.wait_for(std::chrono::seconds{0}) == std::future_status::ready);
+
+            if (s.get() == SYS_THREAD_ENCOUNTERED_INTERRUPT) {
+                ++discarded;
+            }
+        }
+        CHECK(discarded == 9);
+        CHECK(r.order().size() == 1);
+    }
+
+    SECTION("the destructor interrupts the stages which outlast the grace period")
+    {
+        std::shared_future<int> status;
+
+        {
+            auto stage = [&r](auto& _request) {
+                irods::stage_queue::set_interrupt([&r] { r.release(); });
+                return r.stage(_request);
+            };
+
+            irods::stage_queue q{1, stage, std::chrono::milliseconds{50}};
+
+            status = q.submit(make_request("/tempZone/home/rods/a"), irods::stage_priority_prefetch);
+            r.wait_for_stages(1);
+        }
+
+        REQUIRE(status.wait_for(std::chrono::seconds{0}) == std::future_status::ready);
+        CHECK(status.get() == 0);
+    }
+
+    SECTION("run stages in the calling thread when there is nothing to coalesce with")
+    {
+        irods::stage_queue q{1, [&r](auto& _request) { return r.stage(_request); }};
+
+        const auto caller = std::this_thread::get_id();
+        std::thread::id stager;
+
+        CHECK(q.run(make_request("/tempZone/home/rods/a"), [&stager] {
+            stager = std::this_thread::get_id();
+            return 0;
+        }) == 0);
+
+        CHECK(stager == caller);
+        CHECK(r.order().empty());
+        CHECK(q.running() == 0);
+    }
+
+    SECTION("run waits for a running stage of the data object")
+    {
+        irods::stage_queue q{1, [&r](auto& _request) { return r.stage(_request); }};
+
+        auto prefetch = q.submit(make_request("/tempZone/home/rods/a"), irods::stage_priority_prefetch);
+        r.wait_for_stages(1);
+
+        bool staged_here = false;
+        std::thread release{[&r] {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            r.release();
+        }};
+
+        CHECK(q.run(make_request("/tempZone/home/rods/a"), [&staged_here] {
+            staged_here = true;
+            return 0;
+        }) == 0);
+
+        release.join();
+        CHECK_FALSE(staged_here);
+        CHECK(prefetch.get() == 0);
+        CHECK(r.order().size() == 1);
+    }
+
+    SECTION("run takes over a prefetch which has not started")
+    {
+        irods::stage_queue q{1, [&r](auto& _request) { return r.stage(_request); }};
+
+        // Occupies the only worker.
+        auto blocker = q.submit(make_request("/tempZone/home/rods/blocker"), irods::stage_priority_prefetch);
+        r.wait_for_stages(1);
+
+        auto prefetch = q.submit(make_request("/tempZone/home/rods/a"), irods::stage_priority_prefetch);
+        CHECK(q.queued() == 1);
+
+        // The open does not wait for the worker, and the prefetch completes with its status.
+        CHECK(q.run(make_request("/tempZone/home/rods/a"), [] { return SYS_NO_GOOD_REPLICA; }) == SYS_NO_GOOD_REPLICA);
+        CHECK(q.queued() == 0);
+        CHECK(prefetch.get() == SYS_NO_GOOD_REPLICA);
+
+        r.release();
+        CHECK(blocker.get() == 0);
+        CHECK(r.order().size() == 1);
+    }
+}
+
+TEST_CASE("stage_queue reports the status of failed stages")
+{
+    irods::stage_queue q{2, [](const irods::stage_request& _request) -> int {
+        if (_request.logical_path == "/tempZone/home/rods/throws") {
+            THROW(SYS_INVALID_INPUT_PARAM, "cannot stage");
+        }
+
+        return SYS_NO_GOOD_REPLICA;
+    }};
+
+    CHECK(q.submit(make_request("/tempZone/home/rods/fails"), 0).get() == SYS_NO_GOOD_REPLICA);
+    CHECK(q.submit(make_request("/tempZone/home/rods/throws"), 0).get() == SYS_INVALID_INPUT_PARAM);
+}
@@ -0,0 +1,279 @@
+#include "catch.hpp"
+
+#include "irods_exception.hpp"
+#include "tar_member_index.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace tar = irods::experimental::tar;
+
+namespace
+{
+    // Builds tar files in memory.
+    class tar_writer
+    {
+    public:
+        auto add(const std::string& _name, const std::string& _data, char _type = '0', const std::string& _prefix = {})
+            -> tar_writer&
+        {
+            add_header(_name, static_cast<std::int64_t>(_data.size()), _type, _prefix);
+            add_data(_data);
+            return *this;
+        }
+
+        auto add_directory(const std::string& _name) -> tar_writer&
+        {
+            add_header(_name, 0, '5');
+            return *this;
+        }
+
+        auto add_gnu_long_name(const std::string& _name, const std::string& _data) -> tar_writer&
+        {
+            add_header("././@LongLink", static_cast<std::int64_t>(_name.size() + 1), 'L');
+            add_data(_name + '\0');
+            return add(_name.substr(0, 99), _data);
+        }
+
+        auto add_pax(const std::string& _name, const std::string& _data) -> tar_writer&
+        {
+            const auto record = [](const std::string& _key, const std::string& _value) {
+                // The length includes the digits of the length itself.
+                auto length = _key.size() + _value.size() + 3;
+                length += std::to_string(length + std::to_string(length).size()).size();
+                return fmt::format("{} {}={}\n", length, _key, _value);
+            };
+
+            const auto records = record("path", _name);
+            add_header("PaxHeaders/x", static_cast<std::int64_t>(records.size()), 'x');
+            add_data(records);
+            return add("truncated", _data);
+        }
+
+        auto finish() -> std::string
+        {
+            return data_ + std::string(1024, '\0');
+        }
+
+        auto data() const -> const std::string& { return data_; }
+
+    private:
+        auto add_header(const std::string& _name, std::int64_t _size, char _type, const std::string& _prefix = {})
+            -> void
+        {
+            char h[512]{};
+            std::strncpy(h, _name.c_str(), 100);
+            std::snprintf(h + 100, 8, "%07o", 0644);
+            std::snprintf(h + 108, 8, "%07o", 0);
+            std::snprintf(h + 116, 8, "%07o", 0);
+            std::snprintf(h + 124, 12, "%011llo", static_cast<unsigned long long>(_size));
+            std::snprintf(h + 136, 12, "%011o", 1600000000);
+            h[156] = _type;
+            std::memcpy(h + 257, "ustar", 6);
+            std::memcpy(h + 263, "00", 2);
+            std::strncpy(h + 345, _prefix.c_str(), 155);
+
+            std::memset(h + 148, ' ', 8);
+            unsigned int sum = 0;
+            for (unsigned char c : h) {
+                sum += c;
+            }
+            std::snprintf(h + 148, 8, "%06o", sum);
+            h[155] = ' ';
+
+            data_.append(h, sizeof(h));
+        }
+
+        auto add_data(const std::string& _data) -> void
+        {
+            data_ += _data;
+            data_.append((512 - _data.size() % 512) % 512, '\0');
+        }
+
+        std::string data_;
+    };
+
+    auto reader_of(const std::string& _file, int* _reads = nullptr) -> tar::read_function
+    {
+        return [&_file, _reads](std::int64_t _offset, void* _buffer, std::int64_t _size) -> std::int64_t {
+            if (_reads) {
+                ++*_reads;
+            }
+
+            if (_offset >= static_cast<std::int64_t>(_file.size())) {
+                return 0;
+            }
+
+            const auto n = std::min<std::int64_t>(_size, _file.size() - _offset);
+            std::memcpy(_buffer, _file.data() + _offset, n);
+            return n;
+        };
+    }
+
+    auto member_data(const std::string& _file, const tar::member& _member) -> std::string
+    {
+        return _file.substr(_member.offset, _member.size);
+    }
+} // anonymous namespace
+
+TEST_CASE("member_index locates the members of a tar file")
+{
+    const std::string long_name = "dir/" + std::string(150, 'a') + "/file.txt";
+
+    const auto file = tar_writer{}
+                          .add_directory("./dir/")
+                          .add("./dir/small.txt", "hello")
+                          .add("empty.txt", "")
+                          .add("big.bin", std::string(5000, 'x'))
+                          .add("in_prefix.txt", "prefixed", '0', "some/prefix")
+                          .add_gnu_long_name(long_name, "gnu long name")
+                          .add_pax("pax/" + std::string(120, 'p'), "pax name")
+                          .add("link", "", '2')
+                          .finish();
+
+    const auto index = tar::member_index::build(reader_of(file));
+    REQUIRE(index);
+
+    // The symbolic link cannot be read in place.
+    CHECK(index->members().size() == 7);
+    CHECK(index->find("link") == nullptr);
+
+    const auto* dir = index->find("dir");
+    REQUIRE(dir);
+    CHECK(dir->is_directory());
+
+    const auto* small = index->find("dir/small.txt");
+    REQUIRE(small);
+    CHECK(small->is_regular_file());
+    CHECK(small->size == 5);
+    CHECK(small->mode == 0644);
+    CHECK(small->mtime == 1600000000);
+    CHECK(member_data(file, *small) == "hello");
+
+    REQUIRE(index->find("empty.txt"));
+    CHECK(index->find("empty.txt")->size == 0);
+
+    REQUIRE(index->find("big.bin"));
+    CHECK(member_data(file, *index->find("big.bin")) == std::string(5000, 'x'));
+
+    REQUIRE(index->find("some/prefix/in_prefix.txt"));
+    CHECK(member_data(file, *index->find("some/prefix/in_prefix.txt")) == "prefixed");
+
+    REQUIRE(index->find(long_name));
+    CHECK(member_data(file, *index->find(long_name)) == "gnu long name");
+
+    REQUIRE(index->find("pax/" + std::string(120, 'p')));
+    CHECK(member_data(file, *index->find("pax/" + std::string(120, 'p'))) == "pax name");
+
+    CHECK(index->find("missing.txt") == nullptr);
+    CHECK(index->find("dir/small") == nullptr);
+}
+
+TEST_CASE("member_index finds the last of several members with the same name")
+{
+    const auto file = tar_writer{}.add("a.txt", "first").add("b.txt", "b").add("a.txt", "second").finish();
+
+    const auto index = tar::member_index::build(reader_of(file));
+    REQUIRE(index);
+    REQUIRE(index->find("a.txt"));
+    CHECK(member_data(file, *index->find("a.txt")) == "second");
+    CHECK(member_data(file, *index->find("b.txt")) == "b");
+}
+
+TEST_CASE("member_index rejects files which are not uncompressed tar files")
+{
+    CHECK_FALSE(tar::member_index::build(reader_of("")));
+    CHECK_FALSE(tar::member_index::build(reader_of("\x1f\x8b\x08" + std::string(1021, '\0'))));
+    CHECK_FALSE(tar::member_index::build(reader_of("PK\x03\x04" + std::string(2000, 'z'))));
+
+    // An empty tar file has no members.
+    const auto empty = tar::member_index::build(reader_of(std::string(1024, '\0')));
+    REQUIRE(empty);
+    CHECK(empty->members().empty());
+
+    // A corrupt header after the first one is an error rather than a different format.
+    auto corrupt = tar_writer{}.add("a.txt", "a").data() + std::string(512, 'x');
+    CHECK_THROWS_AS(tar::member_index::build(reader_of(corrupt)), irods::exception);
+
+    // A tar file which ends without the end-of-archive blocks is read to its last member.
+    const auto unterminated = tar_writer{}.add("a.txt", "a").data();
+    const auto index = tar::member_index::build(reader_of(unterminated));
+    REQUIRE(index);
+    CHECK(index->find("a.txt"));
+}
+
+TEST_CASE("member_index reads the headers in large chunks")
+{
+    tar_writer writer;
+    for (int i = 0; i < 100; ++i) {
+        writer.add(fmt::format("file_{}.txt", i), std::string(100, 'd'));
+    }
+
+    const auto file = writer.finish();
+
+    int reads = 0;
+    const auto index = tar::member_index::build(reader_of(file, &reads));
+    REQUIRE(index);
+    CHECK(index->members().size() == 100);
+
+    // 100 members of two blocks each fit in two or three 64 KiB reads.
+    CHECK(reads <= 3);
+}
+
+TEST_CASE("member_index serialization")
+{
+    const auto file = tar_writer{}
+                          .add("a.txt", "a")
+                          .add("with space and\nnewline.txt", "b")
+                          .add_directory("dir")
+                          .finish();
+
+    const auto index = tar::member_index::build(reader_of(file));
+    REQUIRE(index);
+
+    const auto data = index->serialize(static_cast<std::int64_t>(file.size()), 1234);
+
+    const auto restored = tar::member_index::deserialize(data, static_cast<std::int64_t>(file.size()), 1234);
+    REQUIRE(restored);
+    REQUIRE(restored->members().size() == 3);
+
+    for (std::size_t i = 0; i < 3; ++i) {
+        const auto& expected = index->members()[i];
+        const auto& actual = restored->members()[i];
+        CHECK(actual.name == expected.name);
+        CHECK(actual.offset == expected.offset);
+        CHECK(actual.size == expected.size);
+        CHECK(actual.mtime == expected.mtime);
+        CHECK(actual.mode == expected.mode);
+        CHECK(actual.type == expected.type);
+    }
+
+    CHECK(restored->find("with space and\nnewline.txt"));
+
+    SECTION("an index of another version of the tar file is rejected")
+    {
+        CHECK_FALSE(tar::member_index::deserialize(data, static_cast<std::int64_t>(file.size()) + 512, 1234));
+        CHECK_FALSE(tar::member_index::deserialize(data, static_cast<std::int64_t>(file.size()), 1235));
+    }
+
+    SECTION("an index of any version of the tar file is recognized")
+    {
+        CHECK(tar::member_index::is_serialized(data));
+        CHECK(tar::member_index::is_serialized(index->serialize(512, 1)));
+        CHECK_FALSE(tar::member_index::is_serialized(""));
+        CHECK_FALSE(tar::member_index::is_serialized("irods_tar_member_index"));
+        CHECK_FALSE(tar::member_index::is_serialized("a data object\n"));
+    }
+
+    SECTION("corrupt indexes are rejected")
+    {
+        CHECK_FALSE(tar::member_index::deserialize("", 0, 0));
+        CHECK_FALSE(tar::member_index::deserialize("not an index\n", 0, 0));
+        CHECK_FALSE(tar::member_index::deserialize(data.substr(0, data.size() - 5), static_cast<std::int64_t>(file.size()), 1234));
+        CHECK_FALSE(tar::member_index::deserialize(data + "x", static_cast<std::int64_t>(file.size()), 1234));
+    }
+}
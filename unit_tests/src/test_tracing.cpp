@@ -0,0 +1,208 @@
+#include "catch.hpp"
+
+#include "irods_tracing.hpp"
+
+#include <json.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace tracing = irods::experimental::tracing;
+namespace fs = boost::filesystem;
+
+namespace
+{
+    // Returns every span in the file, keyed by span ID.
+    auto read_spans(const fs::path& _p) -> std::map<std::string, nlohmann::json>
+    {
+        std::map<std::string, nlohmann::json> spans;
+        std::ifstream in{_p.c_str()};
+
+        for (std::string line; std::getline(in, line);) {
+            const auto request = nlohmann::json::parse(line);
+
+            for (auto&& rs : request.at("resourceSpans")) {
+                for (auto&& ss : rs.at("scopeSpans")) {
+                    for (auto&& s : ss.at("spans")) {
+                        spans[s.at("spanId").get<std::string>()] = s;
+                    }
+                }
+            }
+        }
+
+        return spans;
+    }
+
+    auto find_span(const std::map<std::string, nlohmann::json>& _spans, const std::string& _name) -> const nlohmann::json&
+    {
+        const auto iter = std::find_if(std::begin(_spans), std::end(_spans), [&_name](auto& _s) {
+            return _s.second.at("name").template get<std::string>() == _name;
+        });
+
+        REQUIRE(iter != std::end(_spans));
+
+        return iter->second;
+    }
+} // anonymous namespace
+
+TEST_CASE("traceparent")
+{
+    const std::string value = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+
+    const auto ctx = tracing::from_traceparent(value);
+    REQUIRE(ctx);
+    CHECK(ctx->trace_id[0] == 0x4b);
+    CHECK(ctx->trace_id[15] == 0x36);
+    CHECK(ctx->span_id == 0x00f067aa0ba902b7);
+    CHECK(ctx->sampled);
+    CHECK(tracing::to_traceparent(*ctx) == value);
+
+    // All-zero IDs, the forbidden version, bad separators and uppercase digits are rejected.
+    CHECK_FALSE(tracing::from_traceparent("00-00000000000000000000000000000000-00f067aa0ba902b7-01"));
+    CHECK_FALSE(tracing::from_traceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01"));
+    CHECK_FALSE(tracing::from_traceparent("ff-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"));
+    CHECK_FALSE(tracing::from_traceparent("00_4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"));
+    CHECK_FALSE(tracing::from_traceparent("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01"));
+    CHECK_FALSE(tracing::from_traceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7"));
+
+    SECTION("the context is carried in the option string of the startup pack")
+    {
+        std::string option = "iput" + tracing::to_startup_pack_option(*ctx) + "request_server_negotiation";
+
+        const auto extracted = tracing::extract_from_startup_pack_option(option);
+        REQUIRE(extracted);
+        CHECK(tracing::to_traceparent(*extracted) == value);
+        CHECK(option == "iputrequest_server_negotiation");
+
+        CHECK_FALSE(tracing::extract_from_startup_pack_option(option));
+    }
+}
+
+TEST_CASE("tracing")
+{
+    const auto path = fs::temp_directory_path() / fs::unique_path("irods_tracing_%%%%-%%%%.json");
+    const auto remove_file = std::shared_ptr<void>{nullptr, [&path](void*) { fs::remove(path); }};
+
+    tracing::init({path.string(), 1.0, "irods_test"});
+    REQUIRE(tracing::enabled());
+
+    SECTION("spans nest and are exported in the OTLP/JSON format")
+    {
+        {
+            tracing::span outer{"outer", tracing::span_kind::server};
+            REQUIRE(outer.recording());
+            outer.set_attribute("irods.api_number", 602);
+
+            {
+                tracing::span inner{"inner"};
+                inner.set_attribute("irods.resource", "demoResc");
+                inner.set_error("failed: \"x\"\n\x01");
+            }
+        }
+
+        tracing::flush();
+
+        const auto spans = read_spans(path);
+        REQUIRE(spans.size() == 2);
+
+        const auto& outer = find_span(spans, "outer");
+        const auto& inner = find_span(spans, "inner");
+
+        CHECK(outer.at("traceId") == inner.at("traceId"));
+        CHECK(outer.count("parentSpanId") == 0);
+        CHECK(inner.at("parentSpanId") == outer.at("spanId"));
+        CHECK(outer.at("kind") == 2);
+        CHECK(inner.at("status").at("code") == 2);
+        CHECK(inner.at("status").at("message") == "failed: \"x\"\n\x01");
+        CHECK(outer.at("attributes").at(0).at("value").at("intValue") == "602");
+        CHECK(inner.at("attributes").at(0).at("value").at("stringValue") == "demoResc");
+        CHECK(std::stoull(outer.at("startTimeUnixNano").get<std::string>()) <=
+              std::stoull(inner.at("startTimeUnixNano").get<std::string>()));
+    }
+
+    SECTION("spans without a local parent join the trace of the remote caller")
+    {
+        const auto caller = tracing::from_traceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+        tracing::set_remote_parent(*caller);
+
+        {
+            tracing::span s{"api"};
+
+            // The context propagated to other servers is the active span.
+            const auto ctx = tracing::current();
+            REQUIRE(ctx);
+            CHECK(ctx->trace_id == caller->trace_id);
+            CHECK(ctx->span_id != caller->span_id);
+        }
+
+        tracing::set_remote_parent({});
+        tracing::flush();
+
+        const auto spans = read_spans(path);
+        const auto& s = find_span(spans, "api");
+        CHECK(s.at("traceId") == "4bf92f3577b34da6a3ce929d0e0e4736");
+        CHECK(s.at("parentSpanId") == "00f067aa0ba902b7");
+    }
+
+    SECTION("traces which are not sampled are not recorded")
+    {
+        const auto caller = tracing::from_traceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00");
+        tracing::set_remote_parent(*caller);
+
+        {
+            tracing::span s{"api"};
+            CHECK_FALSE(s.recording());
+        }
+
+        tracing::set_remote_parent({});
+
+        tracing::init({path.string(), 0.0, "irods_test"});
+
+        {
+            tracing::span s{"api"};
+            CHECK_FALSE(s.recording());
+        }
+
+        tracing::flush();
+        CHECK(read_spans(path).empty());
+    }
+
+    SECTION("forked processes record spans with distinct IDs")
+    {
+        constexpr int processes = 4;
+
+        for (int p = 0; p < processes; ++p) {
+            if (fork() == 0) {
+                { tracing::span s{"child"}; }
+                tracing::flush();
+                _exit(0);
+            }
+        }
+
+        for (int p = 0; p < processes; ++p) {
+            int status{};
+            wait(&status);
+            REQUIRE(WIFEXITED(status));
+        }
+
+        const auto spans = read_spans(path);
+        REQUIRE(spans.size() == processes);
+
+        std::set<std::string> trace_ids;
+
+        for (auto&& [id, s] : spans) {
+            trace_ids.insert(s.at("traceId").get<std::string>());
+        }
+
+        CHECK(trace_ids.size() == processes);
+    }
+}
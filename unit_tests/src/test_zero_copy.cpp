@@ -0,0 +1,243 @@
+#include "catch.hpp"
+
+#include "zero_copy.hpp"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr rodsLong_t file_size = 64 * 1024 * 1024;
+    constexpr int buffer_size = 4 * 1024 * 1024;
+
+    auto make_temp_file(const std::string& _contents_seed, rodsLong_t _size) -> std::string
+    {
+        std::string path = "/tmp/irods_test_zero_copy_XXXXXX";
+        const int fd = mkstemp(path.data());
+        REQUIRE(fd >= 0);
+
+        std::vector<char> block(buffer_size);
+        for (std::size_t i = 0; i < block.size(); ++i) {
+            block[i] = _contents_seed[i % _contents_seed.size()];
+        }
+
+        for (rodsLong_t written = 0; written < _size; written += buffer_size) {
+            REQUIRE(write(fd, block.data(), block.size()) == static_cast<ssize_t>(block.size()));
+        }
+
+        close(fd);
+
+        return path;
+    }
+
+    auto thread_cpu_seconds() -> double
+    {
+        rusage usage{};
+        getrusage(RUSAGE_THREAD, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    }
+
+    // Drains _sock until the peer closes it and returns the number of bytes seen.
+    auto drain(int _sock) -> rodsLong_t
+    {
+        std::vector<char> buf(buffer_size);
+        rodsLong_t total = 0;
+
+        for (ssize_t n; (n = read(_sock, buf.data(), buf.size())) > 0;) {
+            total += n;
+        }
+
+        return total;
+    }
+
+    auto buffered_send(int _fd, int _sock, rodsLong_t _length) -> rodsLong_t
+    {
+        std::vector<char> buf(buffer_size);
+        rodsLong_t total = 0;
+
+        while (total < _length) {
+            const auto n = pread(_fd, buf.data(), std::min<rodsLong_t>(buf.size(), _length - total), total);
+            if (n <= 0) {
+                break;
+            }
+
+            for (ssize_t sent = 0; sent < n;) {
+                const auto m = write(_sock, buf.data() + sent, n - sent);
+                if (m < 0) {
+                    return -1;
+                }
+                sent += m;
+            }
+
+            total += n;
+        }
+
+        return total;
+    }
+} // anonymous namespace
+
+TEST_CASE("zero_copy")
+{
+    namespace zc = irods::zero_copy;
+
+    const auto src_path = make_temp_file("irods", file_size);
+    const int src_fd = open(src_path.c_str(), O_RDONLY);
+    REQUIRE(src_fd >= 0);
+
+    SECTION("send_to_socket transfers the requested range")
+    {
+        int socks[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+
+        rodsLong_t received = 0;
+        std::thread reader{[&] { received = drain(socks[1]); }};
+
+        bool unsupported = false;
+        const auto sent = zc::send_to_socket(src_fd, socks[0], 1024, file_size - 1024, unsupported);
+        close(socks[0]);
+        reader.join();
+        close(socks[1]);
+
+        if (!unsupported) {
+            CHECK(sent == file_size - 1024);
+            CHECK(received == file_size - 1024);
+        }
+    }
+
+    SECTION("receive_from_socket writes at the requested offset")
+    {
+        int socks[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+
+        std::string dst_path = "/tmp/irods_test_zero_copy_dst_XXXXXX";
+        const int dst_fd = mkstemp(dst_path.data());
+        REQUIRE(dst_fd >= 0);
+
+        constexpr rodsLong_t length = 1024 * 1024;
+        std::thread writer{[&] {
+            buffered_send(src_fd, socks[0], length);
+            close(socks[0]);
+        }};
+
+        bool unsupported = false;
+        const auto received = zc::receive_from_socket(socks[1], dst_fd, 512, length, unsupported);
+        writer.join();
+        close(socks[1]);
+
+        if (!unsupported) {
+            CHECK(received == length);
+
+            std::vector<char> expected(length);
+            std::vector<char> actual(length);
+            REQUIRE(pread(src_fd, expected.data(), expected.size(), 0) == length);
+            REQUIRE(pread(dst_fd, actual.data(), actual.size(), 512) == length);
+            CHECK(expected == actual);
+        }
+
+        close(dst_fd);
+        unlink(dst_path.c_str());
+    }
+
+    SECTION("copy_file_range copies the requested range at the same offset")
+    {
+        std::string dst_path = "/tmp/irods_test_zero_copy_dst_XXXXXX";
+        const int dst_fd = mkstemp(dst_path.data());
+        REQUIRE(dst_fd >= 0);
+
+        bool unsupported = false;
+        const auto copied = zc::copy_file_range(src_fd, dst_fd, 4096, 8192, unsupported);
+
+        if (!unsupported) {
+            CHECK(copied == 8192);
+
+            std::vector<char> expected(8192);
+            std::vector<char> actual(8192);
+            REQUIRE(pread(src_fd, expected.data(), expected.size(), 4096) == 8192);
+            REQUIRE(pread(dst_fd, actual.data(), actual.size(), 4096) == 8192);
+            CHECK(expected == actual);
+        }
+
+        close(dst_fd);
+        unlink(dst_path.c_str());
+    }
+
+    close(src_fd);
+    unlink(src_path.c_str());
+}
+
+TEST_CASE("zero_copy is only used when every resource passes bytes through unchanged")
+{
+    namespace zc = irods::zero_copy;
+
+    CHECK(zc::is_pass_through_hierarchy({"unixfilesystem"}));
+    CHECK(zc::is_pass_through_hierarchy({"passthru", "unixfilesystem"}));
+    CHECK(zc::is_pass_through_hierarchy({"replication", "random", "unixfilesystem"}));
+    CHECK(zc::is_pass_through_hierarchy({"compound", "unixfilesystem"}));
+
+    // The file of the child holds compressed blocks, chunks or a pack.
+    CHECK_FALSE(zc::is_pass_through_hierarchy({"blockcompress", "unixfilesystem"}));
+    CHECK_FALSE(zc::is_pass_through_hierarchy({"replication", "blockcompress", "unixfilesystem"}));
+    CHECK_FALSE(zc::is_pass_through_hierarchy({"dedup", "unixfilesystem"}));
+    CHECK_FALSE(zc::is_pass_through_hierarchy({"pack", "unixfilesystem"}));
+
+    // The leaf is not a plain file.
+    CHECK_FALSE(zc::is_pass_through_hierarchy({"passthru", "univmss"}));
+    CHECK_FALSE(zc::is_pass_through_hierarchy({"unixfilesystem", "passthru"}));
+    CHECK_FALSE(zc::is_pass_through_hierarchy({}));
+}
+
+// Run with: irods_zero_copy "[benchmark]"
+TEST_CASE("zero_copy benchmark - CPU seconds per GiB", "[.][benchmark]")
+{
+    namespace zc = irods::zero_copy;
+
+    constexpr double gib = 1024.0 * 1024.0 * 1024.0;
+
+    const auto src_path = make_temp_file("benchmark", file_size);
+    const int src_fd = open(src_path.c_str(), O_RDONLY);
+    REQUIRE(src_fd >= 0);
+
+    const auto measure = [&](auto&& _send) {
+        int socks[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == 0);
+
+        std::thread reader{[&] { drain(socks[1]); }};
+
+        const auto cpu_start = thread_cpu_seconds();
+        const auto sent = _send(socks[0]);
+        const auto cpu_seconds = thread_cpu_seconds() - cpu_start;
+
+        close(socks[0]);
+        reader.join();
+        close(socks[1]);
+
+        REQUIRE(sent == file_size);
+
+        return cpu_seconds * gib / file_size;
+    };
+
+    const auto buffered = measure([&](int _sock) { return buffered_send(src_fd, _sock, file_size); });
+
+    bool unsupported = false;
+    const auto zero_copy = measure([&](int _sock) {
+        const auto sent = zc::send_to_socket(src_fd, _sock, 0, file_size, unsupported);
+        return unsupported ? file_size : sent;
+    });
+
+    WARN("read/write: " << buffered << " CPU seconds per GiB");
+    WARN("sendfile:   " << (unsupported ? std::string{"unsupported"} : std::to_string(zero_copy)) << " CPU seconds per GiB");
+
+    close(src_fd);
+    unlink(src_path.c_str());
+}